@@ -194,6 +194,93 @@ static tb_void_t tb_sort_int_test_perf_quick(tb_size_t n)
     // free
     tb_free(data);
 }
+static tb_void_t tb_sort_int_test_perf_intro(tb_size_t n)
+{
+    __tb_volatile__ tb_size_t i = 0;
+
+    // init data
+    tb_long_t* data = (tb_long_t*)tb_nalloc0(n, sizeof(tb_long_t));
+    tb_assert_and_check_return(data);
+    
+    // init iterator
+    tb_array_iterator_t array_iterator;
+    tb_iterator_ref_t   iterator = tb_iterator_make_for_long(&array_iterator, data, n);
+
+    // make
+    for (i = 0; i < n; i++) data[i] = tb_random_range(TB_MINS16, TB_MAXS16);
+    
+    // sort
+    tb_hong_t time = tb_mclock();
+    tb_intro_sort_all(iterator, tb_null);
+    time = tb_mclock() - time;
+
+    // time
+    tb_trace_i("tb_intro_sort_int_all: %lld ms", time);
+
+    // check
+    for (i = 1; i < n; i++) tb_assert_and_check_break(data[i - 1] <= data[i]);
+
+    // free
+    tb_free(data);
+}
+static tb_void_t tb_sort_int_test_perf_merge(tb_size_t n)
+{
+    __tb_volatile__ tb_size_t i = 0;
+
+    // init data
+    tb_long_t* data = (tb_long_t*)tb_nalloc0(n, sizeof(tb_long_t));
+    tb_assert_and_check_return(data);
+    
+    // init iterator
+    tb_array_iterator_t array_iterator;
+    tb_iterator_ref_t   iterator = tb_iterator_make_for_long(&array_iterator, data, n);
+
+    // make
+    for (i = 0; i < n; i++) data[i] = tb_random_range(TB_MINS16, TB_MAXS16);
+    
+    // sort
+    tb_hong_t time = tb_mclock();
+    tb_merge_sort_all(iterator, tb_null);
+    time = tb_mclock() - time;
+
+    // time
+    tb_trace_i("tb_merge_sort_int_all: %lld ms", time);
+
+    // check
+    for (i = 1; i < n; i++) tb_assert_and_check_break(data[i - 1] <= data[i]);
+
+    // free
+    tb_free(data);
+}
+static tb_void_t tb_sort_int_test_perf_parallel(tb_size_t n)
+{
+    __tb_volatile__ tb_size_t i = 0;
+
+    // init data
+    tb_long_t* data = (tb_long_t*)tb_nalloc0(n, sizeof(tb_long_t));
+    tb_assert_and_check_return(data);
+    
+    // init iterator
+    tb_array_iterator_t array_iterator;
+    tb_iterator_ref_t   iterator = tb_iterator_make_for_long(&array_iterator, data, n);
+
+    // make
+    for (i = 0; i < n; i++) data[i] = tb_random_range(TB_MINS16, TB_MAXS16);
+    
+    // sort
+    tb_hong_t time = tb_mclock();
+    tb_parallel_sort_all(tb_null, iterator, tb_null);
+    time = tb_mclock() - time;
+
+    // time
+    tb_trace_i("tb_parallel_sort_int_all: %lld ms", time);
+
+    // check
+    for (i = 1; i < n; i++) tb_assert_and_check_break(data[i - 1] <= data[i]);
+
+    // free
+    tb_free(data);
+}
 static tb_void_t tb_sort_int_test_func_quick()
 {
     // init
@@ -295,6 +382,61 @@ static tb_void_t tb_sort_int_test_func_heap()
     // free
     tb_free(data);
 }
+static tb_long_t tb_sort_scalar_test_comp_long(tb_iterator_ref_t iterator, tb_cpointer_t litem, tb_cpointer_t ritem)
+{
+    return ((tb_long_t)litem < (tb_long_t)ritem)? -1 : ((tb_long_t)litem > (tb_long_t)ritem);
+}
+static tb_long_t tb_sort_scalar_test_comp_size(tb_iterator_ref_t iterator, tb_cpointer_t litem, tb_cpointer_t ritem)
+{
+    return ((tb_size_t)litem < (tb_size_t)ritem)? -1 : ((tb_size_t)litem > (tb_size_t)ritem);
+}
+static tb_void_t tb_sort_scalar_test_func(tb_size_t n)
+{
+    // init data
+    tb_size_t*  data = (tb_size_t*)tb_nalloc0(n << 2, sizeof(tb_size_t));
+    tb_vector_ref_t vector = tb_vector_init(n, tb_element_long());
+    if (data && vector)
+    {
+        // make the random values with the sign bit, the last values are duplicated
+        tb_size_t i = 0;
+        for (i = 0; i < n; i++) 
+        {
+            data[i] = ((tb_size_t)tb_random_value() << ((sizeof(tb_size_t) << 3) - 31)) ^ (tb_size_t)tb_random_value();
+            if (i >= n - (n >> 3)) data[i] = data[i & 15];
+            data[n + i] = data[i];
+            data[(n << 1) + i] = data[i];
+            data[(n << 1) + n + i] = data[i];
+            tb_vector_insert_tail(vector, (tb_cpointer_t)data[i]);
+        }
+
+        // sort the long items by the scalar path and the generic path with the custom comparer
+        tb_array_iterator_t array_iterator;
+        tb_sort_all(tb_iterator_make_for_long(&array_iterator, (tb_long_t*)data, n), tb_null);
+        tb_sort_all(tb_iterator_make_for_long(&array_iterator, (tb_long_t*)data + n, n), tb_sort_scalar_test_comp_long);
+
+        // sort the size items by the scalar path and the generic path with the custom comparer
+        tb_sort_all(tb_iterator_make_for_size(&array_iterator, data + (n << 1), n), tb_null);
+        tb_sort_all(tb_iterator_make_for_size(&array_iterator, data + (n << 1) + n, n), tb_sort_scalar_test_comp_size);
+
+        // sort the vector items by the scalar path
+        tb_sort_all(vector, tb_null);
+
+        // check
+        tb_bool_t ok = tb_vector_size(vector) == n;
+        for (i = 0; i < n && ok; i++)
+        {
+            if (data[i] != data[n + i] || data[(n << 1) + i] != data[(n << 1) + n + i] || data[i] != (tb_size_t)tb_iterator_item(vector, i)) ok = tb_false;
+            if (i && ((tb_long_t)data[i - 1] > (tb_long_t)data[i] || data[(n << 1) + i - 1] > data[(n << 1) + i])) ok = tb_false;
+        }
+
+        // trace
+        tb_trace_i("tb_sort_scalar(%lu): %s", n, ok? "ok" : "failed");
+    }
+
+    // free
+    if (vector) tb_vector_exit(vector);
+    if (data) tb_free(data);
+}
 static tb_void_t tb_sort_str_test_perf(tb_size_t n)
 {
     __tb_volatile__ tb_size_t i = 0;
@@ -439,6 +581,114 @@ static tb_void_t tb_sort_str_test_perf_quick(tb_size_t n)
     for (i = 0; i < n; i++) tb_free(data[i]);
     tb_free(data);
 }
+static tb_void_t tb_sort_str_test_perf_intro(tb_size_t n)
+{
+    __tb_volatile__ tb_size_t i = 0;
+
+    // init data
+    tb_char_t** data = (tb_char_t**)tb_nalloc0(n, sizeof(tb_char_t*));
+    tb_assert_and_check_return(data);
+
+    // init iterator
+    tb_array_iterator_t array_iterator;
+    tb_iterator_ref_t   iterator = tb_iterator_make_for_str(&array_iterator, data, n);
+
+    // make
+    tb_char_t s[256] = {0};
+    for (i = 0; i < n; i++) 
+    {
+        tb_long_t r = tb_snprintf(s, 256, "%ld", tb_random_value()); 
+        s[r] = '\0'; 
+        data[i] = tb_strdup(s);
+    }
+
+    // sort
+    tb_hong_t time = tb_mclock();
+    tb_intro_sort_all(iterator, tb_null);
+    time = tb_mclock() - time;
+
+    // time
+    tb_trace_i("tb_intro_sort_str_all: %lld ms", time);
+
+    // check
+    for (i = 1; i < n; i++) tb_assert_and_check_break(tb_strcmp(data[i - 1], data[i]) <= 0);
+
+    // free data
+    for (i = 0; i < n; i++) tb_free(data[i]);
+    tb_free(data);
+}
+static tb_void_t tb_sort_str_test_perf_merge(tb_size_t n)
+{
+    __tb_volatile__ tb_size_t i = 0;
+
+    // init data
+    tb_char_t** data = (tb_char_t**)tb_nalloc0(n, sizeof(tb_char_t*));
+    tb_assert_and_check_return(data);
+
+    // init iterator
+    tb_array_iterator_t array_iterator;
+    tb_iterator_ref_t   iterator = tb_iterator_make_for_str(&array_iterator, data, n);
+
+    // make
+    tb_char_t s[256] = {0};
+    for (i = 0; i < n; i++) 
+    {
+        tb_long_t r = tb_snprintf(s, 256, "%ld", tb_random_value()); 
+        s[r] = '\0'; 
+        data[i] = tb_strdup(s);
+    }
+
+    // sort
+    tb_hong_t time = tb_mclock();
+    tb_merge_sort_all(iterator, tb_null);
+    time = tb_mclock() - time;
+
+    // time
+    tb_trace_i("tb_merge_sort_str_all: %lld ms", time);
+
+    // check
+    for (i = 1; i < n; i++) tb_assert_and_check_break(tb_strcmp(data[i - 1], data[i]) <= 0);
+
+    // free data
+    for (i = 0; i < n; i++) tb_free(data[i]);
+    tb_free(data);
+}
+static tb_void_t tb_sort_str_test_perf_parallel(tb_size_t n)
+{
+    __tb_volatile__ tb_size_t i = 0;
+
+    // init data
+    tb_char_t** data = (tb_char_t**)tb_nalloc0(n, sizeof(tb_char_t*));
+    tb_assert_and_check_return(data);
+
+    // init iterator
+    tb_array_iterator_t array_iterator;
+    tb_iterator_ref_t   iterator = tb_iterator_make_for_str(&array_iterator, data, n);
+
+    // make
+    tb_char_t s[256] = {0};
+    for (i = 0; i < n; i++) 
+    {
+        tb_long_t r = tb_snprintf(s, 256, "%ld", tb_random_value()); 
+        s[r] = '\0'; 
+        data[i] = tb_strdup(s);
+    }
+
+    // sort
+    tb_hong_t time = tb_mclock();
+    tb_parallel_sort_all(tb_null, iterator, tb_null);
+    time = tb_mclock() - time;
+
+    // time
+    tb_trace_i("tb_parallel_sort_str_all: %lld ms", time);
+
+    // check
+    for (i = 1; i < n; i++) tb_assert_and_check_break(tb_strcmp(data[i - 1], data[i]) <= 0);
+
+    // free data
+    for (i = 0; i < n; i++) tb_free(data[i]);
+    tb_free(data);
+}
 static tb_void_t tb_sort_str_test_perf_heap(tb_size_t n)
 {
     __tb_volatile__ tb_size_t i = 0;
@@ -485,16 +735,24 @@ tb_int_t tb_demo_algorithm_sort_main(tb_int_t argc, tb_char_t** argv)
     tb_sort_int_test_func_quick();
     tb_sort_int_test_func_bubble();
     tb_sort_int_test_func_insert();
+    tb_sort_scalar_test_func(10);
+    tb_sort_scalar_test_func(100000);
 
     // perf
     tb_sort_int_test_perf(1000);
     tb_sort_int_test_perf_heap(1000);
     tb_sort_int_test_perf_quick(1000);
+    tb_sort_int_test_perf_intro(1000);
+    tb_sort_int_test_perf_merge(1000);
+    tb_sort_int_test_perf_parallel(100000);
     tb_sort_int_test_perf_bubble(1000);
     tb_sort_int_test_perf_insert(1000);
     tb_sort_str_test_perf(1000);
     tb_sort_str_test_perf_heap(1000);
     tb_sort_str_test_perf_quick(1000);
+    tb_sort_str_test_perf_intro(1000);
+    tb_sort_str_test_perf_merge(1000);
+    tb_sort_str_test_perf_parallel(100000);
     tb_sort_str_test_perf_bubble(1000);
     tb_sort_str_test_perf_insert(1000);
 
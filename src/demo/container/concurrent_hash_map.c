@@ -0,0 +1,305 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the operations count for each thread
+#ifdef __tb_debug__
+#   define TB_DEMO_OPS_COUNT        (200000)
+#else
+#   define TB_DEMO_OPS_COUNT        (2000000)
+#endif
+
+// the keys count
+#define TB_DEMO_KEYS_COUNT          (65536)
+
+// the counters count for the compute test
+#define TB_DEMO_COUNTERS_COUNT      (1024)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the demo context type
+typedef struct __tb_demo_context_t
+{
+    // the concurrent hash map
+    tb_concurrent_hash_map_ref_t    map;
+
+    // the hash map
+    tb_hash_map_ref_t               hash_map;
+
+    // the lock for the hash map
+    tb_spinlock_t                   lock;
+
+    // the found count
+    tb_atomic_t                     found;
+
+}tb_demo_context_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+
+// the thread-local random value, tb_random_value() is locked and too slow for the performance test
+static __tb_inline__ tb_size_t tb_demo_random(tb_uint32_t* seed)
+{
+    tb_uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return (tb_size_t)x;
+}
+static tb_size_t tb_demo_compute_inc(tb_hash_map_item_ref_t item, tb_cpointer_t* pdata, tb_cpointer_t priv)
+{
+    *pdata = (tb_cpointer_t)((tb_size_t)item->data + 1);
+    return TB_CONCURRENT_HASH_MAP_COMPUTE_REPLACE;
+}
+static tb_size_t tb_demo_compute_remove(tb_hash_map_item_ref_t item, tb_cpointer_t* pdata, tb_cpointer_t priv)
+{
+    return TB_CONCURRENT_HASH_MAP_COMPUTE_REMOVE;
+}
+static tb_bool_t tb_demo_walk_sum(tb_hash_map_item_ref_t item, tb_cpointer_t priv)
+{
+    *((tb_size_t*)priv) += (tb_size_t)item->data;
+    return tb_true;
+}
+static tb_bool_t tb_demo_walk_odd(tb_hash_map_item_ref_t item, tb_cpointer_t priv)
+{
+    return ((tb_size_t)item->name) & 1;
+}
+static tb_void_t tb_concurrent_hash_map_int_test()
+{
+    // init
+    tb_concurrent_hash_map_ref_t map = tb_concurrent_hash_map_init(0, tb_element_size(), tb_element_size());
+    tb_assert_and_check_return(map);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // insert items
+        tb_size_t i = 0;
+        for (i = 0; i < 1000; i++) if (!tb_concurrent_hash_map_insert(map, (tb_pointer_t)i, (tb_pointer_t)(i * 2))) break;
+        tb_assert_and_check_break(i == 1000 && tb_concurrent_hash_map_size(map) == 1000);
+
+        // get items, the zero data need be found too
+        tb_size_t data = 0;
+        for (i = 0; i < 1000; i++) if (!tb_concurrent_hash_map_get(map, (tb_pointer_t)i, &data) || data != i * 2) break;
+        tb_assert_and_check_break(i == 1000 && !tb_concurrent_hash_map_get(map, (tb_pointer_t)1000, tb_null));
+
+        // get or insert
+        tb_assert_and_check_break(!tb_concurrent_hash_map_get_or_insert(map, (tb_pointer_t)10, (tb_pointer_t)0, &data) && data == 20);
+        tb_assert_and_check_break(tb_concurrent_hash_map_get_or_insert(map, (tb_pointer_t)1000, (tb_pointer_t)2000, &data) == 1 && data == 2000);
+
+        // compute if present
+        tb_assert_and_check_break(tb_concurrent_hash_map_compute(map, (tb_pointer_t)10, tb_demo_compute_inc, tb_null));
+        tb_assert_and_check_break(tb_concurrent_hash_map_get(map, (tb_pointer_t)10, &data) && data == 21);
+        tb_assert_and_check_break(!tb_concurrent_hash_map_compute(map, (tb_pointer_t)1001, tb_demo_compute_inc, tb_null));
+        tb_assert_and_check_break(tb_concurrent_hash_map_compute(map, (tb_pointer_t)1000, tb_demo_compute_remove, tb_null));
+        tb_assert_and_check_break(!tb_concurrent_hash_map_get(map, (tb_pointer_t)1000, tb_null));
+
+        // walk items
+        tb_size_t sum = 0;
+        tb_concurrent_hash_map_walk(map, tb_demo_walk_sum, &sum);
+        tb_assert_and_check_break(sum == 999 * 1000 + 1);
+
+        // remove items
+        tb_assert_and_check_break(tb_concurrent_hash_map_remove(map, (tb_pointer_t)0) && !tb_concurrent_hash_map_remove(map, (tb_pointer_t)0));
+        tb_assert_and_check_break(tb_concurrent_hash_map_remove_if(map, tb_demo_walk_odd, tb_null) == 500);
+        tb_assert_and_check_break(tb_concurrent_hash_map_size(map) == 499);
+
+        // clear items
+        tb_concurrent_hash_map_clear(map);
+        tb_assert_and_check_break(!tb_concurrent_hash_map_size(map));
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // trace
+    tb_trace_i("int: %s", ok? "ok" : "failed");
+
+    // exit
+    tb_concurrent_hash_map_exit(map);
+}
+static tb_void_t tb_concurrent_hash_map_str_test()
+{
+    // init
+    tb_concurrent_hash_map_ref_t map = tb_concurrent_hash_map_init(8, tb_element_str(tb_true), tb_element_str(tb_true));
+    tb_assert_and_check_return(map);
+
+    // insert items
+    tb_concurrent_hash_map_insert(map, "0000000000", "1111111111");
+    tb_concurrent_hash_map_insert(map, "2222222222", "3333333333");
+
+    // get item and free it
+    tb_char_t*      data = tb_null;
+    tb_element_t    element = tb_element_str(tb_true);
+    if (tb_concurrent_hash_map_get(map, "2222222222", &data))
+    {
+        tb_trace_i("str: %s", data);
+        element.free(&element, &data);
+    }
+
+    // the remaining items will be freed when exiting it
+    tb_concurrent_hash_map_exit(map);
+}
+static tb_int_t tb_concurrent_hash_map_counter(tb_cpointer_t priv)
+{
+    // check
+    tb_concurrent_hash_map_ref_t map = (tb_concurrent_hash_map_ref_t)priv;
+    tb_assert_and_check_return_val(map, -1);
+
+    // increase the counters
+    tb_size_t   i = 0;
+    tb_uint32_t seed = (tb_uint32_t)tb_thread_self() | 1;
+    for (i = 0; i < TB_DEMO_OPS_COUNT / 10; i++)
+    {
+        tb_size_t key = 1 + tb_demo_random(&seed) % TB_DEMO_COUNTERS_COUNT;
+        if (tb_concurrent_hash_map_get_or_insert(map, (tb_pointer_t)key, (tb_pointer_t)1, tb_null) == 0)
+            tb_concurrent_hash_map_compute(map, (tb_pointer_t)key, tb_demo_compute_inc, tb_null);
+    }
+    return 0;
+}
+static tb_void_t tb_concurrent_hash_map_counter_test(tb_size_t n)
+{
+    // init
+    tb_concurrent_hash_map_ref_t map = tb_concurrent_hash_map_init(0, tb_element_size(), tb_element_size());
+    tb_assert_and_check_return(map);
+
+    // start threads
+    tb_size_t       i = 0;
+    tb_thread_ref_t threads[32] = {0};
+    for (i = 0; i < n; i++) threads[i] = tb_thread_init(tb_null, tb_concurrent_hash_map_counter, map, 0);
+
+    // wait threads
+    for (i = 0; i < n; i++)
+    {
+        if (threads[i])
+        {
+            tb_thread_wait(threads[i], -1, tb_null);
+            tb_thread_exit(threads[i]);
+        }
+    }
+
+    // check the sum of the counters
+    tb_size_t sum = 0;
+    tb_concurrent_hash_map_walk(map, tb_demo_walk_sum, &sum);
+
+    // trace
+    tb_trace_i("counter: threads: %lu, sum: %lu, %s", n, sum, sum == n * (TB_DEMO_OPS_COUNT / 10)? "ok" : "failed");
+
+    // exit
+    tb_concurrent_hash_map_exit(map);
+}
+static tb_int_t tb_concurrent_hash_map_worker(tb_cpointer_t priv)
+{
+    // check
+    tb_demo_context_t* context = (tb_demo_context_t*)priv;
+    tb_assert_and_check_return_val(context, -1);
+
+    // 95% get and 5% insert or remove
+    tb_size_t   i = 0;
+    tb_size_t   found = 0;
+    tb_size_t   data = 0;
+    tb_uint32_t seed = (tb_uint32_t)tb_thread_self() | 1;
+    for (i = 0; i < TB_DEMO_OPS_COUNT; i++)
+    {
+        tb_size_t key = tb_demo_random(&seed) % TB_DEMO_KEYS_COUNT;
+        tb_size_t op = tb_demo_random(&seed) % 100;
+        if (context->map)
+        {
+            if (op < 95) found += tb_concurrent_hash_map_get(context->map, (tb_pointer_t)key, &data);
+            else if (op < 98) tb_concurrent_hash_map_insert(context->map, (tb_pointer_t)key, (tb_pointer_t)key);
+            else tb_concurrent_hash_map_remove(context->map, (tb_pointer_t)key);
+        }
+        else
+        {
+            tb_spinlock_enter(&context->lock);
+            if (op < 95) found += tb_hash_map_find(context->hash_map, (tb_pointer_t)key)? 1 : 0;
+            else if (op < 98) tb_hash_map_insert(context->hash_map, (tb_pointer_t)key, (tb_pointer_t)key);
+            else tb_hash_map_remove(context->hash_map, (tb_pointer_t)key);
+            tb_spinlock_leave(&context->lock);
+        }
+    }
+
+    // save found
+    tb_atomic_fetch_and_add(&context->found, found);
+    return 0;
+}
+static tb_void_t tb_concurrent_hash_map_perf_test(tb_char_t const* name, tb_bool_t concurrent, tb_size_t n)
+{
+    // init context
+    tb_demo_context_t context;
+    tb_memset(&context, 0, sizeof(tb_demo_context_t));
+    if (concurrent) context.map = tb_concurrent_hash_map_init(0, tb_element_size(), tb_element_size());
+    else
+    {
+        context.hash_map = tb_hash_map_init(0, tb_element_size(), tb_element_size());
+        tb_spinlock_init(&context.lock);
+    }
+
+    // init items
+    tb_size_t i = 0;
+    for (i = 0; i < TB_DEMO_KEYS_COUNT; i += 2)
+    {
+        if (context.map) tb_concurrent_hash_map_insert(context.map, (tb_pointer_t)i, (tb_pointer_t)i);
+        else tb_hash_map_insert(context.hash_map, (tb_pointer_t)i, (tb_pointer_t)i);
+    }
+
+    // start threads
+    tb_thread_ref_t threads[32] = {0};
+    tb_hong_t       t = tb_mclock();
+    for (i = 0; i < n; i++) threads[i] = tb_thread_init(tb_null, tb_concurrent_hash_map_worker, &context, 0);
+
+    // wait threads
+    for (i = 0; i < n; i++)
+    {
+        if (threads[i])
+        {
+            tb_thread_wait(threads[i], -1, tb_null);
+            tb_thread_exit(threads[i]);
+        }
+    }
+    t = tb_mclock() - t;
+
+    // trace
+    tb_trace_i("%s: threads: %lu, ops: %lu, found: %ld, %lld ms", name, n, n * TB_DEMO_OPS_COUNT, (tb_long_t)context.found, t);
+
+    // exit
+    if (context.map) tb_concurrent_hash_map_exit(context.map);
+    if (context.hash_map)
+    {
+        tb_hash_map_exit(context.hash_map);
+        tb_spinlock_exit(&context.lock);
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */
+tb_int_t tb_demo_container_concurrent_hash_map_main(tb_int_t argc, tb_char_t** argv)
+{
+    // the threads count
+    tb_size_t n = argv[1]? tb_atoi(argv[1]) : 4;
+    tb_assert_and_check_return_val(n && n <= 32, -1);
+
+    // test items
+    tb_concurrent_hash_map_int_test();
+    tb_concurrent_hash_map_str_test();
+    tb_concurrent_hash_map_counter_test(n);
+
+    // test performance
+    tb_concurrent_hash_map_perf_test("hash_map + spinlock", tb_false, 1);
+    tb_concurrent_hash_map_perf_test("concurrent_hash_map", tb_true, 1);
+    tb_concurrent_hash_map_perf_test("hash_map + spinlock", tb_false, n);
+    tb_concurrent_hash_map_perf_test("concurrent_hash_map", tb_true, n);
+    return 0;
+}
@@ -535,6 +535,161 @@ static tb_void_t tb_hash_map_test_i2t_perf()
     // exit hash
     tb_hash_map_exit(hash);
 }
+static tb_void_t tb_hash_map_test_s2s_allocator()
+{
+    // init allocator, the map, its buckets and the duplicated strings will be allocated from it
+    tb_allocator_ref_t large_allocator = tb_large_allocator_init(tb_null, 0);
+    tb_allocator_ref_t allocator = large_allocator? tb_default_allocator_init(large_allocator) : tb_null;
+    if (!allocator)
+    {
+        if (large_allocator) tb_allocator_exit(large_allocator);
+        return ;
+    }
+
+    // init hash map
+    tb_bool_t           ok = tb_false;
+    tb_size_t           live = 0;
+    tb_allocator_stat_t stat;
+    tb_hash_map_ref_t   hash = tb_hash_map_init_with_allocator(8, tb_element_str(tb_true), tb_element_str(tb_true), allocator);
+    if (hash)
+    {
+        // insert strings and replace some of them
+        tb_size_t i = 0;
+        tb_size_t n = 1000;
+        tb_char_t name[64];
+        tb_char_t data[64];
+        for (i = 0; i < n; i++)
+        {
+            tb_snprintf(name, sizeof(name), "name: %lu", i);
+            tb_snprintf(data, sizeof(data), "data: %lu", i);
+            tb_hash_map_insert(hash, name, data);
+            if (!(i & 7)) tb_hash_map_insert(hash, name, data);
+        }
+
+        // all strings are allocated from this allocator
+        if (tb_allocator_stat(allocator, &stat)) live = stat.live_count;
+        ok = tb_hash_map_size(hash) == n && live > (n << 1);
+
+        // get and remove strings
+        for (i = 0; i < n && ok; i++)
+        {
+            tb_snprintf(name, sizeof(name), "name: %lu", i);
+            tb_snprintf(data, sizeof(data), "data: %lu", i);
+            tb_char_t const* value = (tb_char_t const*)tb_hash_map_get(hash, name);
+            if (!value || tb_strcmp(value, data)) ok = tb_false;
+            if (i & 1) tb_hash_map_remove(hash, name);
+        }
+        if (tb_hash_map_size(hash) != (n >> 1)) ok = tb_false;
+
+        // exit hash map
+        tb_hash_map_exit(hash);
+    }
+
+    // all data has been freed to the allocator?
+    if (!tb_allocator_stat(allocator, &stat) || stat.live_count) ok = tb_false;
+
+    // trace
+    tb_trace_i("allocator: live: %lu => %lu: %s", live, stat.live_count, ok? "ok" : "failed");
+
+    // exit allocator
+    tb_allocator_exit(allocator);
+    tb_allocator_exit(large_allocator);
+}
+static tb_bool_t tb_hash_map_test_migrate_pred(tb_iterator_ref_t iterator, tb_cpointer_t item, tb_cpointer_t value)
+{
+    // remove the items whose names have the same remainder
+    tb_hash_map_item_ref_t hash_item = (tb_hash_map_item_ref_t)item;
+    return hash_item && ((tb_size_t)hash_item->name % 7) == (tb_size_t)value;
+}
+static tb_void_t tb_hash_map_test_migrate_func()
+{
+    // init hash map and the existing flags of all names
+    tb_size_t           n = 200000;
+    tb_byte_t*          flags = (tb_byte_t*)tb_nalloc0(n, sizeof(tb_byte_t));
+    tb_hash_map_ref_t   hash = tb_hash_map_init(8, tb_element_size(), tb_element_size());
+    if (hash && flags)
+    {
+        /* insert, remove, find and iterate items when growing it
+         *
+         * the large table (>= 16384 slots) is migrated incrementally after growing,
+         * so many of these operations will be done when the old table is still being migrated.
+         */
+        tb_bool_t ok = tb_true;
+        tb_size_t i = 0;
+        tb_size_t k = 0;
+        tb_size_t size = 0;
+        tb_size_t old = 0;
+        tb_hong_t time = tb_mclock();
+        for (i = 0; i < n && ok; i++)
+        {
+            // insert it
+            tb_hash_map_insert(hash, (tb_cpointer_t)i, (tb_cpointer_t)(i * 7));
+            if (!flags[i]) size++;
+            flags[i] = 1;
+
+            // remove the previous item
+            if (i & 1)
+            {
+                k = i >> 1;
+                tb_hash_map_remove(hash, (tb_cpointer_t)k);
+                if (flags[k]) size--;
+                flags[k] = 0;
+            }
+
+            // find a random item
+            k = tb_random_range(0, i + 1);
+            tb_size_t itor = tb_hash_map_find(hash, (tb_cpointer_t)k);
+            if ((itor != tb_iterator_tail(hash)) != (flags[k] != 0)) ok = tb_false;
+            if (flags[k] && (tb_size_t)tb_hash_map_get(hash, (tb_cpointer_t)k) != k * 7) ok = tb_false;
+
+            // iterate all items, the items of the old table are after the items of the current table
+            if (!(i % 5003))
+            {
+                tb_size_t count = 0;
+                tb_size_t maxn = tb_hash_map_maxn(hash);
+                tb_for_all_if (tb_hash_map_item_ref_t, item, hash, item)
+                {
+                    k = (tb_size_t)item->name;
+                    if (k >= n || !flags[k] || (tb_size_t)item->data != k * 7) ok = tb_false;
+                    if (item_itor > maxn) old++;
+                    count++;
+                }
+                if (count != size) ok = tb_false;
+            }
+
+            // remove some items by the iterator
+            if (!(i % 20011))
+            {
+                tb_remove_if(hash, tb_hash_map_test_migrate_pred, (tb_cpointer_t)(i % 7));
+                for (k = i % 7; k <= i; k += 7) 
+                {
+                    if (flags[k]) size--;
+                    flags[k] = 0;
+                }
+            }
+
+            // check size
+            if (tb_hash_map_size(hash) != size) ok = tb_false;
+        }
+
+        // reserve it, all old slots will be migrated now
+        if (!tb_hash_map_reserve(hash, n << 1)) ok = tb_false;
+        tb_size_t maxn = tb_hash_map_maxn(hash);
+        for (k = 0; k < n && ok; k++)
+        {
+            tb_size_t itor = tb_hash_map_find(hash, (tb_cpointer_t)k);
+            if ((itor != tb_iterator_tail(hash)) != (flags[k] != 0) || (flags[k] && itor > maxn)) ok = tb_false;
+        }
+        time = tb_mclock() - time;
+
+        // trace
+        tb_trace_i("migrate: size: %lu, maxn: %lu, iterated %lu items of the old tables in %lld ms: %s", tb_hash_map_size(hash), maxn, old, time, (ok && old)? "ok" : "failed");
+    }
+
+    // exit
+    if (hash) tb_hash_map_exit(hash);
+    if (flags) tb_free(flags);
+}
 static tb_bool_t tb_hash_map_test_walk_item(tb_iterator_ref_t iterator, tb_cpointer_t item, tb_cpointer_t value)
 {
     // done
@@ -592,6 +747,8 @@ tb_int_t tb_demo_container_hash_map_main(tb_int_t argc, tb_char_t** argv)
     tb_hash_map_test_m2m_func();
     tb_hash_map_test_i2i_func();
     tb_hash_map_test_i2t_func();
+    tb_hash_map_test_s2s_allocator();
+    tb_hash_map_test_migrate_func();
 #endif
 
 #if 1
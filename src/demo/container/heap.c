@@ -80,6 +80,61 @@ static tb_void_t tb_test_heap_min_func()
     // exit heap
     tb_heap_exit(heap);
 }
+static tb_long_t tb_test_heap_long_comp(tb_element_ref_t element, tb_cpointer_t ldata, tb_cpointer_t rdata)
+{
+    return ((tb_long_t)ldata < (tb_long_t)rdata)? -1 : ((tb_long_t)ldata > (tb_long_t)rdata);
+}
+static tb_void_t tb_test_heap_scalar_func()
+{
+    // init heaps, the scalar heap compares the long items directly
+    tb_element_t    element = tb_element_long();
+    element.comp            = tb_test_heap_long_comp;
+    tb_heap_ref_t   heap    = tb_heap_init(16, tb_element_long());
+    tb_heap_ref_t   heap2   = tb_heap_init(16, element);
+    tb_heap_ref_t   heap3   = tb_heap_init(16, tb_element_size());
+    if (heap && heap2 && heap3)
+    {
+        // put the random values with the sign bit, and remove some values
+        tb_size_t i = 0;
+        for (i = 0; i < 10000; i++) 
+        {
+            tb_size_t val = ((tb_size_t)tb_random_value() << ((sizeof(tb_size_t) << 3) - 31)) ^ (tb_size_t)tb_random_value();
+            tb_heap_put(heap, (tb_cpointer_t)val);
+            tb_heap_put(heap2, (tb_cpointer_t)val);
+            tb_heap_put(heap3, (tb_cpointer_t)val);
+            if (!(i & 15))
+            {
+                tb_heap_remove(heap, tb_find_all(heap, (tb_cpointer_t)val));
+                tb_heap_remove(heap2, tb_find_all(heap2, (tb_cpointer_t)val));
+                tb_heap_remove(heap3, tb_find_all(heap3, (tb_cpointer_t)val));
+            }
+        }
+
+        // the scalar heap must pop the same values as the generic heap
+        tb_bool_t ok = tb_heap_size(heap) == tb_heap_size(heap2) && tb_heap_size(heap) == tb_heap_size(heap3);
+        tb_long_t prev = 0;
+        tb_size_t prev3 = 0;
+        for (i = 0; tb_heap_size(heap) && ok; i++)
+        {
+            tb_long_t val = (tb_long_t)tb_heap_top(heap);
+            tb_size_t val3 = (tb_size_t)tb_heap_top(heap3);
+            if (val != (tb_long_t)tb_heap_top(heap2) || (i && (prev > val || prev3 > val3))) ok = tb_false;
+            prev = val;
+            prev3 = val3;
+            tb_heap_pop(heap);
+            tb_heap_pop(heap2);
+            tb_heap_pop(heap3);
+        }
+
+        // trace
+        tb_trace_i("heap_scalar: %s", ok? "ok" : "failed");
+    }
+
+    // exit heaps
+    if (heap) tb_heap_exit(heap);
+    if (heap2) tb_heap_exit(heap2);
+    if (heap3) tb_heap_exit(heap3);
+}
 static tb_void_t tb_test_heap_min_perf()
 {
     // init heap
@@ -240,6 +295,7 @@ tb_int_t tb_demo_container_heap_main(tb_int_t argc, tb_char_t** argv)
     // element
     tb_test_heap_min_func();
     tb_test_heap_max_func();
+    tb_test_heap_scalar_func();
 
     // performance
     tb_test_heap_min_perf();
@@ -785,6 +785,56 @@ static tb_void_t tb_list_mem_test()
     // exit list
     if (list) tb_list_exit(list);
 }
+static tb_void_t tb_list_allocator_test()
+{
+    // init allocator, the list, its nodes and the duplicated strings will be allocated from it
+    tb_allocator_ref_t large_allocator = tb_large_allocator_init(tb_null, 0);
+    tb_allocator_ref_t allocator = large_allocator? tb_default_allocator_init(large_allocator) : tb_null;
+    if (!allocator)
+    {
+        if (large_allocator) tb_allocator_exit(large_allocator);
+        return ;
+    }
+
+    // init list
+    tb_bool_t           ok = tb_false;
+    tb_size_t           live = 0;
+    tb_allocator_stat_t stat;
+    tb_list_ref_t       list = tb_list_init_with_allocator(0, tb_element_str(tb_true), allocator);
+    if (list)
+    {
+        // insert strings
+        tb_size_t i = 0;
+        tb_size_t n = 1000;
+        tb_char_t data[64];
+        for (i = 0; i < n; i++)
+        {
+            tb_snprintf(data, sizeof(data), "%lu", i);
+            tb_list_insert_tail(list, data);
+        }
+
+        // replace some strings, the old strings will be freed to the allocator
+        tb_list_replace_head(list, "head");
+        tb_list_replace_last(list, "last");
+
+        // all strings are allocated from this allocator
+        if (tb_allocator_stat(allocator, &stat)) live = stat.live_count;
+        ok = tb_list_size(list) == n && live > n && !tb_strcmp((tb_char_t const*)tb_list_head(list), "head") && !tb_strcmp((tb_char_t const*)tb_list_last(list), "last");
+
+        // exit list
+        tb_list_exit(list);
+    }
+
+    // all data has been freed to the allocator?
+    if (!tb_allocator_stat(allocator, &stat) || stat.live_count) ok = tb_false;
+
+    // trace
+    tb_trace_i("allocator: live: %lu => %lu: %s", live, stat.live_count, ok? "ok" : "failed");
+
+    // exit allocator
+    tb_allocator_exit(allocator);
+    tb_allocator_exit(large_allocator);
+}
 static tb_void_t tb_list_perf_test()
 {
     // insert
@@ -854,6 +904,7 @@ tb_int_t tb_demo_container_list_main(tb_int_t argc, tb_char_t** argv)
     tb_list_int_test();
     tb_list_str_test();
     tb_list_mem_test();
+    tb_list_allocator_test();
 
 #if 1
     tb_list_perf_test();
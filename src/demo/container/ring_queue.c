@@ -0,0 +1,326 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the items count for each producer
+#ifdef __tb_debug__
+#   define TB_DEMO_ITEM_COUNT       (100000)
+#else
+#   define TB_DEMO_ITEM_COUNT       (1000000)
+#endif
+
+// the batch size
+#define TB_DEMO_BATCH_SIZE          (32)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the demo context type
+typedef struct __tb_demo_context_t
+{
+    // the ring queue
+    tb_ring_queue_ref_t         ring_queue;
+
+    // the circle queue
+    tb_circle_queue_ref_t       circle_queue;
+
+    // the lock for the circle queue
+    tb_spinlock_t               lock;
+
+    // use batch?
+    tb_bool_t                   batch;
+
+    // the remaining items count for consumers
+    tb_atomic_t                 left;
+
+    // the sum of the popped items
+    tb_atomic_t                 sum;
+
+}tb_demo_context_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+static tb_void_t tb_ring_queue_int_test()
+{
+    // init
+    tb_ring_queue_ref_t queue = tb_ring_queue_init(10, tb_element_long(), TB_RING_QUEUE_MODE_MPMC);
+    tb_assert_and_check_return(queue);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // check maxn
+        tb_assert_and_check_break(tb_ring_queue_maxn(queue) == 16);
+
+        // put items
+        tb_size_t i = 0;
+        for (i = 0; i < 16; i++) if (!tb_ring_queue_put(queue, (tb_pointer_t)i)) break;
+        tb_assert_and_check_break(tb_ring_queue_full(queue));
+        tb_assert_and_check_break(!tb_ring_queue_put(queue, (tb_pointer_t)16));
+
+        // pop items
+        tb_long_t value = 0;
+        for (i = 0; i < 8; i++)
+        {
+            if (!tb_ring_queue_pop(queue, &value) || value != (tb_long_t)i) break;
+        }
+        tb_assert_and_check_break(i == 8);
+
+        // put and pop items in batches
+        tb_cpointer_t list[8];
+        for (i = 0; i < 8; i++) list[i] = (tb_cpointer_t)(16 + i);
+        tb_assert_and_check_break(tb_ring_queue_put_list(queue, list, 8) == 8);
+
+        tb_long_t items[16];
+        tb_assert_and_check_break(tb_ring_queue_pop_list(queue, items, 16) == 16);
+        for (i = 0; i < 16; i++) 
+        {
+            if (items[i] != (tb_long_t)(8 + i)) break;
+        }
+        tb_assert_and_check_break(i == 16 && tb_ring_queue_null(queue));
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // trace
+    tb_trace_i("int: %s", ok? "ok" : "failed");
+
+    // exit
+    tb_ring_queue_exit(queue);
+}
+static tb_void_t tb_ring_queue_min_test()
+{
+    // init the queue with one slot, it will be aligned to two slots
+    tb_ring_queue_ref_t queue = tb_ring_queue_init(1, tb_element_long(), TB_RING_QUEUE_MODE_MPMC);
+    tb_assert_and_check_return(queue);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // check maxn
+        tb_assert_and_check_break(tb_ring_queue_maxn(queue) == 2);
+
+        // put one and pop two, the second pop will be failed
+        tb_long_t value = 0;
+        tb_assert_and_check_break(tb_ring_queue_put(queue, (tb_pointer_t)1));
+        tb_assert_and_check_break(tb_ring_queue_pop(queue, &value) && value == 1);
+        tb_assert_and_check_break(!tb_ring_queue_pop(queue, &value));
+
+        // the written item will be not overwritten if the queue is full
+        tb_assert_and_check_break(tb_ring_queue_put(queue, (tb_pointer_t)2));
+        tb_assert_and_check_break(tb_ring_queue_put(queue, (tb_pointer_t)3));
+        tb_assert_and_check_break(!tb_ring_queue_put(queue, (tb_pointer_t)4));
+        tb_assert_and_check_break(tb_ring_queue_pop(queue, &value) && value == 2);
+        tb_assert_and_check_break(tb_ring_queue_pop(queue, &value) && value == 3);
+        tb_assert_and_check_break(!tb_ring_queue_pop(queue, &value));
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // trace
+    tb_trace_i("min: %s", ok? "ok" : "failed");
+
+    // exit
+    tb_ring_queue_exit(queue);
+}
+static tb_void_t tb_ring_queue_str_test()
+{
+    // init
+    tb_ring_queue_ref_t queue = tb_ring_queue_init(10, tb_element_str(tb_true), TB_RING_QUEUE_MODE_SPSC);
+    tb_assert_and_check_return(queue);
+
+    // put items
+    tb_ring_queue_put(queue, "0000000000");
+    tb_ring_queue_put(queue, "1111111111");
+    tb_ring_queue_put(queue, "2222222222");
+
+    // pop item and free it
+    tb_char_t* data = tb_null;
+    tb_element_t element = tb_element_str(tb_true);
+    if (tb_ring_queue_pop(queue, &data))
+    {
+        tb_trace_i("str: %s", data);
+        element.free(&element, &data);
+    }
+
+    // the remaining items will be freed when exiting it
+    tb_ring_queue_exit(queue);
+}
+static tb_int_t tb_ring_queue_producer(tb_cpointer_t priv)
+{
+    // check
+    tb_demo_context_t* context = (tb_demo_context_t*)priv;
+    tb_assert_and_check_return_val(context, -1);
+
+    // put items
+    tb_size_t       i = 1;
+    tb_size_t       j = 0;
+    tb_cpointer_t   list[TB_DEMO_BATCH_SIZE];
+    tb_size_t       k = 0;
+    while (i <= TB_DEMO_ITEM_COUNT)
+    {
+        // save the put count
+        k = i;
+
+        // put to the ring queue
+        if (context->ring_queue)
+        {
+            if (context->batch)
+            {
+                tb_size_t n = tb_min(TB_DEMO_BATCH_SIZE, TB_DEMO_ITEM_COUNT + 1 - i);
+                for (j = 0; j < n; j++) list[j] = (tb_cpointer_t)(i + j);
+                i += tb_ring_queue_put_list(context->ring_queue, list, n);
+            }
+            else if (tb_ring_queue_put(context->ring_queue, (tb_cpointer_t)i)) i++;
+        }
+        // put to the circle queue
+        else
+        {
+            tb_spinlock_enter(&context->lock);
+            if (!tb_circle_queue_full(context->circle_queue))
+            {
+                tb_circle_queue_put(context->circle_queue, (tb_cpointer_t)i);
+                i++;
+            }
+            tb_spinlock_leave(&context->lock);
+        }
+
+        // full? yield the processor
+        if (k == i) tb_sched_yield();
+    }
+    return 0;
+}
+static tb_int_t tb_ring_queue_consumer(tb_cpointer_t priv)
+{
+    // check
+    tb_demo_context_t* context = (tb_demo_context_t*)priv;
+    tb_assert_and_check_return_val(context, -1);
+
+    // pop items
+    tb_size_t   i = 0;
+    tb_size_t   n = 0;
+    tb_size_t   sum = 0;
+    tb_long_t   items[TB_DEMO_BATCH_SIZE];
+    while (context->left > 0)
+    {
+        // pop from the ring queue
+        n = 0;
+        if (context->ring_queue)
+        {
+            if (context->batch) n = tb_ring_queue_pop_list(context->ring_queue, items, TB_DEMO_BATCH_SIZE);
+            else if (tb_ring_queue_pop(context->ring_queue, items)) n = 1;
+        }
+        // pop from the circle queue
+        else
+        {
+            tb_spinlock_enter(&context->lock);
+            if (!tb_circle_queue_null(context->circle_queue))
+            {
+                items[0] = (tb_long_t)tb_circle_queue_get(context->circle_queue);
+                tb_circle_queue_pop(context->circle_queue);
+                n = 1;
+            }
+            tb_spinlock_leave(&context->lock);
+        }
+
+        // save items
+        if (n)
+        {
+            for (i = 0; i < n; i++) sum += items[i];
+            tb_atomic_fetch_and_sub(&context->left, n);
+        }
+        // null? yield the processor
+        else tb_sched_yield();
+    }
+
+    // save sum
+    tb_atomic_fetch_and_add(&context->sum, sum);
+    return 0;
+}
+static tb_void_t tb_ring_queue_perf_test(tb_char_t const* name, tb_size_t mode, tb_size_t producers, tb_size_t consumers, tb_bool_t batch)
+{
+    // init context
+    tb_demo_context_t context;
+    tb_memset(&context, 0, sizeof(tb_demo_context_t));
+    context.batch = batch;
+    context.left  = producers * TB_DEMO_ITEM_COUNT;
+    if (mode != (tb_size_t)-1) context.ring_queue = tb_ring_queue_init(1024, tb_element_long(), mode);
+    else
+    {
+        context.circle_queue = tb_circle_queue_init(1024, tb_element_long());
+        tb_spinlock_init(&context.lock);
+    }
+
+    // start threads
+    tb_size_t       i = 0;
+    tb_thread_ref_t threads[64] = {0};
+    tb_hong_t       t = tb_mclock();
+    tb_assert_and_check_return(producers + consumers <= tb_arrayn(threads));
+    for (i = 0; i < producers; i++) threads[i] = tb_thread_init(tb_null, tb_ring_queue_producer, &context, 0);
+    for (i = 0; i < consumers; i++) threads[producers + i] = tb_thread_init(tb_null, tb_ring_queue_consumer, &context, 0);
+
+    // wait threads
+    for (i = 0; i < producers + consumers; i++)
+    {
+        if (threads[i])
+        {
+            tb_thread_wait(threads[i], -1, tb_null);
+            tb_thread_exit(threads[i]);
+        }
+    }
+    t = tb_mclock() - t;
+
+    // check sum
+    tb_size_t sum = producers * ((tb_size_t)TB_DEMO_ITEM_COUNT * (TB_DEMO_ITEM_COUNT + 1) / 2);
+
+    // trace
+    tb_trace_i("%s: producers: %lu, consumers: %lu, batch: %d, items: %lu, %lld ms, %s", name, producers, consumers, batch, producers * TB_DEMO_ITEM_COUNT, t, (tb_size_t)context.sum == sum? "ok" : "failed");
+
+    // exit queue
+    if (context.ring_queue) tb_ring_queue_exit(context.ring_queue);
+    if (context.circle_queue)
+    {
+        tb_circle_queue_exit(context.circle_queue);
+        tb_spinlock_exit(&context.lock);
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */
+tb_int_t tb_demo_container_ring_queue_main(tb_int_t argc, tb_char_t** argv)
+{
+    // the threads count
+    tb_size_t n = argv[1]? tb_atoi(argv[1]) : 4;
+    tb_assert_and_check_return_val(n && n <= 32, -1);
+
+    // test items
+    tb_ring_queue_int_test();
+    tb_ring_queue_min_test();
+    tb_ring_queue_str_test();
+
+    // test performance
+    tb_ring_queue_perf_test("circle_queue + spinlock", -1, 1, 1, tb_false);
+    tb_ring_queue_perf_test("ring_queue(spsc)", TB_RING_QUEUE_MODE_SPSC, 1, 1, tb_false);
+    tb_ring_queue_perf_test("ring_queue(spsc)", TB_RING_QUEUE_MODE_SPSC, 1, 1, tb_true);
+    tb_ring_queue_perf_test("circle_queue + spinlock", -1, n, 1, tb_false);
+    tb_ring_queue_perf_test("ring_queue(mpsc)", TB_RING_QUEUE_MODE_MPSC, n, 1, tb_false);
+    tb_ring_queue_perf_test("ring_queue(mpsc)", TB_RING_QUEUE_MODE_MPSC, n, 1, tb_true);
+    tb_ring_queue_perf_test("circle_queue + spinlock", -1, n, n, tb_false);
+    tb_ring_queue_perf_test("ring_queue(mpmc)", TB_RING_QUEUE_MODE_MPMC, n, n, tb_false);
+    tb_ring_queue_perf_test("ring_queue(mpmc)", TB_RING_QUEUE_MODE_MPMC, n, n, tb_true);
+    return 0;
+}
@@ -10,6 +10,17 @@
 // the switch count
 #define COUNT       (10000000)
 
+// the shared data count of each producer or consumer
+#define COUNT_SHARED    (10000)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the received data count and sum of the shared channel
+static tb_atomic_t      g_shared_count = 0;
+static tb_atomic64_t    g_shared_sum = 0;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */ 
@@ -136,6 +147,118 @@ static tb_void_t tb_demo_coroutine_channel_perf(tb_size_t size)
         tb_co_scheduler_exit(scheduler);
     }
 }
+static tb_void_t tb_demo_coroutine_channel_shared_send(tb_cpointer_t priv)
+{
+    // check
+    tb_co_channel_ref_t channel = (tb_co_channel_ref_t)priv;
+
+    // send data, the small buffer will suspend it frequently
+    tb_size_t i;
+    for (i = 1; i <= COUNT_SHARED; i++) tb_co_channel_send(channel, (tb_cpointer_t)i);
+}
+static tb_void_t tb_demo_coroutine_channel_shared_recv(tb_cpointer_t priv)
+{
+    // check
+    tb_co_channel_ref_t channel = (tb_co_channel_ref_t)priv;
+
+    // recv data from the producers of the other scheduler and the plain thread
+    tb_size_t i;
+    for (i = 0; i < COUNT_SHARED; i++)
+    {
+        tb_size_t data = (tb_size_t)tb_co_channel_recv(channel);
+        tb_atomic64_fetch_and_add(&g_shared_sum, data);
+        tb_atomic_fetch_and_inc(&g_shared_count);
+    }
+}
+static tb_int_t tb_demo_coroutine_channel_shared_thread_send(tb_cpointer_t priv)
+{
+    // the plain thread will be parked if the channel is full
+    tb_demo_coroutine_channel_shared_send(priv);
+    return 0;
+}
+static tb_int_t tb_demo_coroutine_channel_shared_thread_recv(tb_cpointer_t priv)
+{
+    // the plain thread will be parked if the channel is null
+    tb_demo_coroutine_channel_shared_recv(priv);
+    return 0;
+}
+static tb_int_t tb_demo_coroutine_channel_shared_loop(tb_cpointer_t priv)
+{
+    // run the producer scheduler in this thread
+    tb_co_scheduler_loop((tb_co_scheduler_ref_t)priv, tb_false);
+    return 0;
+}
+static tb_void_t tb_demo_coroutine_channel_shared(tb_size_t size)
+{
+    // trace
+    tb_trace_i("shared: %lu", size);
+
+    // init the shared channel
+    tb_co_channel_ref_t channel = tb_co_channel_init_with_flags(size, tb_null, tb_null, TB_CO_CHANNEL_FLAG_SHARED);
+    tb_assert_and_check_return(channel);
+
+    // init the producer and consumer schedulers
+    tb_co_scheduler_ref_t producer = tb_co_scheduler_init();
+    tb_co_scheduler_ref_t consumer = tb_co_scheduler_init();
+    if (producer && consumer)
+    {
+        // start the producers and consumers
+        tb_size_t i;
+        for (i = 0; i < 4; i++) 
+        {
+            tb_coroutine_start(producer, tb_demo_coroutine_channel_shared_send, channel, 0);
+            tb_coroutine_start(consumer, tb_demo_coroutine_channel_shared_recv, channel, 0);
+        }
+
+        // init the start time
+        tb_atomic_set(&g_shared_count, 0);
+        tb_atomic64_set(&g_shared_sum, 0);
+        tb_hong_t startime = tb_mclock();
+
+        // run the producer scheduler in the other thread
+        tb_thread_ref_t loop = tb_thread_init(tb_null, tb_demo_coroutine_channel_shared_loop, producer, 0);
+
+        // start the plain producer and consumer threads
+        tb_thread_ref_t sender = tb_thread_init(tb_null, tb_demo_coroutine_channel_shared_thread_send, channel, 0);
+        tb_thread_ref_t recver = tb_thread_init(tb_null, tb_demo_coroutine_channel_shared_thread_recv, channel, 0);
+
+        // run the consumer scheduler
+        tb_co_scheduler_loop(consumer, tb_false);
+
+        // wait all threads
+        if (loop)
+        {
+            tb_thread_wait(loop, -1, tb_null);
+            tb_thread_exit(loop);
+        }
+        if (sender)
+        {
+            tb_thread_wait(sender, -1, tb_null);
+            tb_thread_exit(sender);
+        }
+        if (recver)
+        {
+            tb_thread_wait(recver, -1, tb_null);
+            tb_thread_exit(recver);
+        }
+
+        // computing time
+        tb_hong_t duration = tb_mclock() - startime;
+
+        // check the received data, 5 producers and 5 consumers
+        tb_size_t   count = (tb_size_t)tb_atomic_get(&g_shared_count);
+        tb_hize_t   sum = (tb_hize_t)tb_atomic64_get(&g_shared_sum);
+        tb_hize_t   expect = (tb_hize_t)5 * COUNT_SHARED * (COUNT_SHARED + 1) / 2;
+        tb_trace_i("shared: %lu: recv %lu/%d, sum %llu/%llu in %lld ms: %s", size, count, 5 * COUNT_SHARED, sum, expect, duration, (count == 5 * COUNT_SHARED && sum == expect)? "ok" : "failed");
+    }
+
+    // exit schedulers
+    if (producer) tb_co_scheduler_exit(producer);
+    if (consumer) tb_co_scheduler_exit(consumer);
+
+    // exit channel
+    tb_co_channel_exit(channel);
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * main
@@ -150,5 +273,8 @@ tb_int_t tb_demo_coroutine_channel_main(tb_int_t argc, tb_char_t** argv)
     tb_demo_coroutine_channel_perf(1);
     tb_demo_coroutine_channel_perf(10);
 
+    tb_demo_coroutine_channel_shared(1);
+    tb_demo_coroutine_channel_shared(16);
+
     return 0;
 }
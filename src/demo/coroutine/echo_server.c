@@ -101,8 +101,11 @@ static tb_void_t tb_demo_coroutine_listen(tb_cpointer_t priv)
  */ 
 tb_int_t tb_demo_coroutine_echo_server_main(tb_int_t argc, tb_char_t** argv)
 {
-    // init scheduler
-    tb_co_scheduler_ref_t scheduler = tb_co_scheduler_init();
+    // the workers count, .e.g xmake r demo coroutine_echo_server 4
+    tb_size_t workers = argc > 1? tb_atoi(argv[1]) : 1;
+
+    // init scheduler, uses the multi-threaded scheduler if workers > 1
+    tb_co_scheduler_ref_t scheduler = tb_co_scheduler_init_with_workers(workers);
     if (scheduler)
     {
         // start listening
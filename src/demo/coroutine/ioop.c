@@ -0,0 +1,216 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the clients count
+#define TB_DEMO_CLIENT_COUNT    (64)
+
+// the echo count of each client
+#define TB_DEMO_ECHO_COUNT      (50)
+
+// the timeout
+#define TB_DEMO_TIMEOUT         (5000)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the listening address
+static tb_ipaddr_t      g_addr;
+
+// the finished clients count
+static tb_atomic_t      g_done = 0;
+
+// the passed timeout tests count
+static tb_atomic_t      g_timeout = 0;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+static tb_void_t tb_demo_coroutine_ioop_echo(tb_cpointer_t priv)
+{
+    // check
+    tb_socket_ref_t sock = (tb_socket_ref_t)priv;
+    tb_assert_and_check_return(sock);
+
+    // echo data until the client is closed, the buffer cannot be placed on the shared stack
+    tb_byte_t data[256];
+    while (1)
+    {
+        // recv data
+        tb_long_t real = tb_coroutine_recv(sock, data, sizeof(data), TB_DEMO_TIMEOUT);
+        tb_check_break(real > 0);
+
+        // send it back
+        tb_long_t send = 0;
+        while (send < real)
+        {
+            tb_long_t size = tb_coroutine_send(sock, data + send, real - send, TB_DEMO_TIMEOUT);
+            tb_check_break(size > 0);
+            send += size;
+        }
+        tb_check_break(send == real);
+    }
+
+    // exit socket
+    tb_socket_exit(sock);
+}
+static tb_void_t tb_demo_coroutine_ioop_client(tb_cpointer_t priv)
+{
+    // done
+    tb_bool_t       ok = tb_false;
+    tb_socket_ref_t sock = tb_null;
+    do
+    {
+        // init socket
+        sock = tb_socket_init(TB_SOCKET_TYPE_TCP, TB_IPADDR_FAMILY_IPV4);
+        tb_assert_and_check_break(sock);
+
+        // connect it
+        if (tb_coroutine_connect(sock, &g_addr, TB_DEMO_TIMEOUT) <= 0) break;
+
+        // send data and check the echo data
+        tb_size_t i = 0;
+        tb_size_t n = 0;
+        tb_byte_t data[100];
+        tb_byte_t echo[100];
+        for (n = 0; n < TB_DEMO_ECHO_COUNT; n++)
+        {
+            // send data
+            for (i = 0; i < sizeof(data); i++) data[i] = (tb_byte_t)(i + n + (tb_size_t)priv);
+            if (tb_coroutine_send(sock, data, sizeof(data), TB_DEMO_TIMEOUT) != sizeof(data)) break;
+
+            // recv the echo data
+            tb_size_t read = 0;
+            while (read < sizeof(echo))
+            {
+                tb_long_t real = tb_coroutine_recv(sock, echo + read, sizeof(echo) - read, TB_DEMO_TIMEOUT);
+                tb_check_break(real > 0);
+                read += real;
+            }
+            if (read != sizeof(echo) || tb_memcmp(data, echo, sizeof(data))) break;
+        }
+        tb_check_break(n == TB_DEMO_ECHO_COUNT);
+
+        // the first client will test the recv timeout, the echo server has no more data
+        if (!priv)
+        {
+            tb_hong_t time = tb_mclock();
+            tb_long_t real = tb_coroutine_recv(sock, echo, sizeof(echo), 200);
+            time = tb_mclock() - time;
+            tb_trace_i("recv: timeout: %ld after %lld ms", real, time);
+            if (!real && time >= 150) tb_atomic_fetch_and_inc(&g_timeout);
+        }
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // exit socket
+    if (sock) tb_socket_exit(sock);
+
+    // done
+    if (ok) tb_atomic_fetch_and_inc(&g_done);
+}
+static tb_void_t tb_demo_coroutine_ioop_listen(tb_cpointer_t priv)
+{
+    // done
+    tb_socket_ref_t sock = tb_null;
+    do
+    {
+        // init socket
+        sock = tb_socket_init(TB_SOCKET_TYPE_TCP, TB_IPADDR_FAMILY_IPV4);
+        tb_assert_and_check_break(sock);
+
+        // bind a free port
+        tb_ipaddr_set(&g_addr, "127.0.0.1", 0, TB_IPADDR_FAMILY_IPV4);
+        if (!tb_socket_bind(sock, &g_addr) || !tb_socket_local(sock, &g_addr)) break;
+
+        // listen socket
+        if (!tb_socket_listen(sock, 1000)) break;
+
+        // trace
+        tb_trace_i("listening %{ipaddr} ..", &g_addr);
+
+        // start clients
+        tb_size_t i = 0;
+        for (i = 0; i < TB_DEMO_CLIENT_COUNT; i++)
+        {
+            if (!tb_coroutine_start(tb_null, tb_demo_coroutine_ioop_client, (tb_cpointer_t)i, 0)) break;
+        }
+
+        // accept clients
+        for (i = 0; i < TB_DEMO_CLIENT_COUNT; i++)
+        {
+            tb_socket_ref_t client = tb_coroutine_accept(sock, tb_null, TB_DEMO_TIMEOUT);
+            tb_check_break(client);
+
+            // start the echo coroutine
+            if (!tb_coroutine_start(tb_null, tb_demo_coroutine_ioop_echo, client, 0))
+            {
+                tb_socket_exit(client);
+                break;
+            }
+        }
+
+        // test the accept timeout, no more clients
+        tb_hong_t       time = tb_mclock();
+        tb_socket_ref_t client = tb_coroutine_accept(sock, tb_null, 100);
+        time = tb_mclock() - time;
+        tb_trace_i("accept: timeout: %p after %lld ms", client, time);
+        if (!client && time >= 50) tb_atomic_fetch_and_inc(&g_timeout);
+        if (client) tb_socket_exit(client);
+
+    } while (0);
+
+    // exit socket
+    if (sock) tb_socket_exit(sock);
+    sock = tb_null;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */
+tb_int_t tb_demo_coroutine_ioop_main(tb_int_t argc, tb_char_t** argv)
+{
+    /* the completion-style io is only supported by io_uring now (`xmake f --iouring=y`),
+     * otherwise these io operations will be done after waiting the io events
+     */
+    tb_poller_ref_t poller = tb_poller_init(tb_null);
+    if (poller)
+    {
+        tb_trace_i("ioop: %s", tb_poller_support(poller, TB_POLLER_EVENT_COMP)? "completion" : "readiness");
+        tb_poller_exit(poller);
+    }
+
+    // the workers count, .e.g xmake r demo coroutine_ioop 4
+    tb_size_t workers = argc > 1? tb_atoi(argv[1]) : 1;
+
+    // init scheduler
+    tb_co_scheduler_ref_t scheduler = tb_co_scheduler_init_with_workers(workers);
+    if (scheduler)
+    {
+        // start listening
+        tb_coroutine_start(scheduler, tb_demo_coroutine_ioop_listen, tb_null, 0);
+
+        // run scheduler
+        tb_hong_t time = tb_mclock();
+        tb_co_scheduler_loop(scheduler, tb_true);
+        time = tb_mclock() - time;
+
+        // trace
+        tb_size_t done = (tb_size_t)tb_atomic_get(&g_done);
+        tb_size_t timeout = (tb_size_t)tb_atomic_get(&g_timeout);
+        tb_trace_i("done: %lu/%d, timeout: %lu/2 in %lld ms: %s", done, TB_DEMO_CLIENT_COUNT, timeout, time, (done == TB_DEMO_CLIENT_COUNT && timeout == 2)? "ok" : "failed");
+
+        // exit scheduler
+        tb_co_scheduler_exit(scheduler);
+    }
+    return 0;
+}
@@ -10,6 +10,22 @@
 // the switch count
 #define COUNT       (10000000)
 
+// the coroutines count of the shared stacks, it is more than the shared stacks count
+#define COUNT_SHARED    (16)
+
+// the yield count of each coroutine on the shared stacks
+#define YIELD_SHARED    (100)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */ 
+
+// the finished coroutines count of the shared stacks
+static tb_atomic_t      g_shared_done = 0;
+
+// the corrupted frames count of the shared stacks
+static tb_atomic_t      g_shared_failed = 0;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */ 
@@ -45,6 +61,85 @@ static tb_void_t tb_demo_coroutine_switch_test()
         tb_co_scheduler_exit(scheduler);
     }
 }
+static tb_bool_t tb_demo_coroutine_switch_shared_check(tb_byte_t const* data, tb_size_t size, tb_byte_t value)
+{
+    tb_size_t i = 0;
+    for (i = 0; i < size; i++)
+    {
+        if (data[i] != value) return tb_false;
+    }
+    return tb_true;
+}
+static tb_void_t tb_demo_coroutine_switch_shared_nest(tb_size_t id, tb_size_t depth)
+{
+    // fill the local data of this frame, it will be saved and restored with the shared stack
+    tb_byte_t data[256];
+    tb_byte_t value = (tb_byte_t)((id << 4) + depth);
+    tb_memset(data, value, sizeof(data));
+
+    // go deeper, so the used stack sizes of these coroutines are different
+    if (depth) tb_demo_coroutine_switch_shared_nest(id, depth - 1);
+    else
+    {
+        // yield or sleep at the deepest frame
+        tb_size_t count = YIELD_SHARED;
+        while (count--)
+        {
+            if (count & 7) tb_coroutine_yield();
+            else tb_coroutine_sleep(1);
+
+            // check the local data after switching
+            if (!tb_demo_coroutine_switch_shared_check(data, sizeof(data), value))
+                tb_atomic_fetch_and_inc(&g_shared_failed);
+        }
+    }
+
+    // check the local data of this frame after all switches of the deeper frames
+    if (!tb_demo_coroutine_switch_shared_check(data, sizeof(data), value))
+        tb_atomic_fetch_and_inc(&g_shared_failed);
+}
+static tb_void_t tb_demo_coroutine_switch_shared_func(tb_cpointer_t priv)
+{
+    // the locals of the first frame
+    tb_size_t id = (tb_size_t)priv;
+    tb_size_t depth = (id & 7) + 1;
+
+    // switch on the nested frames
+    tb_demo_coroutine_switch_shared_nest(id, depth);
+
+    // the locals must be not changed
+    if (id != (tb_size_t)priv || depth != (id & 7) + 1) tb_atomic_fetch_and_inc(&g_shared_failed);
+
+    // done
+    tb_atomic_fetch_and_inc(&g_shared_done);
+}
+static tb_void_t tb_demo_coroutine_switch_shared(tb_size_t workers)
+{
+    // init scheduler, all coroutines will be run on a few shared stacks
+    tb_co_scheduler_ref_t scheduler = tb_co_scheduler_init_with_flags(workers, TB_CO_SCHEDULER_FLAG_SHARED_STACK);
+    if (scheduler)
+    {
+        // start coroutines
+        tb_size_t i = 0;
+        tb_atomic_set0(&g_shared_done);
+        tb_atomic_set0(&g_shared_failed);
+        for (i = 0; i < COUNT_SHARED; i++)
+            tb_coroutine_start(scheduler, tb_demo_coroutine_switch_shared_func, (tb_cpointer_t)i, 0);
+
+        // run scheduler
+        tb_hong_t time = tb_mclock();
+        tb_co_scheduler_loop(scheduler, tb_true);
+        time = tb_mclock() - time;
+
+        // trace
+        tb_size_t done = (tb_size_t)tb_atomic_get(&g_shared_done);
+        tb_size_t failed = (tb_size_t)tb_atomic_get(&g_shared_failed);
+        tb_trace_i("shared stack: workers: %lu, done: %lu/%d, corrupted: %lu in %lld ms: %s", workers, done, COUNT_SHARED, failed, time, (done == COUNT_SHARED && !failed)? "ok" : "failed");
+
+        // exit scheduler
+        tb_co_scheduler_exit(scheduler);
+    }
+}
 static tb_void_t tb_demo_coroutine_switch_perf_func(tb_cpointer_t priv)
 {
     // loop
@@ -88,6 +183,8 @@ static tb_void_t tb_demo_coroutine_switch_perf()
 tb_int_t tb_demo_coroutine_switch_main(tb_int_t argc, tb_char_t** argv)
 {
     tb_demo_coroutine_switch_test();
+    tb_demo_coroutine_switch_shared(1);
+    tb_demo_coroutine_switch_shared(4);
     tb_demo_coroutine_switch_perf();
     return 0;
 }
@@ -148,12 +148,17 @@ static tb_demo_t g_demo[] =
 ,   TB_DEMO_MAIN_ITEM(memory_check)
 ,   TB_DEMO_MAIN_ITEM(memory_fixed_pool)
 ,   TB_DEMO_MAIN_ITEM(memory_string_pool)
+,   TB_DEMO_MAIN_ITEM(memory_intern_pool)
+,   TB_DEMO_MAIN_ITEM(memory_concurrent_fixed_pool)
+,   TB_DEMO_MAIN_ITEM(memory_arena_allocator)
 ,   TB_DEMO_MAIN_ITEM(memory_large_allocator)
 ,   TB_DEMO_MAIN_ITEM(memory_small_allocator)
 ,   TB_DEMO_MAIN_ITEM(memory_default_allocator)
+,   TB_DEMO_MAIN_ITEM(memory_heap_profiler)
 ,   TB_DEMO_MAIN_ITEM(memory_memops)
 ,   TB_DEMO_MAIN_ITEM(memory_buffer)
 ,   TB_DEMO_MAIN_ITEM(memory_queue_buffer)
+,   TB_DEMO_MAIN_ITEM(memory_rope_buffer)
 ,   TB_DEMO_MAIN_ITEM(memory_static_buffer)
 ,   TB_DEMO_MAIN_ITEM(memory_impl_static_fixed_pool)
 
@@ -188,10 +193,12 @@ static tb_demo_t g_demo[] =
 ,   TB_DEMO_MAIN_ITEM(platform_lock)
 ,   TB_DEMO_MAIN_ITEM(platform_timer)
 ,   TB_DEMO_MAIN_ITEM(platform_ltimer)
+,   TB_DEMO_MAIN_ITEM(platform_htimer)
 ,   TB_DEMO_MAIN_ITEM(platform_event)
 ,   TB_DEMO_MAIN_ITEM(platform_semaphore)
 ,   TB_DEMO_MAIN_ITEM(platform_thread)
 ,   TB_DEMO_MAIN_ITEM(platform_thread_pool)
+,   TB_DEMO_MAIN_ITEM(platform_parallel)
 ,   TB_DEMO_MAIN_ITEM(platform_thread_local)
 #ifdef TB_CONFIG_MODULE_HAVE_COROUTINE
 ,   TB_DEMO_MAIN_ITEM(platform_context)
@@ -208,6 +215,8 @@ static tb_demo_t g_demo[] =
 ,   TB_DEMO_MAIN_ITEM(container_hash_set)
 ,   TB_DEMO_MAIN_ITEM(container_queue)
 ,   TB_DEMO_MAIN_ITEM(container_circle_queue)
+,   TB_DEMO_MAIN_ITEM(container_ring_queue)
+,   TB_DEMO_MAIN_ITEM(container_concurrent_hash_map)
 ,   TB_DEMO_MAIN_ITEM(container_list)
 ,   TB_DEMO_MAIN_ITEM(container_list_entry)
 ,   TB_DEMO_MAIN_ITEM(container_single_list)
@@ -226,6 +235,7 @@ static tb_demo_t g_demo[] =
 ,   TB_DEMO_MAIN_ITEM(coroutine_switch)
 ,   TB_DEMO_MAIN_ITEM(coroutine_channel)
 ,   TB_DEMO_MAIN_ITEM(coroutine_semaphore)
+,   TB_DEMO_MAIN_ITEM(coroutine_ioop)
 ,   TB_DEMO_MAIN_ITEM(coroutine_echo_server)
 ,   TB_DEMO_MAIN_ITEM(coroutine_echo_client)
 ,   TB_DEMO_MAIN_ITEM(coroutine_file_server)
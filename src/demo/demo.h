@@ -137,12 +137,17 @@ TB_DEMO_MAIN_DECL(string_static_string);
 TB_DEMO_MAIN_DECL(memory_check);
 TB_DEMO_MAIN_DECL(memory_fixed_pool);
 TB_DEMO_MAIN_DECL(memory_string_pool);
+TB_DEMO_MAIN_DECL(memory_intern_pool);
+TB_DEMO_MAIN_DECL(memory_concurrent_fixed_pool);
+TB_DEMO_MAIN_DECL(memory_arena_allocator);
 TB_DEMO_MAIN_DECL(memory_large_allocator);
 TB_DEMO_MAIN_DECL(memory_small_allocator);
 TB_DEMO_MAIN_DECL(memory_default_allocator);
+TB_DEMO_MAIN_DECL(memory_heap_profiler);
 TB_DEMO_MAIN_DECL(memory_memops);
 TB_DEMO_MAIN_DECL(memory_buffer);
 TB_DEMO_MAIN_DECL(memory_queue_buffer);
+TB_DEMO_MAIN_DECL(memory_rope_buffer);
 TB_DEMO_MAIN_DECL(memory_static_buffer);
 TB_DEMO_MAIN_DECL(memory_impl_static_fixed_pool);
 
@@ -166,6 +171,7 @@ TB_DEMO_MAIN_DECL(platform_event);
 TB_DEMO_MAIN_DECL(platform_utils);
 TB_DEMO_MAIN_DECL(platform_timer);
 TB_DEMO_MAIN_DECL(platform_ltimer);
+TB_DEMO_MAIN_DECL(platform_htimer);
 TB_DEMO_MAIN_DECL(platform_atomic);
 TB_DEMO_MAIN_DECL(platform_process);
 TB_DEMO_MAIN_DECL(platform_barrier);
@@ -182,6 +188,7 @@ TB_DEMO_MAIN_DECL(platform_cache_time);
 TB_DEMO_MAIN_DECL(platform_environment);
 TB_DEMO_MAIN_DECL(platform_thread);
 TB_DEMO_MAIN_DECL(platform_thread_pool);
+TB_DEMO_MAIN_DECL(platform_parallel);
 TB_DEMO_MAIN_DECL(platform_thread_local);
 TB_DEMO_MAIN_DECL(platform_context);
 
@@ -193,6 +200,8 @@ TB_DEMO_MAIN_DECL(container_hash_map);
 TB_DEMO_MAIN_DECL(container_hash_set);
 TB_DEMO_MAIN_DECL(container_queue);
 TB_DEMO_MAIN_DECL(container_circle_queue);
+TB_DEMO_MAIN_DECL(container_ring_queue);
+TB_DEMO_MAIN_DECL(container_concurrent_hash_map);
 TB_DEMO_MAIN_DECL(container_list);
 TB_DEMO_MAIN_DECL(container_list_entry);
 TB_DEMO_MAIN_DECL(container_single_list);
@@ -211,6 +220,7 @@ TB_DEMO_MAIN_DECL(coroutine_spider);
 TB_DEMO_MAIN_DECL(coroutine_switch);
 TB_DEMO_MAIN_DECL(coroutine_channel);
 TB_DEMO_MAIN_DECL(coroutine_semaphore);
+TB_DEMO_MAIN_DECL(coroutine_ioop);
 TB_DEMO_MAIN_DECL(coroutine_echo_client);
 TB_DEMO_MAIN_DECL(coroutine_echo_server);
 TB_DEMO_MAIN_DECL(coroutine_file_client);
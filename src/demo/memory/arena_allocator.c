@@ -0,0 +1,116 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * demo
+ */ 
+tb_void_t tb_demo_arena_allocator_savepoint(tb_noarg_t);
+tb_void_t tb_demo_arena_allocator_savepoint()
+{
+    // done
+    tb_allocator_ref_t arena_allocator = tb_null;
+    do
+    {
+        // init arena allocator
+        arena_allocator = tb_arena_allocator_init(tb_null, 0);
+        tb_assert_and_check_break(arena_allocator);
+
+        // make data0
+        tb_pointer_t data0 = tb_allocator_malloc(arena_allocator, 10);
+        tb_assert_and_check_break(data0);
+
+        // save the current position
+        tb_arena_allocator_savepoint_t savepoint;
+        tb_arena_allocator_save(arena_allocator, &savepoint);
+
+        // make the temporary data
+        tb_pointer_t data1 = tb_allocator_malloc(arena_allocator, 10);
+        tb_pointer_t data2 = tb_allocator_malloc(arena_allocator, 100000);
+        tb_assert_and_check_break(data1 && data2);
+
+        // free the temporary data at once
+        tb_arena_allocator_restore(arena_allocator, &savepoint);
+
+        // the data1 space will be reused
+        tb_pointer_t data3 = tb_allocator_malloc(arena_allocator, 10);
+        tb_assert_and_check_break(data3);
+
+        // trace
+        tb_trace_i("savepoint: %s", data3 == data1? "ok" : "failed");
+
+#ifdef __tb_debug__
+        // dump arena_allocator
+        tb_allocator_dump(arena_allocator);
+#endif
+
+    } while (0);
+
+    // exit arena allocator
+    if (arena_allocator) tb_allocator_exit(arena_allocator);
+    arena_allocator = tb_null;
+}
+tb_void_t tb_demo_arena_allocator_perf(tb_noarg_t);
+tb_void_t tb_demo_arena_allocator_perf()
+{
+    // done
+    tb_allocator_ref_t arena_allocator = tb_null;
+    do
+    {
+        // init arena allocator
+        arena_allocator = tb_arena_allocator_init(tb_null, 0);
+        tb_assert_and_check_break(arena_allocator);
+
+        // make the requests
+        __tb_volatile__ tb_size_t indx = 0;
+        __tb_volatile__ tb_size_t reqs = 0;
+        __tb_volatile__ tb_hong_t time = tb_mclock();
+        __tb_volatile__ tb_size_t rand = 0xbeaf;
+        for (reqs = 0; reqs < 1000; reqs++)
+        {
+            // make the objects of this request
+            for (indx = 0; indx < 100; indx++)
+            {
+                // make data
+                tb_pointer_t data = tb_allocator_malloc0(arena_allocator, (rand & 1023) + 1);
+                tb_assert_and_check_break(data);
+
+                // make rand
+                rand = (rand * 10807 + 1) & 0xffffffff;
+
+                // make string
+                tb_string_t string;
+                tb_string_init_with_allocator(&string, arena_allocator);
+                tb_string_cstrfcpy(&string, "request: %lu, object: %lu", reqs, indx);
+            }
+
+            // free all objects of this request
+            tb_allocator_clear(arena_allocator);
+        }
+        time = tb_mclock() - time;
+
+#ifdef __tb_debug__
+        // dump arena_allocator
+        tb_allocator_dump(arena_allocator);
+#endif
+
+        // trace
+        tb_trace_i("time: %lld ms", time);
+
+    } while (0);
+
+    // exit arena allocator
+    if (arena_allocator) tb_allocator_exit(arena_allocator);
+    arena_allocator = tb_null;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */ 
+tb_int_t tb_demo_memory_arena_allocator_main(tb_int_t argc, tb_char_t** argv)
+{
+    tb_demo_arena_allocator_perf();
+    tb_demo_arena_allocator_savepoint();
+    return 0;
+}
@@ -0,0 +1,231 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the items count for each producer
+#ifdef __tb_debug__
+#   define TB_DEMO_ITEM_COUNT       (100000)
+#else
+#   define TB_DEMO_ITEM_COUNT       (1000000)
+#endif
+
+// the item size
+#define TB_DEMO_ITEM_SIZE           (64)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the demo context type
+typedef struct __tb_demo_context_t
+{
+    // the ring queue
+    tb_ring_queue_ref_t             queue;
+
+    // the concurrent fixed pool
+    tb_concurrent_fixed_pool_ref_t  concurrent_pool;
+
+    // the fixed pool
+    tb_fixed_pool_ref_t             fixed_pool;
+
+    // the lock for the fixed pool
+    tb_spinlock_t                   lock;
+
+    // the remaining items count for consumers
+    tb_atomic_t                     left;
+
+    // the sum of the freed items
+    tb_atomic_t                     sum;
+
+}tb_demo_context_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+static tb_void_t tb_demo_concurrent_fixed_pool_test()
+{
+    // init pool
+    tb_concurrent_fixed_pool_ref_t pool = tb_concurrent_fixed_pool_init(tb_null, 0, sizeof(tb_size_t), tb_null, tb_null, tb_null);
+    tb_assert_and_check_return(pool);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // make data
+        tb_size_t       i = 0;
+        tb_size_t*      list[1000];
+        for (i = 0; i < tb_arrayn(list); i++)
+        {
+            list[i] = (tb_size_t*)tb_concurrent_fixed_pool_malloc(pool);
+            tb_assert_and_check_break(list[i]);
+            *list[i] = i;
+        }
+        tb_assert_and_check_break(i == tb_arrayn(list) && tb_concurrent_fixed_pool_size(pool) == tb_arrayn(list));
+
+        // check and free data
+        for (i = 0; i < tb_arrayn(list) && *list[i] == i; i++) tb_concurrent_fixed_pool_free(pool, list[i]);
+        tb_assert_and_check_break(i == tb_arrayn(list) && !tb_concurrent_fixed_pool_size(pool));
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // trace
+    tb_trace_i("test: %s", ok? "ok" : "failed");
+
+    // exit pool
+    tb_concurrent_fixed_pool_exit(pool);
+}
+static tb_int_t tb_demo_concurrent_fixed_pool_producer(tb_cpointer_t priv)
+{
+    // check
+    tb_demo_context_t* context = (tb_demo_context_t*)priv;
+    tb_assert_and_check_return_val(context, -1);
+
+    // put items
+    tb_size_t i = 1;
+    tb_size_t* data = tb_null;
+    while (i <= TB_DEMO_ITEM_COUNT)
+    {
+        // make data
+        if (!data)
+        {
+            if (context->concurrent_pool) data = (tb_size_t*)tb_concurrent_fixed_pool_malloc(context->concurrent_pool);
+            else
+            {
+                tb_spinlock_enter(&context->lock);
+                data = (tb_size_t*)tb_fixed_pool_malloc(context->fixed_pool);
+                tb_spinlock_leave(&context->lock);
+            }
+            tb_assert_and_check_break(data);
+            *data = i;
+        }
+
+        // put it
+        if (tb_ring_queue_put(context->queue, data))
+        {
+            data = tb_null;
+            i++;
+        }
+        // full? yield the processor
+        else tb_sched_yield();
+    }
+    return 0;
+}
+static tb_int_t tb_demo_concurrent_fixed_pool_consumer(tb_cpointer_t priv)
+{
+    // check
+    tb_demo_context_t* context = (tb_demo_context_t*)priv;
+    tb_assert_and_check_return_val(context, -1);
+
+    // pop items
+    tb_size_t   sum = 0;
+    tb_size_t*  data = tb_null;
+    while (context->left > 0)
+    {
+        // pop it
+        if (tb_ring_queue_pop(context->queue, &data))
+        {
+            // save it
+            sum += *data;
+
+            // free data
+            if (context->concurrent_pool) tb_concurrent_fixed_pool_free(context->concurrent_pool, data);
+            else
+            {
+                tb_spinlock_enter(&context->lock);
+                tb_fixed_pool_free(context->fixed_pool, data);
+                tb_spinlock_leave(&context->lock);
+            }
+            tb_atomic_fetch_and_dec(&context->left);
+        }
+        // null? yield the processor
+        else tb_sched_yield();
+    }
+
+    // save sum
+    tb_atomic_fetch_and_add(&context->sum, sum);
+    return 0;
+}
+static tb_void_t tb_demo_concurrent_fixed_pool_perf(tb_bool_t concurrent, tb_size_t producers, tb_size_t consumers)
+{
+    // init context
+    tb_demo_context_t context;
+    tb_memset(&context, 0, sizeof(tb_demo_context_t));
+    context.left  = producers * TB_DEMO_ITEM_COUNT;
+    context.queue = tb_ring_queue_init(1024, tb_element_ptr(tb_null, tb_null), TB_RING_QUEUE_MODE_MPMC);
+    if (concurrent) context.concurrent_pool = tb_concurrent_fixed_pool_init(tb_null, 0, TB_DEMO_ITEM_SIZE, tb_null, tb_null, tb_null);
+    else
+    {
+        context.fixed_pool = tb_fixed_pool_init(tb_null, 0, TB_DEMO_ITEM_SIZE, tb_null, tb_null, tb_null);
+        tb_spinlock_init(&context.lock);
+    }
+
+    // start threads
+    tb_size_t       i = 0;
+    tb_thread_ref_t threads[64] = {0};
+    tb_hong_t       t = tb_mclock();
+    tb_assert_and_check_return(producers + consumers <= tb_arrayn(threads));
+    for (i = 0; i < producers; i++) threads[i] = tb_thread_init(tb_null, tb_demo_concurrent_fixed_pool_producer, &context, 0);
+    for (i = 0; i < consumers; i++) threads[producers + i] = tb_thread_init(tb_null, tb_demo_concurrent_fixed_pool_consumer, &context, 0);
+
+    // wait threads
+    for (i = 0; i < producers + consumers; i++)
+    {
+        if (threads[i])
+        {
+            tb_thread_wait(threads[i], -1, tb_null);
+            tb_thread_exit(threads[i]);
+        }
+    }
+    t = tb_mclock() - t;
+
+    // check sum
+    tb_size_t sum = producers * ((tb_size_t)TB_DEMO_ITEM_COUNT * (TB_DEMO_ITEM_COUNT + 1) / 2);
+
+    // trace
+    tb_trace_i("%s: producers: %lu, consumers: %lu, items: %lu, %lld ms, %s", concurrent? "concurrent_fixed_pool" : "fixed_pool + spinlock", producers, consumers, producers * TB_DEMO_ITEM_COUNT, t, (tb_size_t)context.sum == sum? "ok" : "failed");
+
+#ifdef __tb_debug__
+    // dump pool
+    if (context.concurrent_pool) tb_concurrent_fixed_pool_dump(context.concurrent_pool);
+#endif
+
+    // exit pool
+    if (context.concurrent_pool) tb_concurrent_fixed_pool_exit(context.concurrent_pool);
+    if (context.fixed_pool) 
+    {
+        tb_fixed_pool_exit(context.fixed_pool);
+        tb_spinlock_exit(&context.lock);
+    }
+
+    // exit queue
+    if (context.queue) tb_ring_queue_exit(context.queue);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */
+tb_int_t tb_demo_memory_concurrent_fixed_pool_main(tb_int_t argc, tb_char_t** argv)
+{
+    // the threads count
+    tb_size_t n = argv[1]? tb_atoi(argv[1]) : 4;
+    tb_assert_and_check_return_val(n && n <= 32, -1);
+
+    // test items
+    tb_demo_concurrent_fixed_pool_test();
+
+    // test performance
+    tb_demo_concurrent_fixed_pool_perf(tb_false, 1, 1);
+    tb_demo_concurrent_fixed_pool_perf(tb_true, 1, 1);
+    tb_demo_concurrent_fixed_pool_perf(tb_false, n, n);
+    tb_demo_concurrent_fixed_pool_perf(tb_true, n, n);
+    return 0;
+}
@@ -213,6 +213,93 @@ tb_void_t tb_demo_default_allocator_perf()
     if (large_allocator) tb_allocator_exit(large_allocator);
     large_allocator = tb_null;
 }
+static tb_void_t tb_demo_default_allocator_pressure_func(tb_allocator_ref_t allocator, tb_size_t size, tb_cpointer_t priv)
+{
+    // the cache
+    tb_value_ref_t cache = (tb_value_ref_t)priv;
+    tb_assert_and_check_return(cache);
+
+    // trace
+    tb_trace_i("pressure: over %lu bytes, release %lu items", size, cache[1].ul);
+
+    // release all cached items
+    tb_pointer_t* list = (tb_pointer_t*)cache[0].ptr;
+    while (cache[1].ul) tb_allocator_free(allocator, list[--cache[1].ul]);
+
+    // update the pressure count
+    cache[2].ul++;
+}
+tb_void_t tb_demo_default_allocator_pressure(tb_noarg_t);
+tb_void_t tb_demo_default_allocator_pressure()
+{
+    // done
+    tb_allocator_ref_t allocator = tb_null;
+    tb_allocator_ref_t large_allocator = tb_null;
+    tb_pointer_t*      list = tb_null;
+    tb_value_t         cache[3];
+    tb_allocator_stat_t stat;
+    do
+    {
+        // init large allocator
+        large_allocator = tb_large_allocator_init(tb_null, 0);
+        tb_assert_and_check_break(large_allocator);
+
+        // init allocator
+        allocator = tb_default_allocator_init(large_allocator);
+        tb_assert_and_check_break(allocator);
+
+        // make the cache list
+        tb_size_t maxn = 100000;
+        list = (tb_pointer_t*)tb_allocator_large_nalloc0(large_allocator, maxn, sizeof(tb_pointer_t), tb_null);
+        tb_assert_and_check_break(list);
+
+        // init cache: list, size and the pressure count
+        cache[0].ptr = (tb_pointer_t)list;
+        cache[1].ul  = 0;
+        cache[2].ul  = 0;
+
+        // set the soft limit to 2MB
+        tb_allocator_pressure_register(allocator, tb_demo_default_allocator_pressure_func, cache);
+        if (!tb_allocator_limit_set(allocator, 2 * 1024 * 1024)) break;
+
+        // fill the cache, it will be released under the memory pressure
+        tb_size_t i = 0;
+        tb_size_t n = 0;
+        for (i = 0; i < maxn; i++)
+        {
+            tb_pointer_t data = tb_allocator_malloc(allocator, 64 + (i & 63));
+            tb_assert_and_check_break(data);
+            list[cache[1].ul++] = data;
+            n++;
+        }
+        if (tb_allocator_stat(allocator, &stat))
+            tb_trace_i("limit: %lu, items: %lu, cached: %lu, pressure: %lu, occupied: %lu", tb_allocator_limit(allocator), n, cache[1].ul, cache[2].ul, stat.occupied_size);
+
+        // release all cached items without the pressure
+        tb_allocator_pressure_unregister(allocator, tb_demo_default_allocator_pressure_func, cache);
+        while (cache[1].ul) tb_allocator_free(allocator, list[--cache[1].ul]);
+        if (tb_allocator_stat(allocator, &stat))
+            tb_trace_i("freed: occupied: %lu, live: %lu", stat.occupied_size, stat.live_size);
+
+        // return the free slots to the system
+        tb_allocator_trim(allocator);
+        if (tb_allocator_stat(allocator, &stat))
+            tb_trace_i("trimmed: occupied: %lu, live: %lu", stat.occupied_size, stat.live_size);
+
+    } while (0);
+
+    // exit list
+    if (list) tb_allocator_large_free(large_allocator, list);
+    list = tb_null;
+
+    // exit allocator
+    if (allocator) tb_allocator_exit(allocator);
+    allocator = tb_null;
+
+    // exit large allocator
+    if (large_allocator) tb_allocator_exit(large_allocator);
+    large_allocator = tb_null;
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * main
@@ -223,6 +310,10 @@ tb_int_t tb_demo_memory_default_allocator_main(tb_int_t argc, tb_char_t** argv)
     tb_demo_default_allocator_perf();
 #endif
 
+#if 1
+    tb_demo_default_allocator_pressure();
+#endif
+
 #if 0
     tb_demo_default_allocator_leak();
 #endif
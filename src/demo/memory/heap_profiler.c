@@ -0,0 +1,174 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the data count
+#define TB_DEMO_DATA_COUNT      (4096)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+static tb_void_t tb_demo_heap_profiler_make(tb_pointer_t* list, tb_size_t count)
+{
+    // make data with the different size classes, they will be sampled with this backtrace
+    tb_size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        list[i] = tb_malloc(((i & 63) + 1) << 4);
+        if (list[i]) tb_memset(list[i], 0, ((i & 63) + 1) << 4);
+    }
+}
+static tb_void_t tb_demo_heap_profiler_free(tb_pointer_t* list, tb_size_t count)
+{
+    // free data
+    tb_size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        if (list[i]) tb_free(list[i]);
+        list[i] = tb_null;
+    }
+}
+static tb_bool_t tb_demo_heap_profiler_stat(tb_pointer_t* list)
+{
+    // init the statistics
+    tb_allocator_stat_t* stat = tb_malloc0_type(tb_allocator_stat_t);
+    tb_assert_and_check_return_val(stat, tb_false);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // get the statistics before making data
+        if (!tb_allocator_stat(tb_allocator(), stat)) break;
+        tb_size_t live_count = stat->live_count;
+        tb_size_t live_size = stat->live_size;
+
+        // make data
+        tb_demo_heap_profiler_make(list, TB_DEMO_DATA_COUNT);
+
+        // get the statistics after making data
+        tb_memset(stat, 0, sizeof(tb_allocator_stat_t));
+        if (!tb_allocator_stat(tb_allocator(), stat)) break;
+
+        // trace
+        tb_trace_i("stat: malloc: %lu, ralloc: %lu, free: %lu, live: %lu, %lu bytes, peak: %lu bytes, occupied: %lu bytes"
+                    , stat->malloc_count, stat->ralloc_count, stat->free_count, stat->live_count, stat->live_size, stat->peak_size, stat->occupied_size);
+
+        // dump the size classes with the live data
+        tb_size_t i = 0;
+        for (i = 0; i < stat->class_count; i++)
+        {
+            tb_allocator_class_stat_t const* class_stat = &stat->classes[i];
+            if (class_stat->live_count) tb_trace_i("stat: class[%lu]: live: %lu, cached: %lu, occupied: %lu bytes", class_stat->space, class_stat->live_count, class_stat->cached_count, class_stat->occupied_size);
+        }
+
+        // all data must be counted
+        tb_check_break(stat->live_count >= live_count + TB_DEMO_DATA_COUNT && stat->live_size > live_size && stat->peak_size >= stat->live_size);
+
+        // free data
+        tb_demo_heap_profiler_free(list, TB_DEMO_DATA_COUNT);
+
+        // get the statistics after freeing data
+        tb_memset(stat, 0, sizeof(tb_allocator_stat_t));
+        if (!tb_allocator_stat(tb_allocator(), stat)) break;
+
+        // all data must be freed
+        tb_check_break(stat->live_count == live_count);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // exit the statistics
+    tb_free(stat);
+
+    // ok?
+    return ok;
+}
+static tb_bool_t tb_demo_heap_profiler_dump(tb_pointer_t* list)
+{
+    // the profile path
+    tb_char_t temp[TB_PATH_MAXN];
+    tb_char_t path[TB_PATH_MAXN];
+    if (!tb_directory_temporary(temp, sizeof(temp))) return tb_false;
+    tb_snprintf(path, sizeof(path), "%s/demo.heap", temp);
+
+    // start the heap profiler, we sample one data for every 4KB on average
+    if (!tb_heap_profiler_start(tb_null, 4096)) return tb_false;
+
+    // done
+    tb_bool_t       ok = tb_false;
+    tb_file_ref_t   file = tb_null;
+    do
+    {
+        // make data
+        tb_demo_heap_profiler_make(list, TB_DEMO_DATA_COUNT);
+
+        // dump the live heap profile, we can view it by `pprof --text ./demo /tmp/demo.heap`
+        if (!tb_heap_profiler_dump(tb_null, path)) break;
+
+        // read the header of the profile
+        file = tb_file_init(path, TB_FILE_MODE_RO);
+        tb_check_break(file);
+
+        tb_char_t   line[256];
+        tb_long_t   real = tb_file_read(file, (tb_byte_t*)line, sizeof(line) - 1);
+        tb_check_break(real > 0);
+        line[real] = '\0';
+
+        // get the first line
+        tb_char_t* e = tb_strchr(line, '\n');
+        if (e) *e = '\0';
+
+        // trace
+        tb_trace_i("dump: %s: %s", path, line);
+
+        // some data must be sampled, .e.g "heap profile:  10:  10240 [ 10:  10240] @ heap_v2/4096"
+        tb_check_break(!tb_strncmp(line, "heap profile:", 13));
+        tb_char_t const* p = line + 13;
+        while (tb_isspace(*p)) p++;
+        tb_check_break(tb_s10tou32(p));
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // exit file
+    if (file) tb_file_exit(file);
+
+    // free data
+    tb_demo_heap_profiler_free(list, TB_DEMO_DATA_COUNT);
+
+    // stop the heap profiler
+    tb_heap_profiler_stop(tb_null);
+
+    // ok?
+    return ok;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */
+tb_int_t tb_demo_memory_heap_profiler_main(tb_int_t argc, tb_char_t** argv)
+{
+    // init the data list
+    tb_pointer_t* list = tb_nalloc0_type(TB_DEMO_DATA_COUNT, tb_pointer_t);
+    if (list)
+    {
+        // get the allocator statistics and dump the heap profile
+        tb_bool_t stat = tb_demo_heap_profiler_stat(list);
+        tb_bool_t dump = tb_demo_heap_profiler_dump(list);
+        tb_trace_i("stat: %s, dump: %s", stat? "ok" : "failed", dump? "ok" : "failed");
+
+        // exit the data list
+        tb_free(list);
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the strings count
+#define TB_DEMO_STRING_COUNT        (10000)
+
+// the loop count for each thread
+#ifdef __tb_debug__
+#   define TB_DEMO_LOOP_COUNT       (100)
+#else
+#   define TB_DEMO_LOOP_COUNT       (1000)
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the demo context type
+typedef struct __tb_demo_context_t
+{
+    // the intern pool
+    tb_intern_pool_ref_t        pool;
+
+    // the strings
+    tb_char_t                   strings[TB_DEMO_STRING_COUNT][16];
+
+    // the interned strings of the first thread
+    tb_char_t const*            interned[TB_DEMO_STRING_COUNT];
+
+    // the failed count
+    tb_atomic_t                 failed;
+
+}tb_demo_context_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+static tb_void_t tb_demo_intern_pool_test()
+{
+    // init pool
+    tb_intern_pool_ref_t pool = tb_intern_pool_init(tb_false);
+    tb_assert_and_check_return(pool);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // intern the header names
+        tb_char_t const* name = tb_intern_pool_insert(pool, "Content-Type");
+        tb_assert_and_check_break(name && !tb_strcmp(name, "Content-Type"));
+        tb_assert_and_check_break(name == tb_intern_pool_insert(pool, "content-type"));
+        tb_assert_and_check_break(name == tb_intern_pool_insert_with_size(pool, "CONTENT-TYPE: text/html", 12));
+        tb_assert_and_check_break(name == tb_intern_pool_find(pool, "Content-type"));
+        tb_assert_and_check_break(!tb_intern_pool_find(pool, "Content-Length"));
+
+        // the atom
+        tb_size_t atom = tb_intern_pool_atom(pool, name);
+        tb_assert_and_check_break(atom == 1 && tb_intern_pool_cstr(pool, atom) == name);
+        tb_assert_and_check_break(tb_intern_pool_strlen(pool, name) == 12);
+
+        // intern more strings
+        tb_size_t   i = 0;
+        tb_char_t   data[64];
+        for (i = 0; i < 1000; i++)
+        {
+            tb_snprintf(data, sizeof(data), "key_%lu", i);
+            tb_char_t const* cstr = tb_intern_pool_insert(pool, data);
+            if (!cstr || tb_intern_pool_atom(pool, cstr) != i + 2 || tb_intern_pool_cstr(pool, i + 2) != cstr) break;
+        }
+        tb_assert_and_check_break(i == 1000 && tb_intern_pool_size(pool) == 1001);
+        tb_assert_and_check_break(name == tb_intern_pool_find(pool, "CONTENT-TYPE"));
+
+#ifdef __tb_debug__
+        // dump pool
+        tb_intern_pool_dump(pool);
+#endif
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // trace
+    tb_trace_i("test: %s", ok? "ok" : "failed");
+
+    // exit pool
+    tb_intern_pool_exit(pool);
+}
+static tb_int_t tb_demo_intern_pool_worker(tb_cpointer_t priv)
+{
+    // check
+    tb_demo_context_t* context = (tb_demo_context_t*)priv;
+    tb_assert_and_check_return_val(context, -1);
+
+    // intern all strings in the random order, they should be interned to the same address
+    tb_size_t i = 0;
+    tb_size_t n = TB_DEMO_LOOP_COUNT * TB_DEMO_STRING_COUNT;
+    tb_size_t r = (tb_size_t)tb_thread_self();
+    for (i = 0; i < n; i++)
+    {
+        r = r * 1103515245 + 12345;
+        tb_size_t           index = (r >> 8) % TB_DEMO_STRING_COUNT;
+        tb_char_t const*    cstr = tb_intern_pool_insert(context->pool, context->strings[index]);
+        if (!cstr || tb_strcmp(cstr, context->strings[index])) tb_atomic_fetch_and_inc(&context->failed);
+    }
+    return 0;
+}
+static tb_void_t tb_demo_intern_pool_perf(tb_size_t count)
+{
+    // make context
+    tb_demo_context_t* context = tb_malloc0_type(tb_demo_context_t);
+    tb_assert_and_check_return(context);
+
+    // init pool
+    context->pool = tb_intern_pool_init(tb_true);
+    tb_assert_and_check_return(context->pool);
+
+    // init strings
+    tb_size_t i = 0;
+    for (i = 0; i < TB_DEMO_STRING_COUNT; i++) tb_snprintf(context->strings[i], sizeof(context->strings[i]), "string_%lu", i);
+
+    // start threads
+    tb_thread_ref_t threads[64] = {0};
+    tb_hong_t       t = tb_mclock();
+    tb_assert(count <= tb_arrayn(threads));
+    for (i = 0; i < count; i++) threads[i] = tb_thread_init(tb_null, tb_demo_intern_pool_worker, context, 0);
+
+    // wait threads
+    for (i = 0; i < count; i++)
+    {
+        if (threads[i])
+        {
+            tb_thread_wait(threads[i], -1, tb_null);
+            tb_thread_exit(threads[i]);
+        }
+    }
+    t = tb_mclock() - t;
+
+    // check the interned strings
+    for (i = 0; i < TB_DEMO_STRING_COUNT; i++)
+    {
+        tb_char_t const* cstr = tb_intern_pool_find(context->pool, context->strings[i]);
+        if (!cstr || tb_intern_pool_cstr(context->pool, tb_intern_pool_atom(context->pool, cstr)) != cstr) break;
+    }
+
+    // trace
+    tb_trace_i("intern_pool: threads: %lu, inserts: %lu, %lld ms, %s", count, count * TB_DEMO_LOOP_COUNT * TB_DEMO_STRING_COUNT, t
+            , (!context->failed && i == TB_DEMO_STRING_COUNT && tb_intern_pool_size(context->pool) == TB_DEMO_STRING_COUNT)? "ok" : "failed");
+
+    // exit pool
+    tb_intern_pool_exit(context->pool);
+    tb_free(context);
+}
+static tb_void_t tb_demo_string_pool_perf()
+{
+    // init pool
+    tb_string_pool_ref_t pool = tb_string_pool_init(tb_true);
+    tb_assert_and_check_return(pool);
+
+    // init strings
+    tb_size_t i = 0;
+    tb_char_t (*strings)[16] = (tb_char_t (*)[16])tb_malloc(TB_DEMO_STRING_COUNT * 16);
+    tb_assert_and_check_return(strings);
+    for (i = 0; i < TB_DEMO_STRING_COUNT; i++) tb_snprintf(strings[i], 16, "string_%lu", i);
+
+    // insert strings
+    tb_size_t r = 0;
+    tb_size_t n = TB_DEMO_LOOP_COUNT * TB_DEMO_STRING_COUNT;
+    tb_hong_t t = tb_mclock();
+    for (i = 0; i < n; i++)
+    {
+        r = r * 1103515245 + 12345;
+        tb_string_pool_insert(pool, strings[(r >> 8) % TB_DEMO_STRING_COUNT]);
+    }
+    t = tb_mclock() - t;
+
+    // trace
+    tb_trace_i("string_pool: threads: 1, inserts: %lu, %lld ms", n, t);
+
+    // exit pool
+    tb_string_pool_exit(pool);
+    tb_free(strings);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */
+tb_int_t tb_demo_memory_intern_pool_main(tb_int_t argc, tb_char_t** argv)
+{
+    // the threads count
+    tb_size_t n = argv[1]? tb_atoi(argv[1]) : 4;
+    tb_assert_and_check_return_val(n && n <= 64, -1);
+
+    // test items
+    tb_demo_intern_pool_test();
+
+    // test performance
+    tb_demo_string_pool_perf();
+    tb_demo_intern_pool_perf(1);
+    tb_demo_intern_pool_perf(n);
+    return 0;
+}
@@ -159,6 +159,100 @@ tb_void_t tb_demo_large_allocator_real(tb_size_t size)
     // exit pool
     if (pool) tb_allocator_exit(pool);
 }
+static tb_bool_t tb_demo_large_allocator_check(tb_byte_t const* data, tb_size_t size, tb_byte_t value)
+{
+    tb_size_t i = 0;
+    for (i = 0; i < size; i++)
+    {
+        if (data[i] != value) return tb_false;
+    }
+    return tb_true;
+}
+tb_void_t tb_demo_large_allocator_flags(tb_size_t flags);
+tb_void_t tb_demo_large_allocator_flags(tb_size_t flags)
+{
+    // done
+    tb_bool_t           ok = tb_false;
+    tb_size_t           maxn = 128;
+    tb_pointer_t        list[128] = {0};
+    tb_size_t           sizes[128] = {0};
+    tb_allocator_ref_t  pool = tb_null;
+    tb_allocator_stat_t stat;
+    do
+    {
+        // init pool, it will fallback to the native large allocator if the virtual memory is not supported
+        pool = tb_large_allocator_init_with_flags(flags);
+        tb_assert_and_check_break(pool);
+
+        // make data, the small data (<= 512KB) shares the pages of a region and the larger data has its own region
+        tb_size_t i = 0;
+        tb_hong_t time = tb_mclock();
+        for (i = 0; i < maxn; i++)
+        {
+            sizes[i] = (i & 15)? tb_random_range(1, 512 * 1024) : tb_random_range(1024 * 1024, 4096 * 1024);
+            list[i] = tb_allocator_large_malloc(pool, sizes[i], tb_null);
+            tb_assert_and_check_break(list[i]);
+            tb_memset(list[i], (tb_byte_t)i, sizes[i]);
+        }
+        tb_check_break(i == maxn);
+
+        // re-make and re-fill some data, the old data must be kept
+        for (i = 0; i < maxn; i += 8)
+        {
+            tb_byte_t* data = (tb_byte_t*)tb_allocator_large_ralloc(pool, list[i], sizes[i] << 1, tb_null);
+            tb_assert_and_check_break(data);
+            tb_check_break(tb_demo_large_allocator_check(data, sizes[i], (tb_byte_t)i));
+            tb_memset(data + sizes[i], (tb_byte_t)i, sizes[i]);
+            list[i]     = data;
+            sizes[i]    = sizes[i] << 1;
+        }
+        tb_check_break(i >= maxn);
+
+        // free the half data and make them again from the cached regions
+        for (i = 1; i < maxn; i += 2) 
+        {
+            tb_allocator_large_free(pool, list[i]);
+            list[i] = tb_allocator_large_malloc(pool, sizes[i], tb_null);
+            tb_assert_and_check_break(list[i]);
+            tb_memset(list[i], (tb_byte_t)i, sizes[i]);
+        }
+        tb_check_break(i >= maxn);
+
+        // check all data
+        for (i = 0; i < maxn; i++)
+        {
+            tb_check_break(tb_demo_large_allocator_check((tb_byte_t const*)list[i], sizes[i], (tb_byte_t)i));
+        }
+        tb_check_break(i == maxn);
+        time = tb_mclock() - time;
+
+        // check the live data count
+        tb_check_break(tb_allocator_stat(pool, &stat) && stat.live_count == maxn);
+
+        // trace
+        tb_trace_i("flags: %lu: live: %lu bytes, occupied: %lu bytes in %lld ms", flags, stat.live_size, stat.occupied_size, time);
+
+        // free all data
+        for (i = 0; i < maxn; i++)
+        {
+            tb_allocator_large_free(pool, list[i]);
+            list[i] = tb_null;
+        }
+
+        // all data has been freed?
+        tb_check_break(tb_allocator_stat(pool, &stat) && !stat.live_count);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // trace
+    tb_trace_i("flags: %lu: %s", flags, ok? "ok" : "failed");
+
+    // exit pool
+    if (pool) tb_allocator_exit(pool);
+}
 tb_void_t tb_demo_large_allocator_perf(tb_noarg_t);
 tb_void_t tb_demo_large_allocator_perf()
 {
@@ -252,6 +346,12 @@ tb_int_t tb_demo_memory_large_allocator_main(tb_int_t argc, tb_char_t** argv)
     tb_demo_large_allocator_underflow2();
 #endif
 
+#if 1
+    tb_demo_large_allocator_flags(TB_LARGE_ALLOCATOR_FLAG_NONE);
+    tb_demo_large_allocator_flags(TB_LARGE_ALLOCATOR_FLAG_HUGEPAGE);
+    tb_demo_large_allocator_flags(TB_LARGE_ALLOCATOR_FLAG_HUGEPAGE | TB_LARGE_ALLOCATOR_FLAG_NUMA);
+#endif
+
 #if 1
     tb_demo_large_allocator_real(16 * 256);
     tb_demo_large_allocator_real(32 * 256);
@@ -0,0 +1,148 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */ 
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */ 
+static tb_void_t tb_demo_rope_buffer_free(tb_pointer_t data, tb_cpointer_t priv)
+{
+    // trace
+    tb_trace_i("free: %s", (tb_char_t const*)priv);
+}
+static tb_bool_t tb_demo_rope_buffer_check(tb_rope_buffer_ref_t buffer, tb_char_t const* cstr)
+{
+    // read all data
+    tb_char_t data[256];
+    tb_size_t size = tb_rope_buffer_read(buffer, 0, (tb_byte_t*)data, sizeof(data) - 1);
+    data[size] = '\0';
+
+    // trace
+    tb_trace_i("[%lu]: %s", tb_rope_buffer_count(buffer), data);
+
+    // ok?
+    return size == tb_rope_buffer_size(buffer) && !tb_strcmp(data, cstr);
+}
+static tb_void_t tb_demo_rope_buffer_test(tb_char_t const* path)
+{
+    // init buffers
+    tb_rope_buffer_t response;
+    tb_rope_buffer_t other;
+    tb_rope_buffer_init(&response);
+    tb_rope_buffer_init(&other);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // the body data is referred without copying it
+        static tb_char_t body[] = "hello world!";
+        if (!tb_rope_buffer_append_ref(&response, (tb_byte_t*)body, sizeof(body) - 1, tb_demo_rope_buffer_free, "body")) break;
+
+        // prepend the headers
+        tb_char_t const* headers = "HTTP/1.1 200 OK\r\nContent-Length: 12\r\n\r\n";
+        if (!tb_rope_buffer_prepend(&response, (tb_byte_t const*)headers, tb_strlen(headers))) break;
+        tb_assert_and_check_break(tb_demo_rope_buffer_check(&response, "HTTP/1.1 200 OK\r\nContent-Length: 12\r\n\r\nhello world!"));
+
+        // split the body
+        if (!tb_rope_buffer_split(&response, tb_strlen(headers) + 5, &other)) break;
+        tb_assert_and_check_break(tb_demo_rope_buffer_check(&other, " world!"));
+
+        // share the part of the body 
+        if (!tb_rope_buffer_append_rope(&response, &other, 0, 1)) break;
+
+        // append data to the tail block
+        if (!tb_rope_buffer_append(&response, (tb_byte_t const*)"tbox", 4)) break;
+        if (!tb_rope_buffer_append(&response, (tb_byte_t const*)"!", 1)) break;
+        tb_assert_and_check_break(tb_demo_rope_buffer_check(&response, "HTTP/1.1 200 OK\r\nContent-Length: 12\r\n\r\nhello tbox!"));
+        tb_assert_and_check_break(tb_rope_buffer_count(&response) == 4);
+
+        // drop the headers
+        tb_assert_and_check_break(tb_rope_buffer_drop(&response, tb_strlen(headers)) == tb_strlen(headers));
+
+        // splice the other buffer
+        if (!tb_rope_buffer_splice(&response, &other)) break;
+        tb_assert_and_check_break(!tb_rope_buffer_size(&other));
+        tb_assert_and_check_break(tb_demo_rope_buffer_check(&response, "hello tbox! world!"));
+
+        // write all data to the file
+        if (path)
+        {
+            tb_file_ref_t file = tb_file_init(path, TB_FILE_MODE_RW | TB_FILE_MODE_CREAT | TB_FILE_MODE_BINARY | TB_FILE_MODE_TRUNC);
+            if (file)
+            {
+                tb_iovec_t list[16];
+                while (tb_rope_buffer_size(&response))
+                {
+                    tb_size_t count = tb_rope_buffer_iovec(&response, list, tb_arrayn(list));
+                    tb_long_t real = tb_file_writv(file, list, count);
+                    if (real > 0) tb_rope_buffer_drop(&response, real);
+                    else break;
+                }
+                tb_file_exit(file);
+            }
+        }
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // trace
+    tb_trace_i("test: %s", ok? "ok" : "failed");
+
+    // exit buffers
+    tb_rope_buffer_exit(&response);
+    tb_rope_buffer_exit(&other);
+}
+static tb_void_t tb_demo_rope_buffer_perf()
+{
+    // the body
+    tb_size_t   size = 256 * 1024;
+    tb_byte_t*  body = (tb_byte_t*)tb_malloc0(size);
+    tb_assert_and_check_return(body);
+
+    // assemble the responses by tb_buffer
+    tb_size_t   i = 0;
+    tb_size_t   n = 1000;
+    tb_hong_t   t = tb_mclock();
+    for (i = 0; i < n; i++)
+    {
+        tb_buffer_t buffer;
+        tb_buffer_init(&buffer);
+        tb_buffer_memncat(&buffer, (tb_byte_t const*)"HTTP/1.1 200 OK\r\n\r\n", 19);
+        tb_buffer_memncat(&buffer, body, size);
+        tb_buffer_memncat(&buffer, body, size);
+        tb_buffer_exit(&buffer);
+    }
+    t = tb_mclock() - t;
+    tb_trace_i("buffer: %lld ms", t);
+
+    // assemble the responses by tb_rope_buffer
+    t = tb_mclock();
+    for (i = 0; i < n; i++)
+    {
+        tb_rope_buffer_t buffer;
+        tb_rope_buffer_init(&buffer);
+        tb_rope_buffer_append_ref(&buffer, body, size, tb_null, tb_null);
+        tb_rope_buffer_append_ref(&buffer, body, size, tb_null, tb_null);
+        tb_rope_buffer_prepend(&buffer, (tb_byte_t const*)"HTTP/1.1 200 OK\r\n\r\n", 19);
+        tb_rope_buffer_exit(&buffer);
+    }
+    t = tb_mclock() - t;
+    tb_trace_i("rope_buffer: %lld ms", t);
+
+    // exit body
+    tb_free(body);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */ 
+tb_int_t tb_demo_memory_rope_buffer_main(tb_int_t argc, tb_char_t** argv)
+{
+    tb_demo_rope_buffer_test(argv[1]);
+    tb_demo_rope_buffer_perf();
+    return 0;
+}
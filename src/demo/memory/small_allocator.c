@@ -128,6 +128,82 @@ tb_void_t tb_demo_small_allocator_underflow2()
     if (small_allocator) tb_allocator_exit(small_allocator);
     small_allocator = tb_null;
 }
+tb_void_t tb_demo_small_allocator_classes(tb_noarg_t);
+tb_void_t tb_demo_small_allocator_classes()
+{
+    // the size classes for the string-heavy workloads, the 3072 class will be appended
+    static tb_size_t const s_classes[] = {16, 32, 48, 64, 96, 128, 256, 512, 1024, 2048};
+
+    // done
+    tb_bool_t           ok = tb_true;
+    tb_allocator_ref_t  small_allocator = tb_null;
+    tb_allocator_ref_t  custom_allocator = tb_null;
+    do
+    {
+        // init small allocator with the default classes
+        small_allocator = tb_small_allocator_init(tb_null);
+        tb_assert_and_check_break(small_allocator);
+
+        // init small allocator with the custom classes
+        custom_allocator = tb_small_allocator_init_with_classes(tb_null, s_classes, tb_arrayn(s_classes));
+        tb_assert_and_check_break(custom_allocator);
+
+        // check the classes count
+        tb_size_t count = tb_small_allocator_class_count(small_allocator);
+        tb_size_t custom_count = tb_small_allocator_class_count(custom_allocator);
+        tb_trace_i("classes: default: %lu, custom: %lu", count, custom_count);
+        if (custom_count != tb_arrayn(s_classes) + 1) ok = tb_false;
+
+        // check the mapped class of all sizes
+        tb_size_t size = 1;
+        for (size = 1; size <= TB_SMALL_ALLOCATOR_DATA_MAXN && ok; size++)
+        {
+            // the default class must be the smallest class which can hold this size
+            tb_size_t space = 0;
+            tb_size_t index = tb_small_allocator_class(small_allocator, size, &space);
+            if (    index >= count || space < size || space != tb_small_allocator_class_space(small_allocator, index)
+                ||  (index && tb_small_allocator_class_space(small_allocator, index - 1) >= size))
+                ok = tb_false;
+
+            // the wasted space is < 16 bytes or ~12.5% of the data
+            if (size > 128 && space * 8 > size * 9) ok = tb_false;
+
+            // the custom class must be the smallest class which can hold this size too
+            index = tb_small_allocator_class(custom_allocator, size, &space);
+            if (    index >= custom_count || space < size
+                ||  (index && tb_small_allocator_class_space(custom_allocator, index - 1) >= size))
+                ok = tb_false;
+
+            // failed?
+            if (!ok) tb_trace_i("class: size: %lu => index: %lu, space: %lu: failed", size, index, space);
+        }
+
+        // make and free data of all classes
+        tb_pointer_t data[2];
+        for (size = 1; size <= TB_SMALL_ALLOCATOR_DATA_MAXN && ok; size += 7)
+        {
+            data[0] = tb_allocator_malloc(small_allocator, size);
+            data[1] = tb_allocator_malloc(custom_allocator, size);
+            if (data[0]) tb_memset(data[0], 0xff, size);
+            if (data[1]) tb_memset(data[1], 0xff, size);
+            if (!data[0] || !data[1]) ok = tb_false;
+            if (data[0]) tb_allocator_free(small_allocator, data[0]);
+            if (data[1]) tb_allocator_free(custom_allocator, data[1]);
+        }
+
+    } while (0);
+
+    // trace
+    tb_trace_i("classes: %s", (ok && small_allocator && custom_allocator)? "ok" : "failed");
+
+    // exit small allocator
+    if (small_allocator) tb_allocator_exit(small_allocator);
+    small_allocator = tb_null;
+
+    // exit custom allocator
+    if (custom_allocator) tb_allocator_exit(custom_allocator);
+    custom_allocator = tb_null;
+}
 tb_void_t tb_demo_small_allocator_perf(tb_noarg_t);
 tb_void_t tb_demo_small_allocator_perf()
 {
@@ -217,6 +293,10 @@ tb_void_t tb_demo_small_allocator_perf()
  */ 
 tb_int_t tb_demo_memory_small_allocator_main(tb_int_t argc, tb_char_t** argv)
 {
+#if 1
+    tb_demo_small_allocator_classes();
+#endif
+
 #if 1
     tb_demo_small_allocator_perf();
 #endif
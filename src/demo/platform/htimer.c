@@ -0,0 +1,422 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the allowed late time of the expired task, ms
+#define TB_DEMO_HTIMER_PRECISION        (20)
+
+// the maximum called times of the repeating task
+#define TB_DEMO_HTIMER_CALLED_MAXN      (32)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the demo task type
+typedef struct __tb_demo_htimer_task_t
+{
+    // the delay time
+    tb_hong_t           delay;
+
+    // the expected when
+    tb_hong_t           when;
+
+    // the called time
+    tb_hong_t           called[TB_DEMO_HTIMER_CALLED_MAXN];
+
+    // the called count
+    tb_size_t           count;
+
+    // the called order
+    tb_size_t           order;
+
+    // have been killed?
+    tb_bool_t           killed;
+
+}tb_demo_htimer_task_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the called order of all tasks
+static tb_atomic_t      g_order = 0;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * func
+ */
+static tb_hong_t tb_demo_htimer_now()
+{
+    // get the real time, it is same as the time of htimer without ctime
+    tb_timeval_t tv = {0};
+    return tb_gettimeofday(&tv, tb_null)? ((tb_hong_t)tv.tv_sec * 1000 + tv.tv_usec / 1000) : 0;
+}
+static tb_void_t tb_demo_htimer_task_func(tb_bool_t killed, tb_cpointer_t priv)
+{
+    // check
+    tb_demo_htimer_task_t* task = (tb_demo_htimer_task_t*)priv;
+    tb_assert_and_check_return(task);
+
+    // save the called time and order
+    if (task->count < TB_DEMO_HTIMER_CALLED_MAXN) task->called[task->count] = tb_demo_htimer_now();
+    task->order = (tb_size_t)tb_atomic_fetch_and_inc(&g_order);
+    task->killed = killed;
+    task->count++;
+}
+static tb_int_t tb_demo_htimer_loop(tb_cpointer_t priv)
+{
+    // loop timer until it has been killed
+    tb_htimer_loop((tb_htimer_ref_t)priv);
+    return 0;
+}
+static tb_void_t tb_demo_htimer_spak(tb_htimer_ref_t timer, tb_size_t time)
+{
+    // spak the timer for the given time
+    tb_hong_t stop = tb_demo_htimer_now() + time;
+    while (tb_demo_htimer_now() < stop)
+    {
+        tb_size_t delay = tb_htimer_delay(timer);
+        tb_msleep(tb_min(delay, 10));
+        tb_htimer_spak(timer);
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * tests
+ */
+
+/* the tasks will be expired in order when crossing the boundaries of the wheel0, wheel1 and wheel2
+ *
+ * wheel0: [0, 256), wheel1: [256, 16384), wheel2: [16384, 1048576), ...
+ */
+static tb_bool_t tb_demo_htimer_test_cascade()
+{
+    // the delays, they are posted out of order
+    static tb_hong_t delays[] = {16385, 257, 16384, 1, 255, 16383, 256, 0, 4095, 4096, 1000, 16640, 511, 512};
+
+    // init timer with the real time
+    tb_htimer_ref_t timer = tb_htimer_init(0, tb_false);
+    tb_assert_and_check_return_val(timer, tb_false);
+
+    // done
+    tb_bool_t               ok = tb_false;
+    tb_thread_ref_t         loop = tb_null;
+    tb_demo_htimer_task_t   tasks[tb_arrayn(delays)];
+    do
+    {
+        // start the timer loop
+        loop = tb_thread_init(tb_null, tb_demo_htimer_loop, timer, 0);
+        tb_assert_and_check_break(loop);
+
+        // post tasks
+        tb_size_t i = 0;
+        tb_size_t n = tb_arrayn(delays);
+        tb_hong_t maxdelay = 0;
+        tb_hong_t now = tb_demo_htimer_now();
+        tb_memset(tasks, 0, sizeof(tasks));
+        for (i = 0; i < n; i++)
+        {
+            tasks[i].delay = delays[i];
+            tasks[i].when  = now + delays[i];
+            tb_htimer_task_post_at(timer, tasks[i].when, 0, tb_false, tb_demo_htimer_task_func, &tasks[i]);
+            if (delays[i] > maxdelay) maxdelay = delays[i];
+        }
+
+        // wait all tasks
+        tb_msleep((tb_long_t)maxdelay + 200);
+
+        // check precision
+        for (i = 0; i < n; i++)
+        {
+            // trace
+            tb_trace_i("cascade: delay: %lld ms, late: %lld ms, count: %lu", tasks[i].delay, tasks[i].called[0] - tasks[i].when, tasks[i].count);
+
+            // check it
+            if (tasks[i].count != 1 || tasks[i].killed) break;
+            if (tasks[i].called[0] < tasks[i].when || tasks[i].called[0] > tasks[i].when + TB_DEMO_HTIMER_PRECISION) break;
+        }
+        tb_check_break(i == n);
+
+        // check order, the earlier task must be called first
+        tb_size_t j = 0;
+        for (i = 0; i < n; i++)
+        {
+            for (j = 0; j < n; j++)
+            {
+                if (tasks[i].when < tasks[j].when && tasks[i].order > tasks[j].order) break;
+            }
+            if (j < n) break;
+        }
+        tb_check_break(i == n);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // kill the timer loop
+    tb_htimer_kill(timer);
+    if (loop)
+    {
+        // the loop must be exited after killing it
+        if (tb_thread_wait(loop, 1000, tb_null) <= 0) ok = tb_false;
+        tb_thread_exit(loop);
+    }
+
+    // exit timer
+    tb_htimer_exit(timer);
+
+    // trace
+    tb_trace_i("cascade: %s", ok? "ok" : "failed");
+    return ok;
+}
+
+/* the long tasks will be placed at the upper wheels, wheel3: [2^20, 2^26), wheel4: [2^26, 2^32),
+ * and the longer tasks (>= 2^32) will be placed at the end of the wheel4 and cascaded again.
+ *
+ * we cannot wait them, so we check the cascaded time of the top task and kill them.
+ */
+static tb_bool_t tb_demo_htimer_test_levels()
+{
+    // the delays across the upper boundaries
+    static tb_hong_t delays[] =
+    {
+        255
+    ,   256
+    ,   ((tb_hong_t)1 << 14) - 1
+    ,   ((tb_hong_t)1 << 14)
+    ,   ((tb_hong_t)1 << 20) - 1
+    ,   ((tb_hong_t)1 << 20)
+    ,   ((tb_hong_t)1 << 26) - 1
+    ,   ((tb_hong_t)1 << 26)
+    ,   ((tb_hong_t)1 << 32) - 1
+    ,   ((tb_hong_t)1 << 32)
+    ,   ((tb_hong_t)1 << 32) + 1000
+    ,   ((tb_hong_t)1 << 40)
+    };
+
+    // init timer with the cached time, the time will be not changed if we do not spak it
+    tb_cache_time_spak();
+    tb_htimer_ref_t timer = tb_htimer_init(0, tb_true);
+    tb_assert_and_check_return_val(timer, tb_false);
+
+    // done
+    tb_size_t i = 0;
+    tb_size_t n = tb_arrayn(delays);
+    for (i = 0; i < n; i++)
+    {
+        // post a long task
+        tb_demo_htimer_task_t task = {0};
+        tb_hong_t now = tb_cache_time_mclock();
+        task.delay = delays[i];
+        task.when  = now + delays[i];
+        tb_htimer_task_ref_t timer_task = tb_htimer_task_init_at(timer, task.when, 0, tb_false, tb_demo_htimer_task_func, &task);
+        tb_assert_and_check_break(timer_task);
+
+        // compute the expected cascaded time of this task
+        tb_size_t level = 0;
+        tb_hong_t expires = delays[i] < ((tb_hong_t)1 << 32)? task.when : now + ((tb_hong_t)1 << 32) - 1;
+        tb_hong_t delta = expires - now;
+        if (delta >= ((tb_hong_t)1 << 26)) level = 4;
+        else if (delta >= ((tb_hong_t)1 << 20)) level = 3;
+        else if (delta >= ((tb_hong_t)1 << 14)) level = 2;
+        else if (delta >= 256) level = 1;
+        tb_size_t shift = level? 8 + 6 * (level - 1) : 0;
+        tb_hong_t top = (tb_hong_t)tb_htimer_top(timer);
+
+        // trace
+        tb_trace_i("levels: delay: %lld ms, level: %lu, top: +%lld ms", task.delay, level, top - now);
+
+        // check the top time
+        tb_check_break(top == ((expires >> shift) << shift));
+
+        // it will be not expired now
+        tb_htimer_spak(timer);
+        tb_check_break(!task.count);
+
+        // kill it, it will be called at the next spak
+        tb_htimer_task_kill(timer, timer_task);
+        tb_htimer_spak(timer);
+        tb_htimer_task_exit(timer, timer_task);
+        tb_check_break(task.count == 1 && task.killed);
+    }
+
+    // exit timer
+    tb_htimer_exit(timer);
+
+    // trace
+    tb_trace_i("levels: %s", i == n? "ok" : "failed");
+    return i == n;
+}
+
+// cancel or kill the expired tasks
+static tb_bool_t tb_demo_htimer_test_cancel()
+{
+    // init timer with the real time
+    tb_htimer_ref_t timer = tb_htimer_init(0, tb_false);
+    tb_assert_and_check_return_val(timer, tb_false);
+
+    // done
+    tb_bool_t               ok = tb_false;
+    tb_demo_htimer_task_t   task;
+    tb_htimer_task_ref_t    timer_task = tb_null;
+    do
+    {
+        // exit the expired task before spaking it, it will be never called
+        tb_memset(&task, 0, sizeof(task));
+        timer_task = tb_htimer_task_init(timer, 10, tb_false, tb_demo_htimer_task_func, &task);
+        tb_assert_and_check_break(timer_task);
+        tb_msleep(30);
+        tb_htimer_task_exit(timer, timer_task);
+        tb_demo_htimer_spak(timer, 30);
+        tb_check_break(!task.count);
+
+        // exit the task after it has been called
+        tb_memset(&task, 0, sizeof(task));
+        timer_task = tb_htimer_task_init(timer, 10, tb_false, tb_demo_htimer_task_func, &task);
+        tb_assert_and_check_break(timer_task);
+        tb_demo_htimer_spak(timer, 50);
+        tb_check_break(task.count == 1 && !task.killed);
+        tb_htimer_task_exit(timer, timer_task);
+        tb_demo_htimer_spak(timer, 30);
+        tb_check_break(task.count == 1);
+
+        // kill the expired task before spaking it, it will be called once
+        tb_memset(&task, 0, sizeof(task));
+        timer_task = tb_htimer_task_init(timer, 10, tb_false, tb_demo_htimer_task_func, &task);
+        tb_assert_and_check_break(timer_task);
+        tb_msleep(30);
+        tb_htimer_task_kill(timer, timer_task);
+        tb_demo_htimer_spak(timer, 30);
+        tb_check_break(task.count == 1);
+
+        // kill it again after it has been called, it will be not called again
+        tb_htimer_task_kill(timer, timer_task);
+        tb_demo_htimer_spak(timer, 30);
+        tb_htimer_task_exit(timer, timer_task);
+        tb_check_break(task.count == 1);
+
+        // kill the pending task, it will be called immediately
+        tb_memset(&task, 0, sizeof(task));
+        timer_task = tb_htimer_task_init(timer, 10000, tb_false, tb_demo_htimer_task_func, &task);
+        tb_assert_and_check_break(timer_task);
+        tb_htimer_task_kill(timer, timer_task);
+        tb_check_break(!tb_htimer_delay(timer));
+        tb_htimer_spak(timer);
+        tb_htimer_task_exit(timer, timer_task);
+        tb_check_break(task.count == 1 && task.killed);
+
+        // no more tasks
+        tb_check_break(tb_htimer_delay(timer) == (tb_size_t)-1);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // exit timer
+    tb_htimer_exit(timer);
+
+    // trace
+    tb_trace_i("cancel: %s", ok? "ok" : "failed");
+    return ok;
+}
+
+// the repeating tasks
+static tb_bool_t tb_demo_htimer_test_repeat()
+{
+    // init timer with the real time
+    tb_htimer_ref_t timer = tb_htimer_init(0, tb_false);
+    tb_assert_and_check_return_val(timer, tb_false);
+
+    // done
+    tb_bool_t               ok = tb_false;
+    tb_demo_htimer_task_t   task;
+    tb_demo_htimer_task_t   killed;
+    tb_htimer_task_ref_t    timer_task = tb_null;
+    tb_htimer_task_ref_t    killed_task = tb_null;
+    do
+    {
+        // init a repeating task and a repeating task for killing
+        tb_memset(&task, 0, sizeof(task));
+        tb_memset(&killed, 0, sizeof(killed));
+        task.delay = 50;
+        task.when = tb_demo_htimer_now() + task.delay;
+        timer_task = tb_htimer_task_init(timer, (tb_size_t)task.delay, tb_true, tb_demo_htimer_task_func, &task);
+        killed_task = tb_htimer_task_init(timer, 20, tb_true, tb_demo_htimer_task_func, &killed);
+        tb_assert_and_check_break(timer_task && killed_task);
+
+        // spak it for 10 periods
+        tb_demo_htimer_spak(timer, (tb_size_t)task.delay * 10 + 25);
+
+        // kill the second task, it will be not repeated
+        tb_size_t count = killed.count;
+        tb_htimer_task_kill(timer, killed_task);
+
+        // exit the first task, it will be not called again
+        tb_htimer_task_exit(timer, timer_task);
+        timer_task = tb_null;
+        tb_size_t called = task.count;
+        tb_demo_htimer_spak(timer, 200);
+
+        // trace
+        tb_trace_i("repeat: count: %lu, killed: %lu => %lu", task.count, count, killed.count);
+
+        // check count
+        tb_check_break(called == task.count && called >= 9 && called <= 10);
+        tb_check_break(killed.count == count + 1 && killed.killed);
+
+        // check periods
+        tb_size_t i = 0;
+        tb_hong_t when = task.when;
+        for (i = 0; i < called; i++)
+        {
+            // trace
+            tb_trace_i("repeat: [%lu]: late: %lld ms", i, task.called[i] - when);
+
+            // check it
+            if (task.called[i] < when || task.called[i] > when + TB_DEMO_HTIMER_PRECISION) break;
+
+            // the next period is started from the called time
+            when = task.called[i] + task.delay;
+        }
+        tb_check_break(i == called);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // exit tasks
+    if (timer_task) tb_htimer_task_exit(timer, timer_task);
+    if (killed_task) tb_htimer_task_exit(timer, killed_task);
+
+    // exit timer
+    tb_htimer_exit(timer);
+
+    // trace
+    tb_trace_i("repeat: %s", ok? "ok" : "failed");
+    return ok;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */
+tb_int_t tb_demo_platform_htimer_main(tb_int_t argc, tb_char_t** argv)
+{
+    // test it
+    tb_bool_t ok = tb_true;
+    if (!tb_demo_htimer_test_levels()) ok = tb_false;
+    if (!tb_demo_htimer_test_cancel()) ok = tb_false;
+    if (!tb_demo_htimer_test_repeat()) ok = tb_false;
+    if (!tb_demo_htimer_test_cascade()) ok = tb_false;
+
+    // trace
+    tb_trace_i("htimer: %s", ok? "ok" : "failed");
+    return ok? 0 : -1;
+}
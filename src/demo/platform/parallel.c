@@ -0,0 +1,163 @@
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "../demo.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the items count
+#define TB_DEMO_ITEM_COUNT          (1000000)
+
+// the work nodes count of the killed task graph
+#define TB_DEMO_KILL_COUNT          (64)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * test
+ */ 
+static tb_void_t tb_demo_parallel_for(tb_size_t start, tb_size_t end, tb_cpointer_t priv)
+{
+    tb_size_t   i = 0;
+    tb_size_t*  data = (tb_size_t*)priv;
+    for (i = start; i < end; i++) data[i] = i;
+}
+static tb_void_t tb_demo_parallel_reduce(tb_size_t start, tb_size_t end, tb_pointer_t result, tb_cpointer_t priv)
+{
+    tb_size_t           i = 0;
+    tb_size_t const*    data = (tb_size_t const*)priv;
+    for (i = start; i < end; i++) *((tb_hize_t*)result) += data[i];
+}
+static tb_void_t tb_demo_parallel_join(tb_pointer_t result, tb_cpointer_t other, tb_cpointer_t priv)
+{
+    *((tb_hize_t*)result) += *((tb_hize_t const*)other);
+}
+static tb_void_t tb_demo_task_graph_done(tb_cpointer_t priv)
+{
+    // trace
+    tb_trace_i("task: %s", (tb_char_t const*)priv);
+
+    // wait some time
+    tb_msleep(10);
+}
+static tb_void_t tb_demo_task_graph_work(tb_cpointer_t priv)
+{
+    // the context: pool, kill index, done count
+    tb_value_ref_t context = (tb_value_ref_t)priv;
+
+    // done it
+    tb_size_t index = (tb_size_t)tb_atomic_fetch_and_inc(&context[2].l);
+    tb_msleep(5);
+
+    // kill the thread pool when some tasks are still waiting
+    if (index == context[1].ul) tb_thread_pool_kill((tb_thread_pool_ref_t)context[0].ptr);
+}
+static tb_void_t tb_demo_task_graph_kill(tb_size_t flags)
+{
+    // init pool
+    tb_thread_pool_ref_t pool = tb_thread_pool_init_with_flags(2, 0, flags);
+    tb_assert_and_check_return(pool);
+
+    // init task graph
+    tb_task_graph_ref_t graph = tb_task_graph_init(pool);
+    if (graph)
+    {
+        // the context: pool, kill index, done count
+        tb_value_t context[3];
+        context[0].ptr = (tb_pointer_t)pool;
+        context[1].ul  = 4;
+        context[2].l   = 0;
+
+        // add tasks: start -> work x N -> save
+        tb_task_graph_node_ref_t start = tb_task_graph_node(graph, "start", tb_demo_task_graph_work, context);
+        tb_task_graph_node_ref_t save  = tb_task_graph_node(graph, "save", tb_demo_task_graph_work, context);
+        tb_size_t i = 0;
+        for (i = 0; i < TB_DEMO_KILL_COUNT; i++)
+        {
+            tb_task_graph_node_ref_t work = tb_task_graph_node(graph, "work", tb_demo_task_graph_work, context);
+            tb_task_graph_depend(graph, work, start);
+            tb_task_graph_depend(graph, save, work);
+        }
+
+        // run it, it will be not blocked and return failed because some tasks have been killed
+        tb_hong_t time = tb_mclock();
+        tb_bool_t ok = tb_task_graph_run(graph);
+        time = tb_mclock() - time;
+
+        // trace
+        tb_size_t done = (tb_size_t)context[2].l;
+        tb_trace_i("graph: kill: %s, done: %lu/%lu, %lld ms, %s", (flags & TB_THREAD_POOL_FLAG_WORK_STEALING)? "stealing" : "normal"
+            , done, TB_DEMO_KILL_COUNT + 2, time, !ok && done < TB_DEMO_KILL_COUNT + 2? "ok" : "failed");
+
+        // exit it
+        tb_task_graph_exit(graph);
+    }
+
+    // exit pool
+    tb_thread_pool_exit(pool);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * main
+ */ 
+tb_int_t tb_demo_platform_parallel_main(tb_int_t argc, tb_char_t** argv)
+{
+    // init data
+    tb_size_t* data = tb_nalloc0_type(TB_DEMO_ITEM_COUNT, tb_size_t);
+    tb_assert_and_check_return_val(data, -1);
+
+    // parallel for
+    tb_hong_t time = tb_mclock();
+    tb_parallel_for(tb_null, 0, TB_DEMO_ITEM_COUNT, 0, tb_demo_parallel_for, data);
+    time = tb_mclock() - time;
+
+    // trace
+    tb_trace_i("for: %lld ms", time);
+
+    // parallel reduce
+    tb_hize_t sum = 0;
+    time = tb_mclock();
+    tb_parallel_reduce(tb_null, 0, TB_DEMO_ITEM_COUNT, 0, &sum, sizeof(sum), tb_demo_parallel_reduce, tb_demo_parallel_join, data);
+    time = tb_mclock() - time;
+
+    // trace
+    tb_trace_i("reduce: %llu, %lld ms, %s", sum, time, sum == (tb_hize_t)TB_DEMO_ITEM_COUNT * (TB_DEMO_ITEM_COUNT - 1) / 2? "ok" : "failed");
+
+    // exit data
+    tb_free(data);
+
+    // init task graph
+    tb_task_graph_ref_t graph = tb_task_graph_init(tb_null);
+    if (graph)
+    {
+        // add tasks
+        tb_task_graph_node_ref_t load  = tb_task_graph_node(graph, "load", tb_demo_task_graph_done, "load");
+        tb_task_graph_node_ref_t parse = tb_task_graph_node(graph, "parse", tb_demo_task_graph_done, "parse");
+        tb_task_graph_node_ref_t fetch = tb_task_graph_node(graph, "fetch", tb_demo_task_graph_done, "fetch");
+        tb_task_graph_node_ref_t merge = tb_task_graph_node(graph, "merge", tb_demo_task_graph_done, "merge");
+        tb_task_graph_node_ref_t save  = tb_task_graph_node(graph, "save", tb_demo_task_graph_done, "save");
+
+        // add dependences
+        tb_task_graph_depend(graph, parse, load);
+        tb_task_graph_depend(graph, fetch, load);
+        tb_task_graph_depend(graph, merge, parse);
+        tb_task_graph_depend(graph, merge, fetch);
+        tb_task_graph_depend(graph, save, merge);
+
+        // run it
+        time = tb_mclock();
+        tb_bool_t ok = tb_task_graph_run(graph);
+        time = tb_mclock() - time;
+
+        // trace
+        tb_trace_i("graph: %lld ms, %s", time, ok? "ok" : "failed");
+
+        // exit it
+        tb_task_graph_exit(graph);
+    }
+
+    // kill the thread pool when running the task graph
+    tb_demo_task_graph_kill(TB_THREAD_POOL_FLAG_NONE);
+    tb_demo_task_graph_kill(TB_THREAD_POOL_FLAG_WORK_STEALING);
+    return 0;
+}
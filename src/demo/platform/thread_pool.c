@@ -3,9 +3,188 @@
  */
 #include "../demo.h"
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the posting threads count
+#define TB_DEMO_POST_THREADS        (4)
+
+// the posted tasks count of each thread
+#define TB_DEMO_POST_COUNT          (20000)
+
+// the parent tasks count, each parent task will post a child task from the worker if (index & 3) == 0
+#define TB_DEMO_TASK_PARENTS        (TB_DEMO_POST_THREADS * TB_DEMO_POST_COUNT)
+
+// the maximum tasks count
+#define TB_DEMO_TASK_MAXN           (TB_DEMO_TASK_PARENTS << 1)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the many tasks test type
+typedef struct __tb_demo_tasks_t
+{
+    // the thread pool
+    tb_thread_pool_ref_t    pool;
+
+    // the posted flags of all tasks
+    tb_atomic_t*            posted;
+
+    // the done count of all tasks
+    tb_atomic_t*            dones;
+
+    // the exit count of all tasks
+    tb_atomic_t*            exits;
+
+    // the done tasks count
+    tb_atomic_t             done;
+
+}tb_demo_tasks_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the many tasks test
+static tb_demo_tasks_t      g_tasks;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * test
  */ 
+static tb_void_t tb_demo_task_small_exit(tb_thread_pool_worker_ref_t worker, tb_cpointer_t priv)
+{
+    // it will be called once for the finished or killed task
+    tb_atomic_fetch_and_inc(&g_tasks.exits[(tb_size_t)priv]);
+}
+static tb_void_t tb_demo_task_small_done(tb_thread_pool_worker_ref_t worker, tb_cpointer_t priv)
+{
+    // done it
+    tb_size_t index = (tb_size_t)priv;
+    tb_atomic_fetch_and_inc(&g_tasks.dones[index]);
+    tb_atomic_fetch_and_inc(&g_tasks.done);
+
+    // post a child task from the worker, it will be pushed to the deque of this worker and stolen by the others
+    if (index < TB_DEMO_TASK_PARENTS && !(index & 3))
+    {
+        tb_size_t child = TB_DEMO_TASK_PARENTS + index;
+        if (tb_thread_pool_task_post(g_tasks.pool, tb_null, tb_demo_task_small_done, tb_demo_task_small_exit, (tb_cpointer_t)child, tb_false))
+            tb_atomic_set(&g_tasks.posted[child], 1);
+    }
+}
+static tb_int_t tb_demo_task_small_post(tb_cpointer_t priv)
+{
+    // post tasks one by one and in batches
+    tb_size_t i = 0;
+    tb_size_t base = (tb_size_t)priv * TB_DEMO_POST_COUNT;
+    while (i < TB_DEMO_POST_COUNT)
+    {
+        if (i & 1)
+        {
+            // post one task
+            if (tb_thread_pool_task_post(g_tasks.pool, tb_null, tb_demo_task_small_done, tb_demo_task_small_exit, (tb_cpointer_t)(base + i), tb_false))
+                tb_atomic_set(&g_tasks.posted[base + i], 1);
+            i++;
+        }
+        else
+        {
+            // post a task list
+            tb_size_t               j = 0;
+            tb_size_t               n = tb_min(16, TB_DEMO_POST_COUNT - i);
+            tb_thread_pool_task_t   list[16];
+            for (j = 0; j < n; j++)
+            {
+                list[j].name    = tb_null;
+                list[j].done    = tb_demo_task_small_done;
+                list[j].exit    = tb_demo_task_small_exit;
+                list[j].priv    = (tb_cpointer_t)(base + i + j);
+                list[j].urgent  = !((i + j) & 63);
+            }
+            n = tb_thread_pool_task_post_list(g_tasks.pool, list, n);
+            for (j = 0; j < n; j++) tb_atomic_set(&g_tasks.posted[base + i + j], 1);
+            i += 16;
+        }
+    }
+    return 0;
+}
+static tb_void_t tb_demo_task_small(tb_size_t flags, tb_bool_t kill)
+{
+    // init the task states
+    g_tasks.posted  = tb_nalloc0_type(TB_DEMO_TASK_MAXN, tb_atomic_t);
+    g_tasks.dones   = tb_nalloc0_type(TB_DEMO_TASK_MAXN, tb_atomic_t);
+    g_tasks.exits   = tb_nalloc0_type(TB_DEMO_TASK_MAXN, tb_atomic_t);
+    g_tasks.pool    = tb_thread_pool_init_with_flags(4, 0, flags);
+    tb_atomic_set0(&g_tasks.done);
+    if (g_tasks.pool && g_tasks.posted && g_tasks.dones && g_tasks.exits)
+    {
+        // post many small tasks from several threads
+        tb_size_t       i = 0;
+        tb_hong_t       time = tb_mclock();
+        tb_thread_ref_t threads[TB_DEMO_POST_THREADS];
+        for (i = 0; i < TB_DEMO_POST_THREADS; i++)
+            threads[i] = tb_thread_init(tb_null, tb_demo_task_small_post, (tb_cpointer_t)i, 0);
+
+        // kill the pool while posting and stealing tasks, after some tasks have been done
+        if (kill)
+        {
+            tb_size_t wait = 0;
+            while (tb_atomic_get(&g_tasks.done) < TB_DEMO_TASK_PARENTS / 8 && wait++ < 5000) tb_msleep(1);
+            tb_thread_pool_kill(g_tasks.pool);
+        }
+
+        // wait all posting threads
+        for (i = 0; i < TB_DEMO_POST_THREADS; i++)
+        {
+            if (threads[i])
+            {
+                tb_thread_wait(threads[i], -1, tb_null);
+                tb_thread_exit(threads[i]);
+            }
+        }
+
+        // wait all tasks and exit the pool, the remaining tasks will be killed
+        if (!kill) tb_thread_pool_task_wait_all(g_tasks.pool, -1);
+        tb_bool_t ok = tb_thread_pool_exit(g_tasks.pool);
+        g_tasks.pool = tb_null;
+        time = tb_mclock() - time;
+
+        /* check the task states
+         *
+         * all posted tasks must be exited once and done at most once, 
+         * and all tasks must be done if we do not kill the pool.
+         */
+        tb_size_t posted = 0;
+        tb_size_t done = 0;
+        for (i = 0; i < TB_DEMO_TASK_MAXN; i++)
+        {
+            tb_long_t dones = tb_atomic_get(&g_tasks.dones[i]);
+            tb_long_t exits = tb_atomic_get(&g_tasks.exits[i]);
+            if (tb_atomic_get(&g_tasks.posted[i]))
+            {
+                posted++;
+                if (dones == 1) done++;
+                if (exits != 1 || dones > 1 || (!kill && dones != 1)) ok = tb_false;
+            }
+            else if (dones || exits) ok = tb_false;
+        }
+
+        // trace
+        tb_trace_i("small: %s%s: posted: %lu, done: %lu, killed: %lu in %lld ms: %s", (flags & TB_THREAD_POOL_FLAG_WORK_STEALING)? "stealing" : "normal", kill? ", kill" : "", posted, done, posted - done, time, ok? "ok" : "failed");
+    }
+
+    // exit the pool
+    if (g_tasks.pool) tb_thread_pool_exit(g_tasks.pool);
+    g_tasks.pool = tb_null;
+
+    // exit the task states
+    if (g_tasks.posted) tb_free(g_tasks.posted);
+    if (g_tasks.dones) tb_free(g_tasks.dones);
+    if (g_tasks.exits) tb_free(g_tasks.exits);
+    g_tasks.posted  = tb_null;
+    g_tasks.dones   = tb_null;
+    g_tasks.exits   = tb_null;
+}
 static tb_void_t tb_demo_task_time_done(tb_thread_pool_worker_ref_t worker, tb_cpointer_t priv)
 {
     // trace
@@ -71,6 +250,14 @@ tb_int_t tb_demo_platform_thread_pool_main(tb_int_t argc, tb_char_t** argv)
 
 #endif
 
+    // post many small tasks from several threads and check that each task is done exactly once
+    tb_demo_task_small(TB_THREAD_POOL_FLAG_NONE, tb_false);
+    tb_demo_task_small(TB_THREAD_POOL_FLAG_WORK_STEALING, tb_false);
+
+    // kill the pool while posting and stealing tasks
+    tb_demo_task_small(TB_THREAD_POOL_FLAG_NONE, tb_true);
+    tb_demo_task_small(TB_THREAD_POOL_FLAG_WORK_STEALING, tb_true);
+
     // trace
     tb_trace_i("end");
     return 0;
@@ -39,6 +39,9 @@
 #include "sort.h"
 #include "heap_sort.h"
 #include "quick_sort.h"
+#include "intro_sort.h"
+#include "merge_sort.h"
+#include "parallel_sort.h"
 #include "insert_sort.h"
 #include "bubble_sort.h"
 #include "find.h"
@@ -0,0 +1,343 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        intro_sort.c
+ * @ingroup     algorithm
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "intro_sort.h"
+#include "heap_sort.h"
+#include "../libc/libc.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the range will be sorted by the insertion sorter if it is smaller than this
+#define TB_INTRO_SORT_INSERT_MAXN           (24)
+
+// the pivot is the median of the three medians (ninther) if the range is larger than this
+#define TB_INTRO_SORT_NINTHER_MINN          (128)
+
+// the maximum moved items count of the partial insertion sorter
+#define TB_INTRO_SORT_PARTIAL_MOVES         (8)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the intro sorter type
+typedef struct __tb_intro_sort_t
+{
+    // the iterator
+    tb_iterator_ref_t       iterator;
+
+    // the comparer
+    tb_iterator_comp_t      comp;
+
+    // the item step
+    tb_size_t               step;
+
+    // the temporary items for the large item, swap + hole + pivot
+    tb_byte_t*              temp;
+
+}tb_intro_sort_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+
+/* save the item to the temporary space (0: swap, 1: hole, 2: pivot) and get the saved item
+ *
+ * the small item is saved as the item value and the large item is copied to the temporary buffer
+ */
+static __tb_inline__ tb_cpointer_t tb_intro_sort_save(tb_intro_sort_t* sort, tb_size_t itor, tb_size_t index)
+{
+    tb_pointer_t item = tb_iterator_item(sort->iterator, itor);
+    if (!sort->temp) return item;
+    tb_memcpy(sort->temp + index * sort->step, item, sort->step);
+    return sort->temp + index * sort->step;
+}
+static __tb_inline__ tb_bool_t tb_intro_sort_less(tb_intro_sort_t* sort, tb_size_t litor, tb_size_t ritor)
+{
+    return sort->comp(sort->iterator, tb_iterator_item(sort->iterator, litor), tb_iterator_item(sort->iterator, ritor)) < 0;
+}
+static __tb_inline__ tb_void_t tb_intro_sort_move(tb_intro_sort_t* sort, tb_size_t ditor, tb_size_t sitor)
+{
+    tb_iterator_copy(sort->iterator, ditor, tb_iterator_item(sort->iterator, sitor));
+}
+static __tb_inline__ tb_void_t tb_intro_sort_swap(tb_intro_sort_t* sort, tb_size_t litor, tb_size_t ritor)
+{
+    tb_cpointer_t item = tb_intro_sort_save(sort, litor, 0);
+    tb_intro_sort_move(sort, litor, ritor);
+    tb_iterator_copy(sort->iterator, ritor, item);
+}
+static __tb_inline__ tb_void_t tb_intro_sort_sort2(tb_intro_sort_t* sort, tb_size_t a, tb_size_t b)
+{
+    if (tb_intro_sort_less(sort, b, a)) tb_intro_sort_swap(sort, a, b);
+}
+static __tb_inline__ tb_void_t tb_intro_sort_sort3(tb_intro_sort_t* sort, tb_size_t a, tb_size_t b, tb_size_t c)
+{
+    tb_intro_sort_sort2(sort, a, b);
+    tb_intro_sort_sort2(sort, b, c);
+    tb_intro_sort_sort2(sort, a, b);
+}
+/* the insertion sorter for [head, tail)
+ *
+ * the unguarded sorter need not check the head, because the item before head is not larger than all items of this range,
+ * the partial sorter gives up if too many items are moved and returns tb_false
+ */
+static tb_bool_t tb_intro_sort_insert(tb_intro_sort_t* sort, tb_size_t head, tb_size_t tail, tb_bool_t guarded, tb_bool_t partial)
+{
+    // done
+    tb_size_t moves = 0;
+    tb_size_t next = head + 1;
+    for (; next < tail; next++)
+    {
+        // need move it?
+        tb_size_t hole = next;
+        if (tb_intro_sort_less(sort, hole, hole - 1))
+        {
+            // save item
+            tb_cpointer_t item = tb_intro_sort_save(sort, hole, 1);
+
+            // move the larger items: [hole - n, hole - 1] => [hole - n + 1, hole]
+            do 
+            {
+                tb_intro_sort_move(sort, hole, hole - 1);
+                hole--;
+
+            } while ((!guarded || hole != head) && sort->comp(sort->iterator, item, tb_iterator_item(sort->iterator, hole - 1)) < 0);
+
+            // item => hole
+            tb_iterator_copy(sort->iterator, hole, item);
+
+            // too many moves for the partial sorter?
+            moves += next - hole;
+            if (partial && moves > TB_INTRO_SORT_PARTIAL_MOVES) return tb_false;
+        }
+    }
+
+    // ok
+    return tb_true;
+}
+/* partition [head, tail) by the pivot at head, the items which are equal to the pivot will be moved to the right
+ *
+ * @return the pivot position, and whether the range has been partitioned already
+ */
+static tb_size_t tb_intro_sort_partition_right(tb_intro_sort_t* sort, tb_size_t head, tb_size_t tail, tb_bool_t* ppartitioned)
+{
+    // save pivot
+    tb_iterator_ref_t   iterator = sort->iterator;
+    tb_iterator_comp_t  comp = sort->comp;
+    tb_cpointer_t       pivot = tb_intro_sort_save(sort, head, 2);
+
+    // find the first item which is not less than the pivot, the median of three guarantees it exists
+    tb_size_t first = head;
+    tb_size_t last = tail;
+    while (comp(iterator, tb_iterator_item(iterator, ++first), pivot) < 0) ;
+
+    // find the last item which is less than the pivot, we need check the bound if there is no any item less than the pivot before first
+    if (first - 1 == head) while (first < last && comp(iterator, tb_iterator_item(iterator, --last), pivot) >= 0) ;
+    else while (comp(iterator, tb_iterator_item(iterator, --last), pivot) >= 0) ;
+
+    // no swap? it has been partitioned already
+    *ppartitioned = first >= last;
+
+    // swap the misplaced items
+    while (first < last)
+    {
+        tb_intro_sort_swap(sort, first, last);
+        while (comp(iterator, tb_iterator_item(iterator, ++first), pivot) < 0) ;
+        while (comp(iterator, tb_iterator_item(iterator, --last), pivot) >= 0) ;
+    }
+
+    // pivot => the final position
+    tb_size_t pivot_pos = first - 1;
+    if (pivot_pos != head) tb_intro_sort_move(sort, head, pivot_pos);
+    tb_iterator_copy(iterator, pivot_pos, pivot);
+    return pivot_pos;
+}
+/* partition [head, tail) by the pivot at head, the items which are equal to the pivot will be moved to the left
+ *
+ * it is used if the pivot is equal to the item before this range, 
+ * all items which are equal to the pivot will be put in the left and need not be sorted again
+ */
+static tb_size_t tb_intro_sort_partition_left(tb_intro_sort_t* sort, tb_size_t head, tb_size_t tail)
+{
+    // save pivot
+    tb_iterator_ref_t   iterator = sort->iterator;
+    tb_iterator_comp_t  comp = sort->comp;
+    tb_cpointer_t       pivot = tb_intro_sort_save(sort, head, 2);
+
+    // find the misplaced items
+    tb_size_t first = head;
+    tb_size_t last = tail;
+    while (comp(iterator, pivot, tb_iterator_item(iterator, --last)) < 0) ;
+    if (last + 1 == tail) while (first < last && comp(iterator, pivot, tb_iterator_item(iterator, ++first)) >= 0) ;
+    else while (comp(iterator, pivot, tb_iterator_item(iterator, ++first)) >= 0) ;
+
+    // swap them
+    while (first < last)
+    {
+        tb_intro_sort_swap(sort, first, last);
+        while (comp(iterator, pivot, tb_iterator_item(iterator, --last)) < 0) ;
+        while (comp(iterator, pivot, tb_iterator_item(iterator, ++first)) >= 0) ;
+    }
+
+    // pivot => the final position
+    tb_size_t pivot_pos = last;
+    if (pivot_pos != head) tb_intro_sort_move(sort, head, pivot_pos);
+    tb_iterator_copy(iterator, pivot_pos, pivot);
+    return pivot_pos;
+}
+static tb_void_t tb_intro_sort_loop(tb_intro_sort_t* sort, tb_size_t head, tb_size_t tail, tb_size_t bad_allowed, tb_bool_t leftmost)
+{
+    while (1)
+    {
+        // the small range? using the insertion sorter
+        tb_size_t size = tail - head;
+        if (size < TB_INTRO_SORT_INSERT_MAXN)
+        {
+            tb_intro_sort_insert(sort, head, tail, leftmost, tb_false);
+            return ;
+        }
+
+        // the median of three or ninther => head
+        tb_size_t half = size >> 1;
+        if (size > TB_INTRO_SORT_NINTHER_MINN)
+        {
+            tb_intro_sort_sort3(sort, head, head + half, tail - 1);
+            tb_intro_sort_sort3(sort, head + 1, head + half - 1, tail - 2);
+            tb_intro_sort_sort3(sort, head + 2, head + half + 1, tail - 3);
+            tb_intro_sort_sort3(sort, head + half - 1, head + half, head + half + 1);
+            tb_intro_sort_swap(sort, head, head + half);
+        }
+        else tb_intro_sort_sort3(sort, head + half, head, tail - 1);
+
+        /* the pivot is equal to the item before this range? 
+         *
+         * the previous pivot is not larger than all items of this range, 
+         * so all items which are equal to it can be put in the left and they need not be sorted
+         */
+        if (!leftmost && !tb_intro_sort_less(sort, head - 1, head))
+        {
+            head = tb_intro_sort_partition_left(sort, head, tail) + 1;
+            continue;
+        }
+
+        // partition it
+        tb_bool_t partitioned = tb_false;
+        tb_size_t pivot_pos = tb_intro_sort_partition_right(sort, head, tail, &partitioned);
+
+        // the highly unbalanced partition?
+        tb_size_t lsize = pivot_pos - head;
+        tb_size_t rsize = tail - (pivot_pos + 1);
+        if (lsize < (size >> 3) || rsize < (size >> 3))
+        {
+            // too many bad partitions? using the heap sorter
+            if (!--bad_allowed)
+            {
+                tb_heap_sort(sort->iterator, head, tail, sort->comp);
+                return ;
+            }
+
+            // shuffle some items to break the patterns
+            if (lsize >= TB_INTRO_SORT_INSERT_MAXN)
+            {
+                tb_intro_sort_swap(sort, head, head + (lsize >> 2));
+                tb_intro_sort_swap(sort, pivot_pos - 1, pivot_pos - (lsize >> 2));
+                if (lsize > TB_INTRO_SORT_NINTHER_MINN)
+                {
+                    tb_intro_sort_swap(sort, head + 1, head + (lsize >> 2) + 1);
+                    tb_intro_sort_swap(sort, head + 2, head + (lsize >> 2) + 2);
+                    tb_intro_sort_swap(sort, pivot_pos - 2, pivot_pos - (lsize >> 2) - 1);
+                    tb_intro_sort_swap(sort, pivot_pos - 3, pivot_pos - (lsize >> 2) - 2);
+                }
+            }
+            if (rsize >= TB_INTRO_SORT_INSERT_MAXN)
+            {
+                tb_intro_sort_swap(sort, pivot_pos + 1, pivot_pos + 1 + (rsize >> 2));
+                tb_intro_sort_swap(sort, tail - 1, tail - (rsize >> 2));
+                if (rsize > TB_INTRO_SORT_NINTHER_MINN)
+                {
+                    tb_intro_sort_swap(sort, pivot_pos + 2, pivot_pos + 2 + (rsize >> 2));
+                    tb_intro_sort_swap(sort, pivot_pos + 3, pivot_pos + 3 + (rsize >> 2));
+                    tb_intro_sort_swap(sort, tail - 2, tail - 1 - (rsize >> 2));
+                    tb_intro_sort_swap(sort, tail - 3, tail - 2 - (rsize >> 2));
+                }
+            }
+        }
+        // it has been partitioned already? it may be sorted, try to sort it by the partial insertion sorter
+        else if (   partitioned 
+                &&  tb_intro_sort_insert(sort, head, pivot_pos, tb_true, tb_true)
+                &&  tb_intro_sort_insert(sort, pivot_pos + 1, tail, tb_true, tb_true)) 
+            return ;
+
+        // sort the left range and loop for the right range
+        tb_intro_sort_loop(sort, head, pivot_pos, bad_allowed, leftmost);
+        head = pivot_pos + 1;
+        leftmost = tb_false;
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_void_t tb_intro_sort(tb_iterator_ref_t iterator, tb_size_t head, tb_size_t tail, tb_iterator_comp_t comp)
+{
+    // check
+    tb_assert_and_check_return(iterator && (tb_iterator_mode(iterator) & TB_ITERATOR_MODE_RACCESS));
+    tb_check_return(head + 1 < tail);
+
+    // init sorter
+    tb_intro_sort_t sort;
+    sort.iterator   = iterator;
+    sort.comp       = comp? comp : tb_iterator_comp;
+    sort.step       = tb_iterator_step(iterator);
+    sort.temp       = tb_null;
+
+    // make the temporary items for the large item
+    if (sort.step > sizeof(tb_pointer_t))
+    {
+        sort.temp = (tb_byte_t*)tb_malloc(3 * sort.step);
+        tb_assert_and_check_return(sort.temp);
+    }
+
+    // the bad partitions limit: log2(n)
+    tb_size_t bad_allowed = 0;
+    tb_size_t size = tail - head;
+    for (; size; size >>= 1) bad_allowed++;
+
+    // sort it
+    tb_intro_sort_loop(&sort, head, tail, bad_allowed, tb_true);
+
+    // exit the temporary items
+    if (sort.temp) tb_free(sort.temp);
+}
+tb_void_t tb_intro_sort_all(tb_iterator_ref_t iterator, tb_iterator_comp_t comp)
+{
+    tb_intro_sort(iterator, tb_iterator_head(iterator), tb_iterator_tail(iterator), comp);
+}
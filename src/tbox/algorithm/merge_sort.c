@@ -0,0 +1,171 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        merge_sort.c
+ * @ingroup     algorithm
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "merge_sort.h"
+#include "intro_sort.h"
+#include "bubble_sort.h"
+#include "distance.h"
+#include "../libc/libc.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the run size which will be sorted by the insertion sorter first
+#define TB_MERGE_SORT_RUN_SIZE          (32)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_void_t tb_merge_sort_insert(tb_iterator_ref_t iterator, tb_cpointer_t* items, tb_size_t size, tb_iterator_comp_t comp)
+{
+    // done
+    tb_size_t next = 1;
+    for (; next < size; next++)
+    {
+        // the item is not less than the previous item? keep it for the stability
+        tb_cpointer_t item = items[next];
+        if (comp(iterator, item, items[next - 1]) >= 0) continue;
+
+        // move the larger items: [hole - n, hole - 1] => [hole - n + 1, hole]
+        tb_size_t hole = next;
+        do
+        {
+            items[hole] = items[hole - 1];
+            hole--;
+
+        } while (hole && comp(iterator, item, items[hole - 1]) < 0);
+
+        // item => hole
+        items[hole] = item;
+    }
+}
+static tb_void_t tb_merge_sort_merge(tb_iterator_ref_t iterator, tb_cpointer_t const* litems, tb_size_t lsize, tb_cpointer_t const* ritems, tb_size_t rsize, tb_cpointer_t* items, tb_iterator_comp_t comp)
+{
+    // merge them, the left item is taken first if they are equal
+    tb_cpointer_t const* ltail = litems + lsize;
+    tb_cpointer_t const* rtail = ritems + rsize;
+    while (litems < ltail && ritems < rtail)
+        *items++ = comp(iterator, *ritems, *litems) < 0? *ritems++ : *litems++;
+
+    // copy the remaining items
+    if (litems < ltail) tb_memcpy(items, litems, (ltail - litems) * sizeof(tb_cpointer_t));
+    else if (ritems < rtail) tb_memcpy(items, ritems, (rtail - ritems) * sizeof(tb_cpointer_t));
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_void_t tb_merge_sort(tb_iterator_ref_t iterator, tb_size_t head, tb_size_t tail, tb_iterator_comp_t comp)
+{
+    // check
+    tb_assert_and_check_return(iterator);
+    tb_check_return(head != tail);
+
+    // the comparer
+    if (!comp) comp = tb_iterator_comp;
+
+    // the items count
+    tb_size_t size = tb_distance(iterator, head, tail);
+    tb_check_return(size > 1);
+
+    /* make the items buffer
+     *
+     * the small item is saved as the item value and the large item is copied to the data buffer,
+     * so we only need move the item values or pointers when merging them
+     *
+     * buffer: |items: size|temp: size|data: size * step (only for the large item)|
+     */
+    tb_size_t       step = tb_iterator_step(iterator);
+    tb_size_t       data_size = step > sizeof(tb_pointer_t)? size * step : 0;
+    tb_cpointer_t*  buffer = (tb_cpointer_t*)tb_malloc((size << 1) * sizeof(tb_cpointer_t) + data_size);
+    if (!buffer)
+    {
+        // trace
+        tb_trace_e("merge_sort: no enough memory for %lu items, using the unstable sorter!", size);
+
+        // sort it by the unstable sorter
+        if (tb_iterator_mode(iterator) & TB_ITERATOR_MODE_RACCESS) tb_intro_sort(iterator, head, tail, comp);
+        else tb_bubble_sort(iterator, head, tail, comp);
+        return ;
+    }
+    tb_cpointer_t*  items = buffer;
+    tb_cpointer_t*  temp = buffer + size;
+    tb_byte_t*      data = data_size? (tb_byte_t*)(temp + size) : tb_null;
+
+    // load items
+    tb_size_t i = 0;
+    tb_size_t itor = head;
+    for (; itor != tail; itor = tb_iterator_next(iterator, itor), i++)
+    {
+        tb_pointer_t item = tb_iterator_item(iterator, itor);
+        if (data)
+        {
+            tb_memcpy(data + i * step, item, step);
+            items[i] = data + i * step;
+        }
+        else items[i] = item;
+    }
+    tb_assert(i == size);
+
+    // sort the small runs by the insertion sorter
+    for (i = 0; i < size; i += TB_MERGE_SORT_RUN_SIZE)
+        tb_merge_sort_insert(iterator, items + i, tb_min(TB_MERGE_SORT_RUN_SIZE, size - i), comp);
+
+    // merge the runs from bottom to top
+    tb_size_t width = TB_MERGE_SORT_RUN_SIZE;
+    for (; width < size; width <<= 1)
+    {
+        for (i = 0; i < size; i += width << 1)
+        {
+            // the left and right runs
+            tb_size_t mid = tb_min(i + width, size);
+            tb_size_t end = tb_min(i + (width << 1), size);
+
+            // they are ordered already? only copy them
+            if (mid == end || comp(iterator, items[mid], items[mid - 1]) >= 0)
+                tb_memcpy(temp + i, items + i, (end - i) * sizeof(tb_cpointer_t));
+            else tb_merge_sort_merge(iterator, items + i, mid - i, items + mid, end - mid, temp + i, comp);
+        }
+
+        // swap the items and temp buffers
+        tb_cpointer_t* swap = items; items = temp; temp = swap;
+    }
+
+    // save items
+    for (i = 0, itor = head; itor != tail; itor = tb_iterator_next(iterator, itor), i++)
+        tb_iterator_copy(iterator, itor, items[i]);
+
+    // exit the items buffer
+    tb_free(buffer);
+}
+tb_void_t tb_merge_sort_all(tb_iterator_ref_t iterator, tb_iterator_comp_t comp)
+{
+    tb_merge_sort(iterator, tb_iterator_head(iterator), tb_iterator_tail(iterator), comp);
+}
@@ -0,0 +1,289 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        parallel_sort.c
+ * @ingroup     algorithm
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "parallel_sort.h"
+#include "sort.h"
+#include "../libc/libc.h"
+#include "../platform/parallel.h"
+#include "../platform/processor.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the minimum items count of each chunk, the smaller range will be sorted by tb_sort() directly
+#define TB_PARALLEL_SORT_CHUNK_MINN         (16384)
+
+// the chunks maxn
+#define TB_PARALLEL_SORT_CHUNKS_MAXN        (64)
+
+// the scalar value for comparing, it flips the sign bit of tb_long_t, so we can compare them as the unsigned integer
+#define tb_parallel_sort_scalar_value(item, bias)    ((item) + (bias))
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the parallel sorter type
+typedef struct __tb_parallel_sort_t
+{
+    // the iterator
+    tb_iterator_ref_t       iterator;
+
+    // the comparer
+    tb_iterator_comp_t      comp;
+
+    // the range head
+    tb_size_t               head;
+
+    // the items count
+    tb_size_t               size;
+
+    // the chunks count
+    tb_size_t               chunks;
+
+    // the merged chunks count of each side for the current pass
+    tb_size_t               width;
+
+    // the item step
+    tb_size_t               step;
+
+    // the slot size of the temporary buffer
+    tb_size_t               slot;
+
+    // the temporary buffer for the left items of merging
+    tb_byte_t*              temp;
+
+    // the scalar items, they will be merged directly if exists
+    tb_size_t*              scalar;
+
+    // the scalar bias
+    tb_size_t               bias;
+
+}tb_parallel_sort_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static __tb_inline__ tb_size_t tb_parallel_sort_bound(tb_parallel_sort_t const* sort, tb_size_t chunk)
+{
+    return sort->head + (tb_size_t)(((tb_hize_t)sort->size * chunk) / sort->chunks);
+}
+static tb_void_t tb_parallel_sort_chunk(tb_size_t start, tb_size_t end, tb_cpointer_t priv)
+{
+    // check
+    tb_parallel_sort_t const* sort = (tb_parallel_sort_t const*)priv;
+    tb_assert_and_check_return(sort);
+
+    // sort chunks
+    for (; start < end; start++)
+        tb_sort(sort->iterator, tb_parallel_sort_bound(sort, start), tb_parallel_sort_bound(sort, start + 1), sort->comp);
+}
+static tb_void_t tb_parallel_sort_merge_scalar(tb_parallel_sort_t const* sort, tb_size_t l, tb_size_t m, tb_size_t r)
+{
+    // copy the left items to the temporary buffer
+    tb_size_t*  items = sort->scalar;
+    tb_size_t*  left = (tb_size_t*)sort->temp + (l - sort->head);
+    tb_size_t*  left_tail = left + (m - l);
+    tb_memcpy(left, items + l, (m - l) * sizeof(tb_size_t));
+
+    // merge them
+    tb_size_t   bias = sort->bias;
+    while (left < left_tail && m < r)
+    {
+        if (tb_parallel_sort_scalar_value(items[m], bias) < tb_parallel_sort_scalar_value(*left, bias)) items[l++] = items[m++];
+        else items[l++] = *left++;
+    }
+
+    // copy the remaining left items, the remaining right items are at the final position already
+    if (left < left_tail) tb_memcpy(items + l, left, (left_tail - left) * sizeof(tb_size_t));
+}
+static tb_void_t tb_parallel_sort_merge_items(tb_parallel_sort_t const* sort, tb_size_t l, tb_size_t m, tb_size_t r)
+{
+    // copy the left items to the temporary buffer, the small item is saved as the item value
+    tb_iterator_ref_t   iterator = sort->iterator;
+    tb_iterator_comp_t  comp = sort->comp;
+    tb_size_t           step = sort->step;
+    tb_size_t           slot = sort->slot;
+    tb_byte_t*          left = sort->temp + (l - sort->head) * slot;
+    tb_byte_t*          left_tail = left + (m - l) * slot;
+    tb_size_t           itor = l;
+    tb_byte_t*          p = left;
+    for (; itor < m; itor++, p += slot)
+    {
+        if (step > sizeof(tb_pointer_t)) tb_memcpy(p, tb_iterator_item(iterator, itor), step);
+        else *((tb_cpointer_t*)p) = tb_iterator_item(iterator, itor);
+    }
+
+    /* merge them
+     *
+     * the output position is always before the next right item, so the unmerged right items will not be overwritten
+     */
+    while (left < left_tail)
+    {
+        tb_cpointer_t item = step > sizeof(tb_pointer_t)? (tb_cpointer_t)left : *((tb_cpointer_t*)left);
+        if (m < r)
+        {
+            tb_pointer_t right = tb_iterator_item(iterator, m);
+            if (comp(iterator, right, item) < 0)
+            {
+                tb_iterator_copy(iterator, l++, right);
+                m++;
+                continue;
+            }
+        }
+        tb_iterator_copy(iterator, l++, item);
+        left += slot;
+    }
+}
+static tb_void_t tb_parallel_sort_merge(tb_size_t start, tb_size_t end, tb_cpointer_t priv)
+{
+    // check
+    tb_parallel_sort_t const* sort = (tb_parallel_sort_t const*)priv;
+    tb_assert_and_check_return(sort);
+
+    // merge the chunk pairs: [pair * width * 2, pair * width * 2 + width) and [pair * width * 2 + width, pair * width * 2 + width * 2)
+    tb_size_t width = sort->width;
+    for (; start < end; start++)
+    {
+        // the left and right ranges
+        tb_size_t first = start * (width << 1);
+        tb_size_t l = tb_parallel_sort_bound(sort, first);
+        tb_size_t m = tb_parallel_sort_bound(sort, tb_min(first + width, sort->chunks));
+        tb_size_t r = tb_parallel_sort_bound(sort, tb_min(first + (width << 1), sort->chunks));
+        tb_check_continue(l < m && m < r);
+
+        // merge them
+        if (sort->scalar) 
+        {
+            // they are ordered already?
+            tb_check_continue(tb_parallel_sort_scalar_value(sort->scalar[m], sort->bias) < tb_parallel_sort_scalar_value(sort->scalar[m - 1], sort->bias));
+            tb_parallel_sort_merge_scalar(sort, l, m, r);
+        }
+        else
+        {
+            // they are ordered already?
+            tb_check_continue(sort->comp(sort->iterator, tb_iterator_item(sort->iterator, m), tb_iterator_item(sort->iterator, m - 1)) < 0);
+            tb_parallel_sort_merge_items(sort, l, m, r);
+        }
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_void_t tb_parallel_sort(tb_thread_pool_ref_t pool, tb_iterator_ref_t iterator, tb_size_t head, tb_size_t tail, tb_iterator_comp_t comp)
+{
+    // check
+    tb_assert_and_check_return(iterator && (tb_iterator_mode(iterator) & TB_ITERATOR_MODE_RACCESS));
+    tb_assert_and_check_return(!(tb_iterator_mode(iterator) & TB_ITERATOR_MODE_READONLY));
+    tb_check_return(head + 1 < tail);
+
+    // the comparer
+    if (!comp) comp = tb_iterator_comp;
+
+    // the participants count
+    if (!pool) pool = tb_thread_pool();
+    tb_size_t chunks = tb_processor_count();
+    if (pool)
+    {
+        tb_size_t worker_size = tb_thread_pool_worker_size(pool);
+        if (chunks < worker_size) chunks = worker_size;
+    }
+    else chunks = 1;
+
+    // the chunks count
+    tb_size_t size = tail - head;
+    if (chunks > size / TB_PARALLEL_SORT_CHUNK_MINN) chunks = size / TB_PARALLEL_SORT_CHUNK_MINN;
+    if (chunks > TB_PARALLEL_SORT_CHUNKS_MAXN) chunks = TB_PARALLEL_SORT_CHUNKS_MAXN;
+
+    // too small or only one participant? sort it directly
+    if (chunks < 2)
+    {
+        tb_sort(iterator, head, tail, comp);
+        return ;
+    }
+
+    // init sorter
+    tb_parallel_sort_t sort;
+    tb_memset(&sort, 0, sizeof(tb_parallel_sort_t));
+    sort.iterator   = iterator;
+    sort.comp       = comp;
+    sort.head       = head;
+    sort.size       = size;
+    sort.chunks     = chunks;
+    sort.step       = tb_iterator_step(iterator);
+    sort.slot       = sort.step > sizeof(tb_pointer_t)? sort.step : sizeof(tb_pointer_t);
+
+    // the scalar items with the default comparer? merge them directly
+    tb_size_t type = TB_ELEMENT_SCALAR_NONE;
+    if (comp == tb_iterator_comp) sort.scalar = (tb_size_t*)tb_iterator_scalar(iterator, &type);
+    sort.bias = type == TB_ELEMENT_SCALAR_LONG? ((tb_size_t)1 << (TB_CPU_BITSIZE - 1)) : 0;
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // make the temporary buffer for merging
+        sort.temp = (tb_byte_t*)tb_malloc(size * sort.slot);
+        tb_assert_and_check_break(sort.temp);
+
+        // sort all chunks
+        if (!tb_parallel_for(pool, 0, chunks, 1, tb_parallel_sort_chunk, &sort)) break;
+
+        // merge the sorted chunks in pairs from bottom to top
+        for (sort.width = 1; sort.width < chunks; sort.width <<= 1)
+        {
+            tb_size_t pairs = (chunks + (sort.width << 1) - 1) / (sort.width << 1);
+            if (!tb_parallel_for(pool, 0, pairs, 1, tb_parallel_sort_merge, &sort)) break;
+        }
+        tb_check_break(sort.width >= chunks);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // exit the temporary buffer
+    if (sort.temp) tb_free(sort.temp);
+
+    // failed? sort it directly, the sorted chunks will make it faster
+    if (!ok) 
+    {
+        // trace
+        tb_trace_e("parallel_sort: failed, sort %lu items directly!", size);
+
+        // sort it
+        tb_sort(iterator, head, tail, comp);
+    }
+}
+tb_void_t tb_parallel_sort_all(tb_thread_pool_ref_t pool, tb_iterator_ref_t iterator, tb_iterator_comp_t comp)
+{
+    tb_parallel_sort(pool, iterator, tb_iterator_head(iterator), tb_iterator_tail(iterator), comp);
+}
@@ -0,0 +1,74 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        parallel_sort.h
+ * @ingroup     algorithm
+ *
+ */
+#ifndef TB_ALGORITHM_PARALLEL_SORT_H
+#define TB_ALGORITHM_PARALLEL_SORT_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../platform/thread_pool.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! the parallel sorter, O(nlog(n)), unstable
+ *
+ * the range is split to some chunks, they are sorted by tb_sort() on the workers of the thread pool
+ * and the current thread, and then the sorted chunks are merged in pairs in parallel.
+ *
+ * it will sort the range by tb_sort() directly if the range is small or there is only one participant.
+ *
+ * @note the iterator must be random access and the comparer will be called on the multiple threads,
+ * it need O(n) extra space for merging and it will fall back to tb_sort() if there is no enough memory
+ *
+ * @param pool      the thread pool, using tb_thread_pool() if be null
+ * @param iterator  the iterator
+ * @param head      the iterator head
+ * @param tail      the iterator tail
+ * @param comp      the comparer
+ */
+tb_void_t           tb_parallel_sort(tb_thread_pool_ref_t pool, tb_iterator_ref_t iterator, tb_size_t head, tb_size_t tail, tb_iterator_comp_t comp);
+
+/*! the parallel sorter for all
+ *
+ * @param pool      the thread pool, using tb_thread_pool() if be null
+ * @param iterator  the iterator
+ * @param comp      the comparer
+ */
+tb_void_t           tb_parallel_sort_all(tb_thread_pool_ref_t pool, tb_iterator_ref_t iterator, tb_iterator_comp_t comp);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+#endif
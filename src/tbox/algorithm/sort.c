@@ -28,13 +28,124 @@
  * includes
  */
 #include "sort.h"
-#include "distance.h"
-#include "heap_sort.h"
+#include "intro_sort.h"
+#include "merge_sort.h"
 #include "quick_sort.h"
-#include "insert_sort.h"
-#include "bubble_sort.h"
 #include "../libc/libc.h"
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the items count for the insertion sort of the scalar items
+#define TB_SORT_SCALAR_INSERT_MAXN          (16)
+
+// the scalar value for comparing, it flips the sign bit of tb_long_t, so we can compare them as the unsigned integer
+#define tb_sort_scalar_value(item, bias)    ((item) + (bias))
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+#ifndef TB_CONFIG_MICRO_ENABLE
+static tb_void_t tb_sort_scalar_insert(tb_size_t* items, tb_size_t size, tb_size_t bias)
+{
+    tb_size_t i = 1;
+    for (; i < size; i++)
+    {
+        tb_size_t item  = items[i];
+        tb_size_t value = tb_sort_scalar_value(item, bias);
+        tb_size_t j     = i;
+        for (; j && tb_sort_scalar_value(items[j - 1], bias) > value; j--) items[j] = items[j - 1];
+        items[j] = item;
+    }
+}
+static tb_void_t tb_sort_scalar_heap(tb_size_t* items, tb_size_t size, tb_size_t bias)
+{
+    // make heap and pop the maximum item to the tail
+    tb_size_t i = size >> 1;
+    tb_size_t n = size;
+    while (n > 1)
+    {
+        // the hole and item
+        tb_size_t hole;
+        tb_size_t item;
+        if (i) item = items[hole = --i];
+        else 
+        {
+            item = items[--n];
+            items[n] = items[0];
+            hole = 0;
+        }
+
+        // shift down the hole
+        tb_size_t value = tb_sort_scalar_value(item, bias);
+        tb_size_t child = (hole << 1) + 1;
+        for (; child < n; child = (hole << 1) + 1)
+        {
+            if (child + 1 < n && tb_sort_scalar_value(items[child + 1], bias) > tb_sort_scalar_value(items[child], bias)) child++;
+            if (tb_sort_scalar_value(items[child], bias) <= value) break;
+            items[hole] = items[child];
+            hole = child;
+        }
+        items[hole] = item;
+    }
+}
+static tb_void_t tb_sort_scalar(tb_size_t* items, tb_size_t size, tb_size_t bias, tb_size_t depth)
+{
+    while (size > TB_SORT_SCALAR_INSERT_MAXN)
+    {
+        // too deep? using the heap sort
+        if (!depth--)
+        {
+            tb_sort_scalar_heap(items, size, bias);
+            return ;
+        }
+
+        // the median of three items => head
+        tb_size_t* l = items;
+        tb_size_t* m = items + (size >> 1);
+        tb_size_t* r = items + size - 1;
+        tb_size_t  t;
+        if (tb_sort_scalar_value(*m, bias) < tb_sort_scalar_value(*l, bias)) { t = *m; *m = *l; *l = t; }
+        if (tb_sort_scalar_value(*r, bias) < tb_sort_scalar_value(*m, bias)) 
+        { 
+            t = *r; *r = *m; *m = t;
+            if (tb_sort_scalar_value(*m, bias) < tb_sort_scalar_value(*l, bias)) { t = *m; *m = *l; *l = t; }
+        }
+        t = *m; *m = *l; *l = t;
+
+        // partition [head + 1, tail), the head is the pivot
+        tb_size_t pivot = tb_sort_scalar_value(*items, bias);
+        tb_size_t i = 0;
+        tb_size_t j = size;
+        while (1)
+        {
+            while (tb_sort_scalar_value(items[++i], bias) < pivot && i < size - 1) ;
+            while (tb_sort_scalar_value(items[--j], bias) > pivot) ;
+            if (i >= j) break;
+            t = items[i]; items[i] = items[j]; items[j] = t;
+        }
+        t = items[0]; items[0] = items[j]; items[j] = t;
+
+        // sort the smaller part first, the recursive depth is only O(log(n))
+        if (j < size - j - 1)
+        {
+            tb_sort_scalar(items, j, bias, depth);
+            items += j + 1;
+            size -= j + 1;
+        }
+        else
+        {
+            tb_sort_scalar(items + j + 1, size - j - 1, bias, depth);
+            size = j;
+        }
+    }
+
+    // sort the small items
+    tb_sort_scalar_insert(items, size, bias);
+}
+#endif
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */
@@ -56,13 +167,26 @@ tb_void_t tb_sort(tb_iterator_ref_t iterator, tb_size_t head, tb_size_t tail, tb
     // sort it
     tb_quick_sort(iterator, head, tail, comp);
 #else
-    // random access iterator? 
-    if (tb_iterator_mode(iterator) & TB_ITERATOR_MODE_RACCESS) 
+    // the scalar items with the default comparer? sort them directly
+    tb_size_t       type = TB_ELEMENT_SCALAR_NONE;
+    tb_size_t*      items = (!comp || comp == tb_iterator_comp)? (tb_size_t*)tb_iterator_scalar(iterator, &type) : tb_null;
+    if (items && head < tail)
     {
-        if (tb_distance(iterator, head, tail) > 100000) tb_heap_sort(iterator, head, tail, comp);
-        else tb_quick_sort(iterator, head, tail, comp); //!< @note the recursive stack size is limit
+        // the depth limit: 2 * log2(n)
+        tb_size_t size = tail - head;
+        tb_size_t depth = 0;
+        tb_size_t n = size;
+        for (; n; n >>= 1) depth += 2;
+
+        // sort it
+        tb_sort_scalar(items + head, size, type == TB_ELEMENT_SCALAR_LONG? ((tb_size_t)1 << (TB_CPU_BITSIZE - 1)) : 0, depth);
+        return ;
     }
-    else tb_bubble_sort(iterator, head, tail, comp);
+
+    // random access iterator? using the pattern-defeating intro sorter
+    if (tb_iterator_mode(iterator) & TB_ITERATOR_MODE_RACCESS) tb_intro_sort(iterator, head, tail, comp);
+    // using the merge sorter for the list and single list
+    else tb_merge_sort(iterator, head, tail, comp);
 #endif
 }
 tb_void_t tb_sort_all(tb_iterator_ref_t iterator, tb_iterator_comp_t comp)
@@ -41,6 +41,12 @@ __tb_extern_c_enter__
  */
 
 /*! the sorter
+ *
+ * the scalar items (.e.g the vector of tb_element_long()) will be compared and moved directly 
+ * if the comparer is null or tb_iterator_comp(), see tb_iterator_scalar()
+ *
+ * the random access iterator is sorted by tb_intro_sort() and the other iterator (.e.g list) is sorted by tb_merge_sort(),
+ * it is unstable, please use tb_merge_sort() if the equal items need keep their original order
  *
  * @param iterator  the iterator
  * @param head      the iterator head
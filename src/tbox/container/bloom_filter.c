@@ -82,6 +82,9 @@ typedef struct __tb_bloom_filter_t
     // the maxn
     tb_size_t           maxn;
 
+    // the allocator
+    tb_allocator_ref_t  allocator;
+
     // the element
     tb_element_t        element;
 
@@ -100,6 +103,10 @@ typedef struct __tb_bloom_filter_t
  * implementation
  */
 tb_bloom_filter_ref_t tb_bloom_filter_init(tb_size_t probability, tb_size_t hash_count, tb_size_t item_maxn, tb_element_t element)
+{
+    return tb_bloom_filter_init_with_allocator(probability, hash_count, item_maxn, element, tb_null);
+}
+tb_bloom_filter_ref_t tb_bloom_filter_init_with_allocator(tb_size_t probability, tb_size_t hash_count, tb_size_t item_maxn, tb_element_t element, tb_allocator_ref_t allocator)
 {
     // check
     tb_assert_and_check_return_val(element.hash, tb_null);
@@ -121,9 +128,16 @@ tb_bloom_filter_ref_t tb_bloom_filter_init(tb_size_t probability, tb_size_t hash
         if (!item_maxn) item_maxn = TB_BLOOM_FILTER_ITEM_MAXN_DEFAULT;
         tb_assert_and_check_break(item_maxn < TB_MAXU32);
 
+        // using the global allocator if be null
+        if (!allocator) allocator = tb_allocator();
+        tb_assert_and_check_break(allocator);
+
         // make filter
-        filter = tb_malloc0_type(tb_bloom_filter_t);
+        filter = (tb_bloom_filter_t*)tb_allocator_malloc0(allocator, sizeof(tb_bloom_filter_t));
         tb_assert_and_check_break(filter);
+
+        // init allocator
+        filter->allocator = allocator;
     
         // init filter
         filter->element     = element;
@@ -199,7 +213,7 @@ tb_bloom_filter_ref_t tb_bloom_filter_init(tb_size_t probability, tb_size_t hash
         tb_trace_d("size: %lu", filter->size);
 
         // init data
-        filter->data = tb_malloc0_bytes(filter->size);
+        filter->data = (tb_byte_t*)tb_allocator_malloc0(filter->allocator, filter->size);
         tb_assert_and_check_break(filter->data);
 
         // init hash mask
@@ -229,11 +243,11 @@ tb_void_t tb_bloom_filter_exit(tb_bloom_filter_ref_t self)
     tb_assert_and_check_return(filter);
 
     // exit data
-    if (filter->data) tb_free(filter->data);
+    if (filter->data) tb_allocator_free(filter->allocator, filter->data);
     filter->data = tb_null;
 
     // exit it
-    tb_free(filter);
+    tb_allocator_free(filter->allocator, filter);
 }
 tb_void_t tb_bloom_filter_clear(tb_bloom_filter_ref_t self)
 {
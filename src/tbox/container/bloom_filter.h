@@ -144,6 +144,20 @@ typedef enum __tb_bloom_filter_probability_e
  */
 tb_bloom_filter_ref_t   tb_bloom_filter_init(tb_size_t probability, tb_size_t hash_count, tb_size_t item_maxn, tb_element_t element);
 
+/*! init bloom filter with the given allocator
+ *
+ * the filter and its bits data are allocated from the given allocator.
+ *
+ * @param probability   the probability of false positives
+ * @param hash_count    the hash count: < 16
+ * @param item_maxn     the item maxn
+ * @param element       the element only for hash
+ * @param allocator     the allocator, using the global allocator if be null
+ *
+ * @return              the bloom filter
+ */
+tb_bloom_filter_ref_t   tb_bloom_filter_init_with_allocator(tb_size_t probability, tb_size_t hash_count, tb_size_t item_maxn, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit bloom filter
  *
  * @param bloom_filter  the bloom filter
@@ -81,6 +81,19 @@ typedef tb_iterator_ref_t   tb_circle_queue_ref_t;
  */
 tb_circle_queue_ref_t   tb_circle_queue_init(tb_size_t maxn, tb_element_t element);
 
+/*! init queue with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param maxn          the item maxn, using the default maxn if be zero
+ * @param element       the element
+ * @param allocator     the allocator, using the global allocator if be null
+ *
+ * @return              the queue
+ */
+tb_circle_queue_ref_t   tb_circle_queue_init_with_allocator(tb_size_t maxn, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit queue
  *
  * @param queue         the queue
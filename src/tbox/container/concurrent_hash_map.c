@@ -0,0 +1,519 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        concurrent_hash_map.c
+ * @ingroup     container
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME                "concurrent_hash_map"
+#define TB_TRACE_MODULE_DEBUG               (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "concurrent_hash_map.h"
+#include "../libc/libc.h"
+#include "../utils/utils.h"
+#include "../memory/memory.h"
+#include "../platform/platform.h"
+#include "../algorithm/algorithm.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the default shards count for each processor
+#define TB_CONCURRENT_HASH_MAP_SHARDS_CPU               (4)
+
+// the shards maximum count
+#ifdef __tb_small__
+#   define TB_CONCURRENT_HASH_MAP_SHARDS_MAXN           (64)
+#else
+#   define TB_CONCURRENT_HASH_MAP_SHARDS_MAXN           (1024)
+#endif
+
+// the lock state: the readers count << 2 | writer waiting | writer
+#define TB_CONCURRENT_HASH_MAP_LOCK_WRITER              (1)
+#define TB_CONCURRENT_HASH_MAP_LOCK_WAITING             (2)
+#define TB_CONCURRENT_HASH_MAP_LOCK_READER              (4)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the concurrent hash map shard type
+typedef struct __tb_concurrent_hash_map_shard_t
+{
+    // the reader-writer lock
+    tb_atomic_t                     lock;
+
+    // the hash map
+    tb_hash_map_ref_t               hash_map;
+
+    // the padding, each shard is placed on its own cache line
+    tb_byte_t                       pad[TB_L1_CACHE_BYTES - sizeof(tb_atomic_t) - sizeof(tb_hash_map_ref_t)];
+
+}tb_concurrent_hash_map_shard_t;
+
+// the concurrent hash map type
+typedef struct __tb_concurrent_hash_map_t
+{
+    // the shards, aligned by the cache line
+    tb_concurrent_hash_map_shard_t* shards;
+
+    // the shards data
+    tb_byte_t*                      shards_data;
+
+    // the shards count
+    tb_size_t                       shards_count;
+
+    // the allocator
+    tb_allocator_ref_t              allocator;
+
+    // the element for name
+    tb_element_t                    element_name;
+
+    // the element for data
+    tb_element_t                    element_data;
+
+}tb_concurrent_hash_map_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+
+/* load the lock state
+ *
+ * tb_atomic_get() will lock the cache line for writing (cmpxchg), it is too slow for spinning
+ */
+static __tb_inline__ tb_size_t tb_concurrent_hash_map_lock_load(tb_atomic_t* lock)
+{
+#ifdef __ATOMIC_ACQUIRE
+    return (tb_size_t)__atomic_load_n(lock, __ATOMIC_ACQUIRE);
+#else
+    tb_size_t v = (tb_size_t)*lock;
+    tb_barrier();
+    return v;
+#endif
+}
+static __tb_inline__ tb_void_t tb_concurrent_hash_map_lock_enter_read(tb_atomic_t* lock)
+{
+    tb_size_t tryn = 5;
+    while (1)
+    {
+        // no writer and no waiting writer? we have got it
+        if (!(tb_atomic_fetch_and_add(lock, TB_CONCURRENT_HASH_MAP_LOCK_READER) & (TB_CONCURRENT_HASH_MAP_LOCK_WRITER | TB_CONCURRENT_HASH_MAP_LOCK_WAITING))) 
+            break;
+
+        // cancel it and wait the writers
+        tb_atomic_fetch_and_sub(lock, TB_CONCURRENT_HASH_MAP_LOCK_READER);
+        while (tb_concurrent_hash_map_lock_load(lock) & (TB_CONCURRENT_HASH_MAP_LOCK_WRITER | TB_CONCURRENT_HASH_MAP_LOCK_WAITING))
+        {
+            // yield the processor
+            if (!tryn--)
+            {
+                tb_sched_yield();
+                tryn = 5;
+            }
+        }
+    }
+}
+static __tb_inline__ tb_void_t tb_concurrent_hash_map_lock_leave_read(tb_atomic_t* lock)
+{
+    tb_atomic_fetch_and_sub(lock, TB_CONCURRENT_HASH_MAP_LOCK_READER);
+}
+static __tb_inline__ tb_void_t tb_concurrent_hash_map_lock_enter_write(tb_atomic_t* lock)
+{
+    tb_size_t tryn = 5;
+    while (1)
+    {
+        // no readers and no writer? try to get it and clear the waiting flag
+        tb_size_t state = tb_concurrent_hash_map_lock_load(lock);
+        if (!(state & ~TB_CONCURRENT_HASH_MAP_LOCK_WAITING))
+        {
+            if ((tb_size_t)tb_atomic_fetch_and_pset(lock, (tb_long_t)state, TB_CONCURRENT_HASH_MAP_LOCK_WRITER) == state) break;
+        }
+        // mark the waiting flag to block the new readers, so the writers will not be starved
+        else if (!(state & TB_CONCURRENT_HASH_MAP_LOCK_WAITING)) 
+            tb_atomic_fetch_and_or(lock, TB_CONCURRENT_HASH_MAP_LOCK_WAITING);
+
+        // yield the processor
+        if (!tryn--)
+        {
+            tb_sched_yield();
+            tryn = 5;
+        }
+    }
+}
+static __tb_inline__ tb_void_t tb_concurrent_hash_map_lock_leave_write(tb_atomic_t* lock)
+{
+    // @note the waiting flag may be marked by the other writers
+    tb_atomic_fetch_and_sub(lock, TB_CONCURRENT_HASH_MAP_LOCK_WRITER);
+}
+static __tb_inline__ tb_concurrent_hash_map_shard_t* tb_concurrent_hash_map_shard(tb_concurrent_hash_map_t* map, tb_cpointer_t name)
+{
+    // the full hash of the name
+    tb_uint32_t hash = (tb_uint32_t)map->element_name.hash(&map->element_name, name, (tb_size_t)-1, 0);
+
+    /* mix it to select the shard
+     *
+     * @note the hash map mixes the same hash with another finalizer, 
+     * so the items of one shard will not be crowded in the same slots
+     */
+    hash ^= hash >> 16;
+    hash *= 0x7feb352d;
+    hash ^= hash >> 15;
+    hash *= 0x846ca68b;
+    hash ^= hash >> 16;
+    return &map->shards[hash & (map->shards_count - 1)];
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_concurrent_hash_map_ref_t tb_concurrent_hash_map_init(tb_size_t shards, tb_element_t element_name, tb_element_t element_data)
+{
+    return tb_concurrent_hash_map_init_with_allocator(shards, element_name, element_data, tb_null);
+}
+tb_concurrent_hash_map_ref_t tb_concurrent_hash_map_init_with_allocator(tb_size_t shards, tb_element_t element_name, tb_element_t element_data, tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert_and_check_return_val(element_name.hash && element_data.dupl, tb_null);
+
+    // done
+    tb_bool_t                   ok = tb_false;
+    tb_concurrent_hash_map_t*   map = tb_null;
+    do
+    {
+        // using the global allocator if be null
+        if (!allocator) allocator = tb_allocator();
+        tb_assert_and_check_break(allocator);
+
+        // make map
+        map = (tb_concurrent_hash_map_t*)tb_allocator_malloc0(allocator, sizeof(tb_concurrent_hash_map_t));
+        tb_assert_and_check_break(map);
+
+        // init map
+        map->allocator      = allocator;
+        map->element_name   = element_name;
+        map->element_data   = element_data;
+
+        // the element data uses the allocator of the container if the element has no allocator
+        if (!map->element_name.allocator) map->element_name.allocator = allocator;
+        if (!map->element_data.allocator) map->element_data.allocator = allocator;
+
+        // init the shards count
+        if (!shards) shards = tb_processor_count() * TB_CONCURRENT_HASH_MAP_SHARDS_CPU;
+        shards = tb_align_pow2(tb_max(shards, 1));
+        map->shards_count = tb_min(shards, TB_CONCURRENT_HASH_MAP_SHARDS_MAXN);
+
+        // make shards
+        map->shards_data = (tb_byte_t*)tb_allocator_malloc0(allocator, (map->shards_count + 1) * sizeof(tb_concurrent_hash_map_shard_t));
+        tb_assert_and_check_break(map->shards_data);
+
+        // align the shards by the cache line
+        map->shards = (tb_concurrent_hash_map_shard_t*)tb_align((tb_size_t)map->shards_data, TB_L1_CACHE_BYTES);
+
+        // init the hash map of each shard
+        tb_size_t i = 0;
+        for (i = 0; i < map->shards_count; i++)
+        {
+            map->shards[i].hash_map = tb_hash_map_init_with_allocator(TB_HASH_MAP_BUCKET_SIZE_MICRO, map->element_name, map->element_data, allocator);
+            tb_assert_and_check_break(map->shards[i].hash_map);
+        }
+        tb_check_break(i == map->shards_count);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (map) tb_concurrent_hash_map_exit((tb_concurrent_hash_map_ref_t)map);
+        map = tb_null;
+    }
+
+    // ok?
+    return (tb_concurrent_hash_map_ref_t)map;
+}
+tb_void_t tb_concurrent_hash_map_exit(tb_concurrent_hash_map_ref_t self)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return(map);
+
+    // exit shards
+    if (map->shards_data)
+    {
+        tb_size_t i = 0;
+        for (i = 0; i < map->shards_count; i++)
+        {
+            if (map->shards[i].hash_map) tb_hash_map_exit(map->shards[i].hash_map);
+            map->shards[i].hash_map = tb_null;
+        }
+        tb_allocator_free(map->allocator, map->shards_data);
+    }
+
+    // exit it
+    tb_allocator_free(map->allocator, map);
+}
+tb_void_t tb_concurrent_hash_map_clear(tb_concurrent_hash_map_ref_t self)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return(map);
+
+    // clear shards
+    tb_size_t i = 0;
+    for (i = 0; i < map->shards_count; i++)
+    {
+        tb_concurrent_hash_map_shard_t* shard = &map->shards[i];
+        tb_concurrent_hash_map_lock_enter_write(&shard->lock);
+        tb_hash_map_clear(shard->hash_map);
+        tb_concurrent_hash_map_lock_leave_write(&shard->lock);
+    }
+}
+tb_bool_t tb_concurrent_hash_map_get(tb_concurrent_hash_map_ref_t self, tb_cpointer_t name, tb_pointer_t data)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return_val(map, tb_false);
+
+    // the shard
+    tb_concurrent_hash_map_shard_t* shard = tb_concurrent_hash_map_shard(map, name);
+
+    /* get it with the shared lock
+     *
+     * @note we cannot use the iterator item here, because it will modify the current item of the hash map
+     */
+    tb_pointer_t item = tb_null;
+    tb_concurrent_hash_map_lock_enter_read(&shard->lock);
+    tb_bool_t ok = tb_hash_map_lookup(shard->hash_map, name, &item);
+    if (ok && data) map->element_data.dupl(&map->element_data, data, item);
+    tb_concurrent_hash_map_lock_leave_read(&shard->lock);
+
+    // ok?
+    return ok;
+}
+tb_bool_t tb_concurrent_hash_map_insert(tb_concurrent_hash_map_ref_t self, tb_cpointer_t name, tb_cpointer_t data)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return_val(map, tb_false);
+
+    // the shard
+    tb_concurrent_hash_map_shard_t* shard = tb_concurrent_hash_map_shard(map, name);
+
+    // insert it
+    tb_concurrent_hash_map_lock_enter_write(&shard->lock);
+    tb_bool_t ok = tb_hash_map_insert(shard->hash_map, name, data) != 0;
+    tb_concurrent_hash_map_lock_leave_write(&shard->lock);
+
+    // ok?
+    return ok;
+}
+tb_long_t tb_concurrent_hash_map_get_or_insert(tb_concurrent_hash_map_ref_t self, tb_cpointer_t name, tb_cpointer_t data, tb_pointer_t item)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return_val(map, -1);
+
+    // the shard
+    tb_concurrent_hash_map_shard_t* shard = tb_concurrent_hash_map_shard(map, name);
+
+    // done
+    tb_long_t ok = -1;
+    tb_concurrent_hash_map_lock_enter_write(&shard->lock);
+    do
+    {
+        // exists? get it
+        tb_size_t itor = tb_hash_map_find(shard->hash_map, name);
+        if (itor)
+        {
+            tb_hash_map_item_ref_t hash_item = (tb_hash_map_item_ref_t)tb_iterator_item(shard->hash_map, itor);
+            tb_assert_and_check_break(hash_item);
+
+            if (item) map->element_data.dupl(&map->element_data, item, hash_item->data);
+            ok = 0;
+            break;
+        }
+
+        // insert it
+        itor = tb_hash_map_insert(shard->hash_map, name, data);
+        tb_check_break(itor);
+
+        // get the inserted data
+        if (item) map->element_data.dupl(&map->element_data, item, tb_hash_map_get(shard->hash_map, name));
+
+        // ok
+        ok = 1;
+
+    } while (0);
+    tb_concurrent_hash_map_lock_leave_write(&shard->lock);
+
+    // ok?
+    return ok;
+}
+tb_bool_t tb_concurrent_hash_map_compute(tb_concurrent_hash_map_ref_t self, tb_cpointer_t name, tb_concurrent_hash_map_compute_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return_val(map && func, tb_false);
+
+    // the shard
+    tb_concurrent_hash_map_shard_t* shard = tb_concurrent_hash_map_shard(map, name);
+
+    // done
+    tb_bool_t ok = tb_false;
+    tb_concurrent_hash_map_lock_enter_write(&shard->lock);
+    do
+    {
+        // find it
+        tb_size_t itor = tb_hash_map_find(shard->hash_map, name);
+        tb_check_break(itor);
+
+        // the item
+        tb_hash_map_item_ref_t hash_item = (tb_hash_map_item_ref_t)tb_iterator_item(shard->hash_map, itor);
+        tb_assert_and_check_break(hash_item);
+
+        // compute it
+        tb_cpointer_t data = hash_item->data;
+        switch (func(hash_item, &data, priv))
+        {
+        case TB_CONCURRENT_HASH_MAP_COMPUTE_REPLACE:
+            tb_hash_map_insert(shard->hash_map, name, data);
+            break;
+        case TB_CONCURRENT_HASH_MAP_COMPUTE_REMOVE:
+            tb_iterator_remove(shard->hash_map, itor);
+            break;
+        default:
+            break;
+        }
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+    tb_concurrent_hash_map_lock_leave_write(&shard->lock);
+
+    // ok?
+    return ok;
+}
+tb_bool_t tb_concurrent_hash_map_remove(tb_concurrent_hash_map_ref_t self, tb_cpointer_t name)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return_val(map, tb_false);
+
+    // the shard
+    tb_concurrent_hash_map_shard_t* shard = tb_concurrent_hash_map_shard(map, name);
+
+    // remove it
+    tb_concurrent_hash_map_lock_enter_write(&shard->lock);
+    tb_size_t itor = tb_hash_map_find(shard->hash_map, name);
+    if (itor) tb_iterator_remove(shard->hash_map, itor);
+    tb_concurrent_hash_map_lock_leave_write(&shard->lock);
+
+    // ok?
+    return itor != 0;
+}
+tb_size_t tb_concurrent_hash_map_remove_if(tb_concurrent_hash_map_ref_t self, tb_concurrent_hash_map_walk_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return_val(map && func, 0);
+
+    // remove the items of each shard, the removing will not move the other items
+    tb_size_t i = 0;
+    tb_size_t removed = 0;
+    for (i = 0; i < map->shards_count; i++)
+    {
+        tb_concurrent_hash_map_shard_t* shard = &map->shards[i];
+        tb_concurrent_hash_map_lock_enter_write(&shard->lock);
+        tb_size_t itor = tb_iterator_head(shard->hash_map);
+        while (itor != tb_iterator_tail(shard->hash_map))
+        {
+            tb_size_t next = tb_iterator_next(shard->hash_map, itor);
+            if (func((tb_hash_map_item_ref_t)tb_iterator_item(shard->hash_map, itor), priv))
+            {
+                tb_iterator_remove(shard->hash_map, itor);
+                removed++;
+            }
+            itor = next;
+        }
+        tb_concurrent_hash_map_lock_leave_write(&shard->lock);
+    }
+
+    // the removed count
+    return removed;
+}
+tb_void_t tb_concurrent_hash_map_walk(tb_concurrent_hash_map_ref_t self, tb_concurrent_hash_map_walk_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return(map && func);
+
+    /* walk the items of each shard
+     *
+     * @note we need the exclusive lock, because the iterator item will modify the current item of the hash map
+     */
+    tb_size_t i = 0;
+    tb_bool_t stop = tb_false;
+    for (i = 0; i < map->shards_count && !stop; i++)
+    {
+        tb_concurrent_hash_map_shard_t* shard = &map->shards[i];
+        tb_concurrent_hash_map_lock_enter_write(&shard->lock);
+        tb_for_all (tb_hash_map_item_ref_t, item, shard->hash_map)
+        {
+            if (!func(item, priv)) 
+            {
+                stop = tb_true;
+                break;
+            }
+        }
+        tb_concurrent_hash_map_lock_leave_write(&shard->lock);
+    }
+}
+tb_size_t tb_concurrent_hash_map_size(tb_concurrent_hash_map_ref_t self)
+{
+    // check
+    tb_concurrent_hash_map_t* map = (tb_concurrent_hash_map_t*)self;
+    tb_assert_and_check_return_val(map, 0);
+
+    // the size of all shards
+    tb_size_t i = 0;
+    tb_size_t size = 0;
+    for (i = 0; i < map->shards_count; i++)
+    {
+        tb_concurrent_hash_map_shard_t* shard = &map->shards[i];
+        tb_concurrent_hash_map_lock_enter_read(&shard->lock);
+        size += tb_hash_map_size(shard->hash_map);
+        tb_concurrent_hash_map_lock_leave_read(&shard->lock);
+    }
+    return size;
+}
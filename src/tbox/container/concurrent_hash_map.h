@@ -0,0 +1,242 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        concurrent_hash_map.h
+ * @ingroup     container
+ *
+ */
+#ifndef TB_CONTAINER_CONCURRENT_HASH_MAP_H
+#define TB_CONTAINER_CONCURRENT_HASH_MAP_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "element.h"
+#include "hash_map.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the concurrent hash map compute result enum
+typedef enum __tb_concurrent_hash_map_compute_e
+{
+    TB_CONCURRENT_HASH_MAP_COMPUTE_KEEP     = 0 //!< keep the item data
+,   TB_CONCURRENT_HASH_MAP_COMPUTE_REPLACE  = 1 //!< replace the item data with the new data
+,   TB_CONCURRENT_HASH_MAP_COMPUTE_REMOVE   = 2 //!< remove this item
+
+}tb_concurrent_hash_map_compute_e;
+
+/*! the concurrent hash map ref type
+ *
+ * the hash map can be shared between threads without the external lock.
+ *
+ * <pre>
+ * shards: |  shard 0  |  shard 1  |  shard 2  |    ...    | shard n - 1 |
+ *            rwlock      rwlock      rwlock                   rwlock
+ *           hash_map    hash_map    hash_map                 hash_map
+ *
+ * the shard index is selected by the hash of the name and each shard is placed on its own cache line
+ *
+ * get:                 shared lock of the shard, the readers do not block each other
+ * insert/remove:       exclusive lock of the shard, the waiting writer will block the new readers
+ * walk/remove_if:      lock the shards one by one, so it will not block the whole map
+ * </pre>
+ *
+ * @note the item data is copied out by element.dupl() in tb_concurrent_hash_map_get() and tb_concurrent_hash_map_get_or_insert(),
+ * so the copied data need be freed by element.free() if the element has the free function (.e.g tb_element_str(tb_true)),
+ * and the element.allocator need be same as the allocator of the map if it was inited by tb_concurrent_hash_map_init_with_allocator()
+ */
+typedef __tb_typeref__(concurrent_hash_map);
+
+/*! the compute func type
+ *
+ * it will be called with the exclusive lock of the shard, so it cannot access the map again.
+ *
+ * @param item          the item in the map, the data of the mem element can be modified in place
+ * @param pdata         the new data for TB_CONCURRENT_HASH_MAP_COMPUTE_REPLACE
+ * @param priv          the user private data
+ *
+ * @return              TB_CONCURRENT_HASH_MAP_COMPUTE_KEEP, TB_CONCURRENT_HASH_MAP_COMPUTE_REPLACE or TB_CONCURRENT_HASH_MAP_COMPUTE_REMOVE
+ */
+typedef tb_size_t       (*tb_concurrent_hash_map_compute_func_t)(tb_hash_map_item_ref_t item, tb_cpointer_t* pdata, tb_cpointer_t priv);
+
+/*! the walk func type
+ *
+ * it will be called with the exclusive lock of the current shard, so it cannot access the map again.
+ *
+ * @param item          the item in the map
+ * @param priv          the user private data
+ *
+ * @return              tb_true: continue or remove this item for tb_concurrent_hash_map_remove_if(), tb_false: break or keep it
+ */
+typedef tb_bool_t       (*tb_concurrent_hash_map_walk_func_t)(tb_hash_map_item_ref_t item, tb_cpointer_t priv);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init map
+ *
+ * @param shards        the shards count, it will be aligned to the power of 2, using the default count if be zero
+ * @param element_name  the element for name
+ * @param element_data  the element for data
+ *
+ * @return              the map
+ */
+tb_concurrent_hash_map_ref_t    tb_concurrent_hash_map_init(tb_size_t shards, tb_element_t element_name, tb_element_t element_data);
+
+/*! init map with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param shards        the shards count, it will be aligned to the power of 2, using the default count if be zero
+ * @param element_name  the element for name
+ * @param element_data  the element for data
+ * @param allocator     the allocator, using the global allocator if be null
+ *
+ * @return              the map
+ */
+tb_concurrent_hash_map_ref_t    tb_concurrent_hash_map_init_with_allocator(tb_size_t shards, tb_element_t element_name, tb_element_t element_data, tb_allocator_ref_t allocator);
+
+/*! exit map, it is not thread-safe
+ *
+ * @param map           the map
+ */
+tb_void_t                       tb_concurrent_hash_map_exit(tb_concurrent_hash_map_ref_t map);
+
+/*! clear map
+ *
+ * @param map           the map
+ */
+tb_void_t                       tb_concurrent_hash_map_clear(tb_concurrent_hash_map_ref_t map);
+
+/*! get the item data
+ *
+ * @code
+ * tb_long_t value = 0;
+ * if (tb_concurrent_hash_map_get(map, name, &value))
+ * {
+ *     // ...
+ * }
+ * @endcode
+ *
+ * @param map           the map
+ * @param name          the item name
+ * @param data          the data buffer with element_data.size bytes, only check whether the item exists if be null
+ *
+ * @return              tb_true or tb_false if the item does not exist
+ */
+tb_bool_t                       tb_concurrent_hash_map_get(tb_concurrent_hash_map_ref_t map, tb_cpointer_t name, tb_pointer_t data);
+
+/*! insert or replace the item
+ *
+ * @param map           the map
+ * @param name          the item name
+ * @param data          the item data
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t                       tb_concurrent_hash_map_insert(tb_concurrent_hash_map_ref_t map, tb_cpointer_t name, tb_cpointer_t data);
+
+/*! get the item data or insert it atomically if it does not exist
+ *
+ * @param map           the map
+ * @param name          the item name
+ * @param data          the item data for inserting
+ * @param item          the data buffer with element_data.size bytes for the current data, ignore it if be null
+ *
+ * @return              1: inserted, 0: the item exists, -1: failed
+ */
+tb_long_t                       tb_concurrent_hash_map_get_or_insert(tb_concurrent_hash_map_ref_t map, tb_cpointer_t name, tb_cpointer_t data, tb_pointer_t item);
+
+/*! compute the item data atomically if the item exists
+ *
+ * @code
+    static tb_size_t tb_demo_compute(tb_hash_map_item_ref_t item, tb_cpointer_t* pdata, tb_cpointer_t priv)
+    {
+        *pdata = (tb_cpointer_t)((tb_size_t)item->data + 1);
+        return TB_CONCURRENT_HASH_MAP_COMPUTE_REPLACE;
+    }
+
+    tb_concurrent_hash_map_compute(map, name, tb_demo_compute, tb_null);
+ * @endcode
+ *
+ * @param map           the map
+ * @param name          the item name
+ * @param func          the compute func
+ * @param priv          the user private data
+ *
+ * @return              tb_true or tb_false if the item does not exist
+ */
+tb_bool_t                       tb_concurrent_hash_map_compute(tb_concurrent_hash_map_ref_t map, tb_cpointer_t name, tb_concurrent_hash_map_compute_func_t func, tb_cpointer_t priv);
+
+/*! remove the item
+ *
+ * @param map           the map
+ * @param name          the item name
+ *
+ * @return              tb_true or tb_false if the item does not exist
+ */
+tb_bool_t                       tb_concurrent_hash_map_remove(tb_concurrent_hash_map_ref_t map, tb_cpointer_t name);
+
+/*! remove the items if func returns tb_true
+ *
+ * @param map           the map
+ * @param func          the walk func
+ * @param priv          the user private data
+ *
+ * @return              the removed items count
+ */
+tb_size_t                       tb_concurrent_hash_map_remove_if(tb_concurrent_hash_map_ref_t map, tb_concurrent_hash_map_walk_func_t func, tb_cpointer_t priv);
+
+/*! walk all items 
+ *
+ * the shards are walked one by one and the other shards can be accessed by the other threads at the same time,
+ * so it is weakly consistent: the changes of the walked shards will not be seen.
+ *
+ * @param map           the map
+ * @param func          the walk func
+ * @param priv          the user private data
+ */
+tb_void_t                       tb_concurrent_hash_map_walk(tb_concurrent_hash_map_ref_t map, tb_concurrent_hash_map_walk_func_t func, tb_cpointer_t priv);
+
+/*! the map size, it is only a snapshot if the map is being accessed by the other threads
+ *
+ * @param map           the map
+ *
+ * @return              the map size
+ */
+tb_size_t                       tb_concurrent_hash_map_size(tb_concurrent_hash_map_ref_t map);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
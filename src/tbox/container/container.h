@@ -39,6 +39,8 @@
 #include "hash_map.h"
 #include "queue.h"
 #include "circle_queue.h"
+#include "ring_queue.h"
+#include "concurrent_hash_map.h"
 #include "priority_queue.h"
 #include "list.h"
 #include "list_entry.h"
@@ -0,0 +1,77 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        element.c
+ * @ingroup     container
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "element.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static __tb_inline__ tb_bool_t tb_element_scalar_same(tb_element_ref_t element, tb_element_ref_t scalar)
+{
+    // the element functions have not been changed?
+    return (    element->size == scalar->size
+            &&  element->comp == scalar->comp
+            &&  element->data == scalar->data
+            &&  element->free == scalar->free
+            &&  element->dupl == scalar->dupl
+            &&  element->repl == scalar->repl
+            &&  element->copy == scalar->copy)? tb_true : tb_false;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_size_t tb_element_scalar(tb_element_ref_t element)
+{
+    // check
+    tb_assert_and_check_return_val(element, TB_ELEMENT_SCALAR_NONE);
+
+    // done
+    tb_element_t scalar;
+    switch (element->type)
+    {
+    case TB_ELEMENT_TYPE_LONG:
+        scalar = tb_element_long();
+        if (tb_element_scalar_same(element, &scalar)) return TB_ELEMENT_SCALAR_LONG;
+        break;
+    case TB_ELEMENT_TYPE_SIZE:
+        scalar = tb_element_size();
+        if (tb_element_scalar_same(element, &scalar)) return TB_ELEMENT_SCALAR_SIZE;
+        break;
+    case TB_ELEMENT_TYPE_PTR:
+        scalar = tb_element_ptr(tb_null, tb_null);
+        if (tb_element_scalar_same(element, &scalar)) return TB_ELEMENT_SCALAR_SIZE;
+        break;
+    default:
+        break;
+    }
+
+    // not scalar
+    return TB_ELEMENT_SCALAR_NONE;
+}
@@ -30,6 +30,7 @@
  * includes
  */
 #include "prefix.h"
+#include "../memory/allocator.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
@@ -182,6 +183,19 @@ typedef enum __tb_element_type_t
 
 }tb_element_type_t;
 
+/*! the element scalar type
+ *
+ * the scalar element saves the integer or pointer value inline and uses the default functions,
+ * so the containers and algorithms can compare and copy it directly without the function calls.
+ */
+typedef enum __tb_element_scalar_e
+{
+    TB_ELEMENT_SCALAR_NONE         = 0     //!< not scalar, using the element functions
+,   TB_ELEMENT_SCALAR_LONG         = 1     //!< the tb_long_t value, compared as the signed integer
+,   TB_ELEMENT_SCALAR_SIZE         = 2     //!< the tb_size_t or pointer value, compared as the unsigned integer
+
+}tb_element_scalar_e;
+
 /// the element type
 typedef struct __tb_element_t
 {
@@ -197,6 +211,9 @@ typedef struct __tb_element_t
     /// the priv data
     tb_cpointer_t               priv;
 
+    /// the allocator for the element data, using the global allocator if be null
+    tb_allocator_ref_t          allocator;
+
     /// the hash function
     tb_element_hash_func_t      hash;
 
@@ -318,6 +335,28 @@ tb_element_t        tb_element_obj(tb_noarg_t);
  */
 tb_element_t        tb_element_mem(tb_size_t size, tb_element_free_func_t free, tb_cpointer_t priv);
 
+/*! the element scalar type
+ *
+ * the element is scalar only if it is made by tb_element_long(), tb_element_size() or tb_element_ptr() without the free function,
+ * and its compare, data, copy and free functions have not been changed.
+ *
+ * @param element   the element
+ *
+ * @return          the scalar type, .e.g TB_ELEMENT_SCALAR_LONG, TB_ELEMENT_SCALAR_NONE if it is not scalar
+ */
+tb_size_t           tb_element_scalar(tb_element_ref_t element);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * inlines
+ */
+
+/// compare the data of the scalar element, it is same as element.comp()
+static __tb_inline_force__ tb_long_t tb_element_scalar_comp(tb_size_t scalar, tb_cpointer_t ldata, tb_cpointer_t rdata)
+{
+    if (scalar == TB_ELEMENT_SCALAR_LONG) return ((tb_long_t)ldata < (tb_long_t)rdata)? -1 : ((tb_long_t)ldata > (tb_long_t)rdata);
+    return ((tb_size_t)ldata < (tb_size_t)rdata)? -1 : ((tb_size_t)ldata > (tb_size_t)rdata);
+}
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
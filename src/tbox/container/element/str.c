@@ -68,7 +68,7 @@ static tb_void_t tb_element_str_free(tb_element_ref_t element, tb_pointer_t buff
     if (cstr) 
     {
         // free it
-        tb_free(cstr);
+        tb_allocator_free(element->allocator? element->allocator : tb_allocator(), cstr);
 
         // clear it
         *((tb_pointer_t*)buff) = tb_null;
@@ -80,7 +80,19 @@ static tb_void_t tb_element_str_dupl(tb_element_ref_t element, tb_pointer_t buff
     tb_assert_and_check_return(element && buff);
 
     // duplicate it
-    if (data) *((tb_char_t const**)buff) = tb_strdup((tb_char_t const*)data);
+    if (data)
+    {
+        // make it
+        tb_size_t   size = tb_strlen((tb_char_t const*)data);
+        tb_char_t*  cstr = (tb_char_t*)tb_allocator_malloc(element->allocator? element->allocator : tb_allocator(), size + 1);
+        tb_assert_and_check_return(cstr);
+
+        // copy it
+        tb_memcpy(cstr, data, size + 1);
+
+        // save it
+        *((tb_char_t const**)buff) = cstr;
+    }
     // clear it
     else *((tb_char_t const**)buff) = tb_null;
 }
@@ -116,7 +128,7 @@ static tb_void_t tb_element_str_repl(tb_element_ref_t element, tb_pointer_t buff
             tb_size_t copy = p - (tb_char_t*)cstr;
 
             // grow size
-            cstr = tb_ralloc(cstr, copy + left + 1);
+            cstr = tb_allocator_ralloc(element->allocator? element->allocator : tb_allocator(), cstr, copy + left + 1);
             tb_assert(cstr);
 
             // copy the left data
@@ -41,73 +41,134 @@
 #include "../stream/stream.h"
 #include "../platform/platform.h"
 #include "../algorithm/algorithm.h"
+#if defined(TB_ARCH_SSE2)
+#   include <emmintrin.h>
+#elif defined(TB_ARCH_ARM_NEON) || (defined(TB_ARCH_ARM64) && defined(__ARM_NEON))
+#   include <arm_neon.h>
+#   define TB_HASH_MAP_GROUP_NEON
+#endif
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * macros
  */
 
-// index
-#if TB_CPU_BIT64
-#   define tb_hash_map_index_make(buck, item)           (((tb_size_t)((item) & 0xffffffff) << 32) | ((buck) & 0xffffffff))
-#   define tb_hash_map_index_buck(index)                ((index) & 0xffffffff)
-#   define tb_hash_map_index_item(index)                (((index) >> 32) & 0xffffffff)
+/* the control bytes group width
+ *
+ * sse2: 16 control bytes, the match mask has one bit per byte
+ * neon and others: 8 control bytes, the match mask has the high bit of each byte
+ */
+#if defined(TB_ARCH_SSE2)
+#   define TB_HASH_MAP_GROUP_WIDTH                      (16)
 #else
-#   define tb_hash_map_index_make(buck, item)           (((tb_size_t)((item) & 0xffff) << 16) | ((buck) & 0xffff))
-#   define tb_hash_map_index_buck(index)                ((index) & 0xffff)
-#   define tb_hash_map_index_item(index)                (((index) >> 16) & 0xffff)
+#   define TB_HASH_MAP_GROUP_WIDTH                      (8)
 #endif
 
-// the self bucket default size
+// the control byte of the empty slot
+#define TB_HASH_MAP_CTRL_EMPTY                          (0x80)
+
+// the control byte of the deleted slot
+#define TB_HASH_MAP_CTRL_DELETED                        (0xfe)
+
+// the control byte is full? the full slot saves the 7-bits hash (h2) of the name
+#define tb_hash_map_ctrl_full(c)                        (!((c) & 0x80))
+
+// the hash => the probe start (h1) and the control byte (h2)
+#define tb_hash_map_hash_h1(hash)                       ((hash) >> 7)
+#define tb_hash_map_hash_h2(hash)                       ((tb_byte_t)((hash) & 0x7f))
+
+// the maximum items count for the given capacity, the max load factor is 7/8
+#define tb_hash_map_capacity_growth(capacity)           ((capacity) - ((capacity) >> 3))
+
+// the self default capacity
 #ifdef __tb_small__
 #   define TB_HASH_MAP_BUCKET_SIZE_DEFAULT              TB_HASH_MAP_BUCKET_SIZE_MICRO
 #else
 #   define TB_HASH_MAP_BUCKET_SIZE_DEFAULT              TB_HASH_MAP_BUCKET_SIZE_SMALL
 #endif
 
-// the self bucket maximum size
-#define TB_HASH_MAP_BUCKET_MAXN                         (1 << 16)
-
-// the self bucket item maximum size
-#define TB_HASH_MAP_BUCKET_ITEM_MAXN                    (1 << 16)
+/* the minimum capacity of the incremental rehash
+ *
+ * the smaller table will be rehashed at once, it is fast enough
+ */
+#ifdef __tb_small__
+#   define TB_HASH_MAP_INCREMENTAL_MINN                 (4096)
+#else
+#   define TB_HASH_MAP_INCREMENTAL_MINN                 (16384)
+#endif
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
  */
 
-// the hash map item list type
-typedef struct __tb_hash_map_item_list_t
+// the group match mask type
+#if defined(TB_ARCH_SSE2)
+typedef tb_uint32_t                 tb_hash_map_mask_t;
+#else
+typedef tb_uint64_t                 tb_hash_map_mask_t;
+#endif
+
+// the hash map table type
+typedef struct __tb_hash_map_table_t
 {
-    // the list size
-    tb_size_t                       size;
+    /* the control bytes, capacity + group width
+     *
+     * the first group width bytes are cloned to the tail, 
+     * so we can load a group at any slot without wrapping around
+     */
+    tb_byte_t*                      ctrl;
+
+    // the slots, the name and data of each item are saved inline
+    tb_byte_t*                      slots;
 
-    // the list maxn
-    tb_size_t                       maxn;
+    // the slots count, it is aligned to the power of 2
+    tb_size_t                       capacity;
 
-}tb_hash_map_item_list_t;
+}tb_hash_map_table_t;
 
-// the hash map type
+/* the hash map type
+ *
+ * the items of the old table are migrated to the current table incrementally after growing,
+ * the item is only in one of these tables and the old table is only used by the lookup and removing.
+ *
+ * itor: [1, table.capacity]: the current table, (table.capacity, table.capacity + table_old.capacity]: the old table
+ */
 typedef struct __tb_hash_map_t
 {
     // the item itor
     tb_iterator_t                   itor;
 
-    // the hash list
-    tb_hash_map_item_list_t**       hash_list;
+    // the current table
+    tb_hash_map_table_t             table;
+
+    // the old table which is being migrated
+    tb_hash_map_table_t             table_old;
+
+    // the next slot index of the old table for migrating
+    tb_size_t                       migrate_index;
+
+    // the slots count of the old table for migrating each time
+    tb_size_t                       migrate_step;
+
+    // the initial capacity
+    tb_size_t                       capacity_init;
 
-    // the hash list size
-    tb_size_t                       hash_size;
+    /* the items count which can be inserted to the current table before growing
+     *
+     * the slots for the items of the old table have been reserved
+     */
+    tb_size_t                       growth_left;
 
     // the current item for iterator
     tb_hash_map_item_t              item;
 
-    // the item size
+    // the item size of all tables
     tb_size_t                       item_size;
 
-    // the item maxn
-    tb_size_t                       item_maxn;
+    // the item step
+    tb_size_t                       item_step;
 
-    // the item grow
-    tb_size_t                       item_grow;
+    // the allocator
+    tb_allocator_ref_t              allocator;
 
     // the element for name
     tb_element_t                    element_name;
@@ -115,129 +176,414 @@ typedef struct __tb_hash_map_t
     // the element for data
     tb_element_t                    element_data;
 
+    // the element scalar type for name, the scalar names are hashed and compared directly
+    tb_size_t                       name_scalar;
+
+    // the element scalar type for data, the scalar data are copied directly
+    tb_size_t                       data_scalar;
+
 }tb_hash_map_t;
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * group implementation
+ */
+#if defined(TB_ARCH_SSE2)
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match(tb_byte_t const* ctrl, tb_byte_t h2)
+{
+    __m128i group = _mm_loadu_si128((__m128i const*)ctrl);
+    return (tb_hash_map_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((tb_char_t)h2)));
+}
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match_empty(tb_byte_t const* ctrl)
+{
+    __m128i group = _mm_loadu_si128((__m128i const*)ctrl);
+    return (tb_hash_map_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((tb_char_t)TB_HASH_MAP_CTRL_EMPTY)));
+}
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match_free(tb_byte_t const* ctrl)
+{
+    // the empty or deleted slots
+    return (tb_hash_map_mask_t)_mm_movemask_epi8(_mm_loadu_si128((__m128i const*)ctrl));
+}
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match_full(tb_byte_t const* ctrl)
+{
+    return tb_hash_map_group_match_free(ctrl) ^ 0xffff;
+}
+static __tb_inline__ tb_size_t tb_hash_map_mask_head(tb_hash_map_mask_t mask)
+{
+    return tb_bits_cl0_u32_le(mask);
+}
+static __tb_inline__ tb_size_t tb_hash_map_mask_tail(tb_hash_map_mask_t mask)
+{
+    return tb_bits_cl0_u32_be(mask) - 16;
+}
+#else
+#   define TB_HASH_MAP_GROUP_LSBS                       (0x0101010101010101ULL)
+#   define TB_HASH_MAP_GROUP_MSBS                       (0x8080808080808080ULL)
+#   ifdef TB_HASH_MAP_GROUP_NEON
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match(tb_byte_t const* ctrl, tb_byte_t h2)
+{
+    uint8x8_t eq = vceq_u8(vld1_u8(ctrl), vdup_n_u8(h2));
+    return vget_lane_u64(vreinterpret_u64_u8(eq), 0) & TB_HASH_MAP_GROUP_MSBS;
+}
+#   else
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match(tb_byte_t const* ctrl, tb_byte_t h2)
+{
+    /* the zero bytes of (group ^ h2), it may be matched some full slots falsely, 
+     * but it is harmless because we will compare the name of the matched slots
+     */
+    tb_uint64_t group = tb_bits_get_u64_le(ctrl) ^ (TB_HASH_MAP_GROUP_LSBS * h2);
+    return (group - TB_HASH_MAP_GROUP_LSBS) & ~group & TB_HASH_MAP_GROUP_MSBS;
+}
+#   endif
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match_empty(tb_byte_t const* ctrl)
+{
+    // 0x80: the high bit is 1 and the bit 1 is 0, 0xfe (deleted) and the full slots are not matched
+    tb_uint64_t group = tb_bits_get_u64_le(ctrl);
+    return group & (~group << 6) & TB_HASH_MAP_GROUP_MSBS;
+}
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match_free(tb_byte_t const* ctrl)
+{
+    return tb_bits_get_u64_le(ctrl) & TB_HASH_MAP_GROUP_MSBS;
+}
+static __tb_inline__ tb_hash_map_mask_t tb_hash_map_group_match_full(tb_byte_t const* ctrl)
+{
+    return ~tb_bits_get_u64_le(ctrl) & TB_HASH_MAP_GROUP_MSBS;
+}
+static __tb_inline__ tb_size_t tb_hash_map_mask_head(tb_hash_map_mask_t mask)
+{
+    return tb_bits_cl0_u64_le(mask) >> 3;
+}
+static __tb_inline__ tb_size_t tb_hash_map_mask_tail(tb_hash_map_mask_t mask)
+{
+    return tb_bits_cl0_u64_be(mask) >> 3;
+}
+#endif
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * private implementation
  */
-#if 0
-// linear finder
-static tb_bool_t tb_hash_map_item_find(tb_hash_map_t* hash_map, tb_cpointer_t name, tb_size_t* pbuck, tb_size_t* pitem)
+static __tb_inline__ tb_size_t tb_hash_map_hash(tb_hash_map_t* hash_map, tb_cpointer_t name)
 {
-    tb_assert_and_check_return_val(hash_map && hash_map->hash_list && hash_map->hash_size, tb_false);
-    
-    // get step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert_and_check_return_val(step, tb_false);
-
-    // comupte hash_map from name
-    tb_size_t buck = hash_map->element_name.hash(&hash_map->element_name, name, hash_map->hash_size - 1, 0);
-    tb_assert_and_check_return_val(buck < hash_map->hash_size, tb_false);
-
-    // update buck
-    if (pbuck) *pbuck = buck;
-
-    // get list
-    tb_hash_map_item_list_t* list = hash_map->hash_list[buck];
-    tb_check_return_val(list && list->size, tb_false);
-
-    // find item
-    tb_long_t   r = 1;
-    tb_size_t   i = 0;
-    tb_size_t   n = list->size;
-    for (i = 0; i < n; i++)
+    // the full hash of the name, the scalar name will be mixed directly
+    tb_size_t hash = hash_map->name_scalar? (tb_size_t)name : hash_map->element_name.hash(&hash_map->element_name, name, (tb_size_t)-1, 0);
+
+    /* mix it, because the low bits are used to find the slot and the element hash of the integer is weak
+     *
+     * @see the finalizer of murmur3
+     */
+#if TB_CPU_BIT64
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+#else
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+#endif
+    return hash;
+}
+static __tb_inline__ tb_pointer_t tb_hash_map_item_name(tb_hash_map_t* hash_map, tb_cpointer_t item)
+{
+    return hash_map->name_scalar? *((tb_pointer_t*)item) : hash_map->element_name.data(&hash_map->element_name, item);
+}
+static __tb_inline__ tb_pointer_t tb_hash_map_item_data(tb_hash_map_t* hash_map, tb_cpointer_t item)
+{
+    item = (tb_byte_t const*)item + hash_map->element_name.size;
+    return hash_map->data_scalar? *((tb_pointer_t*)item) : hash_map->element_data.data(&hash_map->element_data, item);
+}
+static __tb_inline__ tb_void_t tb_hash_map_ctrl_set(tb_byte_t* ctrl, tb_size_t capacity, tb_size_t index, tb_byte_t c)
+{
+    // set it and the cloned byte at the tail, the cloned position is index itself if index >= group width - 1
+    ctrl[index] = c;
+    ctrl[((index - (TB_HASH_MAP_GROUP_WIDTH - 1)) & (capacity - 1)) + (TB_HASH_MAP_GROUP_WIDTH - 1)] = c;
+}
+static tb_size_t tb_hash_map_slot_free(tb_byte_t const* ctrl, tb_size_t capacity, tb_size_t hash)
+{
+    // check
+    tb_assert(ctrl && capacity);
+
+    // probe the groups: offset, offset + 1 * width, offset + 3 * width, offset + 6 * width, ...
+    tb_size_t mask      = capacity - 1;
+    tb_size_t offset    = tb_hash_map_hash_h1(hash) & mask;
+    tb_size_t probe     = 0;
+    while (1)
     {
-        // get item
-        tb_byte_t const* item = ((tb_byte_t*)&list[1]) + i * step;
+        // find the first empty or deleted slot in this group
+        tb_hash_map_mask_t m = tb_hash_map_group_match_free(ctrl + offset);
+        if (m) return (offset + tb_hash_map_mask_head(m)) & mask;
+
+        // the next group, we will always find a free slot because the load factor is less than 1
+        probe += TB_HASH_MAP_GROUP_WIDTH;
+        tb_assert(probe < capacity);
+        offset = (offset + probe) & mask;
+    }
+
+    // unreachable
+    return 0;
+}
+static tb_size_t tb_hash_map_table_find(tb_hash_map_t* hash_map, tb_hash_map_table_t const* table, tb_cpointer_t name, tb_size_t hash)
+{
+    // check
+    tb_assert(hash_map && table && table->capacity);
+
+    // done
+    tb_size_t           mask    = table->capacity - 1;
+    tb_size_t           offset  = tb_hash_map_hash_h1(hash) & mask;
+    tb_size_t           probe   = 0;
+    tb_byte_t           h2      = tb_hash_map_hash_h2(hash);
+    tb_size_t           step    = hash_map->item_step;
+    tb_byte_t const*    ctrl    = table->ctrl;
+    tb_element_ref_t    element = &hash_map->element_name;
+    tb_bool_t           scalar  = hash_map->name_scalar? tb_true : tb_false;
+    while (1)
+    {
+        // compare the slots which have the same h2 in this group
+        tb_hash_map_mask_t m = tb_hash_map_group_match(ctrl + offset, h2);
+        while (m)
+        {
+            tb_size_t index = (offset + tb_hash_map_mask_head(m)) & mask;
+            tb_byte_t const* item = table->slots + index * step;
+            if (scalar? *((tb_cpointer_t*)item) == name : !element->comp(element, name, element->data(element, item))) return index + 1;
+            m &= m - 1;
+        }
 
-        // compare it
-        r = hash_map->element_name.comp(&hash_map->element_name, name, hash_map->element_name.data(&hash_map->element_name, item));
-        if (r <= 0) break;
+        // end? the probe sequence will be stopped at the group with the empty slot
+        if (tb_hash_map_group_match_empty(ctrl + offset)) break;
+
+        // the next group
+        probe += TB_HASH_MAP_GROUP_WIDTH;
+        tb_check_break(probe < table->capacity);
+        offset = (offset + probe) & mask;
     }
 
-    // update item
-    if (pitem) *pitem = i;
+    // not found
+    return 0;
+}
+static tb_size_t tb_hash_map_table_next(tb_hash_map_table_t const* table, tb_size_t index)
+{
+    // find the next full slot from the given index
+    tb_size_t capacity = table->capacity;
+    while (index < capacity)
+    {
+        tb_hash_map_mask_t m = tb_hash_map_group_match_full(table->ctrl + index);
+        if (m) 
+        {
+            // @note the cloned bytes at the tail are the head slots which have been walked
+            index += tb_hash_map_mask_head(m);
+            return tb_min(index, capacity);
+        }
+        index += TB_HASH_MAP_GROUP_WIDTH;
+    }
 
-    // ok?
-    return !r? tb_true : tb_false;
+    // end
+    return capacity;
 }
-#else
-// binary finder
-static tb_bool_t tb_hash_map_item_find(tb_hash_map_t* hash_map, tb_cpointer_t name, tb_size_t* pbuck, tb_size_t* pitem)
+static __tb_inline__ tb_byte_t* tb_hash_map_slot(tb_hash_map_t* hash_map, tb_size_t itor, tb_hash_map_table_t** ptable, tb_size_t* pindex)
 {
     // check
-    tb_assert_and_check_return_val(hash_map && hash_map->hash_list && hash_map->hash_size, tb_false);
-    
-    // get step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert_and_check_return_val(step, tb_false);
-
-    // comupte hash_map from name
-    tb_size_t buck = hash_map->element_name.hash(&hash_map->element_name, name, hash_map->hash_size - 1, 0);
-    tb_assert_and_check_return_val(buck < hash_map->hash_size, tb_false);
-
-    // update buck
-    if (pbuck) *pbuck = buck;
-
-    // get list
-    tb_hash_map_item_list_t* list = hash_map->hash_list[buck];
-    tb_check_return_val(list && list->size, tb_false);
-
-    // find item
-    tb_long_t   t = 1;
-    tb_size_t   l = 0;
-    tb_size_t   r = list->size;
-    tb_size_t   m = (l + r) >> 1;
-    while (l < r)
+    tb_assert(hash_map && itor);
+
+    // the table and index of the itor
+    tb_hash_map_table_t*    table = &hash_map->table;
+    tb_size_t               index = itor - 1;
+    if (index >= table->capacity)
     {
-        // get item
-        tb_byte_t const* item = ((tb_byte_t*)&list[1]) + m * step;
-
-        // compare it
-        t = hash_map->element_name.comp(&hash_map->element_name, name, hash_map->element_name.data(&hash_map->element_name, item));
-        if (t < 0) r = m;
-        else if (t > 0) l = m + 1;
-        else break;
-    
-        // next
-        m = (l + r) >> 1;
+        index -= table->capacity;
+        table = &hash_map->table_old;
     }
 
-    /* update item
-     *
-     * @note: m is not the prev not same item if not finded and list has repeat items
-     * but this hash_map not exists repeat
-     *
-     * @see tb_binary_pfind()
-     */
-    if (pitem) *pitem = m;
+    // check
+    tb_assert_and_check_return_val(index < table->capacity && tb_hash_map_ctrl_full(table->ctrl[index]), tb_null);
+
+    // save them
+    if (ptable) *ptable = table;
+    if (pindex) *pindex = index;
+
+    // the slot
+    return table->slots + index * hash_map->item_step;
+}
+static tb_size_t tb_hash_map_slot_find(tb_hash_map_t* hash_map, tb_cpointer_t name, tb_size_t hash)
+{
+    // check
+    tb_assert(hash_map);
+
+    // empty?
+    tb_check_return_val(hash_map->item_size, 0);
+
+    // find it from the current table
+    tb_size_t itor = tb_hash_map_table_find(hash_map, &hash_map->table, name, hash);
+
+    // find it from the old table if it is being migrated
+    if (!itor && hash_map->table_old.capacity)
+    {
+        itor = tb_hash_map_table_find(hash_map, &hash_map->table_old, name, hash);
+        if (itor) itor += hash_map->table.capacity;
+    }
 
     // ok?
-    return !t? tb_true : tb_false;
+    return itor;
 }
-#endif
-static tb_bool_t tb_hash_map_item_at(tb_hash_map_t* hash_map, tb_size_t buck, tb_size_t item, tb_pointer_t* pname, tb_pointer_t* pdata)
+static tb_size_t tb_hash_map_slot_next(tb_hash_map_t* hash_map, tb_size_t index)
 {
     // check
-    tb_assert_and_check_return_val(hash_map && hash_map->hash_list && hash_map->hash_size && buck < hash_map->hash_size, tb_false);
-    
-    // get step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert_and_check_return_val(step, tb_false);
+    tb_assert(hash_map);
 
-    // get list
-    tb_hash_map_item_list_t* list = hash_map->hash_list[buck];
-    tb_check_return_val(list && list->size && item < list->size, tb_false);
+    // find the next full slot from the current table
+    tb_size_t capacity = hash_map->table.capacity;
+    if (index < capacity)
+    {
+        index = tb_hash_map_table_next(&hash_map->table, index);
+        if (index < capacity) return index + 1;
+    }
 
-    // get name
-    if (pname) *pname = hash_map->element_name.data(&hash_map->element_name, ((tb_byte_t*)&list[1]) + item * step);
-    
-    // get data
-    if (pdata) *pdata = hash_map->element_data.data(&hash_map->element_data, ((tb_byte_t*)&list[1]) + item * step + hash_map->element_name.size);
+    // find the next full slot from the old table
+    if (hash_map->table_old.capacity)
+    {
+        index = tb_hash_map_table_next(&hash_map->table_old, index - capacity);
+        if (index < hash_map->table_old.capacity) return capacity + index + 1;
+    }
+
+    // tail
+    return 0;
+}
+static tb_void_t tb_hash_map_migrate(tb_hash_map_t* hash_map, tb_size_t count)
+{
+    // check
+    tb_assert(hash_map);
+
+    // no migrating?
+    tb_hash_map_table_t* table_old = &hash_map->table_old;
+    tb_check_return(table_old->capacity);
+
+    // the migrating range
+    tb_size_t index = hash_map->migrate_index;
+    tb_size_t tail  = count < table_old->capacity - index? index + count : table_old->capacity;
+
+    // move the full slots to the current table
+    tb_size_t               step  = hash_map->item_step;
+    tb_hash_map_table_t*    table = &hash_map->table;
+    for (; index < tail; index++)
+    {
+        // full?
+        tb_check_continue(tb_hash_map_ctrl_full(table_old->ctrl[index]));
+
+        // rehash it
+        tb_byte_t const*    item = table_old->slots + index * step;
+        tb_size_t           hash = tb_hash_map_hash(hash_map, tb_hash_map_item_name(hash_map, item));
+        tb_size_t           slot = tb_hash_map_slot_free(table->ctrl, table->capacity, hash);
+
+        // the slot has been reserved, we get one more slot if it reuses the deleted slot
+        if (table->ctrl[slot] == TB_HASH_MAP_CTRL_DELETED) hash_map->growth_left++;
+
+        // move it
+        tb_hash_map_ctrl_set(table->ctrl, table->capacity, slot, tb_hash_map_hash_h2(hash));
+        tb_memcpy(table->slots + slot * step, item, step);
+
+        // mark it as deleted in the old table, so the probe sequences of the other old items are not broken
+        tb_hash_map_ctrl_set(table_old->ctrl, table_old->capacity, index, TB_HASH_MAP_CTRL_DELETED);
+    }
+    hash_map->migrate_index = index;
+
+    // end? free the old table
+    if (index >= table_old->capacity)
+    {
+        tb_allocator_free(hash_map->allocator, table_old->ctrl);
+        tb_memset(table_old, 0, sizeof(tb_hash_map_table_t));
+        hash_map->migrate_index = 0;
+    }
+}
+static tb_bool_t tb_hash_map_rehash(tb_hash_map_t* hash_map, tb_size_t capacity, tb_bool_t incremental)
+{
+    // check
+    tb_assert_and_check_return_val(hash_map && capacity >= TB_HASH_MAP_GROUP_WIDTH && !(capacity & (capacity - 1)), tb_false);
+    tb_assert_and_check_return_val(tb_hash_map_capacity_growth(capacity) >= hash_map->item_size, tb_false);
+
+    // finish the previous migrating first
+    tb_hash_map_migrate(hash_map, (tb_size_t)-1);
+
+    // make the new table: | ctrl: capacity + width | slots: capacity * step |
+    tb_size_t   step        = hash_map->item_step;
+    tb_size_t   ctrl_size   = tb_align8(capacity + TB_HASH_MAP_GROUP_WIDTH);
+    tb_assert_and_check_return_val(capacity <= ((tb_size_t)-1 - ctrl_size) / step, tb_false);
+    tb_byte_t*  ctrl        = (tb_byte_t*)tb_allocator_malloc(hash_map->allocator, ctrl_size + capacity * step);
+    tb_assert_and_check_return_val(ctrl, tb_false);
+
+    // init the new table
+    tb_memset(ctrl, TB_HASH_MAP_CTRL_EMPTY, capacity + TB_HASH_MAP_GROUP_WIDTH);
+
+    // the current table becomes the old table
+    if (hash_map->table.capacity) hash_map->table_old = hash_map->table;
+
+    // switch to the new table and reserve the slots for all items
+    hash_map->table.ctrl        = ctrl;
+    hash_map->table.slots       = ctrl + ctrl_size;
+    hash_map->table.capacity    = capacity;
+    hash_map->growth_left       = tb_hash_map_capacity_growth(capacity) - hash_map->item_size;
+    hash_map->migrate_index     = 0;
+
+    /* migrate a few old slots for each inserting and removing, 
+     * all old slots will have been migrated before using half of the growth left
+     */
+    hash_map->migrate_step = tb_align((hash_map->table_old.capacity << 1) / tb_max(hash_map->growth_left, 1) + 1, TB_HASH_MAP_GROUP_WIDTH);
+    hash_map->migrate_step = tb_max(hash_map->migrate_step, TB_HASH_MAP_GROUP_WIDTH << 1);
+
+    // migrate all old slots now if we need not rehash it incrementally
+    if (!incremental) tb_hash_map_migrate(hash_map, (tb_size_t)-1);
 
     // ok
     return tb_true;
 }
+static tb_bool_t tb_hash_map_grow(tb_hash_map_t* hash_map)
+{
+    // check
+    tb_assert(hash_map);
+
+    // init the table first
+    tb_size_t capacity = hash_map->table.capacity;
+    if (!capacity) return tb_hash_map_rehash(hash_map, hash_map->capacity_init, tb_false);
+
+    // finish the previous migrating, the current table may have the enough slots now
+    tb_hash_map_migrate(hash_map, (tb_size_t)-1);
+    tb_check_return_val(!hash_map->growth_left, tb_true);
+
+    /* only rehash it with the same capacity if there are too many deleted slots, 
+     * otherwise double the capacity
+     */
+    return tb_hash_map_rehash(hash_map, hash_map->item_size * 32 <= capacity * 25? capacity : capacity << 1, capacity >= TB_HASH_MAP_INCREMENTAL_MINN);
+}
+static tb_void_t tb_hash_map_slot_remove(tb_hash_map_t* hash_map, tb_size_t itor)
+{
+    // the slot
+    tb_size_t               index = 0;
+    tb_hash_map_table_t*    table = tb_null;
+    tb_byte_t*              item = tb_hash_map_slot(hash_map, itor, &table, &index);
+    tb_assert_and_check_return(item && table);
+
+    // free item, the scalar item need not be freed
+    if (hash_map->element_name.free && !hash_map->name_scalar) hash_map->element_name.free(&hash_map->element_name, item);
+    if (hash_map->element_data.free && !hash_map->data_scalar) hash_map->element_data.free(&hash_map->element_data, item + hash_map->element_name.size);
+
+    /* mark it as empty if no probe sequence has walked over this slot, otherwise mark it as deleted
+     *
+     * the probe sequence will be stopped at the group with the empty slot, 
+     * so it only can walk over this slot if all slots of a group containing this slot are not empty, 
+     * we need not leave the deleted slot if the non-empty slots around this slot are less than the group width.
+     *
+     * @note we do not move the other items (backward shift) here, 
+     * because the itor of the other items must be not changed after removing (.e.g tb_remove_if)
+     */
+    tb_byte_t*          ctrl            = table->ctrl;
+    tb_size_t           capacity        = table->capacity;
+    tb_hash_map_mask_t  empty_before    = tb_hash_map_group_match_empty(ctrl + ((index - TB_HASH_MAP_GROUP_WIDTH) & (capacity - 1)));
+    tb_hash_map_mask_t  empty_after     = tb_hash_map_group_match_empty(ctrl + index);
+    tb_bool_t           never_full      = empty_before && empty_after && tb_hash_map_mask_head(empty_after) + tb_hash_map_mask_tail(empty_before) < TB_HASH_MAP_GROUP_WIDTH;
+    tb_hash_map_ctrl_set(ctrl, capacity, index, never_full? TB_HASH_MAP_CTRL_EMPTY : TB_HASH_MAP_CTRL_DELETED);
+
+    // update the growth left, the reserved slot of the old item is released too
+    if (never_full || table == &hash_map->table_old) hash_map->growth_left++;
+
+    // update the item size
+    hash_map->item_size--;
+}
 static tb_size_t tb_hash_map_itor_size(tb_iterator_ref_t iterator)
 {
     // check
@@ -253,15 +599,8 @@ static tb_size_t tb_hash_map_itor_head(tb_iterator_ref_t iterator)
     tb_hash_map_t* hash_map = (tb_hash_map_t*)iterator;
     tb_assert(hash_map);
 
-    // find the head
-    tb_size_t i = 0;
-    tb_size_t n = hash_map->hash_size;
-    for (i = 0; i < n; i++)
-    {
-        tb_hash_map_item_list_t* list = hash_map->hash_list[i];
-        if (list && list->size) return tb_hash_map_index_make(i + 1, 1);
-    }
-    return 0;
+    // the head
+    return hash_map->item_size? tb_hash_map_slot_next(hash_map, 0) : 0;
 }
 static tb_size_t tb_hash_map_itor_tail(tb_iterator_ref_t iterator)
 {
@@ -271,32 +610,10 @@ static tb_size_t tb_hash_map_itor_next(tb_iterator_ref_t iterator, tb_size_t ito
 {
     // check
     tb_hash_map_t* hash_map = (tb_hash_map_t*)iterator;
-    tb_assert(hash_map && hash_map->hash_list && hash_map->hash_size);
-
-    // the current buck and item
-    tb_size_t buck = tb_hash_map_index_buck(itor);
-    tb_size_t item = tb_hash_map_index_item(itor);
-    tb_assert(buck && item);
-
-    // compute index
-    buck--;
-    item--;
-    tb_assert(buck < hash_map->hash_size && (item + 1) < TB_HASH_MAP_BUCKET_ITEM_MAXN);
-
-    // find the next from the current buck first
-    if (hash_map->hash_list[buck] && item + 1 < hash_map->hash_list[buck]->size) return tb_hash_map_index_make(buck + 1, item + 2);
+    tb_assert(hash_map && itor && itor <= hash_map->table.capacity + hash_map->table_old.capacity);
 
-    // find the next from the next buckets
-    tb_size_t i;
-    tb_size_t n = hash_map->hash_size;
-    for (i = buck + 1; i < n; i++)
-    {
-        tb_hash_map_item_list_t* list = hash_map->hash_list[i];
-        if (list && list->size) return tb_hash_map_index_make(i + 1, 1);
-    }
-
-    // tail
-    return 0;
+    // the next, itor is the next slot index
+    return tb_hash_map_slot_next(hash_map, itor);
 }
 static tb_pointer_t tb_hash_map_itor_item(tb_iterator_ref_t iterator, tb_size_t itor)
 {
@@ -304,38 +621,27 @@ static tb_pointer_t tb_hash_map_itor_item(tb_iterator_ref_t iterator, tb_size_t
     tb_hash_map_t* hash_map = (tb_hash_map_t*)iterator;
     tb_assert(hash_map && itor);
 
-    // get the buck and item
-    tb_size_t buck = tb_hash_map_index_buck(itor);
-    tb_size_t item = tb_hash_map_index_item(itor);
-    tb_assert_and_check_return_val(buck && item, tb_null);
+    // the slot
+    tb_byte_t const* item = tb_hash_map_slot(hash_map, itor, tb_null, tb_null);
+    tb_assert_and_check_return_val(item, tb_null);
 
     // get item
-    if (tb_hash_map_item_at(hash_map, buck - 1, item - 1, &((tb_hash_map_t*)hash_map)->item.name, &((tb_hash_map_t*)hash_map)->item.data))
-        return &(hash_map->item);
-    return tb_null;
+    hash_map->item.name = tb_hash_map_item_name(hash_map, item);
+    hash_map->item.data = tb_hash_map_item_data(hash_map, item);
+    return &(hash_map->item);
 }
 static tb_void_t tb_hash_map_itor_copy(tb_iterator_ref_t iterator, tb_size_t itor, tb_cpointer_t item)
 {
     // check
     tb_hash_map_t* hash_map = (tb_hash_map_t*)iterator;
-    tb_assert(hash_map && hash_map->hash_list && hash_map->hash_size);
-    
-    // the buck and item
-    tb_size_t b = tb_hash_map_index_buck(itor);
-    tb_size_t i = tb_hash_map_index_item(itor);
-    tb_assert(b && i); b--; i--;
-    tb_assert(b < hash_map->hash_size);
-
-    // step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert(step);
+    tb_assert(hash_map && itor);
 
-    // list
-    tb_hash_map_item_list_t* list = hash_map->hash_list[b];
-    tb_check_return(list && list->size && i < list->size);
+    // the slot
+    tb_byte_t* slot = tb_hash_map_slot(hash_map, itor, tb_null, tb_null);
+    tb_check_return(slot);
 
     // note: copy data only, will destroy hash_map index if copy name
-    hash_map->element_data.copy(&hash_map->element_data, ((tb_byte_t*)&list[1]) + i * step + hash_map->element_name.size, item);
+    hash_map->element_data.copy(&hash_map->element_data, slot + hash_map->element_name.size, item);
 }
 static tb_long_t tb_hash_map_itor_comp(tb_iterator_ref_t iterator, tb_cpointer_t lelement, tb_cpointer_t relement)
 {
@@ -344,136 +650,36 @@ static tb_long_t tb_hash_map_itor_comp(tb_iterator_ref_t iterator, tb_cpointer_t
     tb_assert(hash_map && hash_map->element_name.comp && lelement && relement);
     
     // done
+    if (hash_map->name_scalar) return tb_element_scalar_comp(hash_map->name_scalar, ((tb_hash_map_item_ref_t)lelement)->name, ((tb_hash_map_item_ref_t)relement)->name);
     return hash_map->element_name.comp(&hash_map->element_name, ((tb_hash_map_item_ref_t)lelement)->name, ((tb_hash_map_item_ref_t)relement)->name);
 }
 static tb_void_t tb_hash_map_itor_remove(tb_iterator_ref_t iterator, tb_size_t itor)
 {
     // check
     tb_hash_map_t* hash_map = (tb_hash_map_t*)iterator;
-    tb_assert(hash_map && hash_map->hash_list && hash_map->hash_size);
-    
-    // buck & item
-    tb_size_t buck = tb_hash_map_index_buck(itor);
-    tb_size_t item = tb_hash_map_index_item(itor);
-    tb_assert(buck && item); buck--; item--;
-    tb_assert(buck < hash_map->hash_size);
-
-    // the step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert(step);
-
-    // get list
-    tb_hash_map_item_list_t* list = hash_map->hash_list[buck];
-    tb_assert(list && list->size && item < list->size);
-
-    // free item
-    if (hash_map->element_name.free) hash_map->element_name.free(&hash_map->element_name, ((tb_byte_t*)&list[1]) + item * step);
-    if (hash_map->element_data.free) hash_map->element_data.free(&hash_map->element_data, ((tb_byte_t*)&list[1]) + item * step + hash_map->element_name.size);
-
-    // remove item from the list
-    if (list->size > 1)
-    {
-        // move items
-        if (item < list->size - 1) tb_memmov(((tb_byte_t*)&list[1]) + item * step, ((tb_byte_t*)&list[1]) + (item + 1) * step, (list->size - item - 1) * step);
-
-        // update size
-        list->size--;
-    }
-    // remove list
-    else 
-    {
-        // free it
-        tb_free(list);
-
-        // reset
-        hash_map->hash_list[buck] = tb_null;
-    }
+    tb_assert(hash_map && itor);
 
-    // update the hash_map item size
-    hash_map->item_size--;
+    // remove it, we do not migrate the old table here, because the itors must be not changed when iterating
+    tb_hash_map_slot_remove(hash_map, itor);
 }
 static tb_void_t tb_hash_map_itor_remove_range(tb_iterator_ref_t iterator, tb_size_t prev, tb_size_t next, tb_size_t size)
 {
     // check
     tb_hash_map_t* hash_map = (tb_hash_map_t*)iterator;
-    tb_assert(hash_map && hash_map->hash_list && hash_map->hash_size);
+    tb_assert(hash_map);
 
     // no size
     tb_check_return(size);
 
-    // the step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert(step);
-
     // the first itor
     tb_size_t itor = prev? tb_hash_map_itor_next(iterator, prev) : tb_hash_map_itor_head(iterator);
 
-    // the head buck and item
-    tb_size_t buck_head = tb_hash_map_index_buck(itor);
-    tb_size_t item_head = tb_hash_map_index_item(itor);
-    tb_assert(buck_head && item_head);
-
-    // compute index
-    buck_head--;
-    item_head--;
-    tb_assert(buck_head < hash_map->hash_size && item_head < TB_HASH_MAP_BUCKET_ITEM_MAXN);
-
-    // the last buck and the tail item
-    tb_size_t buck_last;
-    tb_size_t item_tail;
-    if (next)
-    {
-        // next => buck and item
-        buck_last = tb_hash_map_index_buck(next);
-        item_tail = tb_hash_map_index_item(next);
-        tb_assert(buck_last && item_tail);
-
-        // compute index
-        buck_last--;
-        item_tail--;
-        tb_assert(buck_last < hash_map->hash_size && item_tail < TB_HASH_MAP_BUCKET_ITEM_MAXN);
-    }
-    else 
-    {
-        buck_last = hash_map->hash_size - 1;
-        item_tail = -1;
-    }
-
-    // remove items: [itor, next)
-    tb_size_t buck;
-    tb_size_t item;
-    tb_element_free_func_t name_free = hash_map->element_name.free;
-    tb_element_free_func_t data_free = hash_map->element_data.free;
-    for (buck = buck_head, item = item_head; buck <= buck_last; buck++, item = 0)
+    // remove items: [itor, next), the other slots will not be moved
+    while (itor && itor != next && size--)
     {
-        // the list
-        tb_hash_map_item_list_t* list = hash_map->hash_list[buck];
-        tb_check_continue(list && list->size);
-
-        // the tail
-        tb_size_t tail = (buck == buck_last && next)? item_tail : list->size;
-        tb_assert(tail != -1);
-        tb_check_continue(item < tail);
-
-        // the data
-        tb_byte_t* data = (tb_byte_t*)&list[1];
-
-        // free items
-        tb_size_t i = 0;
-        for (i = item; i < tail; i++)
-        {
-            if (name_free) name_free(&hash_map->element_name, data + i * step);
-            if (data_free) data_free(&hash_map->element_data, data + i * step + hash_map->element_name.size);
-        }
-
-        // move items
-        if (buck == buck_last && tail < list->size) tb_memmov(data + item * step, data + tail * step, (list->size - tail) * step);
-
-        // update the list size
-        list->size -= tail - item;
-
-        // update the item size
-        hash_map->item_size -= tail - item;
+        tb_size_t item = itor;
+        itor = tb_hash_map_slot_next(hash_map, itor);
+        tb_hash_map_slot_remove(hash_map, item);
     }
 }
 
@@ -481,6 +687,10 @@ static tb_void_t tb_hash_map_itor_remove_range(tb_iterator_ref_t iterator, tb_si
  * implementation
  */
 tb_hash_map_ref_t tb_hash_map_init(tb_size_t bucket_size, tb_element_t element_name, tb_element_t element_data)
+{
+    return tb_hash_map_init_with_allocator(bucket_size, element_name, element_data, tb_null);
+}
+tb_hash_map_ref_t tb_hash_map_init_with_allocator(tb_size_t bucket_size, tb_element_t element_name, tb_element_t element_data, tb_allocator_ref_t allocator)
 {
     // check
     tb_assert_and_check_return_val(element_name.size && element_name.hash && element_name.comp && element_name.data && element_name.dupl, tb_null);
@@ -495,13 +705,26 @@ tb_hash_map_ref_t tb_hash_map_init(tb_size_t bucket_size, tb_element_t element_n
     tb_hash_map_t*  hash_map = tb_null;
     do
     {
+        // using the global allocator if be null
+        if (!allocator) allocator = tb_allocator();
+        tb_assert_and_check_break(allocator);
+
         // make self
-        hash_map = tb_malloc0_type(tb_hash_map_t);
+        hash_map = (tb_hash_map_t*)tb_allocator_malloc0(allocator, sizeof(tb_hash_map_t));
         tb_assert_and_check_break(hash_map);
 
+        // init allocator
+        hash_map->allocator = allocator;
+
         // init self func
         hash_map->element_name = element_name;
         hash_map->element_data = element_data;
+        hash_map->name_scalar  = tb_element_scalar(&element_name);
+        hash_map->data_scalar  = tb_element_scalar(&element_data);
+
+        // the element data uses the allocator of the container if the element has no allocator
+        if (!hash_map->element_name.allocator) hash_map->element_name.allocator = allocator;
+        if (!hash_map->element_data.allocator) hash_map->element_data.allocator = allocator;
 
         // init item itor
         hash_map->itor.mode             = TB_ITERATOR_MODE_FORWARD | TB_ITERATOR_MODE_MUTABLE;
@@ -518,18 +741,12 @@ tb_hash_map_ref_t tb_hash_map_init(tb_size_t bucket_size, tb_element_t element_n
         hash_map->itor.remove           = tb_hash_map_itor_remove;
         hash_map->itor.remove_range     = tb_hash_map_itor_remove_range;
 
-        // init self size
-        hash_map->hash_size = tb_align_pow2(bucket_size);
-        tb_assert_and_check_break(hash_map->hash_size <= TB_HASH_MAP_BUCKET_MAXN);
+        // init item step
+        hash_map->item_step = element_name.size + element_data.size;
+        tb_assert_and_check_break(hash_map->item_step);
 
-        // init self list
-        hash_map->hash_list = (tb_hash_map_item_list_t**)tb_nalloc0(hash_map->hash_size, sizeof(tb_size_t));
-        tb_assert_and_check_break(hash_map->hash_list);
-
-        // init item grow
-        hash_map->item_grow = tb_isqrti((tb_uint32_t)bucket_size);
-        if (hash_map->item_grow < 8) hash_map->item_grow = 8;
-        hash_map->item_grow = tb_align_pow2(hash_map->item_grow);
+        // init the initial capacity, the table will be allocated when inserting the first item
+        hash_map->capacity_init = tb_align_pow2(tb_max(bucket_size, TB_HASH_MAP_GROUP_WIDTH));
 
         // ok
         ok = tb_true;
@@ -553,71 +770,83 @@ tb_void_t tb_hash_map_exit(tb_hash_map_ref_t self)
     tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
     tb_assert_and_check_return(hash_map);
 
-    // clear it
+    // clear it and free the table
     tb_hash_map_clear(self);
 
-    // free hash_map list
-    if (hash_map->hash_list) tb_free(hash_map->hash_list);
-
     // free it
-    tb_free(hash_map);
+    tb_allocator_free(hash_map->allocator, hash_map);
 }
-tb_void_t tb_hash_map_clear(tb_hash_map_ref_t self)
+static tb_void_t tb_hash_map_table_clear(tb_hash_map_t* hash_map, tb_hash_map_table_t* table)
 {
     // check
-    tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
-    tb_assert_and_check_return(hash_map && hash_map->hash_list);
-
-    // step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert_and_check_return(step);
+    tb_assert(hash_map && table);
 
-    // clear hash_map
-    tb_size_t i = 0;
-    tb_size_t n = hash_map->hash_size;
-    for (i = 0; i < n; i++)
+    // free items
+    if (table->capacity && ((hash_map->element_name.free && !hash_map->name_scalar) || (hash_map->element_data.free && !hash_map->data_scalar)))
     {
-        tb_hash_map_item_list_t* list = hash_map->hash_list[i];
-        if (list)
+        tb_size_t i = 0;
+        tb_size_t n = table->capacity;
+        tb_size_t step = hash_map->item_step;
+        for (i = 0; i < n; i++)
         {
-            // free items
-            if (hash_map->element_name.free || hash_map->element_data.free)
+            if (tb_hash_map_ctrl_full(table->ctrl[i]))
             {
-                tb_size_t j = 0;
-                tb_size_t m = list->size;
-                for (j = 0; j < m; j++)
-                {
-                    tb_byte_t* item = ((tb_byte_t*)&list[1]) + j * step;
-                    if (hash_map->element_name.free) hash_map->element_name.free(&hash_map->element_name, item);
-                    if (hash_map->element_data.free) hash_map->element_data.free(&hash_map->element_data, item + hash_map->element_name.size);
-                }
+                tb_byte_t* item = table->slots + i * step;
+                if (hash_map->element_name.free && !hash_map->name_scalar) hash_map->element_name.free(&hash_map->element_name, item);
+                if (hash_map->element_data.free && !hash_map->data_scalar) hash_map->element_data.free(&hash_map->element_data, item + hash_map->element_name.size);
             }
-
-            // free list
-            tb_free(list);
         }
-        hash_map->hash_list[i] = tb_null;
     }
 
+    // free the table
+    if (table->ctrl) tb_allocator_free(hash_map->allocator, table->ctrl);
+    tb_memset(table, 0, sizeof(tb_hash_map_table_t));
+}
+tb_void_t tb_hash_map_clear(tb_hash_map_ref_t self)
+{
+    // check
+    tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
+    tb_assert_and_check_return(hash_map);
+
+    // clear tables
+    tb_hash_map_table_clear(hash_map, &hash_map->table);
+    tb_hash_map_table_clear(hash_map, &hash_map->table_old);
+
     // reset info
-    hash_map->item_size = 0;
-    hash_map->item_maxn = 0;
+    hash_map->migrate_index = 0;
+    hash_map->growth_left   = 0;
+    hash_map->item_size     = 0;
     tb_memset(&hash_map->item, 0, sizeof(tb_hash_map_item_t));
 }
 tb_pointer_t tb_hash_map_get(tb_hash_map_ref_t self, tb_cpointer_t name)
+{
+    // lookup it
+    tb_pointer_t data = tb_null;
+    return tb_hash_map_lookup(self, name, &data)? data : tb_null;
+}
+tb_bool_t tb_hash_map_lookup(tb_hash_map_ref_t self, tb_cpointer_t name, tb_pointer_t* pdata)
 {
     // check
     tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
-    tb_assert_and_check_return_val(hash_map, tb_null);
+    tb_assert_and_check_return_val(hash_map, tb_false);
 
-    // find it
-    tb_size_t buck = 0;
-    tb_size_t item = 0;
-    if (!tb_hash_map_item_find(hash_map, name, &buck, &item)) return tb_null;
+    // empty?
+    tb_check_return_val(hash_map->item_size, tb_false);
+
+    // find it, @note we cannot migrate the old table here, because it may be called by multiple readers
+    tb_size_t itor = tb_hash_map_slot_find(hash_map, name, tb_hash_map_hash(hash_map, name));
+    tb_check_return_val(itor, tb_false);
 
     // get data
-    tb_pointer_t data = tb_null;
-    return tb_hash_map_item_at(hash_map, buck, item, tb_null, &data)? data : tb_null;
+    if (pdata) 
+    {
+        tb_byte_t const* item = tb_hash_map_slot(hash_map, itor, tb_null, tb_null);
+        tb_assert_and_check_return_val(item, tb_false);
+        *pdata = tb_hash_map_item_data(hash_map, item);
+    }
+
+    // ok
+    return tb_true;
 }
 tb_size_t tb_hash_map_find(tb_hash_map_ref_t self, tb_cpointer_t name)
 {
@@ -625,10 +854,8 @@ tb_size_t tb_hash_map_find(tb_hash_map_ref_t self, tb_cpointer_t name)
     tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
     tb_assert_and_check_return_val(hash_map, 0);
 
-    // find
-    tb_size_t buck = 0;
-    tb_size_t item = 0;
-    return tb_hash_map_item_find(hash_map, name, &buck, &item)? tb_hash_map_index_make(buck + 1, item + 1) : 0;
+    // find it
+    return hash_map->item_size? tb_hash_map_slot_find(hash_map, name, tb_hash_map_hash(hash_map, name)) : 0;
 }
 tb_size_t tb_hash_map_insert(tb_hash_map_ref_t self, tb_cpointer_t name, tb_cpointer_t data)
 {
@@ -636,99 +863,55 @@ tb_size_t tb_hash_map_insert(tb_hash_map_ref_t self, tb_cpointer_t name, tb_cpoi
     tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
     tb_assert_and_check_return_val(hash_map, 0);
 
-    // the step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert_and_check_return_val(step, 0);
+    // migrate a few old slots
+    if (hash_map->table_old.capacity) tb_hash_map_migrate(hash_map, hash_map->migrate_step);
 
     // find it
-    tb_size_t buck = 0;
-    tb_size_t item = 0;
-    if (tb_hash_map_item_find(hash_map, name, &buck, &item))
+    tb_size_t hash = tb_hash_map_hash(hash_map, name);
+    tb_size_t itor = tb_hash_map_slot_find(hash_map, name, hash);
+    if (itor)
     {
-        // check
-        tb_assert_and_check_return_val(buck < hash_map->hash_size, 0);
-
-        // get list
-        tb_hash_map_item_list_t* list = hash_map->hash_list[buck];
-        tb_assert_and_check_return_val(list && list->size && item < list->size, 0);
+        // the slot
+        tb_byte_t* item = tb_hash_map_slot(hash_map, itor, tb_null, tb_null);
+        tb_assert_and_check_return_val(item, 0);
 
         // replace data
-        hash_map->element_data.repl(&hash_map->element_data, ((tb_byte_t*)&list[1]) + item * step + hash_map->element_name.size, data);
+        if (hash_map->data_scalar) *((tb_cpointer_t*)(item + hash_map->element_name.size)) = data;
+        else hash_map->element_data.repl(&hash_map->element_data, item + hash_map->element_name.size, data);
+        return itor;
     }
-    else
-    {
-        // check
-        tb_assert_and_check_return_val(buck < hash_map->hash_size, 0);
-
-        // get list
-        tb_hash_map_item_list_t* list = hash_map->hash_list[buck];
-        
-        // insert item
-        if (list)
-        {
-            // grow?
-            if (list->size >= list->maxn)
-            {
-                // check
-                tb_assert_and_check_return_val(hash_map->item_grow, 0);
-
-                // resize maxn
-                tb_size_t maxn = tb_align_pow2(list->maxn + hash_map->item_grow);
-                tb_assert_and_check_return_val(maxn > list->maxn, 0);
-
-                // realloc it
-                list = (tb_hash_map_item_list_t*)tb_ralloc(list, sizeof(tb_hash_map_item_list_t) + maxn * step);  
-                tb_assert_and_check_return_val(list, 0);
-
-                // update the hash_map item maxn
-                hash_map->item_maxn += maxn - list->maxn;
-
-                // update maxn
-                list->maxn = maxn;
 
-                // reattach list
-                hash_map->hash_list[buck] = list;
-            }
-            tb_assert_and_check_return_val(item <= list->size && list->size < list->maxn, 0);
-
-            // move items
-            if (item != list->size) tb_memmov(((tb_byte_t*)&list[1]) + (item + 1) * step, ((tb_byte_t*)&list[1]) + item * step, (list->size - item) * step);
-
-            // dupl item
-            list->size++;
-            hash_map->element_name.dupl(&hash_map->element_name, ((tb_byte_t*)&list[1]) + item * step, name);
-            hash_map->element_data.dupl(&hash_map->element_data, ((tb_byte_t*)&list[1]) + item * step + hash_map->element_name.size, data);
+    // init the table first
+    tb_hash_map_table_t* table = &hash_map->table;
+    if (!table->ctrl && !tb_hash_map_grow(hash_map)) return 0;
 
-        }
-        // create list for adding item
-        else
-        {
-            // check
-            tb_assert_and_check_return_val(hash_map->item_grow, 0);
-
-            // make list
-            list = (tb_hash_map_item_list_t*)tb_malloc0(sizeof(tb_hash_map_item_list_t) + hash_map->item_grow * step);
-            tb_assert_and_check_return_val(list, 0);
+    // find a free slot, we can reuse the deleted slot without growing
+    tb_size_t index = tb_hash_map_slot_free(table->ctrl, table->capacity, hash);
+    if (!hash_map->growth_left && table->ctrl[index] != TB_HASH_MAP_CTRL_DELETED)
+    {
+        // grow it
+        if (!tb_hash_map_grow(hash_map)) return 0;
 
-            // init list
-            list->size = 1;
-            list->maxn = hash_map->item_grow;
-            hash_map->element_name.dupl(&hash_map->element_name, ((tb_byte_t*)&list[1]), name);
-            hash_map->element_data.dupl(&hash_map->element_data, ((tb_byte_t*)&list[1]) + hash_map->element_name.size, data);
+        // find a free slot again
+        index = tb_hash_map_slot_free(table->ctrl, table->capacity, hash);
+    }
 
-            // attach list
-            hash_map->hash_list[buck] = list;
+    // update the growth left
+    if (table->ctrl[index] == TB_HASH_MAP_CTRL_EMPTY) hash_map->growth_left--;
 
-            // update the hash_map item maxn
-            hash_map->item_maxn += list->maxn;
-        }
+    // dupl item
+    tb_byte_t* item = table->slots + index * hash_map->item_step;
+    tb_hash_map_ctrl_set(table->ctrl, table->capacity, index, tb_hash_map_hash_h2(hash));
+    if (hash_map->name_scalar) *((tb_cpointer_t*)item) = name;
+    else hash_map->element_name.dupl(&hash_map->element_name, item, name);
+    if (hash_map->data_scalar) *((tb_cpointer_t*)(item + hash_map->element_name.size)) = data;
+    else hash_map->element_data.dupl(&hash_map->element_data, item + hash_map->element_name.size, data);
 
-        // update the hash_map item size
-        hash_map->item_size++;
-    }
+    // update the item size
+    hash_map->item_size++;
 
     // ok?
-    return tb_hash_map_index_make(buck + 1, item + 1);
+    return index + 1;
 }
 tb_void_t tb_hash_map_remove(tb_hash_map_ref_t self, tb_cpointer_t name)
 {
@@ -736,11 +919,36 @@ tb_void_t tb_hash_map_remove(tb_hash_map_ref_t self, tb_cpointer_t name)
     tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
     tb_assert_and_check_return(hash_map);
 
+    // migrate a few old slots
+    if (hash_map->table_old.capacity) tb_hash_map_migrate(hash_map, hash_map->migrate_step);
+
     // find it
-    tb_size_t buck = 0;
-    tb_size_t item = 0;
-    if (tb_hash_map_item_find(hash_map, name, &buck, &item))
-        tb_hash_map_itor_remove((tb_iterator_ref_t)hash_map, tb_hash_map_index_make(buck + 1, item + 1));
+    tb_size_t itor = tb_hash_map_find(self, name);
+    if (itor) tb_hash_map_slot_remove(hash_map, itor);
+}
+tb_bool_t tb_hash_map_reserve(tb_hash_map_ref_t self, tb_size_t size)
+{
+    // check
+    tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
+    tb_assert_and_check_return_val(hash_map, tb_false);
+
+    // compute the capacity for the given items count
+    tb_size_t capacity = TB_HASH_MAP_GROUP_WIDTH;
+    size = tb_max(size, hash_map->item_size);
+    while (tb_hash_map_capacity_growth(capacity) < size)
+    {
+        tb_assert_and_check_return_val(capacity < ((tb_size_t)-1 >> 1), tb_false);
+        capacity <<= 1;
+    }
+
+    // finish the migrating
+    tb_hash_map_migrate(hash_map, (tb_size_t)-1);
+
+    // enough?
+    tb_check_return_val(capacity > hash_map->table.capacity, tb_true);
+
+    // rehash it at once
+    return tb_hash_map_rehash(hash_map, capacity, tb_false);
 }
 tb_size_t tb_hash_map_size(tb_hash_map_ref_t self)
 {
@@ -758,67 +966,55 @@ tb_size_t tb_hash_map_maxn(tb_hash_map_ref_t self)
     tb_assert_and_check_return_val(hash_map, 0);
 
     // the maxn
-    return hash_map->item_maxn;
+    return hash_map->table.capacity;
 }
 #ifdef __tb_debug__
 tb_void_t tb_hash_map_dump(tb_hash_map_ref_t self)
 {
     // check
     tb_hash_map_t* hash_map = (tb_hash_map_t*)self;
-    tb_assert_and_check_return(hash_map && hash_map->hash_list);
+    tb_assert_and_check_return(hash_map);
 
-    // the step
-    tb_size_t step = hash_map->element_name.size + hash_map->element_data.size;
-    tb_assert_and_check_return(step);
+    // the deleted slots count
+    tb_size_t i = 0;
+    tb_size_t deleted = 0;
+    for (i = 0; i < hash_map->table.capacity; i++)
+    {
+        if (hash_map->table.ctrl[i] == TB_HASH_MAP_CTRL_DELETED) deleted++;
+    }
 
     // trace
     tb_trace_i("");
-    tb_trace_i("self: size: %lu", tb_hash_map_size(self));
+    tb_trace_i("self: size: %lu, capacity: %lu, deleted: %lu, growth_left: %lu", tb_hash_map_size(self), hash_map->table.capacity, deleted, hash_map->growth_left);
+    if (hash_map->table_old.capacity)
+        tb_trace_i("self: migrating: %lu/%lu, step: %lu", hash_map->migrate_index, hash_map->table_old.capacity, hash_map->migrate_step);
 
     // done
-    tb_size_t i = 0;
     tb_char_t name[4096];
     tb_char_t data[4096];
-    for (i = 0; i < hash_map->hash_size; i++)
+    tb_size_t itor = tb_iterator_head(self);
+    for (; itor != tb_iterator_tail(self); itor = tb_iterator_next(self, itor))
     {
-        // the list
-        tb_hash_map_item_list_t* list = hash_map->hash_list[i];
-        if (list)
-        {
-            // trace
-            tb_trace_i("buck[%u]: size: %u, maxn: %u", i, list->size, list->maxn);
+        // the item
+        tb_hash_map_item_ref_t item = (tb_hash_map_item_ref_t)tb_iterator_item(self, itor);
+        tb_assert_and_check_break(item);
 
-            // done 
-            tb_size_t j = 0;
-            for (j = 0; j < list->size; j++)
-            {
-                // the item
-                tb_byte_t const* item = ((tb_byte_t*)&list[1]) + j * step;
-
-                // the item name
-                tb_pointer_t element_name = hash_map->element_name.data(&hash_map->element_name, item);
-
-                // the item data
-                tb_pointer_t element_data = hash_map->element_data.data(&hash_map->element_data, item + hash_map->element_name.size);
-
-                // trace
-                if (hash_map->element_name.cstr && hash_map->element_data.cstr)
-                {
-                    tb_trace_i("    %s => %s", hash_map->element_name.cstr(&hash_map->element_name, element_name, name, sizeof(name)), hash_map->element_data.cstr(&hash_map->element_data, element_data, data, sizeof(data)));
-                }
-                else if (hash_map->element_name.cstr) 
-                {
-                    tb_trace_i("    %s => %p", hash_map->element_name.cstr(&hash_map->element_name, element_name, name, sizeof(name)), element_data);
-                }
-                else if (hash_map->element_data.cstr) 
-                {
-                    tb_trace_i("    %x => %p", element_name, hash_map->element_data.cstr(&hash_map->element_data, element_data, data, sizeof(data)));
-                }
-                else 
-                {
-                    tb_trace_i("    %p => %p", element_name, element_data);
-                }
-            }
+        // trace
+        if (hash_map->element_name.cstr && hash_map->element_data.cstr)
+        {
+            tb_trace_i("slot[%lu]: %s => %s", itor - 1, hash_map->element_name.cstr(&hash_map->element_name, item->name, name, sizeof(name)), hash_map->element_data.cstr(&hash_map->element_data, item->data, data, sizeof(data)));
+        }
+        else if (hash_map->element_name.cstr) 
+        {
+            tb_trace_i("slot[%lu]: %s => %p", itor - 1, hash_map->element_name.cstr(&hash_map->element_name, item->name, name, sizeof(name)), item->data);
+        }
+        else if (hash_map->element_data.cstr) 
+        {
+            tb_trace_i("slot[%lu]: %x => %p", itor - 1, item->name, hash_map->element_data.cstr(&hash_map->element_data, item->data, data, sizeof(data)));
+        }
+        else 
+        {
+            tb_trace_i("slot[%lu]: %p => %p", itor - 1, item->name, item->data);
         }
     }
 }
@@ -67,32 +67,32 @@ typedef struct __tb_hash_map_item_t
 }tb_hash_map_item_t, *tb_hash_map_item_ref_t;
 
 /*! the hash map ref type
+ *
+ * the open addressing hash map, the items are saved inline in the slots and each slot has a control byte
  *
  * <pre>
- *                 0        1        3       ...     ...                n       n + 1
- * hash_list: |--------|--------|--------|--------|--------|--------|--------|--------|
- *                         |
- *                       -----    
- * item_list:           |     |       key:0                                      
- *                       -----   
- *                      |     |       key:1                                              
- *                       -----               <= insert by binary search algorithm
- *                      |     |       key:2                                               
- *                       -----  
- *                      |     |       key:3                                               
- *                       -----   
- *                      |     |       key:4                                               
- *                       -----  
- *                      |     |                                              
- *                       -----  
- *                      |     |                                              
- *                       -----  
- *                      |     |                                              
- *                       -----  
+ *                 0        1        2        3       ...     n - 1    | cloned: 0 ... width - 1
+ * ctrl:      |--------|--------|--------|--------|--------|--------|   |--------|--------|
+ *              empty    h2(key0) deleted  h2(key1)  ...    empty
+ *
+ * slots:     |--------|--------|--------|--------|--------|--------|
+ *                       key0:data0        key1:data1
+ *
+ * the control byte: empty (0x80), deleted (0xfe) or full (the low 7-bits of the hash)
+ *
+ * lookup: probe a group of control bytes (16 bytes for sse2, 8 bytes for neon and others) at once,
+ *         only compare the names of the slots which have the same 7-bits hash,
+ *         and stop at the group which has an empty slot.
  *
  * </pre>
  *
- * @note the itor of the same item is mutable
+ * the capacity is aligned to the power of 2 and it will be grown if the load factor is larger than 7/8,
+ * the large table will be rehashed incrementally: the items of the old table are migrated to the new table 
+ * by a few groups for each inserting and removing, and the lookup will check both tables until the migrating is finished.
+ * we can call tb_hash_map_reserve() to presize it if the items count is known.
+ *
+ * @note the itor of the same item is mutable, 
+ * but removing an item will not change the itors of the other items
  */
 typedef tb_iterator_ref_t tb_hash_map_ref_t;
 
@@ -102,7 +102,7 @@ typedef tb_iterator_ref_t tb_hash_map_ref_t;
 
 /*! init hash map
  *
- * @param bucket_size   the hash bucket size, using the default size if be zero
+ * @param bucket_size   the initial capacity, using the default size if be zero
  * @param element_name  the item for name
  * @param element_data  the item for data
  *
@@ -110,6 +110,20 @@ typedef tb_iterator_ref_t tb_hash_map_ref_t;
  */
 tb_hash_map_ref_t       tb_hash_map_init(tb_size_t bucket_size, tb_element_t element_name, tb_element_t element_data);
 
+/*! init hash map with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param bucket_size   the initial capacity, using the default size if be zero
+ * @param element_name  the item for name
+ * @param element_data  the item for data
+ * @param allocator     the allocator, using the global allocator if be null
+ *
+ * @return              the hash map
+ */
+tb_hash_map_ref_t       tb_hash_map_init_with_allocator(tb_size_t bucket_size, tb_element_t element_name, tb_element_t element_data, tb_allocator_ref_t allocator);
+
 /*! exit hash map
  *
  * @param hash_map      the hash map
@@ -145,6 +159,28 @@ tb_void_t               tb_hash_map_clear(tb_hash_map_ref_t hash_map);
  */
 tb_pointer_t            tb_hash_map_get(tb_hash_map_ref_t hash_map, tb_cpointer_t name);
 
+/*! lookup item data from name
+ *
+ * it is same as tb_hash_map_get() but we can know whether the item exists if the data may be zero,
+ * and it only reads the hash map, so it can be called by multiple readers at the same time
+ *
+ * @code
+ *
+ * tb_pointer_t data = tb_null;
+ * if (tb_hash_map_lookup(hash_map, name, &data))
+ * {
+ *      // ...
+ * }
+ * @endcode
+ *
+ * @param hash_map      the hash map
+ * @param name          the item name
+ * @param pdata         the item data pointer, ignore it if be null
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_hash_map_lookup(tb_hash_map_ref_t hash_map, tb_cpointer_t name, tb_pointer_t* pdata);
+
 /*! find item from name
  *
  * @code
@@ -188,6 +224,18 @@ tb_size_t               tb_hash_map_insert(tb_hash_map_ref_t hash_map, tb_cpoint
  */
 tb_void_t               tb_hash_map_remove(tb_hash_map_ref_t hash_map, tb_cpointer_t name);
 
+/*! reserve the hash map for the given items count
+ *
+ * it will rehash the hash map at once if the current capacity is not enough, 
+ * so the following inserting will not grow it.
+ *
+ * @param hash_map      the hash map
+ * @param size          the items count
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_hash_map_reserve(tb_hash_map_ref_t hash_map, tb_size_t size);
+
 /*! the hash map size
  *
  * @param hash_map      the hash map
@@ -200,7 +248,7 @@ tb_size_t               tb_hash_map_size(tb_hash_map_ref_t hash_map);
  *
  * @param hash_map      the hash map
  *
- * @return              the hash map maxn
+ * @return              the hash map maxn (the slots count)
  */
 tb_size_t               tb_hash_map_maxn(tb_hash_map_ref_t hash_map);
 
@@ -63,9 +63,14 @@ static tb_pointer_t tb_hash_set_itor_item(tb_iterator_ref_t iterator, tb_size_t
  * implementation
  */
 tb_hash_set_ref_t tb_hash_set_init(tb_size_t bucket_size, tb_element_t element)
+{
+    return tb_hash_set_init_with_allocator(bucket_size, element, tb_null);
+}
+tb_hash_set_ref_t tb_hash_set_init_with_allocator(tb_size_t bucket_size, tb_element_t element, tb_allocator_ref_t allocator)
 {
     // init hash set
-    tb_iterator_ref_t hash_set = (tb_iterator_ref_t)tb_hash_map_init(bucket_size, element, tb_element_true());
+    tb_iterator_ref_t hash_set = (tb_iterator_ref_t)tb_hash_map_init_with_allocator(bucket_size, element, tb_element_true(), allocator);
+    tb_assert_and_check_return_val(hash_set, tb_null);
 
     // @note the private data of the hash map iterator cannot be used
     tb_assert(!hash_set->priv);
@@ -101,6 +106,10 @@ tb_void_t tb_hash_set_remove(tb_hash_set_ref_t self, tb_cpointer_t data)
 {
     tb_hash_map_remove((tb_hash_map_ref_t)self, data);
 }
+tb_bool_t tb_hash_set_reserve(tb_hash_set_ref_t self, tb_size_t size)
+{
+    return tb_hash_map_reserve((tb_hash_map_ref_t)self, size);
+}
 tb_size_t tb_hash_set_size(tb_hash_set_ref_t self)
 {
     return tb_hash_map_size((tb_hash_map_ref_t)self);
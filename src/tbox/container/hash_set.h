@@ -65,13 +65,26 @@ typedef tb_iterator_ref_t tb_hash_set_ref_t;
 
 /*! init hash set
  *
- * @param bucket_size   the hash bucket size, using the default size if be zero
+ * @param bucket_size   the initial capacity, using the default size if be zero
  * @param element       the element
  *
  * @return              the hash set
  */
 tb_hash_set_ref_t       tb_hash_set_init(tb_size_t bucket_size, tb_element_t element);
 
+/*! init hash set with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param bucket_size   the initial capacity, using the default size if be zero
+ * @param element       the element
+ * @param allocator     the allocator, using the global allocator if be null
+ *
+ * @return              the hash set
+ */
+tb_hash_set_ref_t       tb_hash_set_init_with_allocator(tb_size_t bucket_size, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit hash set
  *
  * @param hash_set      the hash set
@@ -137,6 +150,15 @@ tb_size_t               tb_hash_set_insert(tb_hash_set_ref_t hash_set, tb_cpoint
  */
 tb_void_t               tb_hash_set_remove(tb_hash_set_ref_t hash_set, tb_cpointer_t data);
 
+/*! reserve the hash set for the given items count
+ *
+ * @param hash_set      the hash set
+ * @param size          the items count
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_hash_set_reserve(tb_hash_set_ref_t hash_set, tb_size_t size);
+
 /*! the hash set size
  *
  * @param hash_set      the hash set
@@ -67,6 +67,13 @@
 #   define TB_HEAP_CHECK_ENABLE     (0)
 #endif
 
+/* the bias of the scalar item
+ *
+ * the scalar items are compared as the unsigned integer after adding the bias,
+ * it flips the sign bit of tb_long_t, so the signed order is kept
+ */
+#define tb_heap_scalar_bias(scalar)     ((scalar) == TB_ELEMENT_SCALAR_LONG? ((tb_size_t)1 << (TB_CPU_BITSIZE - 1)) : 0)
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
  */
@@ -89,9 +96,15 @@ typedef struct __tb_heap_t
     // the grow
     tb_size_t               grow;
 
+    // the allocator
+    tb_allocator_ref_t      allocator;
+
     // the element
     tb_element_t            element;
 
+    // the element scalar type, the scalar items are compared and copied directly
+    tb_size_t               scalar;
+
 }tb_heap_t;
 
 /* //////////////////////////////////////////////////////////////////////////////////////
@@ -186,6 +199,21 @@ static tb_pointer_t tb_heap_shift_up(tb_heap_t* heap, tb_size_t hole, tb_cpointe
     tb_size_t   parent = 0;
     tb_byte_t*  head = heap->data;
     tb_size_t   step = heap->element.size;
+
+    // scalar? compare and move the items directly
+    if (heap->scalar)
+    {
+        tb_size_t*  items = (tb_size_t*)head;
+        tb_size_t   bias = tb_heap_scalar_bias(heap->scalar);
+        tb_size_t   value = (tb_size_t)data + bias;
+        for (parent = (hole - 1) >> 1; hole && items[parent] + bias > value; parent = (hole - 1) >> 1)
+        {
+            items[hole] = items[parent];
+            hole = parent;
+        }
+        return items + hole;
+    }
+
     switch (step)
     {
     case sizeof(tb_size_t):
@@ -278,6 +306,30 @@ static tb_pointer_t tb_heap_shift_down(tb_heap_t* heap, tb_size_t hole, tb_cpoin
     tb_byte_t*      lchild = head + ((hole << 1) + 1) * step;
     tb_pointer_t    data_lchild = tb_null;
     tb_pointer_t    data_rchild = tb_null;
+
+    // scalar? compare and move the items directly
+    if (heap->scalar)
+    {
+        tb_size_t*  items = (tb_size_t*)head;
+        tb_size_t   size = heap->size;
+        tb_size_t   bias = tb_heap_scalar_bias(heap->scalar);
+        tb_size_t   value = (tb_size_t)data + bias;
+        tb_size_t   child = (hole << 1) + 1;
+        for (; child < size; child = (hole << 1) + 1)
+        {
+            // the smaller child node
+            if (child + 1 < size && items[child] + bias > items[child + 1] + bias) child++;
+
+            // end?
+            if (items[child] + bias >= value) break;
+
+            // the smaller child node => hole
+            items[hole] = items[child];
+            hole = child;
+        }
+        return items + hole;
+    }
+
     switch (step)
     {
     case sizeof(tb_size_t):
@@ -394,6 +446,7 @@ static tb_pointer_t tb_heap_itor_item(tb_iterator_ref_t iterator, tb_size_t itor
     tb_assert_and_check_return_val(heap && itor < heap->size, tb_null);
     
     // data
+    if (heap->scalar) return ((tb_pointer_t*)heap->data)[itor];
     return heap->element.data(&heap->element, heap->data + itor * iterator->step);
 }
 static tb_void_t tb_heap_itor_copy(tb_iterator_ref_t iterator, tb_size_t itor, tb_cpointer_t item)
@@ -412,6 +465,7 @@ static tb_long_t tb_heap_itor_comp(tb_iterator_ref_t iterator, tb_cpointer_t lit
     tb_assert_and_check_return_val(heap && heap->element.comp, 0);
 
     // comp
+    if (heap->scalar) return tb_element_scalar_comp(heap->scalar, litem, ritem);
     return heap->element.comp(&heap->element, litem, ritem);
 }
 static tb_void_t tb_heap_itor_remove(tb_iterator_ref_t iterator, tb_size_t itor)
@@ -474,6 +528,10 @@ static tb_void_t tb_heap_itor_remove(tb_iterator_ref_t iterator, tb_size_t itor)
  * implementation
  */
 tb_heap_ref_t tb_heap_init(tb_size_t grow, tb_element_t element)
+{
+    return tb_heap_init_with_allocator(grow, element, tb_null);
+}
+tb_heap_ref_t tb_heap_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator)
 {
     // check
     tb_assert_and_check_return_val(element.size && element.data && element.dupl && element.repl, tb_null);
@@ -486,17 +544,28 @@ tb_heap_ref_t tb_heap_init(tb_size_t grow, tb_element_t element)
         // using the default grow
         if (!grow) grow = TB_HEAP_GROW;
 
+        // using the global allocator if be null
+        if (!allocator) allocator = tb_allocator();
+        tb_assert_and_check_break(allocator);
+
         // make heap
-        heap = tb_malloc0_type(tb_heap_t);
+        heap = (tb_heap_t*)tb_allocator_malloc0(allocator, sizeof(tb_heap_t));
         tb_assert_and_check_break(heap);
 
+        // init allocator
+        heap->allocator = allocator;
+
         // init heap
         heap->size      = 0;
         heap->grow      = grow;
         heap->maxn      = grow;
         heap->element   = element;
+        heap->scalar    = tb_element_scalar(&element);
         tb_assert_and_check_break(heap->maxn < TB_HEAP_MAXN);
 
+        // the element data uses the allocator of the container if the element has no allocator
+        if (!heap->element.allocator) heap->element.allocator = allocator;
+
         // init iterator
         heap->itor.mode     = TB_ITERATOR_MODE_FORWARD | TB_ITERATOR_MODE_REVERSE | TB_ITERATOR_MODE_RACCESS | TB_ITERATOR_MODE_MUTABLE;
         heap->itor.priv     = tb_null;
@@ -513,7 +582,7 @@ tb_heap_ref_t tb_heap_init(tb_size_t grow, tb_element_t element)
         heap->itor.remove   = tb_heap_itor_remove;
 
         // make data
-        heap->data = (tb_byte_t*)tb_nalloc0(heap->maxn, element.size);
+        heap->data = (tb_byte_t*)tb_allocator_nalloc0(heap->allocator, heap->maxn, element.size);
         tb_assert_and_check_break(heap->data);
 
         // ok
@@ -542,11 +611,11 @@ tb_void_t tb_heap_exit(tb_heap_ref_t self)
     tb_heap_clear(self);
 
     // free data
-    if (heap->data) tb_free(heap->data);
+    if (heap->data) tb_allocator_free(heap->allocator, heap->data);
     heap->data = tb_null;
 
     // free it
-    tb_free(heap);
+    tb_allocator_free(heap->allocator, heap);
 }
 tb_void_t tb_heap_clear(tb_heap_ref_t self)
 {   
@@ -597,7 +666,7 @@ tb_void_t tb_heap_put(tb_heap_ref_t self, tb_cpointer_t data)
         tb_assert_and_check_return(maxn < TB_HEAP_MAXN);
 
         // realloc data
-        heap->data = (tb_byte_t*)tb_ralloc(heap->data, maxn * heap->element.size);
+        heap->data = (tb_byte_t*)tb_allocator_ralloc(heap->allocator, heap->data, maxn * heap->element.size);
         tb_assert_and_check_return(heap->data);
 
         // must be align by 4-bytes
@@ -618,7 +687,11 @@ tb_void_t tb_heap_put(tb_heap_ref_t self, tb_cpointer_t data)
     tb_assert(hole);
         
     // save data to the hole
-    if (hole) heap->element.dupl(&heap->element, hole, data);
+    if (hole) 
+    {
+        if (heap->scalar) *((tb_cpointer_t*)hole) = data;
+        else heap->element.dupl(&heap->element, hole, data);
+    }
 
     // update the size
     heap->size++;
@@ -634,8 +707,8 @@ tb_void_t tb_heap_pop(tb_heap_ref_t self)
     tb_heap_t* heap = (tb_heap_t*)self;
     tb_assert_and_check_return(heap && heap->data && heap->size);
 
-    // free the top item first
-    if (heap->element.free) heap->element.free(&heap->element, heap->data);
+    // free the top item first, the scalar item need not be freed
+    if (heap->element.free && !heap->scalar) heap->element.free(&heap->element, heap->data);
 
     // the last item is not in top 
     if (heap->size > 1)
@@ -651,11 +724,15 @@ tb_void_t tb_heap_pop(tb_heap_ref_t self)
         tb_pointer_t last = heap->data + (heap->size - 1) * step;
 
         // shift down the self from the top hole
-        tb_pointer_t hole = tb_heap_shift_down(heap, 0, heap->element.data(&heap->element, last));
+        tb_pointer_t hole = tb_heap_shift_down(heap, 0, heap->scalar? *((tb_pointer_t*)last) : heap->element.data(&heap->element, last));
         tb_assert(hole);
 
         // copy the last data to the hole
-        if (hole != last) tb_memcpy(hole, last, step);
+        if (hole != last) 
+        {
+            if (heap->scalar) *((tb_pointer_t*)hole) = *((tb_pointer_t*)last);
+            else tb_memcpy(hole, last, step);
+        }
     }
 
     // update the size
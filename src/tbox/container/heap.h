@@ -90,6 +90,19 @@ typedef tb_iterator_ref_t tb_heap_ref_t;
  */
 tb_heap_ref_t       tb_heap_init(tb_size_t grow, tb_element_t element);
 
+/*! init heap, default: minheap with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param grow      the item grow, using the default grow if be zero
+ * @param element   the element
+ * @param allocator the allocator, using the global allocator if be null
+ *
+ * @return          the heap
+ */
+tb_heap_ref_t       tb_heap_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit heap
  *
  * @param heap      the heap
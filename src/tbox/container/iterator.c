@@ -137,4 +137,21 @@ tb_long_t tb_iterator_comp(tb_iterator_ref_t iterator, tb_cpointer_t litem, tb_c
     // comp
     return iterator->comp(iterator, litem, ritem);
 }
+tb_pointer_t tb_iterator_scalar(tb_iterator_ref_t iterator, tb_size_t* ptype)
+{
+    // check
+    tb_assert(iterator && ptype);
+
+    // init type
+    *ptype = TB_ELEMENT_SCALAR_NONE;
 
+    // the random access iterator only
+    tb_check_return_val(iterator->scalar && (iterator->mode & TB_ITERATOR_MODE_RACCESS), tb_null);
+
+    // the scalar items
+    tb_pointer_t items = iterator->scalar(iterator, ptype);
+    if (!items) *ptype = TB_ELEMENT_SCALAR_NONE;
+
+    // ok?
+    return items;
+}
@@ -30,6 +30,7 @@
  * includes
  */
 #include "prefix.h"
+#include "element.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
@@ -96,6 +97,9 @@ typedef struct __tb_iterator_t
     /// the iterator remove range
     tb_void_t               (*remove_range)(struct __tb_iterator_t* iterator, tb_size_t prev, tb_size_t next, tb_size_t size);
 
+    /// the iterator scalar items, optional, it need be null if the iterator does not support it
+    tb_pointer_t            (*scalar)(struct __tb_iterator_t* iterator, tb_size_t* ptype);
+
 }tb_iterator_t;
 
 /// the array iterator type
@@ -292,6 +296,18 @@ tb_void_t           tb_iterator_copy(tb_iterator_ref_t iterator, tb_size_t itor,
  */
 tb_long_t           tb_iterator_comp(tb_iterator_ref_t iterator, tb_cpointer_t litem, tb_cpointer_t ritem);
 
+/*! the iterator scalar items
+ *
+ * the random access iterator returns the contiguous scalar items if the items are compared by the default comparer,
+ * the item of the itor is items[itor], so the algorithms can compare and copy them directly.
+ * 
+ * @param iterator  the iterator
+ * @param ptype     the scalar type, .e.g TB_ELEMENT_SCALAR_LONG
+ *
+ * @return          the scalar items, tb_null if the iterator items are not scalar
+ */
+tb_pointer_t        tb_iterator_scalar(tb_iterator_ref_t iterator, tb_size_t* ptype);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
@@ -36,6 +36,18 @@ static tb_long_t tb_iterator_long_comp(tb_iterator_ref_t iterator, tb_cpointer_t
 {
     return ((tb_long_t)litem < (tb_long_t)ritem)? -1 : ((tb_long_t)litem > (tb_long_t)ritem);
 }
+static tb_pointer_t tb_iterator_long_scalar(tb_iterator_ref_t iterator, tb_size_t* ptype)
+{
+    // check
+    tb_assert(iterator && ptype);
+
+    // the items are compared by the default comparer?
+    tb_check_return_val(iterator->comp == tb_iterator_long_comp, tb_null);
+
+    // the scalar items
+    *ptype = TB_ELEMENT_SCALAR_LONG;
+    return ((tb_array_iterator_ref_t)iterator)->items;
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -46,7 +58,8 @@ tb_iterator_ref_t tb_iterator_make_for_long(tb_array_iterator_ref_t iterator, tb
     if (!tb_iterator_make_for_ptr(iterator, (tb_pointer_t*)items, count)) return tb_null;
 
     // init
-    iterator->base.comp = tb_iterator_long_comp;
+    iterator->base.comp     = tb_iterator_long_comp;
+    iterator->base.scalar   = tb_iterator_long_scalar;
 
     // ok
     return (tb_iterator_ref_t)iterator;
@@ -88,6 +88,18 @@ static tb_long_t tb_iterator_ptr_comp(tb_iterator_ref_t iterator, tb_cpointer_t
 {
     return (litem < ritem)? -1 : (litem > ritem);
 }
+static tb_pointer_t tb_iterator_ptr_scalar(tb_iterator_ref_t iterator, tb_size_t* ptype)
+{
+    // check
+    tb_assert(iterator && ptype);
+
+    // the items are compared by the pointer value? the string and memory array iterators use the other comparer
+    tb_check_return_val(iterator->comp == tb_iterator_ptr_comp && iterator->step == sizeof(tb_pointer_t), tb_null);
+
+    // the scalar items
+    *ptype = TB_ELEMENT_SCALAR_SIZE;
+    return ((tb_array_iterator_ref_t)iterator)->items;
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -109,6 +121,7 @@ tb_iterator_ref_t tb_iterator_make_for_ptr(tb_array_iterator_ref_t iterator, tb_
     iterator->base.item     = tb_iterator_ptr_item;
     iterator->base.copy     = tb_iterator_ptr_copy;
     iterator->base.comp     = tb_iterator_ptr_comp;
+    iterator->base.scalar   = tb_iterator_ptr_scalar;
     iterator->items         = items;
     iterator->count         = count;
 
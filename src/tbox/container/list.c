@@ -76,6 +76,9 @@ typedef struct __tb_list_t
     // the head
     tb_list_entry_head_t        head;
 
+    // the allocator
+    tb_allocator_ref_t          allocator;
+
     // the element
     tb_element_t                element;
 
@@ -202,6 +205,10 @@ static tb_void_t tb_list_item_exit(tb_pointer_t data, tb_cpointer_t priv)
  * implementation
  */
 tb_list_ref_t tb_list_init(tb_size_t grow, tb_element_t element)
+{
+    return tb_list_init_with_allocator(grow, element, tb_null);
+}
+tb_list_ref_t tb_list_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator)
 {
     // check
     tb_assert_and_check_return_val(element.size && element.data && element.dupl && element.repl, tb_null);
@@ -214,13 +221,23 @@ tb_list_ref_t tb_list_init(tb_size_t grow, tb_element_t element)
         // using the default grow
         if (!grow) grow = TB_LIST_GROW;
 
+        // using the global allocator if be null
+        if (!allocator) allocator = tb_allocator();
+        tb_assert_and_check_break(allocator);
+
         // make self
-        list = tb_malloc0_type(tb_list_t);
+        list = (tb_list_t*)tb_allocator_malloc0(allocator, sizeof(tb_list_t));
         tb_assert_and_check_break(list);
 
+        // init allocator
+        list->allocator = allocator;
+
         // init element
         list->element = element;
 
+        // the element data uses the allocator of the container if the element has no allocator
+        if (!list->element.allocator) list->element.allocator = allocator;
+
         // init iterator
         list->itor.mode         = TB_ITERATOR_MODE_FORWARD | TB_ITERATOR_MODE_REVERSE;
         list->itor.priv         = tb_null;
@@ -238,7 +255,7 @@ tb_list_ref_t tb_list_init(tb_size_t grow, tb_element_t element)
         list->itor.remove_range = tb_list_itor_remove_range;
 
         // init pool, item = entry + data
-        list->pool = tb_fixed_pool_init(tb_null, grow, sizeof(tb_list_entry_t) + element.size, tb_null, tb_list_item_exit, (tb_cpointer_t)list);
+        list->pool = tb_fixed_pool_init(list->allocator, grow, sizeof(tb_list_entry_t) + element.size, tb_null, tb_list_item_exit, (tb_cpointer_t)list);
         tb_assert_and_check_break(list->pool);
 
         // init head
@@ -273,7 +290,7 @@ tb_void_t tb_list_exit(tb_list_ref_t self)
     if (list->pool) tb_fixed_pool_exit(list->pool);
 
     // exit it
-    tb_free(list);
+    tb_allocator_free(list->allocator, list);
 }
 tb_void_t tb_list_clear(tb_list_ref_t self)
 {
@@ -86,6 +86,19 @@ typedef tb_iterator_ref_t   tb_list_ref_t;
  */
 tb_list_ref_t       tb_list_init(tb_size_t grow, tb_element_t element);
 
+/*! init list with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param grow      the grow size
+ * @param element   the element
+ * @param allocator the allocator, using the global allocator if be null
+ *
+ * @return          the list
+ */
+tb_list_ref_t       tb_list_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit list
  *
  * @param list      the list
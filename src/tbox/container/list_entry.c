@@ -172,6 +172,7 @@ tb_void_t tb_list_entry_init_(tb_list_entry_head_ref_t list, tb_size_t entry_off
     list->itor.remove       = tb_list_entry_itor_remove;
     list->itor.remove_range = tb_list_entry_itor_remove_range;
     list->itor.comp = tb_null;
+    list->itor.scalar = tb_null;
 }
 tb_void_t tb_list_entry_exit(tb_list_entry_head_ref_t list)
 {
@@ -61,6 +61,19 @@ typedef tb_heap_ref_t       tb_priority_queue_ref_t;
  */
 tb_priority_queue_ref_t     tb_priority_queue_init(tb_size_t grow, tb_element_t element);
 
+/*! init queue, default: min-priority with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param grow              the element grow, using the default grow if be zero
+ * @param element           the element
+ * @param allocator         the allocator, using the global allocator if be null
+ *
+ * @return                  the queue
+ */
+tb_priority_queue_ref_t     tb_priority_queue_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit queue
  *
  * @param queue             the queue
@@ -35,6 +35,10 @@ tb_queue_ref_t tb_queue_init(tb_size_t grow, tb_element_t element)
 {  
     return (tb_queue_ref_t)tb_single_list_init(grow, element);
 }
+tb_queue_ref_t tb_queue_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator)
+{
+    return (tb_queue_ref_t)tb_single_list_init_with_allocator(grow, element, allocator);
+}
 tb_void_t tb_queue_exit(tb_queue_ref_t queue)
 {   
     tb_single_list_exit((tb_single_list_ref_t)queue);
@@ -76,6 +76,19 @@ typedef tb_single_list_ref_t   tb_queue_ref_t;
  */
 tb_queue_ref_t      tb_queue_init(tb_size_t grow, tb_element_t element);
 
+/*! init queue with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param grow      the grow size, using the default grow size if be zero
+ * @param element   the element
+ * @param allocator the allocator, using the global allocator if be null
+ *
+ * @return          the queue
+ */
+tb_queue_ref_t      tb_queue_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit queue
  *
  * @param queue     the queue
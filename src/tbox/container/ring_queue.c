@@ -0,0 +1,589 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        ring_queue.c
+ * @ingroup     container
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "ring_queue.h"
+#include "../libc/libc.h"
+#include "../utils/utils.h"
+#include "../memory/memory.h"
+#include "../platform/platform.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+#ifdef __tb_small__
+#   define TB_RING_QUEUE_SIZE_DEFAULT           (256)
+#else
+#   define TB_RING_QUEUE_SIZE_DEFAULT           (65536)
+#endif
+
+// the spin count before yielding the processor when waiting the peer
+#define TB_RING_QUEUE_WAIT_SPIN                 (16)
+
+// the spin and yield count before sleeping when waiting the peer
+#define TB_RING_QUEUE_WAIT_YIELD                (TB_RING_QUEUE_WAIT_SPIN + 64)
+
+// the cell for the given position
+#define tb_ring_queue_cell(queue, pos)          ((tb_ring_queue_cell_t*)((queue)->data + ((pos) & (queue)->mask) * (queue)->cell_size))
+
+// the item data of the given cell
+#define tb_ring_queue_cell_data(cell)           ((tb_byte_t*)(cell) + sizeof(tb_ring_queue_cell_t))
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/* the ring queue cell type
+ *
+ * the item data is placed after the sequence:
+ *
+ * seq == pos:              the cell is free and can be written by the producer of this position
+ * seq == pos + 1:          the cell has been written and can be read by the consumer of this position
+ * seq == pos + maxn:       the cell has been read and is free for the next round
+ */
+typedef struct __tb_ring_queue_cell_t
+{
+    // the sequence
+    tb_atomic_t             seq;
+
+}tb_ring_queue_cell_t;
+
+// the ring queue type
+typedef struct __tb_ring_queue_t
+{
+    // the mode
+    tb_size_t               mode;
+
+    // the maxn
+    tb_size_t               maxn;
+
+    // the index mask
+    tb_size_t               mask;
+
+    // the cell size
+    tb_size_t               cell_size;
+
+    // the cells data
+    tb_byte_t*              data;
+
+    // the allocator
+    tb_allocator_ref_t      allocator;
+
+    // the element
+    tb_element_t            element;
+
+    // the padding for the tail
+    tb_byte_t               pad0[TB_L1_CACHE_BYTES];
+
+    // the tail position for producers
+    tb_atomic_t             tail;
+
+    // the cached head position for the single producer
+    tb_size_t               head_cache;
+
+    // the padding for the head
+    tb_byte_t               pad1[TB_L1_CACHE_BYTES];
+
+    // the head position for consumers
+    tb_atomic_t             head;
+
+    // the cached tail position for the single consumer
+    tb_size_t               tail_cache;
+
+    // the padding
+    tb_byte_t               pad2[TB_L1_CACHE_BYTES];
+
+}tb_ring_queue_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+
+/* load the position or sequence with the acquire semantics
+ *
+ * tb_atomic_get() will lock the cache line for writing (cmpxchg), it is too slow for polling
+ */
+static __tb_inline__ tb_size_t tb_ring_queue_load(tb_atomic_t* a)
+{
+#ifdef __ATOMIC_ACQUIRE
+    return (tb_size_t)__atomic_load_n(a, __ATOMIC_ACQUIRE);
+#else
+    tb_size_t v = (tb_size_t)*a;
+    tb_barrier();
+    return v;
+#endif
+}
+
+// store the position or sequence with the release semantics
+static __tb_inline__ tb_void_t tb_ring_queue_store(tb_atomic_t* a, tb_size_t v)
+{
+#ifdef __ATOMIC_RELEASE
+    __atomic_store_n(a, (tb_long_t)v, __ATOMIC_RELEASE);
+#else
+    tb_barrier();
+    *a = (tb_long_t)v;
+#endif
+}
+
+/* wait the cell sequence for the claimed position
+ *
+ * the peer which has claimed this cell may be preempted before finishing it,
+ * so we spin a moment first, then yield the processor and sleep 1ms at last to give it a chance to run.
+ */
+static tb_void_t tb_ring_queue_wait(tb_ring_queue_cell_t* cell, tb_size_t seq)
+{
+    tb_size_t tryn = 0;
+    while (tb_ring_queue_load(&cell->seq) != seq)
+    {
+        // backoff
+        tryn++;
+        if (tryn > TB_RING_QUEUE_WAIT_YIELD) tb_msleep(1);
+        else if (tryn > TB_RING_QUEUE_WAIT_SPIN) tb_sched_yield();
+    }
+}
+static tb_bool_t tb_ring_queue_put_mp(tb_ring_queue_t* queue, tb_cpointer_t data)
+{
+    // claim the tail position
+    tb_ring_queue_cell_t*   cell = tb_null;
+    tb_size_t               pos = tb_ring_queue_load(&queue->tail);
+    while (1)
+    {
+        // the cell is free for this position?
+        cell = tb_ring_queue_cell(queue, pos);
+        tb_long_t diff = (tb_long_t)(tb_ring_queue_load(&cell->seq) - pos);
+        if (!diff)
+        {
+            // claim it
+            tb_size_t real = (tb_size_t)tb_atomic_fetch_and_pset(&queue->tail, (tb_long_t)pos, (tb_long_t)(pos + 1));
+            tb_check_break(real != pos);
+
+            // claimed by the other producer, try the new position
+            pos = real;
+        }
+        // full?
+        else if (diff < 0) return tb_false;
+        // the position has been claimed, try the new position
+        else pos = tb_ring_queue_load(&queue->tail);
+    }
+
+    // write it and publish it to the consumer
+    queue->element.dupl(&queue->element, tb_ring_queue_cell_data(cell), data);
+    tb_ring_queue_store(&cell->seq, pos + 1);
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_ring_queue_put_sp(tb_ring_queue_t* queue, tb_cpointer_t data)
+{
+    // full?
+    tb_size_t pos = (tb_size_t)queue->tail;
+    if (pos - queue->head_cache >= queue->maxn)
+    {
+        // update the cached head
+        queue->head_cache = tb_ring_queue_load(&queue->head);
+        tb_check_return_val(pos - queue->head_cache < queue->maxn, tb_false);
+    }
+
+    // write it and publish it to the consumer
+    queue->element.dupl(&queue->element, tb_ring_queue_cell_data(tb_ring_queue_cell(queue, pos)), data);
+    tb_ring_queue_store(&queue->tail, pos + 1);
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_ring_queue_pop_mc(tb_ring_queue_t* queue, tb_pointer_t item)
+{
+    // claim the head position
+    tb_ring_queue_cell_t*   cell = tb_null;
+    tb_size_t               pos = tb_ring_queue_load(&queue->head);
+    while (1)
+    {
+        // the cell has been written for this position?
+        cell = tb_ring_queue_cell(queue, pos);
+        tb_long_t diff = (tb_long_t)(tb_ring_queue_load(&cell->seq) - (pos + 1));
+        if (!diff)
+        {
+            // claim it
+            tb_size_t real = (tb_size_t)tb_atomic_fetch_and_pset(&queue->head, (tb_long_t)pos, (tb_long_t)(pos + 1));
+            tb_check_break(real != pos);
+
+            // claimed by the other consumer, try the new position
+            pos = real;
+        }
+        // null?
+        else if (diff < 0) return tb_false;
+        // the position has been claimed, try the new position
+        else pos = tb_ring_queue_load(&queue->head);
+    }
+
+    // move it out or free it
+    if (item) tb_memcpy(item, tb_ring_queue_cell_data(cell), queue->element.size);
+    else if (queue->element.free) queue->element.free(&queue->element, tb_ring_queue_cell_data(cell));
+
+    // free this cell for the next round
+    tb_ring_queue_store(&cell->seq, pos + queue->maxn);
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_ring_queue_pop_sc(tb_ring_queue_t* queue, tb_pointer_t item)
+{
+    // the cell has been written for this position?
+    tb_size_t               pos = (tb_size_t)queue->head;
+    tb_ring_queue_cell_t*   cell = tb_ring_queue_cell(queue, pos);
+    tb_check_return_val(tb_ring_queue_load(&cell->seq) == pos + 1, tb_false);
+
+    // move it out or free it
+    if (item) tb_memcpy(item, tb_ring_queue_cell_data(cell), queue->element.size);
+    else if (queue->element.free) queue->element.free(&queue->element, tb_ring_queue_cell_data(cell));
+
+    // free this cell for the next round
+    tb_ring_queue_store(&cell->seq, pos + queue->maxn);
+    tb_ring_queue_store(&queue->head, pos + 1);
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_ring_queue_pop_spsc(tb_ring_queue_t* queue, tb_pointer_t item)
+{
+    // null?
+    tb_size_t pos = (tb_size_t)queue->head;
+    if (pos == queue->tail_cache)
+    {
+        // update the cached tail
+        queue->tail_cache = tb_ring_queue_load(&queue->tail);
+        tb_check_return_val(pos != queue->tail_cache, tb_false);
+    }
+
+    // move it out or free it
+    tb_byte_t* data = tb_ring_queue_cell_data(tb_ring_queue_cell(queue, pos));
+    if (item) tb_memcpy(item, data, queue->element.size);
+    else if (queue->element.free) queue->element.free(&queue->element, data);
+
+    // free this cell for the producer
+    tb_ring_queue_store(&queue->head, pos + 1);
+
+    // ok
+    return tb_true;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_ring_queue_ref_t tb_ring_queue_init(tb_size_t maxn, tb_element_t element, tb_size_t mode)
+{
+    return tb_ring_queue_init_with_allocator(maxn, element, mode, tb_null);
+}
+tb_ring_queue_ref_t tb_ring_queue_init_with_allocator(tb_size_t maxn, tb_element_t element, tb_size_t mode, tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert_and_check_return_val(element.size && element.dupl && mode <= TB_RING_QUEUE_MODE_SPSC, tb_null);
+
+    // done
+    tb_bool_t           ok = tb_false;
+    tb_ring_queue_t*    queue = tb_null;
+    do
+    {
+        // using the global allocator if be null
+        if (!allocator) allocator = tb_allocator();
+        tb_assert_and_check_break(allocator);
+
+        // make queue
+        queue = (tb_ring_queue_t*)tb_allocator_malloc0(allocator, sizeof(tb_ring_queue_t));
+        tb_assert_and_check_break(queue);
+
+        // init allocator
+        queue->allocator = allocator;
+
+        // using the default maxn
+        if (!maxn) maxn = TB_RING_QUEUE_SIZE_DEFAULT;
+
+        /* init queue
+         *
+         * the maxn must be larger than 1, otherwise the written sequence (pos + 1) will be same as the read sequence (pos + maxn)
+         */
+        queue->mode      = mode;
+        queue->maxn      = tb_align_pow2(tb_max(maxn, 2));
+        queue->mask      = queue->maxn - 1;
+        queue->element   = element;
+        queue->cell_size = tb_align(sizeof(tb_ring_queue_cell_t) + element.size, sizeof(tb_ring_queue_cell_t));
+
+        // the element data uses the allocator of the container if the element has no allocator
+        if (!queue->element.allocator) queue->element.allocator = allocator;
+
+        // make data
+        queue->data = (tb_byte_t*)tb_allocator_nalloc0(queue->allocator, queue->maxn, queue->cell_size);
+        tb_assert_and_check_break(queue->data);
+
+        // init the cell sequences
+        tb_size_t i = 0;
+        for (i = 0; i < queue->maxn; i++) tb_ring_queue_cell(queue, i)->seq = (tb_long_t)i;
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        if (queue) tb_ring_queue_exit((tb_ring_queue_ref_t)queue);
+        queue = tb_null;
+    }
+
+    // ok?
+    return (tb_ring_queue_ref_t)queue;
+}
+tb_void_t tb_ring_queue_exit(tb_ring_queue_ref_t self)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return(queue);
+
+    // clear data
+    if (queue->data) tb_ring_queue_clear(self);
+
+    // free data
+    if (queue->data) tb_allocator_free(queue->allocator, queue->data);
+
+    // free it
+    tb_allocator_free(queue->allocator, queue);
+}
+tb_void_t tb_ring_queue_clear(tb_ring_queue_ref_t self)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return(queue && queue->data);
+
+    // free all items
+    while (tb_ring_queue_pop(self, tb_null)) ;
+}
+tb_bool_t tb_ring_queue_put(tb_ring_queue_ref_t self, tb_cpointer_t data)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return_val(queue, tb_false);
+
+    // put it
+    return queue->mode == TB_RING_QUEUE_MODE_SPSC? tb_ring_queue_put_sp(queue, data) : tb_ring_queue_put_mp(queue, data);
+}
+tb_bool_t tb_ring_queue_pop(tb_ring_queue_ref_t self, tb_pointer_t item)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return_val(queue, tb_false);
+
+    // pop it
+    switch (queue->mode)
+    {
+    case TB_RING_QUEUE_MODE_MPSC:   return tb_ring_queue_pop_sc(queue, item);
+    case TB_RING_QUEUE_MODE_SPSC:   return tb_ring_queue_pop_spsc(queue, item);
+    default:                        return tb_ring_queue_pop_mc(queue, item);
+    }
+}
+tb_size_t tb_ring_queue_put_list(tb_ring_queue_ref_t self, tb_cpointer_t const* list, tb_size_t size)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return_val(queue && list, 0);
+
+    // the single producer?
+    tb_size_t i = 0;
+    tb_size_t pos = 0;
+    tb_size_t count = 0;
+    if (queue->mode == TB_RING_QUEUE_MODE_SPSC)
+    {
+        // the free count
+        pos = (tb_size_t)queue->tail;
+        if (pos - queue->head_cache + size > queue->maxn) queue->head_cache = tb_ring_queue_load(&queue->head);
+        count = tb_min(size, queue->maxn - (pos - queue->head_cache));
+
+        // write them and publish them to the consumer
+        for (i = 0; i < count; i++)
+            queue->element.dupl(&queue->element, tb_ring_queue_cell_data(tb_ring_queue_cell(queue, pos + i)), list[i]);
+        if (count) tb_ring_queue_store(&queue->tail, pos + count);
+        return count;
+    }
+
+    // claim the tail positions
+    pos = tb_ring_queue_load(&queue->tail);
+    while (1)
+    {
+        // the used count, the loaded tail may be older than the head
+        tb_long_t used = (tb_long_t)(pos - tb_ring_queue_load(&queue->head));
+        if (used < 0)
+        {
+            pos = tb_ring_queue_load(&queue->tail);
+            continue;
+        }
+
+        // full?
+        tb_check_return_val((tb_size_t)used < queue->maxn, 0);
+
+        // claim them
+        count = tb_min(size, queue->maxn - (tb_size_t)used);
+        tb_size_t real = (tb_size_t)tb_atomic_fetch_and_pset(&queue->tail, (tb_long_t)pos, (tb_long_t)(pos + count));
+        tb_check_break(real != pos);
+
+        // claimed by the other producer, try the new position
+        pos = real;
+    }
+
+    // write them and publish them to the consumers
+    for (i = 0; i < count; i++)
+    {
+        // wait the consumer of the last round to free this cell
+        tb_ring_queue_cell_t* cell = tb_ring_queue_cell(queue, pos + i);
+        tb_ring_queue_wait(cell, pos + i);
+
+        // write it
+        queue->element.dupl(&queue->element, tb_ring_queue_cell_data(cell), list[i]);
+        tb_ring_queue_store(&cell->seq, pos + i + 1);
+    }
+
+    // ok
+    return count;
+}
+tb_size_t tb_ring_queue_pop_list(tb_ring_queue_ref_t self, tb_pointer_t items, tb_size_t maxn)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return_val(queue && items, 0);
+
+    // done
+    tb_size_t   i = 0;
+    tb_size_t   pos = 0;
+    tb_size_t   count = 0;
+    tb_size_t   step = queue->element.size;
+    tb_byte_t*  data = (tb_byte_t*)items;
+    switch (queue->mode)
+    {
+    case TB_RING_QUEUE_MODE_SPSC:
+        {
+            // the items count
+            pos = (tb_size_t)queue->head;
+            if (queue->tail_cache - pos < maxn) queue->tail_cache = tb_ring_queue_load(&queue->tail);
+            count = tb_min(maxn, queue->tail_cache - pos);
+
+            // move them out and free these cells for the producer
+            for (i = 0; i < count; i++, data += step)
+                tb_memcpy(data, tb_ring_queue_cell_data(tb_ring_queue_cell(queue, pos + i)), step);
+            if (count) tb_ring_queue_store(&queue->head, pos + count);
+        }
+        break;
+    case TB_RING_QUEUE_MODE_MPSC:
+        {
+            // move out all written items
+            pos = (tb_size_t)queue->head;
+            for (count = 0; count < maxn; count++, data += step)
+            {
+                // the cell has been written?
+                tb_ring_queue_cell_t* cell = tb_ring_queue_cell(queue, pos + count);
+                tb_check_break(tb_ring_queue_load(&cell->seq) == pos + count + 1);
+
+                // move it out and free this cell for the next round
+                tb_memcpy(data, tb_ring_queue_cell_data(cell), step);
+                tb_ring_queue_store(&cell->seq, pos + count + queue->maxn);
+            }
+            if (count) tb_ring_queue_store(&queue->head, pos + count);
+        }
+        break;
+    default:
+        {
+            // claim the head positions
+            pos = tb_ring_queue_load(&queue->head);
+            while (1)
+            {
+                // the items count, the loaded head may be older than the tail
+                tb_long_t size = (tb_long_t)(tb_ring_queue_load(&queue->tail) - pos);
+                if (size < 0)
+                {
+                    pos = tb_ring_queue_load(&queue->head);
+                    continue;
+                }
+
+                // null?
+                tb_check_return_val(size, 0);
+
+                // claim them
+                count = tb_min(maxn, (tb_size_t)size);
+                tb_size_t real = (tb_size_t)tb_atomic_fetch_and_pset(&queue->head, (tb_long_t)pos, (tb_long_t)(pos + count));
+                tb_check_break(real != pos);
+
+                // claimed by the other consumer, try the new position
+                pos = real;
+            }
+
+            // move them out
+            for (i = 0; i < count; i++, data += step)
+            {
+                // wait the producer to finish writing this cell
+                tb_ring_queue_cell_t* cell = tb_ring_queue_cell(queue, pos + i);
+                tb_ring_queue_wait(cell, pos + i + 1);
+
+                // move it out and free this cell for the next round
+                tb_memcpy(data, tb_ring_queue_cell_data(cell), step);
+                tb_ring_queue_store(&cell->seq, pos + i + queue->maxn);
+            }
+        }
+        break;
+    }
+
+    // ok
+    return count;
+}
+tb_size_t tb_ring_queue_size(tb_ring_queue_ref_t self)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return_val(queue, 0);
+
+    // the size
+    tb_size_t head = tb_ring_queue_load(&queue->head);
+    tb_size_t tail = tb_ring_queue_load(&queue->tail);
+    return (tb_long_t)(tail - head) > 0? tb_min(tail - head, queue->maxn) : 0;
+}
+tb_size_t tb_ring_queue_maxn(tb_ring_queue_ref_t self)
+{
+    // check
+    tb_ring_queue_t* queue = (tb_ring_queue_t*)self;
+    tb_assert_and_check_return_val(queue, 0);
+
+    // the maxn
+    return queue->maxn;
+}
+tb_bool_t tb_ring_queue_full(tb_ring_queue_ref_t self)
+{
+    // is full?
+    return tb_ring_queue_size(self) == tb_ring_queue_maxn(self);
+}
+tb_bool_t tb_ring_queue_null(tb_ring_queue_ref_t self)
+{
+    // is null?
+    return !tb_ring_queue_size(self);
+}
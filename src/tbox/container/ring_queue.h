@@ -0,0 +1,208 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        ring_queue.h
+ * @ingroup     container
+ *
+ */
+#ifndef TB_CONTAINER_RING_QUEUE_H
+#define TB_CONTAINER_RING_QUEUE_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "element.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the ring queue mode enum
+typedef enum __tb_ring_queue_mode_e
+{
+    TB_RING_QUEUE_MODE_MPMC     = 0 //!< multi-producer and multi-consumer
+,   TB_RING_QUEUE_MODE_MPSC     = 1 //!< multi-producer and single-consumer
+,   TB_RING_QUEUE_MODE_SPSC     = 2 //!< single-producer and single-consumer
+
+}tb_ring_queue_mode_e;
+
+/*! the lock-free ring queue ref type
+ *
+ * the bounded queue can be shared between threads without the external lock.
+ *
+ * <pre>
+ * queue: |-----|||||||||||||||||||||||||||||||||||||||||||||------------------|
+ *             head (consumers)                          tail (producers)
+ *
+ * the slot index is (position & (maxn - 1)) and maxn is aligned to the power of 2
+ *
+ * performance:
+ *
+ * put: O(1), lock-free
+ * pop: O(1), lock-free
+ *
+ * </pre>
+ *
+ * @note the items are stored in the queue by element.dupl() and moved out by tb_ring_queue_pop(),
+ * so the popped item need be freed by element.free() if the element has the free function (.e.g tb_element_str(tb_true)),
+ * and the element.allocator need be same as the allocator of the queue if it was inited by tb_ring_queue_init_with_allocator()
+ */
+typedef __tb_typeref__(ring_queue);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init queue
+ *
+ * @param maxn          the item maxn, it will be aligned to the power of 2 and at least 2, using the default maxn if be zero
+ * @param element       the element
+ * @param mode          the queue mode, .e.g TB_RING_QUEUE_MODE_MPMC
+ *
+ * @return              the queue
+ */
+tb_ring_queue_ref_t     tb_ring_queue_init(tb_size_t maxn, tb_element_t element, tb_size_t mode);
+
+/*! init queue with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param maxn          the item maxn, it will be aligned to the power of 2 and at least 2, using the default maxn if be zero
+ * @param element       the element
+ * @param mode          the queue mode, .e.g TB_RING_QUEUE_MODE_MPMC
+ * @param allocator     the allocator, using the global allocator if be null
+ *
+ * @return              the queue
+ */
+tb_ring_queue_ref_t     tb_ring_queue_init_with_allocator(tb_size_t maxn, tb_element_t element, tb_size_t mode, tb_allocator_ref_t allocator);
+
+/*! exit queue
+ *
+ * @param queue         the queue
+ */
+tb_void_t               tb_ring_queue_exit(tb_ring_queue_ref_t queue);
+
+/*! clear the queue, it is not thread-safe
+ *
+ * @param queue         the queue
+ */
+tb_void_t               tb_ring_queue_clear(tb_ring_queue_ref_t queue);
+
+/*! put the queue item
+ *
+ * @param queue         the queue
+ * @param data          the item data
+ *
+ * @return              tb_true or tb_false if the queue is full
+ */
+tb_bool_t               tb_ring_queue_put(tb_ring_queue_ref_t queue, tb_cpointer_t data);
+
+/*! pop the queue item
+ *
+ * @code
+ * tb_long_t value = 0;
+ * if (tb_ring_queue_pop(queue, &value))
+ * {
+ *     // ...
+ * }
+ * @endcode
+ *
+ * @param queue         the queue
+ * @param item          the item buffer with element.size bytes, the item will be freed if be null
+ *
+ * @return              tb_true or tb_false if the queue is null
+ */
+tb_bool_t               tb_ring_queue_pop(tb_ring_queue_ref_t queue, tb_pointer_t item);
+
+/*! put the queue items in batches
+ *
+ * the producer need wait the consumers which have been removed the slots but not finished yet,
+ * so it is faster than tb_ring_queue_put() for lots of items, but it may be blocked for a short time.
+ *
+ * @note it will block until the preempted consumers have finished these slots in the mpmc and mpsc mode, 
+ * it spins, yields and sleeps 1ms for waiting them, so please use tb_ring_queue_put() if it cannot be blocked.
+ *
+ * @param queue         the queue
+ * @param list          the item data list
+ * @param size          the item count
+ *
+ * @return              the real put count, 0: the queue is full
+ */
+tb_size_t               tb_ring_queue_put_list(tb_ring_queue_ref_t queue, tb_cpointer_t const* list, tb_size_t size);
+
+/*! pop the queue items in batches
+ *
+ * @note it will block until the preempted producers have finished these slots in the mpmc mode, 
+ * it spins, yields and sleeps 1ms for waiting them, so please use tb_ring_queue_pop() if it cannot be blocked.
+ *
+ * @param queue         the queue
+ * @param items         the items buffer with maxn * element.size bytes
+ * @param maxn          the maximum count of the items
+ *
+ * @return              the real pop count, 0: the queue is null
+ */
+tb_size_t               tb_ring_queue_pop_list(tb_ring_queue_ref_t queue, tb_pointer_t items, tb_size_t maxn);
+
+/*! the queue size, it is only a snapshot if the queue is being accessed by the other threads
+ *
+ * @param queue         the queue
+ *
+ * @return              the queue size
+ */
+tb_size_t               tb_ring_queue_size(tb_ring_queue_ref_t queue);
+
+/*! the queue maxn
+ *
+ * @param queue         the queue
+ *
+ * @return              the queue maxn
+ */
+tb_size_t               tb_ring_queue_maxn(tb_ring_queue_ref_t queue);
+
+/*! the queue full?
+ *
+ * @param queue         the queue
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_ring_queue_full(tb_ring_queue_ref_t queue);
+
+/*! the queue null?
+ *
+ * @param queue         the queue
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_ring_queue_null(tb_ring_queue_ref_t queue);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -148,6 +148,7 @@ tb_void_t tb_single_list_entry_init_(tb_single_list_entry_head_ref_t list, tb_si
     list->itor.copy         = tb_single_list_entry_itor_copy;
     list->itor.remove_range = tb_single_list_entry_itor_remove_range;
     list->itor.comp         = tb_null;
+    list->itor.scalar       = tb_null;
 }
 tb_void_t tb_single_list_entry_exit(tb_single_list_entry_head_ref_t list)
 {
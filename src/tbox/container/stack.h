@@ -78,6 +78,19 @@ typedef tb_vector_ref_t tb_stack_ref_t;
  */
 tb_stack_ref_t      tb_stack_init(tb_size_t grow, tb_element_t element);
 
+/*! init stack with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param grow      the item grow
+ * @param element   the element
+ * @param allocator the allocator, using the global allocator if be null
+ *
+ * @return          the stack
+ */
+tb_stack_ref_t      tb_stack_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exit stack
  *
  * @param stack     the stack
@@ -81,9 +81,15 @@ typedef struct __tb_vector_t
     // the maxn
     tb_size_t               maxn;
 
+    // the allocator
+    tb_allocator_ref_t      allocator;
+
     // the element
     tb_element_t            element;
 
+    // the element scalar type, the scalar items are compared and copied directly
+    tb_size_t               scalar;
+
 }tb_vector_t;
 
 /* //////////////////////////////////////////////////////////////////////////////////////
@@ -148,6 +154,7 @@ static tb_pointer_t tb_vector_itor_item(tb_iterator_ref_t iterator, tb_size_t it
     tb_assert_and_check_return_val(vector && itor < vector->size, tb_null);
     
     // data
+    if (vector->scalar) return ((tb_pointer_t*)vector->data)[itor];
     return vector->element.data(&vector->element, vector->data + itor * iterator->step);
 }
 static tb_void_t tb_vector_itor_copy(tb_iterator_ref_t iterator, tb_size_t itor, tb_cpointer_t item)
@@ -157,7 +164,8 @@ static tb_void_t tb_vector_itor_copy(tb_iterator_ref_t iterator, tb_size_t itor,
     tb_assert(vector);
 
     // copy
-    vector->element.copy(&vector->element, vector->data + itor * iterator->step, item);
+    if (vector->scalar) ((tb_cpointer_t*)vector->data)[itor] = item;
+    else vector->element.copy(&vector->element, vector->data + itor * iterator->step, item);
 }
 static tb_long_t tb_vector_itor_comp(tb_iterator_ref_t iterator, tb_cpointer_t litem, tb_cpointer_t ritem)
 {
@@ -166,8 +174,22 @@ static tb_long_t tb_vector_itor_comp(tb_iterator_ref_t iterator, tb_cpointer_t l
     tb_assert(vector && vector->element.comp);
 
     // comp
+    if (vector->scalar) return tb_element_scalar_comp(vector->scalar, litem, ritem);
     return vector->element.comp(&vector->element, litem, ritem);
 }
+static tb_pointer_t tb_vector_itor_scalar(tb_iterator_ref_t iterator, tb_size_t* ptype)
+{
+    // check
+    tb_vector_t* vector = (tb_vector_t*)iterator;
+    tb_assert(vector && ptype);
+
+    // not scalar?
+    tb_check_return_val(vector->scalar, tb_null);
+
+    // the scalar items
+    *ptype = vector->scalar;
+    return vector->data;
+}
 static tb_void_t tb_vector_itor_remove(tb_iterator_ref_t iterator, tb_size_t itor)
 {
     // remove it
@@ -187,6 +209,10 @@ static tb_void_t tb_vector_itor_remove_range(tb_iterator_ref_t iterator, tb_size
  * implementation
  */
 tb_vector_ref_t tb_vector_init(tb_size_t grow, tb_element_t element)
+{
+    return tb_vector_init_with_allocator(grow, element, tb_null);
+}
+tb_vector_ref_t tb_vector_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator)
 {
     // check
     tb_assert_and_check_return_val(element.size && element.data && element.dupl && element.repl && element.ndupl && element.nrepl, tb_null);
@@ -199,17 +225,28 @@ tb_vector_ref_t tb_vector_init(tb_size_t grow, tb_element_t element)
         // using the default grow
         if (!grow) grow = TB_VECTOR_GROW;
 
+        // using the global allocator if be null
+        if (!allocator) allocator = tb_allocator();
+        tb_assert_and_check_break(allocator);
+
         // make vector
-        vector = tb_malloc0_type(tb_vector_t);
+        vector = (tb_vector_t*)tb_allocator_malloc0(allocator, sizeof(tb_vector_t));
         tb_assert_and_check_break(vector);
 
+        // init allocator
+        vector->allocator = allocator;
+
         // init vector
         vector->size      = 0;
         vector->grow      = grow;
         vector->maxn      = grow;
         vector->element   = element;
+        vector->scalar    = tb_element_scalar(&element);
         tb_assert_and_check_break(vector->maxn < TB_VECTOR_MAXN);
 
+        // the element data uses the allocator of the container if the element has no allocator
+        if (!vector->element.allocator) vector->element.allocator = allocator;
+
         // init iterator
         vector->itor.mode         = TB_ITERATOR_MODE_FORWARD | TB_ITERATOR_MODE_REVERSE | TB_ITERATOR_MODE_RACCESS | TB_ITERATOR_MODE_MUTABLE;
         vector->itor.priv         = tb_null;
@@ -225,9 +262,10 @@ tb_vector_ref_t tb_vector_init(tb_size_t grow, tb_element_t element)
         vector->itor.comp         = tb_vector_itor_comp;
         vector->itor.remove       = tb_vector_itor_remove;
         vector->itor.remove_range = tb_vector_itor_remove_range;
+        vector->itor.scalar       = tb_vector_itor_scalar;
 
         // make data
-        vector->data = (tb_byte_t*)tb_nalloc0(vector->maxn, element.size);
+        vector->data = (tb_byte_t*)tb_allocator_nalloc0(vector->allocator, vector->maxn, element.size);
         tb_assert_and_check_break(vector->data);
 
         // ok
@@ -256,11 +294,11 @@ tb_void_t tb_vector_exit(tb_vector_ref_t self)
     tb_vector_clear(self);
 
     // free data
-    if (vector->data) tb_free(vector->data);
+    if (vector->data) tb_allocator_free(vector->allocator, vector->data);
     vector->data = tb_null;
 
     // free it
-    tb_free(vector);
+    tb_allocator_free(vector->allocator, vector);
 }
 tb_void_t tb_vector_clear(tb_vector_ref_t self)
 {
@@ -372,7 +410,7 @@ tb_bool_t tb_vector_resize(tb_vector_ref_t self, tb_size_t size)
         tb_assert_and_check_return_val(maxn < TB_VECTOR_MAXN, tb_false);
 
         // realloc data
-        vector->data = (tb_byte_t*)tb_ralloc(vector->data, maxn * vector->element.size);
+        vector->data = (tb_byte_t*)tb_allocator_ralloc(vector->allocator, vector->data, maxn * vector->element.size);
         tb_assert_and_check_return_val(vector->data, tb_false);
 
         // must be align by 4-bytes
@@ -409,7 +447,8 @@ tb_void_t tb_vector_insert_prev(tb_vector_ref_t self, tb_size_t itor, tb_cpointe
     if (osize != itor) tb_memmov(vector->data + (itor + 1) * vector->element.size, vector->data + itor * vector->element.size, (osize - itor) * vector->element.size);
 
     // save data
-    vector->element.dupl(&vector->element, vector->data + itor * vector->element.size, data);
+    if (vector->scalar) ((tb_cpointer_t*)vector->data)[itor] = data;
+    else vector->element.dupl(&vector->element, vector->data + itor * vector->element.size, data);
 }
 tb_void_t tb_vector_insert_next(tb_vector_ref_t self, tb_size_t itor, tb_cpointer_t data)
 {
@@ -464,7 +503,8 @@ tb_void_t tb_vector_replace(tb_vector_ref_t self, tb_size_t itor, tb_cpointer_t
     tb_assert_and_check_return(vector && vector->data && itor <= vector->size);
 
     // replace data
-    vector->element.repl(&vector->element, vector->data + itor * vector->element.size, data);
+    if (vector->scalar) ((tb_cpointer_t*)vector->data)[itor] = data;
+    else vector->element.repl(&vector->element, vector->data + itor * vector->element.size, data);
 }
 tb_void_t tb_vector_replace_head(tb_vector_ref_t self, tb_cpointer_t data)
 {
@@ -513,7 +553,8 @@ tb_void_t tb_vector_remove(tb_vector_ref_t self, tb_size_t itor)
     if (vector->size)
     {
         // do free
-        if (vector->element.free) vector->element.free(&vector->element, vector->data + itor * vector->element.size);
+        if (vector->scalar) ((tb_pointer_t*)vector->data)[itor] = tb_null;
+        else if (vector->element.free) vector->element.free(&vector->element, vector->data + itor * vector->element.size);
 
         // move data if itor is not last
         if (itor < vector->size - 1) tb_memmov(vector->data + itor * vector->element.size, vector->data + (itor + 1) * vector->element.size, (vector->size - itor - 1) * vector->element.size);
@@ -535,7 +576,8 @@ tb_void_t tb_vector_remove_last(tb_vector_ref_t self)
     if (vector->size)
     {
         // do free
-        if (vector->element.free) vector->element.free(&vector->element, vector->data + (vector->size - 1) * vector->element.size);
+        if (vector->scalar) ((tb_pointer_t*)vector->data)[vector->size - 1] = tb_null;
+        else if (vector->element.free) vector->element.free(&vector->element, vector->data + (vector->size - 1) * vector->element.size);
 
         // resize
         vector->size--;
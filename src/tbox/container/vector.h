@@ -119,6 +119,19 @@ typedef tb_iterator_ref_t tb_vector_ref_t;
  */
 tb_vector_ref_t     tb_vector_init(tb_size_t grow, tb_element_t element);
 
+/*! init vector with the given allocator
+ *
+ * the container and the element data are allocated from the given allocator,
+ * but the element will use its own allocator if it has been set.
+ *
+ * @param grow      the item grow
+ * @param element   the element
+ * @param allocator the allocator, using the global allocator if be null
+ *
+ * @return          the vector
+ */
+tb_vector_ref_t     tb_vector_init_with_allocator(tb_size_t grow, tb_element_t element, tb_allocator_ref_t allocator);
+
 /*! exist vector
  *
  * @param vector    the vector
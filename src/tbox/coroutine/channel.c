@@ -37,6 +37,7 @@
 #include "coroutine.h"
 #include "scheduler.h"
 #include "impl/impl.h"
+#include "../platform/semaphore.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
@@ -83,8 +84,31 @@ typedef struct __tb_co_channel_t
     // the waiting recv coroutines 
     tb_single_list_entry_head_t     waiting_recv;
 
+    // the waiting send plain threads for the shared channel
+    tb_single_list_entry_head_t     waiting_send_threads;
+
+    // the waiting recv plain threads for the shared channel
+    tb_single_list_entry_head_t     waiting_recv_threads;
+
+    // the flags
+    tb_size_t                       flags;
+
+    // the lock for the shared channel
+    tb_spinlock_t                   lock;
+
 }tb_co_channel_t;
 
+// the waiting plain thread type for the shared channel, it is placed on the stack of the waiting thread
+typedef struct __tb_co_channel_thread_t
+{
+    // the list entry
+    tb_single_list_entry_t          entry;
+
+    // the event for waking up this thread
+    tb_semaphore_ref_t              event;
+
+}tb_co_channel_thread_t;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * private implementation
  */
@@ -357,11 +381,232 @@ static tb_pointer_t tb_co_channel_recv_buffer0(tb_co_channel_t* channel)
     return data;
 }
 
+static tb_pointer_t tb_co_channel_shared_waiting(tb_single_list_entry_head_ref_t waiting)
+{
+    // check
+    tb_assert(waiting);
+
+    // no waiting coroutines or threads?
+    tb_check_return_val(tb_single_list_entry_size(waiting), tb_null);
+
+    // get the next entry from head
+    tb_single_list_entry_ref_t entry = tb_single_list_entry_head(waiting);
+    tb_assert(entry);
+
+    // remove it from the waiting list
+    tb_single_list_entry_remove_head(waiting);
+
+    // get the waiting coroutine or thread
+    return tb_single_list_entry(waiting, entry);
+}
+static tb_bool_t tb_co_channel_shared_waiting_remove(tb_single_list_entry_head_ref_t waiting, tb_single_list_entry_ref_t entry)
+{
+    // check
+    tb_assert(waiting && entry);
+
+    // find and remove it
+    tb_single_list_entry_ref_t prev = (tb_single_list_entry_ref_t)waiting;
+    tb_single_list_entry_ref_t item = tb_single_list_entry_head(waiting);
+    while (item)
+    {
+        if (item == entry)
+        {
+            tb_single_list_entry_remove_next(waiting, prev);
+            return tb_true;
+        }
+        prev = item;
+        item = tb_single_list_entry_next(item);
+    }
+
+    // not found, it has been resumed
+    return tb_false;
+}
+static tb_coroutine_t* tb_co_channel_shared_notify(tb_single_list_entry_head_ref_t waiting, tb_single_list_entry_head_ref_t waiting_threads)
+{
+    // check
+    tb_assert(waiting && waiting_threads);
+
+    // get the first waiting coroutine, it will be resumed after leaving the lock
+    tb_coroutine_t* coroutine = (tb_coroutine_t*)tb_co_channel_shared_waiting(waiting);
+    tb_check_return_val(!coroutine, coroutine);
+
+    // wake up the first waiting thread, we post it in the lock because the thread will exit the event after being waked up
+    tb_co_channel_thread_t* thread = (tb_co_channel_thread_t*)tb_co_channel_shared_waiting(waiting_threads);
+    if (thread) tb_semaphore_post(thread->event, 1);
+
+    // no coroutine
+    return tb_null;
+}
+static tb_bool_t tb_co_channel_shared_wait(tb_co_channel_t* channel, tb_single_list_entry_head_ref_t waiting, tb_single_list_entry_head_ref_t waiting_threads)
+{
+    // check
+    tb_assert(channel && waiting && waiting_threads);
+
+    // get the running coroutine, we are running on the plain thread if be original coroutine
+    tb_coroutine_t* running = (tb_coroutine_t*)tb_coroutine_self();
+    if (running && !tb_coroutine_is_original(running))
+    {
+        /* the remote coroutines are resumed in the io loop of its scheduler
+         *
+         * we cannot block this worker thread, because the peer may be run on the same scheduler.
+         */
+        if (!tb_co_scheduler_need_remote((tb_co_scheduler_t*)tb_coroutine_scheduler(running)))
+        {
+            tb_trace_e("the shared channel cannot be waited on the scheduler without io!");
+            return tb_false;
+        }
+
+        // save this coroutine to the waiting coroutines, it may be resumed from the other threads
+        tb_single_list_entry_insert_tail(waiting, &running->rs.single_entry);
+
+        /* suspend it
+         *
+         * the remote coroutine will be only resumed in the io loop of the current scheduler after it has been suspended,
+         * so we can leave the lock before suspending it.
+         */
+        tb_spinlock_leave(&channel->lock);
+        tb_coroutine_suspend(tb_null);
+        tb_spinlock_enter(&channel->lock);
+
+        // the scheduler has been stopped? remove it from the waiting coroutines and stop waiting
+        if (((tb_co_scheduler_t*)tb_coroutine_scheduler(running))->stopped)
+        {
+            tb_co_channel_shared_waiting_remove(waiting, &running->rs.single_entry);
+            return tb_false;
+        }
+    }
+    else
+    {
+        // init the waiting thread
+        tb_co_channel_thread_t thread;
+        thread.event = tb_semaphore_init(0);
+        tb_assert_and_check_return_val(thread.event, tb_false);
+
+        // save this thread to the waiting threads and park it until it is waked up by the peer
+        tb_single_list_entry_insert_tail(waiting_threads, &thread.entry);
+        tb_spinlock_leave(&channel->lock);
+        tb_semaphore_wait(thread.event, -1);
+        tb_spinlock_enter(&channel->lock);
+
+        // exit the event
+        tb_semaphore_exit(thread.event);
+    }
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_co_channel_shared_send(tb_co_channel_t* channel, tb_cpointer_t data, tb_bool_t wait)
+{
+    // check
+    tb_assert_and_check_return_val(channel && channel->queue.data, tb_false);
+
+    // enter lock
+    tb_spinlock_enter(&channel->lock);
+
+    // done
+    tb_bool_t       ok = tb_false;
+    tb_coroutine_t* waiting = tb_null;
+    do
+    {
+        // put data into queue if be not full
+        if (channel->queue.size + 1 < channel->queue.maxn)
+        {
+            // trace
+            tb_trace_d("send[%p]: put data(%p)", tb_coroutine_self(), data);
+
+            // put data
+            channel->queue.data[channel->queue.tail] = data;
+            channel->queue.tail = (channel->queue.tail + 1) % channel->queue.maxn;
+            channel->queue.size++;
+
+            /* get the first waiting recv coroutine
+             *
+             * it has been removed from the waiting list, so only the first send will wake it up for a burst of sends
+             */
+            waiting = tb_co_channel_shared_notify(&channel->waiting_recv, &channel->waiting_recv_threads);
+
+            // send ok
+            ok = tb_true;
+            break;
+        }
+
+        // wait it if be full
+        tb_check_break(wait);
+        tb_check_break(tb_co_channel_shared_wait(channel, &channel->waiting_send, &channel->waiting_send_threads));
+
+    } while (1);
+
+    // leave lock
+    tb_spinlock_leave(&channel->lock);
+
+    // notify to recv data
+    if (waiting) tb_co_scheduler_resume_remote((tb_co_scheduler_t*)tb_coroutine_scheduler(waiting), waiting);
+
+    // ok?
+    return ok;
+}
+static tb_bool_t tb_co_channel_shared_recv(tb_co_channel_t* channel, tb_pointer_t* pdata, tb_bool_t wait)
+{
+    // check
+    tb_assert_and_check_return_val(channel && channel->queue.data && pdata, tb_false);
+
+    // enter lock
+    tb_spinlock_enter(&channel->lock);
+
+    // done
+    tb_bool_t       ok = tb_false;
+    tb_coroutine_t* waiting = tb_null;
+    do
+    {
+        // recv data from channel if be not null
+        if (channel->queue.size)
+        {
+            // get data
+            *pdata = (tb_pointer_t)channel->queue.data[channel->queue.head];
+
+            // pop data
+            channel->queue.head = (channel->queue.head + 1) % channel->queue.maxn;
+            channel->queue.size--;
+
+            // trace
+            tb_trace_d("recv[%p]: get data(%p)", tb_coroutine_self(), *pdata);
+
+            // get the first waiting send coroutine
+            waiting = tb_co_channel_shared_notify(&channel->waiting_send, &channel->waiting_send_threads);
+
+            // recv ok
+            ok = tb_true;
+            break;
+        }
+
+        // wait it if be null
+        tb_check_break(wait);
+        tb_check_break(tb_co_channel_shared_wait(channel, &channel->waiting_recv, &channel->waiting_recv_threads));
+
+    } while (1);
+
+    // leave lock
+    tb_spinlock_leave(&channel->lock);
+
+    // notify to send data
+    if (waiting) tb_co_scheduler_resume_remote((tb_co_scheduler_t*)tb_coroutine_scheduler(waiting), waiting);
+
+    // ok?
+    return ok;
+}
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */
 tb_co_channel_ref_t tb_co_channel_init(tb_size_t size, tb_co_channel_free_func_t free, tb_cpointer_t priv)
 {
+    return tb_co_channel_init_with_flags(size, free, priv, TB_CO_CHANNEL_FLAG_NONE);
+}
+tb_co_channel_ref_t tb_co_channel_init_with_flags(tb_size_t size, tb_co_channel_free_func_t free, tb_cpointer_t priv, tb_size_t flags)
+{
+    // the shared channel must have buffer
+    tb_assert_and_check_return_val(size || !(flags & TB_CO_CHANNEL_FLAG_SHARED), tb_null);
+
     // done
     tb_bool_t           ok = tb_false;
     tb_co_channel_t*    channel = tb_null;
@@ -377,10 +622,18 @@ tb_co_channel_ref_t tb_co_channel_init(tb_size_t size, tb_co_channel_free_func_t
         // init waiting recv coroutines
         tb_single_list_entry_init(&channel->waiting_recv, tb_coroutine_t, rs.single_entry, tb_null);
 
+        // init waiting send and recv threads
+        tb_single_list_entry_init(&channel->waiting_send_threads, tb_co_channel_thread_t, entry, tb_null);
+        tb_single_list_entry_init(&channel->waiting_recv_threads, tb_co_channel_thread_t, entry, tb_null);
+
         // init free function and data
         channel->free = free;
         channel->priv = priv;
 
+        // init flags and lock
+        channel->flags = flags;
+        tb_spinlock_init(&channel->lock);
+
         // with buffer?
         if (size)
         {
@@ -439,10 +692,17 @@ tb_void_t tb_co_channel_exit(tb_co_channel_ref_t self)
     // check waiting coroutines
     tb_assert(!tb_single_list_entry_size(&channel->waiting_send));
     tb_assert(!tb_single_list_entry_size(&channel->waiting_recv));
+    tb_assert(!tb_single_list_entry_size(&channel->waiting_send_threads));
+    tb_assert(!tb_single_list_entry_size(&channel->waiting_recv_threads));
 
-    // exit waiting coroutines
+    // exit waiting coroutines and threads
     tb_single_list_entry_exit(&channel->waiting_send);
     tb_single_list_entry_exit(&channel->waiting_recv);
+    tb_single_list_entry_exit(&channel->waiting_send_threads);
+    tb_single_list_entry_exit(&channel->waiting_recv_threads);
+
+    // exit lock
+    tb_spinlock_exit(&channel->lock);
 
     // exit the channel
     tb_free(channel);
@@ -454,7 +714,8 @@ tb_void_t tb_co_channel_send(tb_co_channel_ref_t self, tb_cpointer_t data)
     tb_assert_and_check_return(channel);
 
     // send it
-    if (channel->queue.data) tb_co_channel_send_buffer(channel, data);
+    if (channel->flags & TB_CO_CHANNEL_FLAG_SHARED) tb_co_channel_shared_send(channel, data, tb_true);
+    else if (channel->queue.data) tb_co_channel_send_buffer(channel, data);
     else tb_co_channel_send_buffer0(channel, data);
 }
 tb_pointer_t tb_co_channel_recv(tb_co_channel_ref_t self)
@@ -463,6 +724,14 @@ tb_pointer_t tb_co_channel_recv(tb_co_channel_ref_t self)
     tb_co_channel_t* channel = (tb_co_channel_t*)self;
     tb_assert_and_check_return_val(channel, tb_null);
 
+    // recv it from the shared channel
+    tb_pointer_t data = tb_null;
+    if (channel->flags & TB_CO_CHANNEL_FLAG_SHARED) 
+    {
+        tb_co_channel_shared_recv(channel, &data, tb_true);
+        return data;
+    }
+
     // recv it
     return channel->queue.data? tb_co_channel_recv_buffer(channel) : tb_co_channel_recv_buffer0(channel);
 }
@@ -473,6 +742,7 @@ tb_bool_t tb_co_channel_send_try(tb_co_channel_ref_t self, tb_cpointer_t data)
     tb_assert_and_check_return_val(channel, tb_false);
 
     // try sending it
+    if (channel->flags & TB_CO_CHANNEL_FLAG_SHARED) return tb_co_channel_shared_send(channel, data, tb_false);
     return channel->queue.data? tb_co_channel_send_buffer_try(channel, data) : tb_false;
 }
 tb_bool_t tb_co_channel_recv_try(tb_co_channel_ref_t self, tb_pointer_t* pdata)
@@ -482,6 +752,7 @@ tb_bool_t tb_co_channel_recv_try(tb_co_channel_ref_t self, tb_pointer_t* pdata)
     tb_assert_and_check_return_val(channel && pdata, tb_false);
 
     // try recving it
+    if (channel->flags & TB_CO_CHANNEL_FLAG_SHARED) return tb_co_channel_shared_recv(channel, pdata, tb_false);
     return channel->queue.data? tb_co_channel_recv_buffer_try(channel, pdata) : tb_false;
 }
 
@@ -44,6 +44,27 @@ __tb_extern_c_enter__
 /// the coroutine channel ref type
 typedef __tb_typeref__(co_channel);
 
+/// the coroutine channel flag enum
+typedef enum __tb_co_channel_flag_e
+{
+    TB_CO_CHANNEL_FLAG_NONE         = 0
+
+    /*! the channel can be shared between the different schedulers, workers and threads
+     *
+     * the suspended coroutine will be resumed in the io loop of its scheduler by the remote wakeup,
+     * and a burst of sends only wakes up the poller of the receiver once.
+     *
+     * the plain thread (e.g. the worker of tb_thread_pool) can also send or recv data, 
+     * it will be parked on an event instead of suspending it if the channel is full or null.
+     * the coroutine cannot wait it on the scheduler without io, the send or recv will fail.
+     *
+     * @note the shared channel must have buffer, 
+     *       and the scheduler cannot be run in the exclusive mode if the plain threads access this channel.
+     */
+,   TB_CO_CHANNEL_FLAG_SHARED       = 1
+
+}tb_co_channel_flag_e;
+
 /*! the free function type
  *
  * @param data          the channel data
@@ -65,6 +86,21 @@ typedef tb_void_t       (*tb_co_channel_free_func_t)(tb_pointer_t data, tb_cpoin
  */
 tb_co_channel_ref_t     tb_co_channel_init(tb_size_t size, tb_co_channel_free_func_t free, tb_cpointer_t priv);
 
+/*! init channel with the given flags
+ *
+ * @code
+ * tb_co_channel_ref_t channel = tb_co_channel_init_with_flags(64, tb_null, tb_null, TB_CO_CHANNEL_FLAG_SHARED);
+ * @endcode
+ *
+ * @param size          the buffer size, 0: no buffer
+ * @param free          the free function
+ * @param priv          the user private data
+ * @param flags         the channel flags, e.g. TB_CO_CHANNEL_FLAG_SHARED
+ *
+ * @return              the channel 
+ */
+tb_co_channel_ref_t     tb_co_channel_init_with_flags(tb_size_t size, tb_co_channel_free_func_t free, tb_cpointer_t priv, tb_size_t flags);
+
 /*! exit channel
  *
  * @param channel       the channel
@@ -48,6 +48,18 @@ tb_bool_t tb_coroutine_start(tb_co_scheduler_ref_t scheduler, tb_coroutine_func_
     // start it
     return tb_co_scheduler_start((tb_co_scheduler_t*)scheduler, func, priv, stacksize);
 }
+tb_bool_t tb_coroutine_start_local(tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize)
+{
+    // check
+    tb_assert_and_check_return_val(func, tb_false);
+
+    // get current scheduler
+    tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_co_scheduler_self();
+    tb_assert_and_check_return_val(scheduler, tb_false);
+
+    // start it on the current worker
+    return tb_co_scheduler_start_pinned(scheduler, func, priv, stacksize);
+}
 tb_bool_t tb_coroutine_yield()
 {
     // get current scheduler
@@ -88,6 +100,140 @@ tb_long_t tb_coroutine_waitio(tb_socket_ref_t sock, tb_size_t events, tb_long_t
     // wait events
     return scheduler? tb_co_scheduler_wait(scheduler, sock, events, timeout) : -1;
 }
+tb_long_t tb_coroutine_recv(tb_socket_ref_t sock, tb_byte_t* data, tb_size_t size, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(sock && data && size, -1);
+
+    // get current scheduler
+    tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_co_scheduler_self();
+    tb_assert_and_check_return_val(scheduler, -1);
+
+    // recv it directly with the completion-style io
+    tb_poller_ioop_t ioop;
+    ioop.code   = TB_POLLER_IOCODE_RECV;
+    ioop.sock   = sock;
+    ioop.data   = data;
+    ioop.size   = size;
+    tb_long_t ok = tb_co_scheduler_post(scheduler, &ioop, timeout);
+    if (ok >= 0) return ok? (ioop.result > 0? ioop.result : -1) : 0;
+
+    // recv it after waiting events
+    tb_long_t wait = 0;
+    while (1)
+    {
+        // recv it
+        tb_long_t real = tb_socket_recv(sock, data, size);
+        if (real) return real > 0? real : -1;
+
+        // no data after waiting? it has been closed
+        tb_check_return_val(!wait, -1);
+
+        // wait it
+        wait = tb_co_scheduler_wait(scheduler, sock, TB_SOCKET_EVENT_RECV, timeout);
+        tb_check_return_val(wait > 0, wait);
+    }
+    return -1;
+}
+tb_long_t tb_coroutine_send(tb_socket_ref_t sock, tb_byte_t const* data, tb_size_t size, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(sock && data && size, -1);
+
+    // get current scheduler
+    tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_co_scheduler_self();
+    tb_assert_and_check_return_val(scheduler, -1);
+
+    // send it directly with the completion-style io
+    tb_poller_ioop_t ioop;
+    ioop.code   = TB_POLLER_IOCODE_SEND;
+    ioop.sock   = sock;
+    ioop.data   = (tb_byte_t*)data;
+    ioop.size   = size;
+    tb_long_t ok = tb_co_scheduler_post(scheduler, &ioop, timeout);
+    if (ok >= 0) return ok? (ioop.result > 0? ioop.result : -1) : 0;
+
+    // send it after waiting events
+    tb_long_t wait = 0;
+    while (1)
+    {
+        // send it
+        tb_long_t real = tb_socket_send(sock, data, size);
+        if (real) return real > 0? real : -1;
+
+        // no data after waiting? it has been closed
+        tb_check_return_val(!wait, -1);
+
+        // wait it
+        wait = tb_co_scheduler_wait(scheduler, sock, TB_SOCKET_EVENT_SEND, timeout);
+        tb_check_return_val(wait > 0, wait);
+    }
+    return -1;
+}
+tb_socket_ref_t tb_coroutine_accept(tb_socket_ref_t sock, tb_ipaddr_ref_t addr, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(sock, tb_null);
+
+    // get current scheduler
+    tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_co_scheduler_self();
+    tb_assert_and_check_return_val(scheduler, tb_null);
+
+    // accept it directly with the completion-style io
+    tb_poller_ioop_t ioop;
+    ioop.code   = TB_POLLER_IOCODE_ACPT;
+    ioop.sock   = sock;
+    tb_long_t ok = tb_co_scheduler_post(scheduler, &ioop, timeout);
+    if (ok >= 0)
+    {
+        // failed or timeout?
+        tb_check_return_val(ok > 0 && ioop.result > 0, tb_null);
+
+        // save address
+        if (addr) tb_ipaddr_copy(addr, &ioop.addr);
+        return ioop.client;
+    }
+
+    // accept it after waiting events
+    while (1)
+    {
+        // accept it
+        tb_socket_ref_t client = tb_socket_accept(sock, addr);
+        tb_check_return_val(!client, client);
+
+        // wait it
+        tb_check_return_val(tb_co_scheduler_wait(scheduler, sock, TB_SOCKET_EVENT_ACPT, timeout) > 0, tb_null);
+    }
+    return tb_null;
+}
+tb_long_t tb_coroutine_connect(tb_socket_ref_t sock, tb_ipaddr_ref_t addr, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(sock && addr, -1);
+
+    // get current scheduler
+    tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_co_scheduler_self();
+    tb_assert_and_check_return_val(scheduler, -1);
+
+    // connect it directly with the completion-style io
+    tb_poller_ioop_t ioop;
+    ioop.code   = TB_POLLER_IOCODE_CONN;
+    ioop.sock   = sock;
+    tb_ipaddr_copy(&ioop.addr, addr);
+    tb_long_t ok = tb_co_scheduler_post(scheduler, &ioop, timeout);
+    if (ok >= 0) return ok? (ioop.result > 0? 1 : -1) : 0;
+
+    // connect it
+    ok = tb_socket_connect(sock, addr);
+    tb_check_return_val(!ok, ok);
+
+    // wait it
+    tb_long_t wait = tb_co_scheduler_wait(scheduler, sock, TB_SOCKET_EVENT_CONN, timeout);
+    tb_check_return_val(wait > 0, wait);
+
+    // connect it again
+    return tb_socket_connect(sock, addr) > 0? 1 : -1;
+}
 tb_coroutine_ref_t tb_coroutine_self()
 {
     // get coroutine
@@ -96,4 +242,12 @@ tb_coroutine_ref_t tb_coroutine_self()
     // get running coroutine
     return scheduler? (tb_coroutine_ref_t)tb_co_scheduler_running(scheduler) : tb_null;
 }
+tb_bool_t tb_coroutine_stack_stat(tb_coroutine_stack_stat_t* stat)
+{
+    // check
+    tb_assert_and_check_return_val(stat, tb_false);
 
+    // get the statistics of the stack pool
+    tb_co_stack_pool_ref_t pool = tb_co_stack_pool();
+    return pool? tb_co_stack_pool_stat(pool, stat) : tb_false;
+}
@@ -34,6 +34,7 @@
 #include "semaphore.h"
 #include "scheduler.h"
 #include "stackless/stackless.h"
+#include "../network/ipaddr.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
@@ -50,6 +51,26 @@ typedef __tb_typeref__(coroutine);
 /// the coroutine function type
 typedef tb_void_t       (*tb_coroutine_func_t)(tb_cpointer_t priv);
 
+/// the coroutine stack statistics type
+typedef struct __tb_coroutine_stack_stat_t
+{
+    /// the reserved bytes of all stacks (address space), the guard pages and cached stacks are included
+    tb_size_t           reserved;
+
+    /// the resident bytes of all stacks (physical memory)
+    tb_size_t           resident;
+
+    /// the count of the used stacks
+    tb_size_t           used_count;
+
+    /// the count of the cached stacks
+    tb_size_t           cached_count;
+
+    /// the count of the stacks without the guard page, they are allocated from the native memory if the virtual memory is not supported or exhausted (.e.g vm.max_map_count)
+    tb_size_t           native_count;
+
+}tb_coroutine_stack_stat_t;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
@@ -65,6 +86,19 @@ typedef tb_void_t       (*tb_coroutine_func_t)(tb_cpointer_t priv);
  */
 tb_bool_t               tb_coroutine_start(tb_co_scheduler_ref_t scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize);
 
+/*! start coroutine on the current worker
+ *
+ * the new coroutine will be always run on the worker of the current coroutine and never be stolen by the other workers,
+ * so the lock, semaphore and channel without the shared flag can be used between them.
+ *
+ * @param func          the coroutine function
+ * @param priv          the passed user private data as the argument of function
+ * @param stacksize     the stack size
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_coroutine_start_local(tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize);
+
 /*! yield the current coroutine
  * 
  * @return              tb_true(yield ok) or tb_false(yield failed, no more coroutines)
@@ -106,12 +140,68 @@ tb_pointer_t            tb_coroutine_sleep(tb_long_t interval);
  */
 tb_long_t               tb_coroutine_waitio(tb_socket_ref_t sock, tb_size_t events, tb_long_t timeout);
 
+/*! recv data from the socket
+ *
+ * it will be submitted to the kernel directly if the completion-style io is supported (.e.g io_uring),
+ * otherwise we recv it after waiting the recv events.
+ *
+ * @param sock          the socket
+ * @param data          the data buffer, it must be not placed on the shared stack
+ * @param size          the data size
+ * @param timeout       the timeout, infinity: -1
+ *
+ * @return              > 0: the real size, 0: timeout, -1: failed or closed
+ */
+tb_long_t               tb_coroutine_recv(tb_socket_ref_t sock, tb_byte_t* data, tb_size_t size, tb_long_t timeout);
+
+/*! send data to the socket
+ *
+ * @param sock          the socket
+ * @param data          the data
+ * @param size          the data size
+ * @param timeout       the timeout, infinity: -1
+ *
+ * @return              > 0: the real size, 0: timeout, -1: failed or closed
+ */
+tb_long_t               tb_coroutine_send(tb_socket_ref_t sock, tb_byte_t const* data, tb_size_t size, tb_long_t timeout);
+
+/*! accept a client socket
+ *
+ * @param sock          the listening socket
+ * @param addr          the client address, optional
+ * @param timeout       the timeout, infinity: -1
+ *
+ * @return              the client socket, null: timeout or failed
+ */
+tb_socket_ref_t         tb_coroutine_accept(tb_socket_ref_t sock, tb_ipaddr_ref_t addr, tb_long_t timeout);
+
+/*! connect to the given address
+ *
+ * @param sock          the socket
+ * @param addr          the peer address
+ * @param timeout       the timeout, infinity: -1
+ *
+ * @return              > 0: ok, 0: timeout, -1: failed
+ */
+tb_long_t               tb_coroutine_connect(tb_socket_ref_t sock, tb_ipaddr_ref_t addr, tb_long_t timeout);
+
 /*! get the current coroutine
  *
  * @return              the current coroutine
  */
 tb_coroutine_ref_t      tb_coroutine_self(tb_noarg_t);
 
+/*! get the statistics of all coroutine stacks
+ *
+ * the stacks are reserved with the virtual memory and committed lazily, 
+ * so the resident size is usually much less than the reserved size.
+ *
+ * @param stat          the statistics
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_coroutine_stack_stat(tb_coroutine_stack_stat_t* stat);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
@@ -35,6 +35,8 @@
  */
 #include "coroutine.h"
 #include "scheduler.h"
+#include "stack_pool.h"
+#include "shared_stack.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * macros
@@ -46,22 +48,73 @@
 // the default stack size
 #define TB_COROUTINE_STACK_DEFSIZE          (8192 << 1)
 
+// the coroutine head size at the top of stack
+#define TB_COROUTINE_HEAD_SIZE              tb_align(sizeof(tb_coroutine_t), 16)
+
+// the stack guard size between the stack base and the coroutine head
+#define TB_COROUTINE_GUARD_SIZE             (16)
+
 /* //////////////////////////////////////////////////////////////////////////////////////
- * implementation
+ * private implementation
  */
+static tb_coroutine_t* tb_coroutine_stack_alloc(tb_size_t stacksize)
+{
+    /* alloc stack from the stack pool
+     *
+     * TODO: 
+     *
+     * - segment stack 
+     *
+     *  ------------------------------------------------------------------
+     * | guard page | ... stacksize ... | guard | coroutine | pool stack |
+     *  ------------------------------------------------------------------
+     *              |                  |
+     *         stackdata           stackbase
+     *
+     * the guard page is not accessible and it will trap the stack overflow
+     */
+    tb_size_t size = 0;
+    tb_byte_t* data = tb_co_stack_pool_alloc(tb_co_stack_pool(), stacksize + TB_COROUTINE_GUARD_SIZE + TB_COROUTINE_HEAD_SIZE, &size);
+    tb_assert_and_check_return_val(data && size > TB_COROUTINE_GUARD_SIZE + TB_COROUTINE_HEAD_SIZE, tb_null);
+
+    // make coroutine at the top of stack
+    tb_coroutine_t* coroutine = (tb_coroutine_t*)(data + size - TB_COROUTINE_HEAD_SIZE);
+    tb_memset(coroutine, 0, sizeof(tb_coroutine_t));
+
+    // init stack, the stack size may be larger than the given size after aligning pages
+    coroutine->stackbase = (tb_byte_t*)coroutine - TB_COROUTINE_GUARD_SIZE;
+    coroutine->stacksize = coroutine->stackbase - data;
+
+    // ok
+    return coroutine;
+}
+static tb_void_t tb_coroutine_stack_free(tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert(coroutine && coroutine->stackbase);
+
+    // free stack to the stack pool
+    tb_byte_t* data = coroutine->stackbase - coroutine->stacksize;
+    tb_co_stack_pool_free(tb_co_stack_pool(), data, ((tb_byte_t*)coroutine + TB_COROUTINE_HEAD_SIZE) - data);
+}
 static tb_void_t tb_coroutine_entry(tb_context_from_t from)
 {
-    // get the from-coroutine 
+    // get the current coroutine
+    tb_coroutine_t* coroutine = (tb_coroutine_t*)tb_coroutine_self();
+    tb_assert(coroutine && from.context);
+
+    // get the from-coroutine, it is null if we are switched from the switcher of the shared stacks
     tb_coroutine_t* coroutine_from = (tb_coroutine_t*)from.priv;
-    tb_assert(coroutine_from && from.context);
 
     // update the context
-    coroutine_from->context = from.context;
-    tb_assert(from.context);
-
-    // get the current coroutine
-    tb_coroutine_t* coroutine = (tb_coroutine_t*)tb_coroutine_self();
-    tb_assert(coroutine);
+    if (coroutine_from) coroutine_from->context = from.context;
+    else
+    {
+        // update the switcher context
+        tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_coroutine_scheduler(coroutine);
+        tb_assert(scheduler && scheduler->shared_stacks);
+        scheduler->shared_stacks->switcher = from.context;
+    }
 
 #ifdef __tb_debug__
     // check it
@@ -107,37 +160,38 @@ tb_coroutine_t* tb_coroutine_init(tb_co_scheduler_ref_t scheduler, tb_coroutine_
         stacksize <<= 1;
 #endif
 
-        /* make coroutine
-         *
-         * TODO: 
-         *
-         * - segment stack 
+        /* make coroutine without stack for the shared stacks mode
          *
-         *  -----------------------------------------------
-         * | coroutine | guard | ... stacksize ... | guard |
-         *  -----------------------------------------------
+         * the shared stack will be bound and the context will be made lazily when it is started,
+         * so the stack size will be ignored
          */
-        coroutine = (tb_coroutine_t*)tb_malloc_bytes(sizeof(tb_coroutine_t) + stacksize + sizeof(tb_uint16_t));
-        tb_assert_and_check_break(coroutine);
+        if (((tb_co_scheduler_t*)scheduler)->shared_stacks)
+        {
+            coroutine = tb_malloc0_type(tb_coroutine_t);
+            tb_assert_and_check_break(coroutine);
+
+            // mark it as shared
+            coroutine->shared = tb_true;
+        }
+        // make coroutine with stack
+        else
+        {
+            coroutine = tb_coroutine_stack_alloc(stacksize);
+            tb_assert_and_check_break(coroutine);
+        }
 
         // save scheduler
         coroutine->scheduler = scheduler;
 
-        // init stack
-        coroutine->stackbase = (tb_byte_t*)&(coroutine[1]) + stacksize;
-        coroutine->stacksize = stacksize;
-
         // fill guard
         coroutine->guard = TB_COROUTINE_STACK_GUARD;
-        tb_bits_set_u16_ne(coroutine->stackbase, TB_COROUTINE_STACK_GUARD);
 
         // init function and user private data
         coroutine->rs.func.func = func;
         coroutine->rs.func.priv = priv;
 
         // make context
-        coroutine->context = tb_context_make(coroutine->stackbase - stacksize, stacksize, tb_coroutine_entry);
-        tb_assert_and_check_break(coroutine->context);
+        if (!coroutine->shared && !tb_coroutine_context_make(coroutine)) break;
 
         // ok
         ok = tb_true;
@@ -178,27 +232,40 @@ tb_coroutine_t* tb_coroutine_reinit(tb_coroutine_t* coroutine, tb_coroutine_func
         tb_coroutine_check(coroutine);
 #endif
 
-        // remake coroutine
-        if (stacksize > coroutine->stacksize)
-            coroutine = (tb_coroutine_t*)tb_ralloc_bytes(coroutine, sizeof(tb_coroutine_t) + stacksize + sizeof(tb_uint16_t));
-        else stacksize = coroutine->stacksize;
-        tb_assert_and_check_break(coroutine && coroutine->scheduler);
-
-        // init stack
-        coroutine->stackbase = (tb_byte_t*)&(coroutine[1]) + stacksize;
-        coroutine->stacksize = stacksize;
+        // unbind the shared stack, it will be bound again when it is started
+        if (coroutine->shared)
+        {
+            coroutine->shared_stack     = tb_null;
+            coroutine->stackbase        = tb_null;
+            coroutine->stacksize        = 0;
+            coroutine->stack_saved_size = 0;
+            coroutine->context          = tb_null;
+        }
+        // remake coroutine with the larger stack
+        else if (stacksize > coroutine->stacksize)
+        {
+            // make a new coroutine
+            tb_coroutine_t* coroutine_new = tb_coroutine_stack_alloc(stacksize);
+            tb_assert_and_check_break(coroutine_new);
+
+            // save scheduler
+            coroutine_new->scheduler = coroutine->scheduler;
+
+            // free the old stack
+            tb_coroutine_stack_free(coroutine);
+            coroutine = coroutine_new;
+        }
+        tb_assert_and_check_break(coroutine->scheduler);
 
         // fill guard
         coroutine->guard = TB_COROUTINE_STACK_GUARD;
-        tb_bits_set_u16_ne(coroutine->stackbase, TB_COROUTINE_STACK_GUARD);
 
         // init function and user private data
         coroutine->rs.func.func = func;
         coroutine->rs.func.priv = priv;
 
         // make context
-        coroutine->context = tb_context_make(coroutine->stackbase - stacksize, stacksize, tb_coroutine_entry);
-        tb_assert_and_check_break(coroutine->context);
+        if (!coroutine->shared && !tb_coroutine_context_make(coroutine)) break;
 
         // ok
         ok = tb_true;
@@ -228,13 +295,38 @@ tb_void_t tb_coroutine_exit(tb_coroutine_t* coroutine)
 #endif
 
     // exit it
-    tb_free(coroutine);
+    if (coroutine->shared)
+    {
+        // free the saved stack
+        if (coroutine->stack_saved) tb_free(coroutine->stack_saved);
+        tb_free(coroutine);
+    }
+    else tb_coroutine_stack_free(coroutine);
+}
+tb_bool_t tb_coroutine_context_make(tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert_and_check_return_val(coroutine && coroutine->stackbase && coroutine->stacksize, tb_false);
+
+    // fill the stack guard
+    tb_bits_set_u16_ne(coroutine->stackbase, TB_COROUTINE_STACK_GUARD);
+
+    // make context
+    coroutine->context = tb_context_make(coroutine->stackbase - coroutine->stacksize, coroutine->stacksize, tb_coroutine_entry);
+    tb_assert_and_check_return_val(coroutine->context, tb_false);
+
+    // ok
+    return tb_true;
 }
 #ifdef __tb_debug__
 tb_void_t tb_coroutine_check(tb_coroutine_t* coroutine)
 {
     // check
-    tb_assert(coroutine && coroutine->context);
+    tb_assert(coroutine);
+
+    // this shared coroutine has been not started? 
+    tb_check_return(!coroutine->shared || coroutine->context);
+    tb_assert(coroutine->context);
 
     // this coroutine is original for scheduler?
     tb_check_return(!tb_coroutine_is_original(coroutine));
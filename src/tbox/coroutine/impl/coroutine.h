@@ -50,6 +50,9 @@ __tb_extern_c_enter__
  * types
  */
 
+// the shared stack type
+struct __tb_co_shared_stack_t;
+
 // the coroutine function type
 typedef struct __tb_coroutine_rs_func_t
 {
@@ -64,11 +67,7 @@ typedef struct __tb_coroutine_rs_func_t
 // the coroutine wait type
 typedef struct __tb_coroutine_rs_wait_t
 {
-    /* the timer task pointer for ltimer or timer
-     *
-     * for ltimer:  task
-     * for timer:   task & 0x1
-     */
+    // the timer task
     tb_cpointer_t                   task;
 
     // the socket
@@ -83,6 +82,9 @@ typedef struct __tb_coroutine_rs_wait_t
     // is waiting?
     tb_uint16_t                     waiting         : 1;
 
+    // the posted io operation has been canceled for timeout?
+    tb_uint16_t                     canceled        : 1;
+
 }tb_coroutine_rs_wait_t;
 
 // the coroutine type
@@ -126,6 +128,21 @@ typedef struct __tb_coroutine_t
 
     }                               rs;
 
+    // is running on the shared stacks? (copy-on-switch)
+    tb_bool_t                       shared;
+
+    // the bound shared stack, it is null if this coroutine has been not started
+    struct __tb_co_shared_stack_t*  shared_stack;
+
+    // the saved stack data for the shared stack 
+    tb_byte_t*                      stack_saved;
+
+    // the saved stack size
+    tb_size_t                       stack_saved_size;
+
+    // the saved stack buffer size
+    tb_size_t                       stack_saved_maxn;
+
     // the guard
     tb_uint16_t                     guard;
 
@@ -157,6 +174,14 @@ tb_coroutine_t*         tb_coroutine_init(tb_co_scheduler_ref_t scheduler, tb_co
  */
 tb_coroutine_t*         tb_coroutine_reinit(tb_coroutine_t* coroutine, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize);
 
+/* make the context of the given coroutine and fill the stack guard
+ *
+ * @param coroutine     the coroutine
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_coroutine_context_make(tb_coroutine_t* coroutine);
+
 /* exit coroutine
  *
  * @param coroutine     the coroutine
@@ -31,7 +31,10 @@
 #include "prefix.h"
 #include "coroutine.h"
 #include "scheduler.h"
+#include "stack_pool.h"
+#include "shared_stack.h"
 #include "scheduler_io.h"
+#include "scheduler_group.h"
 #include "stackless/stackless.h"
 
 #endif
@@ -36,6 +36,8 @@
 #include "scheduler.h"
 #include "coroutine.h"
 #include "scheduler_io.h"
+#include "scheduler_group.h"
+#include "shared_stack.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * macros
@@ -125,26 +127,15 @@ static __tb_inline__ tb_coroutine_t* tb_co_scheduler_next_ready(tb_co_scheduler_
     return (tb_coroutine_t*)tb_list_entry0(entry_next);
 }
 
-/* //////////////////////////////////////////////////////////////////////////////////////
- * implementation
- */
-tb_bool_t tb_co_scheduler_start(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize)
+static tb_coroutine_t* tb_co_scheduler_make(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize)
 {
     // check
-    tb_assert(func);
+    tb_assert(scheduler && func);
 
     // done
-    tb_bool_t       ok = tb_false;
     tb_coroutine_t* coroutine = tb_null;
     do
     {
-        // trace
-        tb_trace_d("start ..");
-
-        // uses the current scheduler if be null
-        if (!scheduler) scheduler = (tb_co_scheduler_t*)tb_co_scheduler_self();
-        tb_assert_and_check_break(scheduler);
-
         // have been stopped? do not continue to start new coroutines
         tb_check_break(!scheduler->stopped);
 
@@ -172,9 +163,6 @@ tb_bool_t tb_co_scheduler_start(tb_co_scheduler_t* scheduler, tb_coroutine_func_
         if (!coroutine) coroutine = tb_coroutine_init((tb_co_scheduler_ref_t)scheduler, func, priv, stacksize);
         tb_assert_and_check_break(coroutine);
 
-        // ready coroutine
-        tb_co_scheduler_make_ready(scheduler, coroutine);
-
         // the dead coroutines is too much? free some coroutines
         while (tb_list_entry_size(&scheduler->coroutines_dead) > TB_SCHEDULER_DEAD_CACHE_MAXN)
         {
@@ -189,6 +177,57 @@ tb_bool_t tb_co_scheduler_start(tb_co_scheduler_t* scheduler, tb_coroutine_func_
             tb_coroutine_exit((tb_coroutine_t*)tb_list_entry0(entry));
         }
 
+    } while (0);
+
+    // ok?
+    return coroutine;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_bool_t tb_co_scheduler_start(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize)
+{
+    // check
+    tb_assert(func);
+
+    // done
+    tb_bool_t       ok = tb_false;
+    tb_coroutine_t* coroutine = tb_null;
+    do
+    {
+        // trace
+        tb_trace_d("start ..");
+
+        // get the current scheduler
+        tb_co_scheduler_t* scheduler_self = (tb_co_scheduler_t*)tb_co_scheduler_self();
+
+        // uses the current scheduler if be null
+        if (!scheduler) scheduler = scheduler_self;
+        tb_assert_and_check_break(scheduler);
+
+        // uses the current worker directly if we are running on the same worker group
+        if (scheduler->group && scheduler_self && scheduler_self->group == scheduler->group)
+            scheduler = scheduler_self;
+
+        // single-threaded scheduler? start it directly
+        if (!scheduler->group) 
+        {
+            ok = tb_co_scheduler_start_local(scheduler, func, priv, stacksize);
+            break;
+        }
+
+        /* make coroutine
+         *
+         * we cannot access the dead coroutines of this worker on the other threads
+         */
+        if (scheduler == scheduler_self) coroutine = tb_co_scheduler_make(scheduler, func, priv, stacksize);
+        else if (!scheduler->stopped) coroutine = tb_coroutine_init((tb_co_scheduler_ref_t)scheduler, func, priv, stacksize);
+        tb_check_break(coroutine);
+
+        // post it to the pending coroutines of this worker, it may be stolen by the other idle workers
+        tb_co_scheduler_group_post(scheduler->group, scheduler, coroutine);
+
         // ok
         ok = tb_true;
 
@@ -200,6 +239,49 @@ tb_bool_t tb_co_scheduler_start(tb_co_scheduler_t* scheduler, tb_coroutine_func_
     // ok?
     return ok;
 }
+tb_bool_t tb_co_scheduler_start_local(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize)
+{
+    // check
+    tb_assert(scheduler && func);
+
+    // make coroutine
+    tb_coroutine_t* coroutine = tb_co_scheduler_make(scheduler, func, priv, stacksize);
+    tb_check_return_val(coroutine, tb_false);
+
+    // ready coroutine
+    tb_co_scheduler_make_ready(scheduler, coroutine);
+
+    // ok
+    return tb_true;
+}
+tb_bool_t tb_co_scheduler_start_pinned(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize)
+{
+    // check
+    tb_assert(scheduler && func);
+
+    // have been stopped?
+    tb_check_return_val(!scheduler->stopped, tb_false);
+
+    // start it on this worker directly
+    tb_check_return_val(tb_co_scheduler_start_local(scheduler, func, priv, stacksize), tb_false);
+
+    // it is alive now for the worker group
+    if (scheduler->group) tb_co_scheduler_group_live(scheduler->group);
+
+    // ok
+    return tb_true;
+}
+tb_void_t tb_co_scheduler_ready(tb_co_scheduler_t* scheduler, tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert(scheduler && coroutine);
+
+    // bind this coroutine to the given scheduler
+    coroutine->scheduler = (tb_co_scheduler_ref_t)scheduler;
+
+    // make it as ready
+    tb_co_scheduler_make_ready(scheduler, coroutine);
+}
 tb_bool_t tb_co_scheduler_yield(tb_co_scheduler_t* scheduler)
 {
     // check
@@ -255,6 +337,30 @@ tb_pointer_t tb_co_scheduler_resume(tb_co_scheduler_t* scheduler, tb_coroutine_t
     // return it
     return retval;
 }
+tb_void_t tb_co_scheduler_resume_remote(tb_co_scheduler_t* scheduler, tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert(scheduler && coroutine);
+
+    // running on the same scheduler? resume it directly
+    if (scheduler == (tb_co_scheduler_t*)tb_co_scheduler_self())
+    {
+        tb_co_scheduler_resume(scheduler, coroutine, tb_null);
+        return ;
+    }
+
+    // resume it in the io loop of this scheduler
+    tb_assert(scheduler->scheduler_io);
+    tb_co_scheduler_io_resume_remote(scheduler->scheduler_io, coroutine);
+}
+tb_bool_t tb_co_scheduler_need_remote(tb_co_scheduler_t* scheduler)
+{
+    // check
+    tb_assert(scheduler);
+
+    // the remote coroutines are resumed in the io loop
+    return tb_co_scheduler_need_io(scheduler);
+}
 tb_pointer_t tb_co_scheduler_suspend(tb_co_scheduler_t* scheduler, tb_cpointer_t priv)
 {
     // check
@@ -309,6 +415,12 @@ tb_void_t tb_co_scheduler_finish(tb_co_scheduler_t* scheduler)
     // make the running coroutine as dead
     tb_co_scheduler_make_dead(scheduler, scheduler->running);
 
+    // release the shared stack, we need not save this dead stack when switching to the other coroutine
+    if (scheduler->running->shared_stack) scheduler->running->shared_stack->owner = tb_null;
+
+    // notify the worker group, all workers will be stopped if no more alive coroutines
+    if (scheduler->group && !scheduler->stopped) tb_co_scheduler_group_done(scheduler->group);
+
     // switch to next coroutine 
     if (coroutine_next != scheduler->running) tb_co_scheduler_switch(scheduler, coroutine_next);
     // no more coroutine?
@@ -340,7 +452,7 @@ tb_void_t tb_co_scheduler_switch(tb_co_scheduler_t* scheduler, tb_coroutine_t* c
 {
     // check
     tb_assert(scheduler && scheduler->running);
-    tb_assert(coroutine && coroutine->context);
+    tb_assert(coroutine && (coroutine->context || coroutine->shared));
 
     // the current running coroutine
     tb_coroutine_t* running = scheduler->running;
@@ -352,19 +464,27 @@ tb_void_t tb_co_scheduler_switch(tb_co_scheduler_t* scheduler, tb_coroutine_t* c
     tb_trace_d("switch to coroutine(%p) from coroutine(%p)", coroutine, running);
 
     // jump to the given coroutine
-    tb_context_from_t from = tb_context_jump(coroutine->context, running);
+    tb_context_from_t from = scheduler->shared_stacks? tb_co_shared_stacks_jump(scheduler->shared_stacks, coroutine, running) : tb_context_jump(coroutine->context, running);
+    tb_assert(from.context);
 
-    // the from-coroutine 
+    // the from-coroutine, it is null if we are switched from the switcher of the shared stacks
     tb_coroutine_t* coroutine_from = (tb_coroutine_t*)from.priv;
-    tb_assert(coroutine_from && from.context);
-
+    if (coroutine_from)
+    {
 #ifdef __tb_debug__
-    // check it
-    tb_coroutine_check(coroutine_from);
+        // check it
+        tb_coroutine_check(coroutine_from);
 #endif
 
-    // update the context
-    coroutine_from->context = from.context;
+        // update the context
+        coroutine_from->context = from.context;
+    }
+    // update the switcher context
+    else 
+    {
+        tb_assert(scheduler->shared_stacks);
+        scheduler->shared_stacks->switcher = from.context;
+    }
 }
 tb_long_t tb_co_scheduler_wait(tb_co_scheduler_t* scheduler, tb_socket_ref_t sock, tb_size_t events, tb_long_t timeout)
 {
@@ -381,3 +501,18 @@ tb_long_t tb_co_scheduler_wait(tb_co_scheduler_t* scheduler, tb_socket_ref_t soc
     // sleep it
     return tb_co_scheduler_io_wait(scheduler->scheduler_io, sock, events, timeout);
 }
+tb_long_t tb_co_scheduler_post(tb_co_scheduler_t* scheduler, tb_poller_ioop_ref_t ioop, tb_long_t timeout)
+{
+    // check
+    tb_assert(scheduler && scheduler->running);
+    tb_assert(scheduler->running == (tb_coroutine_t*)tb_coroutine_self());
+
+    // have been stopped? return it directly
+    tb_check_return_val(!scheduler->stopped, -1);
+
+    // need io scheduler
+    if (!tb_co_scheduler_need_io(scheduler)) return -1;
+
+    // post it
+    return tb_co_scheduler_io_post(scheduler->scheduler_io, ioop, timeout);
+}
@@ -60,6 +60,12 @@ __tb_extern_c_enter__
 // the io scheduler type
 struct __tb_co_scheduler_io_t;
 
+// the worker group type
+struct __tb_co_scheduler_group_t;
+
+// the shared stacks type
+struct __tb_co_shared_stacks_t;
+
 // the scheduler type
 typedef struct __tb_co_scheduler_t
 {   
@@ -92,6 +98,27 @@ typedef struct __tb_co_scheduler_t
     // the suspend coroutines
     tb_list_entry_head_t            coroutines_suspend;
 
+    // the worker group, it is null for the single-threaded scheduler
+    struct __tb_co_scheduler_group_t*   group;
+
+    // the worker index in the group
+    tb_size_t                       worker;
+
+    // is idle? (waiting the poller in the group)
+    tb_atomic_t                     idle;
+
+    // the lock of the pending coroutines
+    tb_spinlock_t                   pending_lock;
+
+    /* the pending coroutines (not started) in the group
+     *
+     * they can be stolen by the other idle workers
+     */
+    tb_list_entry_head_t            coroutines_pending;
+
+    // the shared stacks for the copy-on-switch mode, it is null if each coroutine has its own stack
+    struct __tb_co_shared_stacks_t* shared_stacks;
+
 }tb_co_scheduler_t;
 
 /* //////////////////////////////////////////////////////////////////////////////////////
@@ -109,6 +136,40 @@ typedef struct __tb_co_scheduler_t
  */
 tb_bool_t                   tb_co_scheduler_start(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize);
 
+/* start the coroutine function on the given scheduler directly
+ *
+ * the coroutine will be not posted to the pending coroutines and stolen by the other workers in the group
+ *
+ * @param scheduler         the scheduler
+ * @param func              the coroutine function
+ * @param priv              the passed user private data as the argument of function
+ * @param stacksize         the stack size
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_co_scheduler_start_local(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize);
+
+/* start the coroutine function on the given worker and pin it
+ *
+ * it is same as tb_co_scheduler_start_local() but it will be counted as the alive coroutine of the worker group,
+ * so the lock, semaphore and channel without the shared flag can be used between it and the current coroutine.
+ *
+ * @param scheduler         the scheduler (worker)
+ * @param func              the coroutine function
+ * @param priv              the passed user private data as the argument of function
+ * @param stacksize         the stack size
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_co_scheduler_start_pinned(tb_co_scheduler_t* scheduler, tb_coroutine_func_t func, tb_cpointer_t priv, tb_size_t stacksize);
+
+/* make the given coroutine as ready, it must be not in any coroutine list
+ *
+ * @param scheduler         the scheduler
+ * @param coroutine         the coroutine
+ */
+tb_void_t                   tb_co_scheduler_ready(tb_co_scheduler_t* scheduler, tb_coroutine_t* coroutine);
+
 /* yield the current coroutine
  *
  * @param scheduler         the scheduler
@@ -127,6 +188,27 @@ tb_bool_t                   tb_co_scheduler_yield(tb_co_scheduler_t* scheduler);
  */
 tb_pointer_t                tb_co_scheduler_resume(tb_co_scheduler_t* scheduler, tb_coroutine_t* coroutine, tb_cpointer_t priv);
 
+/*! resume the given suspended coroutine from the other thread
+ *
+ * the coroutine will be resumed in the io loop of its scheduler and the suspend() will return null,
+ * it will be resumed directly if we are running on the same scheduler.
+ *
+ * @param scheduler         the scheduler of the suspended coroutine
+ * @param coroutine         the suspended coroutine
+ */
+tb_void_t                   tb_co_scheduler_resume_remote(tb_co_scheduler_t* scheduler, tb_coroutine_t* coroutine);
+
+/*! need resume the current coroutine from the other threads
+ *
+ * it will init the io loop for resuming the remote coroutines,
+ * so it need be called before saving the current coroutine to the waiting list shared with the other threads.
+ *
+ * @param scheduler         the scheduler
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_co_scheduler_need_remote(tb_co_scheduler_t* scheduler);
+
 /*! suspend the current coroutine
  *
  * @param scheduler         the scheduler
@@ -169,6 +251,16 @@ tb_void_t                   tb_co_scheduler_switch(tb_co_scheduler_t* scheduler,
  */
 tb_long_t                   tb_co_scheduler_wait(tb_co_scheduler_t* scheduler, tb_socket_ref_t sock, tb_size_t events, tb_long_t timeout);
 
+/*! post io operation and wait it to be completed 
+ *
+ * @param scheduler         the scheduler
+ * @param ioop              the io operation
+ * @param timeout           the timeout, infinity: -1
+ *
+ * @return                  > 0: completed, 0: timeout, -1: not supported or failed
+ */
+tb_long_t                   tb_co_scheduler_post(tb_co_scheduler_t* scheduler, tb_poller_ioop_ref_t ioop, tb_long_t timeout);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
@@ -0,0 +1,375 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        scheduler_group.c
+ * @ingroup     coroutine
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "scheduler_group"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "scheduler_group.h"
+#include "scheduler_io.h"
+#include "coroutine.h"
+#include "shared_stack.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the maximum count of the pulled or stolen coroutines at once
+#ifdef __tb_small__
+#   define TB_SCHEDULER_GROUP_PULL_MAXN     (16)
+#else
+#   define TB_SCHEDULER_GROUP_PULL_MAXN     (64)
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_size_t tb_co_scheduler_group_take(tb_co_scheduler_t* scheduler, tb_co_scheduler_t* victim)
+{
+    // check
+    tb_assert(scheduler && victim);
+
+    // no pending coroutines? 
+    tb_check_return_val(tb_list_entry_size(&victim->coroutines_pending), 0);
+
+    // enter lock, do not wait the busy victim
+    if (victim == scheduler) tb_spinlock_enter(&victim->pending_lock);
+    else if (!tb_spinlock_enter_try(&victim->pending_lock)) return 0;
+
+    /* compute the taken count
+     *
+     * we pull them from the head of the pending coroutines for the current worker (fifo)
+     * and steal the half of them from the tail for the other workers
+     */
+    tb_size_t count = tb_list_entry_size(&victim->coroutines_pending);
+    if (victim != scheduler) count = (count + 1) >> 1;
+    if (count > TB_SCHEDULER_GROUP_PULL_MAXN) count = TB_SCHEDULER_GROUP_PULL_MAXN;
+
+    // take them
+    tb_size_t i = 0;
+    for (i = 0; i < count; i++)
+    {
+        // get the pending coroutine
+        tb_list_entry_ref_t entry = victim == scheduler? tb_list_entry_head(&victim->coroutines_pending) : tb_list_entry_last(&victim->coroutines_pending);
+        tb_assert(entry);
+
+        // remove it from the pending coroutines
+        tb_list_entry_remove(&victim->coroutines_pending, entry);
+
+        // make it as ready on the current worker
+        tb_co_scheduler_ready(scheduler, (tb_coroutine_t*)tb_list_entry0(entry));
+    }
+
+    // leave lock
+    tb_spinlock_leave(&victim->pending_lock);
+
+    // trace
+    tb_trace_d("worker[%lu]: %s %lu coroutines from worker[%lu]", scheduler->worker, victim == scheduler? "pull" : "steal", count, victim->worker);
+
+    // ok
+    return count;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_co_scheduler_group_ref_t tb_co_scheduler_group_init(tb_co_scheduler_t* scheduler, tb_size_t count)
+{
+    // check
+    tb_assert_and_check_return_val(scheduler && !scheduler->group && count > 1, tb_null);
+
+    // done
+    tb_bool_t                   ok = tb_false;
+    tb_co_scheduler_group_ref_t group = tb_null;
+    do
+    {
+        // make group
+        group = tb_malloc0_type(tb_co_scheduler_group_t);
+        tb_assert_and_check_break(group);
+
+        // make workers
+        group->workers = tb_nalloc0_type(count, tb_co_scheduler_t*);
+        tb_assert_and_check_break(group->workers);
+
+        // make threads
+        group->threads = tb_nalloc0_type(count, tb_thread_ref_t);
+        tb_assert_and_check_break(group->threads);
+
+        // init the first worker
+        group->workers[0]       = scheduler;
+        group->workers_count    = count;
+        scheduler->group        = group;
+        scheduler->worker       = 0;
+
+        // init the other workers
+        tb_size_t i = 1;
+        for (i = 1; i < count; i++)
+        {
+            // init worker
+            tb_co_scheduler_t* worker = (tb_co_scheduler_t*)tb_co_scheduler_init();
+            tb_assert_and_check_break(worker);
+
+            // bind it to this group
+            worker->group   = group;
+            worker->worker  = i;
+
+            // init the shared stacks if the first worker uses them
+            if (scheduler->shared_stacks)
+            {
+                worker->shared_stacks = tb_co_shared_stacks_init();
+                tb_assert_and_check_break(worker->shared_stacks);
+            }
+
+            // save it
+            group->workers[i] = worker;
+        }
+        tb_check_break(i == count);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (group) tb_co_scheduler_group_exit(group);
+        group = tb_null;
+    }
+
+    // ok?
+    return group;
+}
+tb_void_t tb_co_scheduler_group_exit(tb_co_scheduler_group_ref_t group)
+{
+    // check
+    tb_assert_and_check_return(group);
+
+    // exit workers
+    if (group->workers)
+    {
+        tb_size_t i = 1;
+        for (i = 1; i < group->workers_count; i++)
+        {
+            // exit the worker
+            tb_co_scheduler_t* worker = group->workers[i];
+            if (worker) 
+            {
+                worker->group   = tb_null;
+                worker->stopped = tb_true;
+                tb_co_scheduler_exit((tb_co_scheduler_ref_t)worker);
+            }
+            group->workers[i] = tb_null;
+        }
+
+        // unbind the first worker
+        if (group->workers[0]) group->workers[0]->group = tb_null;
+
+        // free workers
+        tb_free(group->workers);
+        group->workers = tb_null;
+    }
+
+    // free threads, they have been exited after loop
+    if (group->threads) tb_free(group->threads);
+    group->threads = tb_null;
+
+    // exit it
+    tb_free(group);
+}
+tb_void_t tb_co_scheduler_group_kill(tb_co_scheduler_group_ref_t group)
+{
+    // check
+    tb_assert_and_check_return(group && group->workers);
+
+    // trace
+    tb_trace_d("kill: ..");
+
+    // kill all workers
+    tb_size_t i = 0;
+    for (i = 0; i < group->workers_count; i++)
+    {
+        // stop it
+        tb_co_scheduler_t* worker = group->workers[i];
+        worker->stopped = tb_true;
+
+        // kill the io scheduler and break the poller
+        if (worker->scheduler_io) tb_co_scheduler_io_kill(worker->scheduler_io);
+    }
+}
+tb_void_t tb_co_scheduler_group_loop(tb_co_scheduler_group_ref_t group, tb_thread_func_t func)
+{
+    // check
+    tb_assert_and_check_return(group && group->workers && group->threads && func);
+
+    // no coroutines? 
+    tb_check_return(tb_atomic_get(&group->alive));
+
+    // init io scheduler for all workers first, each worker keeps its own poller
+    tb_size_t i = 0;
+    for (i = 0; i < group->workers_count; i++)
+    {
+        tb_co_scheduler_t* worker = group->workers[i];
+        if (!worker->scheduler_io) worker->scheduler_io = tb_co_scheduler_io_init(worker);
+        tb_assert_and_check_break(worker->scheduler_io);
+    }
+
+    // failed? stop all workers
+    if (i != group->workers_count) 
+    {
+        tb_co_scheduler_group_kill(group);
+        return ;
+    }
+
+    // run the other workers on their own threads
+    for (i = 1; i < group->workers_count; i++)
+    {
+        group->threads[i] = tb_thread_init(__tb_lstring__("co_worker"), func, group->workers[i], 0);
+        tb_assert(group->threads[i]);
+    }
+
+    // run the first worker on the current thread
+    func(group->workers[0]);
+
+    // wait the other workers
+    for (i = 1; i < group->workers_count; i++)
+    {
+        if (group->threads[i])
+        {
+            tb_thread_wait(group->threads[i], -1, tb_null);
+            tb_thread_exit(group->threads[i]);
+        }
+        group->threads[i] = tb_null;
+    }
+}
+tb_void_t tb_co_scheduler_group_post(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler, tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert(group && scheduler && coroutine);
+
+    // it is alive now, we need increase it before it may be finished on the other workers
+    tb_atomic_fetch_and_inc(&group->alive);
+
+    // post it to the pending coroutines
+    tb_spinlock_enter(&scheduler->pending_lock);
+    tb_list_entry_insert_tail(&scheduler->coroutines_pending, (tb_list_entry_ref_t)coroutine);
+    tb_spinlock_leave(&scheduler->pending_lock);
+
+    // no idle workers?
+    tb_check_return(tb_atomic_get(&group->idle));
+
+    // wake up an idle worker to steal it
+    tb_size_t i = 0;
+    tb_size_t n = group->workers_count;
+    for (i = 0; i < n; i++)
+    {
+        tb_co_scheduler_t* worker = group->workers[(scheduler->worker + i) % n];
+        if (tb_atomic_fetch_and_pset(&worker->idle, 1, 0) == 1)
+        {
+            // update the idle workers count
+            tb_atomic_fetch_and_dec(&group->idle);
+
+            // trace
+            tb_trace_d("worker[%lu]: wake up worker[%lu]", scheduler->worker, worker->worker);
+
+            // break the poller of this worker
+            if (worker->scheduler_io && worker->scheduler_io->poller) tb_poller_spak(worker->scheduler_io->poller);
+            break;
+        }
+    }
+}
+tb_size_t tb_co_scheduler_group_pull(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler)
+{
+    // check
+    tb_assert(group && scheduler);
+
+    // have been stopped? 
+    tb_check_return_val(!scheduler->stopped, 0);
+
+    // pull the pending coroutines of the current worker first
+    tb_size_t count = tb_co_scheduler_group_take(scheduler, scheduler);
+    tb_check_return_val(!count, count);
+
+    // steal them from the other workers
+    tb_size_t i = 1;
+    tb_size_t n = group->workers_count;
+    for (i = 1; i < n && !count; i++)
+        count = tb_co_scheduler_group_take(scheduler, group->workers[(scheduler->worker + i) % n]);
+
+    // ok?
+    return count;
+}
+tb_bool_t tb_co_scheduler_group_idle(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler)
+{
+    // check
+    tb_assert(group && scheduler);
+
+    // mark it as idle
+    tb_atomic_set(&scheduler->idle, 1);
+    tb_atomic_fetch_and_inc(&group->idle);
+
+    // pull again, some new coroutines may be posted before marking it as idle
+    if (tb_co_scheduler_group_pull(group, scheduler))
+    {
+        // mark it as busy
+        tb_co_scheduler_group_busy(group, scheduler);
+        return tb_false;
+    }
+
+    // ok
+    return tb_true;
+}
+tb_void_t tb_co_scheduler_group_busy(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler)
+{
+    // check
+    tb_assert(group && scheduler);
+
+    // mark it as busy if it has been not waked up by the other workers
+    if (tb_atomic_fetch_and_pset(&scheduler->idle, 1, 0) == 1)
+        tb_atomic_fetch_and_dec(&group->idle);
+}
+tb_void_t tb_co_scheduler_group_live(tb_co_scheduler_group_ref_t group)
+{
+    // check
+    tb_assert(group);
+
+    // it is alive now and will be notified by tb_co_scheduler_group_done() after it has been finished
+    tb_atomic_fetch_and_inc(&group->alive);
+}
+tb_void_t tb_co_scheduler_group_done(tb_co_scheduler_group_ref_t group)
+{
+    // check
+    tb_assert(group);
+
+    // no more alive coroutines? stop all workers
+    if (!tb_atomic_dec_and_fetch(&group->alive)) tb_co_scheduler_group_kill(group);
+}
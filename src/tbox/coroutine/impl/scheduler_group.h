@@ -0,0 +1,157 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        scheduler_group.h
+ * @ingroup     coroutine
+ *
+ */
+#ifndef TB_COROUTINE_IMPL_SCHEDULER_GROUP_H
+#define TB_COROUTINE_IMPL_SCHEDULER_GROUP_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "scheduler.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/* the worker group type for the multi-threaded scheduler (N:M)
+ *
+ * each worker is a single-threaded scheduler with the ready coroutines and the io scheduler (poller),
+ * the new coroutines are posted to the pending coroutines of the current worker 
+ * and the idle workers will steal them from the busy workers.
+ *
+ *  worker0(thread0): [pending] -> ready -> .. -> io loop(poller) 
+ *     |                   |
+ *     |                 steal 
+ *     |                   |
+ *  worker1(thread1): [pending] -> ready -> .. -> io loop(poller) 
+ *
+ */
+typedef struct __tb_co_scheduler_group_t
+{
+    // the workers, workers[0] is the scheduler of the user and it will be run on the loop thread
+    tb_co_scheduler_t**             workers;
+
+    // the workers count
+    tb_size_t                       workers_count;
+
+    // the worker threads, threads[0] is not used
+    tb_thread_ref_t*                threads;
+
+    // the alive coroutines count (posted and not finished)
+    tb_atomic_t                     alive;
+
+    // the idle workers count
+    tb_atomic_t                     idle;
+
+}tb_co_scheduler_group_t, *tb_co_scheduler_group_ref_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/* init the worker group
+ *
+ * @param scheduler         the scheduler of the user, it will be the first worker
+ * @param count             the workers count
+ *
+ * @return                  the worker group
+ */
+tb_co_scheduler_group_ref_t tb_co_scheduler_group_init(tb_co_scheduler_t* scheduler, tb_size_t count);
+
+/* exit the worker group and all workers exclude the first worker
+ *
+ * @param group             the worker group
+ */
+tb_void_t                   tb_co_scheduler_group_exit(tb_co_scheduler_group_ref_t group);
+
+/* kill all workers
+ *
+ * @param group             the worker group
+ */
+tb_void_t                   tb_co_scheduler_group_kill(tb_co_scheduler_group_ref_t group);
+
+/* run all workers and wait them
+ *
+ * @param group             the worker group
+ * @param func              the loop function of the worker
+ */
+tb_void_t                   tb_co_scheduler_group_loop(tb_co_scheduler_group_ref_t group, tb_thread_func_t func);
+
+/* post the new coroutine to the pending coroutines of the given worker 
+ *
+ * @param group             the worker group
+ * @param scheduler         the worker
+ * @param coroutine         the coroutine
+ */
+tb_void_t                   tb_co_scheduler_group_post(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler, tb_coroutine_t* coroutine);
+
+/* pull the pending coroutines of the given worker or steal them from the other workers
+ *
+ * @param group             the worker group
+ * @param scheduler         the current worker
+ *
+ * @return                  the pulled coroutines count
+ */
+tb_size_t                   tb_co_scheduler_group_pull(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler);
+
+/* mark the given worker as idle before waiting the poller
+ *
+ * @param group             the worker group
+ * @param scheduler         the current worker
+ *
+ * @return                  tb_true: idle now, tb_false: some new coroutines have been pulled
+ */
+tb_bool_t                   tb_co_scheduler_group_idle(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler);
+
+/* mark the given worker as busy after waiting the poller
+ *
+ * @param group             the worker group
+ * @param scheduler         the current worker
+ */
+tb_void_t                   tb_co_scheduler_group_busy(tb_co_scheduler_group_ref_t group, tb_co_scheduler_t* scheduler);
+
+/* notify that a new coroutine has been started on the given worker directly without posting it
+ *
+ * @param group             the worker group
+ */
+tb_void_t                   tb_co_scheduler_group_live(tb_co_scheduler_group_ref_t group);
+
+/* notify that a posted coroutine has been finished, all workers will be stopped if no more alive coroutines 
+ *
+ * @param group             the worker group
+ */
+tb_void_t                   tb_co_scheduler_group_done(tb_co_scheduler_group_ref_t group);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -34,22 +34,20 @@
  * includes
  */
 #include "scheduler_io.h"
+#include "scheduler_group.h"
 #include "coroutine.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * macros
  */
 
-// the ltimer grow
+// the timer grow
 #ifdef __tb_small__
-#   define TB_SCHEDULER_IO_LTIMER_GROW      (64)
+#   define TB_SCHEDULER_IO_TIMER_GROW       (64)
 #else
-#   define TB_SCHEDULER_IO_LTIMER_GROW      (4096)
+#   define TB_SCHEDULER_IO_TIMER_GROW       (4096)
 #endif
 
-// the timer grow
-#define TB_SCHEDULER_IO_TIMER_GROW          (TB_SCHEDULER_IO_LTIMER_GROW >> 4)
-
 /* //////////////////////////////////////////////////////////////////////////////////////
  * private implementation
  */
@@ -63,15 +61,8 @@ static tb_void_t tb_co_scheduler_io_resume(tb_co_scheduler_t* scheduler, tb_coro
         tb_co_scheduler_io_ref_t scheduler_io = tb_co_scheduler_io(scheduler);
         tb_assert(scheduler_io && scheduler_io->poller);
 
-        // is high-precision timer?
-        tb_size_t is_timer = (tb_size_t)(task) & 0x1;
-
-        // check
-        tb_assert((tb_size_t)task & (tb_size_t)~0x1);
-
         // remove the timer task
-        if (__tb_unlikely__(is_timer)) tb_timer_task_exit(scheduler_io->timer, (tb_timer_task_ref_t)((tb_size_t)task & (tb_size_t)~0x1));
-        else tb_ltimer_task_exit(scheduler_io->ltimer, (tb_ltimer_task_ref_t)task);
+        tb_htimer_task_exit(scheduler_io->timer, (tb_htimer_task_ref_t)task);
         coroutine->rs.wait.task = tb_null;
     }
 
@@ -97,8 +88,50 @@ static tb_void_t tb_co_scheduler_io_timeout(tb_bool_t killed, tb_cpointer_t priv
     // resume the coroutine 
     tb_co_scheduler_io_resume(scheduler, coroutine, tb_null);
 }
+static tb_void_t tb_co_scheduler_io_timeout_post(tb_bool_t killed, tb_cpointer_t priv)
+{
+    // check
+    tb_poller_ioop_ref_t ioop = (tb_poller_ioop_ref_t)priv;
+    tb_assert(ioop && ioop->priv);
+
+    // get coroutine
+    tb_coroutine_t* coroutine = (tb_coroutine_t*)ioop->priv;
+
+    // get io scheduler
+    tb_co_scheduler_io_ref_t scheduler_io = tb_co_scheduler_io((tb_co_scheduler_t*)tb_coroutine_scheduler(coroutine));
+    tb_assert(scheduler_io && scheduler_io->poller);
+
+    // trace
+    tb_trace_d("coroutine(%p): post timer %s", coroutine, killed? "killed" : "timeout");
+
+    /* cancel the io operation and mark it as canceled
+     *
+     * we cannot resume the coroutine directly because the kernel may be still accessing the io operation,
+     * so it will be resumed after the canceled io operation has been completed.
+     */
+    coroutine->rs.wait.canceled = 1;
+    tb_poller_cancel(scheduler_io->poller, ioop);
+}
 static tb_void_t tb_co_scheduler_io_events(tb_poller_ref_t poller, tb_socket_ref_t sock, tb_size_t events, tb_cpointer_t priv)
 {
+    // the io operation has been completed? 
+    if (events & TB_POLLER_EVENT_COMP)
+    {
+        // check
+        tb_poller_ioop_ref_t ioop = (tb_poller_ioop_ref_t)priv;
+        tb_assert(ioop && ioop->priv);
+
+        // get coroutine
+        tb_coroutine_t* coroutine = (tb_coroutine_t*)ioop->priv;
+
+        // trace
+        tb_trace_d("coroutine(%p): socket: %p, ioop(%lu) completed: %ld", coroutine, sock, ioop->code, ioop->result);
+
+        // resume the coroutine and pass the io operation to suspend()
+        tb_co_scheduler_io_resume((tb_co_scheduler_t*)tb_coroutine_scheduler(coroutine), coroutine, ioop);
+        return ;
+    }
+
     // check
     tb_coroutine_t* coroutine = (tb_coroutine_t*)priv;
     tb_assert(coroutine && poller && sock && priv);
@@ -130,25 +163,52 @@ static tb_void_t tb_co_scheduler_io_events(tb_poller_ref_t poller, tb_socket_ref
 static tb_bool_t tb_co_scheduler_io_timer_spak(tb_co_scheduler_io_ref_t scheduler_io)
 {
     // check
-    tb_assert(scheduler_io && scheduler_io->timer && scheduler_io->ltimer);
+    tb_assert(scheduler_io && scheduler_io->timer);
 
     // spak ctime
     tb_cache_time_spak();
 
     // spak timer
-    if (!tb_timer_spak(scheduler_io->timer)) return tb_false;
-
-    // spak ltimer
-    if (!tb_ltimer_spak(scheduler_io->ltimer)) return tb_false;
+    if (!tb_htimer_spak(scheduler_io->timer)) return tb_false;
 
     // pk
     return tb_true;
 }
+static tb_void_t tb_co_scheduler_io_remote_spak(tb_co_scheduler_io_ref_t scheduler_io)
+{
+    // check
+    tb_assert(scheduler_io && scheduler_io->scheduler);
+
+    // no remote coroutines? 
+    tb_check_return(tb_atomic_fetch_and_set(&scheduler_io->remote_spak, 0));
+
+    // resume all remote coroutines
+    tb_spinlock_enter(&scheduler_io->remote_lock);
+    while (tb_single_list_entry_size(&scheduler_io->remote_coroutines))
+    {
+        // get the next entry from head
+        tb_single_list_entry_ref_t entry = tb_single_list_entry_head(&scheduler_io->remote_coroutines);
+        tb_assert(entry);
+
+        // remove it from the remote coroutines
+        tb_single_list_entry_remove_head(&scheduler_io->remote_coroutines);
+
+        // get the remote coroutine
+        tb_coroutine_t* coroutine = (tb_coroutine_t*)tb_single_list_entry(&scheduler_io->remote_coroutines, entry);
+
+        // trace
+        tb_trace_d("coroutine(%p): resumed from the other thread", coroutine);
+
+        // resume this coroutine
+        tb_co_scheduler_resume(scheduler_io->scheduler, coroutine, tb_null);
+    }
+    tb_spinlock_leave(&scheduler_io->remote_lock);
+}
 static tb_void_t tb_co_scheduler_io_loop(tb_cpointer_t priv)
 {
     // check
     tb_co_scheduler_io_ref_t scheduler_io = (tb_co_scheduler_io_ref_t)priv;
-    tb_assert_and_check_return(scheduler_io && scheduler_io->timer && scheduler_io->ltimer);
+    tb_assert_and_check_return(scheduler_io && scheduler_io->timer);
 
     // the scheduler
     tb_co_scheduler_t* scheduler = scheduler_io->scheduler;
@@ -158,6 +218,9 @@ static tb_void_t tb_co_scheduler_io_loop(tb_cpointer_t priv)
     tb_poller_ref_t poller = scheduler_io->poller;
     tb_assert_and_check_return(poller);
 
+    // the worker group
+    tb_co_scheduler_group_ref_t group = scheduler->group;
+
     // loop
     while (!scheduler->stopped)
     {
@@ -166,26 +229,58 @@ static tb_void_t tb_co_scheduler_io_loop(tb_cpointer_t priv)
         {
             // spak timer
             if (!tb_co_scheduler_io_timer_spak(scheduler_io)) break;
+
+            // resume the remote coroutines
+            tb_co_scheduler_io_remote_spak(scheduler_io);
         }
 
+        // is worker? pull the pending coroutines or steal them from the other workers
+        if (group)
+        {
+            // have been stopped? 
+            tb_check_break(!scheduler->stopped);
+
+            // continue to run the pulled coroutines
+            if (tb_co_scheduler_group_pull(group, scheduler)) continue;
+        }
         // no more suspended coroutines? loop end
-        tb_check_break(tb_co_scheduler_suspend_count(scheduler));
+        else tb_check_break(tb_co_scheduler_suspend_count(scheduler));
 
         // the delay
-        tb_size_t delay = tb_timer_delay(scheduler_io->timer);
+        tb_size_t delay = tb_htimer_delay(scheduler_io->timer);
 
-        // the ldelay
-        tb_size_t ldelay = tb_ltimer_delay(scheduler_io->ltimer);
+        // mark this worker as idle, it will be waked up if the new coroutines are posted
+        if (group && !tb_co_scheduler_group_idle(group, scheduler)) continue;
 
         // trace
-        tb_trace_d("loop: wait %lu ms ..", tb_min(delay, ldelay));
+        tb_trace_d("loop: wait %lu ms ..", delay);
 
         // no more ready coroutines? wait io events and timers
-        if (tb_poller_wait(poller, tb_co_scheduler_io_events, tb_min(delay, ldelay)) < 0) break;
+        tb_long_t wait = tb_poller_wait_events(poller, scheduler_io->events, tb_arrayn(scheduler_io->events), delay);
+
+        // mark this worker as busy
+        if (group) tb_co_scheduler_group_busy(group, scheduler);
+
+        // failed?
+        if (wait < 0) break;
+
+        // resume the remote coroutines
+        tb_co_scheduler_io_remote_spak(scheduler_io);
+
+        // handle the harvested events in batches
+        tb_long_t i = 0;
+        for (i = 0; i < wait; i++)
+        {
+            tb_poller_event_ref_t event = scheduler_io->events + i;
+            tb_co_scheduler_io_events(poller, event->sock, event->events, event->priv);
+        }
 
         // spak timer
         if (!tb_co_scheduler_io_timer_spak(scheduler_io)) break;
     }
+
+    // stop all workers if the io loop of this worker is broken
+    if (group) tb_co_scheduler_group_kill(group);
 }
 
 /* //////////////////////////////////////////////////////////////////////////////////////
@@ -205,20 +300,26 @@ tb_co_scheduler_io_ref_t tb_co_scheduler_io_init(tb_co_scheduler_t* scheduler)
         // save scheduler
         scheduler_io->scheduler = (tb_co_scheduler_t*)scheduler;
 
+        // init the remote coroutines
+        tb_spinlock_init(&scheduler_io->remote_lock);
+        tb_single_list_entry_init(&scheduler_io->remote_coroutines, tb_coroutine_t, rs.single_entry, tb_null);
+
+        /* spak the cache time first, the timer uses it as the base time
+         *
+         * it may be not spaked yet if the io scheduler is inited on the other workers
+         */
+        tb_cache_time_spak();
+
         // init timer and using cache time
-        scheduler_io->timer = tb_timer_init(TB_SCHEDULER_IO_TIMER_GROW, tb_true);
+        scheduler_io->timer = tb_htimer_init(TB_SCHEDULER_IO_TIMER_GROW, tb_true);
         tb_assert_and_check_break(scheduler_io->timer);
 
-        // init ltimer and using cache time
-        scheduler_io->ltimer = tb_ltimer_init(TB_SCHEDULER_IO_LTIMER_GROW, TB_LTIMER_TICK_S, tb_true);
-        tb_assert_and_check_break(scheduler_io->ltimer);
-
         // init poller
         scheduler_io->poller = tb_poller_init(tb_null);
         tb_assert_and_check_break(scheduler_io->poller);
 
         // start the io loop coroutine
-        if (!tb_co_scheduler_start(scheduler_io->scheduler, tb_co_scheduler_io_loop, scheduler_io, 0)) break;
+        if (!tb_co_scheduler_start_local(scheduler_io->scheduler, tb_co_scheduler_io_loop, scheduler_io, 0)) break;
 
         // ok
         ok = tb_true;
@@ -246,12 +347,12 @@ tb_void_t tb_co_scheduler_io_exit(tb_co_scheduler_io_ref_t scheduler_io)
     scheduler_io->poller = tb_null;
 
     // exit timer
-    if (scheduler_io->timer) tb_timer_exit(scheduler_io->timer);
+    if (scheduler_io->timer) tb_htimer_exit(scheduler_io->timer);
     scheduler_io->timer = tb_null;
 
-    // exit ltimer
-    if (scheduler_io->ltimer) tb_ltimer_exit(scheduler_io->ltimer);
-    scheduler_io->ltimer = tb_null;
+    // exit the remote coroutines
+    tb_single_list_entry_exit(&scheduler_io->remote_coroutines);
+    tb_spinlock_exit(&scheduler_io->remote_lock);
 
     // clear scheduler
     scheduler_io->scheduler = tb_null;
@@ -268,10 +369,7 @@ tb_void_t tb_co_scheduler_io_kill(tb_co_scheduler_io_ref_t scheduler_io)
     tb_trace_d("kill: ..");
 
     // kill timer
-    if (scheduler_io->timer) tb_timer_kill(scheduler_io->timer);
-
-    // kill ltimer
-    if (scheduler_io->ltimer) tb_ltimer_kill(scheduler_io->ltimer);
+    if (scheduler_io->timer) tb_htimer_kill(scheduler_io->timer);
 
     // kill poller
     if (scheduler_io->poller) tb_poller_kill(scheduler_io->poller);
@@ -294,18 +392,8 @@ tb_pointer_t tb_co_scheduler_io_sleep(tb_co_scheduler_io_ref_t scheduler_io, tb_
     // infinity?
     if (interval > 0)
     {
-        // high-precision interval?
-        if (interval % 1000)
-        {
-            // post task to timer
-            tb_timer_task_post(scheduler_io->timer, interval, tb_false, tb_co_scheduler_io_timeout, coroutine);
-        }
-        // low-precision interval?
-        else
-        {
-            // post task to ltimer (faster)
-            tb_ltimer_task_post(scheduler_io->ltimer, interval, tb_false, tb_co_scheduler_io_timeout, coroutine);
-        }
+        // post task to timer
+        tb_htimer_task_post(scheduler_io->timer, interval, tb_false, tb_co_scheduler_io_timeout, coroutine);
     }
 
     // suspend it
@@ -377,34 +465,16 @@ tb_long_t tb_co_scheduler_io_wait(tb_co_scheduler_io_ref_t scheduler_io, tb_sock
     }
 
     // exists timeout?
-    tb_cpointer_t   task = tb_null;
-    tb_bool_t       is_ltimer = tb_false;
+    tb_htimer_task_ref_t task = tb_null;
     if (timeout >= 0)
     {
-        // high-precision interval?
-        if (timeout % 1000)
-        {
-            // init task for timer
-            task = tb_timer_task_init(scheduler_io->timer, timeout, tb_false, tb_co_scheduler_io_timeout, coroutine);
-            tb_assert_and_check_return_val(task, tb_false);
-        }
-        // low-precision interval?
-        else
-        {
-            // init task for ltimer (faster)
-            task = tb_ltimer_task_init(scheduler_io->ltimer, timeout, tb_false, tb_co_scheduler_io_timeout, coroutine);
-            tb_assert_and_check_return_val(task, tb_false);
-
-            // mark as low-precision timer
-            is_ltimer = tb_true;
-        }
+        // init task for timer
+        task = tb_htimer_task_init(scheduler_io->timer, timeout, tb_false, tb_co_scheduler_io_timeout, coroutine);
+        tb_assert_and_check_return_val(task, tb_false);
     }
 
-    // check
-    tb_assert(!((tb_size_t)(task) & 0x1));
-
     // save the timer task to coroutine
-    coroutine->rs.wait.task = (is_ltimer || !task)? task : (tb_cpointer_t)((tb_size_t)(task) | 0x1);
+    coroutine->rs.wait.task = task;
 
     // save the socket to coroutine for the timer function
     coroutine->rs.wait.sock = sock;
@@ -419,6 +489,82 @@ tb_long_t tb_co_scheduler_io_wait(tb_co_scheduler_io_ref_t scheduler_io, tb_sock
     // suspend the current coroutine and return the waited result
     return (tb_long_t)tb_co_scheduler_suspend(scheduler_io->scheduler, tb_null);
 }
+tb_long_t tb_co_scheduler_io_post(tb_co_scheduler_io_ref_t scheduler_io, tb_poller_ioop_ref_t ioop, tb_long_t timeout)
+{
+    // check
+    tb_assert(scheduler_io && ioop && scheduler_io->poller && scheduler_io->scheduler);
+
+    // get the current coroutine
+    tb_coroutine_t* coroutine = tb_co_scheduler_running(scheduler_io->scheduler);
+    tb_assert(coroutine);
+
+    /* not supported? 
+     *
+     * the io operation and data buffer are usually placed on the stack of the coroutine,
+     * but the shared stack will be saved and reused by the other coroutines after suspending it.
+     */
+    tb_check_return_val(!coroutine->shared && tb_poller_support(scheduler_io->poller, TB_POLLER_EVENT_COMP), -1);
+
+    // trace
+    tb_trace_d("coroutine(%p): post ioop(%lu) with %ld ms for socket(%p) ..", coroutine, ioop->code, timeout, ioop->sock);
+
+    // post the io operation
+    ioop->priv = coroutine;
+    if (!tb_poller_post(scheduler_io->poller, ioop)) return -1;
+
+    // exists timeout?
+    tb_htimer_task_ref_t task = tb_null;
+    if (timeout >= 0)
+    {
+        // init task for timer
+        task = tb_htimer_task_init(scheduler_io->timer, timeout, tb_false, tb_co_scheduler_io_timeout_post, ioop);
+        tb_assert(task);
+    }
+
+    // save the timer task to coroutine
+    coroutine->rs.wait.task = task;
+
+    /* clear the canceled state
+     *
+     * we do not mark it as waiting state for io events, 
+     * the events of the inserted socket will be only cached before the io operation is completed.
+     */
+    coroutine->rs.wait.canceled = 0;
+
+    // suspend the current coroutine until the io operation has been completed 
+    tb_pointer_t result = tb_co_scheduler_suspend(scheduler_io->scheduler, tb_null);
+    tb_assert(result == ioop); tb_used(result);
+
+    // timeout?
+    if (coroutine->rs.wait.canceled)
+    {
+        coroutine->rs.wait.canceled = 0;
+        if (ioop->result < 0) return 0;
+    }
+
+    // completed
+    return 1;
+}
+tb_void_t tb_co_scheduler_io_resume_remote(tb_co_scheduler_io_ref_t scheduler_io, tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert(scheduler_io && scheduler_io->poller && coroutine);
+
+    // trace
+    tb_trace_d("coroutine(%p): resume it from the other thread ..", coroutine);
+
+    // post this coroutine to the remote coroutines
+    tb_spinlock_enter(&scheduler_io->remote_lock);
+    tb_single_list_entry_insert_tail(&scheduler_io->remote_coroutines, &coroutine->rs.single_entry);
+    tb_spinlock_leave(&scheduler_io->remote_lock);
+
+    /* wake up the io loop if it has been not waked up
+     *
+     * the flag will be cleared before resuming the remote coroutines in the io loop,
+     * so a burst of the remote resumes will only wake up the poller once.
+     */
+    if (!tb_atomic_fetch_and_set(&scheduler_io->remote_spak, 1)) tb_poller_spak(scheduler_io->poller);
+}
 tb_bool_t tb_co_scheduler_io_cancel(tb_co_scheduler_io_ref_t scheduler_io, tb_socket_ref_t sock)
 {
     // check
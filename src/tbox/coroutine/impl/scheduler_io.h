@@ -36,6 +36,17 @@
  */
 __tb_extern_c_enter__
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the maximum count of the harvested poller events at once
+#ifdef __tb_small__
+#   define TB_SCHEDULER_IO_EVENTS_MAXN      (64)
+#else
+#   define TB_SCHEDULER_IO_EVENTS_MAXN      (256)
+#endif
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
  */
@@ -52,11 +63,20 @@ typedef struct __tb_co_scheduler_io_t
     // the poller
     tb_poller_ref_t     poller;
 
-    // the timer
-    tb_timer_ref_t      timer;
+    // the hierarchical timing wheel timer
+    tb_htimer_ref_t     timer;
 
-    // the low-precision timer (faster)
-    tb_ltimer_ref_t     ltimer;
+    // the harvested poller events
+    tb_poller_event_t   events[TB_SCHEDULER_IO_EVENTS_MAXN];
+
+    // the lock of the remote coroutines
+    tb_spinlock_t       remote_lock;
+
+    // the suspended coroutines which have been resumed from the other threads
+    tb_single_list_entry_head_t remote_coroutines;
+
+    // the poller has been waked up for the remote coroutines?
+    tb_atomic_t         remote_spak;
 
 }tb_co_scheduler_io_t, *tb_co_scheduler_io_ref_t;
 
@@ -102,6 +122,26 @@ tb_pointer_t                tb_co_scheduler_io_sleep(tb_co_scheduler_io_ref_t sc
  */
 tb_long_t                   tb_co_scheduler_io_wait(tb_co_scheduler_io_ref_t scheduler_io, tb_socket_ref_t sock, tb_size_t events, tb_long_t timeout);
 
+/*! post io operation and wait it to be completed 
+ *
+ * @param scheduler_io      the io scheduler
+ * @param ioop              the io operation
+ * @param timeout           the timeout, infinity: -1
+ *
+ * @return                  > 0: completed, 0: timeout, -1: not supported or failed
+ */
+tb_long_t                   tb_co_scheduler_io_post(tb_co_scheduler_io_ref_t scheduler_io, tb_poller_ioop_ref_t ioop, tb_long_t timeout);
+
+/*! resume the suspended coroutine from the other thread
+ *
+ * the coroutine will be resumed in the io loop of its scheduler,
+ * and the poller will be only waked up once for a burst of the remote resumes.
+ *
+ * @param scheduler_io      the io scheduler of the suspended coroutine
+ * @param coroutine         the suspended coroutine
+ */
+tb_void_t                   tb_co_scheduler_io_resume_remote(tb_co_scheduler_io_ref_t scheduler_io, tb_coroutine_t* coroutine);
+
 /*! cancel io events for the given socket 
  *
  * @param scheduler_io      the io scheduler
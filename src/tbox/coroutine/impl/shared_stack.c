@@ -0,0 +1,268 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        shared_stack.c
+ * @ingroup     coroutine
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "shared_stack"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "shared_stack.h"
+#include "stack_pool.h"
+#include "scheduler.h"
+#include "coroutine.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the shared stack size
+#ifdef __tb_small__
+#   define TB_CO_SHARED_STACK_SIZE          (1024 * 128)
+#else
+#   define TB_CO_SHARED_STACK_SIZE          (1024 * 256)
+#endif
+
+// the switcher stack size
+#ifdef __tb_debug__
+#   define TB_CO_SHARED_SWITCHER_SIZE       (8192 << 2)
+#else
+#   define TB_CO_SHARED_SWITCHER_SIZE       (8192 << 1)
+#endif
+
+// the stack guard size at the stack base
+#define TB_CO_SHARED_STACK_GUARD_SIZE       (16)
+
+// the align size of the saved stack buffer
+#define TB_CO_SHARED_STACK_SAVED_ALIGN      (256)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_bool_t tb_co_shared_stack_init(tb_co_shared_stack_t* stack, tb_size_t size)
+{
+    // check
+    tb_assert(stack && size);
+
+    // alloc stack data from the stack pool, it has a guard page for trapping the stack overflow
+    stack->data = tb_co_stack_pool_alloc(tb_co_stack_pool(), size, &stack->size);
+    tb_assert_and_check_return_val(stack->data && stack->size > TB_CO_SHARED_STACK_GUARD_SIZE, tb_false);
+
+    // init stack
+    stack->stackbase = stack->data + stack->size - TB_CO_SHARED_STACK_GUARD_SIZE;
+    stack->stacksize = stack->stackbase - stack->data;
+    stack->owner     = tb_null;
+
+    // ok
+    return tb_true;
+}
+static tb_void_t tb_co_shared_stack_exit(tb_co_shared_stack_t* stack)
+{
+    // check
+    tb_assert(stack);
+
+    // free stack data
+    if (stack->data) tb_co_stack_pool_free(tb_co_stack_pool(), stack->data, stack->size);
+    stack->data  = tb_null;
+    stack->size  = 0;
+    stack->owner = tb_null;
+}
+static tb_bool_t tb_co_shared_stack_save(tb_co_shared_stack_t* stack, tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert(stack && coroutine && coroutine->context);
+
+    // compute the used stack size, all data between the saved context and stack base are used
+    tb_byte_t* top = (tb_byte_t*)coroutine->context;
+    tb_assert_and_check_return_val(top >= stack->data && top <= stack->stackbase, tb_false);
+    tb_size_t used = stack->stackbase - top;
+
+    // the buffer is too small or too large? make a right-sized buffer
+    tb_size_t maxn = tb_align(used, TB_CO_SHARED_STACK_SAVED_ALIGN);
+    if (used > coroutine->stack_saved_maxn || maxn < (coroutine->stack_saved_maxn >> 1))
+    {
+        coroutine->stack_saved = (tb_byte_t*)tb_ralloc_bytes(coroutine->stack_saved, maxn);
+        tb_assert_and_check_return_val(coroutine->stack_saved, tb_false);
+        coroutine->stack_saved_maxn = maxn;
+    }
+
+    // save the used stack
+    tb_memcpy(coroutine->stack_saved, top, used);
+    coroutine->stack_saved_size = used;
+
+    // trace
+    tb_trace_d("save coroutine(%p): %lu bytes", coroutine, used);
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_co_shared_stack_load(tb_co_shared_stacks_t* stacks, tb_coroutine_t* coroutine)
+{
+    // check
+    tb_assert(stacks && coroutine);
+
+    // the original coroutine is running on the thread stack
+    tb_check_return_val(!tb_coroutine_is_original(coroutine), tb_true);
+    tb_assert(coroutine->shared);
+
+    // bind a shared stack to the new coroutine 
+    tb_co_shared_stack_t* stack = coroutine->shared_stack;
+    if (!stack)
+    {
+        stack = &stacks->stacks[stacks->next++ % TB_CO_SHARED_STACK_MAXN];
+        coroutine->shared_stack = stack;
+        coroutine->stackbase    = stack->stackbase;
+        coroutine->stacksize    = stack->stacksize;
+    }
+
+    // this coroutine owns the stack now?
+    tb_check_return_val(stack->owner != coroutine, tb_true);
+
+    // save the used stack of the previous owner
+    if (stack->owner && !tb_co_shared_stack_save(stack, stack->owner)) return tb_false;
+    stack->owner = coroutine;
+
+    // make context for the new coroutine
+    if (!coroutine->context) return tb_coroutine_context_make(coroutine);
+
+    // restore the saved stack
+    tb_assert_and_check_return_val(coroutine->stack_saved && coroutine->stack_saved_size <= stack->stacksize, tb_false);
+    tb_memcpy(stack->stackbase - coroutine->stack_saved_size, coroutine->stack_saved, coroutine->stack_saved_size);
+
+    // trace
+    tb_trace_d("restore coroutine(%p): %lu bytes", coroutine, coroutine->stack_saved_size);
+
+    // ok
+    return tb_true;
+}
+static tb_void_t tb_co_shared_stacks_switcher(tb_context_from_t from)
+{
+    // the switcher loop
+    while (1)
+    {
+        // get the from-coroutine 
+        tb_coroutine_t* coroutine_from = (tb_coroutine_t*)from.priv;
+        tb_assert(coroutine_from && from.context);
+
+        // update the context
+        coroutine_from->context = from.context;
+
+        // get the scheduler and the next running coroutine
+        tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_coroutine_scheduler(coroutine_from);
+        tb_assert(scheduler && scheduler->shared_stacks && scheduler->running);
+
+        // load the stack of the next coroutine, we cannot continue to run if it is failed
+        tb_coroutine_t* coroutine = scheduler->running;
+        if (!tb_co_shared_stack_load(scheduler->shared_stacks, coroutine))
+        {
+            // trace
+            tb_trace_e("cannot load the shared stack for coroutine(%p)!", coroutine);
+
+            // abort
+            tb_abort();
+        }
+
+        // jump to the next coroutine, the null priv means that it is switched from the switcher
+        from = tb_context_jump(coroutine->context, tb_null);
+    }
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_co_shared_stacks_ref_t tb_co_shared_stacks_init()
+{
+    // done
+    tb_bool_t                   ok = tb_false;
+    tb_co_shared_stacks_ref_t   stacks = tb_null;
+    do
+    {
+        // make stacks
+        stacks = tb_malloc0_type(tb_co_shared_stacks_t);
+        tb_assert_and_check_break(stacks);
+
+        // init the shared stacks
+        tb_size_t i = 0;
+        for (i = 0; i < TB_CO_SHARED_STACK_MAXN; i++)
+        {
+            if (!tb_co_shared_stack_init(&stacks->stacks[i], TB_CO_SHARED_STACK_SIZE)) break;
+        }
+        tb_check_break(i == TB_CO_SHARED_STACK_MAXN);
+
+        // init the switcher stack
+        if (!tb_co_shared_stack_init(&stacks->switcher_stack, TB_CO_SHARED_SWITCHER_SIZE)) break;
+
+        // make the switcher context
+        stacks->switcher = tb_context_make(stacks->switcher_stack.data, stacks->switcher_stack.stacksize, tb_co_shared_stacks_switcher);
+        tb_assert_and_check_break(stacks->switcher);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (stacks) tb_co_shared_stacks_exit(stacks);
+        stacks = tb_null;
+    }
+
+    // ok?
+    return stacks;
+}
+tb_void_t tb_co_shared_stacks_exit(tb_co_shared_stacks_ref_t stacks)
+{
+    // check
+    tb_assert_and_check_return(stacks);
+
+    // exit the shared stacks
+    tb_size_t i = 0;
+    for (i = 0; i < TB_CO_SHARED_STACK_MAXN; i++)
+        tb_co_shared_stack_exit(&stacks->stacks[i]);
+
+    // exit the switcher stack
+    tb_co_shared_stack_exit(&stacks->switcher_stack);
+
+    // exit it
+    tb_free(stacks);
+}
+tb_context_from_t tb_co_shared_stacks_jump(tb_co_shared_stacks_ref_t stacks, tb_coroutine_t* coroutine, tb_cpointer_t priv)
+{
+    // check
+    tb_assert(stacks && stacks->switcher && coroutine);
+
+    // jump to it directly if we need not restore its stack
+    if (tb_coroutine_is_original(coroutine) || (coroutine->shared_stack && coroutine->shared_stack->owner == coroutine))
+        return tb_context_jump(coroutine->context, priv);
+
+    // jump to the switcher, it will restore the stack and jump to the given coroutine
+    return tb_context_jump(stacks->switcher, priv);
+}
@@ -0,0 +1,138 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        shared_stack.h
+ * @ingroup     coroutine
+ *
+ */
+#ifndef TB_COROUTINE_IMPL_SHARED_STACK_H
+#define TB_COROUTINE_IMPL_SHARED_STACK_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the shared stacks count of each scheduler
+#ifdef __tb_small__
+#   define TB_CO_SHARED_STACK_MAXN          (2)
+#else
+#   define TB_CO_SHARED_STACK_MAXN          (4)
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the coroutine type
+struct __tb_coroutine_t;
+
+// the shared stack type
+typedef struct __tb_co_shared_stack_t
+{
+    // the stack data
+    tb_byte_t*                      data;
+
+    // the stack data size
+    tb_size_t                       size;
+
+    // the stack base (top)
+    tb_byte_t*                      stackbase;
+
+    // the stack size
+    tb_size_t                       stacksize;
+
+    // the coroutine which is using this stack now, it is null if no coroutine or it has been finished 
+    struct __tb_coroutine_t*        owner;
+
+}tb_co_shared_stack_t;
+
+/* the shared stacks type for the copy-on-switch mode
+ *
+ * all coroutines of the scheduler are run on a few shared stacks,
+ * the used part of the stack will be saved to the heap buffer of the owner 
+ * and the stack of the next coroutine will be restored before switching to it.
+ *
+ * the stack cannot be copied when we are running on it, 
+ * so we switch to the next coroutine through a switcher context with the private stack.
+ *
+ *  coroutine1(stack0) -> switcher: save(coroutine1) + restore(coroutine2) -> coroutine2(stack0)
+ *  coroutine1(stack0) -> coroutine3(stack1, it owns stack1 now)
+ */
+typedef struct __tb_co_shared_stacks_t
+{
+    // the shared stacks
+    tb_co_shared_stack_t            stacks[TB_CO_SHARED_STACK_MAXN];
+
+    // the next stack index for the new coroutine
+    tb_size_t                       next;
+
+    // the switcher context
+    tb_context_ref_t                switcher;
+
+    // the switcher stack
+    tb_co_shared_stack_t            switcher_stack;
+
+}tb_co_shared_stacks_t, *tb_co_shared_stacks_ref_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/* init the shared stacks
+ *
+ * @return                  the shared stacks
+ */
+tb_co_shared_stacks_ref_t   tb_co_shared_stacks_init(tb_noarg_t);
+
+/* exit the shared stacks
+ *
+ * @param stacks            the shared stacks
+ */
+tb_void_t                   tb_co_shared_stacks_exit(tb_co_shared_stacks_ref_t stacks);
+
+/* jump to the given coroutine 
+ *
+ * we will jump to the switcher first if the stack of the given coroutine need be restored
+ *
+ * @param stacks            the shared stacks
+ * @param coroutine         the coroutine
+ * @param priv              the passed user private data
+ *
+ * @return                  the from-context, the from.priv is null if it is from the switcher
+ */
+tb_context_from_t           tb_co_shared_stacks_jump(tb_co_shared_stacks_ref_t stacks, struct __tb_coroutine_t* coroutine, tb_cpointer_t priv);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -0,0 +1,469 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        stack_pool.c
+ * @ingroup     coroutine
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "stack_pool"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "stack_pool.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the maximum count of the cached stacks
+#ifdef __tb_small__
+#   define TB_CO_STACK_POOL_CACHE_MAXN      (16)
+#else
+#   define TB_CO_STACK_POOL_CACHE_MAXN      (256)
+#endif
+
+// the maximum count of the cached stacks for finding the matched stack
+#define TB_CO_STACK_POOL_FIND_MAXN          (16)
+
+// the stack head size
+#define TB_CO_STACK_HEAD_SIZE               tb_align(sizeof(tb_co_stack_t), 16)
+
+/* the hot size at the top of the cached stack, it will be kept in the physical memory for reusing quickly 
+ * and the other pages will be returned to the system when the stack is cached
+ */
+#ifdef __tb_small__
+#   define TB_CO_STACK_POOL_HOT_SIZE        (4096)
+#else
+#   define TB_CO_STACK_POOL_HOT_SIZE        (8192)
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the stack head type, it is placed at the top of the stack
+typedef struct __tb_co_stack_t
+{
+    // the list entry for the used or cached stacks
+    tb_list_entry_t                 entry;
+
+    // the region base (the guard page is included)
+    tb_byte_t*                      base;
+
+    // the region size
+    tb_size_t                       size;
+
+    // the real usable size of the stack data
+    tb_size_t                       data_size;
+
+    // is mapped with the virtual memory?
+    tb_bool_t                       mapped;
+
+}tb_co_stack_t;
+
+// the stack pool type
+typedef struct __tb_co_stack_pool_t
+{
+    // the lock
+    tb_spinlock_t                   lock;
+
+    // the page size
+    tb_size_t                       pagesize;
+
+    // the used stacks
+    tb_list_entry_head_t            used;
+
+    // the cached stacks, the recently freed stack is at the head
+    tb_list_entry_head_t            cache;
+
+    // the reserved bytes of all stacks
+    tb_size_t                       reserved;
+
+    // the count of the stacks which are allocated from the native memory without the guard page
+    tb_size_t                       native_count;
+
+}tb_co_stack_pool_t;
+
+// the mapped stack range type for computing the resident size outside the lock
+typedef struct __tb_co_stack_range_t
+{
+    // the range data (the guard page is excluded)
+    tb_byte_t*                      data;
+
+    // the range size
+    tb_size_t                       size;
+
+}tb_co_stack_range_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_handle_t tb_co_stack_pool_instance_init(tb_cpointer_t* ppriv)
+{
+    // init it
+    return (tb_handle_t)tb_co_stack_pool_init();
+}
+static tb_void_t tb_co_stack_pool_instance_exit(tb_handle_t pool, tb_cpointer_t priv)
+{
+    // exit it
+    tb_co_stack_pool_exit((tb_co_stack_pool_ref_t)pool);
+}
+static __tb_inline__ tb_size_t tb_co_stack_pool_data_size(tb_co_stack_pool_t* pool, tb_size_t size)
+{
+    // compute the real usable size of the stack data
+    return pool->pagesize? tb_align(size + TB_CO_STACK_HEAD_SIZE, pool->pagesize) - TB_CO_STACK_HEAD_SIZE : tb_align(size, 16);
+}
+static tb_co_stack_t* tb_co_stack_pool_make(tb_co_stack_pool_t* pool, tb_size_t data_size)
+{
+    // check
+    tb_assert(pool && data_size);
+
+    // make stack with the virtual memory
+    tb_byte_t*      base = tb_null;
+    tb_co_stack_t*  stack = tb_null;
+    if (pool->pagesize)
+    {
+        /* reserve and commit the guard page and stack, and then make the guard page not accessible
+         *
+         * the guard page will not split the mapping if the lightweight guard regions are supported,
+         * so the adjacent stacks can be merged to one mapping and we will not exhaust the mappings limit
+         */
+        tb_size_t size = pool->pagesize + data_size + TB_CO_STACK_HEAD_SIZE;
+        base = (tb_byte_t*)tb_virtual_memory_reserve(size);
+        if (base)
+        {
+            if (tb_virtual_memory_commit(base, size) && tb_virtual_memory_guard(base, pool->pagesize))
+            {
+                // init stack head, only the last page will be touched now
+                stack = (tb_co_stack_t*)(base + pool->pagesize + data_size);
+                stack->base     = base;
+                stack->size     = size;
+                stack->mapped   = tb_true;
+            }
+            else tb_virtual_memory_release(base, size);
+        }
+
+        // failed? it may be too many mappings (.e.g vm.max_map_count), we report it only once
+        if (!stack && !pool->native_count)
+            tb_trace_w("[stack_pool]: reserve stack failed, using the native memory without the guard page!");
+    }
+
+    // make stack with the native memory if the virtual memory is not supported or failed
+    if (!stack)
+    {
+        tb_size_t size = data_size + TB_CO_STACK_HEAD_SIZE;
+        base = (tb_byte_t*)tb_align_malloc(size, 16);
+        tb_assert_and_check_return_val(base, tb_null);
+
+        // init stack head
+        stack = (tb_co_stack_t*)(base + data_size);
+        stack->base     = base;
+        stack->size     = size;
+        stack->mapped   = tb_false;
+
+        // update the native stacks count
+        pool->native_count++;
+    }
+
+    // save the data size
+    stack->data_size = data_size;
+
+    // update the reserved size
+    pool->reserved += stack->size;
+
+    // trace
+    tb_trace_d("make: %p, size: %lu, mapped: %d", base, stack->size, stack->mapped);
+
+    // ok
+    return stack;
+}
+static tb_void_t tb_co_stack_pool_kill(tb_co_stack_pool_t* pool, tb_co_stack_t* stack)
+{
+    // check
+    tb_assert(pool && stack && pool->reserved >= stack->size);
+
+    // trace
+    tb_trace_d("kill: %p, size: %lu, mapped: %d", stack->base, stack->size, stack->mapped);
+
+    // update the reserved size
+    pool->reserved -= stack->size;
+
+    // update the native stacks count
+    if (!stack->mapped)
+    {
+        tb_assert(pool->native_count);
+        pool->native_count--;
+    }
+
+    // free it
+    if (stack->mapped) tb_virtual_memory_release(stack->base, stack->size);
+    else tb_align_free(stack->base);
+}
+static tb_size_t tb_co_stack_pool_ranges(tb_co_stack_pool_t* pool, tb_list_entry_head_ref_t list, tb_co_stack_range_t* ranges, tb_size_t maxn, tb_size_t* pcount)
+{
+    // check
+    tb_assert(pool && list && pcount);
+
+    /* save the ranges of the mapped stacks in this list and return the resident size of the others
+     *
+     * the mapped stacks which cannot be saved to the ranges are counted as the committed size
+     */
+    tb_size_t           resident = 0;
+    tb_size_t           count = *pcount;
+    tb_list_entry_ref_t entry = tb_list_entry_head(list);
+    while (entry != tb_list_entry_tail(list))
+    {
+        // the stack
+        tb_co_stack_t* stack = (tb_co_stack_t*)tb_list_entry0(entry);
+
+        // the guard page is never resident
+        if (stack->mapped)
+        {
+            if (count < maxn)
+            {
+                ranges[count].data = stack->base + pool->pagesize;
+                ranges[count].size = stack->size - pool->pagesize;
+                count++;
+            }
+            else resident += stack->size - pool->pagesize;
+        }
+        else resident += stack->size;
+
+        // next
+        entry = tb_list_entry_next(entry);
+    }
+
+    // ok
+    *pcount = count;
+    return resident;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_co_stack_pool_ref_t tb_co_stack_pool()
+{
+    return (tb_co_stack_pool_ref_t)tb_singleton_instance(TB_SINGLETON_TYPE_CO_STACK_POOL, tb_co_stack_pool_instance_init, tb_co_stack_pool_instance_exit, tb_null, tb_null);
+}
+tb_co_stack_pool_ref_t tb_co_stack_pool_init()
+{
+    // make pool
+    tb_co_stack_pool_t* pool = tb_malloc0_type(tb_co_stack_pool_t);
+    tb_assert_and_check_return_val(pool, tb_null);
+
+    // init lock
+    tb_spinlock_init(&pool->lock);
+
+    // init the used and cached stacks
+    tb_list_entry_init(&pool->used, tb_co_stack_t, entry, tb_null);
+    tb_list_entry_init(&pool->cache, tb_co_stack_t, entry, tb_null);
+
+    // uses the virtual memory if be supported
+    tb_size_t pagesize = tb_page_size();
+    if (pagesize && tb_ispow2(pagesize))
+    {
+        tb_pointer_t data = tb_virtual_memory_reserve(pagesize);
+        if (data)
+        {
+            pool->pagesize = pagesize;
+            tb_virtual_memory_release(data, pagesize);
+        }
+    }
+
+    // trace
+    tb_trace_d("init: pagesize: %lu", pool->pagesize);
+
+    // ok
+    return (tb_co_stack_pool_ref_t)pool;
+}
+tb_void_t tb_co_stack_pool_exit(tb_co_stack_pool_ref_t self)
+{
+    // check
+    tb_co_stack_pool_t* pool = (tb_co_stack_pool_t*)self;
+    tb_assert_and_check_return(pool);
+
+    // enter lock
+    tb_spinlock_enter(&pool->lock);
+
+    // check leaks
+    if (tb_list_entry_size(&pool->used)) tb_trace_e("%lu coroutine stacks are still used!", tb_list_entry_size(&pool->used));
+
+    // free all cached stacks
+    while (tb_list_entry_size(&pool->cache))
+    {
+        tb_co_stack_t* stack = (tb_co_stack_t*)tb_list_entry0(tb_list_entry_head(&pool->cache));
+        tb_list_entry_remove_head(&pool->cache);
+        tb_co_stack_pool_kill(pool, stack);
+    }
+
+    // exit the used and cached stacks
+    tb_list_entry_exit(&pool->used);
+    tb_list_entry_exit(&pool->cache);
+
+    // leave lock
+    tb_spinlock_leave(&pool->lock);
+
+    // exit lock
+    tb_spinlock_exit(&pool->lock);
+
+    // exit it
+    tb_free(pool);
+}
+tb_byte_t* tb_co_stack_pool_alloc(tb_co_stack_pool_ref_t self, tb_size_t size, tb_size_t* psize)
+{
+    // check
+    tb_co_stack_pool_t* pool = (tb_co_stack_pool_t*)self;
+    tb_assert_and_check_return_val(pool && size && psize, tb_null);
+
+    // the real usable size
+    tb_size_t data_size = tb_co_stack_pool_data_size(pool, size);
+
+    // enter lock
+    tb_spinlock_enter(&pool->lock);
+
+    // find a matched stack from the recently freed stacks
+    tb_size_t           count = 0;
+    tb_co_stack_t*      stack = tb_null;
+    tb_list_entry_ref_t entry = tb_list_entry_head(&pool->cache);
+    while (entry != tb_list_entry_tail(&pool->cache) && count++ < TB_CO_STACK_POOL_FIND_MAXN)
+    {
+        // matched?
+        tb_co_stack_t* cached = (tb_co_stack_t*)tb_list_entry0(entry);
+        if (cached->data_size == data_size)
+        {
+            // reuse it
+            tb_list_entry_remove(&pool->cache, entry);
+            stack = cached;
+            break;
+        }
+
+        // next
+        entry = tb_list_entry_next(entry);
+    }
+
+    // make a new stack
+    if (!stack) stack = tb_co_stack_pool_make(pool, data_size);
+
+    // save it to the used stacks
+    if (stack) tb_list_entry_insert_tail(&pool->used, &stack->entry);
+
+    // leave lock
+    tb_spinlock_leave(&pool->lock);
+
+    // check
+    tb_assert_and_check_return_val(stack, tb_null);
+
+    // ok
+    *psize = data_size;
+    return (tb_byte_t*)stack - data_size;
+}
+tb_void_t tb_co_stack_pool_free(tb_co_stack_pool_ref_t self, tb_byte_t* data, tb_size_t size)
+{
+    // check
+    tb_co_stack_pool_t* pool = (tb_co_stack_pool_t*)self;
+    tb_assert_and_check_return(pool && data && size);
+
+    // get the stack head
+    tb_co_stack_t* stack = (tb_co_stack_t*)(data + size);
+    tb_assert_and_check_return(stack->data_size == size);
+
+    /* return the physical memory of the cold pages to the system before caching it, 
+     * only the hot pages at the top of the stack are kept for reusing quickly
+     *
+     *  ---------------------------------------------------------
+     * | guard page | ... cold pages ... | hot pages | stack head |
+     *  ---------------------------------------------------------
+     */
+    if (stack->mapped)
+    {
+        tb_byte_t* cold = stack->base + pool->pagesize;
+        tb_byte_t* hot = stack->base + stack->size - tb_align(TB_CO_STACK_POOL_HOT_SIZE, pool->pagesize);
+        if (hot > cold) tb_virtual_memory_advise(cold, hot - cold, TB_VIRTUAL_MEMORY_ADVICE_DONTNEED);
+    }
+
+    // enter lock
+    tb_spinlock_enter(&pool->lock);
+
+    // remove it from the used stacks
+    tb_list_entry_remove(&pool->used, &stack->entry);
+
+    // cache it for reusing 
+    tb_list_entry_insert_head(&pool->cache, &stack->entry);
+
+    // too much cached stacks? free the oldest stack
+    if (tb_list_entry_size(&pool->cache) > TB_CO_STACK_POOL_CACHE_MAXN)
+    {
+        stack = (tb_co_stack_t*)tb_list_entry0(tb_list_entry_last(&pool->cache));
+        tb_list_entry_remove_last(&pool->cache);
+        tb_co_stack_pool_kill(pool, stack);
+    }
+
+    // leave lock
+    tb_spinlock_leave(&pool->lock);
+}
+tb_bool_t tb_co_stack_pool_stat(tb_co_stack_pool_ref_t self, tb_coroutine_stack_stat_t* stat)
+{
+    // check
+    tb_co_stack_pool_t* pool = (tb_co_stack_pool_t*)self;
+    tb_assert_and_check_return_val(pool && stat, tb_false);
+
+    // get the stacks count first, we cannot allocate the ranges in the lock
+    tb_spinlock_enter(&pool->lock);
+    tb_size_t maxn = pool->pagesize? tb_list_entry_size(&pool->used) + tb_list_entry_size(&pool->cache) : 0;
+    tb_spinlock_leave(&pool->lock);
+
+    // make the ranges of the mapped stacks, we will count the committed size if it fails
+    tb_co_stack_range_t* ranges = maxn? tb_nalloc_type(maxn, tb_co_stack_range_t) : tb_null;
+    if (!ranges) maxn = 0;
+
+    // enter lock
+    tb_spinlock_enter(&pool->lock);
+
+    // get the statistics and copy out the ranges of the mapped stacks
+    tb_size_t count     = 0;
+    stat->reserved      = pool->reserved;
+    stat->resident      = tb_co_stack_pool_ranges(pool, &pool->used, ranges, maxn, &count) + tb_co_stack_pool_ranges(pool, &pool->cache, ranges, maxn, &count);
+    stat->used_count    = tb_list_entry_size(&pool->used);
+    stat->cached_count  = tb_list_entry_size(&pool->cache);
+    stat->native_count  = pool->native_count;
+
+    // leave lock
+    tb_spinlock_leave(&pool->lock);
+
+    /* compute the resident size of the mapped stacks outside the lock, because mincore() is slow for the large stacks
+     *
+     * the stack may be freed in the meantime, it is only a snapshot and the released range will be counted as the committed size.
+     */
+    tb_size_t i;
+    for (i = 0; i < count; i++) stat->resident += tb_virtual_memory_resident(ranges[i].data, ranges[i].size);
+
+    // exit the ranges
+    if (ranges) tb_free(ranges);
+
+    // ok
+    return tb_true;
+}
@@ -0,0 +1,116 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        stack_pool.h
+ * @ingroup     coroutine
+ *
+ */
+#ifndef TB_COROUTINE_IMPL_STACK_POOL_H
+#define TB_COROUTINE_IMPL_STACK_POOL_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the coroutine stack pool ref type
+typedef __tb_typeref__(co_stack_pool);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/* the global coroutine stack pool instance
+ *
+ * @return              the stack pool
+ */
+tb_co_stack_pool_ref_t  tb_co_stack_pool(tb_noarg_t);
+
+/* init the coroutine stack pool
+ *
+ * @return              the stack pool
+ */
+tb_co_stack_pool_ref_t  tb_co_stack_pool_init(tb_noarg_t);
+
+/* exit the coroutine stack pool
+ *
+ * @note all stacks must have been freed
+ *
+ * @param pool          the stack pool
+ */
+tb_void_t               tb_co_stack_pool_exit(tb_co_stack_pool_ref_t pool);
+
+/* alloc a stack from the pool
+ *
+ * the stack is reserved with the virtual memory and a not accessible guard page is placed 
+ * below it, the physical memory will be committed lazily when it is touched.
+ *
+ * we will use tb_malloc() instead of it if the virtual memory is not supported or failed (.e.g too many mappings),
+ * and these stacks are counted by tb_coroutine_stack_stat_t.native_count.
+ *
+ *  ---------------------------------------------------------
+ * | guard page | ... data (psize) ... | the pool stack head |
+ *  ---------------------------------------------------------
+ *              |
+ *            data
+ *
+ * @param pool          the stack pool
+ * @param size          the needed size
+ * @param psize         return the real usable size (>= size), it is aligned by 16 bytes
+ *
+ * @return              the stack data
+ */
+tb_byte_t*              tb_co_stack_pool_alloc(tb_co_stack_pool_ref_t pool, tb_size_t size, tb_size_t* psize);
+
+/* free the stack to the pool, it will be cached for reusing 
+ *
+ * only the hot pages at the top of the cached stack are kept in the physical memory
+ *
+ * @param pool          the stack pool
+ * @param data          the stack data
+ * @param size          the real usable size of this stack
+ */
+tb_void_t               tb_co_stack_pool_free(tb_co_stack_pool_ref_t pool, tb_byte_t* data, tb_size_t size);
+
+/* get the statistics of the stack pool
+ *
+ * @param pool          the stack pool
+ * @param stat          the statistics
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_co_stack_pool_stat(tb_co_stack_pool_ref_t pool, tb_coroutine_stack_stat_t* stat);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
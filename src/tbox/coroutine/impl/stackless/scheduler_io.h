@@ -53,11 +53,8 @@ typedef struct __tb_lo_scheduler_io_t
     tb_poller_ref_t     poller;
 
 #ifndef TB_CONFIG_MICRO_ENABLE
-    // the timer
-    tb_timer_ref_t      timer;
-
-    // the low-precision timer (faster)
-    tb_ltimer_ref_t     ltimer;
+    // the hierarchical timing wheel timer
+    tb_htimer_ref_t     timer;
 #endif
 
 }tb_lo_scheduler_io_t, *tb_lo_scheduler_io_ref_t;
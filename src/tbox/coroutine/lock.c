@@ -40,9 +40,13 @@
  * implementation
  */
 tb_co_lock_ref_t tb_co_lock_init()
+{
+    return tb_co_lock_init_with_flags(TB_CO_LOCK_FLAG_NONE);
+}
+tb_co_lock_ref_t tb_co_lock_init_with_flags(tb_size_t flags)
 {
     // init lock
-    return (tb_co_lock_ref_t)tb_co_semaphore_init(1);
+    return (tb_co_lock_ref_t)tb_co_semaphore_init_with_flags(1, (flags & TB_CO_LOCK_FLAG_SHARED)? TB_CO_SEMAPHORE_FLAG_SHARED : TB_CO_SEMAPHORE_FLAG_NONE);
 }
 tb_void_t tb_co_lock_exit(tb_co_lock_ref_t self)
 {
@@ -43,6 +43,16 @@ __tb_extern_c_enter__
 /// the coroutine lock ref type
 typedef __tb_typeref__(co_lock);
 
+/// the coroutine lock flag enum
+typedef enum __tb_co_lock_flag_e
+{
+    TB_CO_LOCK_FLAG_NONE            = 0
+
+    /// the lock can be shared between the different workers of the scheduler and the plain threads
+,   TB_CO_LOCK_FLAG_SHARED          = 1
+
+}tb_co_lock_flag_e;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
@@ -53,6 +63,14 @@ typedef __tb_typeref__(co_lock);
  */
 tb_co_lock_ref_t        tb_co_lock_init(tb_noarg_t);
 
+/*! init lock with the given flags
+ *
+ * @param flags         the lock flags, e.g. TB_CO_LOCK_FLAG_SHARED
+ *
+ * @return              the lock 
+ */
+tb_co_lock_ref_t        tb_co_lock_init_with_flags(tb_size_t flags);
+
 /*! exit lock
  *
  * @param lock          the lock
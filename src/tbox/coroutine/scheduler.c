@@ -69,6 +69,58 @@ static tb_void_t tb_co_scheduler_free(tb_list_entry_head_ref_t coroutines)
         tb_coroutine_exit((tb_coroutine_t*)tb_list_entry0(entry));
     }
 }
+static tb_void_t tb_co_scheduler_run(tb_co_scheduler_t* scheduler, tb_bool_t exclusive)
+{
+    // check
+    tb_assert_and_check_return(scheduler);
+
+    // is exclusive mode?
+    if (exclusive) s_scheduler_self_ex = scheduler;
+    else
+    {
+        // init self scheduler local
+        if (!tb_thread_local_init(&s_scheduler_self, tb_null)) return ;
+     
+        // update and overide the current scheduler
+        tb_thread_local_set(&s_scheduler_self, scheduler);
+    }
+
+    // schedule all ready coroutines
+    while (tb_list_entry_size(&scheduler->coroutines_ready)) 
+    {
+        // check
+        tb_assert(tb_coroutine_is_original(scheduler->running));
+
+        // get the next entry from head
+        tb_list_entry_ref_t entry = tb_list_entry_head(&scheduler->coroutines_ready);
+        tb_assert(entry);
+
+        // switch to the next coroutine 
+        tb_co_scheduler_switch(scheduler, (tb_coroutine_t*)tb_list_entry0(entry));
+
+        // trace
+        tb_trace_d("[loop]: ready %lu", tb_list_entry_size(&scheduler->coroutines_ready));
+    }
+
+    // stop it
+    scheduler->stopped = tb_true;
+ 
+    // is exclusive mode?
+    if (exclusive) s_scheduler_self_ex = tb_null;
+    else
+    {
+        // clear the current scheduler
+        tb_thread_local_set(&s_scheduler_self, tb_null);
+    }
+}
+static tb_int_t tb_co_scheduler_worker(tb_cpointer_t priv)
+{
+    // run this worker, we cannot use the exclusive mode for multi-threads
+    tb_co_scheduler_run((tb_co_scheduler_t*)priv, tb_false);
+
+    // ok
+    return 0;
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -93,6 +145,12 @@ tb_co_scheduler_ref_t tb_co_scheduler_init()
         // init suspend coroutines
         tb_list_entry_init(&scheduler->coroutines_suspend, tb_coroutine_t, entry, tb_null);
 
+        // init pending coroutines
+        tb_list_entry_init(&scheduler->coroutines_pending, tb_coroutine_t, entry, tb_null);
+
+        // init the lock of the pending coroutines
+        if (!tb_spinlock_init(&scheduler->pending_lock)) break;
+
         // init original coroutine
         scheduler->original.scheduler = (tb_co_scheduler_ref_t)scheduler;
 
@@ -115,6 +173,54 @@ tb_co_scheduler_ref_t tb_co_scheduler_init()
     // ok?
     return (tb_co_scheduler_ref_t)scheduler;
 }
+tb_co_scheduler_ref_t tb_co_scheduler_init_with_workers(tb_size_t workers)
+{
+    return tb_co_scheduler_init_with_flags(workers, TB_CO_SCHEDULER_FLAG_NONE);
+}
+tb_co_scheduler_ref_t tb_co_scheduler_init_with_flags(tb_size_t workers, tb_size_t flags)
+{
+    // uses the processor count if be zero
+    if (!workers) workers = tb_processor_count();
+
+    // done
+    tb_bool_t           ok = tb_false;
+    tb_co_scheduler_t*  scheduler = tb_null;
+    do
+    {
+        // init scheduler
+        scheduler = (tb_co_scheduler_t*)tb_co_scheduler_init();
+        tb_assert_and_check_break(scheduler);
+
+        // init the shared stacks
+        if (flags & TB_CO_SCHEDULER_FLAG_SHARED_STACK)
+        {
+            scheduler->shared_stacks = tb_co_shared_stacks_init();
+            tb_assert_and_check_break(scheduler->shared_stacks);
+        }
+
+        // init the worker group if there are more workers
+        if (workers > 1 && !tb_co_scheduler_group_init(scheduler, workers)) break;
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (scheduler) 
+        {
+            scheduler->stopped = tb_true;
+            tb_co_scheduler_exit((tb_co_scheduler_ref_t)scheduler);
+        }
+        scheduler = tb_null;
+    }
+
+    // ok?
+    return (tb_co_scheduler_ref_t)scheduler;
+}
 tb_void_t tb_co_scheduler_exit(tb_co_scheduler_ref_t self)
 {
     // check
@@ -124,6 +230,10 @@ tb_void_t tb_co_scheduler_exit(tb_co_scheduler_ref_t self)
     // must be stopped
     tb_assert(scheduler->stopped);
 
+    // exit the worker group and all other workers
+    if (scheduler->group) tb_co_scheduler_group_exit(scheduler->group);
+    scheduler->group = tb_null;
+
     // exit io scheduler first
     if (scheduler->scheduler_io) tb_co_scheduler_io_exit(scheduler->scheduler_io);
     scheduler->scheduler_io = tb_null;
@@ -144,6 +254,9 @@ tb_void_t tb_co_scheduler_exit(tb_co_scheduler_ref_t self)
     // free all suspend coroutines 
     tb_co_scheduler_free(&scheduler->coroutines_suspend);
 
+    // free all pending coroutines 
+    tb_co_scheduler_free(&scheduler->coroutines_pending);
+
     // exit dead coroutines
     tb_list_entry_exit(&scheduler->coroutines_dead);
 
@@ -153,6 +266,16 @@ tb_void_t tb_co_scheduler_exit(tb_co_scheduler_ref_t self)
     // exit suspend coroutines
     tb_list_entry_exit(&scheduler->coroutines_suspend);
 
+    // exit pending coroutines
+    tb_list_entry_exit(&scheduler->coroutines_pending);
+
+    // exit the shared stacks after all coroutines have been freed
+    if (scheduler->shared_stacks) tb_co_shared_stacks_exit(scheduler->shared_stacks);
+    scheduler->shared_stacks = tb_null;
+
+    // exit the lock of the pending coroutines
+    tb_spinlock_exit(&scheduler->pending_lock);
+
     // exit the scheduler
     tb_free(scheduler);
 }
@@ -162,6 +285,13 @@ tb_void_t tb_co_scheduler_kill(tb_co_scheduler_ref_t self)
     tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)self;
     tb_assert_and_check_return(scheduler);
 
+    // is worker? kill all workers
+    if (scheduler->group) 
+    {
+        tb_co_scheduler_group_kill(scheduler->group);
+        return ;
+    }
+
     // stop it
     scheduler->stopped = tb_true;
 
@@ -174,44 +304,9 @@ tb_void_t tb_co_scheduler_loop(tb_co_scheduler_ref_t self, tb_bool_t exclusive)
     tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)self;
     tb_assert_and_check_return(scheduler);
 
-    // is exclusive mode?
-    if (exclusive) s_scheduler_self_ex = scheduler;
-    else
-    {
-        // init self scheduler local
-        if (!tb_thread_local_init(&s_scheduler_self, tb_null)) return ;
-     
-        // update and overide the current scheduler
-        tb_thread_local_set(&s_scheduler_self, self);
-    }
-
-    // schedule all ready coroutines
-    while (tb_list_entry_size(&scheduler->coroutines_ready)) 
-    {
-        // check
-        tb_assert(tb_coroutine_is_original(scheduler->running));
-
-        // get the next entry from head
-        tb_list_entry_ref_t entry = tb_list_entry_head(&scheduler->coroutines_ready);
-        tb_assert(entry);
-
-        // switch to the next coroutine 
-        tb_co_scheduler_switch(scheduler, (tb_coroutine_t*)tb_list_entry0(entry));
-
-        // trace
-        tb_trace_d("[loop]: ready %lu", tb_list_entry_size(&scheduler->coroutines_ready));
-    }
-
-    // stop it
-    scheduler->stopped = tb_true;
- 
-    // is exclusive mode?
-    if (exclusive) s_scheduler_self_ex = tb_null;
-    else
-    {
-        // clear the current scheduler
-        tb_thread_local_set(&s_scheduler_self, tb_null);
-    }
+    // is multi-threaded scheduler? run all workers
+    if (scheduler->group) tb_co_scheduler_group_loop(scheduler->group, tb_co_scheduler_worker);
+    else tb_co_scheduler_run(scheduler, exclusive);
 }
 tb_co_scheduler_ref_t tb_co_scheduler_self()
 { 
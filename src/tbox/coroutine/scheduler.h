@@ -43,6 +43,23 @@ __tb_extern_c_enter__
 /// the coroutine scheduler ref type
 typedef __tb_typeref__(co_scheduler);
 
+/// the coroutine scheduler flag enum
+typedef enum __tb_co_scheduler_flag_e
+{
+    TB_CO_SCHEDULER_FLAG_NONE           = 0
+
+    /*! run all coroutines on a few shared stacks (copy-on-switch)
+     *
+     * the used part of the shared stack will be saved to a right-sized heap buffer when the coroutine is switched out,
+     * it will save much memory for lots of coroutines with the shallow stacks, but switching them will be slower.
+     *
+     * @note the stack size of tb_coroutine_start() will be ignored,
+     *       and we cannot access the stack data of the other coroutines (e.g. pass the pointer of the local variable)
+     */
+,   TB_CO_SCHEDULER_FLAG_SHARED_STACK   = 1
+
+}tb_co_scheduler_flag_e;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
@@ -53,6 +70,37 @@ typedef __tb_typeref__(co_scheduler);
  */
 tb_co_scheduler_ref_t   tb_co_scheduler_init(tb_noarg_t);
 
+/*! init the multi-threaded scheduler with the work-stealing workers (N:M)
+ *
+ * each worker runs on its own thread and keeps its own ready coroutines and poller,
+ * the new coroutines are posted to the pending queue of the current worker
+ * and the idle workers will steal them from the busy workers.
+ *
+ * @note the coroutine will be always run on the same worker after it has been started,
+ *       so the lock, semaphore and channel can only be used between the coroutines on the same worker 
+ *       (e.g. started by tb_coroutine_start_local()), it will be asserted for the lock and semaphore in the debug mode,
+ *       but they can be used between the different workers with TB_CO_LOCK_FLAG_SHARED, 
+ *       TB_CO_SEMAPHORE_FLAG_SHARED and TB_CO_CHANNEL_FLAG_SHARED.
+ *
+ * @param workers       the workers count, uses the processor count if be zero
+ *
+ * @return              the scheduler 
+ */
+tb_co_scheduler_ref_t   tb_co_scheduler_init_with_workers(tb_size_t workers);
+
+/*! init scheduler with the given flags
+ *
+ * @code
+ * tb_co_scheduler_ref_t scheduler = tb_co_scheduler_init_with_flags(1, TB_CO_SCHEDULER_FLAG_SHARED_STACK);
+ * @endcode
+ *
+ * @param workers       the workers count, uses the processor count if be zero, see tb_co_scheduler_init_with_workers()
+ * @param flags         the scheduler flags, e.g. TB_CO_SCHEDULER_FLAG_SHARED_STACK
+ *
+ * @return              the scheduler 
+ */
+tb_co_scheduler_ref_t   tb_co_scheduler_init_with_flags(tb_size_t workers, tb_size_t flags);
+
 /*! exit scheduler
  *
  * @param scheduler     the scheduler
@@ -69,7 +117,8 @@ tb_void_t               tb_co_scheduler_kill(tb_co_scheduler_ref_t scheduler);
  *
  * @param scheduler     the scheduler
  * @param exclusive     enable exclusive mode, we need ensure only one loop() be called at the same time, 
- *                      but it will be faster using thr global scheduler instead of TLS storage
+ *                      but it will be faster using thr global scheduler instead of TLS storage,
+ *                      it will be ignored for the multi-threaded scheduler
  */
 tb_void_t               tb_co_scheduler_loop(tb_co_scheduler_ref_t schedule, tb_bool_t exclusive);
 
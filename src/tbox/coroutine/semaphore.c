@@ -38,6 +38,7 @@
 #include "scheduler.h"
 #include "impl/impl.h"
 #include "../container/container.h"
+#include "../platform/semaphore.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
@@ -52,12 +53,270 @@ typedef struct __tb_co_semaphore_t
     // the waiting coroutines
     tb_single_list_entry_head_t     waiting;
 
+    // the waiting plain threads for the shared semaphore
+    tb_single_list_entry_head_t     waiting_threads;
+
+    // the flags
+    tb_size_t                       flags;
+
+    // the lock for the shared semaphore
+    tb_spinlock_t                   lock;
+
 }tb_co_semaphore_t;
 
+// the waiting plain thread type for the shared semaphore, it is placed on the stack of the waiting thread
+typedef struct __tb_co_semaphore_thread_t
+{
+    // the list entry
+    tb_single_list_entry_t          entry;
+
+    // the event for waking up this thread
+    tb_semaphore_ref_t              event;
+
+}tb_co_semaphore_thread_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_pointer_t tb_co_semaphore_waiting(tb_single_list_entry_head_ref_t waiting)
+{
+    // check
+    tb_assert(waiting);
+
+    // no waiting coroutines or threads?
+    tb_check_return_val(tb_single_list_entry_size(waiting), tb_null);
+
+    // get the next entry from head
+    tb_single_list_entry_ref_t entry = tb_single_list_entry_head(waiting);
+    tb_assert(entry);
+
+    // remove it from the waiting list
+    tb_single_list_entry_remove_head(waiting);
+
+    // get the waiting coroutine or thread
+    return tb_single_list_entry(waiting, entry);
+}
+static tb_bool_t tb_co_semaphore_waiting_remove(tb_single_list_entry_head_ref_t waiting, tb_single_list_entry_ref_t entry)
+{
+    // check
+    tb_assert(waiting && entry);
+
+    // find and remove it, the waiting list is usually very short
+    tb_single_list_entry_ref_t prev = (tb_single_list_entry_ref_t)waiting;
+    tb_single_list_entry_ref_t item = tb_single_list_entry_head(waiting);
+    while (item)
+    {
+        if (item == entry)
+        {
+            tb_single_list_entry_remove_next(waiting, prev);
+            return tb_true;
+        }
+        prev = item;
+        item = tb_single_list_entry_next(item);
+    }
+
+    // not found, it has been resumed
+    return tb_false;
+}
+static tb_void_t tb_co_semaphore_shared_timeout(tb_bool_t killed, tb_cpointer_t priv)
+{
+    // check
+    tb_coroutine_t* coroutine = (tb_coroutine_t*)priv;
+    tb_assert(coroutine);
+
+    /* get the waited semaphore which was passed to suspend()
+     *
+     * it will be cleared if this coroutine has been resumed by tb_co_semaphore_post() from the io loop,
+     * the timer and the io loop are run on the same thread, so we need not lock it.
+     */
+    tb_co_semaphore_t* semaphore = (tb_co_semaphore_t*)coroutine->rs_priv;
+    tb_check_return(semaphore);
+
+    // remove it from the waiting coroutines if it has been not resumed by tb_co_semaphore_post()
+    tb_spinlock_enter(&semaphore->lock);
+    tb_bool_t timeout = tb_co_semaphore_waiting_remove(&semaphore->waiting, &coroutine->rs.single_entry);
+    tb_spinlock_leave(&semaphore->lock);
+
+    // trace
+    tb_trace_d("coroutine(%p): wait %s", coroutine, timeout? "timeout" : "ok");
+
+    // resume it and pass the timeout state to suspend()
+    if (timeout) tb_co_scheduler_resume((tb_co_scheduler_t*)tb_coroutine_scheduler(coroutine), coroutine, (tb_cpointer_t)tb_true);
+}
+static tb_void_t tb_co_semaphore_shared_post(tb_co_semaphore_t* semaphore, tb_size_t post)
+{
+    // check
+    tb_assert(semaphore);
+
+    // enter lock
+    tb_spinlock_enter(&semaphore->lock);
+
+    // add the semaphore value
+    tb_size_t value = semaphore->value + post;
+
+    // resume the waiting coroutines first
+    tb_coroutine_t* waiting = tb_null;
+    while (value && (waiting = (tb_coroutine_t*)tb_co_semaphore_waiting(&semaphore->waiting)))
+    {
+        /* resume it in the io loop of its scheduler, it only posts it to the remote coroutines or makes it as ready,
+         * so we can do it in the lock and the value has been passed to this coroutine
+         */
+        tb_co_scheduler_resume_remote((tb_co_scheduler_t*)tb_coroutine_scheduler(waiting), waiting);
+
+        // decrease the semaphore value
+        value--;
+    }
+
+    // wake up the waiting threads
+    tb_co_semaphore_thread_t* thread = tb_null;
+    while (value && (thread = (tb_co_semaphore_thread_t*)tb_co_semaphore_waiting(&semaphore->waiting_threads)))
+    {
+        // post it in the lock, the thread cannot exit the event before it has got the lock
+        tb_semaphore_post(thread->event, 1);
+
+        // decrease the semaphore value
+        value--;
+    }
+
+    // update the semaphore value
+    semaphore->value = value;
+
+    // leave lock
+    tb_spinlock_leave(&semaphore->lock);
+}
+static tb_long_t tb_co_semaphore_shared_wait_coroutine(tb_co_semaphore_t* semaphore, tb_coroutine_t* running, tb_long_t timeout)
+{
+    // check
+    tb_assert(semaphore && running);
+
+    // save this coroutine to the waiting coroutines, it may be resumed from the other threads
+    tb_single_list_entry_insert_tail(&semaphore->waiting, &running->rs.single_entry);
+    tb_spinlock_leave(&semaphore->lock);
+
+    // the scheduler
+    tb_co_scheduler_t* scheduler = (tb_co_scheduler_t*)tb_coroutine_scheduler(running);
+    tb_assert(scheduler && tb_co_scheduler_io(scheduler));
+
+    /* init the timer task, the remote resume cannot cancel it, so we will remove it after being resumed
+     *
+     * the timer and the remote coroutines are only handled in the io loop of the current scheduler after it has been suspended,
+     * so we can leave the lock before initing the timer task and suspending it.
+     */
+    tb_htimer_task_ref_t task = tb_null;
+    if (timeout > 0)
+    {
+        task = tb_htimer_task_init(tb_co_scheduler_io(scheduler)->timer, timeout, tb_false, tb_co_semaphore_shared_timeout, running);
+        tb_assert(task);
+    }
+
+    // suspend it and pass the semaphore to the timer task
+    tb_bool_t timedout = tb_coroutine_suspend((tb_cpointer_t)semaphore) != tb_null;
+
+    // remove the timer task
+    if (task) tb_htimer_task_exit(tb_co_scheduler_io(scheduler)->timer, task);
+
+    // the scheduler has been stopped? we may be still in the waiting list
+    if (!timedout && scheduler->stopped)
+    {
+        tb_spinlock_enter(&semaphore->lock);
+        timedout = tb_co_semaphore_waiting_remove(&semaphore->waiting, &running->rs.single_entry);
+        tb_spinlock_leave(&semaphore->lock);
+    }
+
+    // the semaphore value has been passed to us if be not timeout
+    return timedout? 0 : 1;
+}
+static tb_long_t tb_co_semaphore_shared_wait_thread(tb_co_semaphore_t* semaphore, tb_long_t timeout)
+{
+    // check
+    tb_assert(semaphore);
+
+    // init the waiting thread
+    tb_co_semaphore_thread_t thread;
+    thread.event = tb_semaphore_init(0);
+    if (!thread.event)
+    {
+        tb_spinlock_leave(&semaphore->lock);
+        return -1;
+    }
+
+    // save this thread to the waiting threads
+    tb_single_list_entry_insert_tail(&semaphore->waiting_threads, &thread.entry);
+    tb_spinlock_leave(&semaphore->lock);
+
+    // wait it
+    tb_long_t ok = tb_semaphore_wait(thread.event, timeout);
+
+    // timeout or failed? remove it from the waiting threads if it has been not posted
+    if (ok <= 0)
+    {
+        tb_spinlock_enter(&semaphore->lock);
+        tb_bool_t removed = tb_co_semaphore_waiting_remove(&semaphore->waiting_threads, &thread.entry);
+        tb_spinlock_leave(&semaphore->lock);
+
+        // it has been posted in the lock? the event has been posted too
+        if (!removed) ok = tb_semaphore_wait(thread.event, -1);
+    }
+
+    // exit the event
+    tb_semaphore_exit(thread.event);
+
+    // ok?
+    return ok;
+}
+static tb_long_t tb_co_semaphore_shared_wait(tb_co_semaphore_t* semaphore, tb_long_t timeout)
+{
+    // check
+    tb_assert(semaphore);
+
+    // get the running coroutine, we are running on the plain thread if be original coroutine
+    tb_coroutine_t* running = (tb_coroutine_t*)tb_coroutine_self();
+    if (running && tb_coroutine_is_original(running)) running = tb_null;
+
+    // enter lock
+    tb_spinlock_enter(&semaphore->lock);
+
+    // attempt to get the semaphore value
+    if (semaphore->value)
+    {
+        semaphore->value--;
+        tb_spinlock_leave(&semaphore->lock);
+        return 1;
+    }
+
+    // no waiting?
+    if (!timeout)
+    {
+        tb_spinlock_leave(&semaphore->lock);
+        return 0;
+    }
+
+    // park the plain thread on an event, the lock will be left in it
+    if (!running) return tb_co_semaphore_shared_wait_thread(semaphore, timeout);
+
+    /* the remote coroutines are resumed in the io loop of its scheduler
+     *
+     * we cannot block this worker thread, because the poster may be run on the same scheduler.
+     */
+    if (!tb_co_scheduler_need_remote((tb_co_scheduler_t*)tb_coroutine_scheduler(running)))
+    {
+        tb_spinlock_leave(&semaphore->lock);
+        tb_trace_e("the shared semaphore cannot be waited on the scheduler without io!");
+        return -1;
+    }
+
+    // park the coroutine and resume it from the io loop of its scheduler, the lock will be left in it
+    return tb_co_semaphore_shared_wait_coroutine(semaphore, running, timeout);
+}
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */
 tb_co_semaphore_ref_t tb_co_semaphore_init(tb_size_t value)
+{
+    return tb_co_semaphore_init_with_flags(value, TB_CO_SEMAPHORE_FLAG_NONE);
+}
+tb_co_semaphore_ref_t tb_co_semaphore_init_with_flags(tb_size_t value, tb_size_t flags)
 {
     // done
     tb_bool_t           ok = tb_false;
@@ -71,8 +330,13 @@ tb_co_semaphore_ref_t tb_co_semaphore_init(tb_size_t value)
         // init value
         semaphore->value = value;
 
-        // init waiting coroutines
+        // init waiting coroutines and threads
         tb_single_list_entry_init(&semaphore->waiting, tb_coroutine_t, rs.single_entry, tb_null);
+        tb_single_list_entry_init(&semaphore->waiting_threads, tb_co_semaphore_thread_t, entry, tb_null);
+
+        // init flags and lock
+        semaphore->flags = flags;
+        tb_spinlock_init(&semaphore->lock);
 
         // ok
         ok = tb_true;
@@ -96,11 +360,16 @@ tb_void_t tb_co_semaphore_exit(tb_co_semaphore_ref_t self)
     tb_co_semaphore_t* semaphore = (tb_co_semaphore_t*)self;
     tb_assert_and_check_return(semaphore);
 
-    // check waiting coroutines
+    // check waiting coroutines and threads
     tb_assert(!tb_single_list_entry_size(&semaphore->waiting));
+    tb_assert(!tb_single_list_entry_size(&semaphore->waiting_threads));
 
-    // exit waiting coroutines
+    // exit waiting coroutines and threads
     tb_single_list_entry_exit(&semaphore->waiting);
+    tb_single_list_entry_exit(&semaphore->waiting_threads);
+
+    // exit lock
+    tb_spinlock_exit(&semaphore->lock);
 
     // exit the semaphore
     tb_free(semaphore);
@@ -111,6 +380,13 @@ tb_void_t tb_co_semaphore_post(tb_co_semaphore_ref_t self, tb_size_t post)
     tb_co_semaphore_t* semaphore = (tb_co_semaphore_t*)self;
     tb_assert_and_check_return(semaphore);
 
+    // post the shared semaphore
+    if (semaphore->flags & TB_CO_SEMAPHORE_FLAG_SHARED)
+    {
+        tb_co_semaphore_shared_post(semaphore, post);
+        return ;
+    }
+
     // add the semaphore value
     tb_size_t value = semaphore->value + post;
 
@@ -127,6 +403,9 @@ tb_void_t tb_co_semaphore_post(tb_co_semaphore_ref_t self, tb_size_t post)
         // get the waiting coroutine
         tb_coroutine_ref_t coroutine = (tb_coroutine_ref_t)tb_single_list_entry(&semaphore->waiting, entry);
 
+        // the waiting coroutine must be resumed on the same worker, please use TB_CO_SEMAPHORE_FLAG_SHARED for the different workers
+        tb_assertf(tb_coroutine_scheduler((tb_coroutine_t*)coroutine) == tb_co_scheduler_self(), "the semaphore cannot be posted to the coroutine(%p) on the other worker!", coroutine);
+
         // resume this coroutine
         tb_coroutine_resume(coroutine, (tb_cpointer_t)tb_true);
 
@@ -152,6 +431,10 @@ tb_long_t tb_co_semaphore_wait(tb_co_semaphore_ref_t self, tb_long_t timeout)
     tb_co_semaphore_t* semaphore = (tb_co_semaphore_t*)self;
     tb_assert_and_check_return_val(semaphore, -1);
 
+    // wait the shared semaphore
+    if (semaphore->flags & TB_CO_SEMAPHORE_FLAG_SHARED) 
+        return tb_co_semaphore_shared_wait(semaphore, timeout);
+
     // attempt to get the semaphore value
     tb_long_t ok = 1;
     if (semaphore->value) semaphore->value--;
@@ -162,6 +445,9 @@ tb_long_t tb_co_semaphore_wait(tb_co_semaphore_ref_t self, tb_long_t timeout)
         tb_coroutine_t* running = (tb_coroutine_t*)tb_coroutine_self();
         tb_assert(running);
 
+        // all waiting coroutines must be run on the same worker, please use TB_CO_SEMAPHORE_FLAG_SHARED for the different workers
+        tb_assertf(!tb_single_list_entry_size(&semaphore->waiting) || tb_coroutine_scheduler((tb_coroutine_t*)tb_single_list_entry(&semaphore->waiting, tb_single_list_entry_head(&semaphore->waiting))) == tb_coroutine_scheduler(running), "the semaphore cannot be waited on the different workers!");
+
         // save this coroutine to the waiting coroutines
         tb_single_list_entry_insert_tail(&semaphore->waiting, &running->rs.single_entry);
 
@@ -43,6 +43,20 @@ __tb_extern_c_enter__
 /// the coroutine semaphore ref type
 typedef __tb_typeref__(co_semaphore);
 
+/// the coroutine semaphore flag enum
+typedef enum __tb_co_semaphore_flag_e
+{
+    TB_CO_SEMAPHORE_FLAG_NONE       = 0
+
+    /*! the semaphore can be shared between the different workers of the scheduler and the plain threads
+     *
+     * the waiting coroutine will be parked and resumed in the io loop of its scheduler by the remote wakeup,
+     * and the waiting plain thread will be parked on an event.
+     */
+,   TB_CO_SEMAPHORE_FLAG_SHARED     = 1
+
+}tb_co_semaphore_flag_e;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
@@ -55,6 +69,19 @@ typedef __tb_typeref__(co_semaphore);
  */
 tb_co_semaphore_ref_t   tb_co_semaphore_init(tb_size_t value);
 
+/*! init semaphore with the given flags
+ *
+ * @code
+ * tb_co_semaphore_ref_t semaphore = tb_co_semaphore_init_with_flags(0, TB_CO_SEMAPHORE_FLAG_SHARED);
+ * @endcode
+ *
+ * @param value         the initial semaphore value
+ * @param flags         the semaphore flags, e.g. TB_CO_SEMAPHORE_FLAG_SHARED
+ * 
+ * @return              the semaphore 
+ */
+tb_co_semaphore_ref_t   tb_co_semaphore_init_with_flags(tb_size_t value, tb_size_t flags);
+
 /*! exit semaphore
  * 
  * @return              the semaphore 
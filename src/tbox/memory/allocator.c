@@ -34,11 +34,58 @@
  * includes
  */
 #include "allocator.h"
+#include "heap_profiler.h"
 #include "impl/impl.h"
 #include "../libc/libc.h"
 #include "../utils/utils.h"
 #include "../platform/platform.h"
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the maximum count of the pressure funcs
+#define TB_ALLOCATOR_PRESSURE_MAXN      (16)
+
+// the occupied size will be checked for the soft limit after allocating the given size 
+#ifdef __tb_small__
+#   define TB_ALLOCATOR_PRESSURE_STEP   (64 * 1024)
+#else
+#   define TB_ALLOCATOR_PRESSURE_STEP   (256 * 1024)
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the allocator memory pressure type
+typedef struct __tb_allocator_pressure_t
+{
+    // the soft limit
+    tb_size_t                       limit;
+
+    // is checking the soft limit or raising the pressure? 
+    tb_atomic_t                     busy;
+
+#ifndef __tb_thread_local__
+    // the allocated size after the last checking 
+    tb_atomic_t                     size;
+#endif
+
+    // the lock of the pressure funcs
+    tb_spinlock_t                   lock;
+
+    // the pressure funcs
+    tb_allocator_pressure_func_t    funcs[TB_ALLOCATOR_PRESSURE_MAXN];
+
+    // the private data of the pressure funcs
+    tb_cpointer_t                   privs[TB_ALLOCATOR_PRESSURE_MAXN];
+
+    // the pressure funcs count
+    tb_size_t                       count;
+
+}tb_allocator_pressure_t;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * globals
  */
@@ -46,6 +93,121 @@
 // the allocator 
 __tb_extern_c__ tb_allocator_ref_t  g_allocator = tb_null;
 
+#ifdef __tb_thread_local__
+// the allocated size of the current thread after the last checking of the soft limit
+static __tb_thread_local__ tb_size_t g_allocator_pressure_size = 0;
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_allocator_pressure_t* tb_allocator_pressure_init(tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert(allocator);
+
+    // have been inited?
+    tb_allocator_pressure_t* pressure = (tb_allocator_pressure_t*)allocator->pressure;
+    tb_check_return_val(!pressure, pressure);
+
+    // make pressure, it cannot be allocated from this allocator
+    pressure = (tb_allocator_pressure_t*)tb_native_memory_malloc0(sizeof(tb_allocator_pressure_t));
+    tb_assert_and_check_return_val(pressure, tb_null);
+
+    // init lock
+    tb_spinlock_init(&pressure->lock);
+
+    // save it if it has not been inited by the other thread
+    tb_spinlock_enter(&allocator->lock);
+    if (!allocator->pressure) 
+    {
+        allocator->pressure = (tb_handle_t)pressure;
+        pressure = tb_null;
+    }
+    tb_spinlock_leave(&allocator->lock);
+
+    // exit the unused pressure
+    if (pressure)
+    {
+        tb_spinlock_exit(&pressure->lock);
+        tb_native_memory_free(pressure);
+    }
+
+    // ok
+    return (tb_allocator_pressure_t*)allocator->pressure;
+}
+static tb_void_t tb_allocator_pressure_exit(tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert(allocator);
+
+    // exit pressure
+    tb_allocator_pressure_t* pressure = (tb_allocator_pressure_t*)allocator->pressure;
+    if (pressure)
+    {
+        tb_spinlock_exit(&pressure->lock);
+        tb_native_memory_free(pressure);
+    }
+    allocator->pressure = tb_null;
+}
+static tb_void_t tb_allocator_pressure_done(tb_allocator_ref_t allocator, tb_allocator_pressure_t* pressure, tb_size_t size)
+{
+    // check
+    tb_assert(allocator && pressure);
+
+    // trace
+    tb_trace_d("pressure: %lu bytes over the limit: %lu", size, pressure->limit);
+
+    /* call all pressure funcs 
+     *
+     * we call them with the lock, so the func will not be called after unregistering it
+     */
+    tb_size_t i = 0;
+    tb_spinlock_enter(&pressure->lock);
+    for (i = 0; i < pressure->count; i++) pressure->funcs[i](allocator, size, pressure->privs[i]);
+    tb_spinlock_leave(&pressure->lock);
+
+    // return the freed memory to the system
+    tb_allocator_trim(allocator);
+}
+static tb_void_t tb_allocator_pressure_check(tb_allocator_ref_t allocator, tb_size_t size)
+{
+    // check
+    tb_allocator_pressure_t* pressure = (tb_allocator_pressure_t*)allocator->pressure;
+    tb_assert(pressure);
+
+    // no limit?
+    tb_check_return(pressure->limit);
+
+    // we only check the occupied size after allocating some data, because getting the statistics is slower
+#ifdef __tb_thread_local__
+    g_allocator_pressure_size += size;
+    tb_check_return(g_allocator_pressure_size >= TB_ALLOCATOR_PRESSURE_STEP);
+    g_allocator_pressure_size = 0;
+#else
+    tb_check_return((tb_size_t)tb_atomic_add_and_fetch(&pressure->size, size) >= TB_ALLOCATOR_PRESSURE_STEP);
+    tb_atomic_set0(&pressure->size);
+#endif
+
+    // it is being checked or raised by the other thread? or the pressure funcs are allocating data
+    tb_check_return(!tb_atomic_fetch_and_pset(&pressure->busy, 0, 1));
+
+    // get the occupied size
+    tb_size_t               occupied_size = 0;
+    tb_allocator_stat_t*    stat = (tb_allocator_stat_t*)tb_native_memory_malloc(sizeof(tb_allocator_stat_t));
+    if (stat)
+    {
+        if (tb_allocator_stat(allocator, stat)) occupied_size = stat->occupied_size;
+        tb_native_memory_free(stat);
+    }
+
+    // over the soft limit? raise the pressure
+    if (occupied_size > pressure->limit) tb_allocator_pressure_done(allocator, pressure, occupied_size - pressure->limit);
+
+    // leave
+    tb_atomic_set0(&pressure->busy);
+}
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */
@@ -66,8 +228,9 @@ tb_pointer_t tb_allocator_malloc_(tb_allocator_ref_t allocator, tb_size_t size _
     // check
     tb_assert_and_check_return_val(allocator, tb_null);
 
-    // enter
-    tb_spinlock_enter(&allocator->lock);
+    // enter, the allocator may be thread-safe by itself
+    tb_bool_t lock = !(allocator->flag & TB_ALLOCATOR_FLAG_NOLOCK);
+    if (lock) tb_spinlock_enter(&allocator->lock);
 
     // malloc it
     tb_pointer_t data = tb_null;
@@ -82,7 +245,15 @@ tb_pointer_t tb_allocator_malloc_(tb_allocator_ref_t allocator, tb_size_t size _
     tb_assertf(!(((tb_size_t)data) & (TB_POOL_DATA_ALIGN - 1)), "malloc(%lu): unaligned data: %p", size, data);
 
     // leave
-    tb_spinlock_leave(&allocator->lock);
+    if (lock) tb_spinlock_leave(&allocator->lock);
+
+#ifndef TB_CONFIG_MICRO_ENABLE
+    // sample it for the heap profiler
+    if (allocator->profiler && data) tb_heap_profiler_malloc_(allocator->profiler, data, size);
+#endif
+
+    // check the soft limit
+    if (allocator->pressure && data) tb_allocator_pressure_check(allocator, size);
 
     // ok?
     return data;
@@ -128,8 +299,9 @@ tb_pointer_t tb_allocator_ralloc_(tb_allocator_ref_t allocator, tb_pointer_t dat
     // check
     tb_assert_and_check_return_val(allocator, tb_null);
 
-    // enter
-    tb_spinlock_enter(&allocator->lock);
+    // enter, the allocator may be thread-safe by itself
+    tb_bool_t lock = !(allocator->flag & TB_ALLOCATOR_FLAG_NOLOCK);
+    if (lock) tb_spinlock_enter(&allocator->lock);
 
     // ralloc it
     tb_pointer_t data_new = tb_null;
@@ -158,7 +330,19 @@ tb_pointer_t tb_allocator_ralloc_(tb_allocator_ref_t allocator, tb_pointer_t dat
     tb_assertf(!(((tb_size_t)data_new) & (TB_POOL_DATA_ALIGN - 1)), "ralloc(%lu): unaligned data: %p", size, data);
 
     // leave
-    tb_spinlock_leave(&allocator->lock);
+    if (lock) tb_spinlock_leave(&allocator->lock);
+
+#ifndef TB_CONFIG_MICRO_ENABLE
+    // the old data has been reallocated? remove the sampled old data and sample the new data for the heap profiler
+    if (allocator->profiler && data_new)
+    {
+        if (data) tb_heap_profiler_free_(allocator->profiler, data);
+        tb_heap_profiler_malloc_(allocator->profiler, data_new, size);
+    }
+#endif
+
+    // check the soft limit
+    if (allocator->pressure && data_new) tb_allocator_pressure_check(allocator, size);
 
     // ok?
     return data_new;
@@ -168,8 +352,14 @@ tb_bool_t tb_allocator_free_(tb_allocator_ref_t allocator, tb_pointer_t data __t
     // check
     tb_assert_and_check_return_val(allocator, tb_false);
 
-    // enter
-    tb_spinlock_enter(&allocator->lock);
+#ifndef TB_CONFIG_MICRO_ENABLE
+    // remove the sampled data from the heap profiler before it can be reused by the other threads
+    if (allocator->profiler && data) tb_heap_profiler_free_(allocator->profiler, data);
+#endif
+
+    // enter, the allocator may be thread-safe by itself
+    tb_bool_t lock = !(allocator->flag & TB_ALLOCATOR_FLAG_NOLOCK);
+    if (lock) tb_spinlock_enter(&allocator->lock);
 
     // trace
     tb_trace_d("free(%p): at %s(): %d, %s", data __tb_debug_args__);
@@ -195,7 +385,7 @@ tb_bool_t tb_allocator_free_(tb_allocator_ref_t allocator, tb_pointer_t data __t
 #endif
 
     // leave
-    tb_spinlock_leave(&allocator->lock);
+    if (lock) tb_spinlock_leave(&allocator->lock);
 
     // ok?
     return ok;
@@ -205,8 +395,9 @@ tb_pointer_t tb_allocator_large_malloc_(tb_allocator_ref_t allocator, tb_size_t
     // check
     tb_assert_and_check_return_val(allocator, tb_null);
 
-    // enter
-    tb_spinlock_enter(&allocator->lock);
+    // enter, the allocator may be thread-safe by itself
+    tb_bool_t lock = !(allocator->flag & TB_ALLOCATOR_FLAG_NOLOCK);
+    if (lock) tb_spinlock_enter(&allocator->lock);
 
     // malloc it
     tb_pointer_t data = tb_null;
@@ -227,7 +418,15 @@ tb_pointer_t tb_allocator_large_malloc_(tb_allocator_ref_t allocator, tb_size_t
     tb_assert(!real || *real >= size);
 
     // leave
-    tb_spinlock_leave(&allocator->lock);
+    if (lock) tb_spinlock_leave(&allocator->lock);
+
+#ifndef TB_CONFIG_MICRO_ENABLE
+    // sample it for the heap profiler
+    if (allocator->profiler && data) tb_heap_profiler_malloc_(allocator->profiler, data, size);
+#endif
+
+    // check the soft limit
+    if (allocator->pressure && data) tb_allocator_pressure_check(allocator, size);
 
     // ok?
     return data;
@@ -273,8 +472,9 @@ tb_pointer_t tb_allocator_large_ralloc_(tb_allocator_ref_t allocator, tb_pointer
     // check
     tb_assert_and_check_return_val(allocator, tb_null);
 
-    // enter
-    tb_spinlock_enter(&allocator->lock);
+    // enter, the allocator may be thread-safe by itself
+    tb_bool_t lock = !(allocator->flag & TB_ALLOCATOR_FLAG_NOLOCK);
+    if (lock) tb_spinlock_enter(&allocator->lock);
 
     // ralloc it
     tb_pointer_t data_new = tb_null;
@@ -309,7 +509,19 @@ tb_pointer_t tb_allocator_large_ralloc_(tb_allocator_ref_t allocator, tb_pointer
     tb_assertf(!(((tb_size_t)data_new) & (TB_POOL_DATA_ALIGN - 1)), "ralloc(%lu): unaligned data: %p", size, data);
 
     // leave
-    tb_spinlock_leave(&allocator->lock);
+    if (lock) tb_spinlock_leave(&allocator->lock);
+
+#ifndef TB_CONFIG_MICRO_ENABLE
+    // the old data has been reallocated? remove the sampled old data and sample the new data for the heap profiler
+    if (allocator->profiler && data_new)
+    {
+        if (data) tb_heap_profiler_free_(allocator->profiler, data);
+        tb_heap_profiler_malloc_(allocator->profiler, data_new, size);
+    }
+#endif
+
+    // check the soft limit
+    if (allocator->pressure && data_new) tb_allocator_pressure_check(allocator, size);
 
     // ok?
     return data_new;
@@ -319,8 +531,14 @@ tb_bool_t tb_allocator_large_free_(tb_allocator_ref_t allocator, tb_pointer_t da
     // check
     tb_assert_and_check_return_val(allocator, tb_false);
 
-    // enter
-    tb_spinlock_enter(&allocator->lock);
+#ifndef TB_CONFIG_MICRO_ENABLE
+    // remove the sampled data from the heap profiler before it can be reused by the other threads
+    if (allocator->profiler && data) tb_heap_profiler_free_(allocator->profiler, data);
+#endif
+
+    // enter, the allocator may be thread-safe by itself
+    tb_bool_t lock = !(allocator->flag & TB_ALLOCATOR_FLAG_NOLOCK);
+    if (lock) tb_spinlock_enter(&allocator->lock);
 
     // trace
     tb_trace_d("large_free(%p): at %s(): %d, %s", data __tb_debug_args__);
@@ -346,7 +564,7 @@ tb_bool_t tb_allocator_large_free_(tb_allocator_ref_t allocator, tb_pointer_t da
 #endif
 
     // leave
-    tb_spinlock_leave(&allocator->lock);
+    if (lock) tb_spinlock_leave(&allocator->lock);
 
     // ok?
     return ok;
@@ -466,6 +684,164 @@ tb_bool_t tb_allocator_align_free_(tb_allocator_ref_t allocator, tb_pointer_t da
     // free it
     return tb_allocator_free_(allocator, data __tb_debug_args__);
 }
+tb_bool_t tb_allocator_stat(tb_allocator_ref_t allocator, tb_allocator_stat_t* stat)
+{
+    // check
+    tb_assert_and_check_return_val(allocator && stat, tb_false);
+
+    // clear it first
+    tb_memset_(stat, 0, sizeof(tb_allocator_stat_t));
+
+    // enter
+    tb_spinlock_enter(&allocator->lock);
+
+    // get it
+    tb_bool_t ok = allocator->stat? allocator->stat(allocator, stat) : tb_false;
+
+    // leave
+    tb_spinlock_leave(&allocator->lock);
+
+    // ok?
+    return ok;
+}
+tb_void_t tb_allocator_trim(tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert_and_check_return(allocator);
+
+    // enter
+    tb_spinlock_enter(&allocator->lock);
+
+    // trim it
+    if (allocator->trim) allocator->trim(allocator);
+
+    // leave
+    tb_spinlock_leave(&allocator->lock);
+}
+tb_bool_t tb_allocator_limit_set(tb_allocator_ref_t allocator, tb_size_t limit)
+{
+    // check
+    tb_assert_and_check_return_val(allocator, tb_false);
+
+    // init pressure
+    tb_allocator_pressure_t* pressure = tb_allocator_pressure_init(allocator);
+    tb_assert_and_check_return_val(pressure, tb_false);
+
+    // save the soft limit
+    pressure->limit = limit;
+
+    // ok
+    return tb_true;
+}
+tb_size_t tb_allocator_limit(tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert_and_check_return_val(allocator, 0);
+
+    // get the soft limit
+    tb_allocator_pressure_t* pressure = (tb_allocator_pressure_t*)allocator->pressure;
+    return pressure? pressure->limit : 0;
+}
+tb_bool_t tb_allocator_pressure_register(tb_allocator_ref_t allocator, tb_allocator_pressure_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_assert_and_check_return_val(allocator && func, tb_false);
+
+    // init pressure
+    tb_allocator_pressure_t* pressure = tb_allocator_pressure_init(allocator);
+    tb_assert_and_check_return_val(pressure, tb_false);
+
+    // enter
+    tb_spinlock_enter(&pressure->lock);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // have been registered?
+        tb_size_t i = 0;
+        for (i = 0; i < pressure->count; i++)
+        {
+            if (pressure->funcs[i] == func && pressure->privs[i] == priv) break;
+        }
+        if (i < pressure->count)
+        {
+            ok = tb_true;
+            break;
+        }
+
+        // full?
+        tb_assertf_and_check_break(pressure->count < TB_ALLOCATOR_PRESSURE_MAXN, "too many pressure funcs!");
+
+        // register it
+        pressure->funcs[pressure->count] = func;
+        pressure->privs[pressure->count] = priv;
+        pressure->count++;
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // leave
+    tb_spinlock_leave(&pressure->lock);
+
+    // ok?
+    return ok;
+}
+tb_void_t tb_allocator_pressure_unregister(tb_allocator_ref_t allocator, tb_allocator_pressure_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_assert_and_check_return(allocator && func);
+
+    // no pressure?
+    tb_allocator_pressure_t* pressure = (tb_allocator_pressure_t*)allocator->pressure;
+    tb_check_return(pressure);
+
+    // enter
+    tb_spinlock_enter(&pressure->lock);
+
+    // remove it
+    tb_size_t i = 0;
+    for (i = 0; i < pressure->count; i++)
+    {
+        if (pressure->funcs[i] == func && pressure->privs[i] == priv)
+        {
+            pressure->count--;
+            for (; i < pressure->count; i++)
+            {
+                pressure->funcs[i] = pressure->funcs[i + 1];
+                pressure->privs[i] = pressure->privs[i + 1];
+            }
+            break;
+        }
+    }
+
+    // leave
+    tb_spinlock_leave(&pressure->lock);
+}
+tb_void_t tb_allocator_pressure(tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert_and_check_return(allocator);
+
+    // no pressure funcs? only trim it
+    tb_allocator_pressure_t* pressure = (tb_allocator_pressure_t*)allocator->pressure;
+    if (!pressure) 
+    {
+        tb_allocator_trim(allocator);
+        return ;
+    }
+
+    // it is being raised by the other thread?
+    tb_check_return(!tb_atomic_fetch_and_pset(&pressure->busy, 0, 1));
+
+    // raise it
+    tb_allocator_pressure_done(allocator, pressure, 0);
+
+    // leave
+    tb_atomic_set0(&pressure->busy);
+}
 tb_void_t tb_allocator_clear(tb_allocator_ref_t allocator)
 {
     // check
@@ -488,6 +864,9 @@ tb_void_t tb_allocator_exit(tb_allocator_ref_t allocator)
     // clear it first
     tb_allocator_clear(allocator);
 
+    // exit pressure
+    tb_allocator_pressure_exit(allocator);
+
     // exit it
     if (allocator->exit) allocator->exit(allocator);
 }
@@ -80,15 +80,79 @@ typedef enum __tb_allocator_type_e
 ,   TB_ALLOCATOR_STATIC     = 4
 ,   TB_ALLOCATOR_LARGE      = 5
 ,   TB_ALLOCATOR_SMALL      = 6
+,   TB_ALLOCATOR_ARENA      = 7
 
 }tb_allocator_type_e;
 
+/// the allocator flag enum
+typedef enum __tb_allocator_flag_e
+{
+    TB_ALLOCATOR_FLAG_NONE      = 0
+,   TB_ALLOCATOR_FLAG_NOLOCK    = 1 //!< the allocator is thread-safe by itself, so we need not lock it for malloc, ralloc and free 
+
+}tb_allocator_flag_e;
+
+/// the maximum count of the size classes in the allocator statistics
+#define TB_ALLOCATOR_STAT_CLASS_MAXN    (64)
+
+/// the size class statistics type of the allocator
+typedef struct __tb_allocator_class_stat_t
+{
+    /// the data space of this size class
+    tb_size_t               space;
+
+    /// the live data count, including the data cached by the thread caches
+    tb_size_t               live_count;
+
+    /// the data count which is cached by the thread caches
+    tb_size_t               cached_count;
+
+    /// the occupied size of all slots for this size class
+    tb_size_t               occupied_size;
+
+}tb_allocator_class_stat_t;
+
+/// the allocator statistics type
+typedef struct __tb_allocator_stat_t
+{
+    /// the malloc count
+    tb_size_t               malloc_count;
+
+    /// the ralloc count
+    tb_size_t               ralloc_count;
+
+    /// the free count
+    tb_size_t               free_count;
+
+    /// the live data count
+    tb_size_t               live_count;
+
+    /// the live data size, the small data is counted by the space of its size class
+    tb_size_t               live_size;
+
+    /// the peak live data size
+    tb_size_t               peak_size;
+
+    /// the occupied size which is allocated from the parent allocator or the system
+    tb_size_t               occupied_size;
+
+    /// the size classes count
+    tb_size_t               class_count;
+
+    /// the size classes
+    tb_allocator_class_stat_t classes[TB_ALLOCATOR_STAT_CLASS_MAXN];
+
+}tb_allocator_stat_t;
+
 /// the allocator type
 typedef struct __tb_allocator_t
 {
     /// the type
     tb_size_t               type;
 
+    /// the flag
+    tb_size_t               flag;
+
     /// the lock
     tb_spinlock_t           lock;
 
@@ -162,6 +226,29 @@ typedef struct __tb_allocator_t
      */
     tb_void_t               (*exit)(struct __tb_allocator_t* allocator);
 
+    /*! get the statistics of the allocator
+     *
+     * @param allocator     the allocator 
+     * @param stat          the statistics, it has been cleared
+     *
+     * @return              tb_true or tb_false
+     */
+    tb_bool_t               (*stat)(struct __tb_allocator_t* allocator, tb_allocator_stat_t* stat);
+
+    /*! trim allocator, return the cached free memory to the parent allocator or the system
+     *
+     * @param allocator     the allocator 
+     */
+    tb_void_t               (*trim)(struct __tb_allocator_t* allocator);
+
+#ifndef TB_CONFIG_MICRO_ENABLE
+    /// the heap profiler, only for tb_heap_profiler_start()
+    tb_handle_t             profiler;
+#endif
+
+    /// the memory pressure, only for tb_allocator_limit_set() and tb_allocator_pressure_register()
+    tb_handle_t             pressure;
+
 #ifdef __tb_debug__
     /*! dump allocator
      *
@@ -181,6 +268,20 @@ typedef struct __tb_allocator_t
 
 }tb_allocator_t, *tb_allocator_ref_t;
 
+/*! the memory pressure func type
+ *
+ * the cache can release its items in this func for reducing the memory usage,
+ * but it cannot register or unregister the pressure func in this func.
+ *
+ * @note this func may be called when allocating data in any thread, 
+ * so it should only try to enter the lock of the cache, because the lock may have been entered by the current thread.
+ *
+ * @param allocator     the allocator
+ * @param size          the occupied size over the soft limit, it is zero if the pressure is raised by tb_allocator_pressure()
+ * @param priv          the user private data
+ */
+typedef tb_void_t       (*tb_allocator_pressure_func_t)(tb_allocator_ref_t allocator, tb_size_t size, tb_cpointer_t priv);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
@@ -207,6 +308,30 @@ tb_allocator_ref_t      tb_allocator_native(tb_noarg_t);
  */
 tb_size_t               tb_allocator_type(tb_allocator_ref_t allocator);
 
+/*! get the statistics of the allocator
+ *
+ * it is available in the release mode and the counters are only a snapshot 
+ * if the allocator is being accessed by the other threads.
+ *
+ * @code
+    tb_allocator_stat_t stat;
+    if (tb_allocator_stat(tb_allocator(), &stat))
+    {
+        tb_trace_i("live: %lu bytes, peak: %lu bytes, occupied: %lu bytes", stat.live_size, stat.peak_size, stat.occupied_size);
+
+        tb_size_t i = 0;
+        for (i = 0; i < stat.class_count; i++)
+            tb_trace_i("class[%lu]: live: %lu", stat.classes[i].space, stat.classes[i].live_count);
+    }
+ * @endcode
+ *
+ * @param allocator     the allocator 
+ * @param stat          the statistics
+ *
+ * @return              tb_true or tb_false if the allocator does not support it
+ */
+tb_bool_t               tb_allocator_stat(tb_allocator_ref_t allocator, tb_allocator_stat_t* stat);
+
 /*! malloc data
  *
  * @param allocator     the allocator 
@@ -387,6 +512,73 @@ tb_pointer_t            tb_allocator_align_ralloc_(tb_allocator_ref_t allocator,
  */
 tb_bool_t               tb_allocator_align_free_(tb_allocator_ref_t allocator, tb_pointer_t data __tb_debug_decl__);
 
+/*! trim it, return the cached free memory to the parent allocator or the system
+ *
+ * .e.g the empty slots of the fixed pools, the data cached by the thread caches and the idle regions
+ *
+ * @param allocator     the allocator 
+ */
+tb_void_t               tb_allocator_trim(tb_allocator_ref_t allocator);
+
+/*! set the soft limit of the occupied size 
+ *
+ * the occupied size will be checked after allocating some data, 
+ * all pressure funcs will be called and the allocator will be trimmed if it is over the soft limit.
+ *
+ * @code
+    static tb_void_t tb_demo_pressure(tb_allocator_ref_t allocator, tb_size_t size, tb_cpointer_t priv)
+    {
+        // release some cached items
+        tb_demo_cache_shrink((tb_demo_cache_ref_t)priv, size);
+    }
+
+    tb_allocator_pressure_register(tb_allocator(), tb_demo_pressure, cache);
+    tb_allocator_limit_set(tb_allocator(), 256 * 1024 * 1024);
+ * @endcode
+ *
+ * @param allocator     the allocator 
+ * @param limit         the soft limit, no limit if be zero
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_allocator_limit_set(tb_allocator_ref_t allocator, tb_size_t limit);
+
+/*! get the soft limit of the occupied size 
+ *
+ * @param allocator     the allocator 
+ *
+ * @return              the soft limit, no limit if be zero
+ */
+tb_size_t               tb_allocator_limit(tb_allocator_ref_t allocator);
+
+/*! register the memory pressure func
+ *
+ * @param allocator     the allocator 
+ * @param func          the pressure func
+ * @param priv          the user private data
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_allocator_pressure_register(tb_allocator_ref_t allocator, tb_allocator_pressure_func_t func, tb_cpointer_t priv);
+
+/*! unregister the memory pressure func
+ *
+ * the func will not be called after returning from this interface
+ *
+ * @param allocator     the allocator 
+ * @param func          the pressure func
+ * @param priv          the user private data
+ */
+tb_void_t               tb_allocator_pressure_unregister(tb_allocator_ref_t allocator, tb_allocator_pressure_func_t func, tb_cpointer_t priv);
+
+/*! raise the memory pressure, call all pressure funcs and trim the allocator 
+ *
+ * it can be called when the system is low on memory, .e.g the cgroup memory.high event
+ *
+ * @param allocator     the allocator 
+ */
+tb_void_t               tb_allocator_pressure(tb_allocator_ref_t allocator);
+
 /*! clear it
  *
  * @param allocator     the allocator 
@@ -0,0 +1,681 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        arena_allocator.c
+ * @ingroup     memory
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "arena_allocator"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "arena_allocator.h"
+#include "impl/prefix.h"
+#include "../container/list_entry.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the default chunk size
+#ifdef __tb_small__
+#   define TB_ARENA_ALLOCATOR_CHUNK_SIZE        (16 * 1024)
+#else
+#   define TB_ARENA_ALLOCATOR_CHUNK_SIZE        (64 * 1024)
+#endif
+
+// the minimum chunk size
+#define TB_ARENA_ALLOCATOR_CHUNK_MINN           (1024)
+
+// the data head of the given data
+#define tb_arena_allocator_data_head(data)      (&(((tb_pool_data_head_t*)(data))[-1]))
+
+// the large data head of the given data head
+#define tb_arena_allocator_large_head(head)     (&(((tb_arena_allocator_large_t*)(head))[-1]))
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the arena allocator chunk type
+typedef __tb_pool_data_aligned__ struct __tb_arena_allocator_chunk_t
+{
+    // the next chunk
+    struct __tb_arena_allocator_chunk_t*    next;
+
+    // the data size of this chunk
+    tb_size_t                               size;
+
+}__tb_pool_data_aligned__ tb_arena_allocator_chunk_t;
+
+// the arena allocator large data type
+typedef __tb_pool_data_aligned__ struct __tb_arena_allocator_large_t
+{
+    // the list entry
+    tb_list_entry_t                         entry;
+
+    // the large data id, it is increased for savepoints
+    tb_size_t                               id;
+
+}__tb_pool_data_aligned__ tb_arena_allocator_large_t;
+
+// the arena allocator type
+typedef struct __tb_arena_allocator_t
+{
+    // the base
+    tb_allocator_t                          base;
+
+    // the large allocator
+    tb_allocator_ref_t                      large_allocator;
+
+    // the chunk size
+    tb_size_t                               chunk_size;
+
+    // the maximum data size in chunk, the larger data will be allocated from the large allocator directly
+    tb_size_t                               large_size;
+
+    // the chunks
+    tb_arena_allocator_chunk_t*             chunks;
+
+    // the current chunk
+    tb_arena_allocator_chunk_t*             chunk;
+
+    // the current data position of the current chunk
+    tb_byte_t*                              cursor;
+
+    // the tail of the current chunk
+    tb_byte_t*                              tail;
+
+    // the last data head of the current chunk, it can be resized or freed in place
+    tb_pool_data_head_t*                    last;
+
+    // the large data list
+    tb_list_entry_head_t                    large_list;
+
+    // the large data count
+    tb_size_t                               large_count;
+
+    // the malloc count
+    tb_size_t                               malloc_count;
+
+    // the ralloc count
+    tb_size_t                               ralloc_count;
+
+    // the free count
+    tb_size_t                               free_count;
+
+#ifdef __tb_debug__
+    // the clear count
+    tb_size_t                               clear_count;
+#endif
+
+}tb_arena_allocator_t, *tb_arena_allocator_ref_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_bool_t tb_arena_allocator_chunk_next(tb_arena_allocator_ref_t allocator)
+{
+    // check
+    tb_assert(allocator && allocator->large_allocator);
+
+    // reuse the next chunk which has been cleared
+    tb_arena_allocator_chunk_t* chunk = allocator->chunk? allocator->chunk->next : allocator->chunks;
+    if (!chunk)
+    {
+        // make a new chunk
+        tb_size_t real = 0;
+        chunk = (tb_arena_allocator_chunk_t*)tb_allocator_large_malloc(allocator->large_allocator, sizeof(tb_arena_allocator_chunk_t) + allocator->chunk_size, &real);
+        tb_assert_and_check_return_val(chunk, tb_false);
+
+        // init chunk
+        chunk->next = tb_null;
+        chunk->size = real - sizeof(tb_arena_allocator_chunk_t);
+
+        // append it
+        if (allocator->chunk) allocator->chunk->next = chunk;
+        else allocator->chunks = chunk;
+    }
+
+    // switch to this chunk
+    allocator->chunk    = chunk;
+    allocator->cursor   = (tb_byte_t*)&chunk[1];
+    allocator->tail     = allocator->cursor + chunk->size;
+    allocator->last     = tb_null;
+
+    // ok
+    return tb_true;
+}
+static tb_pointer_t tb_arena_allocator_large_malloc(tb_arena_allocator_ref_t allocator, tb_size_t size __tb_debug_decl__)
+{
+    // check
+    tb_assert(allocator && allocator->large_allocator);
+
+    // make data
+    tb_arena_allocator_large_t* large = (tb_arena_allocator_large_t*)tb_allocator_large_malloc_(allocator->large_allocator, sizeof(tb_arena_allocator_large_t) + sizeof(tb_pool_data_head_t) + size, tb_null __tb_debug_args__);
+    tb_assert_and_check_return_val(large, tb_null);
+
+    // save it
+    large->id = allocator->large_count++;
+    tb_list_entry_insert_tail(&allocator->large_list, &large->entry);
+
+    // ok
+    return (tb_pointer_t)&large[1];
+}
+static tb_pointer_t tb_arena_allocator_large_ralloc(tb_arena_allocator_ref_t allocator, tb_pool_data_head_t* data_head, tb_size_t size __tb_debug_decl__)
+{
+    // check
+    tb_assert(allocator && allocator->large_allocator && data_head);
+
+    // remove it from the list first, it may be moved
+    tb_arena_allocator_large_t* large = tb_arena_allocator_large_head(data_head);
+    tb_list_entry_ref_t         prev = large->entry.prev;
+    tb_list_entry_remove(&allocator->large_list, &large->entry);
+
+    // ralloc data
+    tb_arena_allocator_large_t* large_new = (tb_arena_allocator_large_t*)tb_allocator_large_ralloc_(allocator->large_allocator, large, sizeof(tb_arena_allocator_large_t) + sizeof(tb_pool_data_head_t) + size, tb_null __tb_debug_args__);
+
+    // insert it to the original position and keep the order for savepoints
+    if (large_new) tb_list_entry_insert_next(&allocator->large_list, prev, &large_new->entry);
+    else tb_list_entry_insert_next(&allocator->large_list, prev, &large->entry);
+
+    // ok?
+    return large_new? (tb_pointer_t)&large_new[1] : tb_null;
+}
+static tb_void_t tb_arena_allocator_large_free(tb_arena_allocator_ref_t allocator, tb_pool_data_head_t* data_head)
+{
+    // check
+    tb_assert(allocator && allocator->large_allocator && data_head);
+
+    // remove it
+    tb_arena_allocator_large_t* large = tb_arena_allocator_large_head(data_head);
+    tb_list_entry_remove(&allocator->large_list, &large->entry);
+
+    // free it
+    tb_allocator_large_free(allocator->large_allocator, large);
+}
+static tb_void_t tb_arena_allocator_large_clear(tb_arena_allocator_ref_t allocator, tb_size_t id)
+{
+    // check
+    tb_assert(allocator && allocator->large_allocator);
+
+    // free all large data which have been allocated after the given id
+    while (!tb_list_entry_is_null(&allocator->large_list))
+    {
+        // the last large data
+        tb_arena_allocator_large_t* large = (tb_arena_allocator_large_t*)tb_list_entry(&allocator->large_list, tb_list_entry_last(&allocator->large_list));
+        tb_check_break(large->id >= id);
+
+        // free it
+        tb_list_entry_remove_last(&allocator->large_list);
+        tb_allocator_large_free(allocator->large_allocator, large);
+    }
+
+    // update the large data count
+    allocator->large_count = id;
+}
+static tb_pointer_t tb_arena_allocator_malloc(tb_allocator_ref_t self, tb_size_t size __tb_debug_decl__)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && size, tb_null);
+
+    // done
+    tb_pool_data_head_t* data_head = tb_null;
+    if (size <= allocator->large_size)
+    {
+        // no enough space in the current chunk? goto the next chunk
+        tb_size_t need = sizeof(tb_pool_data_head_t) + tb_align(size, TB_POOL_DATA_ALIGN);
+        if ((tb_size_t)(allocator->tail - allocator->cursor) < need && !tb_arena_allocator_chunk_next(allocator)) return tb_null;
+
+        // bump the cursor
+        data_head           = (tb_pool_data_head_t*)allocator->cursor;
+        allocator->cursor  += need;
+        allocator->last     = data_head;
+    }
+    // allocate the large data directly
+    else data_head = (tb_pool_data_head_t*)tb_arena_allocator_large_malloc(allocator, size __tb_debug_args__);
+    tb_check_return_val(data_head, tb_null);
+
+    // init the data head
+    data_head->size = size;
+
+#ifdef __tb_debug__
+    data_head->debug.magic     = TB_POOL_DATA_MAGIC;
+    data_head->debug.file      = file_;
+    data_head->debug.func      = func_;
+    data_head->debug.line      = (tb_uint16_t)line_;
+
+    // save backtrace
+    tb_pool_data_save_backtrace(&data_head->debug, 3);
+#endif
+
+    // update the statistics
+    allocator->malloc_count++;
+
+    // ok
+    return (tb_pointer_t)&data_head[1];
+}
+static tb_bool_t tb_arena_allocator_free(tb_allocator_ref_t self, tb_pointer_t data __tb_debug_decl__)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && data, tb_false);
+
+    // the data head
+    tb_pool_data_head_t* data_head = tb_arena_allocator_data_head(data);
+
+#ifdef __tb_debug__
+    // check it
+    tb_assertf_and_check_return_val(data_head->debug.magic != (tb_uint16_t)~TB_POOL_DATA_MAGIC, tb_false, "double free data: %p", data);
+    tb_assertf_and_check_return_val(data_head->debug.magic == TB_POOL_DATA_MAGIC, tb_false, "free invalid data: %p", data);
+
+    // mark it as freed
+    data_head->debug.magic = (tb_uint16_t)~TB_POOL_DATA_MAGIC;
+#endif
+
+    // update the statistics
+    allocator->free_count++;
+
+    // free the large data directly
+    if (data_head->size > allocator->large_size) tb_arena_allocator_large_free(allocator, data_head);
+    // rewind the cursor if it is the last data, the others will be released after clearing
+    else if (data_head == allocator->last)
+    {
+        allocator->cursor   = (tb_byte_t*)data_head;
+        allocator->last     = tb_null;
+    }
+
+    // ok
+    return tb_true;
+}
+static tb_pointer_t tb_arena_allocator_ralloc(tb_allocator_ref_t self, tb_pointer_t data, tb_size_t size __tb_debug_decl__)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && data && size, tb_null);
+
+    // the data head
+    tb_pool_data_head_t* data_head = tb_arena_allocator_data_head(data);
+    tb_size_t            data_size = data_head->size;
+
+#ifdef __tb_debug__
+    // check it
+    tb_assertf_and_check_return_val(data_head->debug.magic != (tb_uint16_t)~TB_POOL_DATA_MAGIC, tb_null, "ralloc freed data: %p", data);
+    tb_assertf_and_check_return_val(data_head->debug.magic == TB_POOL_DATA_MAGIC, tb_null, "ralloc invalid data: %p", data);
+#endif
+
+    // done
+    tb_pool_data_head_t* data_head_new = tb_null;
+    if (data_size > allocator->large_size && size > allocator->large_size)
+    {
+        // ralloc the large data directly
+        tb_pointer_t data_new = tb_arena_allocator_large_ralloc(allocator, data_head, size __tb_debug_args__);
+        tb_check_return_val(data_new, tb_null);
+
+        // the new data head
+        data_head_new = (tb_pool_data_head_t*)data_new;
+    }
+    else if (data_head == allocator->last && size <= allocator->large_size && (tb_size_t)(allocator->tail - (tb_byte_t*)data) >= tb_align(size, TB_POOL_DATA_ALIGN))
+    {
+        // resize the last data in place
+        allocator->cursor = (tb_byte_t*)data + tb_align(size, TB_POOL_DATA_ALIGN);
+        data_head_new = data_head;
+    }
+    else
+    {
+        // make the new data
+        tb_pointer_t data_new = tb_arena_allocator_malloc(self, size __tb_debug_args__);
+        tb_check_return_val(data_new, tb_null);
+
+        // copy data
+        tb_memcpy(data_new, data, tb_min(data_size, size));
+
+        // free the old data
+        tb_arena_allocator_free(self, data __tb_debug_args__);
+
+        // ok
+        return data_new;
+    }
+
+    // update the data size
+    data_head_new->size = size;
+
+#ifdef __tb_debug__
+    data_head_new->debug.file      = file_;
+    data_head_new->debug.func      = func_;
+    data_head_new->debug.line      = (tb_uint16_t)line_;
+#endif
+
+    // update the statistics
+    allocator->ralloc_count++;
+
+    // ok
+    return (tb_pointer_t)&data_head_new[1];
+}
+static tb_void_t tb_arena_allocator_clear(tb_allocator_ref_t self)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator);
+
+    // free all large data
+    tb_arena_allocator_large_clear(allocator, 0);
+
+    // rewind to the first chunk, all chunks will be reused
+    allocator->chunk    = tb_null;
+    allocator->cursor   = tb_null;
+    allocator->tail     = tb_null;
+    allocator->last     = tb_null;
+
+#ifdef __tb_debug__
+    // update the statistics
+    allocator->clear_count++;
+#endif
+}
+static tb_void_t tb_arena_allocator_trim(tb_allocator_ref_t self)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator && allocator->large_allocator);
+
+    // the unused chunks after the current chunk, they have been cleared
+    tb_arena_allocator_chunk_t* chunk = allocator->chunk? allocator->chunk->next : allocator->chunks;
+
+    // detach them
+    if (allocator->chunk) allocator->chunk->next = tb_null;
+    else allocator->chunks = tb_null;
+
+    // free them
+    while (chunk)
+    {
+        // save the next chunk
+        tb_arena_allocator_chunk_t* next = chunk->next;
+
+        // free it
+        tb_allocator_large_free(allocator->large_allocator, chunk);
+
+        // next
+        chunk = next;
+    }
+}
+static tb_bool_t tb_arena_allocator_stat(tb_allocator_ref_t self, tb_allocator_stat_t* stat)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && stat, tb_false);
+
+    // the used size and the whole size of all chunks
+    tb_size_t                   used_size = 0;
+    tb_size_t                   chunk_size = 0;
+    tb_bool_t                   chunk_used = allocator->chunk? tb_true : tb_false;
+    tb_arena_allocator_chunk_t* chunk = allocator->chunks;
+    for (; chunk; chunk = chunk->next)
+    {
+        // the used chunk?
+        if (chunk_used) 
+        {
+            if (chunk == allocator->chunk)
+            {
+                used_size += allocator->cursor - (tb_byte_t*)&chunk[1];
+                chunk_used = tb_false;
+            }
+            else used_size += chunk->size;
+        }
+        chunk_size += sizeof(tb_arena_allocator_chunk_t) + chunk->size;
+    }
+
+    // the size of all large data
+    tb_size_t large_size = 0;
+    tb_for_all_if (tb_arena_allocator_large_t*, large, tb_list_entry_itor(&allocator->large_list), large)
+    {
+        large_size += sizeof(tb_arena_allocator_large_t) + sizeof(tb_pool_data_head_t) + ((tb_pool_data_head_t*)&large[1])->size;
+    }
+
+    /* save the statistics
+     *
+     * the data are reclaimed in bulk after clearing or restoring it, so we do not know the live data count,
+     * and all chunks are kept until trimming or exiting it, so the peak size is the size of all chunks.
+     */
+    stat->malloc_count  = allocator->malloc_count;
+    stat->ralloc_count  = allocator->ralloc_count;
+    stat->free_count    = allocator->free_count;
+    stat->live_size     = used_size + large_size;
+    stat->peak_size     = chunk_size + large_size;
+    stat->occupied_size = chunk_size + large_size;
+
+    // ok
+    return tb_true;
+}
+static tb_void_t tb_arena_allocator_exit(tb_allocator_ref_t self)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator && allocator->large_allocator);
+
+    // clear it
+    tb_arena_allocator_clear(self);
+
+    // exit chunks
+    tb_arena_allocator_chunk_t* chunk = allocator->chunks;
+    while (chunk)
+    {
+        // save the next chunk
+        tb_arena_allocator_chunk_t* next = chunk->next;
+
+        // exit it
+        tb_allocator_large_free(allocator->large_allocator, chunk);
+
+        // next
+        chunk = next;
+    }
+    allocator->chunks = tb_null;
+
+    // exit lock
+    tb_spinlock_exit(&allocator->base.lock);
+
+    // exit it
+    tb_allocator_large_free(allocator->large_allocator, allocator);
+}
+#ifdef __tb_debug__
+static tb_void_t tb_arena_allocator_dump(tb_allocator_ref_t self)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator);
+
+    // the chunks count and the used size
+    tb_size_t                   used_size = 0;
+    tb_size_t                   chunk_count = 0;
+    tb_bool_t                   chunk_used = allocator->chunk? tb_true : tb_false;
+    tb_arena_allocator_chunk_t* chunk = allocator->chunks;
+    for (; chunk; chunk = chunk->next)
+    {
+        // the used chunk?
+        if (chunk_used) 
+        {
+            if (chunk == allocator->chunk)
+            {
+                used_size += allocator->cursor - (tb_byte_t*)&chunk[1];
+                chunk_used = tb_false;
+            }
+            else used_size += chunk->size;
+        }
+        chunk_count++;
+    }
+
+    // trace
+    tb_trace_i("");
+    tb_trace_i("chunk_size: %lu", allocator->chunk_size);
+    tb_trace_i("chunk_count: %lu", chunk_count);
+    tb_trace_i("used_size: %lu", used_size);
+    tb_trace_i("large_count: %lu", tb_list_entry_size(&allocator->large_list));
+    tb_trace_i("malloc_count: %lu", allocator->malloc_count);
+    tb_trace_i("ralloc_count: %lu", allocator->ralloc_count);
+    tb_trace_i("free_count: %lu", allocator->free_count);
+    tb_trace_i("clear_count: %lu", allocator->clear_count);
+}
+static tb_bool_t tb_arena_allocator_have(tb_allocator_ref_t self, tb_cpointer_t data)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator, tb_false);
+
+    // have it in the used chunks?
+    tb_arena_allocator_chunk_t* chunk = allocator->chunk? allocator->chunks : tb_null;
+    while (chunk)
+    {
+        // the data range of this chunk
+        tb_byte_t const* head = (tb_byte_t const*)&chunk[1];
+        tb_byte_t const* tail = chunk == allocator->chunk? allocator->cursor : head + chunk->size;
+        if ((tb_byte_t const*)data > head && (tb_byte_t const*)data < tail) return tb_true;
+
+        // end?
+        tb_check_break(chunk != allocator->chunk);
+        chunk = chunk->next;
+    }
+
+    // have it in the large data?
+    tb_list_entry_ref_t entry = tb_list_entry_head(&allocator->large_list);
+    tb_list_entry_ref_t last = tb_list_entry_tail(&allocator->large_list);
+    for (; entry != last; entry = tb_list_entry_next(entry))
+    {
+        // the data head
+        tb_pool_data_head_t const* data_head = (tb_pool_data_head_t const*)&((tb_arena_allocator_large_t const*)tb_list_entry(&allocator->large_list, entry))[1];
+        if ((tb_byte_t const*)data >= (tb_byte_t const*)&data_head[1] && (tb_byte_t const*)data < (tb_byte_t const*)&data_head[1] + data_head->size) 
+            return tb_true;
+    }
+
+    // no
+    return tb_false;
+}
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_allocator_ref_t tb_arena_allocator_init(tb_allocator_ref_t large_allocator, tb_size_t chunk_size)
+{
+    // done
+    tb_bool_t                   ok = tb_false;
+    tb_arena_allocator_ref_t    allocator = tb_null;
+    do
+    {
+        // no allocator? uses the global allocator
+        if (!large_allocator) large_allocator = tb_allocator();
+        tb_assert_and_check_break(large_allocator);
+
+        // make allocator
+        allocator = (tb_arena_allocator_ref_t)tb_allocator_large_malloc0(large_allocator, sizeof(tb_arena_allocator_t), tb_null);
+        tb_assert_and_check_break(allocator);
+
+        // init large allocator
+        allocator->large_allocator      = large_allocator;
+
+        // init base
+        allocator->base.type            = TB_ALLOCATOR_ARENA;
+        allocator->base.malloc          = tb_arena_allocator_malloc;
+        allocator->base.ralloc          = tb_arena_allocator_ralloc;
+        allocator->base.free            = tb_arena_allocator_free;
+        allocator->base.clear           = tb_arena_allocator_clear;
+        allocator->base.exit            = tb_arena_allocator_exit;
+        allocator->base.stat            = tb_arena_allocator_stat;
+        allocator->base.trim            = tb_arena_allocator_trim;
+#ifdef __tb_debug__
+        allocator->base.dump            = tb_arena_allocator_dump;
+        allocator->base.have            = tb_arena_allocator_have;
+#endif
+
+        // init lock
+        if (!tb_spinlock_init(&allocator->base.lock)) break;
+
+        // init chunk size
+        allocator->chunk_size           = tb_align(tb_max(chunk_size? chunk_size : TB_ARENA_ALLOCATOR_CHUNK_SIZE, TB_ARENA_ALLOCATOR_CHUNK_MINN), TB_POOL_DATA_ALIGN);
+
+        /* init the maximum data size in chunk
+         *
+         * the larger data will be allocated from the large allocator directly
+         * and we can waste at most 1/4 space of the chunk tail
+         */
+        allocator->large_size           = (allocator->chunk_size >> 2) - sizeof(tb_pool_data_head_t);
+
+        // init the large data list
+        tb_list_entry_init(&allocator->large_list, tb_arena_allocator_large_t, entry, tb_null);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        if (allocator) tb_arena_allocator_exit((tb_allocator_ref_t)allocator);
+        allocator = tb_null;
+    }
+
+    // ok?
+    return (tb_allocator_ref_t)allocator;
+}
+tb_void_t tb_arena_allocator_save(tb_allocator_ref_t self, tb_arena_allocator_savepoint_ref_t savepoint)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator && allocator->base.type == TB_ALLOCATOR_ARENA && savepoint);
+
+    // enter
+    tb_spinlock_enter(&allocator->base.lock);
+
+    // save the current position
+    savepoint->chunk    = (tb_pointer_t)allocator->chunk;
+    savepoint->cursor   = (tb_pointer_t)allocator->cursor;
+    savepoint->large    = allocator->large_count;
+
+    // leave
+    tb_spinlock_leave(&allocator->base.lock);
+}
+tb_void_t tb_arena_allocator_restore(tb_allocator_ref_t self, tb_arena_allocator_savepoint_ref_t savepoint)
+{
+    // check
+    tb_arena_allocator_ref_t allocator = (tb_arena_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator && allocator->base.type == TB_ALLOCATOR_ARENA && savepoint);
+
+    // enter
+    tb_spinlock_enter(&allocator->base.lock);
+
+    // free the large data which have been allocated after this savepoint
+    tb_arena_allocator_large_clear(allocator, savepoint->large);
+
+    // rewind to the saved position, the next chunks will be reused
+    allocator->chunk    = (tb_arena_allocator_chunk_t*)savepoint->chunk;
+    allocator->cursor   = (tb_byte_t*)savepoint->cursor;
+    allocator->tail     = allocator->chunk? (tb_byte_t*)&allocator->chunk[1] + allocator->chunk->size : tb_null;
+    allocator->last     = tb_null;
+
+    // leave
+    tb_spinlock_leave(&allocator->base.lock);
+}
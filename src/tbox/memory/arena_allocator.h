@@ -0,0 +1,152 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        arena_allocator.h
+ * @ingroup     memory
+ *
+ */
+#ifndef TB_MEMORY_ARENA_ALLOCATOR_H
+#define TB_MEMORY_ARENA_ALLOCATOR_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "allocator.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/*! the arena allocator savepoint type
+ *
+ * @note the fields are private and need not be accessed
+ */
+typedef struct __tb_arena_allocator_savepoint_t
+{
+    /// the current chunk
+    tb_pointer_t            chunk;
+
+    /// the current data position
+    tb_pointer_t            cursor;
+
+    /// the large data count
+    tb_size_t               large;
+
+}tb_arena_allocator_savepoint_t, *tb_arena_allocator_savepoint_ref_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init the arena allocator
+ *
+ * the data is allocated by bumping the position of the current chunk,
+ * and all data will be released at once by tb_allocator_clear() or tb_arena_allocator_restore().
+ *
+ * <pre>
+ *
+ *  -----------------------------------------------------------------------------
+ * |                              large allocator                                |
+ *  -----------------------------------------------------------------------------
+ *           |                         |                               |
+ *  -----------------      -----------------      -----------------      -------
+ * | chunk: |||||||| | -> | chunk: ||||||   | -> | chunk:          | -> | large | -> ...
+ *  -----------------      -----------------      -----------------      -------
+ *                                       |
+ *                                     cursor
+ *
+ * </pre>
+ *
+ * - malloc: O(1), bump the cursor of the current chunk, or goto the next chunk
+ * - free: O(1), only the last data will be released, the others will be released after clearing
+ * - ralloc: O(1) in-place if the data is the last data, otherwise copy it to the new data
+ * - clear: O(1), rewind to the first chunk and all chunks will be reused, only the large data will be freed
+ * - trim: free the unused chunks after the current chunk by tb_allocator_trim(), .e.g after clearing it
+ *
+ * the data which is larger than (chunk_size / 4) will be allocated from the large allocator directly.
+ *
+ * @code
+    tb_allocator_ref_t allocator = tb_arena_allocator_init(tb_null, 0);
+    if (allocator)
+    {
+        while (...)
+        {
+            // make the request objects
+            tb_string_t string;
+            tb_string_init_with_allocator(&string, allocator);
+            tb_pointer_t data = tb_allocator_malloc(allocator, 100);
+            // ...
+
+            // free all objects of this request at once
+            tb_allocator_clear(allocator);
+        }
+        tb_allocator_exit(allocator);
+    }
+ * @endcode
+ *
+ * @param large_allocator   the large allocator, uses the global allocator if be null
+ * @param chunk_size        the chunk size, uses the default size if be zero
+ *
+ * @return                  the allocator 
+ */
+tb_allocator_ref_t          tb_arena_allocator_init(tb_allocator_ref_t large_allocator, tb_size_t chunk_size);
+
+/*! save the current position of the arena allocator
+ *
+ * @param allocator         the arena allocator
+ * @param savepoint         the savepoint
+ */
+tb_void_t                   tb_arena_allocator_save(tb_allocator_ref_t allocator, tb_arena_allocator_savepoint_ref_t savepoint);
+
+/*! restore the arena allocator to the given savepoint 
+ *
+ * all data which are allocated after this savepoint will be released at once, 
+ * and the savepoints saved after this savepoint will be invalid.
+ *
+ * @code
+    tb_arena_allocator_savepoint_t savepoint;
+    tb_arena_allocator_save(allocator, &savepoint);
+
+    // make some temporary data
+    tb_pointer_t data = tb_allocator_malloc(allocator, 100);
+    // ...
+
+    // release the temporary data
+    tb_arena_allocator_restore(allocator, &savepoint);
+ * @endcode
+ *
+ * @param allocator         the arena allocator
+ * @param savepoint         the savepoint
+ */
+tb_void_t                   tb_arena_allocator_restore(tb_allocator_ref_t allocator, tb_arena_allocator_savepoint_ref_t savepoint);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
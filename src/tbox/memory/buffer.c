@@ -45,14 +45,19 @@
  * implementation
  */
 tb_bool_t tb_buffer_init(tb_buffer_ref_t buffer)
+{
+    return tb_buffer_init_with_allocator(buffer, tb_null);
+}
+tb_bool_t tb_buffer_init_with_allocator(tb_buffer_ref_t buffer, tb_allocator_ref_t allocator)
 {
     // check
     tb_assert_and_check_return_val(buffer, tb_false);
 
     // init
-    buffer->data = buffer->buff;
-    buffer->size = 0;
-    buffer->maxn = sizeof(buffer->buff);
+    buffer->data        = buffer->buff;
+    buffer->size        = 0;
+    buffer->maxn        = sizeof(buffer->buff);
+    buffer->allocator   = allocator;
 
     // ok
     return tb_true;
@@ -66,7 +71,7 @@ tb_void_t tb_buffer_exit(tb_buffer_ref_t buffer)
     tb_buffer_clear(buffer);
 
     // exit data
-    if (buffer->data && buffer->data != buffer->buff) tb_free(buffer->data);
+    if (buffer->data && buffer->data != buffer->buff) tb_allocator_free(buffer->allocator? buffer->allocator : tb_allocator(), buffer->data);
     buffer->data = buffer->buff;
 
     // exit size
@@ -115,6 +120,7 @@ tb_byte_t* tb_buffer_resize(tb_buffer_ref_t buffer, tb_size_t size)
     tb_byte_t*  buff_data = buffer->data;
     tb_size_t   buff_size = buffer->size;
     tb_size_t   buff_maxn = buffer->maxn;
+    tb_allocator_ref_t allocator = buffer->allocator? buffer->allocator : tb_allocator();
     do
     {
         // check
@@ -131,7 +137,7 @@ tb_byte_t* tb_buffer_resize(tb_buffer_ref_t buffer, tb_size_t size)
                 tb_assert_and_check_break(size <= buff_maxn);
 
                 // grow data
-                buff_data = tb_malloc_bytes(buff_maxn);
+                buff_data = (tb_byte_t*)tb_allocator_malloc(allocator, buff_maxn);
                 tb_assert_and_check_break(buff_data);
 
                 // copy data
@@ -151,7 +157,7 @@ tb_byte_t* tb_buffer_resize(tb_buffer_ref_t buffer, tb_size_t size)
                 tb_assert_and_check_break(size <= buff_maxn);
 
                 // grow data
-                buff_data = (tb_byte_t*)tb_ralloc(buff_data, buff_maxn);
+                buff_data = (tb_byte_t*)tb_allocator_ralloc(allocator, buff_data, buff_maxn);
                 tb_assert_and_check_break(buff_data);
             }
 #if 0
@@ -165,7 +171,7 @@ tb_byte_t* tb_buffer_resize(tb_buffer_ref_t buffer, tb_size_t size)
                 tb_memcpy(buffer->buff, buff_data, size);
 
                 // free data
-                tb_free(buff_data);
+                tb_allocator_free(allocator, buff_data);
 
                 // using the static buffer
                 buff_data = buffer->buff;
@@ -30,6 +30,7 @@
  * includes
  */
 #include "prefix.h"
+#include "allocator.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
@@ -52,6 +53,9 @@ typedef struct __tb_buffer_t
     /// the buffer maxn
     tb_size_t       maxn;
 
+    /// the allocator, uses the global allocator if be null
+    tb_allocator_ref_t allocator;
+
     /// the static buffer
 #ifdef __tb_small__
     tb_byte_t       buff[32];
@@ -73,6 +77,15 @@ typedef struct __tb_buffer_t
  */
 tb_bool_t           tb_buffer_init(tb_buffer_ref_t buffer);
 
+/*! init the buffer with the given allocator
+ *
+ * @param buffer    the buffer
+ * @param allocator the allocator for the buffer data, uses the global allocator if be null
+ *
+ * @return          tb_true or tb_false
+ */
+tb_bool_t           tb_buffer_init_with_allocator(tb_buffer_ref_t buffer, tb_allocator_ref_t allocator);
+
 /*! exit the buffer
  *
  * @param buffer    the buffer
@@ -0,0 +1,602 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        concurrent_fixed_pool.c
+ * @ingroup     memory
+ */
+
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "concurrent_fixed_pool"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "concurrent_fixed_pool.h"
+#include "large_allocator.h"
+#include "impl/prefix.h"
+#include "../platform/platform.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// enable the thread cache of the heaps?
+#if defined(__tb_thread_local__) && !defined(TB_CONFIG_MICRO_ENABLE)
+#   define TB_CONCURRENT_FIXED_POOL_CACHE_ENABLE
+#endif
+
+// the thread cache size, must be the power of 2
+#define TB_CONCURRENT_FIXED_POOL_CACHE_MAXN         (16)
+
+// the used flag of the item link
+#define TB_CONCURRENT_FIXED_POOL_ITEM_USED          ((tb_size_t)1)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the concurrent fixed pool item type
+typedef struct __tb_concurrent_fixed_pool_item_t
+{
+    /* the item link
+     *
+     * used: the owner heap | TB_CONCURRENT_FIXED_POOL_ITEM_USED
+     * free: the next free item
+     */
+    tb_size_t                                   link;
+
+}__tb_pool_data_aligned__ tb_concurrent_fixed_pool_item_t;
+
+// the concurrent fixed pool slot type
+typedef struct __tb_concurrent_fixed_pool_slot_t
+{
+    // the next slot
+    struct __tb_concurrent_fixed_pool_slot_t*   next;
+
+    // the item count
+    tb_size_t                                   count;
+
+}__tb_pool_data_aligned__ tb_concurrent_fixed_pool_slot_t;
+
+// the concurrent fixed pool heap type
+typedef struct __tb_concurrent_fixed_pool_heap_t
+{
+    // the next heap
+    struct __tb_concurrent_fixed_pool_heap_t*   next;
+
+    // the owner thread
+    tb_size_t                                   owner;
+
+    // the local free items, only accessed by the owner thread
+    tb_concurrent_fixed_pool_item_t*            free;
+
+    // the slots
+    tb_concurrent_fixed_pool_slot_t*            slots;
+
+    // the used item count, it is only updated by the owner thread
+    tb_size_t                                   count;
+
+#ifdef __tb_debug__
+    // the malloc count
+    tb_size_t                                   malloc_count;
+
+    // the remote free count
+    tb_atomic_t                                 remote_count;
+
+    // the reclaim count
+    tb_size_t                                   reclaim_count;
+#endif
+
+    // the padding for the remote free items
+    tb_byte_t                                   pad0[TB_L1_CACHE_BYTES];
+
+    // the remote free items, it is pushed by the other threads
+    tb_atomic_t                                 remote;
+
+    // the padding
+    tb_byte_t                                   pad1[TB_L1_CACHE_BYTES];
+
+}tb_concurrent_fixed_pool_heap_t;
+
+// the concurrent fixed pool type
+typedef struct __tb_concurrent_fixed_pool_t
+{
+    // the large allocator
+    tb_allocator_ref_t                          large_allocator;
+
+    // the unique id for the thread cache
+    tb_size_t                                   id;
+
+    // the slot size
+    tb_size_t                                   slot_size;
+
+    // the item size
+    tb_size_t                                   item_size;
+
+    // the item space
+    tb_size_t                                   item_space;
+
+    // the init func
+    tb_fixed_pool_item_init_func_t              func_init;
+
+    // the exit func
+    tb_fixed_pool_item_exit_func_t              func_exit;
+
+    // the private data
+    tb_cpointer_t                               func_priv;
+
+    // the lock of the heaps
+    tb_spinlock_t                               lock;
+
+    // the heaps
+    tb_concurrent_fixed_pool_heap_t*            heaps;
+
+}tb_concurrent_fixed_pool_t;
+
+#ifdef TB_CONCURRENT_FIXED_POOL_CACHE_ENABLE
+// the thread cache entry type
+typedef struct __tb_concurrent_fixed_pool_cache_t
+{
+    // the pool id
+    tb_size_t                                   id;
+
+    // the heap of the current thread
+    tb_concurrent_fixed_pool_heap_t*            heap;
+
+}tb_concurrent_fixed_pool_cache_t;
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the pool id, it is never reused and the stale thread cache will be not matched
+static tb_atomic_t                                                      g_concurrent_fixed_pool_id = 0;
+
+#ifdef TB_CONCURRENT_FIXED_POOL_CACHE_ENABLE
+// the heaps of the current thread, it is mapped by the pool id
+static __tb_thread_local__ tb_concurrent_fixed_pool_cache_t             g_concurrent_fixed_pool_cache[TB_CONCURRENT_FIXED_POOL_CACHE_MAXN];
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static __tb_inline__ tb_size_t tb_concurrent_fixed_pool_load(tb_atomic_t* a)
+{
+#ifdef __ATOMIC_ACQUIRE
+    return (tb_size_t)__atomic_load_n(a, __ATOMIC_ACQUIRE);
+#else
+    tb_size_t v = (tb_size_t)*a;
+    tb_barrier();
+    return v;
+#endif
+}
+static tb_concurrent_fixed_pool_heap_t* tb_concurrent_fixed_pool_heap(tb_concurrent_fixed_pool_t* pool)
+{
+#ifdef TB_CONCURRENT_FIXED_POOL_CACHE_ENABLE
+    // get the heap from the thread cache
+    tb_concurrent_fixed_pool_cache_t* cache = &g_concurrent_fixed_pool_cache[pool->id & (TB_CONCURRENT_FIXED_POOL_CACHE_MAXN - 1)];
+    if (cache->id == pool->id) return cache->heap;
+#endif
+
+    // the current thread
+    tb_size_t self = tb_thread_self();
+
+    // enter
+    tb_spinlock_enter(&pool->lock);
+
+    // find the heap of the current thread
+    tb_concurrent_fixed_pool_heap_t* heap = pool->heaps;
+    while (heap && heap->owner != self) heap = heap->next;
+
+    // not found? make a new heap
+    if (!heap)
+    {
+        heap = (tb_concurrent_fixed_pool_heap_t*)tb_allocator_large_malloc0(pool->large_allocator, sizeof(tb_concurrent_fixed_pool_heap_t), tb_null);
+        if (heap)
+        {
+            heap->owner = self;
+            heap->next  = pool->heaps;
+            pool->heaps = heap;
+        }
+    }
+
+    // leave
+    tb_spinlock_leave(&pool->lock);
+
+    // check
+    tb_assert_and_check_return_val(heap, tb_null);
+
+#ifdef TB_CONCURRENT_FIXED_POOL_CACHE_ENABLE
+    // save it to the thread cache
+    cache->id   = pool->id;
+    cache->heap = heap;
+#endif
+
+    // ok
+    return heap;
+}
+static tb_concurrent_fixed_pool_item_t* tb_concurrent_fixed_pool_heap_reclaim(tb_concurrent_fixed_pool_heap_t* heap)
+{
+    // no remote free items? 
+    tb_check_return_val(tb_concurrent_fixed_pool_load(&heap->remote), tb_null);
+
+    // take all remote free items at once
+    tb_concurrent_fixed_pool_item_t* list = (tb_concurrent_fixed_pool_item_t*)tb_atomic_fetch_and_set(&heap->remote, 0);
+    tb_check_return_val(list, tb_null);
+
+    // update the item count
+    tb_size_t                           count = 0;
+    tb_concurrent_fixed_pool_item_t*    item = list;
+    for (; item; item = (tb_concurrent_fixed_pool_item_t*)item->link) count++;
+    tb_assert(heap->count >= count);
+    heap->count -= count;
+
+#ifdef __tb_debug__
+    // update the reclaim count
+    heap->reclaim_count++;
+#endif
+
+    // ok
+    return list;
+}
+static tb_concurrent_fixed_pool_item_t* tb_concurrent_fixed_pool_heap_grow(tb_concurrent_fixed_pool_t* pool, tb_concurrent_fixed_pool_heap_t* heap)
+{
+    // make slot
+    tb_size_t                           real_space = 0;
+    tb_concurrent_fixed_pool_slot_t*    slot = (tb_concurrent_fixed_pool_slot_t*)tb_allocator_large_malloc(pool->large_allocator, sizeof(tb_concurrent_fixed_pool_slot_t) + pool->slot_size * pool->item_space, &real_space);
+    tb_assert_and_check_return_val(slot, tb_null);
+
+    // init slot, use the whole real space
+    slot->count = (real_space - sizeof(tb_concurrent_fixed_pool_slot_t)) / pool->item_space;
+    slot->next  = heap->slots;
+    heap->slots = slot;
+    tb_assert(slot->count >= pool->slot_size);
+
+    // link all items in the increasing order
+    tb_size_t                           i = slot->count;
+    tb_byte_t*                          data = (tb_byte_t*)&slot[1];
+    tb_concurrent_fixed_pool_item_t*    list = tb_null;
+    while (i--)
+    {
+        tb_concurrent_fixed_pool_item_t* item = (tb_concurrent_fixed_pool_item_t*)(data + i * pool->item_space);
+        item->link = (tb_size_t)list;
+        list = item;
+    }
+
+    // trace
+    tb_trace_d("heap[%p]: grow: %lu items", heap, slot->count);
+
+    // ok
+    return list;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_concurrent_fixed_pool_ref_t tb_concurrent_fixed_pool_init(tb_allocator_ref_t large_allocator, tb_size_t slot_size, tb_size_t item_size, tb_fixed_pool_item_init_func_t item_init, tb_fixed_pool_item_exit_func_t item_exit, tb_cpointer_t priv)
+{
+    // check
+    tb_assert_and_check_return_val(item_size, tb_null);
+
+    // done
+    tb_bool_t                   ok = tb_false;
+    tb_concurrent_fixed_pool_t* pool = tb_null;
+    do
+    {
+        // no allocator? uses the global allocator
+        if (!large_allocator) large_allocator = tb_allocator();
+        tb_assert_and_check_break(large_allocator);
+
+        // make pool
+        pool = (tb_concurrent_fixed_pool_t*)tb_allocator_large_malloc0(large_allocator, sizeof(tb_concurrent_fixed_pool_t), tb_null);
+        tb_assert_and_check_break(pool);
+
+        // init pool
+        pool->large_allocator   = large_allocator;
+        pool->id                = (tb_size_t)tb_atomic_add_and_fetch(&g_concurrent_fixed_pool_id, 1);
+        pool->slot_size         = slot_size? slot_size : (tb_page_size() >> 4);
+        pool->item_size         = item_size;
+        pool->item_space        = tb_align(sizeof(tb_concurrent_fixed_pool_item_t) + item_size, TB_POOL_DATA_ALIGN);
+        pool->func_init         = item_init;
+        pool->func_exit         = item_exit;
+        pool->func_priv         = priv;
+        tb_assert_and_check_break(pool->slot_size);
+
+        // init lock
+        if (!tb_spinlock_init(&pool->lock)) break;
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (pool) tb_concurrent_fixed_pool_exit((tb_concurrent_fixed_pool_ref_t)pool);
+        pool = tb_null;
+    }
+
+    // ok?
+    return (tb_concurrent_fixed_pool_ref_t)pool;
+}
+tb_void_t tb_concurrent_fixed_pool_exit(tb_concurrent_fixed_pool_ref_t self)
+{
+    // check
+    tb_concurrent_fixed_pool_t* pool = (tb_concurrent_fixed_pool_t*)self;
+    tb_assert_and_check_return(pool);
+
+    // exit all heaps
+    tb_concurrent_fixed_pool_heap_t* heap = pool->heaps;
+    while (heap)
+    {
+        // exit all slots
+        tb_concurrent_fixed_pool_slot_t* slot = heap->slots;
+        while (slot)
+        {
+            // exit the used items
+            if (pool->func_exit)
+            {
+                tb_size_t   i = 0;
+                tb_byte_t*  data = (tb_byte_t*)&slot[1];
+                for (i = 0; i < slot->count; i++, data += pool->item_space)
+                {
+                    tb_concurrent_fixed_pool_item_t* item = (tb_concurrent_fixed_pool_item_t*)data;
+                    if (item->link & TB_CONCURRENT_FIXED_POOL_ITEM_USED) pool->func_exit((tb_pointer_t)&item[1], pool->func_priv);
+                }
+            }
+
+            // exit slot
+            tb_concurrent_fixed_pool_slot_t* next = slot->next;
+            tb_allocator_large_free(pool->large_allocator, slot);
+            slot = next;
+        }
+
+        // exit heap
+        tb_concurrent_fixed_pool_heap_t* next = heap->next;
+        tb_allocator_large_free(pool->large_allocator, heap);
+        heap = next;
+    }
+    pool->heaps = tb_null;
+
+#ifdef TB_CONCURRENT_FIXED_POOL_CACHE_ENABLE
+    // clear the thread cache of the current thread
+    tb_concurrent_fixed_pool_cache_t* cache = &g_concurrent_fixed_pool_cache[pool->id & (TB_CONCURRENT_FIXED_POOL_CACHE_MAXN - 1)];
+    if (cache->id == pool->id) 
+    {
+        cache->id   = 0;
+        cache->heap = tb_null;
+    }
+#endif
+
+    // exit lock
+    tb_spinlock_exit(&pool->lock);
+
+    // exit it
+    tb_allocator_large_free(pool->large_allocator, pool);
+}
+tb_size_t tb_concurrent_fixed_pool_size(tb_concurrent_fixed_pool_ref_t self)
+{
+    // check
+    tb_concurrent_fixed_pool_t* pool = (tb_concurrent_fixed_pool_t*)self;
+    tb_assert_and_check_return_val(pool, 0);
+
+    // enter
+    tb_spinlock_enter(&pool->lock);
+
+    // the item count of all heaps
+    tb_size_t                           size = 0;
+    tb_concurrent_fixed_pool_heap_t*    heap = pool->heaps;
+    for (; heap; heap = heap->next) size += heap->count;
+
+    // leave
+    tb_spinlock_leave(&pool->lock);
+
+    // ok
+    return size;
+}
+tb_size_t tb_concurrent_fixed_pool_item_size(tb_concurrent_fixed_pool_ref_t self)
+{
+    // check
+    tb_concurrent_fixed_pool_t* pool = (tb_concurrent_fixed_pool_t*)self;
+    tb_assert_and_check_return_val(pool, 0);
+
+    // the item size
+    return pool->item_size;
+}
+tb_pointer_t tb_concurrent_fixed_pool_malloc_(tb_concurrent_fixed_pool_ref_t self __tb_debug_decl__)
+{
+    // check
+    tb_concurrent_fixed_pool_t* pool = (tb_concurrent_fixed_pool_t*)self;
+    tb_assert_and_check_return_val(pool, tb_null);
+
+    // done
+    tb_pointer_t                        data = tb_null;
+    tb_concurrent_fixed_pool_heap_t*    heap = tb_null;
+    tb_concurrent_fixed_pool_item_t*    item = tb_null;
+    do
+    {
+        // the heap of the current thread
+        heap = tb_concurrent_fixed_pool_heap(pool);
+        tb_assert_and_check_break(heap);
+
+        // no local free items? reclaim the remote free items or grow the heap
+        if (!heap->free) heap->free = tb_concurrent_fixed_pool_heap_reclaim(heap);
+        if (!heap->free) heap->free = tb_concurrent_fixed_pool_heap_grow(pool, heap);
+        tb_check_break(heap->free);
+
+        // pop a free item
+        item = heap->free;
+        heap->free = (tb_concurrent_fixed_pool_item_t*)item->link;
+
+        // mark it as used by this heap
+        item->link = (tb_size_t)heap | TB_CONCURRENT_FIXED_POOL_ITEM_USED;
+        heap->count++;
+
+#ifdef __tb_debug__
+        // update the malloc count
+        heap->malloc_count++;
+#endif
+
+        // the data
+        data = (tb_pointer_t)&item[1];
+
+        // done init
+        if (pool->func_init && !pool->func_init(data, pool->func_priv))
+        {
+            // restore it
+            item->link = (tb_size_t)heap->free;
+            heap->free = item;
+            heap->count--;
+            data = tb_null;
+            break;
+        }
+
+    } while (0);
+
+    // check
+    tb_assertf(data, "malloc(%lu) failed!", pool->item_size);
+
+    // ok?
+    return data;
+}
+tb_pointer_t tb_concurrent_fixed_pool_malloc0_(tb_concurrent_fixed_pool_ref_t self __tb_debug_decl__)
+{
+    // check
+    tb_concurrent_fixed_pool_t* pool = (tb_concurrent_fixed_pool_t*)self;
+    tb_assert_and_check_return_val(pool, tb_null);
+
+    // done
+    tb_pointer_t data = tb_concurrent_fixed_pool_malloc_(self __tb_debug_args__);
+    tb_assert_and_check_return_val(data, tb_null);
+
+    // clear it
+    tb_memset_(data, 0, pool->item_size);
+
+    // ok
+    return data;
+}
+tb_bool_t tb_concurrent_fixed_pool_free_(tb_concurrent_fixed_pool_ref_t self, tb_pointer_t data __tb_debug_decl__)
+{
+    // check
+    tb_concurrent_fixed_pool_t* pool = (tb_concurrent_fixed_pool_t*)self;
+    tb_assert_and_check_return_val(pool && data, tb_false);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // the item
+        tb_concurrent_fixed_pool_item_t* item = &((tb_concurrent_fixed_pool_item_t*)data)[-1];
+
+        // the owner heap
+        tb_size_t link = item->link;
+        tb_assertf_pass_and_check_break(link & TB_CONCURRENT_FIXED_POOL_ITEM_USED, "double free data: %p", data);
+        tb_concurrent_fixed_pool_heap_t* heap = (tb_concurrent_fixed_pool_heap_t*)(link & ~TB_CONCURRENT_FIXED_POOL_ITEM_USED);
+        tb_assert_pass_and_check_break(heap);
+
+        // done exit
+        if (pool->func_exit) pool->func_exit(data, pool->func_priv);
+
+        // is the owner thread? push it to the local free items
+        if (heap->owner == tb_thread_self())
+        {
+            item->link = (tb_size_t)heap->free;
+            heap->free = item;
+            heap->count--;
+        }
+        // push it to the remote free items of the owner heap
+        else
+        {
+            tb_size_t head = tb_concurrent_fixed_pool_load(&heap->remote);
+            while (1)
+            {
+                item->link = head;
+                tb_size_t real = (tb_size_t)tb_atomic_fetch_and_pset(&heap->remote, (tb_long_t)head, (tb_long_t)item);
+                if (real == head) break;
+                head = real;
+            }
+
+#ifdef __tb_debug__
+            // update the remote free count
+            tb_atomic_fetch_and_inc(&heap->remote_count);
+#endif
+        }
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed? dump it
+#ifdef __tb_debug__
+    if (!ok) 
+    {
+        // trace
+        tb_trace_e("free(%p) failed! at %s(): %lu, %s", data, func_, line_, file_);
+
+        // abort
+        tb_abort();
+    }
+#endif
+
+    // ok?
+    return ok;
+}
+#ifdef __tb_debug__
+tb_void_t tb_concurrent_fixed_pool_dump(tb_concurrent_fixed_pool_ref_t self)
+{
+    // check
+    tb_concurrent_fixed_pool_t* pool = (tb_concurrent_fixed_pool_t*)self;
+    tb_assert_and_check_return(pool);
+
+    // enter
+    tb_spinlock_enter(&pool->lock);
+
+    // dump all heaps
+    tb_concurrent_fixed_pool_heap_t* heap = pool->heaps;
+    for (; heap; heap = heap->next)
+    {
+        // the slot count
+        tb_size_t                           slot_count = 0;
+        tb_size_t                           item_maxn = 0;
+        tb_concurrent_fixed_pool_slot_t*    slot = heap->slots;
+        for (; slot; slot = slot->next)
+        {
+            slot_count++;
+            item_maxn += slot->count;
+        }
+
+        // trace
+        tb_trace_i("heap[%lu]: item_size: %lu, count: %lu, item_maxn: %lu, slots: %lu, malloc_count: %lu, remote_free_count: %lu, reclaim_count: %lu"
+                ,   heap->owner, pool->item_size, heap->count, item_maxn, slot_count, heap->malloc_count, (tb_size_t)tb_atomic_get(&heap->remote_count), heap->reclaim_count);
+    }
+
+    // leave
+    tb_spinlock_leave(&pool->lock);
+}
+#endif
@@ -0,0 +1,163 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        concurrent_fixed_pool.h
+ * @ingroup     memory
+ *
+ */
+#ifndef TB_MEMORY_CONCURRENT_FIXED_POOL_H
+#define TB_MEMORY_CONCURRENT_FIXED_POOL_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "fixed_pool.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+#define tb_concurrent_fixed_pool_malloc(pool)           tb_concurrent_fixed_pool_malloc_(pool __tb_debug_vals__)
+#define tb_concurrent_fixed_pool_malloc0(pool)          tb_concurrent_fixed_pool_malloc0_(pool __tb_debug_vals__)
+#define tb_concurrent_fixed_pool_free(pool, item)       tb_concurrent_fixed_pool_free_(pool, (tb_pointer_t)(item) __tb_debug_vals__)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/*! the concurrent fixed pool ref type
+ *
+ * the thread-safe fixed pool, each thread allocates items from its own heap without any lock.
+ *
+ * <pre>
+ *
+ * thread0: malloc                    thread1: free (remote)
+ *    |                                  |
+ *   \|/                                \|/
+ *  ---------------------------------------------------------------------
+ * | heap0: free list (local) | remote free list (lock-free) | slots ... |
+ *  ---------------------------------------------------------------------
+ *      /|\                                  |
+ *       |________ reclaim in batches _______|
+ *                 (only if the local free list is null)
+ *
+ * item:
+ *  --------------------- ---------
+ * | owner heap | next   |  data   |
+ *  --------------------- ---------
+ * </pre>
+ *
+ * - the items freed by the owner thread are pushed to the local free list of its heap directly
+ * - the items freed by the other threads are pushed to the remote free list of its heap by cas
+ * - the owner thread takes all remote free items at once if the local free list is null
+ *
+ * so the producer/consumer pipeline which allocates items on one thread and frees them on the other thread
+ * only need one cas for each item, and the remote free list is ABA-safe because it is only pushed one by one and taken as a whole.
+ *
+ * @note the heap of the exited thread is kept until the pool is exited, and it will be reused if the thread id is reused.
+ * tb_concurrent_fixed_pool_init() and tb_concurrent_fixed_pool_exit() are not thread-safe.
+ */
+typedef __tb_typeref__(concurrent_fixed_pool);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init concurrent fixed pool
+ *
+ * @param large_allocator   the large allocator, uses the global allocator if be null, it need be thread-safe
+ * @param slot_size         the item count per-slot, using the default size if be zero
+ * @param item_size         the item size
+ * @param item_init         the item init func
+ * @param item_exit         the item exit func, it will be called on the freeing thread
+ * @param priv              the private data
+ *
+ * @return                  the pool 
+ */
+tb_concurrent_fixed_pool_ref_t  tb_concurrent_fixed_pool_init(tb_allocator_ref_t large_allocator, tb_size_t slot_size, tb_size_t item_size, tb_fixed_pool_item_init_func_t item_init, tb_fixed_pool_item_exit_func_t item_exit, tb_cpointer_t priv);
+
+/*! exit pool and exit all the remaining items
+ *
+ * @param pool              the pool 
+ */
+tb_void_t                       tb_concurrent_fixed_pool_exit(tb_concurrent_fixed_pool_ref_t pool);
+
+/*! the item count, it is only a snapshot if the pool is being accessed by the other threads
+ *
+ * @note the items which have been freed by the other threads are counted until they are reclaimed by the owner thread
+ *
+ * @param pool              the pool 
+ *
+ * @return                  the item count
+ */
+tb_size_t                       tb_concurrent_fixed_pool_size(tb_concurrent_fixed_pool_ref_t pool);
+
+/*! the item size
+ *
+ * @param pool              the pool 
+ *
+ * @return                  the item size
+ */
+tb_size_t                       tb_concurrent_fixed_pool_item_size(tb_concurrent_fixed_pool_ref_t pool);
+
+/*! malloc data from the heap of the current thread
+ *
+ * @param pool              the pool 
+ * 
+ * @return                  the data
+ */
+tb_pointer_t                    tb_concurrent_fixed_pool_malloc_(tb_concurrent_fixed_pool_ref_t pool __tb_debug_decl__);
+
+/*! malloc data from the heap of the current thread and clear it
+ *
+ * @param pool              the pool 
+ *
+ * @return                  the data
+ */
+tb_pointer_t                    tb_concurrent_fixed_pool_malloc0_(tb_concurrent_fixed_pool_ref_t pool __tb_debug_decl__);
+
+/*! free data, it can be called on any thread
+ *
+ * @param pool              the pool 
+ * @param data              the data
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                       tb_concurrent_fixed_pool_free_(tb_concurrent_fixed_pool_ref_t pool, tb_pointer_t data __tb_debug_decl__);
+
+#ifdef __tb_debug__
+/*! dump pool
+ *
+ * @param pool              the pool 
+ */
+tb_void_t                       tb_concurrent_fixed_pool_dump(tb_concurrent_fixed_pool_ref_t pool);
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -38,34 +38,621 @@
 #include "large_allocator.h"
 #include "default_allocator.h"
 #include "impl/prefix.h"
+#if defined(TB_CONFIG_POSIX_HAVE_PTHREAD_KEY_CREATE) && \
+        defined(TB_CONFIG_POSIX_HAVE_PTHREAD_SETSPECIFIC)
+#   include <pthread.h>
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// enable the thread cache?
+#if defined(__tb_thread_local__) && !defined(TB_CONFIG_MICRO_ENABLE)
+#   define TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+#endif
+
+// the batch size of borrowing and returning data for the thread cache
+#ifdef __tb_small__
+#   define TB_DEFAULT_ALLOCATOR_CACHE_BATCH_SIZE    (4096)
+#else
+#   define TB_DEFAULT_ALLOCATOR_CACHE_BATCH_SIZE    (8192)
+#endif
+
+// the batch count maxn and minn
+#define TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MAXN       (64)
+#define TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MINN       (4)
+
+// the thread cache maxn of each thread, it must be pow2
+#define TB_DEFAULT_ALLOCATOR_CACHE_MAXN             (8)
+
+// register the thread exit callback for the threads which are not created by tb_thread_init()?
+#if defined(TB_DEFAULT_ALLOCATOR_CACHE_ENABLE) && \
+        defined(TB_CONFIG_POSIX_HAVE_PTHREAD_KEY_CREATE) && \
+        defined(TB_CONFIG_POSIX_HAVE_PTHREAD_SETSPECIFIC)
+#   define TB_DEFAULT_ALLOCATOR_CACHE_PTHREAD_KEY
+#endif
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
  */
 
+// the thread cache bin type for each size class
+typedef struct __tb_default_allocator_cache_bin_t
+{
+    // the free data list, the next data is saved in the first pointer of the data
+    tb_pointer_t                        list;
+
+    // the cached data count, it is only written by the owner thread and may be read by the other threads
+    tb_atomic_t                         size;
+
+    // the batch count for borrowing and returning data
+    tb_size_t                           batch;
+
+    // the data space
+    tb_size_t                           space;
+
+}tb_default_allocator_cache_bin_t;
+
+/* the thread cache statistics type
+ *
+ * the counters are only written by the owner thread and read by tb_allocator_stat() from the other threads,
+ * so we update them with the relaxed atomic stores instead of the locked instructions.
+ */
+typedef struct __tb_default_allocator_cache_count_t
+{
+    // the malloc count
+    tb_atomic_t                         malloc_count;
+
+    // the malloc hits
+    tb_atomic_t                         malloc_hits;
+
+    // the free count
+    tb_atomic_t                         free_count;
+
+    // the free hits
+    tb_atomic_t                         free_hits;
+
+    // the borrow count
+    tb_atomic_t                         borrow_count;
+
+    // the return count
+    tb_atomic_t                         return_count;
+
+    // the cached size
+    tb_atomic_t                         cached_size;
+
+}tb_default_allocator_cache_count_t;
+
+// the thread cache type
+typedef struct __tb_default_allocator_cache_t
+{
+    // the list entry
+    tb_list_entry_t                     entry;
+
+    /* the allocator
+     *
+     * it will be cleared if the allocator has been exited and this cache is dead,
+     * and the dead cache will be freed by its owner thread later.
+     */
+    struct __tb_default_allocator_t*    allocator;
+
+    // the allocator id, it is never reused and the dead cache will be not matched
+    tb_size_t                           id;
+
+    // the trim epoch of the allocator when this cache was trimmed last
+    tb_size_t                           trim;
+
+    // the bins
+    tb_default_allocator_cache_bin_t    bins[TB_SMALL_ALLOCATOR_CLASS_MAXN];
+
+    // the statistics
+    tb_default_allocator_cache_count_t  stat;
+
+}tb_default_allocator_cache_t;
+
 // the default allocator type
 typedef struct __tb_default_allocator_t
 {
     // the base
-    tb_allocator_t          base;
+    tb_allocator_t                      base;
 
     // the large allocator
-    tb_allocator_ref_t      large_allocator;
+    tb_allocator_ref_t                  large_allocator;
 
     // the small allocator
-    tb_allocator_ref_t      small_allocator;
+    tb_allocator_ref_t                  small_allocator;
+
+    // the allocator id for mapping the thread caches
+    tb_size_t                           id;
+
+    // the thread caches
+    tb_list_entry_head_t                caches;
+
+    // the lock of the thread caches
+    tb_spinlock_t                       caches_lock;
+
+    // the malloc count of the exited thread caches
+    tb_atomic_t                         caches_malloc_count;
+
+    // the free count of the exited thread caches
+    tb_atomic_t                         caches_free_count;
+
+    // the trim epoch of the thread caches, each thread cache will be cleared by its thread if it is changed
+    tb_atomic_t                         caches_trim;
+
+    // the malloc count of the large data
+    tb_atomic_t                         large_malloc_count;
+
+    // the ralloc count of the large data
+    tb_atomic_t                         large_ralloc_count;
+
+    // the free count of the large data
+    tb_atomic_t                         large_free_count;
+
+    // the live size of the large data
+    tb_atomic_t                         large_size;
+
+    // the peak live size of the large data
+    tb_size_t                           large_peak;
 
 }tb_default_allocator_t, *tb_default_allocator_ref_t;
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the allocator id, it is never reused and the stale thread cache will be not matched
+static tb_atomic_t                                          g_default_allocator_id = 0;
+
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+// the thread caches of the current thread, they are mapped by the allocator id
+static __tb_thread_local__ tb_default_allocator_cache_t*    g_default_allocator_cache[TB_DEFAULT_ALLOCATOR_CACHE_MAXN];
+
+/* the lock of the dead thread caches
+ *
+ * the allocator marks all thread caches dead under this lock when it is exited,
+ * and the owner thread returns its cached data or frees the dead cache under this lock too.
+ */
+static tb_spinlock_t                                        g_default_allocator_cache_lock = TB_SPINLOCK_INIT;
+#endif
+
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_PTHREAD_KEY
+// the pthread key for exiting the thread caches of the threads which are not created by tb_thread_init()
+static pthread_key_t                                        g_default_allocator_cache_key;
+
+// the once lock of the pthread key
+static tb_atomic_t                                          g_default_allocator_cache_key_once = 0;
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * thread cache implementation
+ */
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+static __tb_inline__ tb_size_t tb_default_allocator_cache_load(tb_atomic_t* a)
+{
+#ifdef __ATOMIC_RELAXED
+    return (tb_size_t)__atomic_load_n(a, __ATOMIC_RELAXED);
+#else
+    return (tb_size_t)*a;
+#endif
+}
+static __tb_inline__ tb_void_t tb_default_allocator_cache_count(tb_atomic_t* a, tb_long_t n)
+{
+    // only the owner thread writes it, so we need not the locked instruction
+#ifdef __ATOMIC_RELAXED
+    __atomic_store_n(a, __atomic_load_n(a, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+#else
+    *a += n;
+#endif
+}
+static tb_void_t tb_default_allocator_cache_snapshot(tb_default_allocator_cache_t* cache, tb_default_allocator_cache_stat_t* stat)
+{
+    // check
+    tb_assert(cache && stat);
+
+    // load the statistics, they may be being updated by the owner thread
+    stat->malloc_count  = tb_default_allocator_cache_load(&cache->stat.malloc_count);
+    stat->malloc_hits   = tb_default_allocator_cache_load(&cache->stat.malloc_hits);
+    stat->free_count    = tb_default_allocator_cache_load(&cache->stat.free_count);
+    stat->free_hits     = tb_default_allocator_cache_load(&cache->stat.free_hits);
+    stat->borrow_count  = tb_default_allocator_cache_load(&cache->stat.borrow_count);
+    stat->return_count  = tb_default_allocator_cache_load(&cache->stat.return_count);
+    stat->cached_size   = tb_default_allocator_cache_load(&cache->stat.cached_size);
+}
+static tb_void_t tb_default_allocator_cache_return(tb_default_allocator_cache_t* cache, tb_default_allocator_cache_bin_t* bin, tb_size_t count)
+{
+    // check
+    tb_assert(cache && cache->allocator && bin && count <= (tb_size_t)bin->size);
+
+    // return data in batches
+    tb_size_t       n = 0;
+    tb_pointer_t    list[TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MAXN];
+    while (count && bin->list)
+    {
+        // pop data
+        tb_pointer_t data = bin->list;
+        bin->list = *((tb_pointer_t*)data);
+        count--;
+
+#ifdef __tb_debug__
+        // restore the magic
+        tb_pool_data_head_t* data_head = &(((tb_pool_data_head_t*)data)[-1]);
+        tb_assert(data_head->debug.magic == TB_POOL_DATA_CACHE_MAGIC);
+        data_head->debug.magic = TB_POOL_DATA_MAGIC;
+#endif
+
+        // save data
+        list[n++] = data;
+
+        // return them if the list is full
+        if (n == tb_arrayn(list) || !count || !bin->list)
+        {
+            tb_small_allocator_free_list(cache->allocator->small_allocator, list, n);
+            tb_default_allocator_cache_count(&bin->size, -(tb_long_t)n);
+            tb_default_allocator_cache_count(&cache->stat.cached_size, -(tb_long_t)(n * bin->space));
+            n = 0;
+        }
+    }
+
+    // update the statistics
+    tb_default_allocator_cache_count(&cache->stat.return_count, 1);
+}
+static tb_void_t tb_default_allocator_cache_clear(tb_default_allocator_cache_t* cache)
+{
+    // check
+    tb_assert(cache);
+
+    // return all cached data
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(cache->bins); i++)
+    {
+        tb_default_allocator_cache_bin_t* bin = &cache->bins[i];
+        if (bin->size) tb_default_allocator_cache_return(cache, bin, (tb_size_t)bin->size);
+    }
+}
+static tb_void_t tb_default_allocator_cache_trim(tb_default_allocator_cache_t* cache)
+{
+    // check
+    tb_assert(cache && cache->allocator);
+
+    // trace
+    tb_trace_d("cache[%p]: trim: cached_size: %lu", cache, tb_default_allocator_cache_load(&cache->stat.cached_size));
+
+    // update the trim epoch
+    cache->trim = (tb_size_t)cache->allocator->caches_trim;
+
+    // return all cached data
+    tb_default_allocator_cache_clear(cache);
+}
+static tb_void_t tb_default_allocator_cache_kill(tb_default_allocator_cache_t* cache)
+{
+    // check, the cache should have been removed from the allocator and the dead lock should be entered
+    tb_default_allocator_ref_t allocator = cache? cache->allocator : tb_null;
+    tb_assert_and_check_return(allocator);
+
+#ifdef __tb_debug__
+    // trace
+    tb_trace_d("cache[%p]: malloc: %lu, hits: %lu, free: %lu, hits: %lu, borrow: %lu, return: %lu", cache
+            ,   (tb_size_t)cache->stat.malloc_count, (tb_size_t)cache->stat.malloc_hits
+            ,   (tb_size_t)cache->stat.free_count, (tb_size_t)cache->stat.free_hits
+            ,   (tb_size_t)cache->stat.borrow_count, (tb_size_t)cache->stat.return_count);
+#endif
+
+    // return all cached data
+    tb_default_allocator_cache_clear(cache);
+
+    // keep the statistics of this thread cache
+    tb_atomic_fetch_and_add(&allocator->caches_malloc_count, (tb_long_t)cache->stat.malloc_count);
+    tb_atomic_fetch_and_add(&allocator->caches_free_count, (tb_long_t)cache->stat.free_count);
+
+    // mark it dead, the owner thread will free it later
+    cache->allocator = tb_null;
+}
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_PTHREAD_KEY
+static tb_void_t tb_default_allocator_cache_key_exit(tb_pointer_t priv)
+{
+    // exit the thread caches of the thread which is not created by tb_thread_init()
+    tb_default_allocator_cache_exit();
+}
+static tb_bool_t tb_default_allocator_cache_key_init(tb_cpointer_t priv)
+{
+    return pthread_key_create(&g_default_allocator_cache_key, tb_default_allocator_cache_key_exit) == 0;
+}
+#endif
+static tb_default_allocator_cache_t* tb_default_allocator_cache(tb_default_allocator_ref_t allocator, tb_bool_t create)
+{
+    // the thread cache of the current thread
+    tb_default_allocator_cache_t** pcache = &g_default_allocator_cache[allocator->id & (TB_DEFAULT_ALLOCATOR_CACHE_MAXN - 1)];
+    tb_default_allocator_cache_t*  cache = *pcache;
+    if (cache && cache->id == allocator->id) return cache;
+
+    // create it?
+    tb_check_return_val(create, tb_null);
+
+    // this slot has been used by the other allocator?
+    if (cache)
+    {
+        // free it if it is dead
+        tb_bool_t dead = tb_false;
+        tb_spinlock_enter(&g_default_allocator_cache_lock);
+        dead = !cache->allocator;
+        tb_spinlock_leave(&g_default_allocator_cache_lock);
+
+        // the other allocator is still alive? we use the shared pools directly
+        tb_check_return_val(dead, tb_null);
+        tb_native_memory_free(cache);
+        *pcache = tb_null;
+    }
+
+    /* make cache
+     *
+     * we use the native memory because the dead cache may be freed by its owner thread after the allocator has been exited
+     */
+    cache = (tb_default_allocator_cache_t*)tb_native_memory_malloc0(sizeof(tb_default_allocator_cache_t));
+    tb_assert_and_check_return_val(cache, tb_null);
+
+    // init cache
+    cache->allocator = allocator;
+    cache->id        = allocator->id;
+    cache->trim      = (tb_size_t)allocator->caches_trim;
+
+    // init bins
+    tb_size_t i = 0;
+    tb_size_t n = tb_small_allocator_class_count(allocator->small_allocator);
+    tb_assert(n <= tb_arrayn(cache->bins));
+    for (i = 0; i < n; i++)
+    {
+        tb_default_allocator_cache_bin_t* bin = &cache->bins[i];
+        bin->space = tb_small_allocator_class_space(allocator->small_allocator, i);
+        bin->batch = TB_DEFAULT_ALLOCATOR_CACHE_BATCH_SIZE / bin->space;
+        if (bin->batch > TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MAXN) bin->batch = TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MAXN;
+        if (bin->batch < TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MINN) bin->batch = TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MINN;
+    }
+
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_PTHREAD_KEY
+    // exit the thread caches when the thread exits, even if it is not created by tb_thread_init()
+    if (tb_thread_once(&g_default_allocator_cache_key_once, tb_default_allocator_cache_key_init, tb_null))
+        pthread_setspecific(g_default_allocator_cache_key, (tb_pointer_t)cache);
+#endif
+
+    // register it
+    tb_spinlock_enter(&allocator->caches_lock);
+    tb_list_entry_insert_tail(&allocator->caches, &cache->entry);
+    tb_spinlock_leave(&allocator->caches_lock);
+
+    // save it
+    *pcache = cache;
+
+    // ok
+    return cache;
+}
+static tb_void_t tb_default_allocator_cache_exit_all(tb_default_allocator_ref_t allocator)
+{
+    // check
+    tb_assert_and_check_return(allocator);
+
+    // enter
+    tb_spinlock_enter(&g_default_allocator_cache_lock);
+    tb_spinlock_enter(&allocator->caches_lock);
+
+    /* kill all thread caches
+     *
+     * the other threads may still refer to their caches, so we only return the cached data and mark them dead here,
+     * and the dead caches will be freed when their threads exit or reuse the cache slots.
+     */
+    while (!tb_list_entry_is_null(&allocator->caches))
+    {
+        // remove cache
+        tb_default_allocator_cache_t* cache = (tb_default_allocator_cache_t*)tb_list_entry(&allocator->caches, tb_list_entry_head(&allocator->caches));
+        tb_list_entry_remove(&allocator->caches, &cache->entry);
+
+        // kill it
+        tb_default_allocator_cache_kill(cache);
+    }
+
+    // leave
+    tb_spinlock_leave(&allocator->caches_lock);
+    tb_spinlock_leave(&g_default_allocator_cache_lock);
+
+    // free the thread cache of the current thread now
+    tb_default_allocator_cache_t** pcache = &g_default_allocator_cache[allocator->id & (TB_DEFAULT_ALLOCATOR_CACHE_MAXN - 1)];
+    if (*pcache && (*pcache)->id == allocator->id)
+    {
+        tb_native_memory_free(*pcache);
+        *pcache = tb_null;
+    }
+}
+static tb_pointer_t tb_default_allocator_cache_malloc(tb_default_allocator_ref_t allocator, tb_size_t size __tb_debug_decl__)
+{
+    // the thread cache
+    tb_default_allocator_cache_t* cache = tb_default_allocator_cache(allocator, tb_true);
+    tb_check_return_val(cache, tb_null);
+
+    // the allocator has been trimmed? return all cached data first
+    if (cache->trim != (tb_size_t)allocator->caches_trim) tb_default_allocator_cache_trim(cache);
+
+    // the bin
+    tb_default_allocator_cache_bin_t* bin = &cache->bins[tb_small_allocator_class(allocator->small_allocator, size, tb_null)];
+
+    // update the statistics
+    tb_default_allocator_cache_count(&cache->stat.malloc_count, 1);
+
+    // no cached data? borrow them from the shared pools
+    if (!bin->list)
+    {
+        // borrow data in batches
+        tb_pointer_t    list[TB_DEFAULT_ALLOCATOR_CACHE_BATCH_MAXN];
+        tb_size_t       count = tb_small_allocator_malloc_list(allocator->small_allocator, bin - cache->bins, list, bin->batch);
+        tb_check_return_val(count, tb_null);
+
+        // cache them
+        tb_size_t i = count;
+        while (i--)
+        {
+#ifdef __tb_debug__
+            // mark cached
+            (((tb_pool_data_head_t*)list[i])[-1]).debug.magic = TB_POOL_DATA_CACHE_MAGIC;
+#endif
+            *((tb_pointer_t*)list[i]) = bin->list;
+            bin->list = list[i];
+        }
+        tb_default_allocator_cache_count(&bin->size, (tb_long_t)count);
+        tb_default_allocator_cache_count(&cache->stat.cached_size, (tb_long_t)(count * bin->space));
+
+        // update the statistics
+        tb_default_allocator_cache_count(&cache->stat.borrow_count, 1);
+    }
+    else tb_default_allocator_cache_count(&cache->stat.malloc_hits, 1);
+
+    // pop data
+    tb_pointer_t data = bin->list;
+    bin->list = *((tb_pointer_t*)data);
+    tb_default_allocator_cache_count(&bin->size, -1);
+    tb_default_allocator_cache_count(&cache->stat.cached_size, -(tb_long_t)bin->space);
+
+    // the data head
+    tb_pool_data_head_t* data_head = &(((tb_pool_data_head_t*)data)[-1]);
+
+#ifdef __tb_debug__
+    // check
+    tb_assert(data_head->debug.magic == TB_POOL_DATA_CACHE_MAGIC);
+
+    // init the debug info
+    data_head->debug.magic     = TB_POOL_DATA_MAGIC;
+    data_head->debug.file      = file_;
+    data_head->debug.func      = func_;
+    data_head->debug.line      = (tb_uint16_t)line_;
+
+    // save backtrace
+    tb_pool_data_save_backtrace(&data_head->debug, 3);
+
+    // fill the patch bytes
+    if (bin->space > size) tb_memset_((tb_byte_t*)data + size, TB_POOL_DATA_PATCH, bin->space - size);
+#endif
+
+    // update size
+    data_head->size = size;
+
+    // ok
+    return data;
+}
+static tb_bool_t tb_default_allocator_cache_free_data(tb_default_allocator_ref_t allocator, tb_pointer_t data __tb_debug_decl__)
+{
+    // the thread cache, we only cache the freed data if the current thread has the cache
+    tb_default_allocator_cache_t* cache = tb_default_allocator_cache(allocator, tb_false);
+    tb_check_return_val(cache, tb_false);
+
+    // the allocator has been trimmed? return all cached data first
+    if (cache->trim != (tb_size_t)allocator->caches_trim) tb_default_allocator_cache_trim(cache);
+
+    // the data head
+    tb_pool_data_head_t* data_head = &(((tb_pool_data_head_t*)data)[-1]);
+
+    // the bin
+    tb_default_allocator_cache_bin_t* bin = &cache->bins[tb_small_allocator_class(allocator->small_allocator, data_head->size, tb_null)];
+
+#ifdef __tb_debug__
+    // check underflow
+    tb_assertf(bin->space == data_head->size || ((tb_byte_t*)data)[data_head->size] == TB_POOL_DATA_PATCH, "data underflow");
+
+    // mark cached for checking the double free
+    data_head->debug.magic = TB_POOL_DATA_CACHE_MAGIC;
+#endif
+
+    // the whole space is free now
+    data_head->size = bin->space;
+
+    // cache it
+    *((tb_pointer_t*)data) = bin->list;
+    bin->list = data;
+    tb_default_allocator_cache_count(&bin->size, 1);
+    tb_default_allocator_cache_count(&cache->stat.cached_size, (tb_long_t)bin->space);
+
+    // update the statistics
+    tb_default_allocator_cache_count(&cache->stat.free_count, 1);
+
+    // too many cached data? return one batch to the shared pools
+    if ((tb_size_t)bin->size > (bin->batch << 1)) tb_default_allocator_cache_return(cache, bin, bin->batch);
+    else tb_default_allocator_cache_count(&cache->stat.free_hits, 1);
+
+    // ok
+    return tb_true;
+}
+#endif
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * private implementation
  */
+static tb_void_t tb_default_allocator_large_update(tb_default_allocator_ref_t allocator, tb_long_t size)
+{
+    // update the live size of the large data
+    tb_size_t live_size = (tb_size_t)tb_atomic_add_and_fetch(&allocator->large_size, size);
+
+    // update the peak size, it is only a rough value for the concurrent threads
+    if (live_size > allocator->large_peak) allocator->large_peak = live_size;
+}
+static tb_pointer_t tb_default_allocator_large_malloc(tb_default_allocator_ref_t allocator, tb_size_t size __tb_debug_decl__)
+{
+    // malloc it from the large allocator
+    tb_pointer_t data = tb_allocator_large_malloc_(allocator->large_allocator, size, tb_null __tb_debug_args__);
+    tb_check_return_val(data, tb_null);
+
+    // update the statistics
+    tb_atomic_fetch_and_inc(&allocator->large_malloc_count);
+    tb_default_allocator_large_update(allocator, (tb_long_t)size);
+
+    // ok
+    return data;
+}
+static tb_bool_t tb_default_allocator_large_free(tb_default_allocator_ref_t allocator, tb_pointer_t data __tb_debug_decl__)
+{
+    // the data size
+    tb_size_t size = (((tb_pool_data_head_t*)data)[-1]).size;
+
+    // free it to the large allocator
+    tb_bool_t ok = tb_allocator_large_free_(allocator->large_allocator, data __tb_debug_args__);
+    tb_check_return_val(ok, tb_false);
+
+    // update the statistics
+    tb_atomic_fetch_and_inc(&allocator->large_free_count);
+    tb_default_allocator_large_update(allocator, -(tb_long_t)size);
+
+    // ok
+    return tb_true;
+}
+static tb_pointer_t tb_default_allocator_small_malloc(tb_default_allocator_ref_t allocator, tb_size_t size __tb_debug_decl__)
+{
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // malloc it from the thread cache
+    tb_pointer_t data = tb_default_allocator_cache_malloc(allocator, size __tb_debug_args__);
+    if (data) return data;
+#endif
+
+    // malloc it from the small allocator
+    return tb_allocator_malloc_(allocator->small_allocator, size __tb_debug_args__);
+}
+static tb_bool_t tb_default_allocator_small_free(tb_default_allocator_ref_t allocator, tb_pointer_t data __tb_debug_decl__)
+{
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // free it to the thread cache
+    if (tb_default_allocator_cache_free_data(allocator, data __tb_debug_args__)) return tb_true;
+#endif
+
+    // free it to the small allocator
+    return tb_allocator_free_(allocator->small_allocator, data __tb_debug_args__);
+}
 static tb_void_t tb_default_allocator_exit(tb_allocator_ref_t self)
 {
     // check
     tb_default_allocator_ref_t allocator = (tb_default_allocator_ref_t)self;
     tb_assert_and_check_return(allocator);
 
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // exit all thread caches
+    tb_default_allocator_cache_exit_all(allocator);
+#endif
+
     // enter
     tb_spinlock_enter(&allocator->base.lock);
 
@@ -78,6 +665,7 @@ static tb_void_t tb_default_allocator_exit(tb_allocator_ref_t self)
 
     // exit lock
     tb_spinlock_exit(&allocator->base.lock);
+    tb_spinlock_exit(&allocator->caches_lock);
 
     // exit allocator
     if (allocator->large_allocator) tb_allocator_large_free(allocator->large_allocator, allocator);
@@ -92,7 +680,7 @@ static tb_pointer_t tb_default_allocator_malloc(tb_allocator_ref_t self, tb_size
     tb_assert_and_check_return_val(allocator->large_allocator && allocator->small_allocator && size, tb_null);
 
     // done
-    return size <= TB_SMALL_ALLOCATOR_DATA_MAXN? tb_allocator_malloc_(allocator->small_allocator, size __tb_debug_args__) : tb_allocator_large_malloc_(allocator->large_allocator, size, tb_null __tb_debug_args__);
+    return size <= TB_SMALL_ALLOCATOR_DATA_MAXN? tb_default_allocator_small_malloc(allocator, size __tb_debug_args__) : tb_default_allocator_large_malloc(allocator, size __tb_debug_args__);
 }
 static tb_pointer_t tb_default_allocator_ralloc(tb_allocator_ref_t self, tb_pointer_t data, tb_size_t size __tb_debug_decl__)
 {
@@ -111,7 +699,7 @@ static tb_pointer_t tb_default_allocator_ralloc(tb_allocator_ref_t self, tb_poin
         if (!data)
         {
             // malloc it directly
-            data_new = size <= TB_SMALL_ALLOCATOR_DATA_MAXN? tb_allocator_malloc_(allocator->small_allocator, size __tb_debug_args__) : tb_allocator_large_malloc_(allocator->large_allocator, size, tb_null __tb_debug_args__);
+            data_new = size <= TB_SMALL_ALLOCATOR_DATA_MAXN? tb_default_allocator_small_malloc(allocator, size __tb_debug_args__) : tb_default_allocator_large_malloc(allocator, size __tb_debug_args__);
             break;
         }
 
@@ -122,35 +710,86 @@ static tb_pointer_t tb_default_allocator_ralloc(tb_allocator_ref_t self, tb_poin
 
         // small => small
         if (data_head->size <= TB_SMALL_ALLOCATOR_DATA_MAXN && size <= TB_SMALL_ALLOCATOR_DATA_MAXN)
+        {
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+            // the current thread has the cache? 
+            if (tb_default_allocator_cache(allocator, tb_false))
+            {
+                // the old and new data space
+                tb_size_t space_old = 0;
+                tb_size_t space_new = 0;
+                tb_size_t index_old = tb_small_allocator_class(allocator->small_allocator, data_head->size, &space_old);
+                tb_size_t index_new = tb_small_allocator_class(allocator->small_allocator, size, &space_new);
+
+                // check underflow
+                tb_assertf(space_old == data_head->size || ((tb_byte_t*)data)[data_head->size] == TB_POOL_DATA_PATCH, "data underflow");
+
+                // same space? only update size
+                if (index_old == index_new)
+                {
+#ifdef __tb_debug__
+                    // fill the patch bytes
+                    if (space_new > size) tb_memset_((tb_byte_t*)data + size, TB_POOL_DATA_PATCH, space_new - size);
+#endif
+                    data_head->size = size;
+                    data_new = data;
+                    break;
+                }
+
+                // make the new data from the thread cache
+                data_new = tb_default_allocator_small_malloc(allocator, size __tb_debug_args__);
+                tb_assert_and_check_break(data_new);
+
+                // copy the old data
+                tb_memcpy_(data_new, data, tb_min(data_head->size, size));
+
+                // free the old data to the thread cache
+                tb_default_allocator_small_free(allocator, data __tb_debug_args__);
+                break;
+            }
+#endif
             data_new = tb_allocator_ralloc_(allocator->small_allocator, data, size __tb_debug_args__);
+        }
         // small => large
         else if (data_head->size <= TB_SMALL_ALLOCATOR_DATA_MAXN)
         {
             // make the new data
-            data_new = tb_allocator_large_malloc_(allocator->large_allocator, size, tb_null __tb_debug_args__);
+            data_new = tb_default_allocator_large_malloc(allocator, size __tb_debug_args__);
             tb_assert_and_check_break(data_new);
 
             // copy the old data
             tb_memcpy_(data_new, data, tb_min(data_head->size, size));
 
             // free the old data
-            tb_allocator_free_(allocator->small_allocator, data __tb_debug_args__);
+            tb_default_allocator_small_free(allocator, data __tb_debug_args__);
         }
         // large => small
         else if (size <= TB_SMALL_ALLOCATOR_DATA_MAXN)
         {
             // make the new data
-            data_new = tb_allocator_malloc_(allocator->small_allocator, size __tb_debug_args__);
+            data_new = tb_default_allocator_small_malloc(allocator, size __tb_debug_args__);
             tb_assert_and_check_break(data_new);
 
             // copy the old data
             tb_memcpy_(data_new, data, tb_min(data_head->size, size));
 
             // free the old data
-            tb_allocator_large_free_(allocator->large_allocator, data __tb_debug_args__);
+            tb_default_allocator_large_free(allocator, data __tb_debug_args__);
         }
         // large => large
-        else data_new = tb_allocator_large_ralloc_(allocator->large_allocator, data, size, tb_null __tb_debug_args__);
+        else 
+        {
+            // the old size
+            tb_size_t size_old = data_head->size;
+
+            // ralloc it
+            data_new = tb_allocator_large_ralloc_(allocator->large_allocator, data, size, tb_null __tb_debug_args__);
+            tb_assert_and_check_break(data_new);
+
+            // update the statistics
+            tb_atomic_fetch_and_inc(&allocator->large_ralloc_count);
+            tb_default_allocator_large_update(allocator, (tb_long_t)size - (tb_long_t)size_old);
+        }
 
     } while (0);
 
@@ -175,13 +814,98 @@ static tb_bool_t tb_default_allocator_free(tb_allocator_ref_t self, tb_pointer_t
         tb_assertf(data_head->debug.magic == TB_POOL_DATA_MAGIC, "free invalid data: %p", data);
 
         // free it
-        ok = (data_head->size <= TB_SMALL_ALLOCATOR_DATA_MAXN)? tb_allocator_free_(allocator->small_allocator, data __tb_debug_args__) : tb_allocator_large_free_(allocator->large_allocator, data __tb_debug_args__);
+        ok = (data_head->size <= TB_SMALL_ALLOCATOR_DATA_MAXN)? tb_default_allocator_small_free(allocator, data __tb_debug_args__) : tb_default_allocator_large_free(allocator, data __tb_debug_args__);
 
     } while (0);
 
     // ok?
     return ok;
 }
+static tb_void_t tb_default_allocator_trim(tb_allocator_ref_t self)
+{
+    // check
+    tb_default_allocator_ref_t allocator = (tb_default_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator && allocator->large_allocator && allocator->small_allocator);
+
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // the thread caches of the other threads will be trimmed by themselves when they are accessed next time
+    tb_atomic_fetch_and_inc(&allocator->caches_trim);
+
+    // trim the thread cache of the current thread now
+    tb_default_allocator_cache_t* cache = tb_default_allocator_cache(allocator, tb_false);
+    if (cache) tb_default_allocator_cache_trim(cache);
+#endif
+
+    // trim the small allocator, the empty slots will be returned to the large allocator
+    tb_allocator_trim(allocator->small_allocator);
+
+    // trim the large allocator
+    tb_allocator_trim(allocator->large_allocator);
+}
+static tb_bool_t tb_default_allocator_stat(tb_allocator_ref_t self, tb_allocator_stat_t* stat)
+{
+    // check
+    tb_default_allocator_ref_t allocator = (tb_default_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && allocator->large_allocator && allocator->small_allocator && stat, tb_false);
+
+    // get the statistics of the small allocator, the data cached by the thread caches are live for it
+    if (!tb_allocator_stat(allocator->small_allocator, stat)) return tb_false;
+
+    // get the occupied size from the large allocator
+    tb_size_t large_size = (tb_size_t)tb_atomic_get(&allocator->large_size);
+    tb_size_t occupied_size = stat->occupied_size + large_size;
+    tb_allocator_stat_t* large_stat = (tb_allocator_stat_t*)tb_native_memory_malloc0(sizeof(tb_allocator_stat_t));
+    if (large_stat)
+    {
+        if (tb_allocator_stat(allocator->large_allocator, large_stat)) occupied_size = large_stat->occupied_size;
+        tb_native_memory_free(large_stat);
+    }
+
+    // the statistics of the thread caches
+    tb_size_t malloc_count = (tb_size_t)tb_atomic_get(&allocator->caches_malloc_count);
+    tb_size_t free_count = (tb_size_t)tb_atomic_get(&allocator->caches_free_count);
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    tb_size_t cached_size = 0;
+    tb_spinlock_enter(&allocator->caches_lock);
+    tb_for_all_if (tb_default_allocator_cache_t*, cache, tb_list_entry_itor(&allocator->caches), cache)
+    {
+        // the counts
+        tb_default_allocator_cache_stat_t cache_stat;
+        tb_default_allocator_cache_snapshot(cache, &cache_stat);
+        malloc_count    += cache_stat.malloc_count;
+        free_count      += cache_stat.free_count;
+        cached_size     += cache_stat.cached_size;
+
+        // the cached data count of each size class
+        tb_size_t i = 0;
+        for (i = 0; i < stat->class_count; i++) stat->classes[i].cached_count += tb_default_allocator_cache_load(&cache->bins[i].size);
+    }
+    tb_spinlock_leave(&allocator->caches_lock);
+
+    // the cached data are not live
+    tb_size_t i = 0;
+    for (i = 0; i < stat->class_count; i++)
+    {
+        stat->live_count            -= stat->classes[i].cached_count;
+        stat->classes[i].live_count -= stat->classes[i].cached_count;
+    }
+    stat->live_size -= cached_size;
+#endif
+
+    // save the statistics
+    tb_size_t large_malloc_count = (tb_size_t)tb_atomic_get(&allocator->large_malloc_count);
+    tb_size_t large_free_count = (tb_size_t)tb_atomic_get(&allocator->large_free_count);
+    stat->malloc_count  += malloc_count + large_malloc_count;
+    stat->ralloc_count  += (tb_size_t)tb_atomic_get(&allocator->large_ralloc_count);
+    stat->free_count    += free_count + large_free_count;
+    stat->live_count    += large_malloc_count - large_free_count;
+    stat->live_size     += large_size;
+    stat->peak_size     += allocator->large_peak;
+    stat->occupied_size = occupied_size;
+
+    // ok
+    return tb_true;
+}
 #ifdef __tb_debug__
 static tb_void_t tb_default_allocator_dump(tb_allocator_ref_t self)
 {
@@ -189,6 +913,28 @@ static tb_void_t tb_default_allocator_dump(tb_allocator_ref_t self)
     tb_default_allocator_ref_t allocator = (tb_default_allocator_ref_t)self;
     tb_assert_and_check_return(allocator && allocator->small_allocator);
 
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // dump the thread caches
+    tb_spinlock_enter(&allocator->caches_lock);
+    tb_for_all_if (tb_default_allocator_cache_t*, cache, tb_list_entry_itor(&allocator->caches), cache)
+    {
+        // the statistics
+        tb_default_allocator_cache_stat_t cache_stat;
+        tb_default_allocator_cache_snapshot(cache, &cache_stat);
+
+        // trace
+        tb_trace_i("cache[%p]: malloc: %lu, hit_rate: %lu/10000, free: %lu, hit_rate: %lu/10000, borrow: %lu, return: %lu, cached_size: %lu", cache
+                ,   cache_stat.malloc_count
+                ,   cache_stat.malloc_count? (cache_stat.malloc_hits * 10000) / cache_stat.malloc_count : 0
+                ,   cache_stat.free_count
+                ,   cache_stat.free_count? (cache_stat.free_hits * 10000) / cache_stat.free_count : 0
+                ,   cache_stat.borrow_count
+                ,   cache_stat.return_count
+                ,   cache_stat.cached_size);
+    }
+    tb_spinlock_leave(&allocator->caches_lock);
+#endif
+
     // dump allocator
     tb_allocator_dump(allocator->small_allocator);
 }
@@ -267,6 +1013,11 @@ static tb_void_t tb_default_allocator_instance_exit(tb_handle_t self, tb_cpointe
     tb_allocator_ref_t large_allocator = allocator->large_allocator;
     tb_assert_and_check_return(large_allocator);
 
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // exit all thread caches first for checking the leaked data
+    tb_default_allocator_cache_exit_all(allocator);
+#endif
+
 #ifdef __tb_debug__
     // dump allocator
     if (allocator) tb_allocator_dump((tb_allocator_ref_t)allocator);
@@ -306,6 +1057,10 @@ tb_allocator_ref_t tb_default_allocator(tb_byte_t* data, tb_size_t size)
     return (tb_allocator_ref_t)tb_singleton_instance(TB_SINGLETON_TYPE_DEFAULT_ALLOCATOR, tb_default_allocator_instance_init, tb_default_allocator_instance_exit, tb_null, tuple);
 }
 tb_allocator_ref_t tb_default_allocator_init(tb_allocator_ref_t large_allocator)
+{
+    return tb_default_allocator_init_with_classes(large_allocator, tb_null, 0);
+}
+tb_allocator_ref_t tb_default_allocator_init_with_classes(tb_allocator_ref_t large_allocator, tb_size_t const* classes, tb_size_t count)
 {
     // check
     tb_assert_and_check_return_val(large_allocator, tb_null);
@@ -325,17 +1080,27 @@ tb_allocator_ref_t tb_default_allocator_init(tb_allocator_ref_t large_allocator)
         allocator->base.ralloc          = tb_default_allocator_ralloc;
         allocator->base.free            = tb_default_allocator_free;
         allocator->base.exit            = tb_default_allocator_exit;
+        allocator->base.stat            = tb_default_allocator_stat;
+        allocator->base.trim            = tb_default_allocator_trim;
 #ifdef __tb_debug__
         allocator->base.dump            = tb_default_allocator_dump;
         allocator->base.have            = tb_default_allocator_have;
 #endif
 
+        // the small data will be allocated from the thread cache without the global lock
+        allocator->base.flag            = TB_ALLOCATOR_FLAG_NOLOCK;
+
         // init lock
         if (!tb_spinlock_init(&allocator->base.lock)) break;
 
+        // init thread caches
+        if (!tb_spinlock_init(&allocator->caches_lock)) break;
+        tb_list_entry_init(&allocator->caches, tb_default_allocator_cache_t, entry, tb_null);
+
         // init allocator
+        allocator->id              = (tb_size_t)tb_atomic_add_and_fetch(&g_default_allocator_id, 1);
         allocator->large_allocator = large_allocator;
-        allocator->small_allocator = tb_small_allocator_init(large_allocator);
+        allocator->small_allocator = tb_small_allocator_init_with_classes(large_allocator, classes, count);
         tb_assert_and_check_break(allocator->small_allocator);
 
         // register lock profiler
@@ -358,4 +1123,66 @@ tb_allocator_ref_t tb_default_allocator_init(tb_allocator_ref_t large_allocator)
     // ok?
     return (tb_allocator_ref_t)allocator;
 }
+tb_bool_t tb_default_allocator_cache_stat(tb_allocator_ref_t self, tb_default_allocator_cache_stat_t* stat)
+{
+    // check
+    tb_default_allocator_ref_t allocator = (tb_default_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && allocator->base.type == TB_ALLOCATOR_DEFAULT && stat, tb_false);
+
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // the thread cache of the current thread
+    tb_default_allocator_cache_t* cache = tb_default_allocator_cache(allocator, tb_false);
+    tb_check_return_val(cache, tb_false);
+
+    // save the statistics
+    tb_default_allocator_cache_snapshot(cache, stat);
+
+    // ok
+    return tb_true;
+#else
+    return tb_false;
+#endif
+}
+tb_void_t tb_default_allocator_cache_exit()
+{
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_ENABLE
+    // exit all thread caches of the current thread
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(g_default_allocator_cache); i++)
+    {
+        // the thread cache
+        tb_default_allocator_cache_t* cache = g_default_allocator_cache[i];
+        tb_check_continue(cache);
+
+        // clear it first, because the cached data may be freed again when exiting it
+        g_default_allocator_cache[i] = tb_null;
+
+        // enter, the allocator cannot be exited now
+        tb_spinlock_enter(&g_default_allocator_cache_lock);
+
+        // kill it if the allocator is still alive
+        tb_default_allocator_ref_t allocator = cache->allocator;
+        if (allocator)
+        {
+            // unregister it
+            tb_spinlock_enter(&allocator->caches_lock);
+            tb_list_entry_remove(&allocator->caches, &cache->entry);
+            tb_spinlock_leave(&allocator->caches_lock);
+
+            // kill it
+            tb_default_allocator_cache_kill(cache);
+        }
 
+        // leave
+        tb_spinlock_leave(&g_default_allocator_cache_lock);
+
+        // exit it
+        tb_native_memory_free(cache);
+    }
+
+#ifdef TB_DEFAULT_ALLOCATOR_CACHE_PTHREAD_KEY
+    // this thread has no cache now, we need not exit them again when the thread exits
+    if (g_default_allocator_cache_key_once == 2) pthread_setspecific(g_default_allocator_cache_key, tb_null);
+#endif
+#endif
+}
@@ -38,6 +38,36 @@
  */
 __tb_extern_c_enter__
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the thread cache statistics type of the default allocator
+typedef struct __tb_default_allocator_cache_stat_t
+{
+    /// the malloc count of the small data
+    tb_size_t                   malloc_count;
+
+    /// the malloc count which is hit in the thread cache
+    tb_size_t                   malloc_hits;
+
+    /// the free count of the small data
+    tb_size_t                   free_count;
+
+    /// the free count which need not return the data to the shared pools
+    tb_size_t                   free_hits;
+
+    /// the batch count of borrowing data from the shared pools
+    tb_size_t                   borrow_count;
+
+    /// the batch count of returning data to the shared pools
+    tb_size_t                   return_count;
+
+    /// the cached data size
+    tb_size_t                   cached_size;
+
+}tb_default_allocator_cache_stat_t;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
@@ -74,6 +104,19 @@ tb_allocator_ref_t          tb_default_allocator(tb_byte_t* data, tb_size_t size
  * |-----------------------------------------------------------------------------|
  * |                              default allocator                              |
  *  -----------------------------------------------------------------------------
+ *                                            |
+ *                                  --------------------- 
+ *                                 |     thread cache    | ...  one for each thread and allocator
+ *                                  ---------------------
+ *
+ * </pre>
+ *
+ * the small data is allocated from the thread cache without any lock,
+ * the thread cache borrows and returns the data of each size class in batches from the small allocator,
+ * and all cached data will be returned when the thread exits or the allocator is exited.
+ *
+ * each thread can keep the caches of 8 allocators at most,
+ * the other allocators whose ids are mapped to the same slots will use the shared pools directly.
  * 
  * @param large_allocator   the large allocator, cannot be null
  *
@@ -81,6 +124,40 @@ tb_allocator_ref_t          tb_default_allocator(tb_byte_t* data, tb_size_t size
  */
 tb_allocator_ref_t          tb_default_allocator_init(tb_allocator_ref_t large_allocator);
 
+/*! init the default allocator with the given size classes of the small allocator
+ *
+ * @param large_allocator   the large allocator, cannot be null
+ * @param classes           the size classes, see tb_small_allocator_init_with_classes()
+ * @param count             the size classes count
+ *
+ * @return                  the allocator 
+ */
+tb_allocator_ref_t          tb_default_allocator_init_with_classes(tb_allocator_ref_t large_allocator, tb_size_t const* classes, tb_size_t count);
+
+/*! get the thread cache statistics of the current thread
+ *
+ * @code
+    tb_default_allocator_cache_stat_t stat;
+    if (tb_default_allocator_cache_stat(tb_allocator(), &stat))
+    {
+        tb_trace_i("hit rate: %lu%%", stat.malloc_count? (stat.malloc_hits * 100) / stat.malloc_count : 0);
+    }
+ * @endcode
+ *
+ * @param allocator         the default allocator
+ * @param stat              the statistics 
+ *
+ * @return                  tb_true or tb_false if the current thread has no cache
+ */
+tb_bool_t                   tb_default_allocator_cache_stat(tb_allocator_ref_t allocator, tb_default_allocator_cache_stat_t* stat);
+
+/*! exit all thread caches of the current thread and return all cached data to the shared pools
+ *
+ * it will be called automatically when the thread exits,
+ * the threads which are not created by tb_thread_init() need call it only if the pthread key is not supported.
+ */
+tb_void_t                   tb_default_allocator_cache_exit(tb_noarg_t);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
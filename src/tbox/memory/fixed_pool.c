@@ -430,6 +430,20 @@ tb_size_t tb_fixed_pool_item_size(tb_fixed_pool_ref_t self)
     // the item size
     return pool->item_size;
 }
+tb_size_t tb_fixed_pool_occupied_size(tb_fixed_pool_ref_t self)
+{
+    // check
+    tb_fixed_pool_t* pool = (tb_fixed_pool_t*)self;
+    tb_assert_and_check_return_val(pool, 0);
+
+    // the size of all slots
+    tb_size_t i = 0;
+    tb_size_t size = 0;
+    for (i = 0; i < pool->slot_count; i++) size += pool->slot_list[i]->size;
+
+    // ok
+    return size;
+}
 tb_void_t tb_fixed_pool_clear(tb_fixed_pool_ref_t self)
 {
     // check
@@ -504,6 +518,23 @@ tb_void_t tb_fixed_pool_clear(tb_fixed_pool_ref_t self)
     // clear full slots
     tb_list_entry_clear(&pool->full_slots);
 }
+tb_void_t tb_fixed_pool_trim(tb_fixed_pool_ref_t self)
+{
+    // check
+    tb_fixed_pool_t* pool = (tb_fixed_pool_t*)self;
+    tb_assert_and_check_return(pool);
+
+    /* exit the current slot if it is empty
+     *
+     * the other empty slots have been exited when freeing the last data, 
+     * but the current slot is kept for the next allocation
+     */
+    if (pool->current_slot && pool->current_slot->pool && tb_static_fixed_pool_null(pool->current_slot->pool))
+    {
+        tb_fixed_pool_slot_exit(pool, pool->current_slot);
+        pool->current_slot = tb_null;
+    }
+}
 tb_pointer_t tb_fixed_pool_malloc_(tb_fixed_pool_ref_t self __tb_debug_decl__)
 {
     // check
@@ -174,12 +174,26 @@ tb_size_t                   tb_fixed_pool_size(tb_fixed_pool_ref_t pool);
  */
 tb_size_t                   tb_fixed_pool_item_size(tb_fixed_pool_ref_t pool);
 
+/*! the occupied size of all slots, including the free items and the slot heads
+ *
+ * @param pool              the pool 
+ *
+ * @return                  the occupied size
+ */
+tb_size_t                   tb_fixed_pool_occupied_size(tb_fixed_pool_ref_t pool);
+
 /*! clear pool
  *
  * @param pool              the pool 
  */
 tb_void_t                   tb_fixed_pool_clear(tb_fixed_pool_ref_t pool);
 
+/*! trim pool, return the empty slots to the large allocator
+ *
+ * @param pool              the pool 
+ */
+tb_void_t                   tb_fixed_pool_trim(tb_fixed_pool_ref_t pool);
+
 /*! malloc data
  *
  * @param pool              the pool 
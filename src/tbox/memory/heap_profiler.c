@@ -0,0 +1,556 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        heap_profiler.c
+ * @ingroup     memory
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "heap_profiler"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "heap_profiler.h"
+#include "../libc/libc.h"
+#include "../utils/utils.h"
+#include "../platform/platform.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the maximum frames count of the sampled backtrace
+#define TB_HEAP_PROFILER_FRAME_MAXN         (32)
+
+// the skipped frames count: tb_backtrace_frames, tb_heap_profiler_sample and tb_heap_profiler_malloc_
+#define TB_HEAP_PROFILER_FRAME_SKIP         (3)
+
+// the buckets count of the sampled data, must be the power of 2
+#define TB_HEAP_PROFILER_SAMPLE_BUCKETS     (4096)
+
+// the buckets count of the sampled backtraces, must be the power of 2
+#define TB_HEAP_PROFILER_STACK_BUCKETS      (1024)
+
+// the thread local storage for the sampling counter, we only use the shared counter if not supported
+#ifdef __tb_thread_local__
+#   define TB_HEAP_PROFILER_THREAD_LOCAL    __tb_thread_local__
+#else
+#   define TB_HEAP_PROFILER_THREAD_LOCAL 
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the heap profiler stack type
+typedef struct __tb_heap_profiler_stack_t
+{
+    // the next stack in the same bucket
+    struct __tb_heap_profiler_stack_t*  next;
+
+    // the hash value
+    tb_size_t                           hash;
+
+    // the live sampled data count
+    tb_size_t                           live_count;
+
+    // the live sampled data size
+    tb_size_t                           live_size;
+
+    // the total sampled data count
+    tb_hize_t                           alloc_count;
+
+    // the total sampled data size
+    tb_hize_t                           alloc_size;
+
+    // the frames count
+    tb_size_t                           frame_count;
+
+    // the frames
+    tb_pointer_t                        frames[TB_HEAP_PROFILER_FRAME_MAXN];
+
+}tb_heap_profiler_stack_t;
+
+// the heap profiler sample type
+typedef struct __tb_heap_profiler_sample_t
+{
+    // the next sample in the same bucket
+    struct __tb_heap_profiler_sample_t* next;
+
+    // the data address
+    tb_cpointer_t                       data;
+
+    // the data size
+    tb_size_t                           size;
+
+    // the stack
+    tb_heap_profiler_stack_t*           stack;
+
+}tb_heap_profiler_sample_t;
+
+// the heap profiler type
+typedef struct __tb_heap_profiler_t
+{
+    // the lock
+    tb_spinlock_t                       lock;
+
+    // the profiled allocator
+    tb_allocator_ref_t                  allocator;
+
+    // the sample rate
+    tb_size_t                           rate;
+
+    // the stacks count
+    tb_size_t                           stack_count;
+
+    /* the sampled data buckets
+     *
+     * it can be read without the lock for checking whether the freed data may be sampled,
+     * because the sampled data must have been inserted before it is freed.
+     */
+    tb_heap_profiler_sample_t* volatile samples[TB_HEAP_PROFILER_SAMPLE_BUCKETS];
+
+    // the stack buckets
+    tb_heap_profiler_stack_t*           stacks[TB_HEAP_PROFILER_STACK_BUCKETS];
+
+}tb_heap_profiler_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the heap profiler, it is never freed and can be accessed safely after stopping it
+static tb_heap_profiler_t                               g_heap_profiler = {TB_SPINLOCK_INIT};
+
+// the left bytes before sampling the next data for the current thread
+static TB_HEAP_PROFILER_THREAD_LOCAL tb_long_t          g_heap_profiler_left = 0;
+
+// the random seed for the sampling intervals of the current thread
+static TB_HEAP_PROFILER_THREAD_LOCAL tb_uint32_t        g_heap_profiler_seed = 0;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static __tb_inline__ tb_size_t tb_heap_profiler_sample_index(tb_cpointer_t data)
+{
+    // the data address is aligned, so we discard the low bits
+    tb_size_t addr = (tb_size_t)data >> 4;
+    return (addr ^ (addr >> 12)) & (TB_HEAP_PROFILER_SAMPLE_BUCKETS - 1);
+}
+static tb_long_t tb_heap_profiler_interval(tb_size_t rate)
+{
+    // the next random value by xorshift, the seed of each thread is different
+    tb_uint32_t x = g_heap_profiler_seed? g_heap_profiler_seed : ((tb_uint32_t)(tb_size_t)&g_heap_profiler_seed | 1);
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    g_heap_profiler_seed = x;
+
+    /* make the exponential distribution interval with the mean rate: -ln(q / 2^26) * rate
+     *
+     * q is in [1, 2^26] and log2(q) is approximated by the fixed-point value of 16.16, 
+     * -ln(q / 2^26) = (26 - log2(q)) * ln(2), and ln(2) * 2^16 = 45426
+     */
+    tb_uint32_t q = (x >> 6) + 1;
+    tb_uint32_t k = 31 - tb_bits_cl0_u32_be(q);
+    tb_uint64_t l = ((tb_uint64_t)k << 16) + ((((tb_uint64_t)(q - (1 << k))) << 16) >> k);
+    tb_uint64_t e = (((tb_uint64_t)26 << 16) - l) * 45426 >> 16;
+    tb_uint64_t n = ((tb_uint64_t)rate * e) >> 16;
+    return n? (tb_long_t)n : 1;
+}
+static tb_heap_profiler_stack_t* tb_heap_profiler_stack(tb_heap_profiler_t* profiler, tb_pointer_t const* frames, tb_size_t frame_count)
+{
+    // compute the hash value of the frames
+    tb_size_t i = 0;
+    tb_size_t hash = frame_count;
+    for (i = 0; i < frame_count; i++) hash = (hash * 31) ^ ((tb_size_t)frames[i] >> 2);
+
+    // find it
+    tb_heap_profiler_stack_t** bucket = &profiler->stacks[hash & (TB_HEAP_PROFILER_STACK_BUCKETS - 1)];
+    tb_heap_profiler_stack_t* stack = *bucket;
+    for (; stack; stack = stack->next)
+    {
+        if (stack->hash == hash && stack->frame_count == frame_count && !tb_memcmp_(stack->frames, frames, frame_count * sizeof(tb_pointer_t)))
+            return stack;
+    }
+
+    // make a new stack
+    stack = (tb_heap_profiler_stack_t*)tb_native_memory_malloc0(sizeof(tb_heap_profiler_stack_t));
+    tb_check_return_val(stack, tb_null);
+
+    // init it
+    stack->hash         = hash;
+    stack->frame_count  = frame_count;
+    tb_memcpy_(stack->frames, frames, frame_count * sizeof(tb_pointer_t));
+
+    // insert it
+    stack->next = *bucket;
+    *bucket = stack;
+    profiler->stack_count++;
+
+    // ok
+    return stack;
+}
+static tb_void_t tb_heap_profiler_sample(tb_heap_profiler_t* profiler, tb_cpointer_t data, tb_size_t size)
+{
+    // get the backtrace frames outside the lock
+    tb_pointer_t    frames[TB_HEAP_PROFILER_FRAME_MAXN];
+    tb_size_t       frame_count = tb_backtrace_frames(frames, tb_arrayn(frames), TB_HEAP_PROFILER_FRAME_SKIP);
+
+    // make the sample
+    tb_heap_profiler_sample_t* sample = (tb_heap_profiler_sample_t*)tb_native_memory_malloc0(sizeof(tb_heap_profiler_sample_t));
+    tb_check_return(sample);
+
+    // enter
+    tb_spinlock_enter(&profiler->lock);
+
+    // done
+    tb_bool_t ok = tb_false;
+    do
+    {
+        // have been stopped?
+        tb_check_break(profiler->allocator);
+
+        // the stack
+        tb_heap_profiler_stack_t* stack = tb_heap_profiler_stack(profiler, frames, frame_count);
+        tb_check_break(stack);
+
+        // update the stack
+        stack->live_count++;
+        stack->live_size += size;
+        stack->alloc_count++;
+        stack->alloc_size += size;
+
+        // insert the sample
+        tb_size_t index = tb_heap_profiler_sample_index(data);
+        sample->data    = data;
+        sample->size    = size;
+        sample->stack   = stack;
+        sample->next    = profiler->samples[index];
+        profiler->samples[index] = sample;
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // leave
+    tb_spinlock_leave(&profiler->lock);
+
+    // failed? exit the sample
+    if (!ok) tb_native_memory_free(sample);
+}
+static tb_void_t tb_heap_profiler_clear(tb_heap_profiler_t* profiler)
+{
+    // exit all samples
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(profiler->samples); i++)
+    {
+        tb_heap_profiler_sample_t* sample = profiler->samples[i];
+        while (sample)
+        {
+            tb_heap_profiler_sample_t* next = sample->next;
+            tb_native_memory_free(sample);
+            sample = next;
+        }
+        profiler->samples[i] = tb_null;
+    }
+
+    // exit all stacks
+    for (i = 0; i < tb_arrayn(profiler->stacks); i++)
+    {
+        tb_heap_profiler_stack_t* stack = profiler->stacks[i];
+        while (stack)
+        {
+            tb_heap_profiler_stack_t* next = stack->next;
+            tb_native_memory_free(stack);
+            stack = next;
+        }
+        profiler->stacks[i] = tb_null;
+    }
+    profiler->stack_count = 0;
+}
+static tb_bool_t tb_heap_profiler_writ(tb_file_ref_t file, tb_byte_t const* data, tb_size_t size)
+{
+    // write all data
+    tb_size_t writ = 0;
+    while (writ < size)
+    {
+        tb_long_t real = tb_file_writ(file, data + writ, size - writ);
+        tb_check_break(real > 0);
+        writ += real;
+    }
+
+    // ok?
+    return writ == size;
+}
+static tb_bool_t tb_heap_profiler_dump_stack(tb_file_ref_t file, tb_size_t live_count, tb_size_t live_size, tb_hize_t alloc_count, tb_hize_t alloc_size, tb_pointer_t const* frames, tb_size_t frame_count, tb_size_t rate)
+{
+    // dump the counts
+    tb_char_t line[64 + TB_HEAP_PROFILER_FRAME_MAXN * 20];
+    tb_long_t size = frames? tb_snprintf(line, sizeof(line), "%6lu: %8lu [%6llu: %8llu] @", live_count, live_size, alloc_count, alloc_size)
+                           : tb_snprintf(line, sizeof(line), "heap profile: %6lu: %8lu [%6llu: %8llu] @ heap_v2/%lu\n", live_count, live_size, alloc_count, alloc_size, rate);
+    tb_check_return_val(size > 0 && size < sizeof(line), tb_false);
+
+    // dump the frames
+    tb_size_t i = 0;
+    for (i = 0; i < frame_count; i++)
+    {
+        tb_long_t real = tb_snprintf(line + size, sizeof(line) - size, " %p", frames[i]);
+        tb_check_return_val(real > 0 && size + real < sizeof(line), tb_false);
+        size += real;
+    }
+    if (frames) line[size++] = '\n';
+
+    // write it
+    return tb_heap_profiler_writ(file, (tb_byte_t const*)line, size);
+}
+static tb_bool_t tb_heap_profiler_dump_maps(tb_file_ref_t file)
+{
+#ifdef TB_CONFIG_OS_LINUX
+    // the maps of the current process
+    tb_file_ref_t maps = tb_file_init("/proc/self/maps", TB_FILE_MODE_RO);
+    tb_check_return_val(maps, tb_false);
+
+    // dump the mapped libraries for symbolizing the frames
+    tb_bool_t ok = tb_heap_profiler_writ(file, (tb_byte_t const*)"\nMAPPED_LIBRARIES:\n", 19);
+    if (ok)
+    {
+        tb_byte_t   data[4096];
+        tb_long_t   real = 0;
+        while ((real = tb_file_read(maps, data, sizeof(data))) > 0)
+        {
+            ok = tb_heap_profiler_writ(file, data, real);
+            tb_check_break(ok);
+        }
+    }
+
+    // exit maps
+    tb_file_exit(maps);
+
+    // ok?
+    return ok;
+#else
+    return tb_true;
+#endif
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * hook implementation
+ */
+tb_void_t tb_heap_profiler_malloc_(tb_handle_t self, tb_cpointer_t data, tb_size_t size)
+{
+    // check
+    tb_heap_profiler_t* profiler = (tb_heap_profiler_t*)self;
+    tb_assert_and_check_return(profiler && data);
+
+    // the sample rate
+    tb_size_t rate = profiler->rate;
+    tb_check_return(rate);
+
+    // init the left bytes for the current thread
+    if (!g_heap_profiler_left) g_heap_profiler_left = tb_heap_profiler_interval(rate);
+
+    // need not sample it?
+    g_heap_profiler_left -= size;
+    tb_check_return(g_heap_profiler_left <= 0);
+
+    // sample it and make the next interval
+    g_heap_profiler_left = tb_heap_profiler_interval(rate);
+    tb_heap_profiler_sample(profiler, data, size);
+}
+tb_void_t tb_heap_profiler_free_(tb_handle_t self, tb_cpointer_t data)
+{
+    // check
+    tb_heap_profiler_t* profiler = (tb_heap_profiler_t*)self;
+    tb_assert_and_check_return(profiler && data);
+
+    // no sampled data in this bucket? it is the fast path for most data
+    tb_size_t index = tb_heap_profiler_sample_index(data);
+    tb_check_return(profiler->samples[index]);
+
+    // enter
+    tb_spinlock_enter(&profiler->lock);
+
+    // remove the sampled data
+    tb_heap_profiler_sample_t*  sample = tb_null;
+    tb_heap_profiler_sample_t** psample = (tb_heap_profiler_sample_t**)&profiler->samples[index];
+    for (; (sample = *psample); psample = &sample->next)
+    {
+        if (sample->data == data)
+        {
+            // update the stack
+            sample->stack->live_count--;
+            sample->stack->live_size -= sample->size;
+
+            // remove it
+            *psample = sample->next;
+            break;
+        }
+    }
+
+    // leave
+    tb_spinlock_leave(&profiler->lock);
+
+    // exit the sample
+    if (sample) tb_native_memory_free(sample);
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_bool_t tb_heap_profiler_start(tb_allocator_ref_t allocator, tb_size_t rate)
+{
+    // check
+    if (!allocator) allocator = tb_allocator();
+    tb_assert_and_check_return_val(allocator, tb_false);
+
+    // enter
+    tb_heap_profiler_t* profiler = &g_heap_profiler;
+    tb_spinlock_enter(&profiler->lock);
+
+    // start it
+    tb_bool_t ok = tb_false;
+    if (!profiler->allocator || profiler->allocator == allocator)
+    {
+        profiler->allocator = allocator;
+        profiler->rate      = rate? rate : TB_HEAP_PROFILER_RATE_DEFAULT;
+        allocator->profiler = (tb_handle_t)profiler;
+        ok = tb_true;
+    }
+
+    // leave
+    tb_spinlock_leave(&profiler->lock);
+
+    // ok?
+    return ok;
+}
+tb_void_t tb_heap_profiler_stop(tb_allocator_ref_t allocator)
+{
+    // check
+    if (!allocator) allocator = tb_allocator();
+    tb_assert_and_check_return(allocator);
+
+    // enter
+    tb_heap_profiler_t* profiler = &g_heap_profiler;
+    tb_spinlock_enter(&profiler->lock);
+
+    // stop it and clear all samples, the hooks may still be running but they will check it after entering the lock
+    if (profiler->allocator == allocator)
+    {
+        allocator->profiler = tb_null;
+        profiler->allocator = tb_null;
+        profiler->rate      = 0;
+        tb_heap_profiler_clear(profiler);
+    }
+
+    // leave
+    tb_spinlock_leave(&profiler->lock);
+}
+tb_bool_t tb_heap_profiler_dump(tb_allocator_ref_t allocator, tb_char_t const* path)
+{
+    // check
+    if (!allocator) allocator = tb_allocator();
+    tb_assert_and_check_return_val(allocator && path, tb_false);
+
+    // done
+    tb_bool_t                   ok = tb_false;
+    tb_file_ref_t               file = tb_null;
+    tb_heap_profiler_stack_t*   stacks = tb_null;
+    tb_size_t                   stack_count = 0;
+    tb_size_t                   rate = 0;
+    tb_heap_profiler_t*         profiler = &g_heap_profiler;
+    do
+    {
+        // snapshot all stacks, we do not write file in the lock
+        tb_spinlock_enter(&profiler->lock);
+        if (profiler->allocator == allocator && profiler->stack_count)
+        {
+            stacks = (tb_heap_profiler_stack_t*)tb_native_memory_malloc(profiler->stack_count * sizeof(tb_heap_profiler_stack_t));
+            if (stacks)
+            {
+                tb_size_t i = 0;
+                for (i = 0; i < tb_arrayn(profiler->stacks); i++)
+                {
+                    tb_heap_profiler_stack_t* stack = profiler->stacks[i];
+                    for (; stack; stack = stack->next) stacks[stack_count++] = *stack;
+                }
+            }
+        }
+        rate = profiler->allocator == allocator? profiler->rate : 0;
+        tb_spinlock_leave(&profiler->lock);
+
+        // not profiled?
+        tb_check_break(rate);
+
+        // the total counts
+        tb_size_t i = 0;
+        tb_size_t live_count = 0;
+        tb_size_t live_size = 0;
+        tb_hize_t alloc_count = 0;
+        tb_hize_t alloc_size = 0;
+        for (i = 0; i < stack_count; i++)
+        {
+            live_count  += stacks[i].live_count;
+            live_size   += stacks[i].live_size;
+            alloc_count += stacks[i].alloc_count;
+            alloc_size  += stacks[i].alloc_size;
+        }
+
+        // init file
+        file = tb_file_init(path, TB_FILE_MODE_WO | TB_FILE_MODE_CREAT | TB_FILE_MODE_TRUNC);
+        tb_assert_and_check_break(file);
+
+        // dump the header
+        if (!tb_heap_profiler_dump_stack(file, live_count, live_size, alloc_count, alloc_size, tb_null, 0, rate)) break;
+
+        // dump all stacks
+        for (i = 0; i < stack_count; i++)
+        {
+            tb_heap_profiler_stack_t* stack = &stacks[i];
+            if (!tb_heap_profiler_dump_stack(file, stack->live_count, stack->live_size, stack->alloc_count, stack->alloc_size, stack->frames, stack->frame_count, rate)) break;
+        }
+        tb_check_break(i == stack_count);
+
+        // dump the mapped libraries
+        if (!tb_heap_profiler_dump_maps(file)) break;
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // exit file
+    if (file) tb_file_exit(file);
+    file = tb_null;
+
+    // exit stacks
+    if (stacks) tb_native_memory_free(stacks);
+    stacks = tb_null;
+
+    // ok?
+    return ok;
+}
@@ -0,0 +1,133 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        heap_profiler.h
+ * @ingroup     memory
+ *
+ */
+#ifndef TB_MEMORY_HEAP_PROFILER_H
+#define TB_MEMORY_HEAP_PROFILER_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "allocator.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+/// the default sample rate of the heap profiler, sample one data for every 512KB on average
+#define TB_HEAP_PROFILER_RATE_DEFAULT       (512 * 1024)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+#ifndef TB_CONFIG_MICRO_ENABLE
+
+
+/*! start the sampled heap profiler for the given allocator
+ *
+ * the allocated data will be sampled with the random intervals (exponential distribution) 
+ * and the average interval is the sample rate in bytes, so the profiling overhead is very low
+ * and it can be used in the release mode.
+ *
+ * the backtrace of each sampled data is recorded by tb_backtrace_frames(), 
+ * and the sampled data will be removed when it is freed, so we can dump the live heap profile at any time.
+ *
+ * only one allocator can be profiled at the same time.
+ *
+ * @code
+    // start it
+    tb_heap_profiler_start(tb_allocator(), 0);
+
+    // ...
+
+    // dump the heap profile, and we can view it by `pprof --text ./demo /tmp/demo.heap`
+    tb_heap_profiler_dump(tb_allocator(), "/tmp/demo.heap");
+
+    // stop it
+    tb_heap_profiler_stop(tb_allocator());
+ * @endcode
+ *
+ * @param allocator     the allocator, using the global allocator if be null
+ * @param rate          the sample rate in bytes, using TB_HEAP_PROFILER_RATE_DEFAULT if be zero
+ *
+ * @return              tb_true or tb_false if the other allocator is being profiled
+ */
+tb_bool_t               tb_heap_profiler_start(tb_allocator_ref_t allocator, tb_size_t rate);
+
+/*! stop the heap profiler and clear all samples
+ *
+ * @param allocator     the allocator, using the global allocator if be null
+ */
+tb_void_t               tb_heap_profiler_stop(tb_allocator_ref_t allocator);
+
+/*! dump the live heap profile to the given file
+ *
+ * the profile is written in the legacy text format of the gperftools heap profiler (heap_v2),
+ * so it can be loaded by the pprof tools directly, and the mapped libraries will be appended on linux.
+ *
+ * <pre>
+ * heap profile:   <live count>: <live size> [<alloc count>: <alloc size>] @ heap_v2/<rate>
+ *                 <live count>: <live size> [<alloc count>: <alloc size>] @ <frame> <frame> ...
+ * ...
+ *
+ * MAPPED_LIBRARIES:
+ * ...
+ * </pre>
+ *
+ * @param allocator     the allocator, using the global allocator if be null
+ * @param path          the file path
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_heap_profiler_dump(tb_allocator_ref_t allocator, tb_char_t const* path);
+
+/*! sample the allocated data, it is the hook of the allocator and only be called if allocator->profiler exists
+ *
+ * @param profiler      the heap profiler of the allocator
+ * @param data          the allocated data
+ * @param size          the allocated size
+ */
+tb_void_t               tb_heap_profiler_malloc_(tb_handle_t profiler, tb_cpointer_t data, tb_size_t size);
+
+/*! remove the sampled data, it is the hook of the allocator and only be called if allocator->profiler exists
+ *
+ * @param profiler      the heap profiler of the allocator
+ * @param data          the freed data
+ */
+tb_void_t               tb_heap_profiler_free_(tb_handle_t profiler, tb_cpointer_t data);
+
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -32,6 +32,7 @@
 #include "memory.h"
 #include "native_large_allocator.h"
 #include "static_large_allocator.h"
+#include "region_large_allocator.h"
 
 
 #endif
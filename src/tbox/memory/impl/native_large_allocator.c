@@ -77,19 +77,12 @@ typedef struct __tb_native_large_allocator_t
     // the data list
     tb_list_entry_head_t            data_list;
 
-#ifdef __tb_debug__
     // the peak size
     tb_size_t                       peak_size;
 
     // the total size
     tb_size_t                       total_size;
 
-    // the real size
-    tb_size_t                       real_size;
-
-    // the occupied size
-    tb_size_t                       occupied_size;
-
     // the malloc count
     tb_size_t                       malloc_count;
 
@@ -98,6 +91,13 @@ typedef struct __tb_native_large_allocator_t
 
     // the free count
     tb_size_t                       free_count;
+
+#ifdef __tb_debug__
+    // the real size
+    tb_size_t                       real_size;
+
+    // the occupied size
+    tb_size_t                       occupied_size;
 #endif
 
 }tb_native_large_allocator_t, *tb_native_large_allocator_ref_t;
@@ -265,6 +265,7 @@ static tb_pointer_t tb_native_large_allocator_malloc(tb_allocator_ref_t self, tb
 
         // update the occupied size
         allocator->occupied_size += need - TB_POOL_DATA_HEAD_DIFF_SIZE - patch;
+#endif
 
         // update the total size
         allocator->total_size    += size;
@@ -274,7 +275,6 @@ static tb_pointer_t tb_native_large_allocator_malloc(tb_allocator_ref_t self, tb
 
         // update the malloc count
         allocator->malloc_count++;
-#endif
 
         // ok
         ok = tb_true;
@@ -339,14 +339,14 @@ static tb_pointer_t tb_native_large_allocator_ralloc(tb_allocator_ref_t self, tb
 
         // update the occupied size
         allocator->occupied_size -= base_head->size;
- 
-        // update the total size
-        allocator->total_size -= base_head->size;
 
         // the previous size
         tb_size_t prev_size = base_head->size;
 #endif
 
+        // update the total size
+        allocator->total_size -= base_head->size;
+
         // remove the data from the data_list
         tb_list_entry_remove(&allocator->data_list, &data_head->entry);
         removed = tb_true;
@@ -399,6 +399,7 @@ static tb_pointer_t tb_native_large_allocator_ralloc(tb_allocator_ref_t self, tb
 
         // update the occupied size
         allocator->occupied_size += size;
+#endif
 
         // update the total size
         allocator->total_size    += size;
@@ -408,7 +409,6 @@ static tb_pointer_t tb_native_large_allocator_ralloc(tb_allocator_ref_t self, tb
 
         // update the ralloc count
         allocator->ralloc_count++;
-#endif
 
         // ok
         ok = tb_true;
@@ -443,10 +443,8 @@ static tb_bool_t tb_native_large_allocator_free(tb_allocator_ref_t self, tb_poin
         // the data head
         data_head = &(((tb_native_large_data_head_t*)data)[-1]);
 
-#ifdef __tb_debug__
         // the base head
         tb_pool_data_head_t* base_head = tb_native_large_allocator_data_base(data_head);
-#endif
 
         // check
         tb_assertf(base_head->debug.magic != (tb_uint16_t)~TB_POOL_DATA_MAGIC, "double free data: %p", data);
@@ -466,13 +464,13 @@ static tb_bool_t tb_native_large_allocator_free(tb_allocator_ref_t self, tb_poin
 
         // for checking double-free
         base_head->debug.magic = (tb_uint16_t)~TB_POOL_DATA_MAGIC;
+#endif
 
         // update the total size
         allocator->total_size    -= base_head->size;
    
         // update the free count
         allocator->free_count++;
-#endif
 
         // remove the data from the data_list
         tb_list_entry_remove(&allocator->data_list, &data_head->entry);
@@ -522,16 +520,34 @@ static tb_void_t tb_native_large_allocator_clear(tb_allocator_ref_t self)
     } while (0);
 
     // clear info
-#ifdef __tb_debug__
     allocator->peak_size     = 0;
     allocator->total_size    = 0;
-    allocator->real_size     = 0;
-    allocator->occupied_size = 0;
     allocator->malloc_count  = 0;
     allocator->ralloc_count  = 0;
     allocator->free_count    = 0;
+#ifdef __tb_debug__
+    allocator->real_size     = 0;
+    allocator->occupied_size = 0;
 #endif
 }
+static tb_bool_t tb_native_large_allocator_stat(tb_allocator_ref_t self, tb_allocator_stat_t* stat)
+{
+    // check
+    tb_native_large_allocator_ref_t allocator = (tb_native_large_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && stat, tb_false);
+
+    // save the statistics
+    stat->malloc_count  = allocator->malloc_count;
+    stat->ralloc_count  = allocator->ralloc_count;
+    stat->free_count    = allocator->free_count;
+    stat->live_count    = allocator->malloc_count - allocator->free_count;
+    stat->live_size     = allocator->total_size;
+    stat->peak_size     = allocator->peak_size;
+    stat->occupied_size = allocator->total_size + stat->live_count * sizeof(tb_native_large_data_head_t);
+
+    // ok
+    return tb_true;
+}
 static tb_void_t tb_native_large_allocator_exit(tb_allocator_ref_t self)
 {
     // check
@@ -612,6 +628,7 @@ tb_allocator_ref_t tb_native_large_allocator_init()
         allocator->base.large_free       = tb_native_large_allocator_free;
         allocator->base.clear            = tb_native_large_allocator_clear;
         allocator->base.exit             = tb_native_large_allocator_exit;
+        allocator->base.stat             = tb_native_large_allocator_stat;
 #ifdef __tb_debug__
         allocator->base.dump             = tb_native_large_allocator_dump;
         allocator->base.have             = tb_native_large_allocator_have;
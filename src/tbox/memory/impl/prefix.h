@@ -45,6 +45,9 @@
 // the pool data magic number
 #define TB_POOL_DATA_MAGIC                  (0xdead)
 
+// the pool data magic number of the data in the thread cache
+#define TB_POOL_DATA_CACHE_MAGIC            (0xdeac)
+
 // the pool data empty magic number
 #define TB_POOL_DATA_EMPTY_MAGIC            (0xdeaf)
 
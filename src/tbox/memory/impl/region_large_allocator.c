@@ -0,0 +1,1074 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        region_large_allocator.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "region_large_allocator"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "region_large_allocator.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the region size, it is equal to the transparent huge page size on the most platforms
+#define TB_REGION_LARGE_ALLOCATOR_REGION_SIZE           (1 << 21)
+
+// the maximum pages count of the region, the page size is 4KB at least
+#define TB_REGION_LARGE_ALLOCATOR_PAGES_MAXN            (TB_REGION_LARGE_ALLOCATOR_REGION_SIZE >> 12)
+
+// the maximum count of the shared regions for finding the free pages
+#define TB_REGION_LARGE_ALLOCATOR_FIND_MAXN             (16)
+
+// the maximum count of the idle regions
+#define TB_REGION_LARGE_ALLOCATOR_IDLE_MAXN             (32)
+
+// the maximum size of the idle regions, 128MB
+#define TB_REGION_LARGE_ALLOCATOR_IDLE_SIZE             (TB_REGION_LARGE_ALLOCATOR_REGION_SIZE << 6)
+
+// the region of the given data head
+#define tb_region_large_allocator_region(data_head)     ((tb_region_large_region_t*)((tb_size_t)(data_head) & ~(tb_size_t)(TB_REGION_LARGE_ALLOCATOR_REGION_SIZE - 1)))
+
+// the region large allocator data base
+#define tb_region_large_allocator_data_base(data_head)  (&(((tb_pool_data_head_t*)((tb_region_large_data_head_t*)(data_head) + 1))[-1]))
+
+// the page bits
+#define tb_region_large_allocator_bit_set(bits, i)      ((bits)[(i) / TB_CPU_BITSIZE] |= ((tb_size_t)1 << ((i) % TB_CPU_BITSIZE)))
+#define tb_region_large_allocator_bit_clr(bits, i)      ((bits)[(i) / TB_CPU_BITSIZE] &= ~((tb_size_t)1 << ((i) % TB_CPU_BITSIZE)))
+#define tb_region_large_allocator_bit_get(bits, i)      ((bits)[(i) / TB_CPU_BITSIZE] & ((tb_size_t)1 << ((i) % TB_CPU_BITSIZE)))
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the region large data head type
+typedef __tb_pool_data_aligned__ struct __tb_region_large_data_head_t
+{
+    // the pages count of this data, including the data head
+    tb_size_t                       pages;
+
+    // the data head base
+    tb_byte_t                       base[sizeof(tb_pool_data_head_t)];
+
+}__tb_pool_data_aligned__ tb_region_large_data_head_t;
+
+/* the region type, it is placed at the first page of the region
+ *
+ * <pre>
+ * shared region: 
+ *
+ *  ---------------------------------------------------------------------------
+ * |  region  | data_head | data | data_head |     data     |       ...        |
+ *  ---------------------------------------------------------------------------
+ * |   page   |       pages      |          pages           |                  |
+ * |                               2MB-aligned                                 |
+ *
+ * direct region:
+ *
+ *  ---------------------------------------------------------------------------
+ * |  region  | data_head |                        data                  ...   |
+ *  ---------------------------------------------------------------------------
+ * |   page   |                           pages                          ...   |
+ * |                         2MB-aligned, size >= 512KB                        |
+ * </pre>
+ */
+typedef struct __tb_region_large_region_t
+{
+    // the list entry
+    tb_list_entry_t                 entry;
+
+    // the allocator reference for checking data
+    tb_pointer_t                    allocator;
+
+    // the region size
+    tb_size_t                       size;
+
+    // the numa node, -1: unknown
+    tb_long_t                       node;
+
+    // the used pages count, the first page of the region head is not counted
+    tb_size_t                       used;
+
+    // is the direct region for only one large data?
+    tb_bool_t                       direct;
+
+    // the used page bits
+    tb_size_t                       used_bits[TB_REGION_LARGE_ALLOCATOR_PAGES_MAXN / TB_CPU_BITSIZE];
+
+    // the head page bits of all data
+    tb_size_t                       head_bits[TB_REGION_LARGE_ALLOCATOR_PAGES_MAXN / TB_CPU_BITSIZE];
+
+}tb_region_large_region_t;
+
+// the idle region type
+typedef struct __tb_region_large_idle_t
+{
+    // the region data
+    tb_pointer_t                    data;
+
+    // the region size
+    tb_size_t                       size;
+
+    // the numa node
+    tb_long_t                       node;
+
+}tb_region_large_idle_t;
+
+/*! the region large allocator type
+ *
+ * <pre>
+ *
+ * shared_list: |region| <=> |region| <=> ... <=> |region|       : for the data <= 1/4 region 
+ * direct_list: |region| <=> |region| <=> ... <=> |region|       : for the data >  1/4 region
+ * idle:        |region|region|region| ... |region|               : the freed regions, their pages are freed lazily
+ *
+ * </pre>
+ */
+typedef struct __tb_region_large_allocator_t
+{
+    // the base
+    tb_allocator_t                  base;
+
+    // the flags
+    tb_size_t                       flags;
+
+    // the page size
+    tb_size_t                       page_size;
+
+    // the pages count of the shared region
+    tb_size_t                       region_pages;
+
+    // the shared regions, the recently freed region will be moved to the head
+    tb_list_entry_head_t            shared_list;
+
+    // the direct regions
+    tb_list_entry_head_t            direct_list;
+
+    // the idle regions
+    tb_region_large_idle_t          idle[TB_REGION_LARGE_ALLOCATOR_IDLE_MAXN];
+
+    // the idle regions count
+    tb_size_t                       idle_count;
+
+    // the idle regions size
+    tb_size_t                       idle_size;
+
+    // the peak size
+    tb_size_t                       peak_size;
+
+    // the total size
+    tb_size_t                       total_size;
+
+    // the malloc count
+    tb_size_t                       malloc_count;
+
+    // the ralloc count
+    tb_size_t                       ralloc_count;
+
+    // the free count
+    tb_size_t                       free_count;
+
+#ifdef __tb_debug__
+    // the real size
+    tb_size_t                       real_size;
+
+    // the occupied size
+    tb_size_t                       occupied_size;
+
+    // the region count
+    tb_size_t                       region_count;
+
+    // the reused idle region count
+    tb_size_t                       reuse_count;
+#endif
+
+}tb_region_large_allocator_t, *tb_region_large_allocator_ref_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+#ifdef __tb_debug__
+static tb_void_t tb_region_large_allocator_check_data(tb_region_large_allocator_ref_t allocator, tb_region_large_data_head_t const* data_head)
+{
+    // check
+    tb_assert_and_check_return(allocator && data_head);
+
+    // done
+    tb_bool_t           ok = tb_false;
+    tb_byte_t const*    data = (tb_byte_t const*)&(data_head[1]);
+    do
+    {
+        // the base head
+        tb_pool_data_head_t* base_head = tb_region_large_allocator_data_base(data_head);
+
+        // check
+        tb_assertf_pass_break(base_head->debug.magic != (tb_uint16_t)~TB_POOL_DATA_MAGIC, "data have been freed: %p", data);
+        tb_assertf_pass_break(base_head->debug.magic == TB_POOL_DATA_MAGIC, "the invalid data: %p", data);
+        tb_assertf_pass_break(((tb_byte_t*)data)[base_head->size] == TB_POOL_DATA_PATCH, "data underflow");
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed? dump it
+    if (!ok) 
+    {
+        // dump data
+        tb_pool_data_dump(data, tb_true, "[region_large_allocator]: [error]: ");
+
+        // abort
+        tb_abort();
+    }
+}
+#endif
+static tb_region_large_region_t* tb_region_large_allocator_region_make(tb_region_large_allocator_ref_t allocator, tb_size_t size, tb_bool_t direct)
+{
+    // check
+    tb_assert(allocator && size && !(size & (allocator->page_size - 1)));
+
+    // the numa node of the current thread
+    tb_long_t node = (allocator->flags & TB_LARGE_ALLOCATOR_FLAG_NUMA)? tb_processor_node() : -1;
+
+    // attempt to reuse the recently idle region on the same node, the wasted space cannot be larger than 1/4
+    tb_byte_t*  data = tb_null;
+    tb_size_t   i = allocator->idle_count;
+    while (i--)
+    {
+        tb_region_large_idle_t* idle = &allocator->idle[i];
+        if (idle->node == node && idle->size >= size && idle->size - size <= (size >> 2))
+        {
+            // reuse it
+            data = (tb_byte_t*)idle->data;
+            size = idle->size;
+
+            // remove it from the idle regions
+            allocator->idle_size -= size;
+            allocator->idle_count--;
+            if (i < allocator->idle_count) tb_memmov_(idle, idle + 1, (allocator->idle_count - i) * sizeof(tb_region_large_idle_t));
+
+#ifdef __tb_debug__
+            // update the reuse count
+            allocator->reuse_count++;
+#endif
+            break;
+        }
+    }
+
+    // make a new region
+    if (!data)
+    {
+        // reserve the 2MB-aligned address space
+        data = (tb_byte_t*)tb_virtual_memory_reserve_align(size, TB_REGION_LARGE_ALLOCATOR_REGION_SIZE);
+        tb_check_return_val(data, tb_null);
+
+        // commit it
+        if (!tb_virtual_memory_commit(data, size))
+        {
+            tb_virtual_memory_release(data, size);
+            return tb_null;
+        }
+
+        // back it by the transparent huge pages, it need be advised before touching these pages
+        if (allocator->flags & TB_LARGE_ALLOCATOR_FLAG_HUGEPAGE)
+            tb_virtual_memory_advise(data, size, TB_VIRTUAL_MEMORY_ADVICE_HUGEPAGE);
+
+        // bind it to the numa node of the current thread 
+        if (node >= 0) tb_virtual_memory_bind(data, size, (tb_size_t)node);
+    }
+
+    // init region
+    tb_region_large_region_t* region = (tb_region_large_region_t*)data;
+    tb_memset_(region, 0, sizeof(tb_region_large_region_t));
+    region->allocator   = (tb_pointer_t)allocator;
+    region->size        = size;
+    region->node        = node;
+    region->direct      = direct;
+
+    // the first page is used by the region head
+    tb_region_large_allocator_bit_set(region->used_bits, 0);
+
+#ifdef __tb_debug__
+    // update the region count
+    allocator->region_count++;
+#endif
+
+    // ok
+    return region;
+}
+static tb_void_t tb_region_large_allocator_region_exit(tb_region_large_allocator_ref_t allocator, tb_region_large_region_t* region)
+{
+    // check
+    tb_assert(allocator && region);
+
+    // the region data and size
+    tb_pointer_t    data = (tb_pointer_t)region;
+    tb_size_t       size = region->size;
+
+#ifdef __tb_debug__
+    // update the region count
+    allocator->region_count--;
+#endif
+
+    // too large? release it directly
+    if (size > TB_REGION_LARGE_ALLOCATOR_IDLE_SIZE)
+    {
+        tb_virtual_memory_release(data, size);
+        return ;
+    }
+
+    // release the oldest idle regions if there are too many idle regions
+    while (allocator->idle_count && (allocator->idle_count >= TB_REGION_LARGE_ALLOCATOR_IDLE_MAXN || allocator->idle_size + size > TB_REGION_LARGE_ALLOCATOR_IDLE_SIZE))
+    {
+        tb_region_large_idle_t* idle = &allocator->idle[0];
+        tb_virtual_memory_release(idle->data, idle->size);
+        allocator->idle_size -= idle->size;
+        allocator->idle_count--;
+        if (allocator->idle_count) tb_memmov_(idle, idle + 1, allocator->idle_count * sizeof(tb_region_large_idle_t));
+    }
+
+    /* free its pages lazily and cache it
+     *
+     * the physical pages will be reclaimed by the system only under the memory pressure,
+     * so it is cheap to reuse it if the pages have not been reclaimed.
+     */
+    if (tb_virtual_memory_advise(data, size, TB_VIRTUAL_MEMORY_ADVICE_FREE))
+    {
+        tb_region_large_idle_t* idle = &allocator->idle[allocator->idle_count++];
+        idle->data = data;
+        idle->size = size;
+        idle->node = region->node;
+        allocator->idle_size += size;
+    }
+    // not supported? release it
+    else tb_virtual_memory_release(data, size);
+}
+static tb_size_t tb_region_large_allocator_region_find(tb_region_large_allocator_ref_t allocator, tb_region_large_region_t* region, tb_size_t pages)
+{
+    // check
+    tb_assert(allocator && region && pages);
+
+    // find the free pages with first-fit, the first page is used by the region head
+    tb_size_t i = 1;
+    tb_size_t n = 0;
+    tb_size_t m = allocator->region_pages;
+    tb_size_t p = 0;
+    while (i < m)
+    {
+        // skip the full bits quickly
+        if (!(i % TB_CPU_BITSIZE) && region->used_bits[i / TB_CPU_BITSIZE] == (tb_size_t)-1) 
+        {
+            i += TB_CPU_BITSIZE;
+            n = 0;
+            continue;
+        }
+
+        // the used page?
+        if (tb_region_large_allocator_bit_get(region->used_bits, i)) n = 0;
+        else
+        {
+            // the start page
+            if (!n) p = i;
+
+            // ok?
+            if (++n == pages) return p;
+        }
+
+        // next
+        i++;
+    }
+
+    // not found
+    return 0;
+}
+static tb_void_t tb_region_large_allocator_region_mark(tb_region_large_region_t* region, tb_size_t index, tb_size_t pages, tb_bool_t used)
+{
+    // check
+    tb_assert(region);
+
+    // mark pages
+    tb_size_t i = index;
+    tb_size_t e = index + pages;
+    if (used) 
+    {
+        for (; i < e; i++) tb_region_large_allocator_bit_set(region->used_bits, i);
+        region->used += pages;
+    }
+    else 
+    {
+        for (; i < e; i++) tb_region_large_allocator_bit_clr(region->used_bits, i);
+        region->used -= pages;
+    }
+}
+static tb_region_large_data_head_t* tb_region_large_allocator_malloc_done(tb_region_large_allocator_ref_t allocator, tb_size_t size, tb_size_t* real __tb_debug_decl__)
+{
+    // check
+    tb_assert_and_check_return_val(allocator && allocator->page_size, tb_null);
+
+    // done 
+#ifdef __tb_debug__
+    tb_size_t                       patch = 1; // patch 0xcc
+#else
+    tb_size_t                       patch = 0;
+#endif
+    tb_size_t                       need = sizeof(tb_region_large_data_head_t) + size + patch;
+    tb_size_t                       pages = tb_align(need, allocator->page_size) / allocator->page_size;
+    tb_size_t                       index = 0;
+    tb_region_large_region_t*       region = tb_null;
+    tb_region_large_data_head_t*    data_head = tb_null;
+    do
+    {
+        // check
+        tb_assert_and_check_break(need > size && pages);
+
+        // the large data? make a direct region for it
+        if (pages > (allocator->region_pages >> 2))
+        {
+            // make region
+            region = tb_region_large_allocator_region_make(allocator, (pages + 1) * allocator->page_size, tb_true);
+            tb_check_break(region);
+
+            // save it
+            tb_list_entry_insert_tail(&allocator->direct_list, &region->entry);
+            index = 1;
+        }
+        else
+        {
+            // the numa node of the current thread
+            tb_long_t node = (allocator->flags & TB_LARGE_ALLOCATOR_FLAG_NUMA)? tb_processor_node() : -1;
+
+            // find the free pages from the recently used regions
+            tb_size_t               findn = 0;
+            tb_list_entry_ref_t     entry = tb_list_entry_head(&allocator->shared_list);
+            tb_list_entry_ref_t     tail = tb_list_entry_tail(&allocator->shared_list);
+            while (entry != tail && findn++ < TB_REGION_LARGE_ALLOCATOR_FIND_MAXN)
+            {
+                // the region
+                tb_region_large_region_t* item = (tb_region_large_region_t*)tb_list_entry(&allocator->shared_list, entry);
+                if (item->node == node && item->used + pages < allocator->region_pages)
+                {
+                    // find the free pages
+                    index = tb_region_large_allocator_region_find(allocator, item, pages);
+                    if (index) 
+                    {
+                        region = item;
+                        break;
+                    }
+                }
+
+                // next
+                entry = tb_list_entry_next(entry);
+            }
+
+            // not found? make a new shared region
+            if (!region)
+            {
+                // make region
+                region = tb_region_large_allocator_region_make(allocator, TB_REGION_LARGE_ALLOCATOR_REGION_SIZE, tb_false);
+                tb_check_break(region);
+
+                // save it
+                tb_list_entry_insert_head(&allocator->shared_list, &region->entry);
+                index = 1;
+            }
+        }
+
+        // mark the data pages
+        tb_region_large_allocator_region_mark(region, index, pages, tb_true);
+        tb_region_large_allocator_bit_set(region->head_bits, index);
+
+        // init the data head
+        data_head = (tb_region_large_data_head_t*)((tb_byte_t*)region + index * allocator->page_size);
+        data_head->pages = pages;
+
+        // the base head
+        tb_pool_data_head_t* base_head = tb_region_large_allocator_data_base(data_head);
+
+        // the real size
+        tb_size_t size_real = real? (pages * allocator->page_size - sizeof(tb_region_large_data_head_t) - patch) : size;
+
+        // save the real size
+        if (real) *real = size_real;
+        base_head->size = (tb_uint32_t)size_real;
+
+#ifdef __tb_debug__
+        base_head->debug.magic     = TB_POOL_DATA_MAGIC;
+        base_head->debug.file      = file_;
+        base_head->debug.func      = func_;
+        base_head->debug.line      = (tb_uint16_t)line_;
+
+        // save backtrace
+        tb_pool_data_save_backtrace(&base_head->debug, 6);
+
+        // make the dirty data and patch 0xcc for checking underflow
+        tb_memset_((tb_pointer_t)&(data_head[1]), TB_POOL_DATA_PATCH, size_real + patch);
+
+        // update the real size
+        allocator->real_size     += size_real;
+
+        // update the occupied size
+        allocator->occupied_size += pages * allocator->page_size;
+#endif
+
+        // update the total size
+        allocator->total_size    += size_real;
+
+        // update the peak size
+        if (allocator->total_size > allocator->peak_size) allocator->peak_size = allocator->total_size;
+
+        // update the malloc count
+        allocator->malloc_count++;
+
+    } while (0);
+
+    // ok?
+    return data_head;
+}
+static tb_bool_t tb_region_large_allocator_ralloc_fast(tb_region_large_allocator_ref_t allocator, tb_region_large_region_t* region, tb_region_large_data_head_t* data_head, tb_size_t size, tb_size_t* real __tb_debug_decl__)
+{
+    // check
+    tb_assert(allocator && region && data_head);
+
+    // done 
+#ifdef __tb_debug__
+    tb_size_t                       patch = 1; // patch 0xcc
+#else
+    tb_size_t                       patch = 0;
+#endif
+    tb_size_t                       need = sizeof(tb_region_large_data_head_t) + size + patch;
+    tb_size_t                       pages = tb_align(need, allocator->page_size) / allocator->page_size;
+    tb_size_t                       index = ((tb_byte_t*)data_head - (tb_byte_t*)region) / allocator->page_size;
+    tb_check_return_val(need > size && pages, tb_false);
+
+    // the direct region? only shrink it in place if it is still large data
+    if (region->direct)
+    {
+        tb_check_return_val(pages <= data_head->pages && pages > (allocator->region_pages >> 2), tb_false);
+    }
+    // the shared region
+    else
+    {
+        // too large now? 
+        tb_check_return_val(pages <= (allocator->region_pages >> 2), tb_false);
+
+        // grow it in place if the next pages are free
+        if (pages > data_head->pages)
+        {
+            // check the next pages
+            tb_size_t i = index + data_head->pages;
+            tb_size_t e = index + pages;
+            tb_check_return_val(e <= allocator->region_pages, tb_false);
+            for (; i < e; i++) 
+                if (tb_region_large_allocator_bit_get(region->used_bits, i)) return tb_false;
+
+            // mark them
+            tb_region_large_allocator_region_mark(region, index + data_head->pages, pages - data_head->pages, tb_true);
+            data_head->pages = pages;
+        }
+        // shrink it in place and free the left pages
+        else if (pages < data_head->pages)
+        {
+            tb_region_large_allocator_region_mark(region, index + pages, data_head->pages - pages, tb_false);
+            data_head->pages = pages;
+        }
+    }
+
+    // the base head
+    tb_pool_data_head_t* base_head = tb_region_large_allocator_data_base(data_head);
+
+    // the previous size
+    tb_size_t prev_size = base_head->size;
+
+    // the real size
+    tb_size_t size_real = real? (data_head->pages * allocator->page_size - sizeof(tb_region_large_data_head_t) - patch) : size;
+
+    // save the real size
+    if (real) *real = size_real;
+    base_head->size = (tb_uint32_t)size_real;
+
+#ifdef __tb_debug__
+    base_head->debug.file      = file_;
+    base_head->debug.func      = func_;
+    base_head->debug.line      = (tb_uint16_t)line_;
+
+    // update backtrace
+    tb_pool_data_save_backtrace(&base_head->debug, 6);
+
+    // make the dirty data 
+    if (size_real > prev_size) tb_memset_((tb_byte_t*)&(data_head[1]) + prev_size, TB_POOL_DATA_PATCH, size_real - prev_size);
+
+    // patch 0xcc for checking underflow
+    ((tb_byte_t*)&(data_head[1]))[size_real] = TB_POOL_DATA_PATCH;
+
+    // update the real size
+    allocator->real_size     += size_real;
+    allocator->real_size     -= prev_size;
+
+    // update the occupied size
+    allocator->occupied_size += size_real;
+    allocator->occupied_size -= prev_size;
+#endif
+
+    // update the total size
+    allocator->total_size    += size_real;
+    allocator->total_size    -= prev_size;
+
+    // update the peak size
+    if (allocator->total_size > allocator->peak_size) allocator->peak_size = allocator->total_size;
+
+    // update the ralloc count
+    allocator->ralloc_count++;
+
+    // ok
+    return tb_true;
+}
+static tb_region_large_region_t* tb_region_large_allocator_check(tb_region_large_allocator_ref_t allocator, tb_region_large_data_head_t* data_head)
+{
+    // the region
+    tb_region_large_region_t* region = tb_region_large_allocator_region(data_head);
+
+    // the page index of the data head
+    tb_size_t index = ((tb_byte_t*)data_head - (tb_byte_t*)region) / allocator->page_size;
+
+    // check
+    tb_assertf_and_check_return_val(region->allocator == (tb_pointer_t)allocator, tb_null, "the data: %p not belong to allocator: %p", &data_head[1], allocator);
+    tb_assertf_and_check_return_val(!(((tb_size_t)data_head) & (allocator->page_size - 1)) && index && index < allocator->region_pages, tb_null, "the invalid data: %p", &data_head[1]);
+    tb_assertf_and_check_return_val(tb_region_large_allocator_bit_get(region->head_bits, index), tb_null, "the data: %p has been freed or invalid", &data_head[1]);
+
+    // ok
+    return region;
+}
+static tb_bool_t tb_region_large_allocator_free(tb_allocator_ref_t self, tb_pointer_t data __tb_debug_decl__);
+static tb_pointer_t tb_region_large_allocator_malloc(tb_allocator_ref_t self, tb_size_t size, tb_size_t* real __tb_debug_decl__)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator, tb_null);
+
+    // malloc it
+    tb_region_large_data_head_t* data_head = tb_region_large_allocator_malloc_done(allocator, size, real __tb_debug_args__);
+
+    // ok?
+    return data_head? (tb_pointer_t)&(data_head[1]) : tb_null;
+}
+static tb_pointer_t tb_region_large_allocator_ralloc(tb_allocator_ref_t self, tb_pointer_t data, tb_size_t size, tb_size_t* real __tb_debug_decl__)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && data, tb_null);
+
+    // done
+    tb_bool_t                       ok = tb_false;
+    tb_byte_t*                      data_real = tb_null;
+    tb_region_large_data_head_t*    data_head = tb_null;
+    tb_region_large_data_head_t*    aloc_head = tb_null;
+    do
+    {
+        // the data head
+        data_head = &(((tb_region_large_data_head_t*)data)[-1]);
+
+        // the base head
+        tb_pool_data_head_t* base_head = tb_region_large_allocator_data_base(data_head);
+
+        // check
+        tb_assertf(base_head->debug.magic != (tb_uint16_t)~TB_POOL_DATA_MAGIC, "ralloc freed data: %p", data);
+        tb_assertf(base_head->debug.magic == TB_POOL_DATA_MAGIC, "ralloc invalid data: %p", data);
+        tb_assertf(((tb_byte_t*)data)[base_head->size] == TB_POOL_DATA_PATCH, "data underflow");
+
+        // check the region
+        tb_region_large_region_t* region = tb_region_large_allocator_check(allocator, data_head);
+        tb_check_break(region);
+
+        // attempt to ralloc it in place
+        if (tb_region_large_allocator_ralloc_fast(allocator, region, data_head, size, real __tb_debug_args__))
+            aloc_head = data_head;
+        else
+        {
+            // malloc it
+            aloc_head = tb_region_large_allocator_malloc_done(allocator, size, real __tb_debug_args__);
+            tb_check_break(aloc_head);
+
+            // copy the data
+            tb_memcpy_((tb_pointer_t)&aloc_head[1], data, tb_min(base_head->size, size));
+
+            // free the previous data
+            tb_region_large_allocator_free(self, data __tb_debug_args__);
+        }
+
+        // the real data
+        data_real = (tb_byte_t*)&aloc_head[1];
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok) data_real = tb_null;
+
+    // ok?
+    return (tb_pointer_t)data_real;
+}
+static tb_bool_t tb_region_large_allocator_free(tb_allocator_ref_t self, tb_pointer_t data __tb_debug_decl__)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && data, tb_false);
+
+    // done
+    tb_bool_t                       ok = tb_false;
+    tb_region_large_data_head_t*    data_head = tb_null;
+    do
+    {
+        // the data head
+        data_head = &(((tb_region_large_data_head_t*)data)[-1]);
+
+        // the base head
+        tb_pool_data_head_t* base_head = tb_region_large_allocator_data_base(data_head);
+
+        // check
+        tb_assertf(base_head->debug.magic != (tb_uint16_t)~TB_POOL_DATA_MAGIC, "double free data: %p", data);
+        tb_assertf(base_head->debug.magic == TB_POOL_DATA_MAGIC, "free invalid data: %p", data);
+        tb_assertf(((tb_byte_t*)data)[base_head->size] == TB_POOL_DATA_PATCH, "data underflow");
+
+        // check the region
+        tb_region_large_region_t* region = tb_region_large_allocator_check(allocator, data_head);
+        tb_check_break(region);
+
+#ifdef __tb_debug__
+        // for checking double-free
+        base_head->debug.magic = (tb_uint16_t)~TB_POOL_DATA_MAGIC;
+#endif
+
+        // update the total size
+        allocator->total_size    -= base_head->size;
+   
+        // update the free count
+        allocator->free_count++;
+
+        // free the data pages
+        tb_size_t index = ((tb_byte_t*)data_head - (tb_byte_t*)region) / allocator->page_size;
+        tb_region_large_allocator_bit_clr(region->head_bits, index);
+        tb_region_large_allocator_region_mark(region, index, data_head->pages, tb_false);
+
+        // exit the direct region
+        if (region->direct)
+        {
+            tb_list_entry_remove(&allocator->direct_list, &region->entry);
+            tb_region_large_allocator_region_exit(allocator, region);
+        }
+        // exit the empty shared region, but we keep the last region to avoid thrashing
+        else if (!region->used && tb_list_entry_size(&allocator->shared_list) > 1)
+        {
+            tb_list_entry_remove(&allocator->shared_list, &region->entry);
+            tb_region_large_allocator_region_exit(allocator, region);
+        }
+        // move it to the head for finding the free pages first
+        else if (tb_list_entry_head(&allocator->shared_list) != &region->entry)
+        {
+            tb_list_entry_remove(&allocator->shared_list, &region->entry);
+            tb_list_entry_insert_head(&allocator->shared_list, &region->entry);
+        }
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // ok?
+    return ok;
+}
+static tb_void_t tb_region_large_allocator_clear(tb_allocator_ref_t self)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator);
+
+    // release all regions
+    tb_list_entry_head_ref_t lists[] = {&allocator->shared_list, &allocator->direct_list};
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(lists); i++)
+    {
+        while (!tb_list_entry_is_null(lists[i]))
+        {
+            // the region
+            tb_list_entry_ref_t         entry = tb_list_entry_head(lists[i]);
+            tb_region_large_region_t*   region = (tb_region_large_region_t*)tb_list_entry(lists[i], entry);
+
+            // remove and release it
+            tb_list_entry_remove(lists[i], entry);
+            tb_virtual_memory_release((tb_pointer_t)region, region->size);
+        }
+    }
+
+    // release all idle regions
+    for (i = 0; i < allocator->idle_count; i++)
+        tb_virtual_memory_release(allocator->idle[i].data, allocator->idle[i].size);
+    allocator->idle_count = 0;
+    allocator->idle_size  = 0;
+
+    // clear info
+    allocator->peak_size     = 0;
+    allocator->total_size    = 0;
+    allocator->malloc_count  = 0;
+    allocator->ralloc_count  = 0;
+    allocator->free_count    = 0;
+#ifdef __tb_debug__
+    allocator->real_size     = 0;
+    allocator->occupied_size = 0;
+    allocator->region_count  = 0;
+    allocator->reuse_count   = 0;
+#endif
+}
+static tb_void_t tb_region_large_allocator_trim(tb_allocator_ref_t self)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator);
+
+    // release the empty shared regions, we have kept the last region to avoid thrashing
+    tb_iterator_ref_t iterator = tb_list_entry_itor(&allocator->shared_list);
+    tb_size_t itor = tb_iterator_head(iterator);
+    while (itor != tb_iterator_tail(iterator))
+    {
+        // the region
+        tb_region_large_region_t* region = (tb_region_large_region_t*)tb_iterator_item(iterator, itor);
+        tb_assert_and_check_break(region);
+
+        // the next itor
+        tb_size_t next = tb_iterator_next(iterator, itor);
+
+        // release it if it is empty
+        if (!region->used)
+        {
+            tb_list_entry_remove(&allocator->shared_list, &region->entry);
+            tb_virtual_memory_release((tb_pointer_t)region, region->size);
+#ifdef __tb_debug__
+            allocator->region_count--;
+#endif
+        }
+
+        // next
+        itor = next;
+    }
+
+    // release all idle regions, their pages may not have been reclaimed by the system yet
+    tb_size_t i = 0;
+    for (i = 0; i < allocator->idle_count; i++)
+        tb_virtual_memory_release(allocator->idle[i].data, allocator->idle[i].size);
+    allocator->idle_count = 0;
+    allocator->idle_size  = 0;
+}
+static tb_bool_t tb_region_large_allocator_stat(tb_allocator_ref_t self, tb_allocator_stat_t* stat)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && stat, tb_false);
+
+    // save the statistics
+    stat->malloc_count  = allocator->malloc_count;
+    stat->ralloc_count  = allocator->ralloc_count;
+    stat->free_count    = allocator->free_count;
+    stat->live_count    = allocator->malloc_count - allocator->free_count;
+    stat->live_size     = allocator->total_size;
+    stat->peak_size     = allocator->peak_size;
+
+    // the occupied size of all used regions, the idle regions have been freed lazily
+    tb_for_all_if (tb_region_large_region_t*, shared, tb_list_entry_itor(&allocator->shared_list), shared)
+    {
+        stat->occupied_size += shared->size;
+    }
+    tb_for_all_if (tb_region_large_region_t*, direct, tb_list_entry_itor(&allocator->direct_list), direct)
+    {
+        stat->occupied_size += direct->size;
+    }
+
+    // ok
+    return tb_true;
+}
+static tb_void_t tb_region_large_allocator_exit(tb_allocator_ref_t self)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator);
+
+    // clear it
+    tb_region_large_allocator_clear(self);
+
+    // exit lock
+    tb_spinlock_exit(&allocator->base.lock);
+
+    // exit it
+    tb_native_memory_free(allocator);
+}
+#ifdef __tb_debug__
+static tb_void_t tb_region_large_allocator_dump(tb_allocator_ref_t self)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator);
+
+    // trace
+    tb_trace_i("");
+
+    // dump the leaked data of all regions
+    tb_list_entry_head_ref_t lists[] = {&allocator->shared_list, &allocator->direct_list};
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(lists); i++)
+    {
+        tb_for_all_if (tb_region_large_region_t*, region, tb_list_entry_itor(lists[i]), region)
+        {
+            tb_size_t index = 1;
+            for (index = 1; index < allocator->region_pages; index++)
+            {
+                // the data head?
+                tb_check_continue(tb_region_large_allocator_bit_get(region->head_bits, index));
+
+                // check it
+                tb_region_large_data_head_t* data_head = (tb_region_large_data_head_t*)((tb_byte_t*)region + index * allocator->page_size);
+                tb_region_large_allocator_check_data(allocator, data_head);
+
+                // trace
+                tb_trace_e("leak: %p", &data_head[1]);
+
+                // dump data
+                tb_pool_data_dump((tb_byte_t const*)&data_head[1], tb_false, "[region_large_allocator]: [error]: ");
+            }
+        }
+    }
+
+    // trace debug info
+    tb_trace_i("peak_size: %lu",            allocator->peak_size);
+    tb_trace_i("wast_rate: %llu/10000",     allocator->occupied_size? (((tb_hize_t)allocator->occupied_size - allocator->real_size) * 10000) / (tb_hize_t)allocator->occupied_size : 0);
+    tb_trace_i("free_count: %lu",           allocator->free_count);
+    tb_trace_i("malloc_count: %lu",         allocator->malloc_count);
+    tb_trace_i("ralloc_count: %lu",         allocator->ralloc_count);
+    tb_trace_i("region_count: %lu",         allocator->region_count);
+    tb_trace_i("reuse_count: %lu",          allocator->reuse_count);
+    tb_trace_i("idle_count: %lu",           allocator->idle_count);
+    tb_trace_i("idle_size: %lu",            allocator->idle_size);
+}
+static tb_bool_t tb_region_large_allocator_have(tb_allocator_ref_t self, tb_cpointer_t data)
+{
+    // check
+    tb_region_large_allocator_ref_t allocator = (tb_region_large_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator, tb_false);
+
+    // the region of this data, the data head is always at the first 2MB of the region
+    tb_region_large_region_t const* region = tb_region_large_allocator_region(data);
+
+    // have it?
+    tb_list_entry_head_ref_t lists[] = {&allocator->shared_list, &allocator->direct_list};
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(lists); i++)
+    {
+        tb_for_all_if (tb_region_large_region_t*, item, tb_list_entry_itor(lists[i]), item)
+        {
+            if (item == region) return tb_true;
+        }
+    }
+    return tb_false;
+}
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_allocator_ref_t tb_region_large_allocator_init(tb_size_t flags)
+{
+    // done
+    tb_bool_t                           ok = tb_false;
+    tb_region_large_allocator_ref_t     allocator = tb_null;
+    do
+    {
+        // check
+        tb_assert_static(!(sizeof(tb_region_large_data_head_t) & (TB_POOL_DATA_ALIGN - 1)));
+
+        // the page size must be in [4KB, 2MB) and the region head must be placed at the first page
+        tb_size_t page_size = tb_page_size();
+        tb_check_break(page_size >= 4096 && page_size < TB_REGION_LARGE_ALLOCATOR_REGION_SIZE && !(page_size & (page_size - 1)));
+        tb_assert_and_check_break(sizeof(tb_region_large_region_t) <= page_size);
+
+        // check whether the virtual memory is supported
+        tb_pointer_t data = tb_virtual_memory_reserve_align(TB_REGION_LARGE_ALLOCATOR_REGION_SIZE, TB_REGION_LARGE_ALLOCATOR_REGION_SIZE);
+        tb_check_break(data);
+        tb_virtual_memory_release(data, TB_REGION_LARGE_ALLOCATOR_REGION_SIZE);
+
+        // make allocator
+        allocator = (tb_region_large_allocator_ref_t)tb_native_memory_malloc0(sizeof(tb_region_large_allocator_t));
+        tb_assert_and_check_break(allocator);
+
+        // init base
+        allocator->base.type             = TB_ALLOCATOR_LARGE;
+        allocator->base.large_malloc     = tb_region_large_allocator_malloc;
+        allocator->base.large_ralloc     = tb_region_large_allocator_ralloc;
+        allocator->base.large_free       = tb_region_large_allocator_free;
+        allocator->base.clear            = tb_region_large_allocator_clear;
+        allocator->base.exit             = tb_region_large_allocator_exit;
+        allocator->base.stat             = tb_region_large_allocator_stat;
+        allocator->base.trim             = tb_region_large_allocator_trim;
+#ifdef __tb_debug__
+        allocator->base.dump             = tb_region_large_allocator_dump;
+        allocator->base.have             = tb_region_large_allocator_have;
+#endif
+
+        // init lock
+        if (!tb_spinlock_init(&allocator->base.lock)) break;
+
+        // init allocator
+        allocator->flags        = flags;
+        allocator->page_size    = page_size;
+        allocator->region_pages = TB_REGION_LARGE_ALLOCATOR_REGION_SIZE / page_size;
+
+        // init regions
+        tb_list_entry_init(&allocator->shared_list, tb_region_large_region_t, entry, tb_null);
+        tb_list_entry_init(&allocator->direct_list, tb_region_large_region_t, entry, tb_null);
+
+        // register lock profiler
+#ifdef TB_LOCK_PROFILER_ENABLE
+        tb_lock_profiler_register(tb_lock_profiler(), (tb_pointer_t)&allocator->base.lock, TB_TRACE_MODULE_NAME);
+#endif
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (allocator) tb_region_large_allocator_exit((tb_allocator_ref_t)allocator);
+        allocator = tb_null;
+    }
+
+    // ok?
+    return (tb_allocator_ref_t)allocator;
+}
@@ -0,0 +1,58 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        region_large_allocator.h
+ *
+ */
+#ifndef TB_MEMORY_IMPL_REGION_LARGE_ALLOCATOR_H
+#define TB_MEMORY_IMPL_REGION_LARGE_ALLOCATOR_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/* init the region large allocator
+ *
+ * the data will be allocated from the 2MB-aligned regions which are reserved from the virtual memory,
+ * the small data shares the pages of the region and the large data uses the whole region directly.
+ * 
+ * @param flags         the flags, .e.g TB_LARGE_ALLOCATOR_FLAG_HUGEPAGE | TB_LARGE_ALLOCATOR_FLAG_NUMA
+ *
+ * @return              the allocator, tb_null if the virtual memory is not supported
+ */
+tb_allocator_ref_t      tb_region_large_allocator_init(tb_size_t flags);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -328,7 +328,10 @@ static tb_void_t tb_static_fixed_pool_check_data(tb_static_fixed_pool_t* pool, t
         // check
         tb_assertf_pass_break(!(((tb_byte_t*)data_head - pool->data) % pool->item_space), "the invalid data: %p", data);
         tb_assertf_pass_break(tb_static_fixed_pool_used_bset(pool->used_info, index), "data have been freed: %p", data);
-        tb_assertf_pass_break(data_head->debug.magic == (pool->for_small? TB_POOL_DATA_MAGIC : TB_POOL_DATA_EMPTY_MAGIC), "the invalid data: %p", data);
+
+        // the data of the small allocator may be in the thread cache of the default allocator
+        tb_assertf_pass_break(data_head->debug.magic == (pool->for_small? TB_POOL_DATA_MAGIC : TB_POOL_DATA_EMPTY_MAGIC)
+                            || (pool->for_small && data_head->debug.magic == TB_POOL_DATA_CACHE_MAGIC), "the invalid data: %p", data);
         tb_assertf_pass_break(((tb_byte_t*)data)[pool->item_size] == TB_POOL_DATA_PATCH, "data underflow");
 
         // ok
@@ -747,6 +750,9 @@ tb_void_t tb_static_fixed_pool_dump(tb_static_fixed_pool_ref_t self)
             // check it
             tb_static_fixed_pool_check_data(pool, data_head);
 
+            // the data cached by the thread cache of the default allocator is not leaked
+            if (pool->for_small && data_head->debug.magic == TB_POOL_DATA_CACHE_MAGIC) continue;
+
             // the data
             tb_byte_t const* data = (tb_byte_t const*)data_head + pool->data_head_size;
 
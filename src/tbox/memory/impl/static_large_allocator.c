@@ -143,19 +143,12 @@ typedef __tb_pool_data_aligned__ struct __tb_static_large_allocator_t
     tb_static_large_data_pred_t     data_pred[10];
 #endif
 
-#ifdef __tb_debug__
     // the peak size
     tb_size_t                       peak_size;
 
     // the total size
     tb_size_t                       total_size;
 
-    // the real size
-    tb_size_t                       real_size;
-
-    // the occupied size
-    tb_size_t                       occupied_size;
-
     // the malloc count
     tb_size_t                       malloc_count;
 
@@ -164,6 +157,13 @@ typedef __tb_pool_data_aligned__ struct __tb_static_large_allocator_t
 
     // the free count
     tb_size_t                       free_count;
+
+#ifdef __tb_debug__
+    // the real size
+    tb_size_t                       real_size;
+
+    // the occupied size
+    tb_size_t                       occupied_size;
 #endif
 
 }__tb_pool_data_aligned__ tb_static_large_allocator_t, *tb_static_large_allocator_ref_t;
@@ -474,6 +474,7 @@ static tb_static_large_data_head_t* tb_static_large_allocator_malloc_done(tb_sta
 
         // update the occupied size
         allocator->occupied_size += sizeof(tb_static_large_data_head_t) + data_head->space - 1 - TB_POOL_DATA_HEAD_DIFF_SIZE;
+#endif
 
         // update the total size
         allocator->total_size    += base_head->size;
@@ -483,7 +484,6 @@ static tb_static_large_data_head_t* tb_static_large_allocator_malloc_done(tb_sta
 
         // update the malloc count
         allocator->malloc_count++;
-#endif
 
         // ok
         ok = tb_true;
@@ -511,13 +511,13 @@ static tb_static_large_data_head_t* tb_static_large_allocator_ralloc_fast(tb_sta
         // the base head
         tb_pool_data_head_t* base_head = tb_static_large_allocator_data_base(data_head);
 
+        // the prev size
+        tb_size_t prev_size = base_head->size;
+
 #ifdef __tb_debug__
         // patch 0xcc
         tb_size_t patch = 1;
 
-        // the prev size
-        tb_size_t prev_size = base_head->size;
-
         // the prev space
         tb_size_t prev_space = data_head->space;
 
@@ -601,6 +601,7 @@ static tb_static_large_data_head_t* tb_static_large_allocator_ralloc_fast(tb_sta
         // update the occupied size
         allocator->occupied_size += data_head->space;
         allocator->occupied_size -= prev_space;
+#endif
 
         // update the total size
         allocator->total_size    += size_real;
@@ -608,7 +609,6 @@ static tb_static_large_data_head_t* tb_static_large_allocator_ralloc_fast(tb_sta
 
         // update the peak size
         if (allocator->total_size > allocator->peak_size) allocator->peak_size = allocator->total_size;
-#endif
 
         // ok
         ok = tb_true;
@@ -638,10 +638,8 @@ static tb_bool_t tb_static_large_allocator_free(tb_allocator_ref_t self, tb_poin
         // the data head
         data_head = &(((tb_static_large_data_head_t*)data)[-1]);
 
-#ifdef __tb_debug__
         // the base head
         tb_pool_data_head_t* base_head = tb_static_large_allocator_data_base(data_head);
-#endif
 
         // check
         tb_assertf_and_check_break(!data_head->bfree, "double free data: %p", data);
@@ -652,13 +650,13 @@ static tb_bool_t tb_static_large_allocator_free(tb_allocator_ref_t self, tb_poin
 #ifdef __tb_debug__
         // check the next data
         tb_static_large_allocator_check_next(allocator, data_head);
+#endif
 
         // update the total size
         allocator->total_size -= base_head->size;
 
         // update the free count
         allocator->free_count++;
-#endif
 
         // trace
         tb_trace_d("free: %lu: %s", base_head->size, ok? "ok" : "no");
@@ -757,10 +755,8 @@ static tb_pointer_t tb_static_large_allocator_ralloc(tb_allocator_ref_t self, tb
         // the real data
         data_real = (tb_byte_t*)&aloc_head[1];
 
-#ifdef __tb_debug__
         // update the ralloc count
         allocator->ralloc_count++;
-#endif
 
         // ok
         ok = tb_true;
@@ -793,16 +789,34 @@ static tb_void_t tb_static_large_allocator_clear(tb_allocator_ref_t self)
     tb_static_large_allocator_pred_update(allocator, allocator->data_head);
 
     // clear info
-#ifdef __tb_debug__
     allocator->peak_size     = 0;
     allocator->total_size    = 0;
-    allocator->real_size     = 0;
-    allocator->occupied_size = 0;
     allocator->malloc_count  = 0;
     allocator->ralloc_count  = 0;
     allocator->free_count    = 0;
+#ifdef __tb_debug__
+    allocator->real_size     = 0;
+    allocator->occupied_size = 0;
 #endif
 }
+static tb_bool_t tb_static_large_allocator_stat(tb_allocator_ref_t self, tb_allocator_stat_t* stat)
+{
+    // check
+    tb_static_large_allocator_ref_t allocator = (tb_static_large_allocator_t*)self;
+    tb_assert_and_check_return_val(allocator && stat, tb_false);
+
+    // save the statistics, the whole static buffer is occupied
+    stat->malloc_count  = allocator->malloc_count;
+    stat->ralloc_count  = allocator->ralloc_count;
+    stat->free_count    = allocator->free_count;
+    stat->live_count    = allocator->malloc_count - allocator->free_count;
+    stat->live_size     = allocator->total_size;
+    stat->peak_size     = allocator->peak_size;
+    stat->occupied_size = allocator->data_size;
+
+    // ok
+    return tb_true;
+}
 static tb_void_t tb_static_large_allocator_exit(tb_allocator_ref_t self)
 {
     // check
@@ -919,6 +933,7 @@ tb_allocator_ref_t tb_static_large_allocator_init(tb_byte_t* data, tb_size_t siz
     allocator->base.large_free       = tb_static_large_allocator_free;
     allocator->base.clear            = tb_static_large_allocator_clear;
     allocator->base.exit             = tb_static_large_allocator_exit;
+    allocator->base.stat             = tb_static_large_allocator_stat;
 #ifdef __tb_debug__
     allocator->base.dump             = tb_static_large_allocator_dump;
     allocator->base.have             = tb_static_large_allocator_have;
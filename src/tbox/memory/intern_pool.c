@@ -0,0 +1,557 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        intern_pool.c
+ * @ingroup     memory
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME                "intern_pool"
+#define TB_TRACE_MODULE_DEBUG               (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "intern_pool.h"
+#include "allocator.h"
+#include "arena_allocator.h"
+#include "../libc/libc.h"
+#include "../utils/utils.h"
+#include "../platform/platform.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the shard count, must be the power of 2
+#define TB_INTERN_POOL_SHARD_MAXN           (16)
+
+// the shard index, we use the high bits of hash because the low bits are used by the table
+#define TB_INTERN_POOL_SHARD_INDEX(hash)    ((hash) >> 28)
+
+// the initial table size, must be the power of 2
+#define TB_INTERN_POOL_TABLE_GROW           (64)
+
+// the first atom segment size
+#define TB_INTERN_POOL_ATOM_GROW_BITS       (8)
+#define TB_INTERN_POOL_ATOM_GROW            (1 << TB_INTERN_POOL_ATOM_GROW_BITS)
+
+// the atom segment maxn, the segment k has (TB_INTERN_POOL_ATOM_GROW << k) atoms
+#define TB_INTERN_POOL_ATOM_SEGMENT_MAXN    (24)
+
+// the arena chunk size
+#ifdef __tb_small__
+#   define TB_INTERN_POOL_ARENA_CHUNK_SIZE  (4096)
+#else
+#   define TB_INTERN_POOL_ARENA_CHUNK_SIZE  (16384)
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the intern pool entry type
+typedef struct __tb_intern_pool_entry_t
+{
+    // the hash
+    tb_uint32_t                         hash;
+
+    // the string size
+    tb_uint32_t                         size;
+
+    // the atom
+    tb_size_t                           atom;
+
+}tb_intern_pool_entry_t;
+
+// the intern pool table type
+typedef struct __tb_intern_pool_table_t
+{
+    // the next retired table
+    struct __tb_intern_pool_table_t*    next;
+
+    // the mask: maxn - 1
+    tb_size_t                           mask;
+
+    // the entries
+    tb_intern_pool_entry_t*             entries[1];
+
+}tb_intern_pool_table_t;
+
+// the intern pool shard type
+typedef struct __tb_intern_pool_shard_t
+{
+    // the lock for inserting
+    tb_spinlock_t                       lock;
+
+    // the arena for the strings
+    tb_allocator_ref_t                  arena;
+
+    // the current table, it is published with the release semantics
+    tb_intern_pool_table_t*             table;
+
+    // the retired tables, they may be still accessed by the lock-free readers
+    tb_intern_pool_table_t*             retired;
+
+    // the string count
+    tb_size_t                           size;
+
+    // the padding
+    tb_byte_t                           pad[TB_L1_CACHE_BYTES];
+
+}tb_intern_pool_shard_t;
+
+// the intern pool type
+typedef struct __tb_intern_pool_t
+{
+    // the large allocator
+    tb_allocator_ref_t                  large_allocator;
+
+    // is case?
+    tb_bool_t                           bcase;
+
+    // the atom count
+    tb_atomic_t                         atom_count;
+
+    // the atom segments
+    tb_atomic_t                         atoms[TB_INTERN_POOL_ATOM_SEGMENT_MAXN];
+
+    // the shards
+    tb_intern_pool_shard_t              shards[TB_INTERN_POOL_SHARD_MAXN];
+
+}tb_intern_pool_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static __tb_inline__ tb_pointer_t tb_intern_pool_load(tb_pointer_t* p)
+{
+#ifdef __ATOMIC_ACQUIRE
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#else
+    tb_pointer_t v = *((tb_pointer_t volatile*)p);
+    tb_barrier();
+    return v;
+#endif
+}
+static __tb_inline__ tb_void_t tb_intern_pool_store(tb_pointer_t* p, tb_pointer_t v)
+{
+#ifdef __ATOMIC_RELEASE
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+#else
+    tb_barrier();
+    *((tb_pointer_t volatile*)p) = v;
+#endif
+}
+static __tb_inline__ tb_uint32_t tb_intern_pool_hash(tb_byte_t const* data, tb_size_t size, tb_bool_t bcase)
+{
+    // fnv-1a
+    tb_uint32_t hash = 2166136261u;
+    if (bcase) while (size--) hash = (hash ^ *data++) * 16777619u;
+    else while (size--) 
+    {
+        tb_byte_t ch = *data++;
+        hash = (hash ^ tb_tolower(ch)) * 16777619u;
+    }
+
+    // mix the high bits for the shard index
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+static __tb_inline__ tb_char_t const* tb_intern_pool_entry_cstr(tb_intern_pool_entry_t const* entry)
+{
+    return (tb_char_t const*)&entry[1];
+}
+static __tb_inline__ tb_intern_pool_entry_t* tb_intern_pool_entry(tb_char_t const* cstr)
+{
+    return &((tb_intern_pool_entry_t*)cstr)[-1];
+}
+static __tb_inline__ tb_size_t tb_intern_pool_atom_segment(tb_size_t index)
+{
+    // the segment k contains [TB_INTERN_POOL_ATOM_GROW << k, TB_INTERN_POOL_ATOM_GROW << (k + 1))
+    tb_check_return_val(index <= TB_MAXU32, TB_INTERN_POOL_ATOM_SEGMENT_MAXN);
+    return (31 - tb_bits_cl0_u32_be((tb_uint32_t)index)) - TB_INTERN_POOL_ATOM_GROW_BITS;
+}
+static tb_intern_pool_entry_t* tb_intern_pool_table_find(tb_intern_pool_t* pool, tb_intern_pool_table_t* table, tb_char_t const* data, tb_size_t size, tb_uint32_t hash)
+{
+    // find it by the linear probing
+    tb_size_t               mask = table->mask;
+    tb_size_t               index = hash & mask;
+    tb_intern_pool_entry_t* entry = tb_null;
+    while ((entry = (tb_intern_pool_entry_t*)tb_intern_pool_load((tb_pointer_t*)&table->entries[index])))
+    {
+        // is this? compare the saved hash and size first
+        if (entry->hash == hash && entry->size == size)
+        {
+            tb_char_t const* cstr = tb_intern_pool_entry_cstr(entry);
+            if (pool->bcase? !tb_memcmp_(cstr, data, size) : !tb_strnicmp(cstr, data, size)) return entry;
+        }
+
+        // next
+        index = (index + 1) & mask;
+    }
+
+    // not found
+    return tb_null;
+}
+static tb_intern_pool_table_t* tb_intern_pool_table_init(tb_intern_pool_t* pool, tb_size_t maxn)
+{
+    // make table
+    return (tb_intern_pool_table_t*)tb_allocator_large_malloc0(pool->large_allocator, sizeof(tb_intern_pool_table_t) + (maxn - 1) * sizeof(tb_intern_pool_entry_t*), tb_null);
+}
+static tb_bool_t tb_intern_pool_shard_grow(tb_intern_pool_t* pool, tb_intern_pool_shard_t* shard)
+{
+    // the old table
+    tb_intern_pool_table_t* table = shard->table;
+
+    // make the new table
+    tb_size_t               maxn = table? ((table->mask + 1) << 1) : TB_INTERN_POOL_TABLE_GROW;
+    tb_intern_pool_table_t* table_new = tb_intern_pool_table_init(pool, maxn);
+    tb_assert_and_check_return_val(table_new, tb_false);
+    table_new->mask = maxn - 1;
+
+    // move all entries to the new table by the saved hash
+    if (table)
+    {
+        tb_size_t i = 0;
+        for (i = 0; i <= table->mask; i++)
+        {
+            tb_intern_pool_entry_t* entry = table->entries[i];
+            if (entry)
+            {
+                tb_size_t index = entry->hash & table_new->mask;
+                while (table_new->entries[index]) index = (index + 1) & table_new->mask;
+                table_new->entries[index] = entry;
+            }
+        }
+
+        // retire the old table, it will be freed after exiting the pool
+        table->next = shard->retired;
+        shard->retired = table;
+    }
+
+    // publish the new table
+    tb_intern_pool_store((tb_pointer_t*)&shard->table, table_new);
+
+    // trace
+    tb_trace_d("shard[%lu]: grow: %lu", shard - pool->shards, maxn);
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_intern_pool_atom_save(tb_intern_pool_t* pool, tb_size_t atom, tb_char_t const* cstr)
+{
+    // the segment and the offset
+    tb_size_t index = atom - 1 + TB_INTERN_POOL_ATOM_GROW;
+    tb_size_t k     = tb_intern_pool_atom_segment(index);
+    tb_size_t off   = index - (TB_INTERN_POOL_ATOM_GROW << k);
+    tb_assert_and_check_return_val(k < TB_INTERN_POOL_ATOM_SEGMENT_MAXN, tb_false);
+
+    // make the segment if not exists
+    tb_char_t const** segment = (tb_char_t const**)tb_intern_pool_load((tb_pointer_t*)&pool->atoms[k]);
+    if (!segment)
+    {
+        // make it
+        tb_char_t const** segment_new = (tb_char_t const**)tb_allocator_large_malloc0(pool->large_allocator, (TB_INTERN_POOL_ATOM_GROW << k) * sizeof(tb_char_t const*), tb_null);
+        tb_assert_and_check_return_val(segment_new, tb_false);
+
+        // save it, the other shard may have made it
+        segment = (tb_char_t const**)tb_atomic_fetch_and_pset(&pool->atoms[k], 0, (tb_long_t)segment_new);
+        if (segment) tb_allocator_large_free(pool->large_allocator, segment_new);
+        else segment = segment_new;
+    }
+
+    // save the string
+    tb_intern_pool_store((tb_pointer_t*)&segment[off], (tb_pointer_t)cstr);
+    return tb_true;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_intern_pool_ref_t tb_intern_pool_init(tb_bool_t bcase)
+{
+    // done
+    tb_bool_t           ok = tb_false;
+    tb_intern_pool_t*   pool = tb_null;
+    do
+    {
+        // the large allocator
+        tb_allocator_ref_t large_allocator = tb_allocator();
+        tb_assert_and_check_break(large_allocator);
+
+        // make pool
+        pool = (tb_intern_pool_t*)tb_allocator_large_malloc0(large_allocator, sizeof(tb_intern_pool_t), tb_null);
+        tb_assert_and_check_break(pool);
+
+        // init pool
+        pool->large_allocator   = large_allocator;
+        pool->bcase             = bcase;
+
+        // init shards
+        tb_size_t i = 0;
+        for (i = 0; i < tb_arrayn(pool->shards); i++)
+        {
+            // init lock
+            tb_intern_pool_shard_t* shard = &pool->shards[i];
+            if (!tb_spinlock_init(&shard->lock)) break;
+
+            // init arena
+            shard->arena = tb_arena_allocator_init(large_allocator, TB_INTERN_POOL_ARENA_CHUNK_SIZE);
+            tb_assert_and_check_break(shard->arena);
+        }
+        tb_check_break(i == tb_arrayn(pool->shards));
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (pool) tb_intern_pool_exit((tb_intern_pool_ref_t)pool);
+        pool = tb_null;
+    }
+
+    // ok?
+    return (tb_intern_pool_ref_t)pool;
+}
+tb_void_t tb_intern_pool_exit(tb_intern_pool_ref_t self)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return(pool);
+
+    // exit shards
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(pool->shards); i++)
+    {
+        // exit tables
+        tb_intern_pool_shard_t* shard = &pool->shards[i];
+        tb_intern_pool_table_t* table = shard->retired;
+        while (table)
+        {
+            tb_intern_pool_table_t* next = table->next;
+            tb_allocator_large_free(pool->large_allocator, table);
+            table = next;
+        }
+        if (shard->table) tb_allocator_large_free(pool->large_allocator, shard->table);
+        shard->table = tb_null;
+        shard->retired = tb_null;
+
+        // exit arena
+        if (shard->arena) tb_allocator_exit(shard->arena);
+        shard->arena = tb_null;
+
+        // exit lock
+        tb_spinlock_exit(&shard->lock);
+    }
+
+    // exit atom segments
+    for (i = 0; i < tb_arrayn(pool->atoms); i++)
+    {
+        if (pool->atoms[i]) tb_allocator_large_free(pool->large_allocator, (tb_pointer_t)pool->atoms[i]);
+        pool->atoms[i] = 0;
+    }
+
+    // exit it
+    tb_allocator_large_free(pool->large_allocator, pool);
+}
+tb_size_t tb_intern_pool_size(tb_intern_pool_ref_t self)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return_val(pool, 0);
+
+    // the atom count
+    return (tb_size_t)tb_atomic_get(&pool->atom_count);
+}
+tb_char_t const* tb_intern_pool_insert(tb_intern_pool_ref_t self, tb_char_t const* cstr)
+{
+    // check
+    tb_assert_and_check_return_val(cstr, tb_null);
+
+    // insert it
+    return tb_intern_pool_insert_with_size(self, cstr, tb_strlen(cstr));
+}
+tb_char_t const* tb_intern_pool_insert_with_size(tb_intern_pool_ref_t self, tb_char_t const* data, tb_size_t size)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return_val(pool && data && size < TB_MAXU32, tb_null);
+
+    // the hash and shard
+    tb_uint32_t             hash = tb_intern_pool_hash((tb_byte_t const*)data, size, pool->bcase);
+    tb_intern_pool_shard_t* shard = &pool->shards[TB_INTERN_POOL_SHARD_INDEX(hash)];
+
+    // find it without the lock first
+    tb_intern_pool_table_t* table = (tb_intern_pool_table_t*)tb_intern_pool_load((tb_pointer_t*)&shard->table);
+    tb_intern_pool_entry_t* entry = table? tb_intern_pool_table_find(pool, table, data, size, hash) : tb_null;
+    if (entry) return tb_intern_pool_entry_cstr(entry);
+
+    // enter
+    tb_spinlock_enter(&shard->lock);
+
+    // done
+    tb_char_t const* cstr = tb_null;
+    do
+    {
+        // find it again, it may have been inserted by the other thread
+        if (shard->table && (entry = tb_intern_pool_table_find(pool, shard->table, data, size, hash)))
+        {
+            cstr = tb_intern_pool_entry_cstr(entry);
+            break;
+        }
+
+        // grow the table if the load factor will be larger than 1/2
+        if (!shard->table || ((shard->size + 1) << 1) > shard->table->mask + 1)
+        {
+            if (!tb_intern_pool_shard_grow(pool, shard)) break;
+        }
+
+        // make entry
+        entry = (tb_intern_pool_entry_t*)tb_allocator_malloc(shard->arena, sizeof(tb_intern_pool_entry_t) + size + 1);
+        tb_assert_and_check_break(entry);
+
+        // init entry
+        tb_char_t* data_new = (tb_char_t*)&entry[1];
+        tb_memcpy_(data_new, data, size);
+        data_new[size]  = '\0';
+        entry->hash     = hash;
+        entry->size     = (tb_uint32_t)size;
+        entry->atom     = (tb_size_t)tb_atomic_add_and_fetch(&pool->atom_count, 1);
+
+        // save the atom before publishing it
+        if (!tb_intern_pool_atom_save(pool, entry->atom, data_new)) break;
+
+        // publish it
+        table = shard->table;
+        tb_size_t index = hash & table->mask;
+        while (table->entries[index]) index = (index + 1) & table->mask;
+        tb_intern_pool_store((tb_pointer_t*)&table->entries[index], entry);
+        shard->size++;
+
+        // ok
+        cstr = data_new;
+
+    } while (0);
+
+    // leave
+    tb_spinlock_leave(&shard->lock);
+
+    // ok?
+    return cstr;
+}
+tb_char_t const* tb_intern_pool_find(tb_intern_pool_ref_t self, tb_char_t const* cstr)
+{
+    // check
+    tb_assert_and_check_return_val(cstr, tb_null);
+
+    // find it
+    return tb_intern_pool_find_with_size(self, cstr, tb_strlen(cstr));
+}
+tb_char_t const* tb_intern_pool_find_with_size(tb_intern_pool_ref_t self, tb_char_t const* data, tb_size_t size)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return_val(pool && data, tb_null);
+
+    // the hash and shard
+    tb_uint32_t             hash = tb_intern_pool_hash((tb_byte_t const*)data, size, pool->bcase);
+    tb_intern_pool_shard_t* shard = &pool->shards[TB_INTERN_POOL_SHARD_INDEX(hash)];
+
+    // find it
+    tb_intern_pool_table_t* table = (tb_intern_pool_table_t*)tb_intern_pool_load((tb_pointer_t*)&shard->table);
+    tb_intern_pool_entry_t* entry = table? tb_intern_pool_table_find(pool, table, data, size, hash) : tb_null;
+    return entry? tb_intern_pool_entry_cstr(entry) : tb_null;
+}
+tb_size_t tb_intern_pool_atom(tb_intern_pool_ref_t self, tb_char_t const* cstr)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return_val(pool && cstr, 0);
+
+    // the atom
+    return tb_intern_pool_entry(cstr)->atom;
+}
+tb_size_t tb_intern_pool_strlen(tb_intern_pool_ref_t self, tb_char_t const* cstr)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return_val(pool && cstr, 0);
+
+    // the size
+    return tb_intern_pool_entry(cstr)->size;
+}
+tb_char_t const* tb_intern_pool_cstr(tb_intern_pool_ref_t self, tb_size_t atom)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return_val(pool && atom, tb_null);
+
+    // the segment and the offset
+    tb_size_t index = atom - 1 + TB_INTERN_POOL_ATOM_GROW;
+    tb_size_t k     = tb_intern_pool_atom_segment(index);
+    tb_size_t off   = index - (TB_INTERN_POOL_ATOM_GROW << k);
+    tb_check_return_val(k < TB_INTERN_POOL_ATOM_SEGMENT_MAXN, tb_null);
+
+    // get the string
+    tb_char_t const** segment = (tb_char_t const**)tb_intern_pool_load((tb_pointer_t*)&pool->atoms[k]);
+    return segment? (tb_char_t const*)tb_intern_pool_load((tb_pointer_t*)&segment[off]) : tb_null;
+}
+#ifdef __tb_debug__
+tb_void_t tb_intern_pool_dump(tb_intern_pool_ref_t self)
+{
+    // check
+    tb_intern_pool_t* pool = (tb_intern_pool_t*)self;
+    tb_assert_and_check_return(pool);
+
+    // trace
+    tb_trace_i("size: %lu", tb_intern_pool_size(self));
+
+    // dump shards
+    tb_size_t i = 0;
+    for (i = 0; i < tb_arrayn(pool->shards); i++)
+    {
+        // enter
+        tb_intern_pool_shard_t* shard = &pool->shards[i];
+        tb_spinlock_enter(&shard->lock);
+
+        // the retired table count
+        tb_size_t               retired = 0;
+        tb_intern_pool_table_t* table = shard->retired;
+        for (; table; table = table->next) retired++;
+
+        // trace
+        tb_trace_i("shard[%lu]: size: %lu, table: %lu, retired: %lu", i, shard->size, shard->table? shard->table->mask + 1 : 0, retired);
+
+        // leave
+        tb_spinlock_leave(&shard->lock);
+    }
+}
+#endif
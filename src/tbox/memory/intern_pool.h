@@ -0,0 +1,182 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        intern_pool.h
+ * @ingroup     memory
+ *
+ */
+#ifndef TB_MEMORY_INTERN_POOL_H
+#define TB_MEMORY_INTERN_POOL_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/*! the intern pool ref type
+ *
+ * the thread-safe interned string table, the same strings are always interned to the same address,
+ * so the interned strings can be compared by the pointer instead of tb_strcmp().
+ *
+ * <pre>
+ *
+ *                 hash >> 28
+ * string => hash ------------> shard[0] | shard[1] | ... | shard[15]
+ *                                 |
+ *                                \|/ hash & mask
+ *                     table: | entry | null | entry | ... |
+ *                                |             |
+ *                               \|/           \|/
+ *                     arena: | hash, size, atom, "data\0" | hash, size, atom, "data\0" | ...
+ *
+ * </pre>
+ *
+ * - find: lock-free, the table and entries are published with the release semantics
+ * - insert: lock the shard only if the string has not been interned
+ * - the hash of the entry is saved, so the table will be grown without rehashing the strings
+ * - the strings are stored in the append-only arena of each shard and will be not freed until the pool is exited
+ *
+ * each interned string has an unique atom, it is a small integer starting from 1 in the insertion order.
+ */
+typedef __tb_typeref__(intern_pool);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init the intern pool
+ *
+ * @param bcase             is case? the strings will be compared and hashed case-insensitively if be tb_false
+ *
+ * @return                  the intern pool
+ */
+tb_intern_pool_ref_t        tb_intern_pool_init(tb_bool_t bcase);
+
+/*! exit the intern pool, all interned strings will be freed
+ *
+ * @param pool              the intern pool
+ */
+tb_void_t                   tb_intern_pool_exit(tb_intern_pool_ref_t pool);
+
+/*! the interned string count
+ *
+ * @param pool              the intern pool
+ *
+ * @return                  the string count
+ */
+tb_size_t                   tb_intern_pool_size(tb_intern_pool_ref_t pool);
+
+/*! intern the string
+ *
+ * @code
+    tb_char_t const* name = tb_intern_pool_insert(pool, "Content-Type");
+    if (name == tb_intern_pool_insert(pool, "content-type"))
+    {
+        // the same name for the case-insensitive pool
+    }
+ * @endcode
+ *
+ * @param pool              the intern pool
+ * @param cstr              the string
+ *
+ * @return                  the interned string, it is valid until the pool is exited
+ */
+tb_char_t const*            tb_intern_pool_insert(tb_intern_pool_ref_t pool, tb_char_t const* cstr);
+
+/*! intern the string with the given size, the data need not be terminated by '\0'
+ *
+ * @param pool              the intern pool
+ * @param data              the string data
+ * @param size              the string size
+ *
+ * @return                  the interned string, it is terminated by '\0'
+ */
+tb_char_t const*            tb_intern_pool_insert_with_size(tb_intern_pool_ref_t pool, tb_char_t const* data, tb_size_t size);
+
+/*! find the interned string without interning it
+ *
+ * @param pool              the intern pool
+ * @param cstr              the string
+ *
+ * @return                  the interned string or tb_null if it has not been interned
+ */
+tb_char_t const*            tb_intern_pool_find(tb_intern_pool_ref_t pool, tb_char_t const* cstr);
+
+/*! find the interned string with the given size without interning it
+ *
+ * @param pool              the intern pool
+ * @param data              the string data
+ * @param size              the string size
+ *
+ * @return                  the interned string or tb_null if it has not been interned
+ */
+tb_char_t const*            tb_intern_pool_find_with_size(tb_intern_pool_ref_t pool, tb_char_t const* data, tb_size_t size);
+
+/*! the atom of the interned string
+ *
+ * @param pool              the intern pool
+ * @param cstr              the interned string which was returned by tb_intern_pool_insert()
+ *
+ * @return                  the atom
+ */
+tb_size_t                   tb_intern_pool_atom(tb_intern_pool_ref_t pool, tb_char_t const* cstr);
+
+/*! the size of the interned string
+ *
+ * @param pool              the intern pool
+ * @param cstr              the interned string which was returned by tb_intern_pool_insert()
+ *
+ * @return                  the string size
+ */
+tb_size_t                   tb_intern_pool_strlen(tb_intern_pool_ref_t pool, tb_char_t const* cstr);
+
+/*! get the interned string from the atom
+ *
+ * @param pool              the intern pool
+ * @param atom              the atom
+ *
+ * @return                  the interned string or tb_null if the atom is invalid
+ */
+tb_char_t const*            tb_intern_pool_cstr(tb_intern_pool_ref_t pool, tb_size_t atom);
+
+#ifdef __tb_debug__
+/*! dump the intern pool
+ *
+ * @param pool              the intern pool
+ */
+tb_void_t                   tb_intern_pool_dump(tb_intern_pool_ref_t pool);
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
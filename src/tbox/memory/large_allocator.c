@@ -40,5 +40,16 @@ tb_allocator_ref_t tb_large_allocator_init(tb_byte_t* data, tb_size_t size)
     // init pool
     return (data && size)? tb_static_large_allocator_init(data, size, tb_page_size()) : tb_native_large_allocator_init();
 }
+tb_allocator_ref_t tb_large_allocator_init_with_flags(tb_size_t flags)
+{
+    // init the region large allocator
+    tb_allocator_ref_t allocator = flags? tb_region_large_allocator_init(flags) : tb_null;
+
+    // init the native large allocator if no flags or the virtual memory is not supported
+    if (!allocator) allocator = tb_native_large_allocator_init();
+
+    // ok?
+    return allocator;
+}
 
 
@@ -36,6 +36,19 @@
  */
 __tb_extern_c_enter__
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the large allocator flag enum
+typedef enum __tb_large_allocator_flag_e
+{
+    TB_LARGE_ALLOCATOR_FLAG_NONE        = 0     //!< allocate the data from the native memory one by one
+,   TB_LARGE_ALLOCATOR_FLAG_HUGEPAGE    = 1     //!< allocate the data from the 2MB-aligned regions which are backed by the transparent huge pages
+,   TB_LARGE_ALLOCATOR_FLAG_NUMA        = 2     //!< bind the regions to the numa node of the calling thread
+
+}tb_large_allocator_flag_e;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
@@ -65,6 +78,38 @@ __tb_extern_c_enter__
  */
 tb_allocator_ref_t      tb_large_allocator_init(tb_byte_t* data, tb_size_t size);
 
+/*! init the large allocator with the given flags from the native memory
+ *
+ * it will reserve the 2MB-aligned regions from the virtual memory if some flags are given, 
+ * the huge pages can reduce the TLB misses for the large working set. 
+ * and the freed regions will be cached and their pages will be returned to the system lazily (.e.g MADV_FREE).
+ *
+ * it will fallback to the native large allocator if the virtual memory is not supported.
+ *
+ * @code
+    // init the large allocator with the transparent huge pages
+    tb_allocator_ref_t large_allocator = tb_large_allocator_init_with_flags(TB_LARGE_ALLOCATOR_FLAG_HUGEPAGE | TB_LARGE_ALLOCATOR_FLAG_NUMA);
+
+    // init the default allocator with it
+    tb_allocator_ref_t allocator = tb_default_allocator_init(large_allocator);
+
+    // init tbox
+    tb_init(tb_null, allocator);
+
+    // ...
+
+    // exit tbox and allocators
+    tb_exit();
+    tb_allocator_exit(allocator);
+    tb_allocator_exit(large_allocator);
+ * @endcode
+ *
+ * @param flags         the flags, .e.g TB_LARGE_ALLOCATOR_FLAG_HUGEPAGE
+ *
+ * @return              the allocator 
+ */
+tb_allocator_ref_t      tb_large_allocator_init_with_flags(tb_size_t flags);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
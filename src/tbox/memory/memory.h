@@ -34,8 +34,13 @@
 #include "allocator.h"
 #include "fixed_pool.h"
 #include "string_pool.h"
+#include "intern_pool.h"
+#include "concurrent_fixed_pool.h"
 #include "queue_buffer.h"
+#include "rope_buffer.h"
 #include "static_buffer.h"
+#include "heap_profiler.h"
+#include "arena_allocator.h"
 #include "large_allocator.h"
 #include "small_allocator.h"
 #include "native_allocator.h"
@@ -65,25 +70,13 @@
  *                             |          ---------------------------------------     |----------------------|     ------      ------
  *                             |                              |                       |    fixed pool:32B    | -> ...
  *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:64B    | -> ...
+ *                             |                              |                       |    fixed pool:48B    | -> ...
  *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:96B*   | -> ...
+ *                             |                              |                       |         ...          |  ~12.5% spacing
  *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:128B   | -> ...
+ *                             |                              |                       |    fixed pool:2816B  | -> ...
  *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:192B*  | -> ...
- *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:256B   | -> ...
- *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:384B*  | -> ...
- *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:512B   | -> ...
- *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:1024B  | -> ...
- *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:2048B  | -> ...
- *                             |                              |                       |----------------------|
- *                             |                              |                       |    fixed pool:3072B* | -> ...
+ *                             |                              |                       |    fixed pool:3072B  | -> ...
  *                             |                              |                        ---------------------- 
  *                             |                              |
  *                             |                              |
@@ -0,0 +1,594 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        rope_buffer.c
+ * @ingroup     memory
+ *
+ */
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "memory.h"
+#include "../libc/libc.h"
+#include "../utils/utils.h"
+#include "../platform/platform.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the block size for appending data
+#ifdef __tb_small__
+#   define TB_ROPE_BUFFER_BLOCK_SIZE       (4096)
+#else
+#   define TB_ROPE_BUFFER_BLOCK_SIZE       (8192)
+#endif
+
+// the allocator of the buffer
+#define tb_rope_buffer_allocator(buffer)    ((buffer)->allocator? (buffer)->allocator : tb_allocator())
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the rope buffer block type
+typedef struct __tb_rope_buffer_block_t
+{
+    // the reference count
+    tb_atomic_t                         refn;
+
+    // the allocator of this block
+    tb_allocator_ref_t                  allocator;
+
+    // the data
+    tb_byte_t*                          data;
+
+    // the data maxn
+    tb_size_t                           maxn;
+
+    // the used size, only for the owned data 
+    tb_size_t                           used;
+
+    // the free func of the user data, the data is owned by this block if be null
+    tb_rope_buffer_free_func_t          func;
+
+    // the user private data
+    tb_cpointer_t                       priv;
+
+    // is user data?
+    tb_bool_t                           user;
+
+}tb_rope_buffer_block_t;
+
+// the rope buffer slice type
+typedef struct __tb_rope_buffer_slice_t
+{
+    // the next slice
+    struct __tb_rope_buffer_slice_t*    next;
+
+    // the block
+    tb_rope_buffer_block_t*             block;
+
+    // the data
+    tb_byte_t*                          data;
+
+    // the size
+    tb_size_t                           size;
+
+}tb_rope_buffer_slice_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_rope_buffer_block_t* tb_rope_buffer_block_init(tb_allocator_ref_t allocator, tb_size_t maxn)
+{
+    // make block and the owned data
+    tb_rope_buffer_block_t* block = (tb_rope_buffer_block_t*)tb_allocator_malloc(allocator, sizeof(tb_rope_buffer_block_t) + maxn);
+    tb_assert_and_check_return_val(block, tb_null);
+
+    // init block
+    block->refn         = 0;
+    block->allocator    = allocator;
+    block->data         = (tb_byte_t*)&block[1];
+    block->maxn         = maxn;
+    block->used         = 0;
+    block->func         = tb_null;
+    block->priv         = tb_null;
+    block->user         = tb_false;
+    return block;
+}
+static tb_rope_buffer_block_t* tb_rope_buffer_block_init_ref(tb_allocator_ref_t allocator, tb_byte_t* data, tb_size_t size, tb_rope_buffer_free_func_t func, tb_cpointer_t priv)
+{
+    // make block
+    tb_rope_buffer_block_t* block = (tb_rope_buffer_block_t*)tb_allocator_malloc(allocator, sizeof(tb_rope_buffer_block_t));
+    tb_assert_and_check_return_val(block, tb_null);
+
+    // init block with the user data
+    block->refn         = 0;
+    block->allocator    = allocator;
+    block->data         = data;
+    block->maxn         = size;
+    block->used         = size;
+    block->func         = func;
+    block->priv         = priv;
+    block->user         = tb_true;
+    return block;
+}
+static tb_void_t tb_rope_buffer_block_exit(tb_rope_buffer_block_t* block)
+{
+    // free the user data
+    if (block->func) block->func(block->data, block->priv);
+
+    // exit block
+    tb_allocator_free(block->allocator, block);
+}
+static tb_rope_buffer_slice_t* tb_rope_buffer_slice_init(tb_rope_buffer_ref_t buffer, tb_rope_buffer_block_t* block, tb_byte_t* data, tb_size_t size)
+{
+    // make slice
+    tb_rope_buffer_slice_t* slice = (tb_rope_buffer_slice_t*)tb_allocator_malloc(tb_rope_buffer_allocator(buffer), sizeof(tb_rope_buffer_slice_t));
+    tb_assert_and_check_return_val(slice, tb_null);
+
+    // init slice and refer to the block
+    slice->next     = tb_null;
+    slice->block    = block;
+    slice->data     = data;
+    slice->size     = size;
+    tb_atomic_fetch_and_inc(&block->refn);
+    return slice;
+}
+static tb_void_t tb_rope_buffer_slice_exit(tb_rope_buffer_ref_t buffer, tb_rope_buffer_slice_t* slice)
+{
+    // release the block
+    if (tb_atomic_fetch_and_dec(&slice->block->refn) == 1) tb_rope_buffer_block_exit(slice->block);
+
+    // exit slice
+    tb_allocator_free(tb_rope_buffer_allocator(buffer), slice);
+}
+static tb_void_t tb_rope_buffer_insert_head(tb_rope_buffer_ref_t buffer, tb_rope_buffer_slice_t* slice)
+{
+    slice->next = (tb_rope_buffer_slice_t*)buffer->head;
+    buffer->head = slice;
+    if (!buffer->tail) buffer->tail = slice;
+    buffer->size += slice->size;
+    buffer->count++;
+}
+static tb_void_t tb_rope_buffer_insert_tail(tb_rope_buffer_ref_t buffer, tb_rope_buffer_slice_t* slice)
+{
+    slice->next = tb_null;
+    if (buffer->tail) ((tb_rope_buffer_slice_t*)buffer->tail)->next = slice;
+    else buffer->head = slice;
+    buffer->tail = slice;
+    buffer->size += slice->size;
+    buffer->count++;
+}
+static tb_bool_t tb_rope_buffer_insert_ref(tb_rope_buffer_ref_t buffer, tb_byte_t* data, tb_size_t size, tb_rope_buffer_free_func_t func, tb_cpointer_t priv, tb_bool_t head)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && data && size, tb_false);
+
+    // make block with the user data
+    tb_rope_buffer_block_t* block = tb_rope_buffer_block_init_ref(tb_rope_buffer_allocator(buffer), data, size, func, priv);
+    tb_assert_and_check_return_val(block, tb_false);
+
+    // make slice
+    tb_rope_buffer_slice_t* slice = tb_rope_buffer_slice_init(buffer, block, data, size);
+    if (!slice)
+    {
+        tb_rope_buffer_block_exit(block);
+        return tb_false;
+    }
+
+    // insert it
+    if (head) tb_rope_buffer_insert_head(buffer, slice);
+    else tb_rope_buffer_insert_tail(buffer, slice);
+    return tb_true;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_bool_t tb_rope_buffer_init(tb_rope_buffer_ref_t buffer)
+{
+    return tb_rope_buffer_init_with_allocator(buffer, tb_null);
+}
+tb_bool_t tb_rope_buffer_init_with_allocator(tb_rope_buffer_ref_t buffer, tb_allocator_ref_t allocator)
+{
+    // check
+    tb_assert_and_check_return_val(buffer, tb_false);
+
+    // init
+    buffer->head        = tb_null;
+    buffer->tail        = tb_null;
+    buffer->size        = 0;
+    buffer->count       = 0;
+    buffer->allocator   = allocator;
+
+    // ok
+    return tb_true;
+}
+tb_void_t tb_rope_buffer_exit(tb_rope_buffer_ref_t buffer)
+{
+    // clear it
+    tb_rope_buffer_clear(buffer);
+}
+tb_void_t tb_rope_buffer_clear(tb_rope_buffer_ref_t buffer)
+{
+    // check
+    tb_assert_and_check_return(buffer);
+
+    // exit all slices
+    tb_rope_buffer_slice_t* slice = (tb_rope_buffer_slice_t*)buffer->head;
+    while (slice)
+    {
+        tb_rope_buffer_slice_t* next = slice->next;
+        tb_rope_buffer_slice_exit(buffer, slice);
+        slice = next;
+    }
+
+    // clear it
+    buffer->head    = tb_null;
+    buffer->tail    = tb_null;
+    buffer->size    = 0;
+    buffer->count   = 0;
+}
+tb_size_t tb_rope_buffer_size(tb_rope_buffer_ref_t buffer)
+{
+    // check
+    tb_assert_and_check_return_val(buffer, 0);
+
+    // the data size
+    return buffer->size;
+}
+tb_size_t tb_rope_buffer_count(tb_rope_buffer_ref_t buffer)
+{
+    // check
+    tb_assert_and_check_return_val(buffer, 0);
+
+    // the slice count
+    return buffer->count;
+}
+tb_bool_t tb_rope_buffer_append(tb_rope_buffer_ref_t buffer, tb_byte_t const* data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && data, tb_false);
+
+    // append data to the free space of the tail block if it is only referred by the tail slice
+    tb_rope_buffer_slice_t* tail = (tb_rope_buffer_slice_t*)buffer->tail;
+    if (tail && size)
+    {
+        tb_rope_buffer_block_t* block = tail->block;
+        if (    !block->user
+            &&  block->used < block->maxn
+            &&  tail->data + tail->size == block->data + block->used
+            &&  tb_atomic_get(&block->refn) == 1)
+        {
+            tb_size_t n = tb_min(size, block->maxn - block->used);
+            tb_memcpy(block->data + block->used, data, n);
+            block->used     += n;
+            tail->size      += n;
+            buffer->size    += n;
+            data            += n;
+            size            -= n;
+        }
+    }
+
+    // append the remaining data to a new block
+    if (size)
+    {
+        // make block
+        tb_rope_buffer_block_t* block = tb_rope_buffer_block_init(tb_rope_buffer_allocator(buffer), tb_max(size, TB_ROPE_BUFFER_BLOCK_SIZE));
+        tb_assert_and_check_return_val(block, tb_false);
+
+        // copy data
+        tb_memcpy(block->data, data, size);
+        block->used = size;
+
+        // make slice
+        tb_rope_buffer_slice_t* slice = tb_rope_buffer_slice_init(buffer, block, block->data, size);
+        if (!slice)
+        {
+            tb_rope_buffer_block_exit(block);
+            return tb_false;
+        }
+
+        // insert it
+        tb_rope_buffer_insert_tail(buffer, slice);
+    }
+
+    // ok
+    return tb_true;
+}
+tb_bool_t tb_rope_buffer_append_ref(tb_rope_buffer_ref_t buffer, tb_byte_t* data, tb_size_t size, tb_rope_buffer_free_func_t func, tb_cpointer_t priv)
+{
+    return tb_rope_buffer_insert_ref(buffer, data, size, func, priv, tb_false);
+}
+tb_bool_t tb_rope_buffer_prepend(tb_rope_buffer_ref_t buffer, tb_byte_t const* data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && data, tb_false);
+    tb_check_return_val(size, tb_true);
+
+    // make block, the prepended data is usually small (e.g. the headers), so we need not reserve the free space
+    tb_rope_buffer_block_t* block = tb_rope_buffer_block_init(tb_rope_buffer_allocator(buffer), size);
+    tb_assert_and_check_return_val(block, tb_false);
+
+    // copy data
+    tb_memcpy(block->data, data, size);
+    block->used = size;
+
+    // make slice
+    tb_rope_buffer_slice_t* slice = tb_rope_buffer_slice_init(buffer, block, block->data, size);
+    if (!slice)
+    {
+        tb_rope_buffer_block_exit(block);
+        return tb_false;
+    }
+
+    // insert it
+    tb_rope_buffer_insert_head(buffer, slice);
+    return tb_true;
+}
+tb_bool_t tb_rope_buffer_prepend_ref(tb_rope_buffer_ref_t buffer, tb_byte_t* data, tb_size_t size, tb_rope_buffer_free_func_t func, tb_cpointer_t priv)
+{
+    return tb_rope_buffer_insert_ref(buffer, data, size, func, priv, tb_true);
+}
+tb_bool_t tb_rope_buffer_append_rope(tb_rope_buffer_ref_t buffer, tb_rope_buffer_ref_t other, tb_size_t offset, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && other && buffer != other && offset <= other->size, tb_false);
+
+    // the range size
+    if (size > other->size - offset) size = other->size - offset;
+
+    // share the slices of the range
+    tb_rope_buffer_slice_t* slice = (tb_rope_buffer_slice_t*)other->head;
+    for (; slice && size; slice = slice->next)
+    {
+        // skip the slices before the offset
+        if (offset >= slice->size)
+        {
+            offset -= slice->size;
+            continue;
+        }
+
+        // refer to the part of this slice
+        tb_size_t               n = tb_min(size, slice->size - offset);
+        tb_rope_buffer_slice_t* slice_new = tb_rope_buffer_slice_init(buffer, slice->block, slice->data + offset, n);
+        tb_assert_and_check_return_val(slice_new, tb_false);
+        tb_rope_buffer_insert_tail(buffer, slice_new);
+
+        // next
+        offset = 0;
+        size -= n;
+    }
+
+    // ok
+    return tb_true;
+}
+tb_bool_t tb_rope_buffer_splice(tb_rope_buffer_ref_t buffer, tb_rope_buffer_ref_t other)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && other && buffer != other, tb_false);
+    tb_check_return_val(other->head, tb_true);
+
+    // the same allocator? move all slices at once
+    if (tb_rope_buffer_allocator(buffer) == tb_rope_buffer_allocator(other))
+    {
+        if (buffer->tail) ((tb_rope_buffer_slice_t*)buffer->tail)->next = (tb_rope_buffer_slice_t*)other->head;
+        else buffer->head = other->head;
+        buffer->tail    = other->tail;
+        buffer->size    += other->size;
+        buffer->count   += other->count;
+    }
+    // remake the slices with the allocator of the buffer, but the data need not be copied
+    else
+    {
+        tb_rope_buffer_slice_t* slice = (tb_rope_buffer_slice_t*)other->head;
+        for (; slice; slice = slice->next)
+        {
+            tb_rope_buffer_slice_t* slice_new = tb_rope_buffer_slice_init(buffer, slice->block, slice->data, slice->size);
+            tb_assert_and_check_return_val(slice_new, tb_false);
+            tb_rope_buffer_insert_tail(buffer, slice_new);
+        }
+        tb_rope_buffer_clear(other);
+    }
+
+    // clear the other buffer
+    other->head     = tb_null;
+    other->tail     = tb_null;
+    other->size     = 0;
+    other->count    = 0;
+
+    // ok
+    return tb_true;
+}
+tb_bool_t tb_rope_buffer_split(tb_rope_buffer_ref_t buffer, tb_size_t offset, tb_rope_buffer_ref_t other)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && other && buffer != other && offset <= buffer->size, tb_false);
+    tb_check_return_val(offset < buffer->size, tb_true);
+
+    // find the slice which contains the offset
+    tb_size_t               size = offset;
+    tb_size_t               count = 0;
+    tb_rope_buffer_slice_t* prev = tb_null;
+    tb_rope_buffer_slice_t* slice = (tb_rope_buffer_slice_t*)buffer->head;
+    while (slice && size >= slice->size)
+    {
+        size -= slice->size;
+        prev = slice;
+        slice = slice->next;
+        count++;
+    }
+    tb_assert_and_check_return_val(slice, tb_false);
+
+    // cut this slice if the offset is in the middle of it 
+    if (size)
+    {
+        // make the right part and share the block
+        tb_rope_buffer_slice_t* right = tb_rope_buffer_slice_init(buffer, slice->block, slice->data + size, slice->size - size);
+        tb_assert_and_check_return_val(right, tb_false);
+
+        // keep the left part
+        right->next = slice->next;
+        slice->next = right;
+        slice->size = size;
+        if (buffer->tail == slice) buffer->tail = right;
+        buffer->count++;
+
+        // split after the left part
+        prev = slice;
+        slice = right;
+        count++;
+    }
+
+    // make the right buffer
+    tb_rope_buffer_t right;
+    right.head      = slice;
+    right.tail      = buffer->tail;
+    right.size      = buffer->size - offset;
+    right.count     = buffer->count - count;
+    right.allocator = buffer->allocator;
+
+    // keep the left data
+    if (prev) prev->next = tb_null;
+    buffer->head    = prev? buffer->head : tb_null;
+    buffer->tail    = prev;
+    buffer->size    = offset;
+    buffer->count   = count;
+
+    // splice the right data to the other buffer
+    return tb_rope_buffer_splice(other, &right);
+}
+tb_size_t tb_rope_buffer_drop(tb_rope_buffer_ref_t buffer, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(buffer, 0);
+
+    // drop the head slices
+    tb_size_t               drop = 0;
+    tb_rope_buffer_slice_t* slice = tb_null;
+    while (size && (slice = (tb_rope_buffer_slice_t*)buffer->head))
+    {
+        // drop the part of this slice?
+        if (size < slice->size)
+        {
+            slice->data += size;
+            slice->size -= size;
+            buffer->size -= size;
+            drop += size;
+            break;
+        }
+
+        // remove this slice
+        buffer->head = slice->next;
+        if (!buffer->head) buffer->tail = tb_null;
+        buffer->size -= slice->size;
+        buffer->count--;
+        drop += slice->size;
+        size -= slice->size;
+        tb_rope_buffer_slice_exit(buffer, slice);
+    }
+
+    // ok
+    return drop;
+}
+tb_size_t tb_rope_buffer_read(tb_rope_buffer_ref_t buffer, tb_size_t offset, tb_byte_t* data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && data, 0);
+
+    // copy data
+    tb_size_t               read = 0;
+    tb_rope_buffer_slice_t* slice = (tb_rope_buffer_slice_t*)buffer->head;
+    for (; slice && read < size; slice = slice->next)
+    {
+        // skip the slices before the offset
+        if (offset >= slice->size)
+        {
+            offset -= slice->size;
+            continue;
+        }
+
+        // copy the part of this slice
+        tb_size_t n = tb_min(size - read, slice->size - offset);
+        tb_memcpy(data + read, slice->data + offset, n);
+        read += n;
+        offset = 0;
+    }
+
+    // ok
+    return read;
+}
+tb_size_t tb_rope_buffer_iovec(tb_rope_buffer_ref_t buffer, tb_iovec_t* list, tb_size_t maxn)
+{
+    // check
+    tb_assert_and_check_return_val(buffer && list && maxn, 0);
+
+    // export the slices
+    tb_size_t               count = 0;
+    tb_rope_buffer_slice_t* slice = (tb_rope_buffer_slice_t*)buffer->head;
+    for (; slice && count < maxn; slice = slice->next)
+    {
+        list[count].data = slice->data;
+        list[count].size = (tb_iovec_size_t)slice->size;
+        count++;
+    }
+
+    // ok
+    return count;
+}
+tb_byte_t* tb_rope_buffer_pullup(tb_rope_buffer_ref_t buffer)
+{
+    // check
+    tb_assert_and_check_return_val(buffer, tb_null);
+
+    // no data?
+    tb_rope_buffer_slice_t* head = (tb_rope_buffer_slice_t*)buffer->head;
+    tb_check_return_val(head, tb_null);
+
+    // only one slice? return it directly
+    tb_check_return_val(head->next, head->data);
+
+    // make block for all data
+    tb_rope_buffer_block_t* block = tb_rope_buffer_block_init(tb_rope_buffer_allocator(buffer), buffer->size);
+    tb_assert_and_check_return_val(block, tb_null);
+
+    // copy all data
+    tb_size_t size = tb_rope_buffer_read(buffer, 0, block->data, buffer->size);
+    tb_assert(size == buffer->size);
+    block->used = size;
+
+    // make slice
+    tb_rope_buffer_slice_t* slice = tb_rope_buffer_slice_init(buffer, block, block->data, size);
+    if (!slice)
+    {
+        tb_rope_buffer_block_exit(block);
+        return tb_null;
+    }
+
+    // replace all slices
+    tb_rope_buffer_clear(buffer);
+    tb_rope_buffer_insert_tail(buffer, slice);
+
+    // ok
+    return slice->data;
+}
@@ -0,0 +1,273 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        rope_buffer.h
+ * @ingroup     memory
+ *
+ */
+#ifndef TB_MEMORY_ROPE_BUFFER_H
+#define TB_MEMORY_ROPE_BUFFER_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "allocator.h"
+#include "../platform/prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/*! the rope buffer type
+ *
+ * the chained buffer of the slices, each slice refers to a range of the refcounted block.
+ *
+ * <pre>
+ *
+ * rope:   head                                                          tail
+ *          |                                                              |
+ *        slice ----------------> slice ----------------> slice ---------> slice
+ *          |                       |                       |                |
+ *  -----------------       ----------------        -----------------------------------
+ * | block: |||||||| |     | block: (user)  |      | block: |||||||||||||||||||||      |
+ *  -----------------       ----------------        -----------------------------------
+ *                                                    (shared by two slices, refn: 2)
+ * </pre>
+ *
+ * - append: copy data to the free space of the tail block, or refer to the user data without copying
+ * - prepend: insert a new slice at the head
+ * - split, splice and drop: only move or cut the slices, the data will be not copied
+ * - iovec: export the slices to the iovec list for tb_socket_sendv() and tb_file_writv()
+ *
+ * @note the fields are private and need not be accessed
+ */
+typedef struct __tb_rope_buffer_t
+{
+    /// the head slice
+    tb_pointer_t            head;
+
+    /// the tail slice
+    tb_pointer_t            tail;
+
+    /// the data size
+    tb_size_t               size;
+
+    /// the slice count
+    tb_size_t               count;
+
+    /// the allocator, uses the global allocator if be null
+    tb_allocator_ref_t      allocator;
+
+}tb_rope_buffer_t, *tb_rope_buffer_ref_t;
+
+/*! the free func type of the user data
+ *
+ * @param data              the user data
+ * @param priv              the user private data
+ */
+typedef tb_void_t           (*tb_rope_buffer_free_func_t)(tb_pointer_t data, tb_cpointer_t priv);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init the rope buffer
+ *
+ * @param buffer            the buffer
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_init(tb_rope_buffer_ref_t buffer);
+
+/*! init the rope buffer with the given allocator
+ *
+ * @param buffer            the buffer
+ * @param allocator         the allocator for the slices and blocks, uses the global allocator if be null
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_init_with_allocator(tb_rope_buffer_ref_t buffer, tb_allocator_ref_t allocator);
+
+/*! exit the rope buffer
+ *
+ * @param buffer            the buffer
+ */
+tb_void_t                   tb_rope_buffer_exit(tb_rope_buffer_ref_t buffer);
+
+/*! clear the rope buffer
+ *
+ * @param buffer            the buffer
+ */
+tb_void_t                   tb_rope_buffer_clear(tb_rope_buffer_ref_t buffer);
+
+/*! the data size
+ *
+ * @param buffer            the buffer
+ *
+ * @return                  the data size
+ */
+tb_size_t                   tb_rope_buffer_size(tb_rope_buffer_ref_t buffer);
+
+/*! the slice count
+ *
+ * @param buffer            the buffer
+ *
+ * @return                  the slice count
+ */
+tb_size_t                   tb_rope_buffer_count(tb_rope_buffer_ref_t buffer);
+
+/*! append the data by copying it to the free space of the tail block
+ *
+ * @param buffer            the buffer
+ * @param data              the data
+ * @param size              the size
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_append(tb_rope_buffer_ref_t buffer, tb_byte_t const* data, tb_size_t size);
+
+/*! append the user data without copying it
+ *
+ * the user data will be freed by the free func after it is not referred by all slices
+ *
+ * @param buffer            the buffer
+ * @param data              the user data, it need be valid until the free func is called
+ * @param size              the size
+ * @param func              the free func, the data need not be freed if be null
+ * @param priv              the user private data of the free func
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_append_ref(tb_rope_buffer_ref_t buffer, tb_byte_t* data, tb_size_t size, tb_rope_buffer_free_func_t func, tb_cpointer_t priv);
+
+/*! prepend the data by copying it
+ *
+ * @param buffer            the buffer
+ * @param data              the data
+ * @param size              the size
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_prepend(tb_rope_buffer_ref_t buffer, tb_byte_t const* data, tb_size_t size);
+
+/*! prepend the user data without copying it
+ *
+ * @param buffer            the buffer
+ * @param data              the user data, it need be valid until the free func is called
+ * @param size              the size
+ * @param func              the free func, the data need not be freed if be null
+ * @param priv              the user private data of the free func
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_prepend_ref(tb_rope_buffer_ref_t buffer, tb_byte_t* data, tb_size_t size, tb_rope_buffer_free_func_t func, tb_cpointer_t priv);
+
+/*! append the range of the other buffer by sharing its blocks without copying data
+ *
+ * @param buffer            the buffer
+ * @param other             the other buffer, it will be not modified
+ * @param offset            the offset of the range
+ * @param size              the size of the range, (tb_size_t)-1 for all the remaining data
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_append_rope(tb_rope_buffer_ref_t buffer, tb_rope_buffer_ref_t other, tb_size_t offset, tb_size_t size);
+
+/*! splice all data of the other buffer to the tail of the buffer, and the other buffer will be empty
+ *
+ * @param buffer            the buffer
+ * @param other             the other buffer
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_splice(tb_rope_buffer_ref_t buffer, tb_rope_buffer_ref_t other);
+
+/*! split the buffer at the given offset, and move the data after it to the tail of the other buffer
+ *
+ * @param buffer            the buffer, only the data before the offset will be kept
+ * @param offset            the offset
+ * @param other             the other buffer
+ *
+ * @return                  tb_true or tb_false
+ */
+tb_bool_t                   tb_rope_buffer_split(tb_rope_buffer_ref_t buffer, tb_size_t offset, tb_rope_buffer_ref_t other);
+
+/*! drop the data from the head, e.g. the data has been sent
+ *
+ * @param buffer            the buffer
+ * @param size              the size
+ *
+ * @return                  the real dropped size
+ */
+tb_size_t                   tb_rope_buffer_drop(tb_rope_buffer_ref_t buffer, tb_size_t size);
+
+/*! read the data at the given offset by copying it
+ *
+ * @param buffer            the buffer
+ * @param offset            the offset
+ * @param data              the data
+ * @param size              the size
+ *
+ * @return                  the real read size
+ */
+tb_size_t                   tb_rope_buffer_read(tb_rope_buffer_ref_t buffer, tb_size_t offset, tb_byte_t* data, tb_size_t size);
+
+/*! export the slices to the iovec list
+ *
+ * @code
+    tb_iovec_t list[16];
+    while (tb_rope_buffer_size(&buffer))
+    {
+        tb_size_t count = tb_rope_buffer_iovec(&buffer, list, tb_arrayn(list));
+        tb_long_t real = tb_socket_sendv(sock, list, count);
+        if (real > 0) tb_rope_buffer_drop(&buffer, real);
+        else ...
+    }
+ * @endcode
+ *
+ * @param buffer            the buffer
+ * @param list              the iovec list
+ * @param maxn              the iovec maxn
+ *
+ * @return                  the iovec count
+ */
+tb_size_t                   tb_rope_buffer_iovec(tb_rope_buffer_ref_t buffer, tb_iovec_t* list, tb_size_t maxn);
+
+/*! make all data contiguous, it will copy data if there are more than one slice
+ *
+ * @param buffer            the buffer
+ *
+ * @return                  the data address, tb_null if the buffer is empty or failed
+ */
+tb_byte_t*                  tb_rope_buffer_pullup(tb_rope_buffer_ref_t buffer);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -51,11 +51,53 @@ typedef struct __tb_small_allocator_t
     // the large allocator
     tb_allocator_ref_t      large_allocator;
 
-    // the fixed pool
-    tb_fixed_pool_ref_t     fixed_pool[12];
+    // the fixed pool for each size class
+    tb_fixed_pool_ref_t     fixed_pool[TB_SMALL_ALLOCATOR_CLASS_MAXN];
+
+    // the data space of each size class
+    tb_uint16_t             class_space[TB_SMALL_ALLOCATOR_CLASS_MAXN];
+
+    // the size classes count
+    tb_size_t               class_count;
+
+    // the size class index table, the table index is (size + TB_SMALL_ALLOCATOR_CLASS_ALIGN - 1) / TB_SMALL_ALLOCATOR_CLASS_ALIGN
+    tb_byte_t               class_index[TB_SMALL_ALLOCATOR_DATA_MAXN / TB_SMALL_ALLOCATOR_CLASS_ALIGN + 1];
+
+    // the malloc count
+    tb_size_t               malloc_count;
+
+    // the ralloc count
+    tb_size_t               ralloc_count;
+
+    // the free count
+    tb_size_t               free_count;
+
+    // the live data size
+    tb_size_t               live_size;
+
+    // the peak live data size
+    tb_size_t               peak_size;
 
 }tb_small_allocator_t, *tb_small_allocator_ref_t;
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+/* the default size classes with ~12.5% spacing (8 classes for each doubling)
+ *
+ * the wasted space of the internal fragmentation is less than 12.5% for the data size > 128B 
+ */
+static tb_uint16_t const g_small_allocator_classes[] = 
+{
+    16,     32,     48,     64,     80,     96,     112,    128
+,   144,    160,    176,    192,    208,    224,    240,    256
+,   288,    320,    352,    384,    416,    448,    480,    512
+,   576,    640,    704,    768,    832,    896,    960,    1024
+,   1152,   1280,   1408,   1536,   1664,   1792,   1920,   2048
+,   2304,   2560,   2816,   3072
+};
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * declaration
  */
@@ -64,105 +106,90 @@ __tb_extern_c__ tb_fixed_pool_ref_t tb_fixed_pool_init_(tb_allocator_ref_t large
 /* //////////////////////////////////////////////////////////////////////////////////////
  * private implementation
  */
-static tb_fixed_pool_ref_t tb_small_allocator_find_fixed(tb_small_allocator_ref_t allocator, tb_size_t size)
+static __tb_inline__ tb_size_t tb_small_allocator_find_class(tb_small_allocator_ref_t allocator, tb_size_t size)
 {
     // check
     tb_assert(allocator && size && size <= TB_SMALL_ALLOCATOR_DATA_MAXN);
 
-    // done
-    tb_fixed_pool_ref_t fixed_pool = tb_null;
-    do
+    // find the size class from the index table
+    return allocator->class_index[(size + TB_SMALL_ALLOCATOR_CLASS_ALIGN - 1) / TB_SMALL_ALLOCATOR_CLASS_ALIGN];
+}
+static tb_bool_t tb_small_allocator_init_classes(tb_small_allocator_ref_t allocator, tb_size_t const* classes, tb_size_t count)
+{
+    // check
+    tb_assert_and_check_return_val(allocator, tb_false);
+
+    // init the size classes
+    tb_size_t i = 0;
+    tb_size_t n = 0;
+    if (classes && count)
     {
-        // the fixed pool index
-        tb_size_t index = 0;
-        tb_size_t space = 0;
-        if (size > 64 && size < 193)
-        {
-            if (size < 97)
-            {
-                index = 3;
-                space = 96;
-            }
-            else if (size > 128)
-            {
-                index = 5;
-                space = 192;
-            }
-            else 
-            {
-                index = 4;
-                space = 128;
-            }
-        }
-        else if (size > 192 && size < 513)
+        for (i = 0; i < count && n < TB_SMALL_ALLOCATOR_CLASS_MAXN; i++)
         {
-            if (size < 257)
-            {
-                index = 6;
-                space = 256;
-            }
-            else if (size > 384)
-            {
-                index = 8;
-                space = 512;
-            }
-            else 
-            {
-                index = 7;
-                space = 384;
-            }
-        }
-        else if (size < 65)
-        {
-            if (size < 17)
-            {
-                index = 0;
-                space = 16;
-            }
-            else if (size > 32)
-            {
-                index = 2;
-                space = 64;
-            }
-            else 
-            {
-                index = 1;
-                space = 32;
-            }
+            // check
+            tb_size_t space = classes[i];
+            tb_assertf_and_check_return_val(space && space <= TB_SMALL_ALLOCATOR_DATA_MAXN && !(space & (TB_SMALL_ALLOCATOR_CLASS_ALIGN - 1)), tb_false, "invalid size class: %lu", space);
+            tb_assertf_and_check_return_val(!n || space > allocator->class_space[n - 1], tb_false, "the size classes must be ascending: %lu", space);
+
+            // save it
+            allocator->class_space[n++] = (tb_uint16_t)space;
         }
-        else 
+
+        // append the maximum class if not exists
+        if (allocator->class_space[n - 1] != TB_SMALL_ALLOCATOR_DATA_MAXN)
         {
-            if (size < 1025)
-            {
-                index = 9;
-                space = 1024;
-            }
-            else if (size > 2048)
-            {
-                index = 11;
-                space = 3072;
-            }
-            else 
-            {
-                index = 10;
-                space = 2048;
-            }
+            tb_assert_and_check_return_val(n < TB_SMALL_ALLOCATOR_CLASS_MAXN, tb_false);
+            allocator->class_space[n++] = TB_SMALL_ALLOCATOR_DATA_MAXN;
         }
+    }
+    else
+    {
+        tb_assert_static(tb_arrayn(g_small_allocator_classes) <= TB_SMALL_ALLOCATOR_CLASS_MAXN);
+        for (n = 0; n < tb_arrayn(g_small_allocator_classes); n++)
+            allocator->class_space[n] = g_small_allocator_classes[n];
+    }
+    allocator->class_count = n;
 
-        // trace
-        tb_trace_d("find: size: %lu => index: %lu, space: %lu", size, index, space);
+    // init the size class index table
+    tb_size_t index = 0;
+    for (i = 0; i < tb_arrayn(allocator->class_index); i++)
+    {
+        // the minimum class which can contain this size
+        while (allocator->class_space[index] < i * TB_SMALL_ALLOCATOR_CLASS_ALIGN) index++;
+        tb_assert(index < n);
 
-        // make fixed pool if not exists
-        if (!allocator->fixed_pool[index]) allocator->fixed_pool[index] = tb_fixed_pool_init_(allocator->large_allocator, 0, space, tb_true, tb_null, tb_null, tb_null);
-        tb_assert_and_check_break(allocator->fixed_pool[index]);
+        // save it
+        allocator->class_index[i] = (tb_byte_t)index;
+    }
 
-        // ok
-        fixed_pool = allocator->fixed_pool[index];
+    // ok
+    return tb_true;
+}
+static tb_fixed_pool_ref_t tb_small_allocator_find_pool(tb_small_allocator_ref_t allocator, tb_size_t index, tb_size_t space)
+{
+    // check
+    tb_assert(allocator && index < tb_arrayn(allocator->fixed_pool));
 
-    } while (0);
+    // make fixed pool if not exists
+    if (!allocator->fixed_pool[index]) allocator->fixed_pool[index] = tb_fixed_pool_init_(allocator->large_allocator, 0, space, tb_true, tb_null, tb_null, tb_null);
+    tb_assert(allocator->fixed_pool[index]);
 
-    // ok?
-    return fixed_pool;
+    // ok
+    return allocator->fixed_pool[index];
+}
+static tb_fixed_pool_ref_t tb_small_allocator_find_fixed(tb_small_allocator_ref_t allocator, tb_size_t size)
+{
+    // check
+    tb_assert(allocator && size && size <= TB_SMALL_ALLOCATOR_DATA_MAXN);
+
+    // the size class
+    tb_size_t index = tb_small_allocator_find_class(allocator, size);
+
+    // trace
+    tb_trace_d("find: size: %lu => index: %lu, space: %lu", size, index, allocator->class_space[index]);
+
+    // the fixed pool
+    return tb_small_allocator_find_pool(allocator, index, allocator->class_space[index]);
 }
 #ifdef __tb_debug__
 static tb_bool_t tb_small_allocator_item_check(tb_pointer_t data, tb_cpointer_t priv)
@@ -177,6 +204,15 @@ static tb_bool_t tb_small_allocator_item_check(tb_pointer_t data, tb_cpointer_t
     {
         // the data head
         tb_pool_data_head_t* data_head = &(((tb_pool_data_head_t*)data)[-1]);
+
+        // this data is cached by the thread cache of the default allocator? it is not live
+        if (data_head->debug.magic == TB_POOL_DATA_CACHE_MAGIC)
+        {
+            ok = tb_true;
+            break;
+        }
+
+        // check
         tb_assertf(data_head->debug.magic == TB_POOL_DATA_MAGIC, "invalid data: %p", data);
 
         // the data space
@@ -237,6 +273,23 @@ static tb_void_t tb_small_allocator_clear(tb_allocator_ref_t self)
         // clear it
         if (allocator->fixed_pool[i]) tb_fixed_pool_clear(allocator->fixed_pool[i]);
     }
+
+    // clear the live data size
+    allocator->live_size = 0;
+}
+static tb_void_t tb_small_allocator_trim(tb_allocator_ref_t self)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator && allocator->large_allocator);
+
+    // trim fixed pool
+    tb_size_t i = 0;
+    for (i = 0; i < allocator->class_count; i++)
+    {
+        // trim it
+        if (allocator->fixed_pool[i]) tb_fixed_pool_trim(allocator->fixed_pool[i]);
+    }
 }
 static tb_pointer_t tb_small_allocator_malloc(tb_allocator_ref_t self, tb_size_t size __tb_debug_decl__)
 {
@@ -269,6 +322,11 @@ static tb_pointer_t tb_small_allocator_malloc(tb_allocator_ref_t self, tb_size_t
         // update size
         data_head->size = size;
 
+        // update the statistics
+        allocator->malloc_count++;
+        allocator->live_size += tb_fixed_pool_item_size(fixed_pool);
+        if (allocator->live_size > allocator->peak_size) allocator->peak_size = allocator->live_size;
+
     } while (0);
 
     // check
@@ -284,6 +342,9 @@ static tb_pointer_t tb_small_allocator_ralloc(tb_allocator_ref_t self, tb_pointe
     tb_assert_and_check_return_val(allocator && allocator->large_allocator && data && size, tb_null);
     tb_assert_and_check_return_val(size <= TB_SMALL_ALLOCATOR_DATA_MAXN, tb_null);
 
+    // update the ralloc count
+    allocator->ralloc_count++;
+
     // done
     tb_pointer_t data_new = tb_null;
     do
@@ -344,15 +405,19 @@ static tb_pointer_t tb_small_allocator_ralloc(tb_allocator_ref_t self, tb_pointe
         // free the old data
         tb_fixed_pool_free_(fixed_pool_old, data __tb_debug_args__);
 
+        // update the live data size
+        allocator->live_size -= space_old;
+        allocator->live_size += tb_fixed_pool_item_size(fixed_pool_new);
+        if (allocator->live_size > allocator->peak_size) allocator->peak_size = allocator->live_size;
+
     } while (0);
 
     // ok
     return data_new;
 }
-static tb_bool_t tb_small_allocator_free(tb_allocator_ref_t self, tb_pointer_t data __tb_debug_decl__)
+static tb_bool_t tb_small_allocator_free_done(tb_small_allocator_ref_t allocator, tb_pointer_t data __tb_debug_decl__)
 {
     // check
-    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
     tb_assert_and_check_return_val(allocator && allocator->large_allocator && data, tb_false);
 
     // done
@@ -376,12 +441,62 @@ static tb_bool_t tb_small_allocator_free(tb_allocator_ref_t self, tb_pointer_t d
 
         // done
         ok = tb_fixed_pool_free_(fixed_pool, data __tb_debug_args__);
+        tb_check_break(ok);
+
+        // update the live data size
+        allocator->live_size -= space;
 
     } while (0);
 
     // ok?
     return ok;
 }
+static tb_bool_t tb_small_allocator_free(tb_allocator_ref_t self, tb_pointer_t data __tb_debug_decl__)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator, tb_false);
+
+    // update the free count
+    allocator->free_count++;
+
+    // free it
+    return tb_small_allocator_free_done(allocator, data __tb_debug_args__);
+}
+static tb_bool_t tb_small_allocator_stat(tb_allocator_ref_t self, tb_allocator_stat_t* stat)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && stat, tb_false);
+
+    // save the statistics
+    stat->malloc_count  = allocator->malloc_count;
+    stat->ralloc_count  = allocator->ralloc_count;
+    stat->free_count    = allocator->free_count;
+    stat->live_size     = allocator->live_size;
+    stat->peak_size     = allocator->peak_size;
+
+    // save the statistics of all size classes
+    tb_size_t i = 0;
+    tb_assert_static(TB_SMALL_ALLOCATOR_CLASS_MAXN <= TB_ALLOCATOR_STAT_CLASS_MAXN);
+    for (i = 0; i < allocator->class_count; i++)
+    {
+        tb_allocator_class_stat_t*  class_stat = &stat->classes[i];
+        tb_fixed_pool_ref_t         fixed_pool = allocator->fixed_pool[i];
+        class_stat->space = allocator->class_space[i];
+        if (fixed_pool)
+        {
+            class_stat->live_count      = tb_fixed_pool_size(fixed_pool);
+            class_stat->occupied_size   = tb_fixed_pool_occupied_size(fixed_pool);
+            stat->live_count            += class_stat->live_count;
+            stat->occupied_size         += class_stat->occupied_size;
+        }
+    }
+    stat->class_count = allocator->class_count;
+
+    // ok
+    return tb_true;
+}
 #ifdef __tb_debug__
 static tb_void_t tb_small_allocator_dump(tb_allocator_ref_t self)
 {
@@ -422,6 +537,10 @@ static tb_void_t tb_small_allocator_dump(tb_allocator_ref_t self)
  * implementation
  */
 tb_allocator_ref_t tb_small_allocator_init(tb_allocator_ref_t large_allocator)
+{
+    return tb_small_allocator_init_with_classes(large_allocator, tb_null, 0);
+}
+tb_allocator_ref_t tb_small_allocator_init_with_classes(tb_allocator_ref_t large_allocator, tb_size_t const* classes, tb_size_t count)
 {
     // done
     tb_bool_t                   ok = tb_false;
@@ -446,6 +565,8 @@ tb_allocator_ref_t tb_small_allocator_init(tb_allocator_ref_t large_allocator)
         allocator->base.free            = tb_small_allocator_free;
         allocator->base.clear           = tb_small_allocator_clear;
         allocator->base.exit            = tb_small_allocator_exit;
+        allocator->base.stat            = tb_small_allocator_stat;
+        allocator->base.trim            = tb_small_allocator_trim;
 #ifdef __tb_debug__
         allocator->base.dump            = tb_small_allocator_dump;
         allocator->base.have            = tb_small_allocator_have;
@@ -454,6 +575,9 @@ tb_allocator_ref_t tb_small_allocator_init(tb_allocator_ref_t large_allocator)
         // init lock
         if (!tb_spinlock_init(&allocator->base.lock)) break;
 
+        // init size classes
+        if (!tb_small_allocator_init_classes(allocator, classes, count)) break;
+
         // ok
         ok = tb_true;
 
@@ -470,3 +594,117 @@ tb_allocator_ref_t tb_small_allocator_init(tb_allocator_ref_t large_allocator)
     return (tb_allocator_ref_t)allocator;
 }
 
+tb_size_t tb_small_allocator_class(tb_allocator_ref_t self, tb_size_t size, tb_size_t* pspace)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && size && size <= TB_SMALL_ALLOCATOR_DATA_MAXN, 0);
+
+    // find the size class
+    tb_size_t index = tb_small_allocator_find_class(allocator, size);
+
+    // save the data space
+    if (pspace) *pspace = allocator->class_space[index];
+
+    // ok
+    return index;
+}
+tb_size_t tb_small_allocator_class_space(tb_allocator_ref_t self, tb_size_t index)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && index < allocator->class_count, 0);
+
+    // the data space
+    return allocator->class_space[index];
+}
+tb_size_t tb_small_allocator_class_count(tb_allocator_ref_t self)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator, 0);
+
+    // the size classes count
+    return allocator->class_count;
+}
+tb_size_t tb_small_allocator_malloc_list_(tb_allocator_ref_t self, tb_size_t index, tb_pointer_t* list, tb_size_t maxn __tb_debug_decl__)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return_val(allocator && allocator->large_allocator && list && maxn, 0);
+    tb_assert_and_check_return_val(index < allocator->class_count, 0);
+
+    // enter
+    tb_spinlock_enter(&allocator->base.lock);
+
+    // done
+    tb_size_t size = 0;
+    do
+    {
+        // the fixed pool
+        tb_size_t space = allocator->class_space[index];
+        tb_fixed_pool_ref_t fixed_pool = tb_small_allocator_find_pool(allocator, index, space);
+        tb_assert_and_check_break(fixed_pool);
+
+        // malloc data in batches
+        for (size = 0; size < maxn; size++)
+        {
+            // malloc it
+            tb_pointer_t data = tb_fixed_pool_malloc_(fixed_pool __tb_debug_args__);
+            tb_check_break(data);
+
+            // the data head
+            tb_pool_data_head_t* data_head = &(((tb_pool_data_head_t*)data)[-1]);
+            tb_assert(data_head->debug.magic == TB_POOL_DATA_MAGIC);
+
+            // the whole space is used
+            data_head->size = space;
+
+            // save it
+            list[size] = data;
+        }
+
+        // update the live data size
+        allocator->live_size += size * space;
+        if (allocator->live_size > allocator->peak_size) allocator->peak_size = allocator->live_size;
+
+    } while (0);
+
+    // leave
+    tb_spinlock_leave(&allocator->base.lock);
+
+    // ok?
+    return size;
+}
+tb_void_t tb_small_allocator_free_list_(tb_allocator_ref_t self, tb_pointer_t const* list, tb_size_t size __tb_debug_decl__)
+{
+    // check
+    tb_small_allocator_ref_t allocator = (tb_small_allocator_ref_t)self;
+    tb_assert_and_check_return(allocator && allocator->large_allocator && list);
+
+    // enter
+    tb_spinlock_enter(&allocator->base.lock);
+
+    // free data in batches
+    tb_size_t i = 0;
+    for (i = 0; i < size; i++)
+    {
+        // free it
+        if (!tb_small_allocator_free_done(allocator, list[i] __tb_debug_args__))
+        {
+#ifdef __tb_debug__
+            // trace
+            tb_trace_e("free(%p) failed! at %s(): %lu, %s", list[i], func_, line_, file_);
+
+            // dump data
+            tb_pool_data_dump((tb_byte_t const*)list[i], tb_true, "[small_allocator]: [error]: ");
+
+            // abort
+            tb_abort();
+#endif
+        }
+    }
+
+    // leave
+    tb_spinlock_leave(&allocator->base.lock);
+}
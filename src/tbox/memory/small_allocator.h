@@ -43,39 +43,44 @@ __tb_extern_c_enter__
 /// the data size maximum
 #define TB_SMALL_ALLOCATOR_DATA_MAXN        (3072)
 
+/// the size classes maximum count
+#define TB_SMALL_ALLOCATOR_CLASS_MAXN       (64)
+
+/// the size class alignment
+#define TB_SMALL_ALLOCATOR_CLASS_ALIGN      (16)
+
+/// malloc the data list of the given size class
+#define tb_small_allocator_malloc_list(allocator, index, list, maxn)    tb_small_allocator_malloc_list_(allocator, index, list, maxn __tb_debug_vals__)
+
+/// free the data list
+#define tb_small_allocator_free_list(allocator, list, size)             tb_small_allocator_free_list_(allocator, list, size __tb_debug_vals__)
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * interfaces
  */
 
 /*! init the small allocator only for size <=3KB
+ *
+ * the data size is mapped to the size class by a lookup table in O(1),
+ * and the data of each size class is allocated from its own fixed pool.
+ *
+ * the default size classes have ~12.5% spacing (8 classes for each doubling):
  *
  * <pre>
  *
- *  --------------------------------------
- * |    fixed pool: 16B    |  1-16B       | 
- * |--------------------------------------|
- * |    fixed pool: 32B    |  17-32B      |  
- * |--------------------------------------|
- * |    fixed pool: 64B    |  33-64B      | 
- * |--------------------------------------|
- * |    fixed pool: 96B*   |  65-96B*     | 
- * |--------------------------------------|
- * |    fixed pool: 128B   |  97-128B     |  
- * |--------------------------------------|
- * |    fixed pool: 192B*  |  129-192B*   |  
- * |--------------------------------------|
- * |    fixed pool: 256B   |  193-256B    |  
- * |--------------------------------------|
- * |    fixed pool: 384B*  |  257-384B*   |  
- * |--------------------------------------|
- * |    fixed pool: 512B   |  385-512B    |  
- * |--------------------------------------|
- * |    fixed pool: 1024B  |  513-1024B   |  
- * |--------------------------------------|
- * |    fixed pool: 2048B  |  1025-2048B  |  
- * |--------------------------------------|
- * |    fixed pool: 3072B* |  2049-3072B* |  
- *  -------------------------------------- 
+ *  ---------------------------------------------------
+ * |    16B - 128B      |  16, 32, 48, ..., 128   (+16)  |
+ * |---------------------------------------------------|
+ * |    129B - 256B     |  144, 160, ..., 256     (+16)  |
+ * |---------------------------------------------------|
+ * |    257B - 512B     |  288, 320, ..., 512     (+32)  |
+ * |---------------------------------------------------|
+ * |    513B - 1024B    |  576, 640, ..., 1024    (+64)  |
+ * |---------------------------------------------------|
+ * |    1025B - 2048B   |  1152, 1280, ..., 2048  (+128) |
+ * |---------------------------------------------------|
+ * |    2049B - 3072B   |  2304, 2560, 2816, 3072 (+256) |
+ *  ---------------------------------------------------
  *
  * </pre>
  * 
@@ -85,6 +90,72 @@ __tb_extern_c_enter__
  */
 tb_allocator_ref_t          tb_small_allocator_init(tb_allocator_ref_t large_allocator);
 
+/*! init the small allocator with the given size classes
+ *
+ * @code
+    // the size classes for the string-heavy workloads
+    static tb_size_t const s_classes[] = {16, 32, 48, 64, 96, 128, 256, 512, 1024, 2048};
+    tb_allocator_ref_t allocator = tb_small_allocator_init_with_classes(tb_null, s_classes, tb_arrayn(s_classes));
+ * @endcode
+ *
+ * @param large_allocator   the large allocator, uses the global allocator if be null
+ * @param classes           the ascending data space of the size classes, it must be aligned by TB_SMALL_ALLOCATOR_CLASS_ALIGN,
+ *                          the maximum class TB_SMALL_ALLOCATOR_DATA_MAXN will be appended automatically if not exists, 
+ *                          using the default classes if be null
+ * @param count             the size classes count, <= TB_SMALL_ALLOCATOR_CLASS_MAXN
+ *
+ * @return                  the pool 
+ */
+tb_allocator_ref_t          tb_small_allocator_init_with_classes(tb_allocator_ref_t large_allocator, tb_size_t const* classes, tb_size_t count);
+
+/*! get the size class of the given data size
+ *
+ * @param allocator         the small allocator
+ * @param size              the data size, (0, TB_SMALL_ALLOCATOR_DATA_MAXN]
+ * @param pspace            the data space of this class, optional
+ *
+ * @return                  the class index, [0, tb_small_allocator_class_count())
+ */
+tb_size_t                   tb_small_allocator_class(tb_allocator_ref_t allocator, tb_size_t size, tb_size_t* pspace);
+
+/*! get the data space of the given size class
+ *
+ * @param allocator         the small allocator
+ * @param index             the class index
+ *
+ * @return                  the data space
+ */
+tb_size_t                   tb_small_allocator_class_space(tb_allocator_ref_t allocator, tb_size_t index);
+
+/*! get the size classes count
+ *
+ * @param allocator         the small allocator
+ *
+ * @return                  the size classes count
+ */
+tb_size_t                   tb_small_allocator_class_count(tb_allocator_ref_t allocator);
+
+/*! malloc the data list of the given size class in batches with only one lock 
+ *
+ * the data size of each data head is the whole space of this class
+ *
+ * @param allocator         the small allocator
+ * @param index             the class index
+ * @param list              the data list
+ * @param maxn              the data list maxn
+ *
+ * @return                  the real data count
+ */
+tb_size_t                   tb_small_allocator_malloc_list_(tb_allocator_ref_t allocator, tb_size_t index, tb_pointer_t* list, tb_size_t maxn __tb_debug_decl__);
+
+/*! free the data list in batches with only one lock 
+ *
+ * @param allocator         the small allocator
+ * @param list              the data list
+ * @param size              the data count
+ */
+tb_void_t                   tb_small_allocator_free_list_(tb_allocator_ref_t allocator, tb_pointer_t const* list, tb_size_t size __tb_debug_decl__);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
@@ -122,6 +122,29 @@ static tb_bool_t tb_dns_cache_clear(tb_iterator_ref_t iterator, tb_cpointer_t it
     // ok?
     return ok;
 }
+static tb_void_t tb_dns_cache_pressure(tb_allocator_ref_t allocator, tb_size_t size, tb_cpointer_t priv)
+{
+    /* try to enter
+     *
+     * the pressure func may be called when allocating data with this lock in tb_dns_cache_set()
+     */
+    tb_check_return(tb_spinlock_enter_try(&g_lock));
+
+    // trace
+    tb_trace_d("pressure: clear %lu items", g_cache.hash? tb_hash_map_size(g_cache.hash) : 0);
+
+    // clear all items, they can be looked up again
+    if (g_cache.hash) tb_hash_map_clear(g_cache.hash);
+
+    // clear times
+    g_cache.times = 0;
+
+    // clear expired 
+    g_cache.expired = 0;
+
+    // leave
+    tb_spinlock_leave(&g_lock);
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -147,6 +170,9 @@ tb_bool_t tb_dns_cache_init()
     // leave
     tb_spinlock_leave(&g_lock);
 
+    // clear the cache under the memory pressure, the pressure func cannot be registered with the lock
+    if (ok && tb_allocator()) ok = tb_allocator_pressure_register(tb_allocator(), tb_dns_cache_pressure, tb_null);
+
     // failed? exit it
     if (!ok) tb_dns_cache_exit();
 
@@ -155,6 +181,9 @@ tb_bool_t tb_dns_cache_init()
 }
 tb_void_t tb_dns_cache_exit()
 {
+    // unregister the pressure func
+    if (tb_allocator()) tb_allocator_pressure_unregister(tb_allocator(), tb_dns_cache_pressure, tb_null);
+
     // enter
     tb_spinlock_enter(&g_lock);
 
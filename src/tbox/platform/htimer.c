@@ -0,0 +1,877 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        htimer.c
+ * @ingroup     platform
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME                "htimer"
+#define TB_TRACE_MODULE_DEBUG               (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "platform.h"
+#include "../memory/memory.h"
+#include "../container/container.h"
+#include "../utils/utils.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the bits of the first wheel, 256 slots and 1ms for each slot
+#define TB_HTIMER_WHEEL_BITS0               (8)
+
+// the bits of the upper wheels, 64 slots for each wheel
+#define TB_HTIMER_WHEEL_BITSN               (6)
+
+// the wheel levels, the range of all wheels is 2^32 ms (~49 days)
+#define TB_HTIMER_WHEEL_LEVELS              (5)
+
+// the slots count of the first wheel
+#define TB_HTIMER_WHEEL_SIZE0               (1 << TB_HTIMER_WHEEL_BITS0)
+
+// the slots count of the upper wheel
+#define TB_HTIMER_WHEEL_SIZEN               (1 << TB_HTIMER_WHEEL_BITSN)
+
+// the slots count of all wheels
+#define TB_HTIMER_WHEEL_MAXN                (TB_HTIMER_WHEEL_SIZE0 + TB_HTIMER_WHEEL_SIZEN * (TB_HTIMER_WHEEL_LEVELS - 1))
+
+// the time range of all wheels, the longer tasks will be placed at the end of the last wheel and cascaded again
+#define TB_HTIMER_WHEEL_RANGE               ((tb_hong_t)1 << (TB_HTIMER_WHEEL_BITS0 + TB_HTIMER_WHEEL_BITSN * (TB_HTIMER_WHEEL_LEVELS - 1)))
+
+// the time shift of the given wheel level
+#define tb_htimer_wheel_shift(level)        ((level)? (TB_HTIMER_WHEEL_BITS0 + TB_HTIMER_WHEEL_BITSN * ((level) - 1)) : 0)
+
+// the first slot index of the given wheel level
+#define tb_htimer_wheel_base(level)         ((level)? (TB_HTIMER_WHEEL_SIZE0 + TB_HTIMER_WHEEL_SIZEN * ((level) - 1)) : 0)
+
+// the slot mask of the given wheel level
+#define tb_htimer_wheel_mask(level)         ((level)? (TB_HTIMER_WHEEL_SIZEN - 1) : (TB_HTIMER_WHEEL_SIZE0 - 1))
+
+// the task is not in the wheel and the expired list
+#define TB_HTIMER_WINDX_NONE                ((tb_uint32_t)-1)
+
+// the task is in the expired list
+#define TB_HTIMER_WINDX_EXPIRED             ((tb_uint32_t)-2)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the timer task type
+typedef struct __tb_htimer_task_t
+{
+    // the list entry for the wheel slot or the expired list
+    tb_list_entry_t             entry;
+
+    // the func
+    tb_htimer_task_func_t       func;
+
+    // the priv
+    tb_cpointer_t               priv;
+
+    // the when
+    tb_hong_t                   when;
+
+    // the period
+    tb_uint32_t                 period  : 28;
+
+    // is repeat?
+    tb_uint32_t                 repeat  : 1;
+
+    // is killed?
+    tb_uint32_t                 killed  : 1;
+
+    // the refn, <= 2
+    tb_uint32_t                 refn    : 2;
+
+    // the wheel slot index
+    tb_uint32_t                 windx;
+
+}tb_htimer_task_t;
+
+/*! the hierarchical timing wheel timer type
+ *
+ * <pre>
+ *
+ * wheel0: |-|-|-|-|-|-| ... |-|-|     256 slots, 1ms
+ * wheel1: |---|---|---| ... |---|      64 slots, 256ms
+ * wheel2: |-----|-----| ... |-----|    64 slots, 16s
+ * wheel3: |-------|---- ... ------|    64 slots, 17m
+ * wheel4: |---------|-- ... ------|    64 slots, 18h
+ *
+ * the tasks will be cascaded to the lower wheel when the lower wheel turns a full circle,
+ * and the expired tasks of the wheel0 will be moved to the expired list.
+ *
+ * </pre>
+ */
+typedef struct __tb_htimer_t
+{
+    // the grow
+    tb_size_t                   grow;
+
+    // is stoped?
+    tb_atomic_t                 stop;
+
+    // is worked?
+    tb_atomic_t                 work;
+
+    // cache time?
+    tb_bool_t                   ctime;
+
+    // the lock
+    tb_spinlock_t               lock;
+
+    // the pool
+    tb_fixed_pool_ref_t         pool;
+
+    // the event
+    tb_event_ref_t              event;
+
+    // the current time of the wheel, all slots before it have been handled
+    tb_hong_t                   jiffies;
+
+    // the tasks count in the wheel
+    tb_size_t                   count;
+
+    // the expired tasks
+    tb_list_entry_t             expired;
+
+    // the wheel bitmap of the non-empty slots
+    tb_uint64_t                 bits[TB_HTIMER_WHEEL_MAXN >> 6];
+
+    // the wheel slots
+    tb_list_entry_t             wheel[TB_HTIMER_WHEEL_MAXN];
+
+}tb_htimer_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+static __tb_inline__ tb_hong_t tb_htimer_now(tb_htimer_t* timer)
+{
+    // using the real time?
+    if (!timer->ctime)
+    {
+        // get the time
+        tb_timeval_t tv = {0};
+        if (tb_gettimeofday(&tv, tb_null)) return ((tb_hong_t)tv.tv_sec * 1000 + tv.tv_usec / 1000);
+    }
+
+    // using cached time
+    return tb_cache_time_mclock();
+}
+static __tb_inline__ tb_void_t tb_htimer_list_init(tb_list_entry_ref_t list)
+{
+    list->next = list;
+    list->prev = list;
+}
+static __tb_inline__ tb_bool_t tb_htimer_list_empty(tb_list_entry_ref_t list)
+{
+    return list->next == list;
+}
+static __tb_inline__ tb_void_t tb_htimer_list_insert(tb_list_entry_ref_t list, tb_list_entry_ref_t entry)
+{
+    entry->next         = list;
+    entry->prev         = list->prev;
+    list->prev->next    = entry;
+    list->prev          = entry;
+}
+static __tb_inline__ tb_void_t tb_htimer_list_remove(tb_list_entry_ref_t entry)
+{
+    entry->prev->next   = entry->next;
+    entry->next->prev   = entry->prev;
+    entry->next         = tb_null;
+    entry->prev         = tb_null;
+}
+static __tb_inline__ tb_void_t tb_htimer_list_moveto(tb_list_entry_ref_t list, tb_list_entry_ref_t moved)
+{
+    // empty?
+    tb_check_return(!tb_htimer_list_empty(moved));
+
+    // move all entries to the list tail
+    moved->next->prev   = list->prev;
+    list->prev->next    = moved->next;
+    moved->prev->next   = list;
+    list->prev          = moved->prev;
+
+    // clear the moved list
+    tb_htimer_list_init(moved);
+}
+static tb_size_t tb_htimer_wheel_find0(tb_htimer_t* timer, tb_size_t from)
+{
+    // find the first non-empty slot of the wheel0 in [from, TB_HTIMER_WHEEL_SIZE0)
+    tb_size_t   i = from >> 6;
+    tb_uint64_t bits = timer->bits[i] & ((tb_uint64_t)-1 << (from & 63));
+    while (1)
+    {
+        // found?
+        if (bits) return (i << 6) + tb_bits_fb1_u64_le(bits);
+
+        // end?
+        if (++i >= (TB_HTIMER_WHEEL_SIZE0 >> 6)) break;
+        bits = timer->bits[i];
+    }
+
+    // not found
+    return TB_HTIMER_WHEEL_SIZE0;
+}
+static tb_hong_t tb_htimer_wheel_next(tb_htimer_t* timer)
+{
+    // the current time of the wheel
+    tb_hong_t jiffies = timer->jiffies;
+
+    // find the next non-empty slot of the wheel0, the slots before the current slot are in the next circle
+    tb_hong_t   next = -1;
+    tb_size_t   indx = (tb_size_t)(jiffies & (TB_HTIMER_WHEEL_SIZE0 - 1));
+    tb_size_t   slot = tb_htimer_wheel_find0(timer, indx);
+    if (slot < TB_HTIMER_WHEEL_SIZE0) next = jiffies - indx + slot;
+    else if (indx && (slot = tb_htimer_wheel_find0(timer, 0)) < indx) next = jiffies - indx + TB_HTIMER_WHEEL_SIZE0 + slot;
+
+    // find the next cascaded time of the upper wheels
+    tb_size_t level = 1;
+    for (level = 1; level < TB_HTIMER_WHEEL_LEVELS; level++)
+    {
+        // empty wheel?
+        tb_uint64_t bits = timer->bits[(TB_HTIMER_WHEEL_SIZE0 >> 6) + level - 1];
+        tb_check_continue(bits);
+
+        // the first cascaded slot after the current time
+        tb_size_t   shift = tb_htimer_wheel_shift(level);
+        tb_hong_t   first = (jiffies + ((tb_hong_t)1 << shift) - 1) >> shift;
+        tb_size_t   start = (tb_size_t)(first & (TB_HTIMER_WHEEL_SIZEN - 1));
+
+        // find the next non-empty slot in circle
+        tb_uint64_t after = bits & ((tb_uint64_t)-1 << start);
+        slot = after? tb_bits_fb1_u64_le(after) : tb_bits_fb1_u64_le(bits);
+
+        // the cascaded time of this slot
+        tb_hong_t when = (first + ((slot - start) & (TB_HTIMER_WHEEL_SIZEN - 1))) << shift;
+        if (next < 0 || when < next) next = when;
+    }
+
+    // ok?
+    return next;
+}
+static tb_void_t tb_htimer_add_task(tb_htimer_t* timer, tb_htimer_task_t* timer_task)
+{
+    // check
+    tb_assert(timer && timer_task && timer_task->windx == TB_HTIMER_WINDX_NONE);
+
+    // the expired time, it will be handled at the current slot if it has been expired
+    tb_hong_t expires = timer_task->when;
+    tb_hong_t delta = expires - timer->jiffies;
+    if (delta < 0)
+    {
+        expires = timer->jiffies;
+        delta = 0;
+    }
+    // too long? place it at the end of the last wheel and it will be cascaded again
+    else if (delta >= TB_HTIMER_WHEEL_RANGE)
+    {
+        delta = TB_HTIMER_WHEEL_RANGE - 1;
+        expires = timer->jiffies + delta;
+    }
+
+    // compute the wheel level
+    tb_size_t level = 0;
+    while (level + 1 < TB_HTIMER_WHEEL_LEVELS && delta >= ((tb_hong_t)1 << tb_htimer_wheel_shift(level + 1))) level++;
+
+    // compute the wheel slot
+    tb_size_t windx = tb_htimer_wheel_base(level) + (tb_size_t)((expires >> tb_htimer_wheel_shift(level)) & tb_htimer_wheel_mask(level));
+    tb_assert(windx < TB_HTIMER_WHEEL_MAXN);
+
+    // trace
+    tb_trace_d("add: when: %lld, jiffies: %lld, level: %lu, windx: %lu", timer_task->when, timer->jiffies, level, windx);
+
+    // add it to the wheel slot
+    tb_htimer_list_insert(&timer->wheel[windx], &timer_task->entry);
+    timer->bits[windx >> 6] |= ((tb_uint64_t)1 << (windx & 63));
+    timer_task->windx = (tb_uint32_t)windx;
+    timer->count++;
+}
+static tb_void_t tb_htimer_del_task(tb_htimer_t* timer, tb_htimer_task_t* timer_task)
+{
+    // check
+    tb_assert(timer && timer_task);
+
+    // in the wheel?
+    tb_size_t windx = timer_task->windx;
+    if (windx < TB_HTIMER_WHEEL_MAXN)
+    {
+        // remove it from the wheel slot
+        tb_htimer_list_remove(&timer_task->entry);
+        if (tb_htimer_list_empty(&timer->wheel[windx])) timer->bits[windx >> 6] &= ~((tb_uint64_t)1 << (windx & 63));
+
+        // update the tasks count
+        tb_assert(timer->count);
+        timer->count--;
+    }
+    // in the expired list?
+    else if (windx == TB_HTIMER_WINDX_EXPIRED) tb_htimer_list_remove(&timer_task->entry);
+
+    // clear the wheel slot index
+    timer_task->windx = TB_HTIMER_WINDX_NONE;
+}
+static tb_void_t tb_htimer_expire_slot(tb_htimer_t* timer, tb_size_t windx)
+{
+    // check
+    tb_assert(windx < TB_HTIMER_WHEEL_MAXN);
+
+    // mark all tasks as expired
+    tb_list_entry_ref_t list = &timer->wheel[windx];
+    tb_list_entry_ref_t entry = list->next;
+    for (; entry != list; entry = entry->next)
+    {
+        ((tb_htimer_task_t*)entry)->windx = TB_HTIMER_WINDX_EXPIRED;
+        tb_assert(timer->count);
+        timer->count--;
+    }
+
+    // move them to the expired list
+    tb_htimer_list_moveto(&timer->expired, list);
+    timer->bits[windx >> 6] &= ~((tb_uint64_t)1 << (windx & 63));
+}
+static tb_void_t tb_htimer_cascade(tb_htimer_t* timer)
+{
+    // cascade the upper wheels until the current slot of the wheel is not the first slot
+    tb_size_t level = 1;
+    for (level = 1; level < TB_HTIMER_WHEEL_LEVELS; level++)
+    {
+        // the current slot of this wheel
+        tb_size_t slot = (tb_size_t)((timer->jiffies >> tb_htimer_wheel_shift(level)) & (TB_HTIMER_WHEEL_SIZEN - 1));
+        tb_size_t windx = tb_htimer_wheel_base(level) + slot;
+
+        // detach all tasks of this slot
+        tb_list_entry_t list;
+        tb_htimer_list_init(&list);
+        tb_htimer_list_moveto(&list, &timer->wheel[windx]);
+        timer->bits[windx >> 6] &= ~((tb_uint64_t)1 << (windx & 63));
+
+        // add them to the lower wheels again
+        while (!tb_htimer_list_empty(&list))
+        {
+            tb_htimer_task_t* timer_task = (tb_htimer_task_t*)list.next;
+            tb_htimer_list_remove(&timer_task->entry);
+            timer_task->windx = TB_HTIMER_WINDX_NONE;
+            tb_assert(timer->count);
+            timer->count--;
+            tb_htimer_add_task(timer, timer_task);
+        }
+
+        // not the first slot? stop it
+        tb_check_break(!slot);
+    }
+}
+static tb_void_t tb_htimer_advance(tb_htimer_t* timer, tb_hong_t now)
+{
+    // move the wheel to now
+    while (timer->jiffies <= now)
+    {
+        // no tasks in the wheel? move it to now directly
+        if (!timer->count)
+        {
+            timer->jiffies = now + 1;
+            break;
+        }
+
+        // the current slot of the wheel0, cascade the upper wheels if the wheel0 turns a full circle
+        tb_size_t indx = (tb_size_t)(timer->jiffies & (TB_HTIMER_WHEEL_SIZE0 - 1));
+        if (!indx) tb_htimer_cascade(timer);
+
+        // find the next non-empty slot of the wheel0 in the current circle
+        tb_size_t slot = tb_htimer_wheel_find0(timer, indx);
+        tb_hong_t next = timer->jiffies - indx + slot;
+
+        // not expired now?
+        if (next > now)
+        {
+            timer->jiffies = now + 1;
+            break;
+        }
+
+        // expire this slot or move to the next circle
+        if (slot < TB_HTIMER_WHEEL_SIZE0)
+        {
+            tb_htimer_expire_slot(timer, slot);
+            timer->jiffies = next + 1;
+        }
+        else timer->jiffies = next;
+    }
+}
+static tb_htimer_task_t* tb_htimer_post_task(tb_htimer_t* timer, tb_hize_t when, tb_size_t period, tb_bool_t repeat, tb_htimer_task_func_t func, tb_cpointer_t priv, tb_size_t refn)
+{
+    // check
+    tb_assert_and_check_return_val(timer && timer->pool && func, tb_null);
+
+    // stoped?
+    tb_assert_and_check_return_val(!tb_atomic_get(&timer->stop), tb_null);
+
+    // enter
+    tb_spinlock_enter(&timer->lock);
+
+    // make task
+    tb_event_ref_t      event = tb_null;
+    tb_hong_t           when_top = -1;
+    tb_htimer_task_t*   timer_task = (tb_htimer_task_t*)tb_fixed_pool_malloc0(timer->pool);
+    if (timer_task)
+    {
+        // the top when
+        if (timer->count) when_top = tb_htimer_wheel_next(timer);
+        // the wheel is idle? move it to now directly
+        else timer->jiffies = tb_htimer_now(timer);
+
+        // init task
+        timer_task->refn      = refn;
+        timer_task->func      = func;
+        timer_task->priv      = priv;
+        timer_task->when      = when;
+        timer_task->period    = period;
+        timer_task->repeat    = repeat? 1 : 0;
+        timer_task->windx     = TB_HTIMER_WINDX_NONE;
+
+        // add task
+        tb_htimer_add_task(timer, timer_task);
+
+        // the event
+        event = timer->event;
+    }
+
+    // leave
+    tb_spinlock_leave(&timer->lock);
+
+    // post event if the top task is changed
+    if (event && timer_task && (when_top < 0 || (tb_hong_t)when < when_top))
+        tb_event_post(event);
+
+    // ok?
+    return timer_task;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+tb_htimer_ref_t tb_htimer_init(tb_size_t grow, tb_bool_t ctime)
+{
+    // done
+    tb_bool_t       ok = tb_false;
+    tb_htimer_t*    timer = tb_null;
+    do
+    {
+        // make timer
+        timer = tb_malloc0_type(tb_htimer_t);
+        tb_assert_and_check_break(timer);
+
+        // init timer
+        timer->grow         = tb_max(grow, 16);
+        timer->ctime        = ctime;
+        timer->jiffies      = tb_htimer_now(timer);
+
+        // init wheel and expired list
+        tb_size_t i = 0;
+        for (i = 0; i < TB_HTIMER_WHEEL_MAXN; i++) tb_htimer_list_init(&timer->wheel[i]);
+        tb_htimer_list_init(&timer->expired);
+
+        // init lock
+        if (!tb_spinlock_init(&timer->lock)) break;
+
+        // init pool
+        timer->pool         = tb_fixed_pool_init(tb_null, timer->grow, sizeof(tb_htimer_task_t), tb_null, tb_null, tb_null);
+        tb_assert_and_check_break(timer->pool);
+
+        // register lock profiler
+#ifdef TB_LOCK_PROFILER_ENABLE
+        tb_lock_profiler_register(tb_lock_profiler(), (tb_pointer_t)&timer->lock, TB_TRACE_MODULE_NAME);
+#endif
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (timer) tb_htimer_exit((tb_htimer_ref_t)timer);
+        timer = tb_null;
+    }
+
+    // ok?
+    return (tb_htimer_ref_t)timer;
+}
+tb_void_t tb_htimer_exit(tb_htimer_ref_t self)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return(timer);
+
+    // kill it first
+    tb_htimer_kill(self);
+
+    // wait loop exit
+    tb_size_t tryn = 10;
+    while (tb_atomic_get(&timer->work) && tryn--) tb_msleep(500);
+
+    // warning
+    if (!tryn && tb_atomic_get(&timer->work))
+    {
+        tb_trace_w("[htimer]: the loop has been not exited now!");
+    }
+
+    // enter
+    tb_spinlock_enter(&timer->lock);
+
+    // exit pool, all tasks will be freed
+    if (timer->pool) tb_fixed_pool_exit(timer->pool);
+    timer->pool = tb_null;
+
+    // exit event
+    if (timer->event) tb_event_exit(timer->event);
+    timer->event = tb_null;
+
+    // leave
+    tb_spinlock_leave(&timer->lock);
+
+    // exit lock
+    tb_spinlock_exit(&timer->lock);
+
+    // exit it
+    tb_free(timer);
+}
+tb_void_t tb_htimer_kill(tb_htimer_ref_t self)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return(timer);
+
+    // stop it
+    if (!tb_atomic_fetch_and_set(&timer->stop, 1))
+    {
+        // get event
+        tb_spinlock_enter(&timer->lock);
+        tb_event_ref_t event = timer->event;
+        tb_spinlock_leave(&timer->lock);
+
+        // post event
+        if (event) tb_event_post(event);
+    }
+}
+tb_void_t tb_htimer_clear(tb_htimer_ref_t self)
+{
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    if (timer)
+    {
+        // enter
+        tb_spinlock_enter(&timer->lock);
+
+        // clear wheel and expired list
+        tb_size_t i = 0;
+        for (i = 0; i < TB_HTIMER_WHEEL_MAXN; i++) tb_htimer_list_init(&timer->wheel[i]);
+        tb_htimer_list_init(&timer->expired);
+        tb_memset(timer->bits, 0, sizeof(timer->bits));
+        timer->count    = 0;
+        timer->jiffies  = tb_htimer_now(timer);
+
+        // clear pool
+        if (timer->pool) tb_fixed_pool_clear(timer->pool);
+
+        // leave
+        tb_spinlock_leave(&timer->lock);
+    }
+}
+tb_hize_t tb_htimer_top(tb_htimer_ref_t self)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return_val(timer, -1);
+
+    // stoped?
+    tb_assert_and_check_return_val(!tb_atomic_get(&timer->stop), -1);
+
+    // enter
+    tb_spinlock_enter(&timer->lock);
+
+    // the expired tasks will be done at the next spak
+    tb_hize_t when = -1;
+    if (!tb_htimer_list_empty(&timer->expired)) when = tb_htimer_now(timer);
+    else if (timer->count) when = (tb_hize_t)tb_htimer_wheel_next(timer);
+
+    // leave
+    tb_spinlock_leave(&timer->lock);
+
+    // ok?
+    return when;
+}
+tb_size_t tb_htimer_delay(tb_htimer_ref_t self)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return_val(timer, -1);
+
+    // stoped?
+    tb_assert_and_check_return_val(!tb_atomic_get(&timer->stop), -1);
+
+    // enter
+    tb_spinlock_enter(&timer->lock);
+
+    // done
+    tb_size_t delay = -1;
+    if (!tb_htimer_list_empty(&timer->expired)) delay = 0;
+    else if (timer->count)
+    {
+        // the next time
+        tb_hong_t next = tb_htimer_wheel_next(timer);
+
+        // the now
+        tb_hong_t now = tb_htimer_now(timer);
+
+        // the delay
+        delay = next > now? (tb_size_t)(next - now) : 0;
+    }
+
+    // leave
+    tb_spinlock_leave(&timer->lock);
+
+    // ok?
+    return delay;
+}
+tb_bool_t tb_htimer_spak(tb_htimer_ref_t self)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return_val(timer && timer->pool, tb_false);
+
+    // stoped?
+    tb_check_return_val(!tb_atomic_get(&timer->stop), tb_false);
+
+    // the now
+    tb_hong_t now = tb_htimer_now(timer);
+
+    // move the wheel to now and move all expired tasks to the expired list
+    tb_spinlock_enter(&timer->lock);
+    tb_htimer_advance(timer, now);
+    tb_spinlock_leave(&timer->lock);
+
+    // done all expired tasks
+    while (1)
+    {
+        // enter
+        tb_spinlock_enter(&timer->lock);
+
+        // no more expired tasks?
+        if (tb_htimer_list_empty(&timer->expired))
+        {
+            tb_spinlock_leave(&timer->lock);
+            break;
+        }
+
+        // pop the expired task
+        tb_htimer_task_t* timer_task = (tb_htimer_task_t*)timer->expired.next;
+        tb_htimer_del_task(timer, timer_task);
+
+        // check refn
+        tb_assert(timer_task->refn);
+
+        // save func and data for calling it later
+        tb_htimer_task_func_t   func = timer_task->func;
+        tb_cpointer_t           priv = timer_task->priv;
+        tb_bool_t               killed = timer_task->killed? tb_true : tb_false;
+
+        // trace
+        tb_trace_d("done: expired: when: %lld, period: %u, refn: %u, killed: %u", timer_task->when, timer_task->period, timer_task->refn, timer_task->killed);
+
+        // repeat?
+        if (timer_task->repeat)
+        {
+            // update when
+            timer_task->when = now + timer_task->period;
+
+            // continue the task
+            tb_htimer_add_task(timer, timer_task);
+        }
+        else
+        {
+            // refn--
+            if (timer_task->refn > 1) timer_task->refn--;
+            // remove it from pool directly
+            else tb_fixed_pool_free(timer->pool, timer_task);
+        }
+
+        // leave
+        tb_spinlock_leave(&timer->lock);
+
+        // done func
+        if (func) func(killed, priv);
+    }
+
+    // ok
+    return tb_true;
+}
+tb_void_t tb_htimer_loop(tb_htimer_ref_t self)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return(timer);
+
+    // work++
+    tb_atomic_fetch_and_inc(&timer->work);
+
+    // init event
+    tb_spinlock_enter(&timer->lock);
+    if (!timer->event) timer->event = tb_event_init();
+    tb_spinlock_leave(&timer->lock);
+
+    // loop
+    while (!tb_atomic_get(&timer->stop))
+    {
+        // the delay
+        tb_size_t delay = tb_htimer_delay(self);
+        if (delay)
+        {
+            // the event
+            tb_spinlock_enter(&timer->lock);
+            tb_event_ref_t event = timer->event;
+            tb_spinlock_leave(&timer->lock);
+            tb_check_break(event);
+
+            // wait some time
+            if (tb_event_wait(event, delay) < 0) break;
+        }
+
+        // spak ctime
+        if (timer->ctime) tb_cache_time_spak();
+
+        // spak it
+        if (!tb_htimer_spak(self)) break;
+    }
+
+    // work--
+    tb_atomic_fetch_and_dec(&timer->work);
+}
+tb_htimer_task_ref_t tb_htimer_task_init(tb_htimer_ref_t self, tb_size_t delay, tb_bool_t repeat, tb_htimer_task_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return_val(timer && func, tb_null);
+
+    // add task
+    return tb_htimer_task_init_at(self, tb_htimer_now(timer) + delay, delay, repeat, func, priv);
+}
+tb_htimer_task_ref_t tb_htimer_task_init_at(tb_htimer_ref_t self, tb_hize_t when, tb_size_t period, tb_bool_t repeat, tb_htimer_task_func_t func, tb_cpointer_t priv)
+{
+    // add task, the refn is 2 and it need be removed manually
+    return (tb_htimer_task_ref_t)tb_htimer_post_task((tb_htimer_t*)self, when, period, repeat, func, priv, 2);
+}
+tb_htimer_task_ref_t tb_htimer_task_init_after(tb_htimer_ref_t self, tb_hize_t after, tb_size_t period, tb_bool_t repeat, tb_htimer_task_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return_val(timer && func, tb_null);
+
+    // add task
+    return tb_htimer_task_init_at(self, tb_htimer_now(timer) + after, period, repeat, func, priv);
+}
+tb_void_t tb_htimer_task_post(tb_htimer_ref_t self, tb_size_t delay, tb_bool_t repeat, tb_htimer_task_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return(timer && func);
+
+    // run task
+    tb_htimer_task_post_at(self, tb_htimer_now(timer) + delay, delay, repeat, func, priv);
+}
+tb_void_t tb_htimer_task_post_at(tb_htimer_ref_t self, tb_hize_t when, tb_size_t period, tb_bool_t repeat, tb_htimer_task_func_t func, tb_cpointer_t priv)
+{
+    // add task, the refn is 1 and it will be auto-removed after be expired
+    tb_htimer_post_task((tb_htimer_t*)self, when, period, repeat, func, priv, 1);
+}
+tb_void_t tb_htimer_task_post_after(tb_htimer_ref_t self, tb_hize_t after, tb_size_t period, tb_bool_t repeat, tb_htimer_task_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_htimer_t* timer = (tb_htimer_t*)self;
+    tb_assert_and_check_return(timer && func);
+
+    // run task
+    tb_htimer_task_post_at(self, tb_htimer_now(timer) + after, period, repeat, func, priv);
+}
+tb_void_t tb_htimer_task_exit(tb_htimer_ref_t self, tb_htimer_task_ref_t task)
+{
+    // check
+    tb_htimer_t*        timer = (tb_htimer_t*)self;
+    tb_htimer_task_t*   timer_task = (tb_htimer_task_t*)task;
+    tb_assert_and_check_return(timer && timer->pool && timer_task);
+
+    // trace
+    tb_trace_d("exit: when: %lld, period: %u, refn: %u", timer_task->when, timer_task->period, timer_task->refn);
+
+    // enter
+    tb_spinlock_enter(&timer->lock);
+
+    // remove it from the wheel or the expired list if it has been not expired
+    if (timer_task->refn > 1) tb_htimer_del_task(timer, timer_task);
+
+    // free it
+    tb_fixed_pool_free(timer->pool, timer_task);
+
+    // leave
+    tb_spinlock_leave(&timer->lock);
+}
+tb_void_t tb_htimer_task_kill(tb_htimer_ref_t self, tb_htimer_task_ref_t task)
+{
+    // check
+    tb_htimer_t*        timer = (tb_htimer_t*)self;
+    tb_htimer_task_t*   timer_task = (tb_htimer_task_t*)task;
+    tb_assert_and_check_return(timer && timer->pool && timer_task);
+
+    // trace
+    tb_trace_d("kill: when: %lld, period: %u, refn: %u", timer_task->when, timer_task->period, timer_task->refn);
+
+    // enter
+    tb_spinlock_enter(&timer->lock);
+
+    // not expired or removed?
+    if (timer_task->refn == 2)
+    {
+        // killed
+        timer_task->killed = 1;
+
+        // no repeat
+        timer_task->repeat = 0;
+
+        // move it to the expired list, it will be done at the next spak
+        if (timer_task->windx != TB_HTIMER_WINDX_EXPIRED)
+        {
+            tb_htimer_del_task(timer, timer_task);
+            tb_htimer_list_insert(&timer->expired, &timer_task->entry);
+            timer_task->windx = TB_HTIMER_WINDX_EXPIRED;
+        }
+    }
+
+    // leave
+    tb_spinlock_leave(&timer->lock);
+}
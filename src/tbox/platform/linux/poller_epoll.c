@@ -61,11 +61,11 @@ typedef struct __tb_poller_epoll_t
     // the events count
     tb_size_t               events_count;
 
-    // the user private data hash (socket => priv)
-    tb_cpointer_t*          hash;
+    // the user private data table (fd => priv), it is dense and grown on demand
+    tb_cpointer_t*          privs;
 
-    // the user private data hash size
-    tb_size_t               hash_size;
+    // the user private data table size
+    tb_size_t               privs_size;
     
 }tb_poller_epoll_t, *tb_poller_epoll_ref_t;
 
@@ -93,59 +93,162 @@ static tb_size_t tb_poller_maxfds()
     // ok?
     return maxfds;
 }
-static tb_void_t tb_poller_hash_set(tb_poller_epoll_ref_t poller, tb_long_t fd, tb_cpointer_t priv)
+static tb_bool_t tb_poller_privs_set(tb_poller_epoll_ref_t poller, tb_long_t fd, tb_cpointer_t priv)
 {
     // check
     tb_assert(poller && fd > 0 && fd < TB_MAXS32);
 
-    // not null?
-    if (priv)
+    // grow the private data table if the fd is out of range
+    if (fd >= poller->privs_size)
     {
-        // no hash? init it first
-        tb_size_t need = fd + 1;
-        if (!poller->hash)
-        {
-            // init hash
-            poller->hash = tb_nalloc0_type(need, tb_cpointer_t);
-            tb_assert_and_check_return(poller->hash);
-
-            // init hash size
-            poller->hash_size = need;
-        }
-        else if (need > poller->hash_size)
-        {
-            // grow hash
-            poller->hash = (tb_cpointer_t*)tb_ralloc(poller->hash, need * sizeof(tb_cpointer_t));
-            tb_assert_and_check_return(poller->hash);
+        // compute the new size, we grow it by doubling to avoid reallocating it for each new socket
+        tb_size_t size = tb_max(tb_align8(fd + 1), poller->privs_size << 1);
+        if (poller->maxn && size > poller->maxn) size = tb_max(fd + 1, poller->maxn);
 
-            // init growed space
-            tb_memset(poller->hash + poller->hash_size, 0, (need - poller->hash_size) * sizeof(tb_cpointer_t));
+        // grow it
+        poller->privs = (tb_cpointer_t*)tb_ralloc(poller->privs, size * sizeof(tb_cpointer_t));
+        tb_assert_and_check_return_val(poller->privs, tb_false);
 
-            // grow hash size
-            poller->hash_size = need;
-        }
+        // init the grown space
+        tb_memset(poller->privs + poller->privs_size, 0, (size - poller->privs_size) * sizeof(tb_cpointer_t));
 
-        // save the user private data
-        poller->hash[fd] = priv;
+        // update size
+        poller->privs_size = size;
     }
+
+    // save the user private data, we need clear the previous one if it is null
+    poller->privs[fd] = priv;
+
+    // ok
+    return tb_true;
 }
-static __tb_inline__ tb_cpointer_t tb_poller_hash_get(tb_poller_epoll_ref_t poller, tb_long_t fd)
+static __tb_inline__ tb_cpointer_t tb_poller_privs_get(tb_poller_epoll_ref_t poller, tb_long_t fd)
 {
     // check
-    tb_assert(poller && poller->hash);
-    tb_assert(fd > 0 && fd < TB_MAXS32);
+    tb_assert(poller && fd > 0 && fd < TB_MAXS32);
 
     // get the user private data
-    return fd < poller->hash_size? poller->hash[fd] : tb_null;
+    return fd < poller->privs_size? poller->privs[fd] : tb_null;
 }
-static __tb_inline__ tb_void_t tb_poller_hash_del(tb_poller_epoll_ref_t poller, tb_long_t fd)
+static __tb_inline__ tb_void_t tb_poller_privs_del(tb_poller_epoll_ref_t poller, tb_long_t fd)
 {
     // check
-    tb_assert(poller && poller->hash);
-    tb_assert(fd > 0 && fd < TB_MAXS32);
+    tb_assert(poller && fd > 0 && fd < TB_MAXS32);
 
     // remove the user private data
-    if (fd < poller->hash_size) poller->hash[fd] = tb_null;
+    if (fd < poller->privs_size) poller->privs[fd] = tb_null;
+}
+static __tb_inline__ tb_size_t tb_poller_events_from(tb_size_t epoll_events)
+{
+    // init events 
+    tb_size_t events = TB_POLLER_EVENT_NONE;
+    if (epoll_events & EPOLLIN) events |= TB_POLLER_EVENT_RECV;
+    if (epoll_events & EPOLLOUT) events |= TB_POLLER_EVENT_SEND;
+    if (epoll_events & (EPOLLHUP | EPOLLERR) && !(events & (TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND))) 
+        events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
+
+#ifdef EPOLLRDHUP
+    // connection closed for the edge trigger?
+    if (epoll_events & EPOLLRDHUP) events |= TB_POLLER_EVENT_EOF;
+#endif
+
+    // ok
+    return events;
+}
+static tb_long_t tb_poller_wait_done(tb_poller_epoll_ref_t poller, tb_poller_event_func_t func, tb_poller_event_ref_t list, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(poller && poller->epfd > 0 && poller->maxn && (func || (list && maxn)), -1);
+
+    // init events
+    tb_size_t grow = tb_align8((poller->maxn >> 3) + 1);
+    if (!poller->events)
+    {
+        poller->events_count = grow;
+        poller->events = tb_nalloc_type(poller->events_count, struct epoll_event);
+        tb_assert_and_check_return_val(poller->events, -1);
+    }
+    
+    // wait events, we only harvest the events which can be stored to the given list
+    tb_long_t events_maxn = func? poller->events_count : tb_min(poller->events_count, maxn);
+    tb_long_t events_count = epoll_wait(poller->epfd, poller->events, events_maxn, timeout);
+
+    // interrupted?(for gdb?) continue it
+    if (events_count < 0 && errno == EINTR) return 0;
+
+    // check error?
+    tb_assert_and_check_return_val(events_count >= 0 && events_count <= events_maxn, -1);
+    
+    // timeout?
+    tb_check_return_val(events_count, 0);
+
+    // grow it if events is full
+    if (events_count == poller->events_count && poller->events_count < poller->maxn)
+    {
+        // grow size
+        poller->events_count += grow;
+        if (poller->events_count > poller->maxn) poller->events_count = poller->maxn;
+
+        // grow data
+        poller->events = (struct epoll_event*)tb_ralloc(poller->events, poller->events_count * sizeof(struct epoll_event));
+        tb_assert_and_check_return_val(poller->events, -1);
+    }
+    tb_assert(events_count <= poller->events_count);
+
+    // limit 
+    events_count = tb_min(events_count, poller->maxn);
+
+    // handle events
+    tb_size_t           i = 0;
+    tb_size_t           wait = 0; 
+    struct epoll_event* e = tb_null;
+    tb_socket_ref_t     pair = poller->pair[1];
+    for (i = 0; i < events_count; i++)
+    {
+        // the epoll event
+        e = poller->events + i;
+
+        // the events for epoll
+        tb_size_t epoll_events = e->events;
+
+        // the socket
+        tb_long_t       fd = e->data.fd;
+        tb_socket_ref_t sock = tb_fd2sock(fd);
+
+        // spak?
+        if (sock == pair)
+        {
+            // skip it if no data
+            tb_check_continue(epoll_events & EPOLLIN);
+
+            // read spak
+            tb_char_t spak = '\0';
+            if (1 != tb_socket_recv(pair, (tb_byte_t*)&spak, 1)) return -1;
+
+            // killed?
+            if (spak == 'k') return -1;
+
+            // continue it
+            continue ;
+        }
+
+        // call event function
+        if (func) func((tb_poller_ref_t)poller, sock, tb_poller_events_from(epoll_events), tb_poller_privs_get(poller, fd));
+        // save this event to the list
+        else
+        {
+            tb_poller_event_ref_t event = list + wait;
+            event->sock     = sock;
+            event->events   = tb_poller_events_from(epoll_events);
+            event->priv     = tb_poller_privs_get(poller, fd);
+        }
+
+        // update the events count
+        wait++;
+    }
+
+    // ok
+    return wait;
 }
 
 /* //////////////////////////////////////////////////////////////////////////////////////
@@ -207,10 +310,10 @@ tb_void_t tb_poller_exit(tb_poller_ref_t self)
     poller->pair[0] = tb_null;
     poller->pair[1] = tb_null;
 
-    // exit hash
-    if (poller->hash) tb_free(poller->hash);
-    poller->hash        = tb_null;
-    poller->hash_size   = 0;
+    // exit the user private data table
+    if (poller->privs) tb_free(poller->privs);
+    poller->privs       = tb_null;
+    poller->privs_size  = 0;
 
     // exit events
     if (poller->events) tb_free(poller->events);
@@ -298,7 +401,7 @@ tb_bool_t tb_poller_insert(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t
     e.data.fd = (tb_int_t)tb_sock2fd(sock);
     
     // bind user private data to socket
-    tb_poller_hash_set(poller, e.data.fd, priv);
+    if (!tb_poller_privs_set(poller, e.data.fd, priv)) return tb_false;
 
     // add socket and events
     if (epoll_ctl(poller->epfd, EPOLL_CTL_ADD, e.data.fd, &e) < 0)
@@ -332,7 +435,7 @@ tb_bool_t tb_poller_remove(tb_poller_ref_t self, tb_socket_ref_t sock)
     }
 
     // remove user private data from this socket
-    tb_poller_hash_del(poller, fd);
+    tb_poller_privs_del(poller, fd);
     
     // ok
     return tb_true;
@@ -359,7 +462,7 @@ tb_bool_t tb_poller_modify(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t
     e.data.fd = (tb_int_t)tb_sock2fd(sock);
     
     // modify user private data to socket
-    tb_poller_hash_set(poller, e.data.fd, priv);
+    if (!tb_poller_privs_set(poller, e.data.fd, priv)) return tb_false;
 
     // modify events
     if (epoll_ctl(poller->epfd, EPOLL_CTL_MOD, e.data.fd, &e) < 0) 
@@ -377,100 +480,16 @@ tb_bool_t tb_poller_modify(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t
 tb_long_t tb_poller_wait(tb_poller_ref_t self, tb_poller_event_func_t func, tb_long_t timeout)
 {
     // check
-    tb_poller_epoll_ref_t poller = (tb_poller_epoll_ref_t)self;
-    tb_assert_and_check_return_val(poller && poller->epfd > 0 && poller->maxn && func, -1);
-
-    // init events
-    tb_size_t grow = tb_align8((poller->maxn >> 3) + 1);
-    if (!poller->events)
-    {
-        poller->events_count = grow;
-        poller->events = tb_nalloc_type(poller->events_count, struct epoll_event);
-        tb_assert_and_check_return_val(poller->events, -1);
-    }
-    
-    // wait events
-    tb_long_t events_count = epoll_wait(poller->epfd, poller->events, poller->events_count, timeout);
-
-    // interrupted?(for gdb?) continue it
-    if (events_count < 0 && errno == EINTR) return 0;
-
-    // check error?
-    tb_assert_and_check_return_val(events_count >= 0 && events_count <= poller->events_count, -1);
-    
-    // timeout?
-    tb_check_return_val(events_count, 0);
-
-    // grow it if events is full
-    if (events_count == poller->events_count)
-    {
-        // grow size
-        poller->events_count += grow;
-        if (poller->events_count > poller->maxn) poller->events_count = poller->maxn;
-
-        // grow data
-        poller->events = (struct epoll_event*)tb_ralloc(poller->events, poller->events_count * sizeof(struct epoll_event));
-        tb_assert_and_check_return_val(poller->events, -1);
-    }
-    tb_assert(events_count <= poller->events_count);
-
-    // limit 
-    events_count = tb_min(events_count, poller->maxn);
-
-    // handle events
-    tb_size_t           i = 0;
-    tb_size_t           wait = 0; 
-    struct epoll_event* e = tb_null;
-    tb_socket_ref_t     pair = poller->pair[1];
-    for (i = 0; i < events_count; i++)
-    {
-        // the epoll event
-        e = poller->events + i;
-
-        // the events for epoll
-        tb_size_t epoll_events = e->events;
-
-        // the socket
-        tb_long_t       fd = e->data.fd;
-        tb_socket_ref_t sock = tb_fd2sock(fd);
-
-        // spak?
-        if (sock == pair && (epoll_events & EPOLLIN)) 
-        {
-            // read spak
-            tb_char_t spak = '\0';
-            if (1 != tb_socket_recv(pair, (tb_byte_t*)&spak, 1)) return -1;
-
-            // killed?
-            if (spak == 'k') return -1;
-
-            // continue it
-            continue ;
-        }
-
-        // skip spak
-        tb_check_continue(sock != pair);
-
-        // init events 
-        tb_size_t events = TB_POLLER_EVENT_NONE;
-        if (epoll_events & EPOLLIN) events |= TB_POLLER_EVENT_RECV;
-        if (epoll_events & EPOLLOUT) events |= TB_POLLER_EVENT_SEND;
-        if (epoll_events & (EPOLLHUP | EPOLLERR) && !(events & (TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND))) 
-            events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
-
-#ifdef EPOLLRDHUP
-        // connection closed for the edge trigger?
-        if (epoll_events & EPOLLRDHUP) events |= TB_POLLER_EVENT_EOF;
-#endif
+    tb_assert_and_check_return_val(self && func, -1);
 
-        // call event function
-        func(self, sock, events, tb_poller_hash_get(poller, fd));
-
-        // update the events count
-        wait++;
-    }
-
-    // ok
-    return wait;
+    // wait events and call the events function
+    return tb_poller_wait_done((tb_poller_epoll_ref_t)self, func, tb_null, 0, timeout);
 }
+tb_long_t tb_poller_wait_events(tb_poller_ref_t self, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(self && events && maxn, -1);
 
+    // wait events and save them to the given list
+    return tb_poller_wait_done((tb_poller_epoll_ref_t)self, tb_null, events, maxn, timeout);
+}
@@ -0,0 +1,1142 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        poller_iouring.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../posix/sockaddr.h"
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <unistd.h>
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * the epoll poller for the fallback if io_uring is not supported by the kernel
+ */
+#define tb_poller_init          tb_poller_epoll_init
+#define tb_poller_exit          tb_poller_epoll_exit
+#define tb_poller_clear         tb_poller_epoll_clear
+#define tb_poller_priv          tb_poller_epoll_priv
+#define tb_poller_kill          tb_poller_epoll_kill
+#define tb_poller_spak          tb_poller_epoll_spak
+#define tb_poller_support       tb_poller_epoll_support
+#define tb_poller_insert        tb_poller_epoll_insert
+#define tb_poller_remove        tb_poller_epoll_remove
+#define tb_poller_modify        tb_poller_epoll_modify
+#define tb_poller_wait          tb_poller_epoll_wait
+#define tb_poller_wait_events   tb_poller_epoll_wait_events
+
+/* declare them as static first, 
+ * so the following definitions of the epoll poller will be also static (internal linkage)
+ */
+static tb_poller_ref_t  tb_poller_epoll_init(tb_cpointer_t priv);
+static tb_void_t        tb_poller_epoll_exit(tb_poller_ref_t poller);
+static tb_void_t        tb_poller_epoll_clear(tb_poller_ref_t poller);
+static tb_cpointer_t    tb_poller_epoll_priv(tb_poller_ref_t poller);
+static tb_void_t        tb_poller_epoll_kill(tb_poller_ref_t poller);
+static tb_void_t        tb_poller_epoll_spak(tb_poller_ref_t poller);
+static tb_bool_t        tb_poller_epoll_support(tb_poller_ref_t poller, tb_size_t events);
+static tb_bool_t        tb_poller_epoll_insert(tb_poller_ref_t poller, tb_socket_ref_t sock, tb_size_t events, tb_cpointer_t priv);
+static tb_bool_t        tb_poller_epoll_remove(tb_poller_ref_t poller, tb_socket_ref_t sock);
+static tb_bool_t        tb_poller_epoll_modify(tb_poller_ref_t poller, tb_socket_ref_t sock, tb_size_t events, tb_cpointer_t priv);
+static tb_long_t        tb_poller_epoll_wait(tb_poller_ref_t poller, tb_poller_event_func_t func, tb_long_t timeout);
+static tb_long_t        tb_poller_epoll_wait_events(tb_poller_ref_t poller, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout);
+#include "poller_epoll.c"
+#undef tb_poller_init
+#undef tb_poller_exit
+#undef tb_poller_clear
+#undef tb_poller_priv
+#undef tb_poller_kill
+#undef tb_poller_spak
+#undef tb_poller_support
+#undef tb_poller_insert
+#undef tb_poller_remove
+#undef tb_poller_modify
+#undef tb_poller_wait
+#undef tb_poller_wait_events
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the submission and completion queue entries
+#ifdef __tb_small__
+#   define TB_POLLER_IOURING_SQ_MAXN        (64)
+#   define TB_POLLER_IOURING_CQ_MAXN        (512)
+#else
+#   define TB_POLLER_IOURING_SQ_MAXN        (256)
+#   define TB_POLLER_IOURING_CQ_MAXN        (4096)
+#endif
+
+// the probed operations count
+#define TB_POLLER_IOURING_PROBE_MAXN        (256)
+
+/* the user data of the poll request
+ *
+ * |     gen: 32 bits     |   fd: 31 bits   | 1 |
+ *
+ * the user data of the posted io operation is the aligned address of tb_poller_ioop_t,
+ * and the user data of the internal requests (poll remove, cancel and timeout) is zero.
+ */
+#define tb_poller_iouring_poll_data(fd, gen)    (((tb_uint64_t)(gen) << 32) | ((tb_uint64_t)(fd) << 1) | 0x1)
+#define tb_poller_iouring_poll_fd(data)         ((tb_long_t)(((data) >> 1) & 0x7fffffff))
+#define tb_poller_iouring_poll_gen(data)        ((tb_uint32_t)((data) >> 32))
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the io_uring socket type
+typedef struct __tb_poller_iouring_sock_t
+{
+    // the user private data
+    tb_cpointer_t               priv;
+
+    // the generation, it will be increased after inserting, modifying or removing it to ignore the stale completions
+    tb_uint32_t                 gen;
+
+    // the waited events
+    tb_uint16_t                 events;
+
+    // has been inserted?
+    tb_uint16_t                 inserted;
+
+}tb_poller_iouring_sock_t;
+
+// the io_uring poller type
+typedef struct __tb_poller_iouring_t
+{
+    // the maxn
+    tb_size_t                   maxn;
+
+    // the user private data
+    tb_cpointer_t               priv;
+
+    // the pair sockets for spak, kill ..
+    tb_socket_ref_t             pair[2];
+
+    // the fallback epoll poller if io_uring is not supported
+    tb_poller_ref_t             epoll;
+
+    // the events function of the fallback epoll poller
+    tb_poller_event_func_t      func;
+
+    // the io_uring fd
+    tb_long_t                   fd;
+
+    // the io_uring features
+    tb_uint32_t                 features;
+
+    // support the completion-style io operations?
+    tb_bool_t                   ioop;
+
+    // the submission queue ring
+    tb_byte_t*                  sq_ring;
+
+    // the submission queue ring size
+    tb_size_t                   sq_ring_size;
+
+    // the submission queue head, tail and array
+    tb_uint32_t volatile*       sq_head;
+    tb_uint32_t volatile*       sq_tail;
+    tb_uint32_t*                sq_array;
+
+    // the submission queue mask and entries
+    tb_uint32_t                 sq_mask;
+    tb_uint32_t                 sq_entries;
+
+    // the local tail of the submission queue, the queued entries: [*sq_head, sq_local)
+    tb_uint32_t                 sq_local;
+
+    // the submission queue entries
+    struct io_uring_sqe*        sqes;
+
+    // the submission queue entries size
+    tb_size_t                   sqes_size;
+
+    // the completion queue ring, it may be same as the sq_ring
+    tb_byte_t*                  cq_ring;
+
+    // the completion queue ring size
+    tb_size_t                   cq_ring_size;
+
+    // the completion queue head and tail
+    tb_uint32_t volatile*       cq_head;
+    tb_uint32_t volatile*       cq_tail;
+
+    // the completion queue mask
+    tb_uint32_t                 cq_mask;
+
+    // the completion queue entries
+    struct io_uring_cqe*        cqes;
+
+    // the sockets (fd => socket)
+    tb_poller_iouring_sock_t*   socks;
+
+    // the sockets size
+    tb_size_t                   socks_size;
+
+    // the triggered poll requests (user data) which need be polled again before waiting
+    tb_uint64_t*                polls;
+
+    // the triggered poll requests count
+    tb_size_t                   polls_count;
+
+    // the triggered poll requests maxn
+    tb_size_t                   polls_maxn;
+
+    // the timeout for waiting
+    struct __kernel_timespec    timeout;
+
+}tb_poller_iouring_t, *tb_poller_iouring_ref_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static __tb_inline__ tb_long_t tb_poller_iouring_setup(tb_uint32_t entries, struct io_uring_params* params)
+{
+    return syscall(__NR_io_uring_setup, entries, params);
+}
+static __tb_inline__ tb_long_t tb_poller_iouring_register(tb_long_t fd, tb_uint32_t opcode, tb_pointer_t arg, tb_uint32_t nargs)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nargs);
+}
+static tb_long_t tb_poller_iouring_enter(tb_poller_iouring_ref_t poller, tb_uint32_t min_complete, tb_uint32_t flags, tb_pointer_t arg, tb_size_t argsz)
+{
+    // check
+    tb_assert(poller && poller->fd >= 0);
+
+    // the pending entries
+    tb_uint32_t submit = poller->sq_local - *poller->sq_head;
+
+    // enter it
+    return syscall(__NR_io_uring_enter, poller->fd, submit, min_complete, flags, arg, argsz);
+}
+static tb_void_t tb_poller_iouring_events(tb_poller_ref_t epoll, tb_socket_ref_t sock, tb_size_t events, tb_cpointer_t priv)
+{
+    // get the io_uring poller
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)tb_poller_epoll_priv(epoll);
+    tb_assert(poller && poller->func);
+
+    // pass events to the user function
+    poller->func((tb_poller_ref_t)poller, sock, events, priv);
+}
+static tb_bool_t tb_poller_iouring_mmap(tb_poller_iouring_ref_t poller, struct io_uring_params* params)
+{
+    // check
+    tb_assert(poller && poller->fd >= 0 && params);
+
+    // compute the ring sizes
+    poller->sq_ring_size = params->sq_off.array + params->sq_entries * sizeof(tb_uint32_t);
+    poller->cq_ring_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+    poller->sqes_size    = params->sq_entries * sizeof(struct io_uring_sqe);
+
+    // only map them once?
+    if (params->features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if (poller->cq_ring_size > poller->sq_ring_size) poller->sq_ring_size = poller->cq_ring_size;
+        poller->cq_ring_size = poller->sq_ring_size;
+    }
+
+    // map the submission queue ring
+    tb_pointer_t data = mmap(tb_null, poller->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, poller->fd, IORING_OFF_SQ_RING);
+    tb_assert_and_check_return_val(data != MAP_FAILED, tb_false);
+    poller->sq_ring = (tb_byte_t*)data;
+
+    // map the completion queue ring
+    if (params->features & IORING_FEAT_SINGLE_MMAP) poller->cq_ring = poller->sq_ring;
+    else
+    {
+        data = mmap(tb_null, poller->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, poller->fd, IORING_OFF_CQ_RING);
+        tb_assert_and_check_return_val(data != MAP_FAILED, tb_false);
+        poller->cq_ring = (tb_byte_t*)data;
+    }
+
+    // map the submission queue entries
+    data = mmap(tb_null, poller->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, poller->fd, IORING_OFF_SQES);
+    tb_assert_and_check_return_val(data != MAP_FAILED, tb_false);
+    poller->sqes = (struct io_uring_sqe*)data;
+
+    // init the submission queue
+    poller->sq_head     = (tb_uint32_t volatile*)(poller->sq_ring + params->sq_off.head);
+    poller->sq_tail     = (tb_uint32_t volatile*)(poller->sq_ring + params->sq_off.tail);
+    poller->sq_array    = (tb_uint32_t*)(poller->sq_ring + params->sq_off.array);
+    poller->sq_mask     = *(tb_uint32_t*)(poller->sq_ring + params->sq_off.ring_mask);
+    poller->sq_entries  = *(tb_uint32_t*)(poller->sq_ring + params->sq_off.ring_entries);
+    poller->sq_local    = *poller->sq_tail;
+
+    // init the completion queue
+    poller->cq_head     = (tb_uint32_t volatile*)(poller->cq_ring + params->cq_off.head);
+    poller->cq_tail     = (tb_uint32_t volatile*)(poller->cq_ring + params->cq_off.tail);
+    poller->cq_mask     = *(tb_uint32_t*)(poller->cq_ring + params->cq_off.ring_mask);
+    poller->cqes        = (struct io_uring_cqe*)(poller->cq_ring + params->cq_off.cqes);
+
+    // ok
+    return tb_true;
+}
+static tb_bool_t tb_poller_iouring_probe(tb_poller_iouring_ref_t poller)
+{
+    // check
+    tb_assert(poller && poller->fd >= 0);
+
+    // the required operations
+    static tb_uint8_t s_opcodes[] =
+    {
+        IORING_OP_RECV
+    ,   IORING_OP_SEND
+    ,   IORING_OP_ACCEPT
+    ,   IORING_OP_CONNECT
+    ,   IORING_OP_ASYNC_CANCEL
+    };
+
+    // make probe
+    tb_size_t               size = sizeof(struct io_uring_probe) + TB_POLLER_IOURING_PROBE_MAXN * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe*  probe = (struct io_uring_probe*)tb_malloc0(size);
+    tb_assert_and_check_return_val(probe, tb_false);
+
+    // probe all operations
+    tb_bool_t ok = tb_false;
+    if (!tb_poller_iouring_register(poller->fd, IORING_REGISTER_PROBE, probe, TB_POLLER_IOURING_PROBE_MAXN))
+    {
+        tb_size_t i = 0;
+        for (i = 0; i < tb_arrayn(s_opcodes); i++)
+        {
+            tb_uint8_t opcode = s_opcodes[i];
+            if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) break;
+        }
+        ok = (i == tb_arrayn(s_opcodes));
+    }
+
+    // exit probe
+    tb_free(probe);
+
+    // ok?
+    return ok;
+}
+static tb_bool_t tb_poller_iouring_init_ring(tb_poller_iouring_ref_t poller)
+{
+    // check
+    tb_assert(poller);
+
+    // init io_uring
+    struct io_uring_params params;
+    tb_memset(&params, 0, sizeof(params));
+    params.flags        = IORING_SETUP_CQSIZE;
+    params.cq_entries   = TB_POLLER_IOURING_CQ_MAXN;
+    poller->fd = tb_poller_iouring_setup(TB_POLLER_IOURING_SQ_MAXN, &params);
+    if (poller->fd < 0)
+    {
+        // trace
+        tb_trace_d("io_uring is not supported, errno: %d", errno);
+        return tb_false;
+    }
+
+    // we need not drop the completions if the completion queue is full, otherwise the events may be lost
+    tb_check_return_val(params.features & IORING_FEAT_NODROP, tb_false);
+    poller->features = params.features;
+
+    // map the rings
+    if (!tb_poller_iouring_mmap(poller, &params)) return tb_false;
+
+    // probe the completion-style io operations
+    poller->ioop = tb_poller_iouring_probe(poller);
+
+    // trace
+    tb_trace_d("init: features: %x, ioop: %d", params.features, poller->ioop);
+
+    // ok
+    return tb_true;
+}
+static tb_void_t tb_poller_iouring_exit_ring(tb_poller_iouring_ref_t poller)
+{
+    // check
+    tb_assert(poller);
+
+    // exit the submission queue entries
+    if (poller->sqes) munmap(poller->sqes, poller->sqes_size);
+    poller->sqes = tb_null;
+
+    // exit the completion queue ring
+    if (poller->cq_ring && poller->cq_ring != poller->sq_ring) munmap(poller->cq_ring, poller->cq_ring_size);
+    poller->cq_ring = tb_null;
+
+    // exit the submission queue ring
+    if (poller->sq_ring) munmap(poller->sq_ring, poller->sq_ring_size);
+    poller->sq_ring = tb_null;
+
+    // close the io_uring fd
+    if (poller->fd >= 0) close(poller->fd);
+    poller->fd = -1;
+}
+static struct io_uring_sqe* tb_poller_iouring_sqe(tb_poller_iouring_ref_t poller)
+{
+    // check
+    tb_assert(poller && poller->sqes);
+
+    // the submission queue is full? submit them first
+    if (poller->sq_local - *poller->sq_head >= poller->sq_entries)
+    {
+        if (tb_poller_iouring_enter(poller, 0, 0, tb_null, 0) < 0)
+        {
+            // trace
+            tb_trace_e("submit failed, errno: %d", errno);
+        }
+        tb_check_return_val(poller->sq_local - *poller->sq_head < poller->sq_entries, tb_null);
+    }
+
+    // get a free entry, it is mapped from the kernel and we cannot check it in the debug memset 
+    tb_uint32_t             index = poller->sq_local & poller->sq_mask;
+    struct io_uring_sqe*    sqe = poller->sqes + index;
+    tb_memset_(sqe, 0, sizeof(struct io_uring_sqe));
+    poller->sq_array[index] = index;
+
+    // ok
+    return sqe;
+}
+static __tb_inline__ tb_void_t tb_poller_iouring_push(tb_poller_iouring_ref_t poller)
+{
+    // check
+    tb_assert(poller && poller->sq_tail);
+
+    // publish this entry to the kernel, it will be submitted when entering io_uring
+    poller->sq_local++;
+    tb_barrier();
+    *poller->sq_tail = poller->sq_local;
+}
+static tb_poller_iouring_sock_t* tb_poller_iouring_sock(tb_poller_iouring_ref_t poller, tb_long_t fd, tb_bool_t grow)
+{
+    // check
+    tb_assert(poller && fd >= 0 && fd < TB_MAXS32);
+
+    // grow sockets?
+    if (fd >= poller->socks_size)
+    {
+        // no grow?
+        tb_check_return_val(grow, tb_null);
+
+        // grow it, .e.g 64, 128, 256 ..
+        tb_size_t need = tb_max(tb_align8(fd + 1), poller->socks_size << 1);
+        poller->socks = (tb_poller_iouring_sock_t*)tb_ralloc(poller->socks, need * sizeof(tb_poller_iouring_sock_t));
+        tb_assert_and_check_return_val(poller->socks, tb_null);
+
+        // init the grown sockets
+        tb_memset(poller->socks + poller->socks_size, 0, (need - poller->socks_size) * sizeof(tb_poller_iouring_sock_t));
+        poller->socks_size = need;
+    }
+
+    // get it
+    return poller->socks + fd;
+}
+static tb_bool_t tb_poller_iouring_poll(tb_poller_iouring_ref_t poller, tb_long_t fd, tb_poller_iouring_sock_t* sock)
+{
+    // check
+    tb_assert(poller && sock && sock->inserted);
+
+    // get a submission entry
+    struct io_uring_sqe* sqe = tb_poller_iouring_sqe(poller);
+    tb_assert_and_check_return_val(sqe, tb_false);
+
+    // init poll mask
+    tb_uint32_t mask = 0;
+    if (sock->events & TB_POLLER_EVENT_RECV) mask |= POLLIN;
+    if (sock->events & TB_POLLER_EVENT_SEND) mask |= POLLOUT;
+
+    /* init poll request
+     *
+     * it is only triggered once and we need poll it again after handling events for the level trigger.
+     *
+     * we do not use the multishot poll for the edge trigger, because its completion is posted 
+     * when the socket is waked up and it will be stale if the data has been read before harvesting it,
+     * but epoll will check the events again when harvesting them.
+     */
+    sqe->opcode     = IORING_OP_POLL_ADD;
+    sqe->fd         = (tb_int_t)fd;
+    sqe->user_data  = tb_poller_iouring_poll_data(fd, sock->gen);
+#ifdef IORING_FEAT_POLL_32BITS
+    if (poller->features & IORING_FEAT_POLL_32BITS) sqe->poll32_events = mask;
+    else
+#endif
+    sqe->poll_events = (tb_uint16_t)mask;
+
+    // push it
+    tb_poller_iouring_push(poller);
+
+    // ok
+    return tb_true;
+}
+static tb_void_t tb_poller_iouring_poll_again(tb_poller_iouring_ref_t poller)
+{
+    // check
+    tb_assert(poller);
+
+    // poll the triggered sockets again
+    tb_size_t i = 0;
+    for (i = 0; i < poller->polls_count; i++)
+    {
+        // it has been not modified or removed?
+        tb_uint64_t                 data = poller->polls[i];
+        tb_long_t                   fd = tb_poller_iouring_poll_fd(data);
+        tb_poller_iouring_sock_t*   item = tb_poller_iouring_sock(poller, fd, tb_false);
+        if (item && item->inserted && item->gen == tb_poller_iouring_poll_gen(data))
+            tb_poller_iouring_poll(poller, fd, item);
+    }
+    poller->polls_count = 0;
+}
+static tb_void_t tb_poller_iouring_poll_later(tb_poller_iouring_ref_t poller, tb_uint64_t data)
+{
+    // check
+    tb_assert(poller);
+
+    // grow polls
+    if (poller->polls_count >= poller->polls_maxn)
+    {
+        poller->polls_maxn = poller->polls_maxn? (poller->polls_maxn << 1) : TB_POLLER_IOURING_SQ_MAXN;
+        poller->polls = (tb_uint64_t*)tb_ralloc(poller->polls, poller->polls_maxn * sizeof(tb_uint64_t));
+        tb_assert_and_check_return(poller->polls);
+    }
+
+    // save it
+    poller->polls[poller->polls_count++] = data;
+}
+static tb_bool_t tb_poller_iouring_poll_remove(tb_poller_iouring_ref_t poller, tb_long_t fd, tb_poller_iouring_sock_t* sock)
+{
+    // check
+    tb_assert(poller && sock && sock->inserted);
+
+    // get a submission entry
+    struct io_uring_sqe* sqe = tb_poller_iouring_sqe(poller);
+    tb_assert_and_check_return_val(sqe, tb_false);
+
+    // remove the previous poll request, it will be ignored if it has been completed
+    sqe->opcode     = IORING_OP_POLL_REMOVE;
+    sqe->fd         = -1;
+    sqe->addr       = tb_poller_iouring_poll_data(fd, sock->gen);
+    sqe->user_data  = 0;
+
+    // push it
+    tb_poller_iouring_push(poller);
+
+    // ok
+    return tb_true;
+}
+static tb_void_t tb_poller_iouring_ioop_done(tb_poller_iouring_ref_t poller, tb_poller_ioop_ref_t ioop, tb_int_t result)
+{
+    // check
+    tb_assert(poller && ioop);
+
+    // failed?
+    if (result < 0 && !(ioop->code == TB_POLLER_IOCODE_CONN && result == -EISCONN))
+    {
+        ioop->result = result;
+        return ;
+    }
+
+    // done
+    switch (ioop->code)
+    {
+    case TB_POLLER_IOCODE_RECV:
+    case TB_POLLER_IOCODE_SEND:
+        ioop->result = result;
+        break;
+    case TB_POLLER_IOCODE_ACPT:
+        {
+            // save the client socket, it has been non-block mode
+            ioop->client = tb_fd2sock(result);
+            ioop->result = 1;
+
+            // disable the nagle's algorithm like tb_socket_accept()
+            tb_socket_ctrl(ioop->client, TB_SOCKET_CTRL_SET_TCP_NODELAY, tb_true);
+
+            // save the client address
+            tb_sockaddr_save(&ioop->addr, (struct sockaddr_storage*)ioop->saddr);
+        }
+        break;
+    case TB_POLLER_IOCODE_CONN:
+        ioop->result = 1;
+        break;
+    default:
+        tb_assert(0);
+        ioop->result = -1;
+        break;
+    }
+}
+static tb_long_t tb_poller_iouring_wait_done(tb_poller_iouring_ref_t poller, tb_poller_event_func_t func, tb_poller_event_ref_t list, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(poller && poller->fd >= 0 && (func || (list && maxn)), -1);
+
+    /* poll the triggered sockets again, their events have been handled now
+     *
+     * we do not poll them immediately after harvesting events, 
+     * otherwise they may be triggered again before reading the pending data in the coroutines, 
+     * and these stale events will be cached and wake up the coroutines later.
+     */
+    tb_poller_iouring_poll_again(poller);
+
+    // no completions now? submit all pending requests and wait completions
+    tb_uint32_t head = *poller->cq_head;
+    tb_uint32_t tail = *poller->cq_tail;
+    if (head == tail || poller->sq_local != *poller->sq_head)
+    {
+        // init the wait arguments
+        tb_long_t       ok = 0;
+        tb_uint32_t     flags = IORING_ENTER_GETEVENTS;
+        tb_uint32_t     min_complete = (head == tail && timeout)? 1 : 0;
+        if (min_complete && timeout > 0)
+        {
+            poller->timeout.tv_sec  = timeout / 1000;
+            poller->timeout.tv_nsec = (timeout % 1000) * 1000000;
+        }
+
+#if defined(IORING_ENTER_EXT_ARG) && defined(IORING_FEAT_EXT_ARG)
+        // wait completions with timeout
+        if (min_complete && timeout > 0 && (poller->features & IORING_FEAT_EXT_ARG))
+        {
+            struct io_uring_getevents_arg arg;
+            tb_memset(&arg, 0, sizeof(arg));
+            arg.ts = (tb_uint64_t)(tb_size_t)&poller->timeout;
+            ok = tb_poller_iouring_enter(poller, min_complete, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+        }
+        else
+#endif
+        {
+            // post a timeout request, it will be completed after the timeout or any other completion
+            if (min_complete && timeout > 0)
+            {
+                struct io_uring_sqe* sqe = tb_poller_iouring_sqe(poller);
+                tb_assert_and_check_return_val(sqe, -1);
+
+                sqe->opcode     = IORING_OP_TIMEOUT;
+                sqe->fd         = -1;
+                sqe->addr       = (tb_uint64_t)(tb_size_t)&poller->timeout;
+                sqe->len        = 1;
+                sqe->off        = 1;
+                sqe->user_data  = 0;
+                tb_poller_iouring_push(poller);
+            }
+
+            // wait completions
+            ok = tb_poller_iouring_enter(poller, min_complete, flags, tb_null, 0);
+        }
+
+        // failed?
+        if (ok < 0)
+        {
+            // interrupted?(for gdb?) continue it
+            if (errno == EINTR) return 0;
+
+            // failed
+            if (errno != ETIME && errno != EBUSY && errno != EAGAIN)
+            {
+                // trace
+                tb_trace_e("wait failed, errno: %d", errno);
+                return -1;
+            }
+        }
+    }
+
+    // handle completions
+    tb_size_t       wait = 0;
+    tb_bool_t       killed = tb_false;
+    tb_socket_ref_t pair = poller->pair[1];
+    tail = *poller->cq_tail;
+    tb_barrier();
+    for (head = *poller->cq_head; head != tail && !killed && (func || wait < maxn); head++)
+    {
+        // get the completion
+        struct io_uring_cqe*    cqe = poller->cqes + (head & poller->cq_mask);
+        tb_uint64_t             data = cqe->user_data;
+        tb_int_t                result = cqe->res;
+
+        // the internal request? ignore it
+        tb_check_continue(data);
+
+        // the io operation has been completed?
+        if (!(data & 0x1))
+        {
+            // done io operation
+            tb_poller_ioop_ref_t ioop = (tb_poller_ioop_ref_t)(tb_size_t)data;
+            tb_poller_iouring_ioop_done(poller, ioop, result);
+
+            // call event function
+            if (func) func((tb_poller_ref_t)poller, ioop->sock, TB_POLLER_EVENT_COMP, ioop);
+            // save this event to the list
+            else
+            {
+                tb_poller_event_ref_t event = list + wait;
+                event->sock     = ioop->sock;
+                event->events   = TB_POLLER_EVENT_COMP;
+                event->priv     = ioop;
+            }
+
+            // update the events count
+            wait++;
+            continue;
+        }
+
+        // get the polled socket
+        tb_long_t                   fd = tb_poller_iouring_poll_fd(data);
+        tb_poller_iouring_sock_t*   item = tb_poller_iouring_sock(poller, fd, tb_false);
+
+        // it has been modified or removed? ignore the stale completion
+        tb_check_continue(item && item->inserted && item->gen == tb_poller_iouring_poll_gen(data));
+
+        // need poll it again after handling events for the level trigger?
+        tb_bool_t again = result >= 0 && !(item->events & TB_POLLER_EVENT_ONESHOT);
+
+        // spak?
+        tb_socket_ref_t sock = tb_fd2sock(fd);
+        if (sock == pair)
+        {
+            // read spak
+            tb_char_t spak = '\0';
+            if (1 != tb_socket_recv(pair, (tb_byte_t*)&spak, 1)) killed = tb_true;
+
+            // killed?
+            if (spak == 'k') killed = tb_true;
+        }
+        else
+        {
+            // init events, the socket may be failed if the result < 0
+            tb_size_t events = TB_POLLER_EVENT_NONE;
+            if (result >= 0)
+            {
+                if (result & POLLIN) events |= TB_POLLER_EVENT_RECV;
+                if (result & POLLOUT) events |= TB_POLLER_EVENT_SEND;
+                if ((result & (POLLHUP | POLLERR)) && !(events & (TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND)))
+                    events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
+            }
+            else events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
+
+            // call event function
+            if (func) func((tb_poller_ref_t)poller, sock, events, item->priv);
+            // save this event to the list
+            else
+            {
+                tb_poller_event_ref_t event = list + wait;
+                event->sock     = sock;
+                event->events   = events;
+                event->priv     = item->priv;
+            }
+
+            // update the events count
+            wait++;
+        }
+
+        // poll it again before waiting next time
+        if (again) tb_poller_iouring_poll_later(poller, data);
+    }
+
+    // consume these completions
+    tb_barrier();
+    *poller->cq_head = head;
+
+    // ok?
+    return killed? -1 : wait;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_poller_ref_t tb_poller_init(tb_cpointer_t priv)
+{
+    // done
+    tb_bool_t               ok = tb_false;
+    tb_poller_iouring_ref_t poller = tb_null;
+    do
+    {
+        // make poller
+        poller = tb_malloc0_type(tb_poller_iouring_t);
+        tb_assert_and_check_break(poller);
+
+        // init user private data
+        poller->priv = priv;
+        poller->fd   = -1;
+
+        // init io_uring, uses epoll instead of it if it is not supported
+        if (!tb_poller_iouring_init_ring(poller))
+        {
+            // exit io_uring
+            tb_poller_iouring_exit_ring(poller);
+
+            // init epoll
+            poller->epoll = tb_poller_epoll_init(poller);
+            tb_assert_and_check_break(poller->epoll);
+
+            // ok
+            ok = tb_true;
+            break;
+        }
+
+        // init maxn
+        poller->maxn = tb_poller_maxfds();
+        tb_assert_and_check_break(poller->maxn);
+
+        // init pair sockets
+        if (!tb_socket_pair(TB_SOCKET_TYPE_TCP, poller->pair)) break;
+
+        // insert pair socket first
+        if (!tb_poller_insert((tb_poller_ref_t)poller, poller->pair[1], TB_POLLER_EVENT_RECV, tb_null)) break;
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (poller) tb_poller_exit((tb_poller_ref_t)poller);
+        poller = tb_null;
+    }
+
+    // ok?
+    return (tb_poller_ref_t)poller;
+}
+tb_void_t tb_poller_exit(tb_poller_ref_t self)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return(poller);
+
+    // exit epoll
+    if (poller->epoll) tb_poller_epoll_exit(poller->epoll);
+    poller->epoll = tb_null;
+
+    // exit io_uring, all pending requests will be canceled
+    tb_poller_iouring_exit_ring(poller);
+
+    // exit pair sockets
+    if (poller->pair[0]) tb_socket_exit(poller->pair[0]);
+    if (poller->pair[1]) tb_socket_exit(poller->pair[1]);
+    poller->pair[0] = tb_null;
+    poller->pair[1] = tb_null;
+
+    // exit polls
+    if (poller->polls) tb_free(poller->polls);
+    poller->polls       = tb_null;
+    poller->polls_count = 0;
+    poller->polls_maxn  = 0;
+
+    // exit sockets
+    if (poller->socks) tb_free(poller->socks);
+    poller->socks       = tb_null;
+    poller->socks_size  = 0;
+
+    // free it
+    tb_free(poller);
+}
+tb_void_t tb_poller_clear(tb_poller_ref_t self)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return(poller);
+
+    // clear epoll
+    if (poller->epoll)
+    {
+        tb_poller_epoll_clear(poller->epoll);
+        return ;
+    }
+
+    // remove all sockets
+    tb_size_t i = 0;
+    tb_socket_ref_t pair = poller->pair[1];
+    for (i = 0; i < poller->socks_size; i++)
+    {
+        if (poller->socks[i].inserted && tb_fd2sock(i) != pair)
+            tb_poller_remove(self, tb_fd2sock(i));
+    }
+}
+tb_cpointer_t tb_poller_priv(tb_poller_ref_t self)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller, tb_null);
+
+    // get the user private data
+    return poller->priv;
+}
+tb_void_t tb_poller_kill(tb_poller_ref_t self)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return(poller);
+
+    // kill epoll
+    if (poller->epoll) tb_poller_epoll_kill(poller->epoll);
+
+    // kill it
+    else if (poller->pair[0]) tb_socket_send(poller->pair[0], (tb_byte_t const*)"k", 1);
+}
+tb_void_t tb_poller_spak(tb_poller_ref_t self)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return(poller);
+
+    // spak epoll
+    if (poller->epoll) tb_poller_epoll_spak(poller->epoll);
+
+    // post it
+    else if (poller->pair[0]) tb_socket_send(poller->pair[0], (tb_byte_t const*)"p", 1);
+}
+tb_bool_t tb_poller_support(tb_poller_ref_t self, tb_size_t events)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller, tb_false);
+
+    // is supported by epoll?
+    if (poller->epoll) return tb_poller_epoll_support(poller->epoll, events);
+
+    // all supported events
+    tb_size_t events_supported = TB_POLLER_EVENT_EALL | TB_POLLER_EVENT_ONESHOT;
+    if (poller->ioop) events_supported |= TB_POLLER_EVENT_COMP;
+
+    // is supported?
+    return (events_supported & events) == events;
+}
+tb_bool_t tb_poller_insert(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t events, tb_cpointer_t priv)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller && sock, tb_false);
+
+    // insert it to epoll
+    if (poller->epoll) return tb_poller_epoll_insert(poller->epoll, sock, events, priv);
+
+    // the edge trigger is not supported now
+    tb_assertf(!(events & TB_POLLER_EVENT_CLEAR), "cannot insert events with clear, not supported!");
+
+    // get socket
+    tb_long_t                   fd = tb_sock2fd(sock);
+    tb_poller_iouring_sock_t*   item = tb_poller_iouring_sock(poller, fd, tb_true);
+    tb_assert_and_check_return_val(item, tb_false);
+
+    // exists?
+    if (item->inserted)
+    {
+        // trace
+        tb_trace_e("insert socket(%p) events: %lu failed, it has been inserted!", sock, events);
+        return tb_false;
+    }
+
+    // bind events and user private data to socket
+    item->priv      = priv;
+    item->events    = (tb_uint16_t)events;
+    item->inserted  = 1;
+    item->gen++;
+
+    // poll it
+    return tb_poller_iouring_poll(poller, fd, item);
+}
+tb_bool_t tb_poller_remove(tb_poller_ref_t self, tb_socket_ref_t sock)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller && sock, tb_false);
+
+    // remove it from epoll
+    if (poller->epoll) return tb_poller_epoll_remove(poller->epoll, sock);
+
+    // get socket
+    tb_long_t                   fd = tb_sock2fd(sock);
+    tb_poller_iouring_sock_t*   item = tb_poller_iouring_sock(poller, fd, tb_false);
+    if (!item || !item->inserted)
+    {
+        // trace
+        tb_trace_e("remove socket(%p) failed, it has been not inserted!", sock);
+        return tb_false;
+    }
+
+    // remove the poll request
+    if (!tb_poller_iouring_poll_remove(poller, fd, item)) return tb_false;
+
+    // remove the user private data from this socket
+    item->priv      = tb_null;
+    item->events    = 0;
+    item->inserted  = 0;
+    item->gen++;
+
+    /* it will be submitted with the other pending requests when waiting next time
+     *
+     * the poll request holds a reference of this socket file, so the socket will be not closed 
+     * until the poll request has been removed, but the stale completion will be ignored by the generation,
+     * and the new socket with the same fd can be inserted before submitting it.
+     */
+    return tb_true;
+}
+tb_bool_t tb_poller_modify(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t events, tb_cpointer_t priv)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller && sock, tb_false);
+
+    // modify it for epoll
+    if (poller->epoll) return tb_poller_epoll_modify(poller->epoll, sock, events, priv);
+
+    // the edge trigger is not supported now
+    tb_assertf(!(events & TB_POLLER_EVENT_CLEAR), "cannot modify events with clear, not supported!");
+
+    // get socket
+    tb_long_t                   fd = tb_sock2fd(sock);
+    tb_poller_iouring_sock_t*   item = tb_poller_iouring_sock(poller, fd, tb_false);
+    if (!item || !item->inserted)
+    {
+        // trace
+        tb_trace_e("modify socket(%p) events: %lu failed, it has been not inserted!", sock, events);
+        return tb_false;
+    }
+
+    // remove the previous poll request
+    if (!tb_poller_iouring_poll_remove(poller, fd, item)) return tb_false;
+
+    // modify events and user private data
+    item->priv      = priv;
+    item->events    = (tb_uint16_t)events;
+    item->gen++;
+
+    // poll it again
+    return tb_poller_iouring_poll(poller, fd, item);
+}
+tb_long_t tb_poller_wait(tb_poller_ref_t self, tb_poller_event_func_t func, tb_long_t timeout)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller && func, -1);
+
+    // wait epoll
+    if (poller->epoll)
+    {
+        poller->func = func;
+        return tb_poller_epoll_wait(poller->epoll, tb_poller_iouring_events, timeout);
+    }
+
+    // wait completions and call the events function
+    return tb_poller_iouring_wait_done(poller, func, tb_null, 0, timeout);
+}
+tb_long_t tb_poller_wait_events(tb_poller_ref_t self, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller && events && maxn, -1);
+
+    // wait epoll, the events list is same for the fallback epoll poller
+    if (poller->epoll) return tb_poller_epoll_wait_events(poller->epoll, events, maxn, timeout);
+
+    // wait completions and save them to the given list
+    return tb_poller_iouring_wait_done(poller, tb_null, events, maxn, timeout);
+}
+tb_bool_t tb_poller_post(tb_poller_ref_t self, tb_poller_ioop_ref_t ioop)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller && ioop && ioop->sock, tb_false);
+
+    // not supported?
+    tb_check_return_val(!poller->epoll && poller->ioop, tb_false);
+
+    // the io operation must be aligned for the user data
+    tb_assert_and_check_return_val(!((tb_size_t)ioop & 0x1), tb_false);
+
+    // get a submission entry
+    struct io_uring_sqe* sqe = tb_poller_iouring_sqe(poller);
+    tb_assert_and_check_return_val(sqe, tb_false);
+
+    // init the io operation
+    ioop->client    = tb_null;
+    ioop->result    = 0;
+    sqe->fd         = (tb_int_t)tb_sock2fd(ioop->sock);
+    sqe->user_data  = (tb_uint64_t)(tb_size_t)ioop;
+
+    // done
+    switch (ioop->code)
+    {
+    case TB_POLLER_IOCODE_RECV:
+        sqe->opcode     = IORING_OP_RECV;
+        sqe->addr       = (tb_uint64_t)(tb_size_t)ioop->data;
+        sqe->len        = (tb_uint32_t)ioop->size;
+        break;
+    case TB_POLLER_IOCODE_SEND:
+        sqe->opcode     = IORING_OP_SEND;
+        sqe->addr       = (tb_uint64_t)(tb_size_t)ioop->data;
+        sqe->len        = (tb_uint32_t)ioop->size;
+        sqe->msg_flags  = MSG_NOSIGNAL;
+        break;
+    case TB_POLLER_IOCODE_ACPT:
+        ioop->saddr_size = sizeof(ioop->saddr);
+        sqe->opcode         = IORING_OP_ACCEPT;
+        sqe->addr           = (tb_uint64_t)(tb_size_t)ioop->saddr;
+        sqe->addr2          = (tb_uint64_t)(tb_size_t)&ioop->saddr_size;
+        sqe->accept_flags   = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        break;
+    case TB_POLLER_IOCODE_CONN:
+        ioop->saddr_size = (tb_uint32_t)tb_sockaddr_load((struct sockaddr_storage*)ioop->saddr, &ioop->addr);
+        tb_assert_and_check_return_val(ioop->saddr_size, tb_false);
+        sqe->opcode     = IORING_OP_CONNECT;
+        sqe->addr       = (tb_uint64_t)(tb_size_t)ioop->saddr;
+        sqe->off        = ioop->saddr_size;
+        break;
+    default:
+        tb_trace_e("unknown io operation: %lu", ioop->code);
+        return tb_false;
+    }
+
+    // push it
+    tb_poller_iouring_push(poller);
+
+    // ok
+    return tb_true;
+}
+tb_bool_t tb_poller_cancel(tb_poller_ref_t self, tb_poller_ioop_ref_t ioop)
+{
+    // check
+    tb_poller_iouring_ref_t poller = (tb_poller_iouring_ref_t)self;
+    tb_assert_and_check_return_val(poller && ioop, tb_false);
+
+    // not supported?
+    tb_check_return_val(!poller->epoll && poller->ioop, tb_false);
+
+    // get a submission entry
+    struct io_uring_sqe* sqe = tb_poller_iouring_sqe(poller);
+    tb_assert_and_check_return_val(sqe, tb_false);
+
+    // cancel it, the io operation will be completed with -ECANCELED
+    sqe->opcode     = IORING_OP_ASYNC_CANCEL;
+    sqe->fd         = -1;
+    sqe->addr       = (tb_uint64_t)(tb_size_t)ioop;
+    sqe->user_data  = 0;
+
+    // push it
+    tb_poller_iouring_push(poller);
+
+    // ok
+    return tb_true;
+}
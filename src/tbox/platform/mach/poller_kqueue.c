@@ -186,7 +186,112 @@ static __tb_inline__ tb_void_t tb_poller_hash_del(tb_poller_kqueue_ref_t poller,
     // remove the user private data
     if (fd < poller->hash_size) poller->hash[fd] = 0;
 }
+static tb_long_t tb_poller_wait_done(tb_poller_kqueue_ref_t poller, tb_poller_event_func_t func, tb_poller_event_ref_t list, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(poller && poller->kqfd > 0 && poller->maxn && (func || (list && maxn)), -1);
+
+    // init time
+    struct timespec t = {0};
+    if (timeout > 0)
+    {
+        t.tv_sec = timeout / 1000;
+        t.tv_nsec = (timeout % 1000) * 1000000;
+    }
+
+    // init events
+    tb_size_t grow = tb_align8((poller->maxn >> 3) + 1);
+    if (!poller->events)
+    {
+        poller->events_count = grow;
+        poller->events = tb_nalloc_type(poller->events_count, struct kevent);
+        tb_assert_and_check_return_val(poller->events, -1);
+    }
+
+    // wait events, we only harvest the events which can be stored to the given list
+    tb_long_t events_maxn = func? poller->events_count : tb_min(poller->events_count, maxn);
+    tb_long_t events_count = kevent(poller->kqfd, tb_null, 0, poller->events, events_maxn, timeout >= 0? &t : tb_null);
+    tb_assert_and_check_return_val(events_count >= 0 && events_count <= events_maxn, -1);
+    
+    // timeout?
+    tb_check_return_val(events_count, 0);
+
+    // grow it if events is full
+    if (events_count == poller->events_count)
+    {
+        // grow size
+        poller->events_count += grow;
+        if (poller->events_count > poller->maxn) poller->events_count = poller->maxn;
+
+        // grow data
+        poller->events = (struct kevent*)tb_ralloc(poller->events, poller->events_count * sizeof(struct kevent));
+        tb_assert_and_check_return_val(poller->events, -1);
+    }
+    tb_assert(events_count <= poller->events_count);
+
+    // limit 
+    events_count = tb_min(events_count, poller->maxn);
+
+    // handle events 
+    tb_size_t       i = 0;
+    tb_size_t       wait = 0;
+    struct kevent*  e = tb_null;
+    tb_socket_ref_t pair = poller->pair[1];
+    for (i = 0; i < events_count; i++)
+    {
+        // the kevents 
+        e = poller->events + i;
+
+        // the socket
+        tb_socket_ref_t sock = tb_fd2sock(e->ident);
+        tb_assert(sock);
+
+        // spak?
+        if (sock == pair && e->filter == EVFILT_READ) 
+        {
+            // read spak
+            tb_char_t spak = '\0';
+            if (1 != tb_socket_recv(pair, (tb_byte_t*)&spak, 1)) return -1;
+
+            // killed?
+            if (spak == 'k') return -1;
+
+            // continue it
+            continue ;
+        }
+
+        // skip spak
+        tb_check_continue(sock != pair);
+
+        // init events 
+        tb_size_t events = TB_POLLER_EVENT_NONE;
+        if (e->filter == EVFILT_READ) events |= TB_POLLER_EVENT_RECV;
+        if (e->filter == EVFILT_WRITE) events |= TB_POLLER_EVENT_SEND;
+        if ((e->flags & EV_ERROR) && !(events & (TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND))) 
+            events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
+
+        // connection closed for the edge trigger?
+        if (e->flags & EV_EOF) 
+            events |= TB_POLLER_EVENT_EOF;
 
+        // call event function
+        if (func) func((tb_poller_ref_t)poller, sock, events, e->udata);
+        // save this event to the list
+        else
+        {
+            tb_poller_event_ref_t event = list + wait;
+            event->sock     = sock;
+            event->events   = events;
+            event->priv     = e->udata;
+        }
+
+        // update the events count
+        wait++;
+    }
+
+    // ok
+    return wait;
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -436,99 +541,16 @@ tb_bool_t tb_poller_modify(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t
 tb_long_t tb_poller_wait(tb_poller_ref_t self, tb_poller_event_func_t func, tb_long_t timeout)
 {
     // check
-    tb_poller_kqueue_ref_t poller = (tb_poller_kqueue_ref_t)self;
-    tb_assert_and_check_return_val(poller && poller->kqfd > 0 && poller->maxn && func, -1);
-
-    // init time
-    struct timespec t = {0};
-    if (timeout > 0)
-    {
-        t.tv_sec = timeout / 1000;
-        t.tv_nsec = (timeout % 1000) * 1000000;
-    }
-
-    // init events
-    tb_size_t grow = tb_align8((poller->maxn >> 3) + 1);
-    if (!poller->events)
-    {
-        poller->events_count = grow;
-        poller->events = tb_nalloc_type(poller->events_count, struct kevent);
-        tb_assert_and_check_return_val(poller->events, -1);
-    }
-
-    // wait events
-    tb_long_t events_count = kevent(poller->kqfd, tb_null, 0, poller->events, poller->events_count, timeout >= 0? &t : tb_null);
-    tb_assert_and_check_return_val(events_count >= 0 && events_count <= poller->events_count, -1);
-    
-    // timeout?
-    tb_check_return_val(events_count, 0);
-
-    // grow it if events is full
-    if (events_count == poller->events_count)
-    {
-        // grow size
-        poller->events_count += grow;
-        if (poller->events_count > poller->maxn) poller->events_count = poller->maxn;
-
-        // grow data
-        poller->events = (struct kevent*)tb_ralloc(poller->events, poller->events_count * sizeof(struct kevent));
-        tb_assert_and_check_return_val(poller->events, -1);
-    }
-    tb_assert(events_count <= poller->events_count);
+    tb_assert_and_check_return_val(self && func, -1);
 
-    // limit 
-    events_count = tb_min(events_count, poller->maxn);
-
-    // handle events 
-    tb_size_t       i = 0;
-    tb_size_t       wait = 0;
-    struct kevent*  e = tb_null;
-    tb_socket_ref_t pair = poller->pair[1];
-    for (i = 0; i < events_count; i++)
-    {
-        // the kevents 
-        e = poller->events + i;
-
-        // the socket
-        tb_socket_ref_t sock = tb_fd2sock(e->ident);
-        tb_assert(sock);
-
-        // spak?
-        if (sock == pair && e->filter == EVFILT_READ) 
-        {
-            // read spak
-            tb_char_t spak = '\0';
-            if (1 != tb_socket_recv(pair, (tb_byte_t*)&spak, 1)) return -1;
-
-            // killed?
-            if (spak == 'k') return -1;
-
-            // continue it
-            continue ;
-        }
-
-        // skip spak
-        tb_check_continue(sock != pair);
-
-        // init events 
-        tb_size_t events = TB_POLLER_EVENT_NONE;
-        if (e->filter == EVFILT_READ) events |= TB_POLLER_EVENT_RECV;
-        if (e->filter == EVFILT_WRITE) events |= TB_POLLER_EVENT_SEND;
-        if ((e->flags & EV_ERROR) && !(events & (TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND))) 
-            events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
-
-        // connection closed for the edge trigger?
-        if (e->flags & EV_EOF) 
-            events |= TB_POLLER_EVENT_EOF;
-
-        // call event function
-        func(self, sock, events, e->udata);
-
-        // update the events count
-        wait++;
-    }
-
-    // ok
-    return wait;
+    // wait events and call the events function
+    return tb_poller_wait_done((tb_poller_kqueue_ref_t)self, func, tb_null, 0, timeout);
 }
+tb_long_t tb_poller_wait_events(tb_poller_ref_t self, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(self && events && maxn, -1);
 
+    // wait events and save them to the given list
+    return tb_poller_wait_done((tb_poller_kqueue_ref_t)self, tb_null, events, maxn, timeout);
+}
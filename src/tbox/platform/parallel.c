@@ -0,0 +1,376 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        parallel.c
+ * @ingroup     platform
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME                "parallel"
+#define TB_TRACE_MODULE_DEBUG               (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "parallel.h"
+#include "atomic.h"
+#include "spinlock.h"
+#include "semaphore.h"
+#include "processor.h"
+#include "../libc/libc.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the participants maxn
+#ifdef __tb_small__
+#   define TB_PARALLEL_PARTICIPANTS_MAXN    (32)
+#else
+#   define TB_PARALLEL_PARTICIPANTS_MAXN    (64)
+#endif
+
+// the automatic chunk count for each participant if the grain is zero
+#define TB_PARALLEL_GRAIN_CHUNKS            (64)
+
+// the stack size of the partial result
+#define TB_PARALLEL_RESULT_STACK            (64)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the parallel context type
+typedef struct __tb_parallel_t
+{
+    // the reference count, the caller and all posted helpers
+    tb_atomic_t                 refn;
+
+    // the next start index of the range
+    tb_atomic_t                 next;
+
+    // the left items count which have been not finished
+    tb_atomic_t                 left;
+
+    // the end index of the range
+    tb_size_t                   end;
+
+    // the minimum chunk size
+    tb_size_t                   grain;
+
+    // the participants count
+    tb_size_t                   participants;
+
+    // the semaphore for notifying the caller if all items have been finished
+    tb_semaphore_ref_t          semaphore;
+
+    // the for func
+    tb_parallel_for_func_t      func;
+
+    // the reduce func
+    tb_parallel_reduce_func_t   reduce;
+
+    // the join func
+    tb_parallel_join_func_t     join;
+
+    // the result
+    tb_pointer_t                result;
+
+    // the result size
+    tb_size_t                   size;
+
+    // the identity value of the result
+    tb_byte_t*                  identity;
+
+    // the lock for joining the result
+    tb_spinlock_t               lock;
+
+    // the user private data
+    tb_cpointer_t               priv;
+
+}tb_parallel_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_void_t tb_parallel_exit(tb_parallel_t* parallel)
+{
+    // check
+    tb_assert_and_check_return(parallel);
+
+    // exit semaphore
+    if (parallel->semaphore) tb_semaphore_exit(parallel->semaphore);
+    parallel->semaphore = tb_null;
+
+    // exit lock
+    tb_spinlock_exit(&parallel->lock);
+
+    // exit it, the identity value is allocated with the context
+    tb_free(parallel);
+}
+static tb_void_t tb_parallel_release(tb_parallel_t* parallel)
+{
+    // the last reference? exit it
+    if (tb_atomic_fetch_and_dec(&parallel->refn) == 1) tb_parallel_exit(parallel);
+}
+static tb_bool_t tb_parallel_grab(tb_parallel_t* parallel, tb_size_t* pstart, tb_size_t* pend)
+{
+    // grab the next chunk
+    tb_size_t next = (tb_size_t)tb_atomic_get(&parallel->next);
+    while (next < parallel->end)
+    {
+        /* the guided chunk size
+         *
+         * the chunk is large at first and becomes smaller for the remaining items,
+         * but it will be not less than the grain
+         */
+        tb_size_t left  = parallel->end - next;
+        tb_size_t chunk = left / (parallel->participants << 1);
+        if (chunk < parallel->grain) chunk = parallel->grain;
+        if (chunk > left) chunk = left;
+
+        // claim it
+        tb_size_t prev = (tb_size_t)tb_atomic_fetch_and_pset(&parallel->next, (tb_long_t)next, (tb_long_t)(next + chunk));
+        if (prev == next)
+        {
+            *pstart = next;
+            *pend   = next + chunk;
+            return tb_true;
+        }
+
+        // the other participant has claimed it, try again
+        next = prev;
+    }
+
+    // no more chunks
+    return tb_false;
+}
+static tb_size_t tb_parallel_run(tb_parallel_t* parallel)
+{
+    // check
+    tb_assert_and_check_return_val(parallel, 0);
+
+    // the partial result for reduce
+    tb_byte_t   stack[TB_PARALLEL_RESULT_STACK];
+    tb_byte_t*  partial = tb_null;
+
+    // run all chunks which can be grabbed
+    tb_size_t   start = 0;
+    tb_size_t   end = 0;
+    tb_size_t   count = 0;
+    while (tb_parallel_grab(parallel, &start, &end))
+    {
+        // reduce it?
+        if (parallel->reduce)
+        {
+            // init the partial result by the identity value
+            if (!partial)
+            {
+                partial = parallel->size <= sizeof(stack)? stack : (tb_byte_t*)tb_malloc(parallel->size);
+                tb_assert_and_check_break(partial);
+
+                tb_memcpy(partial, parallel->identity, parallel->size);
+            }
+
+            // reduce this chunk
+            parallel->reduce(start, end, partial, parallel->priv);
+        }
+        // done it
+        else parallel->func(start, end, parallel->priv);
+
+        // update count
+        count += end - start;
+    }
+
+    // join the partial result
+    if (partial)
+    {
+        tb_spinlock_enter(&parallel->lock);
+        parallel->join(parallel->result, partial, parallel->priv);
+        tb_spinlock_leave(&parallel->lock);
+
+        // exit the partial result
+        if (partial != stack) tb_free(partial);
+    }
+
+    // the finished items count
+    return count;
+}
+static tb_void_t tb_parallel_helper_done(tb_thread_pool_worker_ref_t worker, tb_cpointer_t priv)
+{
+    // check
+    tb_parallel_t* parallel = (tb_parallel_t*)priv;
+    tb_assert_and_check_return(parallel);
+
+    // run chunks
+    tb_size_t count = tb_parallel_run(parallel);
+
+    // all items have been finished? notify the caller
+    if (count && tb_atomic_fetch_and_sub(&parallel->left, count) == (tb_long_t)count) 
+        tb_semaphore_post(parallel->semaphore, 1);
+}
+static tb_void_t tb_parallel_helper_exit(tb_thread_pool_worker_ref_t worker, tb_cpointer_t priv)
+{
+    // check
+    tb_parallel_t* parallel = (tb_parallel_t*)priv;
+    tb_assert_and_check_return(parallel);
+
+    // release it, the helper may be killed and not run, but the caller will run the left chunks
+    tb_parallel_release(parallel);
+}
+static tb_bool_t tb_parallel_done(tb_thread_pool_ref_t pool, tb_size_t start, tb_size_t end, tb_size_t grain, tb_parallel_for_func_t func, tb_pointer_t result, tb_size_t size, tb_parallel_reduce_func_t reduce, tb_parallel_join_func_t join, tb_cpointer_t priv)
+{
+    // check
+    tb_assert_and_check_return_val(start <= end && (func || (reduce && join && result && size)), tb_false);
+
+    // empty?
+    tb_size_t count = end - start;
+    tb_check_return_val(count, tb_true);
+
+    // the participants count
+    if (!pool) pool = tb_thread_pool();
+    tb_size_t participants = tb_processor_count();
+    if (pool)
+    {
+        tb_size_t worker_size = tb_thread_pool_worker_size(pool);
+        if (participants < worker_size) participants = worker_size;
+    }
+    else participants = 1;
+    if (participants > TB_PARALLEL_PARTICIPANTS_MAXN) participants = TB_PARALLEL_PARTICIPANTS_MAXN;
+    if (!participants) participants = 1;
+
+    // adapt the grain automatically
+    if (!grain) grain = tb_max(count / (participants * TB_PARALLEL_GRAIN_CHUNKS), 1);
+
+    // the helpers count, we need not post helpers more than the chunks
+    tb_size_t helpers = tb_min(participants, (count + grain - 1) / grain) - 1;
+
+    // only one participant? run it directly
+    if (!helpers)
+    {
+        if (reduce) reduce(start, end, result, priv);
+        else func(start, end, priv);
+        return tb_true;
+    }
+
+    // done
+    tb_bool_t       ok = tb_false;
+    tb_parallel_t*  parallel = tb_null;
+    do
+    {
+        // make the context and the identity value
+        parallel = (tb_parallel_t*)tb_malloc0(sizeof(tb_parallel_t) + (reduce? size : 0));
+        tb_assert_and_check_break(parallel);
+
+        // init it
+        parallel->refn          = 1;
+        parallel->next          = (tb_long_t)start;
+        parallel->left          = (tb_long_t)count;
+        parallel->end           = end;
+        parallel->grain         = grain;
+        parallel->participants  = participants;
+        parallel->func          = func;
+        parallel->reduce        = reduce;
+        parallel->join          = join;
+        parallel->result        = result;
+        parallel->size          = size;
+        parallel->priv          = priv;
+        tb_spinlock_init(&parallel->lock);
+        if (reduce)
+        {
+            parallel->identity = (tb_byte_t*)&parallel[1];
+            tb_memcpy(parallel->identity, result, size);
+        }
+
+        // init semaphore
+        parallel->semaphore = tb_semaphore_init(0);
+        tb_assert_and_check_break(parallel->semaphore);
+
+        // init helpers
+        tb_size_t               i = 0;
+        tb_thread_pool_task_t   tasks[TB_PARALLEL_PARTICIPANTS_MAXN];
+        for (i = 0; i < helpers; i++)
+        {
+            tasks[i].name   = "parallel";
+            tasks[i].done   = tb_parallel_helper_done;
+            tasks[i].exit   = tb_parallel_helper_exit;
+            tasks[i].priv   = parallel;
+            tasks[i].urgent = tb_false;
+        }
+
+        // post helpers, each helper holds one reference
+        parallel->refn += helpers;
+        tb_size_t posted = tb_thread_pool_task_post_list(pool, tasks, helpers);
+
+        // release the references of the helpers which have been not posted
+        if (posted < helpers) tb_atomic_fetch_and_sub(&parallel->refn, helpers - posted);
+
+        // run chunks at the current thread
+        count = tb_parallel_run(parallel);
+
+        // wait the running chunks on the other workers if all items have been not finished
+        if (tb_atomic_fetch_and_sub(&parallel->left, count) != (tb_long_t)count)
+        {
+            if (tb_semaphore_wait(parallel->semaphore, -1) <= 0) break;
+        }
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed before posting helpers? run it directly
+    if (!ok && (!parallel || !parallel->semaphore))
+    {
+        if (reduce) reduce(start, end, result, priv);
+        else func(start, end, priv);
+        ok = tb_true;
+    }
+
+    // release the context
+    if (parallel) tb_parallel_release(parallel);
+
+    // ok?
+    return ok;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_bool_t tb_parallel_for(tb_thread_pool_ref_t pool, tb_size_t start, tb_size_t end, tb_size_t grain, tb_parallel_for_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_assert_and_check_return_val(func, tb_false);
+
+    // done
+    return tb_parallel_done(pool, start, end, grain, func, tb_null, 0, tb_null, tb_null, priv);
+}
+tb_bool_t tb_parallel_reduce(tb_thread_pool_ref_t pool, tb_size_t start, tb_size_t end, tb_size_t grain, tb_pointer_t result, tb_size_t size, tb_parallel_reduce_func_t reduce, tb_parallel_join_func_t join, tb_cpointer_t priv)
+{
+    // check
+    tb_assert_and_check_return_val(result && size && reduce && join, tb_false);
+
+    // done
+    return tb_parallel_done(pool, start, end, grain, tb_null, result, size, reduce, join, priv);
+}
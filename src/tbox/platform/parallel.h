@@ -0,0 +1,142 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        parallel.h
+ * @ingroup     platform
+ *
+ */
+#ifndef TB_PLATFORM_PARALLEL_H
+#define TB_PLATFORM_PARALLEL_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "thread_pool.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/*! the parallel for func type
+ *
+ * @param start         the start index of this range
+ * @param end           the end index of this range, [start, end)
+ * @param priv          the user private data
+ */
+typedef tb_void_t       (*tb_parallel_for_func_t)(tb_size_t start, tb_size_t end, tb_cpointer_t priv);
+
+/*! the parallel reduce func type
+ *
+ * @param start         the start index of this range
+ * @param end           the end index of this range, [start, end)
+ * @param result        the partial result of this range, it has been inited by the initial value
+ * @param priv          the user private data
+ */
+typedef tb_void_t       (*tb_parallel_reduce_func_t)(tb_size_t start, tb_size_t end, tb_pointer_t result, tb_cpointer_t priv);
+
+/*! the parallel join func type
+ *
+ * @param result        the result 
+ * @param other         the other partial result which will be joined to the result
+ * @param priv          the user private data
+ */
+typedef tb_void_t       (*tb_parallel_join_func_t)(tb_pointer_t result, tb_cpointer_t other, tb_cpointer_t priv);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! run the func for the range [start, end) in parallel and wait it
+ *
+ * the range will be split to some chunks and run on the workers of the thread pool and the current thread,
+ * the chunk size is adapted automatically (guided scheduling), it is large at first and becomes smaller 
+ * for the remaining items, so the workers can be balanced without too many small chunks.
+ *
+ * the current thread will also run chunks and it will only wait the running chunks on the other workers, 
+ * so it can be called in the task of the thread pool.
+ *
+ * @code
+    static tb_void_t tb_demo_for(tb_size_t start, tb_size_t end, tb_cpointer_t priv)
+    {
+        tb_size_t i = 0;
+        for (i = start; i < end; i++) ((tb_size_t*)priv)[i] *= 2;
+    }
+
+    tb_parallel_for(tb_null, 0, tb_arrayn(data), 0, tb_demo_for, data);
+ * @endcode
+ *
+ * @param pool          the thread pool, using tb_thread_pool() if be null
+ * @param start         the start index
+ * @param end           the end index
+ * @param grain         the minimum chunk size, adapted automatically if be zero
+ * @param func          the func
+ * @param priv          the user private data
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_parallel_for(tb_thread_pool_ref_t pool, tb_size_t start, tb_size_t end, tb_size_t grain, tb_parallel_for_func_t func, tb_cpointer_t priv);
+
+/*! reduce the range [start, end) in parallel and wait it
+ *
+ * each participated thread reduces its chunks to a partial result which is inited by the identity value of the result,
+ * and then the partial result will be joined to the result.
+ *
+ * @code
+    static tb_void_t tb_demo_reduce(tb_size_t start, tb_size_t end, tb_pointer_t result, tb_cpointer_t priv)
+    {
+        tb_size_t i = 0;
+        for (i = start; i < end; i++) *((tb_hize_t*)result) += ((tb_size_t*)priv)[i];
+    }
+    static tb_void_t tb_demo_join(tb_pointer_t result, tb_cpointer_t other, tb_cpointer_t priv)
+    {
+        *((tb_hize_t*)result) += *((tb_hize_t const*)other);
+    }
+
+    tb_hize_t sum = 0;
+    tb_parallel_reduce(tb_null, 0, tb_arrayn(data), 0, &sum, sizeof(sum), tb_demo_reduce, tb_demo_join, data);
+ * @endcode
+ *
+ * @param pool          the thread pool, using tb_thread_pool() if be null
+ * @param start         the start index
+ * @param end           the end index
+ * @param grain         the minimum chunk size, adapted automatically if be zero
+ * @param result        the result, it need be inited by the identity value (e.g. zero for sum, one for product)
+ * @param size          the result size
+ * @param reduce        the reduce func
+ * @param join          the join func
+ * @param priv          the user private data
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_parallel_reduce(tb_thread_pool_ref_t pool, tb_size_t start, tb_size_t end, tb_size_t grain, tb_pointer_t result, tb_size_t size, tb_parallel_reduce_func_t reduce, tb_parallel_join_func_t join, tb_cpointer_t priv);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -39,6 +39,7 @@
 #include "timer.h"
 #include "print.h"
 #include "ltimer.h"
+#include "htimer.h"
 #include "socket.h"
 #include "thread.h"
 #include "atomic.h"
@@ -61,7 +62,10 @@
 #include "cache_time.h"
 #include "environment.h"
 #include "thread_pool.h"
+#include "parallel.h"
+#include "task_graph.h"
 #include "thread_local.h"
+#include "virtual_memory.h"
 #ifdef TB_CONFIG_API_HAVE_DEPRECATED
 #   include "deprecated/deprecated.h"
 #endif
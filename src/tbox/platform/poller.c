@@ -28,11 +28,29 @@
  */
 #include "poller.h"
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+/* use io_uring? it will fallback to epoll if it is not supported by the kernel
+ *
+ * it is disabled by default, please enable it by `xmake f --iouring=y`
+ */
+#if !defined(TB_CONFIG_OS_WINDOWS) \
+    && defined(TB_CONFIG_POLLER_IOURING_ENABLE) \
+    && defined(TB_CONFIG_LINUX_HAVE_IO_URING_SETUP) \
+    && defined(TB_CONFIG_POSIX_HAVE_EPOLL_CREATE) \
+    && defined(TB_CONFIG_POSIX_HAVE_EPOLL_WAIT)
+#   define TB_POLLER_HAVE_IOURING
+#endif
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
  */
 #if defined(TB_CONFIG_OS_WINDOWS)
 #   include "posix/poller_select.c"
+#elif defined(TB_POLLER_HAVE_IOURING)
+#   include "linux/poller_iouring.c"
 #elif defined(TB_CONFIG_POSIX_HAVE_EPOLL_CREATE) \
     && defined(TB_CONFIG_POSIX_HAVE_EPOLL_WAIT)
 #   include "linux/poller_epoll.c"
@@ -95,5 +113,21 @@ tb_long_t tb_poller_wait(tb_poller_ref_t poller, tb_poller_event_func_t func, tb
     tb_trace_noimpl();
     return 0;
 }
+tb_long_t tb_poller_wait_events(tb_poller_ref_t poller, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout)
+{
+    tb_trace_noimpl();
+    return 0;
+}
 #endif
 
+// the completion-style io operations are only supported by io_uring now
+#ifndef TB_POLLER_HAVE_IOURING
+tb_bool_t tb_poller_post(tb_poller_ref_t poller, tb_poller_ioop_ref_t ioop)
+{
+    return tb_false;
+}
+tb_bool_t tb_poller_cancel(tb_poller_ref_t poller, tb_poller_ioop_ref_t ioop)
+{
+    return tb_false;
+}
+#endif
@@ -61,11 +61,86 @@ typedef enum __tb_poller_event_e
      */
 ,   TB_POLLER_EVENT_EOF         = 0x0100
 
+    /*! the io operation posted by tb_poller_post() has been completed
+     *
+     * the priv argument of the events function will be the io operation (tb_poller_ioop_ref_t)
+     */
+,   TB_POLLER_EVENT_COMP        = 0x0200
+
 }tb_poller_event_e;
 
+/// the poller io operation code enum
+typedef enum __tb_poller_iocode_e
+{
+    TB_POLLER_IOCODE_NONE       = 0
+,   TB_POLLER_IOCODE_RECV       = 1 //!< recv data
+,   TB_POLLER_IOCODE_SEND       = 2 //!< send data
+,   TB_POLLER_IOCODE_ACPT       = 3 //!< accept a client socket
+,   TB_POLLER_IOCODE_CONN       = 4 //!< connect to the given address
+
+}tb_poller_iocode_e;
+
+/*! the poller io operation type for the completion-style io
+ *
+ * it will be submitted to the kernel directly and the completion is notified by tb_poller_wait(),
+ * so it and the data buffer must be kept valid until it has been completed.
+ */
+typedef struct __tb_poller_ioop_t
+{
+    /// the operation code
+    tb_size_t               code;
+
+    /// the socket
+    tb_socket_ref_t         sock;
+
+    /// the data for recv and send
+    tb_byte_t*              data;
+
+    /// the data size for recv and send
+    tb_size_t               size;
+
+    /// the peer address for conn, or the accepted client address for acpt
+    tb_ipaddr_t             addr;
+
+    /// the accepted client socket for acpt
+    tb_socket_ref_t         client;
+
+    /*! the result after completing it
+     *
+     * recv and send: the real size
+     * acpt and conn: 1
+     * failed:        < 0 
+     */
+    tb_long_t               result;
+
+    /// the user private data
+    tb_cpointer_t           priv;
+
+    /// the socket address storage (private)
+    tb_uint64_t             saddr[16];
+
+    /// the socket address size (private)
+    tb_uint32_t             saddr_size;
+
+}tb_poller_ioop_t, *tb_poller_ioop_ref_t;
+
 /// the poller ref type
 typedef __tb_typeref__(poller);
 
+/// the poller event type for tb_poller_wait_events()
+typedef struct __tb_poller_event_t
+{
+    /// the socket
+    tb_socket_ref_t         sock;
+
+    /// the poller events
+    tb_size_t               events;
+
+    /// the user private data for this socket, or the io operation for TB_POLLER_EVENT_COMP
+    tb_cpointer_t           priv;
+
+}tb_poller_event_t, *tb_poller_event_ref_t;
+
 /*! the poller event func type
  *
  * @param poller    the poller
@@ -169,6 +244,46 @@ tb_bool_t           tb_poller_modify(tb_poller_ref_t poller, tb_socket_ref_t soc
  */
 tb_long_t           tb_poller_wait(tb_poller_ref_t poller, tb_poller_event_func_t func, tb_long_t timeout);
 
+/*! wait all sockets and harvest the events in batches
+ *
+ * it is same as tb_poller_wait(), but all harvested events will be saved to the given list 
+ * instead of calling the events function for each event.
+ *
+ * the remaining events will be harvested next time if the list is full,
+ * and the private data of the socket may be stale if it is modified or removed before handling the list.
+ *
+ * @param poller    the poller
+ * @param events    the events list
+ * @param maxn      the maximum count of the events list
+ * @param timeout   the timeout, infinity: -1
+ *
+ * @return          > 0: the events number, 0: timeout, -1: failed
+ */
+tb_long_t           tb_poller_wait_events(tb_poller_ref_t poller, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout);
+
+/*! post an io operation to the poller (completion-style)
+ *
+ * it is only supported if tb_poller_support(poller, TB_POLLER_EVENT_COMP) is ok (.e.g io_uring on linux),
+ * and the completion will be passed to the events function of tb_poller_wait() with TB_POLLER_EVENT_COMP
+ *
+ * @param poller    the poller
+ * @param ioop      the io operation
+ *
+ * @return          tb_true or tb_false
+ */
+tb_bool_t           tb_poller_post(tb_poller_ref_t poller, tb_poller_ioop_ref_t ioop);
+
+/*! cancel the posted io operation 
+ *
+ * the io operation will be completed with a failed result if it has been canceled
+ *
+ * @param poller    the poller
+ * @param ioop      the io operation
+ *
+ * @return          tb_true or tb_false
+ */
+tb_bool_t           tb_poller_cancel(tb_poller_ref_t poller, tb_poller_ioop_ref_t ioop);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
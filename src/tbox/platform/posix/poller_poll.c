@@ -171,6 +171,94 @@ static __tb_inline__ tb_void_t tb_poller_hash_del(tb_poller_poll_ref_t poller, t
     // remove the user private data
     if (fd < poller->hash_size) poller->hash[fd] = tb_null;
 }
+static tb_long_t tb_poller_wait_done(tb_poller_poll_ref_t poller, tb_poller_event_func_t func, tb_poller_event_ref_t list, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(poller && poller->pfds && poller->cfds && (func || (list && maxn)), -1);
+
+    // loop
+    tb_long_t wait = 0;
+    tb_bool_t stop = tb_false;
+    tb_hong_t time = tb_mclock();
+    while (!wait && !stop && (timeout < 0 || tb_mclock() < time + timeout))
+    {
+        // pfds
+        struct pollfd*  pfds = (struct pollfd*)tb_vector_data(poller->pfds);
+        tb_size_t       pfdm = tb_vector_size(poller->pfds);
+        tb_assert_and_check_return_val(pfds && pfdm, -1);
+
+        // wait
+        tb_long_t pfdn = poll(pfds, pfdm, timeout);
+        tb_assert_and_check_return_val(pfdn >= 0, -1);
+
+        // timeout?
+        tb_check_return_val(pfdn, 0);
+
+        // copy fds
+        tb_vector_copy(poller->cfds, poller->pfds);
+
+        // walk the copied fds
+        pfds = (struct pollfd*)tb_vector_data(poller->cfds);
+        pfdm = tb_vector_size(poller->cfds);
+
+        // sync
+        tb_size_t i = 0;
+        for (i = 0; i < pfdm && (func || (tb_size_t)wait < maxn); i++)
+        {
+            // the sock
+            tb_socket_ref_t sock = tb_fd2sock(pfds[i].fd);
+            tb_assert_and_check_return_val(sock, -1);
+
+            // the poll events
+            tb_size_t poll_events = pfds[i].revents;
+            tb_check_continue(poll_events);
+
+            // spak?
+            if (sock == poller->pair[1] && (poll_events & POLLIN))
+            {
+                // read spak
+                tb_char_t spak = '\0';
+                if (1 != tb_socket_recv(poller->pair[1], (tb_byte_t*)&spak, 1)) return -1;
+
+                // killed?
+                if (spak == 'k') return -1;
+
+                // stop to wait
+                stop = tb_true;
+
+                // continue it
+                continue ;
+            }
+
+            // skip spak
+            tb_check_continue(sock != poller->pair[1]);
+
+            // init events
+            tb_size_t events = TB_POLLER_EVENT_NONE;
+            if (poll_events & POLLIN) events |= TB_POLLER_EVENT_RECV;
+            if (poll_events & POLLOUT) events |= TB_POLLER_EVENT_SEND;
+            if ((poll_events & POLLHUP) && !(events & (TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND))) 
+                events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
+
+            // call event function
+            if (func) func((tb_poller_ref_t)poller, sock, events, tb_poller_hash_get(poller, sock));
+            // save this event to the list
+            else
+            {
+                tb_poller_event_ref_t event = list + wait;
+                event->sock     = sock;
+                event->events   = events;
+                event->priv     = tb_poller_hash_get(poller, sock);
+            }
+
+            // update the events count
+            wait++;
+        }
+    }
+
+    // ok
+    return wait;
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -363,82 +451,16 @@ tb_bool_t tb_poller_modify(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t
 tb_long_t tb_poller_wait(tb_poller_ref_t self, tb_poller_event_func_t func, tb_long_t timeout)
 {
     // check
-    tb_poller_poll_ref_t poller = (tb_poller_poll_ref_t)self;
-    tb_assert_and_check_return_val(poller && poller->pfds && poller->cfds && func, -1);
-
-    // loop
-    tb_long_t wait = 0;
-    tb_bool_t stop = tb_false;
-    tb_hong_t time = tb_mclock();
-    while (!wait && !stop && (timeout < 0 || tb_mclock() < time + timeout))
-    {
-        // pfds
-        struct pollfd*  pfds = (struct pollfd*)tb_vector_data(poller->pfds);
-        tb_size_t       pfdm = tb_vector_size(poller->pfds);
-        tb_assert_and_check_return_val(pfds && pfdm, -1);
-
-        // wait
-        tb_long_t pfdn = poll(pfds, pfdm, timeout);
-        tb_assert_and_check_return_val(pfdn >= 0, -1);
-
-        // timeout?
-        tb_check_return_val(pfdn, 0);
+    tb_assert_and_check_return_val(self && func, -1);
 
-        // copy fds
-        tb_vector_copy(poller->cfds, poller->pfds);
-
-        // walk the copied fds
-        pfds = (struct pollfd*)tb_vector_data(poller->cfds);
-        pfdm = tb_vector_size(poller->cfds);
-
-        // sync
-        tb_size_t i = 0;
-        for (i = 0; i < pfdm; i++)
-        {
-            // the sock
-            tb_socket_ref_t sock = tb_fd2sock(pfds[i].fd);
-            tb_assert_and_check_return_val(sock, -1);
-
-            // the poll events
-            tb_size_t poll_events = pfds[i].revents;
-            tb_check_continue(poll_events);
-
-            // spak?
-            if (sock == poller->pair[1] && (poll_events & POLLIN))
-            {
-                // read spak
-                tb_char_t spak = '\0';
-                if (1 != tb_socket_recv(poller->pair[1], (tb_byte_t*)&spak, 1)) return -1;
-
-                // killed?
-                if (spak == 'k') return -1;
-
-                // stop to wait
-                stop = tb_true;
-
-                // continue it
-                continue ;
-            }
-
-            // skip spak
-            tb_check_continue(sock != poller->pair[1]);
-
-            // init events
-            tb_size_t events = TB_POLLER_EVENT_NONE;
-            if (poll_events & POLLIN) events |= TB_POLLER_EVENT_RECV;
-            if (poll_events & POLLOUT) events |= TB_POLLER_EVENT_SEND;
-            if ((poll_events & POLLHUP) && !(events & (TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND))) 
-                events |= TB_POLLER_EVENT_RECV | TB_POLLER_EVENT_SEND;
-
-            // call event function
-            func(self, sock, events, tb_poller_hash_get(poller, sock));
-
-            // update the events count
-            wait++;
-        }
-    }
-
-    // ok
-    return wait;
+    // wait events and call the events function
+    return tb_poller_wait_done((tb_poller_poll_ref_t)self, func, tb_null, 0, timeout);
 }
+tb_long_t tb_poller_wait_events(tb_poller_ref_t self, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(self && events && maxn, -1);
 
+    // wait events and save them to the given list
+    return tb_poller_wait_done((tb_poller_poll_ref_t)self, tb_null, events, maxn, timeout);
+}
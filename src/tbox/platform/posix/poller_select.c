@@ -149,6 +149,106 @@ static tb_void_t tb_poller_list_del(tb_poller_select_ref_t poller, tb_socket_ref
         poller->list_size--;
     }
 }
+static tb_long_t tb_poller_wait_done(tb_poller_select_ref_t poller, tb_poller_event_func_t func, tb_poller_event_ref_t list, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(poller && poller->list && (func || (list && maxn)), -1);
+
+    // init time
+    struct timeval t = {0};
+    if (timeout > 0)
+    {
+#ifdef TB_CONFIG_OS_WINDOWS
+        t.tv_sec = (LONG)(timeout / 1000);
+#else
+        t.tv_sec = (timeout / 1000);
+#endif
+        t.tv_usec = (timeout % 1000) * 1000;
+    }
+
+    // loop
+    tb_long_t wait = 0;
+    tb_bool_t stop = tb_false;
+    tb_hong_t time = tb_mclock();
+    while (!wait && !stop && (timeout < 0 || tb_mclock() < time + timeout))
+    {
+        // copy fds
+        tb_memcpy(&poller->rfdc, &poller->rfds, sizeof(fd_set));
+        tb_memcpy(&poller->wfdc, &poller->wfds, sizeof(fd_set));
+
+        // wait
+#ifdef TB_CONFIG_OS_WINDOWS
+        tb_long_t sfdn = tb_ws2_32()->select((tb_int_t) poller->sfdm + 1, &poller->rfdc, &poller->wfdc, tb_null, timeout >= 0? &t : tb_null);
+#else
+        tb_long_t sfdn = select(poller->sfdm + 1, &poller->rfdc, &poller->wfdc, tb_null, timeout >= 0? &t : tb_null);
+#endif
+        tb_assert_and_check_return_val(sfdn >= 0, -1);
+
+        // timeout?
+        tb_check_return_val(sfdn, 0);
+        
+        // dispatch events
+        tb_size_t i = 0;
+        tb_size_t n = poller->list_size;
+        for (i = 0; i < n; i++)
+        {
+            // end or the events list is full?
+            tb_check_break(wait >= 0 && (func || (tb_size_t)wait < maxn));
+
+            // the sock
+            tb_socket_ref_t sock = (tb_socket_ref_t)poller->list[i].sock;
+            tb_assert_and_check_return_val(sock, -1);
+
+            // spak?
+            if (sock == poller->pair[1] && FD_ISSET(tb_sock2fd(poller->pair[1]), &poller->rfdc))
+            {
+                // read spak
+                tb_char_t spak = '\0';
+                if (1 != tb_socket_recv(poller->pair[1], (tb_byte_t*)&spak, 1)) wait = -1;
+
+                // killed?
+                if (spak == 'k') wait = -1;
+                tb_check_break(wait >= 0);
+
+                // stop to wait
+                stop = tb_true;
+
+                // continue it
+                continue ;
+            }
+
+            // filter spak
+            tb_check_continue(sock != poller->pair[1]);
+
+            // init events
+            tb_long_t fd = tb_sock2fd(sock);
+            tb_size_t events = TB_POLLER_EVENT_NONE;
+            if (FD_ISSET(fd, &poller->rfdc)) events |= TB_POLLER_EVENT_RECV;
+            if (FD_ISSET(fd, &poller->wfdc)) events |= TB_POLLER_EVENT_SEND;
+
+            // exists events?
+            if (events)
+            {
+                // call event function
+                if (func) func((tb_poller_ref_t)poller, sock, events, poller->list[i].priv);
+                // save this event to the list
+                else
+                {
+                    tb_poller_event_ref_t event = list + wait;
+                    event->sock     = sock;
+                    event->events   = events;
+                    event->priv     = poller->list[i].priv;
+                }
+
+                // update the events count
+                wait++;
+            }
+        }
+    }
+
+    // ok
+    return wait;
+}
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -339,94 +439,16 @@ tb_bool_t tb_poller_modify(tb_poller_ref_t self, tb_socket_ref_t sock, tb_size_t
 tb_long_t tb_poller_wait(tb_poller_ref_t self, tb_poller_event_func_t func, tb_long_t timeout)
 {
     // check
-    tb_poller_select_ref_t poller = (tb_poller_select_ref_t)self;
-    tb_assert_and_check_return_val(poller && poller->list && func, -1);
-
-    // init time
-    struct timeval t = {0};
-    if (timeout > 0)
-    {
-#ifdef TB_CONFIG_OS_WINDOWS
-        t.tv_sec = (LONG)(timeout / 1000);
-#else
-        t.tv_sec = (timeout / 1000);
-#endif
-        t.tv_usec = (timeout % 1000) * 1000;
-    }
-
-    // loop
-    tb_long_t wait = 0;
-    tb_bool_t stop = tb_false;
-    tb_hong_t time = tb_mclock();
-    while (!wait && !stop && (timeout < 0 || tb_mclock() < time + timeout))
-    {
-        // copy fds
-        tb_memcpy(&poller->rfdc, &poller->rfds, sizeof(fd_set));
-        tb_memcpy(&poller->wfdc, &poller->wfds, sizeof(fd_set));
-
-        // wait
-#ifdef TB_CONFIG_OS_WINDOWS
-        tb_long_t sfdn = tb_ws2_32()->select((tb_int_t) poller->sfdm + 1, &poller->rfdc, &poller->wfdc, tb_null, timeout >= 0? &t : tb_null);
-#else
-        tb_long_t sfdn = select(poller->sfdm + 1, &poller->rfdc, &poller->wfdc, tb_null, timeout >= 0? &t : tb_null);
-#endif
-        tb_assert_and_check_return_val(sfdn >= 0, -1);
-
-        // timeout?
-        tb_check_return_val(sfdn, 0);
-        
-        // dispatch events
-        tb_size_t i = 0;
-        tb_size_t n = poller->list_size;
-        for (i = 0; i < n; i++)
-        {
-            // end?
-            tb_check_break(wait >= 0);
-
-            // the sock
-            tb_socket_ref_t sock = (tb_socket_ref_t)poller->list[i].sock;
-            tb_assert_and_check_return_val(sock, -1);
+    tb_assert_and_check_return_val(self && func, -1);
 
-            // spak?
-            if (sock == poller->pair[1] && FD_ISSET(tb_sock2fd(poller->pair[1]), &poller->rfdc))
-            {
-                // read spak
-                tb_char_t spak = '\0';
-                if (1 != tb_socket_recv(poller->pair[1], (tb_byte_t*)&spak, 1)) wait = -1;
-
-                // killed?
-                if (spak == 'k') wait = -1;
-                tb_check_break(wait >= 0);
-
-                // stop to wait
-                stop = tb_true;
-
-                // continue it
-                continue ;
-            }
-
-            // filter spak
-            tb_check_continue(sock != poller->pair[1]);
-
-            // init events
-            tb_long_t fd = tb_sock2fd(sock);
-            tb_size_t events = TB_POLLER_EVENT_NONE;
-            if (FD_ISSET(fd, &poller->rfdc)) events |= TB_POLLER_EVENT_RECV;
-            if (FD_ISSET(fd, &poller->wfdc)) events |= TB_POLLER_EVENT_SEND;
-
-            // exists events?
-            if (events)
-            {
-                // call event function
-                func(self, sock, events, poller->list[i].priv);
-
-                // update the events count
-                wait++;
-            }
-        }
-    }
-
-    // ok
-    return wait;
+    // wait events and call the events function
+    return tb_poller_wait_done((tb_poller_select_ref_t)self, func, tb_null, 0, timeout);
 }
+tb_long_t tb_poller_wait_events(tb_poller_ref_t self, tb_poller_event_ref_t events, tb_size_t maxn, tb_long_t timeout)
+{
+    // check
+    tb_assert_and_check_return_val(self && events && maxn, -1);
 
+    // wait events and save them to the given list
+    return tb_poller_wait_done((tb_poller_select_ref_t)self, tb_null, events, maxn, timeout);
+}
@@ -29,6 +29,9 @@
 #include "prefix.h"
 #include "../platform.h"
 #include <unistd.h>
+#ifdef TB_CONFIG_OS_LINUX
+#   include <sys/syscall.h>
+#endif
 
 /* //////////////////////////////////////////////////////////////////////////////////////
  * implementation
@@ -43,5 +46,16 @@ tb_size_t tb_processor_count()
     // ok?
     return count;
 }
+tb_long_t tb_processor_node()
+{
+#if defined(TB_CONFIG_OS_LINUX) && defined(__NR_getcpu)
+    // get the node of the current cpu
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    return !syscall(__NR_getcpu, &cpu, &node, tb_null)? (tb_long_t)node : -1;
+#else
+    return -1;
+#endif
+}
 
 
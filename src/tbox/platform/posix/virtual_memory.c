@@ -0,0 +1,226 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        virtual_memory.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../platform.h"
+#include <sys/mman.h>
+#ifdef TB_CONFIG_OS_LINUX
+#   include <unistd.h>
+#   include <sys/syscall.h>
+#endif
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * macros
+ */
+
+// the anonymous mapping flag
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#   define MAP_ANONYMOUS        MAP_ANON
+#endif
+
+// the no-reserve mapping flag
+#ifndef MAP_NORESERVE
+#   define MAP_NORESERVE        (0)
+#endif
+
+// the lightweight guard regions advice for madvise (linux >= 6.13), see linux/mman.h
+#if defined(TB_CONFIG_OS_LINUX) && !defined(MADV_GUARD_INSTALL)
+#   define MADV_GUARD_INSTALL   (102)
+#endif
+
+// the maximum pages count of the resident vector on stack
+#define TB_VIRTUAL_MEMORY_RESIDENT_PAGES    (256)
+
+// the preferred memory policy for mbind, see linux/mempolicy.h
+#define TB_VIRTUAL_MEMORY_MPOL_PREFERRED    (1)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_pointer_t tb_virtual_memory_reserve(tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(size, tb_null);
+
+    // reserve the address space only
+    tb_pointer_t data = mmap(tb_null, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return data != MAP_FAILED? data : tb_null;
+}
+tb_pointer_t tb_virtual_memory_reserve_align(tb_size_t size, tb_size_t align)
+{
+    // check
+    tb_assert_and_check_return_val(size && align && !(align & (align - 1)), tb_null);
+
+    // reserve more address space for aligning it
+    tb_byte_t* data = (tb_byte_t*)tb_virtual_memory_reserve(size + align);
+    tb_check_return_val(data, tb_null);
+
+    // trim the unaligned head and the left tail
+    tb_byte_t* data_aligned = (tb_byte_t*)tb_align((tb_size_t)data, align);
+    if (data_aligned > data) munmap(data, data_aligned - data);
+    if (data + align > data_aligned) munmap(data_aligned + size, data + align - data_aligned);
+
+    // ok
+    return data_aligned;
+}
+tb_bool_t tb_virtual_memory_release(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // unmap it
+    return !munmap(data, size)? tb_true : tb_false;
+}
+tb_bool_t tb_virtual_memory_commit(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // make these pages accessible, the physical memory will be allocated on the first page fault
+    return !mprotect(data, size, PROT_READ | PROT_WRITE)? tb_true : tb_false;
+}
+tb_bool_t tb_virtual_memory_decommit(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // remap these pages to discard the physical memory and make them not accessible
+    return mmap(data, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0) != MAP_FAILED? tb_true : tb_false;
+}
+tb_bool_t tb_virtual_memory_guard(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+#if defined(MADV_GUARD_INSTALL) && defined(TB_CONFIG_POSIX_HAVE_MADVISE)
+    // install the guard regions without splitting the mapping
+    if (!madvise(data, size, MADV_GUARD_INSTALL)) return tb_true;
+#endif
+
+    // make these pages not accessible, the mapping will be split
+    return !mprotect(data, size, PROT_NONE)? tb_true : tb_false;
+}
+tb_size_t tb_virtual_memory_resident(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, 0);
+
+#ifdef TB_CONFIG_POSIX_HAVE_MINCORE
+    // the page size
+    tb_size_t pagesize = tb_page_size();
+    tb_assert_and_check_return_val(pagesize, size);
+
+    // count the resident pages
+    tb_size_t       resident = 0;
+    tb_byte_t*      p = (tb_byte_t*)data;
+    tb_byte_t*      e = p + size;
+    tb_byte_t       vec[TB_VIRTUAL_MEMORY_RESIDENT_PAGES];
+    while (p < e)
+    {
+        // get the resident flags of the next pages
+        tb_size_t n = tb_min((tb_size_t)(e - p), pagesize * TB_VIRTUAL_MEMORY_RESIDENT_PAGES);
+        if (mincore((tb_pointer_t)p, n, (tb_pointer_t)vec) != 0) return size;
+
+        // count them
+        tb_size_t i = 0;
+        tb_size_t m = (n + pagesize - 1) / pagesize;
+        for (i = 0; i < m; i++)
+            if (vec[i] & 0x1) resident += pagesize;
+
+        // next
+        p += n;
+    }
+
+    // ok
+    return tb_min(resident, size);
+#else
+    return size;
+#endif
+}
+tb_bool_t tb_virtual_memory_advise(tb_pointer_t data, tb_size_t size, tb_size_t advice)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+#ifdef TB_CONFIG_POSIX_HAVE_MADVISE
+    // done
+    tb_bool_t ok = tb_false;
+    switch (advice)
+    {
+    case TB_VIRTUAL_MEMORY_ADVICE_NORMAL:
+        ok = !madvise(data, size, MADV_NORMAL);
+        break;
+    case TB_VIRTUAL_MEMORY_ADVICE_HUGEPAGE:
+#ifdef MADV_HUGEPAGE
+        ok = !madvise(data, size, MADV_HUGEPAGE);
+#endif
+        break;
+    case TB_VIRTUAL_MEMORY_ADVICE_FREE:
+#ifdef MADV_FREE
+        // the pages will be reclaimed lazily only under memory pressure
+        ok = !madvise(data, size, MADV_FREE);
+#endif
+#if defined(MADV_DONTNEED) && defined(TB_CONFIG_OS_LINUX)
+        /* the old kernel (< 4.5) does not support MADV_FREE, 
+         * so we discard these pages immediately and they will be zero-filled on the next access
+         */
+        if (!ok) ok = !madvise(data, size, MADV_DONTNEED);
+#endif
+        break;
+    case TB_VIRTUAL_MEMORY_ADVICE_DONTNEED:
+#ifdef MADV_DONTNEED
+        // discard these pages immediately and they will be zero-filled on the next access
+        ok = !madvise(data, size, MADV_DONTNEED);
+#endif
+        break;
+    default:
+        break;
+    }
+
+    // ok?
+    return ok;
+#else
+    return tb_false;
+#endif
+}
+tb_bool_t tb_virtual_memory_bind(tb_pointer_t data, tb_size_t size, tb_size_t node)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+#if defined(TB_CONFIG_OS_LINUX) && defined(__NR_mbind)
+    // check
+    tb_assert_and_check_return_val(node < TB_CPU_BITSIZE, tb_false);
+
+    // prefer this node and fallback to the other nodes if it has no free memory
+    unsigned long nodemask = 1UL << node;
+    return !syscall(__NR_mbind, data, size, TB_VIRTUAL_MEMORY_MPOL_PREFERRED, &nodemask, (unsigned long)TB_CPU_BITSIZE, 0)? tb_true : tb_false;
+#else
+    return tb_false;
+#endif
+}
@@ -40,5 +40,9 @@ tb_size_t tb_processor_count()
 {
     return 1;
 }
+tb_long_t tb_processor_node()
+{
+    return -1;
+}
 #endif
 
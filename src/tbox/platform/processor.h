@@ -46,6 +46,14 @@ __tb_extern_c_enter__
  */
 tb_size_t               tb_processor_count(tb_noarg_t);
 
+/*! the numa node of the processor which the current thread is running on
+ *
+ * @note the thread may be migrated to the other node later if it is not bound to the processor
+ *
+ * @return              the numa node, -1 if unknown
+ */
+tb_long_t               tb_processor_node(tb_noarg_t);
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * extern
  */
@@ -0,0 +1,439 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        task_graph.c
+ * @ingroup     platform
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME                "task_graph"
+#define TB_TRACE_MODULE_DEBUG               (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "task_graph.h"
+#include "atomic.h"
+#include "semaphore.h"
+#include "../utils/used.h"
+#include "../container/container.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+// the task graph type
+typedef struct __tb_task_graph_t
+{
+    // the thread pool
+    tb_thread_pool_ref_t        pool;
+
+    // the nodes
+    tb_vector_ref_t             nodes;
+
+    // the left count of the nodes which have been not finished and the posted tasks which have been not exited
+    tb_atomic_t                 left;
+
+    // some tasks have been killed?
+    tb_atomic_t                 killed;
+
+    // the semaphore for notifying the caller if all nodes have been finished
+    tb_semaphore_ref_t          semaphore;
+
+    // is running?
+    tb_bool_t                   running;
+
+}tb_task_graph_t;
+
+// the task graph node type
+typedef struct __tb_task_graph_node_t
+{
+    // the graph
+    tb_task_graph_t*            graph;
+
+    // the name
+    tb_char_t const*            name;
+
+    // the func
+    tb_task_graph_func_t        func;
+
+    // the private data
+    tb_cpointer_t               priv;
+
+    // the predecessors count
+    tb_size_t                   preds;
+
+    // the pending predecessors count which have been not finished
+    tb_atomic_t                 pending;
+
+    // has this node been run by the thread pool?
+    tb_atomic_t                 started;
+
+    // the successors
+    tb_vector_ref_t             successors;
+
+}tb_task_graph_node_t;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * declaration
+ */
+static tb_void_t tb_task_graph_node_done(tb_task_graph_node_t* node);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * private implementation
+ */
+static tb_void_t tb_task_graph_node_free(tb_element_ref_t element, tb_pointer_t buff)
+{
+    // check
+    tb_task_graph_node_t* node = buff? *((tb_task_graph_node_t**)buff) : tb_null;
+    tb_check_return(node);
+
+    // exit successors
+    if (node->successors) tb_vector_exit(node->successors);
+    node->successors = tb_null;
+
+    // exit it
+    tb_free(node);
+}
+static tb_void_t tb_task_graph_leave(tb_task_graph_t* graph)
+{
+    // all nodes have been finished and all posted tasks have been exited? notify the caller
+    if (tb_atomic_fetch_and_dec(&graph->left) == 1) tb_semaphore_post(graph->semaphore, 1);
+}
+static tb_void_t tb_task_graph_node_task_done(tb_thread_pool_worker_ref_t worker, tb_cpointer_t priv)
+{
+    // check
+    tb_task_graph_node_t* node = (tb_task_graph_node_t*)priv;
+    tb_assert_and_check_return(node);
+
+    // mark it as started
+    tb_atomic_set(&node->started, 1);
+
+    // done it
+    tb_task_graph_node_done(node);
+}
+static tb_void_t tb_task_graph_node_task_exit(tb_thread_pool_worker_ref_t worker, tb_cpointer_t priv)
+{
+    // check
+    tb_task_graph_node_t* node = (tb_task_graph_node_t*)priv;
+    tb_assert_and_check_return(node && node->graph);
+
+    // the graph
+    tb_task_graph_t* graph = node->graph;
+
+    /* this task has been killed by the thread pool?
+     *
+     * we mark the graph as killed and finish this node without running it,
+     * so its successors will be finished too and the caller will be not blocked.
+     */
+    if (!tb_atomic_get(&node->started))
+    {
+        // trace
+        tb_trace_d("killed: %s", node->name);
+
+        // mark the graph as killed
+        tb_atomic_set(&graph->killed, 1);
+
+        // finish it
+        tb_task_graph_node_done(node);
+    }
+
+    // this posted task has been exited, the node cannot be accessed after leaving it
+    tb_task_graph_leave(graph);
+}
+static tb_void_t tb_task_graph_node_post(tb_task_graph_node_t* node)
+{
+    // the graph
+    tb_task_graph_t* graph = node->graph;
+
+    // the posted task will be waited until it has been exited
+    tb_atomic_fetch_and_inc(&graph->left);
+
+    // post it to the thread pool, run it directly if the thread pool has been stopped
+    if (!tb_thread_pool_task_post(graph->pool, node->name, tb_task_graph_node_task_done, tb_task_graph_node_task_exit, node, tb_false))
+    {
+        tb_task_graph_node_done(node);
+        tb_task_graph_leave(graph);
+    }
+}
+static tb_void_t tb_task_graph_node_done(tb_task_graph_node_t* node)
+{
+    while (node)
+    {
+        // check
+        tb_task_graph_t* graph = node->graph;
+        tb_assert_and_check_break(graph);
+
+        // trace
+        tb_trace_d("done: %s", node->name);
+
+        // done it if the graph has been not killed
+        if (node->func && !tb_atomic_get(&graph->killed)) node->func(node->priv);
+
+        /* notify the successors
+         *
+         * we run the first ready successor directly on the current thread 
+         * and post the others to the thread pool
+         */
+        tb_task_graph_node_t* next = tb_null;
+        if (node->successors)
+        {
+            tb_size_t               i = 0;
+            tb_size_t               n = tb_vector_size(node->successors);
+            tb_task_graph_node_t**  successors = (tb_task_graph_node_t**)tb_vector_data(node->successors);
+            for (i = 0; i < n; i++)
+            {
+                // all predecessors of this successor have been finished?
+                tb_task_graph_node_t* successor = successors[i];
+                if (tb_atomic_fetch_and_dec(&successor->pending) == 1)
+                {
+                    if (!next) next = successor;
+                    else tb_task_graph_node_post(successor);
+                }
+            }
+        }
+
+        // this node has been finished
+        tb_task_graph_leave(graph);
+
+        // the next node
+        node = next;
+    }
+}
+static tb_bool_t tb_task_graph_check(tb_task_graph_node_t** nodes, tb_size_t size, tb_task_graph_node_t** queue)
+{
+    // init the pending counts
+    tb_size_t head = 0;
+    tb_size_t tail = 0;
+    tb_size_t i = 0;
+    for (i = 0; i < size; i++)
+    {
+        nodes[i]->pending = nodes[i]->preds;
+        if (!nodes[i]->preds) queue[tail++] = nodes[i];
+    }
+
+    // visit all nodes in the topological order (kahn)
+    while (head < tail)
+    {
+        tb_task_graph_node_t* node = queue[head++];
+        if (node->successors)
+        {
+            tb_size_t               j = 0;
+            tb_size_t               n = tb_vector_size(node->successors);
+            tb_task_graph_node_t**  successors = (tb_task_graph_node_t**)tb_vector_data(node->successors);
+            for (j = 0; j < n; j++)
+            {
+                if (!--successors[j]->pending) queue[tail++] = successors[j];
+            }
+        }
+    }
+
+    // all nodes have been visited? no cycles
+    return tail == size;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_task_graph_ref_t tb_task_graph_init(tb_thread_pool_ref_t pool)
+{
+    // done
+    tb_bool_t           ok = tb_false;
+    tb_task_graph_t*    graph = tb_null;
+    do
+    {
+        // make graph
+        graph = tb_malloc0_type(tb_task_graph_t);
+        tb_assert_and_check_break(graph);
+
+        // init pool
+        graph->pool = pool? pool : tb_thread_pool();
+        tb_assert_and_check_break(graph->pool);
+
+        // init nodes
+        graph->nodes = tb_vector_init(0, tb_element_ptr(tb_task_graph_node_free, tb_null));
+        tb_assert_and_check_break(graph->nodes);
+
+        // init semaphore
+        graph->semaphore = tb_semaphore_init(0);
+        tb_assert_and_check_break(graph->semaphore);
+
+        // ok
+        ok = tb_true;
+
+    } while (0);
+
+    // failed?
+    if (!ok)
+    {
+        // exit it
+        if (graph) tb_task_graph_exit((tb_task_graph_ref_t)graph);
+        graph = tb_null;
+    }
+
+    // ok?
+    return (tb_task_graph_ref_t)graph;
+}
+tb_void_t tb_task_graph_exit(tb_task_graph_ref_t self)
+{
+    // check
+    tb_task_graph_t* graph = (tb_task_graph_t*)self;
+    tb_assert_and_check_return(graph && !graph->running);
+
+    // exit nodes
+    if (graph->nodes) tb_vector_exit(graph->nodes);
+    graph->nodes = tb_null;
+
+    // exit semaphore
+    if (graph->semaphore) tb_semaphore_exit(graph->semaphore);
+    graph->semaphore = tb_null;
+
+    // exit it
+    tb_free(graph);
+}
+tb_void_t tb_task_graph_clear(tb_task_graph_ref_t self)
+{
+    // check
+    tb_task_graph_t* graph = (tb_task_graph_t*)self;
+    tb_assert_and_check_return(graph && graph->nodes && !graph->running);
+
+    // clear nodes
+    tb_vector_clear(graph->nodes);
+}
+tb_task_graph_node_ref_t tb_task_graph_node(tb_task_graph_ref_t self, tb_char_t const* name, tb_task_graph_func_t func, tb_cpointer_t priv)
+{
+    // check
+    tb_task_graph_t* graph = (tb_task_graph_t*)self;
+    tb_assert_and_check_return_val(graph && graph->nodes && func && !graph->running, tb_null);
+
+    // make node
+    tb_task_graph_node_t* node = tb_malloc0_type(tb_task_graph_node_t);
+    tb_assert_and_check_return_val(node, tb_null);
+
+    // init node
+    node->graph = graph;
+    node->name  = name;
+    node->func  = func;
+    node->priv  = priv;
+
+    // save node
+    tb_vector_insert_tail(graph->nodes, node);
+
+    // ok
+    return (tb_task_graph_node_ref_t)node;
+}
+tb_bool_t tb_task_graph_depend(tb_task_graph_ref_t self, tb_task_graph_node_ref_t node_ref, tb_task_graph_node_ref_t pred_ref)
+{
+    // check
+    tb_task_graph_t*        graph = (tb_task_graph_t*)self;
+    tb_task_graph_node_t*   node = (tb_task_graph_node_t*)node_ref;
+    tb_task_graph_node_t*   pred = (tb_task_graph_node_t*)pred_ref;
+    tb_assert_and_check_return_val(graph && node && pred && node != pred && !graph->running, tb_false);
+    tb_assert_and_check_return_val(node->graph == graph && pred->graph == graph, tb_false);
+
+    // init successors
+    if (!pred->successors) pred->successors = tb_vector_init(0, tb_element_ptr(tb_null, tb_null));
+    tb_assert_and_check_return_val(pred->successors, tb_false);
+
+    // add this node to the successors of the predecessor
+    tb_vector_insert_tail(pred->successors, node);
+    node->preds++;
+
+    // ok
+    return tb_true;
+}
+tb_size_t tb_task_graph_size(tb_task_graph_ref_t self)
+{
+    // check
+    tb_task_graph_t* graph = (tb_task_graph_t*)self;
+    tb_assert_and_check_return_val(graph && graph->nodes, 0);
+
+    // the nodes count
+    return tb_vector_size(graph->nodes);
+}
+tb_bool_t tb_task_graph_run(tb_task_graph_ref_t self)
+{
+    // check
+    tb_task_graph_t* graph = (tb_task_graph_t*)self;
+    tb_assert_and_check_return_val(graph && graph->nodes && !graph->running, tb_false);
+
+    // empty?
+    tb_size_t size = tb_vector_size(graph->nodes);
+    tb_check_return_val(size, tb_true);
+
+    // done
+    tb_bool_t               ok = tb_false;
+    tb_task_graph_node_t**  queue = tb_null;
+    do
+    {
+        // make the visiting queue
+        queue = tb_nalloc_type(size, tb_task_graph_node_t*);
+        tb_assert_and_check_break(queue);
+
+        // check cycles
+        tb_task_graph_node_t** nodes = (tb_task_graph_node_t**)tb_vector_data(graph->nodes);
+        if (!tb_task_graph_check(nodes, size, queue))
+        {
+            // trace
+            tb_trace_e("the task graph has cycles!");
+            break;
+        }
+
+        // reset the pending counts and get the root nodes
+        tb_size_t i = 0;
+        tb_size_t roots = 0;
+        for (i = 0; i < size; i++)
+        {
+            nodes[i]->pending = nodes[i]->preds;
+            nodes[i]->started = 0;
+            if (!nodes[i]->preds) queue[roots++] = nodes[i];
+        }
+        graph->left     = size;
+        graph->killed   = 0;
+        graph->running  = tb_true;
+
+        // post the root nodes, but the first root node will be run on the current thread
+        for (i = 1; i < roots; i++) tb_task_graph_node_post(queue[i]);
+        tb_task_graph_node_done(queue[0]);
+
+        // wait all nodes
+        tb_long_t wait = tb_semaphore_wait(graph->semaphore, -1);
+        tb_assert(wait > 0);
+        tb_used(wait);
+
+        // finished
+        graph->running = tb_false;
+
+        // ok if no tasks have been killed
+        ok = !tb_atomic_get(&graph->killed);
+
+    } while (0);
+
+    // exit the visiting queue
+    if (queue) tb_free(queue);
+    queue = tb_null;
+
+    // ok?
+    return ok;
+}
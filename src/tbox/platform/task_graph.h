@@ -0,0 +1,164 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        task_graph.h
+ * @ingroup     platform
+ *
+ */
+#ifndef TB_PLATFORM_TASK_GRAPH_H
+#define TB_PLATFORM_TASK_GRAPH_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "thread_pool.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/*! the task graph ref type
+ *
+ * the task will be posted to the thread pool after all its predecessors have been finished,
+ * and the finished task will run one of its ready successors directly on the same worker.
+ *
+ * <pre>
+ *
+ *         load
+ *        /    \
+ *     parse  fetch
+ *        \    /
+ *        merge
+ *          |
+ *        save
+ *
+ * </pre>
+ */
+typedef __tb_typeref__(task_graph);
+
+/// the task graph node ref type
+typedef __tb_typeref__(task_graph_node);
+
+/// the task graph node func type
+typedef tb_void_t               (*tb_task_graph_func_t)(tb_cpointer_t priv);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! init the task graph
+ *
+ * @code
+    tb_task_graph_ref_t graph = tb_task_graph_init(tb_null);
+    if (graph)
+    {
+        // add tasks
+        tb_task_graph_node_ref_t load  = tb_task_graph_node(graph, "load", tb_demo_load, tb_null);
+        tb_task_graph_node_ref_t parse = tb_task_graph_node(graph, "parse", tb_demo_parse, tb_null);
+        tb_task_graph_node_ref_t fetch = tb_task_graph_node(graph, "fetch", tb_demo_fetch, tb_null);
+        tb_task_graph_node_ref_t merge = tb_task_graph_node(graph, "merge", tb_demo_merge, tb_null);
+
+        // add dependences
+        tb_task_graph_depend(graph, parse, load);
+        tb_task_graph_depend(graph, fetch, load);
+        tb_task_graph_depend(graph, merge, parse);
+        tb_task_graph_depend(graph, merge, fetch);
+
+        // run it and wait all tasks
+        tb_task_graph_run(graph);
+
+        // exit it
+        tb_task_graph_exit(graph);
+    }
+ * @endcode
+ *
+ * @param pool          the thread pool, using tb_thread_pool() if be null
+ *
+ * @return              the task graph
+ */
+tb_task_graph_ref_t     tb_task_graph_init(tb_thread_pool_ref_t pool);
+
+/*! exit the task graph
+ *
+ * @param graph         the task graph
+ */
+tb_void_t               tb_task_graph_exit(tb_task_graph_ref_t graph);
+
+/*! clear all nodes of the task graph
+ *
+ * @param graph         the task graph
+ */
+tb_void_t               tb_task_graph_clear(tb_task_graph_ref_t graph);
+
+/*! add a task node to the task graph
+ *
+ * @param graph         the task graph
+ * @param name          the task name, only for the debug info
+ * @param func          the task func
+ * @param priv          the task private data
+ *
+ * @return              the task node
+ */
+tb_task_graph_node_ref_t tb_task_graph_node(tb_task_graph_ref_t graph, tb_char_t const* name, tb_task_graph_func_t func, tb_cpointer_t priv);
+
+/*! add a dependence, the node will be run after the predecessor has been finished
+ *
+ * @param graph         the task graph
+ * @param node          the task node
+ * @param pred          the predecessor node
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_task_graph_depend(tb_task_graph_ref_t graph, tb_task_graph_node_ref_t node, tb_task_graph_node_ref_t pred);
+
+/*! the task nodes count
+ *
+ * @param graph         the task graph
+ *
+ * @return              the nodes count
+ */
+tb_size_t               tb_task_graph_size(tb_task_graph_ref_t graph);
+
+/*! run all tasks of the task graph and wait them
+ *
+ * the graph cannot be modified when it is running, but it can be run again after it has been finished.
+ *
+ * if some tasks are killed by the thread pool (e.g. tb_thread_pool_kill()), 
+ * the remaining nodes will be finished without running them and this function will return tb_false.
+ *
+ * @param graph         the task graph
+ *
+ * @return              tb_true or tb_false if the graph has cycles or some tasks have been killed
+ */
+tb_bool_t               tb_task_graph_run(tb_task_graph_ref_t graph);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
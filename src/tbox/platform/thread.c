@@ -31,6 +31,7 @@
 #include "time.h"
 #include "thread_local.h"
 #include "../utils/utils.h"
+#include "../memory/default_allocator.h"
 #include "impl/thread_local.h"
 
 /* //////////////////////////////////////////////////////////////////////////////////////
@@ -103,6 +104,11 @@ static tb_thread_retval_t tb_thread_func(tb_pointer_t priv)
     if (args) tb_free(args);
     args = tb_null;
 
+#ifndef TB_CONFIG_MICRO_ENABLE
+    // return all cached data of the allocator on the current thread
+    tb_default_allocator_cache_exit();
+#endif
+
     // return the return value
     return retval;
 }
@@ -78,6 +78,16 @@
 #   define TB_THREAD_POOL_JOBS_PULL_TIME_MAXN   (20000)
 #endif
 
+// the deque maxn of each worker for the work-stealing mode, must be the power of 2
+#ifdef __tb_small__
+#   define TB_THREAD_POOL_DEQUE_MAXN            (256)
+#else
+#   define TB_THREAD_POOL_DEQUE_MAXN            (4096)
+#endif
+
+// the maximum count of the jobs pulled from the injection queue at once for the work-stealing mode
+#define TB_THREAD_POOL_INJECT_PULL_MAXN         (32)
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * types
  */
@@ -104,6 +114,9 @@ typedef struct __tb_thread_pool_job_t
     // the entry
     tb_list_entry_t                     entry;
 
+    // the kill epoch of the pool when posting it, it will be killed if the epoch has been changed (work-stealing mode)
+    tb_long_t                           epoch;
+
 }tb_thread_pool_job_t;
 
 // the thread pool job stats type
@@ -128,6 +141,40 @@ typedef struct __tb_thread_pool_worker_priv_t
 
 }tb_thread_pool_worker_priv_t;
 
+/* the work-stealing deque type (Chase-Lev)
+ *
+ * the owner worker pushes and pops jobs at the bottom, and the other workers steal jobs from the top.
+ *
+ * <pre>
+ * deque: |-----||||||||||||||||||||||||||||||||----------|
+ *             top (stealers)                 bottom (owner)
+ * </pre>
+ *
+ * the slot index is (position & (TB_THREAD_POOL_DEQUE_MAXN - 1)), 
+ * the deque will be not grown and the new jobs will be posted to the injection queue if it is full.
+ */
+typedef struct __tb_thread_pool_deque_t
+{
+    // the jobs
+    tb_thread_pool_job_t**              data;
+
+    // the padding for the top
+    tb_byte_t                           pad0[TB_L1_CACHE_BYTES];
+
+    // the top position for stealers
+    tb_atomic_t                         top;
+
+    // the padding for the bottom
+    tb_byte_t                           pad1[TB_L1_CACHE_BYTES];
+
+    // the bottom position for the owner
+    tb_atomic_t                         bottom;
+
+    // the padding
+    tb_byte_t                           pad2[TB_L1_CACHE_BYTES];
+
+}tb_thread_pool_deque_t;
+
 // the thread pool worker type
 typedef struct __tb_thread_pool_worker_t
 {
@@ -155,6 +202,12 @@ typedef struct __tb_thread_pool_worker_t
     // the private data 
     tb_thread_pool_worker_priv_t        priv[TB_THREAD_POOL_WORKER_PRIV_MAXN];
 
+    // the jobs deque for the work-stealing mode
+    tb_thread_pool_deque_t              deque;
+
+    // the victim worker index for stealing jobs
+    tb_size_t                           victim;
+
 }tb_thread_pool_worker_t;
 
 // the thread pool type
@@ -190,11 +243,33 @@ typedef struct __tb_thread_pool_impl_t
     // the worker size
     tb_size_t                           worker_size;
 
+    // the flags
+    tb_size_t                           flags;
+
+    // the idle workers count for the work-stealing mode
+    tb_atomic_t                         idle;
+
+    // the alive jobs count for the work-stealing mode
+    tb_atomic_t                         jobs_count;
+
+    // the jobs count of the injection queue (jobs_urgent and jobs_waiting) for the work-stealing mode
+    tb_atomic_t                         jobs_inject;
+
+    // the kill epoch for the work-stealing mode, the waiting jobs will be killed if it is changed
+    tb_atomic_t                         epoch;
+
     // the worker list
     tb_thread_pool_worker_t             worker_list[TB_THREAD_POOL_WORKER_MAXN];
 
 }tb_thread_pool_impl_t;
 
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * globals
+ */
+
+// the current worker local for the work-stealing mode
+static tb_thread_local_t                s_thread_pool_worker = TB_THREAD_LOCAL_INIT;
+
 /* //////////////////////////////////////////////////////////////////////////////////////
  * instance implementation
  */
@@ -222,6 +297,16 @@ static tb_void_t tb_thread_pool_instance_kill(tb_handle_t pool, tb_cpointer_t pr
 /* //////////////////////////////////////////////////////////////////////////////////////
  * worker implementation
  */
+static tb_void_t tb_thread_pool_job_exit_func(tb_thread_pool_worker_t* worker, tb_thread_pool_job_t* job)
+{
+    // check
+    tb_assert(worker && job);
+
+    // exit the private data of the job only once, it will be not called again when cleaning the job
+    tb_thread_pool_task_exit_func_t exit = job->task.exit;
+    job->task.exit = tb_null;
+    if (exit) exit((tb_thread_pool_worker_ref_t)worker, job->task.priv);
+}
 static tb_bool_t tb_thread_pool_worker_walk_pull(tb_iterator_ref_t iterator, tb_cpointer_t item, tb_cpointer_t value, tb_bool_t* is_break)
 {
     // the worker pull
@@ -250,6 +335,9 @@ static tb_bool_t tb_thread_pool_worker_walk_pull(tb_iterator_ref_t iterator, tb_
     // append the job to the working jobs
     tb_vector_insert_tail(worker->jobs, job);   
 
+    // refn++, the working jobs will be released after being done
+    job->refn++;
+
     // computate the job average time 
     tb_size_t average_time = 200;
     if (tb_hash_map_size(worker->stats))
@@ -287,6 +375,11 @@ static tb_bool_t tb_thread_pool_worker_walk_pull_and_clean(tb_iterator_ref_t ite
         // append the job to the working jobs
         tb_vector_insert_tail(worker->jobs, job);   
 
+        /* refn++, the job may be done by other worker and be removed from the pending jobs
+         * before we visit it, so we need keep it until the working jobs are released
+         */
+        job->refn++;
+
         // computate the job average time 
         tb_size_t average_time = 200;
         if (tb_hash_map_size(worker->stats))
@@ -385,6 +478,41 @@ static tb_void_t tb_thread_pool_worker_post(tb_thread_pool_impl_t* impl, tb_size
     if (value >= 0 && (tb_size_t)value < post) 
         tb_semaphore_post(impl->semaphore, post - value);
 }
+static tb_void_t tb_thread_pool_worker_exit(tb_thread_pool_worker_t* worker)
+{
+    // check
+    tb_assert_and_check_return(worker);
+
+    // trace
+    tb_trace_d("worker[%lu]: exit", worker->id);
+
+    // stoped
+    tb_atomic_set(&worker->bstoped, 1);
+
+    // exit all private data
+    tb_size_t i = 0;
+    tb_size_t n = tb_arrayn(worker->priv);
+    for (i = 0; i < n; i++)
+    {
+        // the private data
+        tb_thread_pool_worker_priv_t* priv = &worker->priv[n - i - 1];
+
+        // exit it
+        if (priv->exit) priv->exit((tb_thread_pool_worker_ref_t)worker, priv->priv);
+
+        // clear it
+        priv->exit = tb_null;
+        priv->priv = tb_null;
+    }
+
+    // exit stats
+    if (worker->stats) tb_hash_map_exit(worker->stats);
+    worker->stats = tb_null;
+
+    // exit jobs
+    if (worker->jobs) tb_vector_exit(worker->jobs);
+    worker->jobs = tb_null;
+}
 static tb_int_t tb_thread_pool_worker_loop(tb_cpointer_t priv)
 {
     // the worker
@@ -566,17 +694,38 @@ static tb_int_t tb_thread_pool_worker_loop(tb_cpointer_t priv)
                     tb_trace_d("worker[%lu]: done: task[%p:%s]: time: %lld ms, average: %lld ms, count: %lu", worker->id, job->task.done, job->task.name, time, (total_time / (tb_hize_t)done_count), done_count);
 #endif
 
+                    // exit the job now, the finished job may be cleaned from the pending jobs too late
+                    tb_thread_pool_job_exit_func(worker, job);
+
                     // update the job state
                     tb_atomic_set(&job->state, TB_STATE_FINISHED);
                 }
                 // the job is killing? work it
                 else if (state == TB_STATE_KILLING)
                 {
+                    // exit the job now
+                    tb_thread_pool_job_exit_func(worker, job);
+
                     // update the job state
                     tb_atomic_set(&job->state, TB_STATE_KILLED);
                 }
             }
 
+            // enter
+            tb_spinlock_enter(&impl->lock);
+
+            // release the working jobs
+            tb_for_all (tb_thread_pool_job_t*, working, worker->jobs)
+            {
+                // refn--
+                if (working->refn > 1) working->refn--;
+                // remove it from pool directly
+                else tb_fixed_pool_free(impl->jobs_pool, working);
+            }
+
+            // leave
+            tb_spinlock_leave(&impl->lock);
+
             // clear jobs
             tb_vector_clear(worker->jobs);
         }
@@ -584,39 +733,442 @@ static tb_int_t tb_thread_pool_worker_loop(tb_cpointer_t priv)
     } while (0);
 
     // exit worker
+    if (worker) tb_thread_pool_worker_exit(worker);
+
+    // exit
+    return 0;
+}
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * work-stealing implementation
+ */
+
+/* load the position of deque or the counter
+ *
+ * tb_atomic_get() will lock the cache line for writing (cmpxchg), it is too slow for polling
+ */
+static __tb_inline__ tb_long_t tb_thread_pool_load(tb_atomic_t* a)
+{
+#ifdef __ATOMIC_SEQ_CST
+    return (tb_long_t)__atomic_load_n(a, __ATOMIC_SEQ_CST);
+#else
+    return tb_atomic_get(a);
+#endif
+}
+
+// store the position of deque
+static __tb_inline__ tb_void_t tb_thread_pool_store(tb_atomic_t* a, tb_long_t v)
+{
+#ifdef __ATOMIC_SEQ_CST
+    __atomic_store_n(a, v, __ATOMIC_SEQ_CST);
+#else
+    tb_atomic_set(a, v);
+#endif
+}
+static __tb_inline__ tb_long_t tb_thread_pool_deque_size(tb_thread_pool_deque_t* deque)
+{
+    // the jobs count, it is only a snapshot for the other workers
+    tb_long_t size = tb_thread_pool_load(&deque->bottom) - tb_thread_pool_load(&deque->top);
+    return size > 0? size : 0;
+}
+static tb_bool_t tb_thread_pool_deque_push(tb_thread_pool_deque_t* deque, tb_thread_pool_job_t* job)
+{
+    // check
+    tb_assert(deque && deque->data && job);
+
+    // the bottom is only modified by the owner
+    tb_long_t bottom    = (tb_long_t)deque->bottom;
+    tb_long_t top       = tb_thread_pool_load(&deque->top);
+
+    // full?
+    tb_check_return_val(bottom - top < TB_THREAD_POOL_DEQUE_MAXN, tb_false);
+
+    // push it to the bottom
+    deque->data[bottom & (TB_THREAD_POOL_DEQUE_MAXN - 1)] = job;
+    tb_thread_pool_store(&deque->bottom, bottom + 1);
+
+    // ok
+    return tb_true;
+}
+static tb_thread_pool_job_t* tb_thread_pool_deque_pop(tb_thread_pool_deque_t* deque)
+{
+    // check
+    tb_assert(deque && deque->data);
+
+    // reserve the bottom job first
+    tb_long_t bottom = (tb_long_t)deque->bottom - 1;
+    tb_thread_pool_store(&deque->bottom, bottom);
+
+    // null? restore the bottom
+    tb_long_t top = tb_thread_pool_load(&deque->top);
+    if (top > bottom)
+    {
+        tb_thread_pool_store(&deque->bottom, bottom + 1);
+        return tb_null;
+    }
+
+    // get the bottom job
+    tb_thread_pool_job_t* job = deque->data[bottom & (TB_THREAD_POOL_DEQUE_MAXN - 1)];
+
+    // the last job? we need race with the stealers
+    if (top == bottom)
+    {
+        if (tb_atomic_fetch_and_pset(&deque->top, top, top + 1) != top) job = tb_null;
+        tb_thread_pool_store(&deque->bottom, bottom + 1);
+    }
+
+    // ok?
+    return job;
+}
+static tb_thread_pool_job_t* tb_thread_pool_deque_steal(tb_thread_pool_deque_t* deque)
+{
+    // check
+    tb_assert(deque && deque->data);
+
+    // null?
+    tb_long_t top       = tb_thread_pool_load(&deque->top);
+    tb_long_t bottom    = tb_thread_pool_load(&deque->bottom);
+    tb_check_return_val(top < bottom, tb_null);
+
+    // get the top job
+    tb_thread_pool_job_t* job = deque->data[top & (TB_THREAD_POOL_DEQUE_MAXN - 1)];
+
+    // steal it, it may be taken by the owner or the other stealers
+    return tb_atomic_fetch_and_pset(&deque->top, top, top + 1) == top? job : tb_null;
+}
+static tb_thread_pool_job_t* tb_thread_pool_stealing_job(tb_thread_pool_impl_t* impl, tb_thread_pool_task_t const* task, tb_size_t refn)
+{
+    // check
+    tb_assert_and_check_return_val(impl && task && task->done, tb_null);
+
+    // make job
+    tb_thread_pool_job_t* job = tb_malloc0_type(tb_thread_pool_job_t);
+    tb_assert_and_check_return_val(job, tb_null);
+
+    // init job
+    job->refn   = refn;
+    job->state  = TB_STATE_WAITING;
+    job->task   = *task;
+    job->epoch  = tb_thread_pool_load(&impl->epoch);
+
+    // update the alive jobs count
+    tb_atomic_fetch_and_inc(&impl->jobs_count);
+
+    // trace
+    tb_trace_d("task[%p:%s]: post: ..", task->done, task->name);
+
+    // ok
+    return job;
+}
+static tb_void_t tb_thread_pool_stealing_job_exit(tb_thread_pool_job_t* job)
+{
+    // check
+    tb_assert(job);
+
+    // free it if no more references
+    if (tb_atomic_fetch_and_dec(&job->refn) == 1) tb_free(job);
+}
+static tb_void_t tb_thread_pool_stealing_wake(tb_thread_pool_impl_t* impl, tb_size_t count)
+{
+    // check
+    tb_assert(impl);
+
+    // wake up the idle workers
+    tb_long_t idle = tb_thread_pool_load(&impl->idle);
+    if (idle > 0 && count) tb_thread_pool_worker_post(impl, tb_min(count, (tb_size_t)idle));
+}
+static tb_bool_t tb_thread_pool_stealing_has_jobs(tb_thread_pool_impl_t* impl)
+{
+    // check
+    tb_assert(impl);
+
+    // exists jobs in the injection queue?
+    if (tb_thread_pool_load(&impl->jobs_inject) > 0) return tb_true;
+
+    // exists jobs in the deques of workers?
+    tb_size_t i = 0;
+    tb_size_t n = impl->worker_size;
+    for (i = 0; i < n; i++)
+    {
+        if (tb_thread_pool_deque_size(&impl->worker_list[i].deque)) 
+            return tb_true;
+    }
+
+    // no jobs
+    return tb_false;
+}
+static tb_size_t tb_thread_pool_stealing_post(tb_thread_pool_impl_t* impl, tb_thread_pool_task_t const* list, tb_size_t size, tb_thread_pool_job_t** pjob)
+{
+    // check
+    tb_assert_and_check_return_val(impl && list && size, 0);
+
+    // the current worker of this pool
+    tb_thread_pool_worker_t* worker = (tb_thread_pool_worker_t*)tb_thread_local_get(&s_thread_pool_worker);
+    if (worker && worker->pool != (tb_thread_pool_ref_t)impl) worker = tb_null;
+
+    // post jobs to the deque of the current worker directly, the other idle workers will steal them
+    tb_size_t               ok = 0;
+    tb_thread_pool_job_t*   job = tb_null;
     if (worker)
     {
-        // trace
-        tb_trace_d("worker[%lu]: exit", worker->id);
+        // stoped?
+        tb_check_return_val(!tb_atomic_get(&worker->bstoped), 0);
 
-        // stoped
-        tb_atomic_set(&worker->bstoped, 1);
+        // post jobs
+        for (ok = 0; ok < size; ok++)
+        {
+            // make job, the alive jobs count will be not zero because this worker is running
+            job = tb_thread_pool_stealing_job(impl, &list[ok], pjob? 2 : 1);
+            tb_assert_and_check_break(job);
 
-        // exit all private data
-        tb_size_t i = 0;
-        tb_size_t n = tb_arrayn(worker->priv);
-        for (i = 0; i < n; i++)
+            // full? post it to the injection queue
+            if (!tb_thread_pool_deque_push(&worker->deque, job))
+            {
+                tb_spinlock_enter(&impl->lock);
+                if (list[ok].urgent) tb_list_entry_insert_head(&impl->jobs_urgent, &job->entry);
+                else tb_list_entry_insert_tail(&impl->jobs_waiting, &job->entry);
+                tb_atomic_fetch_and_inc(&impl->jobs_inject);
+                tb_spinlock_leave(&impl->lock);
+            }
+        }
+    }
+    // post jobs to the injection queue
+    else
+    {
+        // enter
+        tb_spinlock_enter(&impl->lock);
+
+        /* post jobs
+         *
+         * we need update the alive jobs count in the lock, 
+         * so the stopped workers will not exit before handling these jobs
+         */
+        if (!impl->bstoped)
         {
-            // the private data
-            tb_thread_pool_worker_priv_t* priv = &worker->priv[n - i - 1];
+            for (ok = 0; ok < size; ok++)
+            {
+                // make job
+                job = tb_thread_pool_stealing_job(impl, &list[ok], pjob? 2 : 1);
+                tb_assert_and_check_break(job);
 
-            // exit it
-            if (priv->exit) priv->exit((tb_thread_pool_worker_ref_t)worker, priv->priv);
+                // post the urgent job to the head 
+                if (list[ok].urgent) tb_list_entry_insert_head(&impl->jobs_urgent, &job->entry);
+                else tb_list_entry_insert_tail(&impl->jobs_waiting, &job->entry);
+            }
+            if (ok) tb_atomic_fetch_and_add(&impl->jobs_inject, ok);
+        }
+
+        // leave
+        tb_spinlock_leave(&impl->lock);
+    }
+
+    // wake up the idle workers
+    tb_thread_pool_stealing_wake(impl, ok);
+
+    // save the last job
+    if (pjob) *pjob = ok? job : tb_null;
+
+    // ok?
+    return ok;
+}
+static tb_thread_pool_job_t* tb_thread_pool_stealing_pull(tb_thread_pool_impl_t* impl, tb_thread_pool_worker_t* worker)
+{
+    // check
+    tb_assert(impl && worker);
+
+    // no jobs in the injection queue?
+    tb_check_return_val(tb_thread_pool_load(&impl->jobs_inject) > 0, tb_null);
+
+    // enter
+    tb_spinlock_enter(&impl->lock);
+
+    // pull jobs from the urgent and waiting jobs
+    tb_size_t               count = 0;
+    tb_thread_pool_job_t*   jobs[TB_THREAD_POOL_INJECT_PULL_MAXN];
+    while (count < tb_arrayn(jobs))
+    {
+        // the urgent or waiting jobs
+        tb_list_entry_head_ref_t list = tb_null;
+        if (tb_list_entry_size(&impl->jobs_urgent)) list = &impl->jobs_urgent;
+        else if (tb_list_entry_size(&impl->jobs_waiting)) list = &impl->jobs_waiting;
+        tb_check_break(list);
+
+        // pull the head job
+        tb_list_entry_ref_t entry = tb_list_entry_head(list);
+        tb_list_entry_remove_head(list);
+        jobs[count++] = (tb_thread_pool_job_t*)tb_list_entry(list, entry);
+    }
+    if (count) tb_atomic_fetch_and_sub(&impl->jobs_inject, count);
+
+    // leave
+    tb_spinlock_leave(&impl->lock);
+
+    // trace
+    tb_trace_d("worker[%lu]: pull: %lu jobs from injection", worker->id, count);
+
+    /* push the other jobs to the deque of this worker, it is null now
+     *
+     * we push them in the reverse order, so the next popped job is the next posted job
+     */
+    tb_size_t i = count;
+    while (i > 1)
+    {
+        // push it
+        tb_bool_t ok = tb_thread_pool_deque_push(&worker->deque, jobs[--i]);
+        tb_assert(ok); tb_used(ok);
+    }
 
-            // clear it
-            priv->exit = tb_null;
-            priv->priv = tb_null;
+    // return the first job
+    return count? jobs[0] : tb_null;
+}
+static tb_thread_pool_job_t* tb_thread_pool_stealing_steal(tb_thread_pool_impl_t* impl, tb_thread_pool_worker_t* worker)
+{
+    // check
+    tb_assert(impl && worker);
+
+    // steal jobs from the other workers, starting from the last victim
+    tb_size_t i = 0;
+    tb_size_t n = impl->worker_size;
+    for (i = 0; i < n; i++)
+    {
+        // the victim worker
+        tb_size_t victim = (worker->victim + i) % n;
+        tb_check_continue(victim != worker->id);
+
+        // steal it
+        tb_thread_pool_job_t* job = tb_thread_pool_deque_steal(&impl->worker_list[victim].deque);
+        if (job)
+        {
+            // trace
+            tb_trace_d("worker[%lu]: steal: task[%p:%s] from worker[%lu]", worker->id, job->task.done, job->task.name, victim);
+
+            // save the victim, we will continue to steal jobs from it next time
+            worker->victim = victim;
+            return job;
         }
+    }
+
+    // no jobs
+    return tb_null;
+}
+static tb_void_t tb_thread_pool_stealing_done(tb_thread_pool_impl_t* impl, tb_thread_pool_worker_t* worker, tb_thread_pool_job_t* job)
+{
+    // check
+    tb_assert(impl && worker && job && job->task.done);
 
-        // exit stats
-        if (worker->stats) tb_hash_map_exit(worker->stats);
-        worker->stats = tb_null;
+    // it has been killed by tb_thread_pool_task_kill_all() or tb_thread_pool_kill()?
+    if (job->epoch != tb_thread_pool_load(&impl->epoch)) 
+        tb_atomic_pset(&job->state, TB_STATE_WAITING, TB_STATE_KILLING);
+
+    // the job state
+    tb_size_t state = tb_atomic_fetch_and_pset(&job->state, TB_STATE_WAITING, TB_STATE_WORKING);
+
+    // the job is waiting? work it
+    if (state == TB_STATE_WAITING)
+    {
+        // trace
+        tb_trace_d("worker[%lu]: done: task[%p:%s]: ..", worker->id, job->task.done, job->task.name);
 
-        // exit jobs
-        if (worker->jobs) tb_vector_exit(worker->jobs);
-        worker->jobs = tb_null;
+        // done the job
+        job->task.done((tb_thread_pool_worker_ref_t)worker, job->task.priv);
+
+        // update the job state
+        tb_atomic_set(&job->state, TB_STATE_FINISHED);
+    }
+    // the job is killing? 
+    else if (state == TB_STATE_KILLING)
+    {
+        // update the job state
+        tb_atomic_set(&job->state, TB_STATE_KILLED);
     }
 
+    // exit the job
+    if (job->task.exit) job->task.exit((tb_thread_pool_worker_ref_t)worker, job->task.priv);
+
+    // update the alive jobs count
+    tb_atomic_fetch_and_dec(&impl->jobs_count);
+
+    // exit the job reference
+    tb_thread_pool_stealing_job_exit(job);
+}
+static tb_int_t tb_thread_pool_worker_loop_stealing(tb_cpointer_t priv)
+{
+    // the worker
+    tb_thread_pool_worker_t* worker = (tb_thread_pool_worker_t*)priv;
+
+    // trace
+    tb_trace_d("worker[%lu]: init", worker? worker->id : -1);
+
+    // done
+    do
+    {
+        // check
+        tb_assert_and_check_break(worker && worker->deque.data);
+
+        // the pool
+        tb_thread_pool_impl_t* impl = (tb_thread_pool_impl_t*)worker->pool;
+        tb_assert_and_check_break(impl && impl->semaphore);
+
+        // bind this worker to the current thread
+        if (!tb_thread_local_set(&s_thread_pool_worker, worker)) break;
+
+        // loop
+        while (1)
+        {
+            // pop job from the deque of this worker first, then pull it from the injection queue or steal it from the other workers
+            tb_thread_pool_job_t* job = tb_thread_pool_deque_pop(&worker->deque);
+            if (!job) job = tb_thread_pool_stealing_pull(impl, worker);
+            if (!job) job = tb_thread_pool_stealing_steal(impl, worker);
+            if (job)
+            {
+                // wake up an idle worker to steal the remaining jobs
+                if (tb_thread_pool_load(&impl->idle) > 0 && (tb_thread_pool_deque_size(&worker->deque) || tb_thread_pool_load(&impl->jobs_inject) > 0))
+                    tb_thread_pool_worker_post(impl, 1);
+
+                // done it
+                tb_thread_pool_stealing_done(impl, worker, job);
+                continue;
+            }
+
+            // stoped and no more alive jobs? exit it
+            tb_bool_t stoped = (tb_bool_t)tb_atomic_get(&worker->bstoped);
+            if (stoped && !tb_thread_pool_load(&impl->jobs_count)) break;
+
+            // mark this worker as idle
+            tb_atomic_fetch_and_inc(&impl->idle);
+
+            // check jobs again, some jobs may be posted before marking it as idle
+            if (tb_thread_pool_stealing_has_jobs(impl))
+            {
+                tb_atomic_fetch_and_dec(&impl->idle);
+                continue;
+            }
+
+            // trace
+            tb_trace_d("worker[%lu]: wait: ..", worker->id);
+
+            /* wait some time, we need check the alive jobs count periodically if be stoped
+             *
+             * the stoped worker does not wait the semaphore, otherwise it may consume the posted semaphore
+             * of the other worker which has been waiting before being killed, and this worker will never be waked up
+             */
+            tb_long_t wait = 0;
+            if (stoped) tb_msleep(10);
+            else wait = tb_semaphore_wait(impl->semaphore, -1);
+
+            // mark this worker as busy
+            tb_atomic_fetch_and_dec(&impl->idle);
+            tb_assert_and_check_break(wait >= 0);
+        }
+
+        // unbind this worker
+        tb_thread_local_set(&s_thread_pool_worker, tb_null);
+
+    } while (0);
+
+    // exit worker
+    if (worker) tb_thread_pool_worker_exit(worker);
+
     // exit
     return 0;
 }
@@ -756,6 +1308,10 @@ tb_thread_pool_ref_t tb_thread_pool()
     return (tb_thread_pool_ref_t)tb_singleton_instance(TB_SINGLETON_TYPE_THREAD_POOL, tb_thread_pool_instance_init, tb_thread_pool_instance_exit, tb_thread_pool_instance_kill, tb_null);
 }
 tb_thread_pool_ref_t tb_thread_pool_init(tb_size_t worker_maxn, tb_size_t stack)
+{
+    return tb_thread_pool_init_with_flags(worker_maxn, stack, TB_THREAD_POOL_FLAG_NONE);
+}
+tb_thread_pool_ref_t tb_thread_pool_init_with_flags(tb_size_t worker_maxn, tb_size_t stack, tb_size_t flags)
 {
     // done
     tb_bool_t               ok = tb_false;
@@ -769,20 +1325,29 @@ tb_thread_pool_ref_t tb_thread_pool_init(tb_size_t worker_maxn, tb_size_t stack)
         // init lock
         if (!tb_spinlock_init(&impl->lock)) break;
 
+        // the work-stealing mode?
+        tb_bool_t stealing = (flags & TB_THREAD_POOL_FLAG_WORK_STEALING)? tb_true : tb_false;
+
         // computate the default worker maxn if be zero
-        if (!worker_maxn) worker_maxn = tb_processor_count() << 2;
+        if (!worker_maxn) worker_maxn = stealing? tb_processor_count() : (tb_processor_count() << 2);
         tb_assert_and_check_break(worker_maxn);
 
         // init thread stack
         impl->stack         = stack;
 
+        // init flags
+        impl->flags         = flags;
+
         // init workers
         impl->worker_size   = 0;
-        impl->worker_maxn   = worker_maxn;
+        impl->worker_maxn   = stealing? tb_min(worker_maxn, TB_THREAD_POOL_WORKER_MAXN) : worker_maxn;
 
-        // init jobs pool
-        impl->jobs_pool     = tb_fixed_pool_init(tb_null, TB_THREAD_POOL_JOBS_POOL_GROW, sizeof(tb_thread_pool_job_t), tb_null, tb_null, tb_null);
-        tb_assert_and_check_break(impl->jobs_pool);
+        // init jobs pool, the jobs will be allocated from the allocator directly for the work-stealing mode
+        if (!stealing)
+        {
+            impl->jobs_pool = tb_fixed_pool_init(tb_null, TB_THREAD_POOL_JOBS_POOL_GROW, sizeof(tb_thread_pool_job_t), tb_null, tb_null, tb_null);
+            tb_assert_and_check_break(impl->jobs_pool);
+        }
 
         // init jobs urgent
         tb_list_entry_init(&impl->jobs_urgent, tb_thread_pool_job_t, entry, tb_null);
@@ -802,6 +1367,41 @@ tb_thread_pool_ref_t tb_thread_pool_init(tb_size_t worker_maxn, tb_size_t stack)
         tb_lock_profiler_register(tb_lock_profiler(), (tb_pointer_t)&impl->lock, TB_TRACE_MODULE_NAME);
 #endif
 
+        // start all workers for the work-stealing mode
+        if (stealing)
+        {
+            // init the current worker local
+            if (!tb_thread_local_init(&s_thread_pool_worker, tb_null)) break;
+
+            // init workers and deques first, the other workers will steal jobs from them
+            tb_size_t i = 0;
+            for (i = 0; i < impl->worker_maxn; i++)
+            {
+                // the worker 
+                tb_thread_pool_worker_t* worker = &impl->worker_list[i];
+
+                // init worker
+                worker->id          = i;
+                worker->pool        = (tb_thread_pool_ref_t)impl;
+                worker->victim      = (i + 1) % impl->worker_maxn;
+                worker->deque.data  = tb_nalloc0_type(TB_THREAD_POOL_DEQUE_MAXN, tb_thread_pool_job_t*);
+                tb_assert_and_check_break(worker->deque.data);
+            }
+            tb_check_break(i == impl->worker_maxn);
+
+            // update the worker size
+            impl->worker_size = impl->worker_maxn;
+
+            // start workers
+            for (i = 0; i < impl->worker_size; i++)
+            {
+                tb_thread_pool_worker_t* worker = &impl->worker_list[i];
+                worker->loop = tb_thread_init(__tb_lstring__("thread_pool"), tb_thread_pool_worker_loop_stealing, worker, impl->stack);
+                tb_assert_and_check_break(worker->loop);
+            }
+            tb_check_break(i == impl->worker_size);
+        }
+
         // ok
         ok = tb_true;
 
@@ -864,6 +1464,17 @@ tb_bool_t tb_thread_pool_exit(tb_thread_pool_ref_t pool)
             worker->loop = tb_null;
         }
     }
+
+    // exit all deques after all workers have been exited, the stopped worker may be still stealing jobs from them
+    for (i = 0; i < n; i++) 
+    {
+        // the worker
+        tb_thread_pool_worker_t* worker = &impl->worker_list[i];
+
+        // exit deque
+        if (worker->deque.data) tb_free(worker->deque.data);
+        worker->deque.data = tb_null;
+    }
     impl->worker_size = 0;
 
     // enter
@@ -927,6 +1538,7 @@ tb_void_t tb_thread_pool_kill(tb_thread_pool_ref_t pool)
 
         // kill all jobs
         if (impl->jobs_pool) tb_fixed_pool_walk(impl->jobs_pool, tb_thread_pool_jobs_walk_kill_all, tb_null);
+        else tb_atomic_fetch_and_inc(&impl->epoch);
 
         // post it
         post = impl->worker_size;
@@ -985,7 +1597,7 @@ tb_size_t tb_thread_pool_task_size(tb_thread_pool_ref_t pool)
     tb_spinlock_enter(&impl->lock);
 
     // the task size
-    tb_size_t task_size = impl->jobs_pool? tb_fixed_pool_size(impl->jobs_pool) : 0;
+    tb_size_t task_size = impl->jobs_pool? tb_fixed_pool_size(impl->jobs_pool) : (tb_size_t)tb_thread_pool_load(&impl->jobs_count);
 
     // leave
     tb_spinlock_leave(&impl->lock);
@@ -999,6 +1611,21 @@ tb_bool_t tb_thread_pool_task_post(tb_thread_pool_ref_t pool, tb_char_t const* n
     tb_thread_pool_impl_t* impl = (tb_thread_pool_impl_t*)pool;
     tb_assert_and_check_return_val(impl && done, tb_false);
 
+    // the work-stealing mode?
+    if (impl->flags & TB_THREAD_POOL_FLAG_WORK_STEALING)
+    {
+        // init task
+        tb_thread_pool_task_t task = {0};
+        task.name       = name;
+        task.done       = done;
+        task.exit       = exit;
+        task.priv       = priv;
+        task.urgent     = urgent;
+
+        // post task
+        return tb_thread_pool_stealing_post(impl, &task, 1, tb_null) == 1;
+    }
+
     // init the post size
     tb_size_t post_size = 0;
 
@@ -1044,6 +1671,10 @@ tb_size_t tb_thread_pool_task_post_list(tb_thread_pool_ref_t pool, tb_thread_poo
     tb_thread_pool_impl_t* impl = (tb_thread_pool_impl_t*)pool;
     tb_assert_and_check_return_val(impl && list, 0);
 
+    // post task list for the work-stealing mode
+    if (impl->flags & TB_THREAD_POOL_FLAG_WORK_STEALING) 
+        return size? tb_thread_pool_stealing_post(impl, list, size, tb_null) : 0;
+
     // init the post size
     tb_size_t post_size = 0;
 
@@ -1077,6 +1708,23 @@ tb_thread_pool_task_ref_t tb_thread_pool_task_init(tb_thread_pool_ref_t pool, tb
     tb_thread_pool_impl_t* impl = (tb_thread_pool_impl_t*)pool;
     tb_assert_and_check_return_val(impl && done, tb_null);
 
+    // the work-stealing mode?
+    if (impl->flags & TB_THREAD_POOL_FLAG_WORK_STEALING)
+    {
+        // init task
+        tb_thread_pool_task_t task = {0};
+        task.name       = name;
+        task.done       = done;
+        task.exit       = exit;
+        task.priv       = priv;
+        task.urgent     = urgent;
+
+        // post task and keep the job reference
+        tb_thread_pool_job_t* job = tb_null;
+        tb_thread_pool_stealing_post(impl, &task, 1, &job);
+        return (tb_thread_pool_task_ref_t)job;
+    }
+
     // init the post size
     tb_size_t post_size = 0;
 
@@ -1144,8 +1792,11 @@ tb_void_t tb_thread_pool_task_kill_all(tb_thread_pool_ref_t pool)
     tb_spinlock_enter(&impl->lock);
 
     // kill all jobs
-    if (!impl->bstoped && impl->jobs_pool) 
-        tb_fixed_pool_walk(impl->jobs_pool, tb_thread_pool_jobs_walk_kill_all, tb_null);
+    if (!impl->bstoped)
+    {
+        if (impl->jobs_pool) tb_fixed_pool_walk(impl->jobs_pool, tb_thread_pool_jobs_walk_kill_all, tb_null);
+        else tb_atomic_fetch_and_inc(&impl->epoch);
+    }
 
     // leave
     tb_spinlock_leave(&impl->lock);
@@ -1188,7 +1839,7 @@ tb_long_t tb_thread_pool_task_wait_all(tb_thread_pool_ref_t pool, tb_long_t time
         tb_spinlock_enter(&impl->lock);
 
         // the jobs count
-        size = impl->jobs_pool? tb_fixed_pool_size(impl->jobs_pool) : 0;
+        size = impl->jobs_pool? tb_fixed_pool_size(impl->jobs_pool) : (tb_size_t)tb_thread_pool_load(&impl->jobs_count);
 
         // trace
         tb_trace_d("wait: jobs: %lu, waiting: %lu, pending: %lu, urgent: %lu: .."
@@ -1227,6 +1878,13 @@ tb_void_t tb_thread_pool_task_exit(tb_thread_pool_ref_t pool, tb_thread_pool_tas
     // kill it first
     tb_thread_pool_task_kill(pool, task);
 
+    // exit the job reference for the work-stealing mode
+    if (impl->flags & TB_THREAD_POOL_FLAG_WORK_STEALING)
+    {
+        tb_thread_pool_stealing_job_exit(job);
+        return ;
+    }
+
     // enter
     tb_spinlock_enter(&impl->lock);
 
@@ -1279,6 +1937,11 @@ tb_void_t tb_thread_pool_dump(tb_thread_pool_ref_t pool)
             // dump jobs
             tb_fixed_pool_walk(impl->jobs_pool, tb_thread_pool_jobs_walk_dump_all, tb_null);
         }
+        else
+        {
+            // trace
+            tb_trace_i("jobs: size: %ld, injection: %ld, idle workers: %ld", tb_thread_pool_load(&impl->jobs_count), tb_thread_pool_load(&impl->jobs_inject), tb_thread_pool_load(&impl->idle));
+        }
     }
 
     // leave
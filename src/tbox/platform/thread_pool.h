@@ -51,6 +51,24 @@ __tb_extern_c_enter__
  * types
  */
 
+/// the thread pool flag enum
+typedef enum __tb_thread_pool_flag_e
+{
+    TB_THREAD_POOL_FLAG_NONE            = 0
+
+    /*! the work-stealing mode
+     *
+     * each worker has its own lock-free deque (Chase-Lev) and the idle workers will steal jobs from the other workers,
+     * the tasks posted from the outside of workers will be pushed to the global injection queue,
+     * and the tasks posted from the worker will be pushed to the deque of this worker directly.
+     *
+     * all workers will be started when initing the thread pool, 
+     * and the default worker count is the processor count.
+     */
+,   TB_THREAD_POOL_FLAG_WORK_STEALING   = 1
+
+}tb_thread_pool_flag_e;
+
 /// the thread pool ref type
 typedef __tb_typeref__(thread_pool);
 
@@ -108,6 +126,20 @@ tb_thread_pool_ref_t        tb_thread_pool(tb_noarg_t);
  */
 tb_thread_pool_ref_t        tb_thread_pool_init(tb_size_t worker_maxn, tb_size_t stack);
 
+/*! init thread pool with the given flags
+ *
+ * @code
+ * tb_thread_pool_ref_t pool = tb_thread_pool_init_with_flags(0, 0, TB_THREAD_POOL_FLAG_WORK_STEALING);
+ * @endcode
+ *
+ * @param worker_maxn       the thread worker max count, using the default count
+ * @param stack             the thread stack, using the default stack size if be zero 
+ * @param flags             the thread pool flags, e.g. TB_THREAD_POOL_FLAG_WORK_STEALING
+ *
+ * @return                  the thread pool 
+ */
+tb_thread_pool_ref_t        tb_thread_pool_init_with_flags(tb_size_t worker_maxn, tb_size_t stack, tb_size_t flags);
+
 /*! exit thread pool
  *
  * @param pool              the thread pool 
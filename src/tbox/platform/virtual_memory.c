@@ -0,0 +1,82 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        virtual_memory.c
+ * @ingroup     platform
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * trace
+ */
+#define TB_TRACE_MODULE_NAME            "virtual_memory"
+#define TB_TRACE_MODULE_DEBUG           (0)
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+#include "virtual_memory.h"
+#ifdef TB_CONFIG_OS_WINDOWS
+#   include "windows/virtual_memory.c"
+#elif defined(TB_CONFIG_POSIX_HAVE_MMAP)
+#   include "posix/virtual_memory.c"
+#else
+tb_pointer_t tb_virtual_memory_reserve(tb_size_t size)
+{
+    return tb_null;
+}
+tb_pointer_t tb_virtual_memory_reserve_align(tb_size_t size, tb_size_t align)
+{
+    return tb_null;
+}
+tb_bool_t tb_virtual_memory_release(tb_pointer_t data, tb_size_t size)
+{
+    tb_trace_noimpl();
+    return tb_false;
+}
+tb_bool_t tb_virtual_memory_commit(tb_pointer_t data, tb_size_t size)
+{
+    tb_trace_noimpl();
+    return tb_false;
+}
+tb_bool_t tb_virtual_memory_decommit(tb_pointer_t data, tb_size_t size)
+{
+    tb_trace_noimpl();
+    return tb_false;
+}
+tb_bool_t tb_virtual_memory_guard(tb_pointer_t data, tb_size_t size)
+{
+    tb_trace_noimpl();
+    return tb_false;
+}
+tb_size_t tb_virtual_memory_resident(tb_pointer_t data, tb_size_t size)
+{
+    return size;
+}
+tb_bool_t tb_virtual_memory_advise(tb_pointer_t data, tb_size_t size, tb_size_t advice)
+{
+    return tb_false;
+}
+tb_bool_t tb_virtual_memory_bind(tb_pointer_t data, tb_size_t size, tb_size_t node)
+{
+    return tb_false;
+}
+#endif
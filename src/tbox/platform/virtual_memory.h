@@ -0,0 +1,160 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        virtual_memory.h
+ * @ingroup     platform
+ *
+ */
+#ifndef TB_PLATFORM_VIRTUAL_MEMORY_H
+#define TB_PLATFORM_VIRTUAL_MEMORY_H
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_enter__
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * types
+ */
+
+/// the virtual memory advice enum
+typedef enum __tb_virtual_memory_advice_e
+{
+    TB_VIRTUAL_MEMORY_ADVICE_NORMAL     = 0 //!< no special treatment
+,   TB_VIRTUAL_MEMORY_ADVICE_HUGEPAGE   = 1 //!< back these pages by the transparent huge pages if possible
+,   TB_VIRTUAL_MEMORY_ADVICE_FREE       = 2 //!< these pages are not used now and the system can reclaim them lazily
+,   TB_VIRTUAL_MEMORY_ADVICE_DONTNEED   = 3 //!< these pages are not used now and their physical memory will be returned to the system immediately
+
+}tb_virtual_memory_advice_e;
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * interfaces
+ */
+
+/*! reserve the virtual address space
+ *
+ * the reserved pages are not accessible and do not use any physical memory
+ * until they are committed
+ *
+ * @param size          the size, must be aligned by the page size
+ *
+ * @return              the address of the reserved pages, tb_null if not supported or failed
+ */
+tb_pointer_t            tb_virtual_memory_reserve(tb_size_t size);
+
+/*! reserve the virtual address space which is aligned by the given alignment
+ *
+ * @param size          the size, must be aligned by the page size
+ * @param align         the alignment, must be the power of 2 and be aligned by the page size
+ *
+ * @return              the address of the reserved pages, tb_null if not supported or failed
+ */
+tb_pointer_t            tb_virtual_memory_reserve_align(tb_size_t size, tb_size_t align);
+
+/*! release the reserved virtual address space
+ *
+ * @param data          the address of the reserved pages
+ * @param size          the reserved size
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_virtual_memory_release(tb_pointer_t data, tb_size_t size);
+
+/*! commit the reserved pages as readable and writable 
+ *
+ * @note the physical memory will be allocated lazily when these pages are touched first
+ *
+ * @param data          the address of the pages, must be aligned by the page size
+ * @param size          the size, must be aligned by the page size
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_virtual_memory_commit(tb_pointer_t data, tb_size_t size);
+
+/*! decommit the committed pages and return their physical memory to the system
+ *
+ * the pages will be not accessible, but their address space is still reserved
+ *
+ * @param data          the address of the pages, must be aligned by the page size
+ * @param size          the size, must be aligned by the page size
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_virtual_memory_decommit(tb_pointer_t data, tb_size_t size);
+
+/*! make the committed pages not accessible as the guard pages
+ *
+ * it will not split the memory mapping if the system supports the lightweight guard regions (linux >= 6.13), 
+ * so the adjacent mappings can still be merged and it will not exhaust the mappings limit (vm.max_map_count).
+ *
+ * @param data          the address of the pages, must be aligned by the page size
+ * @param size          the size, must be aligned by the page size
+ *
+ * @return              tb_true or tb_false
+ */
+tb_bool_t               tb_virtual_memory_guard(tb_pointer_t data, tb_size_t size);
+
+/*! get the resident size of the given pages in the physical memory
+ *
+ * @param data          the address of the pages, must be aligned by the page size
+ * @param size          the size, must be aligned by the page size
+ *
+ * @return              the resident size, returns the committed size if cannot be computed
+ */
+tb_size_t               tb_virtual_memory_resident(tb_pointer_t data, tb_size_t size);
+
+/*! give the advice about the usage of the committed pages
+ *
+ * TB_VIRTUAL_MEMORY_ADVICE_FREE and TB_VIRTUAL_MEMORY_ADVICE_DONTNEED will keep these pages accessible, 
+ * but their data may be discarded (be zero) until they are written again.
+ *
+ * @param data          the address of the pages, must be aligned by the page size
+ * @param size          the size, must be aligned by the page size
+ * @param advice        the advice, .e.g TB_VIRTUAL_MEMORY_ADVICE_HUGEPAGE
+ *
+ * @return              tb_true or tb_false if not supported or failed
+ */
+tb_bool_t               tb_virtual_memory_advise(tb_pointer_t data, tb_size_t size, tb_size_t advice);
+
+/*! bind the pages to the given numa node
+ *
+ * the physical memory of these pages will be allocated from this node first,
+ * and it will fallback to the other nodes if this node has no free memory.
+ *
+ * @param data          the address of the pages, must be aligned by the page size
+ * @param size          the size, must be aligned by the page size
+ * @param node          the numa node, .e.g tb_processor_node()
+ *
+ * @return              tb_true or tb_false if not supported or failed
+ */
+tb_bool_t               tb_virtual_memory_bind(tb_pointer_t data, tb_size_t size, tb_size_t node);
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * extern
+ */
+__tb_extern_c_leave__
+
+#endif
@@ -44,5 +44,10 @@ tb_size_t tb_processor_count()
     // the processor count
     return (tb_size_t)info.dwNumberOfProcessors? info.dwNumberOfProcessors : 1;
 }
+tb_long_t tb_processor_node()
+{
+    // TODO: GetNumaProcessorNode() is not supported on the old windows
+    return -1;
+}
 
 
@@ -0,0 +1,140 @@
+/*!The Treasure Box Library
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * 
+ * Copyright (C) 2009 - 2017, TBOOX Open Source Group.
+ *
+ * @author      ruki
+ * @file        virtual_memory.c
+ *
+ */
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * includes
+ */
+#include "prefix.h"
+#include "../platform.h"
+
+/* //////////////////////////////////////////////////////////////////////////////////////
+ * implementation
+ */
+tb_pointer_t tb_virtual_memory_reserve(tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(size, tb_null);
+
+    // reserve the address space only
+    return (tb_pointer_t)VirtualAlloc(tb_null, (SIZE_T)size, MEM_RESERVE, PAGE_NOACCESS);
+}
+tb_pointer_t tb_virtual_memory_reserve_align(tb_size_t size, tb_size_t align)
+{
+    // check
+    tb_assert_and_check_return_val(size && align && !(align & (align - 1)), tb_null);
+
+    /* we cannot release a part of the reserved region on windows,
+     * so we find an aligned address first and reserve it again, it may be taken by the other threads.
+     */
+    tb_size_t tryn = 8;
+    while (tryn--)
+    {
+        // find an address
+        tb_byte_t* data = (tb_byte_t*)VirtualAlloc(tb_null, (SIZE_T)(size + align), MEM_RESERVE, PAGE_NOACCESS);
+        tb_check_break(data);
+        VirtualFree((LPVOID)data, 0, MEM_RELEASE);
+
+        // reserve the aligned address
+        tb_pointer_t data_aligned = VirtualAlloc((LPVOID)tb_align((tb_size_t)data, align), (SIZE_T)size, MEM_RESERVE, PAGE_NOACCESS);
+        if (data_aligned) return data_aligned;
+    }
+    return tb_null;
+}
+tb_bool_t tb_virtual_memory_release(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // release the whole reserved region
+    return VirtualFree((LPVOID)data, 0, MEM_RELEASE)? tb_true : tb_false;
+}
+tb_bool_t tb_virtual_memory_commit(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // commit these pages, the physical memory will be allocated on the first access
+    return VirtualAlloc((LPVOID)data, (SIZE_T)size, MEM_COMMIT, PAGE_READWRITE)? tb_true : tb_false;
+}
+tb_bool_t tb_virtual_memory_decommit(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // decommit these pages
+    return VirtualFree((LPVOID)data, (SIZE_T)size, MEM_DECOMMIT)? tb_true : tb_false;
+}
+tb_bool_t tb_virtual_memory_guard(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // decommit these pages, the region is still reserved and the mapping is not split on windows
+    return VirtualFree((LPVOID)data, (SIZE_T)size, MEM_DECOMMIT)? tb_true : tb_false;
+}
+tb_size_t tb_virtual_memory_resident(tb_pointer_t data, tb_size_t size)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, 0);
+
+    // count the committed pages, we cannot get the working set cheaply here
+    tb_size_t   committed = 0;
+    tb_byte_t*  p = (tb_byte_t*)data;
+    tb_byte_t*  e = p + size;
+    while (p < e)
+    {
+        // query the next region
+        MEMORY_BASIC_INFORMATION info;
+        if (!VirtualQuery((LPCVOID)p, &info, sizeof(info)) || !info.RegionSize) break;
+
+        // the region size in the given range
+        tb_byte_t*  next = (tb_byte_t*)info.BaseAddress + info.RegionSize;
+        tb_size_t   n = (tb_size_t)(tb_min(next, e) - p);
+        if (info.State == MEM_COMMIT) committed += n;
+
+        // next
+        p += n;
+    }
+
+    // ok
+    return committed;
+}
+tb_bool_t tb_virtual_memory_advise(tb_pointer_t data, tb_size_t size, tb_size_t advice)
+{
+    // check
+    tb_assert_and_check_return_val(data && size, tb_false);
+
+    // only supports the lazy and immediate free, the large pages need be allocated by MEM_LARGE_PAGES on windows
+    if (advice == TB_VIRTUAL_MEMORY_ADVICE_FREE)
+        return VirtualAlloc((LPVOID)data, (SIZE_T)size, MEM_RESET, PAGE_READWRITE)? tb_true : tb_false;
+    if (advice == TB_VIRTUAL_MEMORY_ADVICE_DONTNEED)
+        return VirtualFree((LPVOID)data, (SIZE_T)size, MEM_DECOMMIT) && VirtualAlloc((LPVOID)data, (SIZE_T)size, MEM_COMMIT, PAGE_READWRITE)? tb_true : tb_false;
+    return advice == TB_VIRTUAL_MEMORY_ADVICE_NORMAL;
+}
+tb_bool_t tb_virtual_memory_bind(tb_pointer_t data, tb_size_t size, tb_size_t node)
+{
+    // TODO: the numa node need be given by VirtualAllocExNuma() when committing them
+    return tb_false;
+}
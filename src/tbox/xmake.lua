@@ -28,7 +28,7 @@ target("tbox")
     add_packages("zlib", "mysql", "sqlite3", "openssl", "polarssl", "mbedtls", "pcre2", "pcre", "base")
 
     -- add options
-    add_options("info", "float", "wchar", "exception", "deprecated")
+    add_options("info", "float", "wchar", "exception", "deprecated", "iouring")
 
     -- add modules
     add_options("xml", "zip", "hash", "regex", "coroutine", "object", "charset", "database")
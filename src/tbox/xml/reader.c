@@ -53,6 +53,9 @@
 // the xml reader impl type
 typedef struct __tb_xml_reader_impl_t
 {
+    // the allocator
+    tb_allocator_ref_t      allocator;
+
     // the event
     tb_size_t               event;
 
@@ -148,18 +151,29 @@ static tb_char_t const* tb_xml_reader_text_parse(tb_xml_reader_impl_t* reader)
  */
 tb_xml_reader_ref_t tb_xml_reader_init()
 {
+    return tb_xml_reader_init_with_allocator(tb_null);
+}
+tb_xml_reader_ref_t tb_xml_reader_init_with_allocator(tb_allocator_ref_t allocator)
+{
+    // no allocator? uses the global allocator
+    if (!allocator) allocator = tb_allocator();
+    tb_assert_and_check_return_val(allocator, tb_null);
+
     // init reader
-    tb_xml_reader_impl_t* reader = tb_malloc0_type(tb_xml_reader_impl_t);
+    tb_xml_reader_impl_t* reader = (tb_xml_reader_impl_t*)tb_allocator_malloc0(allocator, sizeof(tb_xml_reader_impl_t));
     tb_assert_and_check_return_val(reader, tb_null);
 
+    // init allocator
+    reader->allocator = allocator;
+
     // init string
-    tb_string_init(&reader->text);
-    tb_string_init(&reader->version);
-    tb_string_init(&reader->charset);
-    tb_string_init(&reader->element);
-    tb_string_init(&reader->element_name);
-    tb_string_init(&reader->attribute_name);
-    tb_string_init(&reader->attribute_data);
+    tb_string_init_with_allocator(&reader->text, allocator);
+    tb_string_init_with_allocator(&reader->version, allocator);
+    tb_string_init_with_allocator(&reader->charset, allocator);
+    tb_string_init_with_allocator(&reader->element, allocator);
+    tb_string_init_with_allocator(&reader->element_name, allocator);
+    tb_string_init_with_allocator(&reader->attribute_name, allocator);
+    tb_string_init_with_allocator(&reader->attribute_data, allocator);
     tb_string_cstrcpy(&reader->version, "2.0");
     tb_string_cstrcpy(&reader->charset, "utf-8");
 
@@ -168,8 +182,8 @@ tb_xml_reader_ref_t tb_xml_reader_init()
     for (i = 0; i < TB_XML_READER_ATTRIBUTES_MAXN; i++)
     {
         tb_xml_node_ref_t node = (tb_xml_node_ref_t)(reader->attributes + i);
-        tb_string_init(&node->name);
-        tb_string_init(&node->data);
+        tb_string_init_with_allocator(&node->name, allocator);
+        tb_string_init_with_allocator(&node->data, allocator);
     }
 
     // ok
@@ -218,7 +232,7 @@ tb_void_t tb_xml_reader_exit(tb_xml_reader_ref_t reader)
     }
 
     // free it
-    tb_free(impl);
+    tb_allocator_free(impl->allocator, impl);
 }
 tb_bool_t tb_xml_reader_open(tb_xml_reader_ref_t reader, tb_stream_ref_t stream, tb_bool_t bowner)
 {
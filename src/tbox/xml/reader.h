@@ -69,6 +69,17 @@ typedef __tb_typeref__(xml_reader);
  */
 tb_xml_reader_ref_t     tb_xml_reader_init(tb_noarg_t);
 
+/*! init the xml reader with the given allocator
+ *
+ * the reader and its element, text and attribute strings will be allocated from this allocator,
+ * .e.g an arena allocator which will be cleared after parsing each document.
+ *
+ * @param allocator     the allocator, uses the global allocator if be null
+ *
+ * @return              the reader 
+ */
+tb_xml_reader_ref_t     tb_xml_reader_init_with_allocator(tb_allocator_ref_t allocator);
+
 /*! exit the xml reader
  *
  * @param reader        the xml reader
@@ -43,6 +43,14 @@ option("deprecated")
     set_description("Enable or disable the deprecated interfaces.")
     add_defines_h_if_ok("$(prefix)_API_HAVE_DEPRECATED")
 
+-- option: iouring
+option("iouring")
+    set_default(false)
+    set_showmenu(true)
+    set_category("option")
+    set_description("Enable or disable the io_uring poller on linux, it will use epoll if be disabled.")
+    add_defines_h_if_ok("$(prefix)_POLLER_IOURING_ENABLE")
+
 -- option: micro
 option("micro")
     set_default(false)
@@ -164,6 +172,7 @@ function check_interfaces()
     add_cfuncs("posix", nil,        "ifaddrs.h",                        "getifaddrs")
     add_cfuncs("posix", nil,        "semaphore.h",                      "sem_init")
     add_cfuncs("posix", nil,        "unistd.h",                         "getpagesize", "sysconf")
+    add_cfuncs("posix", nil,        "sys/mman.h",                       "mmap", "mincore", "madvise")
     add_cfuncs("posix", nil,        "sched.h",                          "sched_yield")
     add_cfuncs("posix", nil,        "regex.h",                          "regcomp", "regexec")
     add_cfuncs("posix", nil,        "sys/uio.h",                        "readv", "writev", "preadv", "pwritev")
@@ -180,6 +189,9 @@ function check_interfaces()
 
     -- add the interfaces for systemv
     add_cfuncs("systemv", nil,      {"sys/sem.h", "sys/ipc.h"},         "semget", "semtimedop")
+
+    -- add the interfaces for linux
+    add_cfuncs("linux", nil,        {"linux/io_uring.h", "sys/syscall.h", "unistd.h"}, "io_uring_setup{struct io_uring_params p; syscall(__NR_io_uring_setup, 1, &p); p.features |= IORING_FEAT_NODROP; (void)IORING_OP_RECV;}")
 end
 
 -- add project directories